@@ -36,32 +36,199 @@
  * This file implements bitmap ADT and provides functions for
  * setting and clearing ranges of bits and for finding ranges
  * of unset bits.
+ *
+ * The bits are stored in bytes, least significant bit first, so that
+ * the layout is suitable for hardware structures such as the I/O
+ * permission bitmap. Searching is done one word (BITMAP_WORD bits) at
+ * a time. Optionally, a second level bitmap (summary) with one bit for
+ * each word of the bitmap allows to skip whole words that are full
+ * without reading them.
  */
 
 #include <adt/bitmap.h>
 #include <align.h>
 #include <assert.h>
 #include <macros.h>
+#include <mem.h>
 
 #define ALL_ONES    0xff
 #define ALL_ZEROES  0x00
 
-/** Unchecked version of bitmap_get()
+/** Word with all bits set */
+#define WORD_ONES  (~0UL)
+
+/** Number of bytes in a word */
+#define WORD_BYTES  (BITMAP_WORD / BITMAP_ELEMENT)
+
+/** Word of the bitmap at any address */
+typedef unsigned long bitmap_uword_t __attribute__((aligned(1), may_alias));
+
+/** Get number of words covering a number of bits. */
+static size_t bitmap_words(size_t elements)
+{
+	return (elements + BITMAP_WORD - 1) / BITMAP_WORD;
+}
+
+/** Get index of least significant set bit of a non-zero word. */
+static inline size_t word_ffs(unsigned long word)
+{
+	return __builtin_ctzl(word);
+}
+
+/** Load word of the bitmap.
+ *
+ * Bit @c i of the result corresponds to element @c word * BITMAP_WORD + i.
+ * Bits beyond the last element of the bitmap are returned as set,
+ * so that they never appear free.
+ *
+ * @param bitmap Bitmap.
+ * @param word   Word index.
+ *
+ * @return Word of the bitmap.
+ *
+ */
+static unsigned long bitmap_load_word(bitmap_t *bitmap, size_t word)
+{
+	const uint8_t *p = bitmap->bits + word * WORD_BYTES;
+	size_t avail = bitmap_size(bitmap->elements) - word * WORD_BYTES;
+	unsigned long w;
+
+	if (avail >= WORD_BYTES) {
+		w = *(const bitmap_uword_t *) p;
+#ifdef __BE__
+#if __SIZEOF_LONG__ == 8
+		w = __builtin_bswap64(w);
+#else
+		w = __builtin_bswap32(w);
+#endif
+#endif
+	} else {
+		/* Do not read past the end of a bitmap without summary */
+		w = 0;
+		for (size_t i = 0; i < avail; i++)
+			w |= (unsigned long) p[i] << (i * BITMAP_ELEMENT);
+	}
+
+	if ((word + 1) * BITMAP_WORD > bitmap->elements)
+		w |= WORD_ONES << (bitmap->elements % BITMAP_WORD);
+
+	return w;
+}
+
+/** Update second level bitmap.
  *
- * This version of bitmap_get() does not do any boundary checks.
+ * Used by bitmap_set() to keep the second level bitmap in sync.
  *
- * @param bitmap  Bitmap to access.
- * @param element Element to access.
+ * @param bitmap  Bitmap with second level bitmap.
+ * @param element Element whose word has changed.
+ *
+ */
+void bitmap_summary_update(bitmap_t *bitmap, size_t element)
+{
+	size_t word = element / BITMAP_WORD;
+	unsigned long mask = 1UL << (word % BITMAP_WORD);
+
+	if (bitmap_load_word(bitmap, word) == WORD_ONES)
+		bitmap->summary[word / BITMAP_WORD] |= mask;
+	else
+		bitmap->summary[word / BITMAP_WORD] &= ~mask;
+}
+
+/** Update second level bitmap for a range of bits.
  *
- * @return Bit value of the element in the bitmap.
+ * @param bitmap Bitmap.
+ * @param start  Starting bit.
+ * @param count  Number of bits that have changed.
  *
  */
-static unsigned int bitmap_get_fast(bitmap_t *bitmap, size_t element)
+static void bitmap_summary_update_range(bitmap_t *bitmap, size_t start,
+    size_t count)
 {
-	size_t byte = element / BITMAP_ELEMENT;
-	uint8_t mask = 1 << (element & BITMAP_REMAINER);
+	if (bitmap->summary == NULL || count == 0)
+		return;
+
+	size_t last = (start + count - 1) / BITMAP_WORD;
 
-	return !!((bitmap->bits)[byte] & mask);
+	for (size_t word = start / BITMAP_WORD; word <= last; word++)
+		bitmap_summary_update(bitmap, word * BITMAP_WORD);
+}
+
+/** Find first zero bit.
+ *
+ * @param bitmap Bitmap.
+ * @param from   First bit to consider.
+ * @param to     Bit after the last bit to consider.
+ *
+ * @return Index of the first zero bit in [@a from, @a to) or @a to if
+ *         there is none.
+ *
+ */
+static size_t bitmap_find_zero(bitmap_t *bitmap, size_t from, size_t to)
+{
+	if (from >= to)
+		return to;
+
+	size_t word = from / BITMAP_WORD;
+	size_t last = (to - 1) / BITMAP_WORD;
+	unsigned long w = bitmap_load_word(bitmap, word) |
+	    ((1UL << (from % BITMAP_WORD)) - 1);
+
+	while (w == WORD_ONES) {
+		if (++word > last)
+			return to;
+
+		if (bitmap->summary != NULL) {
+			/* Skip words which are full */
+			size_t sword = word / BITMAP_WORD;
+			unsigned long s = bitmap->summary[sword] |
+			    ((1UL << (word % BITMAP_WORD)) - 1);
+
+			while (s == WORD_ONES) {
+				if (++sword > last / BITMAP_WORD)
+					return to;
+
+				s = bitmap->summary[sword];
+			}
+
+			word = sword * BITMAP_WORD + word_ffs(~s);
+			if (word > last)
+				return to;
+		}
+
+		w = bitmap_load_word(bitmap, word);
+	}
+
+	return min(word * BITMAP_WORD + word_ffs(~w), to);
+}
+
+/** Find first set bit.
+ *
+ * @param bitmap Bitmap.
+ * @param from   First bit to consider.
+ * @param to     Bit after the last bit to consider.
+ *
+ * @return Index of the first set bit in [@a from, @a to) or @a to if
+ *         there is none.
+ *
+ */
+static size_t bitmap_find_one(bitmap_t *bitmap, size_t from, size_t to)
+{
+	if (from >= to)
+		return to;
+
+	size_t word = from / BITMAP_WORD;
+	size_t last = (to - 1) / BITMAP_WORD;
+	unsigned long w = bitmap_load_word(bitmap, word) &
+	    ~((1UL << (from % BITMAP_WORD)) - 1);
+
+	while (w == 0) {
+		if (++word > last)
+			return to;
+
+		w = bitmap_load_word(bitmap, word);
+	}
+
+	return min(word * BITMAP_WORD + word_ffs(w), to);
 }
 
 /** Get bitmap size
@@ -83,15 +250,31 @@ size_t bitmap_size(size_t elements)
 	return size;
 }
 
+/** Get size of bitmap with second level bitmap
+ *
+ * Return the size (in bytes) required for the bitmap including
+ * the second level bitmap (see bitmap_initialize_summary()).
+ *
+ * @param elements   Number bits stored in bitmap.
+ *
+ * @return Size (in bytes) required for the bitmap.
+ *
+ */
+size_t bitmap_size_summary(size_t elements)
+{
+	size_t words = bitmap_words(elements);
+
+	return (words + bitmap_words(words)) * WORD_BYTES;
+}
+
 /** Initialize bitmap.
  *
  * No portion of the bitmap is set or cleared by this function.
  *
  * @param bitmap     Bitmap structure.
  * @param elements   Number of bits stored in bitmap.
- * @param data       Address of the memory used to hold the map.
- *                   The optional 2nd level bitmap follows the 1st
- *                   level bitmap.
+ * @param data       Address of the memory used to hold the map
+ *                   (at least bitmap_size() bytes).
  *
  */
 void bitmap_initialize(bitmap_t *bitmap, size_t elements, void *data)
@@ -99,6 +282,34 @@ void bitmap_initialize(bitmap_t *bitmap, size_t elements, void *data)
 	bitmap->elements = elements;
 	bitmap->bits = (uint8_t *) data;
 	bitmap->next_fit = 0;
+	bitmap->summary = NULL;
+}
+
+/** Initialize bitmap with second level bitmap.
+ *
+ * The second level bitmap allows to skip full parts of large bitmaps
+ * quickly when searching for free bits. It is kept up to date by all
+ * bitmap functions, hence the bits must not be modified directly.
+ * Like with bitmap_initialize(), the bitmap must be set or cleared
+ * (using bitmap_set_range() or bitmap_clear_range()) before use.
+ *
+ * @param bitmap     Bitmap structure.
+ * @param elements   Number of bits stored in bitmap.
+ * @param data       Word-aligned address of the memory used to hold
+ *                   the map (at least bitmap_size_summary() bytes).
+ *                   The 2nd level bitmap follows the 1st level bitmap.
+ *
+ */
+void bitmap_initialize_summary(bitmap_t *bitmap, size_t elements, void *data)
+{
+	assert(((uintptr_t) data % sizeof(unsigned long)) == 0);
+
+	bitmap_initialize(bitmap, elements, data);
+	bitmap->summary = (unsigned long *) data + bitmap_words(elements);
+
+	/* A clear bit only means that the word may contain zero bits */
+	memset(bitmap->summary, 0,
+	    bitmap_words(bitmap_words(elements)) * WORD_BYTES);
 }
 
 /** Set range of bits.
@@ -131,6 +342,7 @@ void bitmap_set_range(bitmap_t *bitmap, size_t start, size_t count)
 		/* Set bits in the middle of byte. */
 		bitmap->bits[start_byte] |=
 		    ((1 << lub) - 1) << (start & BITMAP_REMAINER);
+		bitmap_summary_update_range(bitmap, start, count);
 		return;
 	}
 
@@ -140,19 +352,17 @@ void bitmap_set_range(bitmap_t *bitmap, size_t start, size_t count)
 		    ~((1 << (BITMAP_ELEMENT - lub)) - 1);
 	}
 
-	size_t i;
-
-	for (i = 0; i < amb / BITMAP_ELEMENT; i++) {
-		/* The middle bits can be set byte by byte. */
-		bitmap->bits[aligned_start / BITMAP_ELEMENT + i] =
-		    ALL_ONES;
-	}
+	/* The middle bits can be set byte by byte. */
+	size_t i = amb / BITMAP_ELEMENT;
+	memset(&bitmap->bits[aligned_start / BITMAP_ELEMENT], ALL_ONES, i);
 
 	if (tab) {
 		/* Make sure to set any trailing aligned bits. */
 		bitmap->bits[aligned_start / BITMAP_ELEMENT + i] |=
 		    (1 << tab) - 1;
 	}
+
+	bitmap_summary_update_range(bitmap, start, count);
 }
 
 /** Clear range of bits.
@@ -185,6 +395,7 @@ void bitmap_clear_range(bitmap_t *bitmap, size_t start, size_t count)
 		/* Set bits in the middle of byte */
 		bitmap->bits[start_byte] &=
 		    ~(((1 << lub) - 1) << (start & BITMAP_REMAINER));
+		bitmap_summary_update_range(bitmap, start, count);
 		return;
 	}
 
@@ -194,13 +405,9 @@ void bitmap_clear_range(bitmap_t *bitmap, size_t start, size_t count)
 		    (1 << (BITMAP_ELEMENT - lub)) - 1;
 	}
 
-	size_t i;
-
-	for (i = 0; i < amb / BITMAP_ELEMENT; i++) {
-		/* The middle bits can be cleared byte by byte. */
-		bitmap->bits[aligned_start / BITMAP_ELEMENT + i] =
-		    ALL_ZEROES;
-	}
+	/* The middle bits can be cleared byte by byte. */
+	size_t i = amb / BITMAP_ELEMENT;
+	memset(&bitmap->bits[aligned_start / BITMAP_ELEMENT], ALL_ZEROES, i);
 
 	if (tab) {
 		/* Make sure to clear any trailing aligned bits. */
@@ -208,6 +415,7 @@ void bitmap_clear_range(bitmap_t *bitmap, size_t start, size_t count)
 		    ~((1 << tab) - 1);
 	}
 
+	bitmap_summary_update_range(bitmap, start, count);
 	bitmap->next_fit = start_byte;
 }
 
@@ -223,10 +431,9 @@ void bitmap_copy(bitmap_t *dst, bitmap_t *src, size_t count)
 	assert(count <= dst->elements);
 	assert(count <= src->elements);
 
-	size_t i;
+	size_t i = count / BITMAP_ELEMENT;
 
-	for (i = 0; i < count / BITMAP_ELEMENT; i++)
-		dst->bits[i] = src->bits[i];
+	memcpy(dst->bits, src->bits, i);
 
 	if (count % BITMAP_ELEMENT) {
 		bitmap_clear_range(dst, i * BITMAP_ELEMENT,
@@ -234,6 +441,8 @@ void bitmap_copy(bitmap_t *dst, bitmap_t *src, size_t count)
 		dst->bits[i] |= src->bits[i] &
 		    ((1 << (count % BITMAP_ELEMENT)) - 1);
 	}
+
+	bitmap_summary_update_range(dst, 0, count);
 }
 
 static int constraint_satisfy(size_t index, size_t base, size_t constraint)
@@ -241,6 +450,84 @@ static int constraint_satisfy(size_t index, size_t base, size_t constraint)
 	return (((base + index) & constraint) == 0);
 }
 
+/** Find next index satisfying constraint.
+ *
+ * @param index      Index to start at.
+ * @param base       Address of the first bit in the bitmap.
+ * @param constraint Constraint for the address (see
+ *                   bitmap_allocate_range()).
+ *
+ * @return Smallest index not smaller than @a index such that the
+ *         corresponding address satisfies the constraint or
+ *         SIZE_MAX if there is none.
+ *
+ */
+static size_t constraint_next(size_t index, size_t base, size_t constraint)
+{
+	size_t addr = base + index;
+
+	while ((addr & constraint) != 0) {
+		/*
+		 * All addresses that agree with addr on the highest
+		 * violating bit and above violate the constraint too.
+		 */
+		size_t bit = (size_t) 1 << (BITMAP_WORD - 1 -
+		    __builtin_clzl(addr & constraint));
+		size_t next = (addr & ~(bit - 1)) + bit;
+
+		if (next < addr)
+			return SIZE_MAX;
+
+		addr = next;
+	}
+
+	return addr - base;
+}
+
+/** Find a continuous zero bit range starting in a given interval
+ *
+ * @param bitmap     Bitmap structure.
+ * @param count      Number of continuous zero bits to find.
+ * @param base       Address of the first bit in the bitmap.
+ * @param constraint Constraint for the address of the first zero bit.
+ * @param from       First bit where the range can start.
+ * @param to         Bit after the last bit where the range can start.
+ * @param index      Place to store the index of the first zero bit.
+ *
+ * @return True if a range has been found.
+ *
+ */
+static bool bitmap_find_range(bitmap_t *bitmap, size_t count, size_t base,
+    size_t constraint, size_t from, size_t to, size_t *index)
+{
+	size_t i = from;
+
+	while (i < to) {
+		i = bitmap_find_zero(bitmap, i, to);
+		if (i >= to)
+			break;
+
+		if (!constraint_satisfy(i, base, constraint)) {
+			i = constraint_next(i, base, constraint);
+			continue;
+		}
+
+		/* Ranges starting further on would not fit either */
+		if (count > bitmap->elements - i)
+			break;
+
+		size_t one = bitmap_find_one(bitmap, i, i + count);
+		if (one == i + count) {
+			*index = i;
+			return true;
+		}
+
+		i = one + 1;
+	}
+
+	return false;
+}
+
 /** Find a continuous zero bit range
  *
  * Find a continuous zero bit range in the bitmap. The address
@@ -249,6 +536,10 @@ static int constraint_satisfy(size_t index, size_t base, size_t constraint)
  * (those bits that are set in the constraint cannot be set in
  * the address).
  *
+ * The search starts at the next-fit position (just after the last
+ * allocated range or at the last freed bit) or at the prefered
+ * address, whichever is higher, and wraps around.
+ *
  * If the index argument is non-NULL, the continuous zero range
  * is set and the index of the first bit is stored to index.
  * Otherwise the bitmap stays untouched.
@@ -270,10 +561,9 @@ static int constraint_satisfy(size_t index, size_t base, size_t constraint)
 bool bitmap_allocate_range(bitmap_t *bitmap, size_t count, size_t base,
     size_t prefered, size_t constraint, size_t *index)
 {
-	if (count == 0)
+	if (count == 0 || count > bitmap->elements)
 		return false;
 
-	size_t size = bitmap_size(bitmap->elements);
 	size_t next_fit = bitmap->next_fit;
 
 	/*
@@ -287,50 +577,23 @@ bool bitmap_allocate_range(bitmap_t *bitmap, size_t count, size_t base,
 			next_fit = prefered_fit;
 	}
 
-	for (size_t pos = 0; pos < size; pos++) {
-		size_t byte = (next_fit + pos) % size;
-
-		/* Skip if the current byte has all bits set */
-		if (bitmap->bits[byte] == ALL_ONES)
-			continue;
-
-		size_t byte_bit = byte * BITMAP_ELEMENT;
-
-		for (size_t bit = 0; bit < BITMAP_ELEMENT; bit++) {
-			size_t i = byte_bit + bit;
-
-			if (i >= bitmap->elements)
-				break;
+	size_t start = next_fit * BITMAP_ELEMENT;
+	if (start >= bitmap->elements)
+		start = 0;
 
-			if (!constraint_satisfy(i, base, constraint))
-				continue;
-
-			if (!bitmap_get_fast(bitmap, i)) {
-				size_t continuous = 1;
-
-				for (size_t j = 1; j < count; j++) {
-					if ((i + j < bitmap->elements) &&
-					    (!bitmap_get_fast(bitmap, i + j)))
-						continuous++;
-					else
-						break;
-				}
-
-				if (continuous == count) {
-					if (index != NULL) {
-						bitmap_set_range(bitmap, i, count);
-						bitmap->next_fit = i / BITMAP_ELEMENT;
-						*index = i;
-					}
+	size_t i;
+	if (!bitmap_find_range(bitmap, count, base, constraint, start,
+	    bitmap->elements, &i) && !bitmap_find_range(bitmap, count, base,
+	    constraint, 0, start, &i))
+		return false;
 
-					return true;
-				} else
-					i += continuous;
-			}
-		}
+	if (index != NULL) {
+		bitmap_set_range(bitmap, i, count);
+		bitmap->next_fit = (i + count) / BITMAP_ELEMENT;
+		*index = i;
 	}
 
-	return false;
+	return true;
 }
 
 /** @}
@@ -0,0 +1,1209 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup kernel_generic_adt
+ * @{
+ */
+
+/** @file B+tree ordered dictionary.
+ *
+ * Items are stored in the leaves, sorted by key. Internal nodes hold
+ * separator keys such that all keys in child i are not greater than
+ * separator i and not less than separator i - 1. Items with equal keys
+ * are allowed and stay in the order of insertion.
+ *
+ * A node holds up to 'order' keys, where the order is chosen so that
+ * a node takes about BPT_NODE_SIZE bytes. If the tree is initialized
+ * with a non-zero key size, the keys are copied into the nodes and
+ * a search does not need to touch any item except the one it finds.
+ * Such an item's key must not change while the item is in the tree.
+ * With zero key size the nodes store the pointers returned by getkey().
+ * Each separator then points to the key of the first item in the subtree
+ * to its right. When that item is removed, the separator is redirected
+ * to the new first item, since the removed item may be freed.
+ *
+ * Leaves are linked in both directions, so iteration moves through
+ * whole nodes of items instead of following a pointer per item.
+ */
+
+#include <adt/bptree.h>
+#include <align.h>
+#include <assert.h>
+#include <errno.h>
+#include <mem.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/** Approximate size of a node in bytes */
+#define BPT_NODE_SIZE  256
+/** Minimum number of keys a full node can hold */
+#define BPT_MIN_ORDER  4
+
+/** B+tree node.
+ *
+ * The header is followed by order + 1 key slots and order + 2 pointers
+ * (one extra for the overflow just before a split). In a leaf pointer i
+ * is the item with key i. In an internal node pointer i is the child
+ * to the left of key i.
+ */
+struct bptree_node {
+	/** Parent node or @c NULL for the root */
+	bptree_node_t *parent;
+	/** Previous leaf */
+	bptree_node_t *prev;
+	/** Next leaf */
+	bptree_node_t *next;
+	/** Number of keys */
+	unsigned nkeys;
+	/** @c true iff node is a leaf */
+	bool leaf;
+};
+
+/** Get key slot @a i of node. */
+static inline uint8_t *node_slot(bptree_t *tree, bptree_node_t *node,
+    unsigned i)
+{
+	return (uint8_t *) node + tree->keys_off + i * tree->slot_size;
+}
+
+/** Get pointer array of node. */
+static inline void **node_ptrs(bptree_t *tree, bptree_node_t *node)
+{
+	return (void **) ((uint8_t *) node + tree->ptrs_off);
+}
+
+/** Get key @a i of node in the form expected by the compare operation. */
+static inline void *node_key(bptree_t *tree, bptree_node_t *node, unsigned i)
+{
+	uint8_t *slot = node_slot(tree, node, i);
+
+	return tree->key_size != 0 ? slot : *(void **) slot;
+}
+
+/** Store key of @a item to key slot @a i of node. */
+static void node_set_key(bptree_t *tree, bptree_node_t *node, unsigned i,
+    void *item)
+{
+	uint8_t *slot = node_slot(tree, node, i);
+
+	if (tree->key_size != 0)
+		memcpy(slot, tree->getkey(item), tree->key_size);
+	else
+		*(void **) slot = tree->getkey(item);
+}
+
+/** Copy @a cnt keys and pointers between (possibly the same) nodes.
+ *
+ * @param tree B+tree
+ * @param dn Destination node
+ * @param di Index of first destination key
+ * @param sn Source node
+ * @param si Index of first source key
+ * @param cnt Number of keys
+ * @param poff Offset of the first pointer relative to the first key
+ *             (0 for items, 1 to move the children right of the keys)
+ */
+static void node_move(bptree_t *tree, bptree_node_t *dn, unsigned di,
+    bptree_node_t *sn, unsigned si, unsigned cnt, unsigned poff)
+{
+	memmove(node_slot(tree, dn, di), node_slot(tree, sn, si),
+	    cnt * tree->slot_size);
+	memmove(&node_ptrs(tree, dn)[di + poff], &node_ptrs(tree, sn)[si + poff],
+	    cnt * sizeof(void *));
+}
+
+/** Allocate node.
+ *
+ * @param tree B+tree
+ * @param leaf @c true to allocate a leaf
+ * @return New node or @c NULL if out of memory
+ */
+static bptree_node_t *node_alloc(bptree_t *tree, bool leaf)
+{
+	bptree_node_t *node;
+
+	node = malloc(tree->node_size);
+	if (node == NULL)
+		return NULL;
+
+	node->parent = NULL;
+	node->prev = NULL;
+	node->next = NULL;
+	node->nkeys = 0;
+	node->leaf = leaf;
+	return node;
+}
+
+/** Allocate @a cnt nodes and link them through their parent pointer.
+ *
+ * @return List of nodes or @c NULL if out of memory (or @a cnt is zero)
+ */
+static bptree_node_t *nodes_reserve(bptree_t *tree, size_t cnt)
+{
+	bptree_node_t *list = NULL;
+	bptree_node_t *node;
+
+	while (cnt-- > 0) {
+		node = node_alloc(tree, false);
+		if (node == NULL) {
+			while (list != NULL) {
+				node = list;
+				list = list->parent;
+				free(node);
+			}
+
+			return NULL;
+		}
+
+		node->parent = list;
+		list = node;
+	}
+
+	return list;
+}
+
+/** Take a node from a list of reserved nodes. */
+static bptree_node_t *nodes_take(bptree_node_t **list, bool leaf)
+{
+	bptree_node_t *node = *list;
+
+	assert(node != NULL);
+	*list = node->parent;
+	node->parent = NULL;
+	node->leaf = leaf;
+	return node;
+}
+
+/** Free subtree. */
+static void subtree_free(bptree_t *tree, bptree_node_t *node)
+{
+	unsigned i;
+
+	if (!node->leaf) {
+		for (i = 0; i <= node->nkeys; i++)
+			subtree_free(tree, node_ptrs(tree, node)[i]);
+	}
+
+	free(node);
+}
+
+/** Count keys in node that are less than (or equal to) @a key.
+ *
+ * @param tree B+tree
+ * @param node Node
+ * @param key Key
+ * @param incl @c true to count keys equal to @a key too
+ * @return Number of keys
+ */
+static unsigned node_rank(bptree_t *tree, bptree_node_t *node,
+    const void *key, bool incl)
+{
+	unsigned lo = 0;
+	unsigned hi = node->nkeys;
+	unsigned mid;
+	int d;
+
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		d = tree->cmp(node_key(tree, node, mid), key);
+		if (d < 0 || (incl && d == 0))
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+/** Find leaf where the first key not less than (or greater than) key is.
+ *
+ * @param tree B+tree (not empty)
+ * @param key Key
+ * @param incl @c false to look for the first key >= @a key, @c true
+ *             to look for the first key > @a key
+ * @return Leaf
+ */
+static bptree_node_t *find_leaf(bptree_t *tree, const void *key, bool incl)
+{
+	bptree_node_t *node = tree->root;
+
+	while (!node->leaf)
+		node = node_ptrs(tree, node)[node_rank(tree, node, key, incl)];
+
+	return node;
+}
+
+/** Get item at iterator position. */
+static void *iter_item(bptree_iter_t *iter)
+{
+	if (iter->node == NULL)
+		return NULL;
+
+	return node_ptrs(iter->tree, iter->node)[iter->idx];
+}
+
+/** Position iterator at the first key not less than (greater than) key.
+ *
+ * @param tree B+tree
+ * @param key Key
+ * @param incl @c false for first key >= @a key, @c true for first > @a key
+ * @param iter Iterator to set (at the end if there is no such key)
+ */
+static void iter_bound(bptree_t *tree, const void *key, bool incl,
+    bptree_iter_t *iter)
+{
+	bptree_node_t *leaf;
+
+	iter->tree = tree;
+	iter->node = NULL;
+	iter->idx = 0;
+
+	if (tree->root == NULL)
+		return;
+
+	leaf = find_leaf(tree, key, incl);
+	iter->idx = node_rank(tree, leaf, key, incl);
+	iter->node = leaf;
+
+	if (iter->idx == leaf->nkeys) {
+		/* All keys in the leaf are less, continue with the next one */
+		iter->node = leaf->next;
+		iter->idx = 0;
+	}
+}
+
+/** Move iterator one item back.
+ *
+ * Moving back from the end gives the last item.
+ *
+ * @param iter Iterator
+ * @return Item at the new position or @c NULL if there is none
+ */
+static void *iter_back(bptree_iter_t *iter)
+{
+	if (iter->node == NULL) {
+		iter->node = iter->tree->last;
+		if (iter->node == NULL)
+			return NULL;
+
+		iter->idx = iter->node->nkeys;
+	}
+
+	if (iter->idx == 0) {
+		iter->node = iter->node->prev;
+		if (iter->node == NULL)
+			return NULL;
+
+		iter->idx = iter->node->nkeys;
+	}
+
+	--iter->idx;
+	return iter_item(iter);
+}
+
+/** Initialize B+tree.
+ *
+ * @param tree B+tree
+ * @param key_size Size of key in bytes. Keys of this size are copied into
+ *                 the tree nodes. Pass zero if the key cannot be copied
+ *                 (e.g. a string), the nodes then store the pointers
+ *                 returned by @a getkey.
+ * @param getkey Function to get pointer to key of an item
+ * @param cmp Function to compare two keys
+ */
+void bptree_initialize(bptree_t *tree, size_t key_size, bpgetkey_t getkey,
+    bpcmp_t cmp)
+{
+	size_t hdr_size;
+	size_t order;
+
+	tree->root = NULL;
+	tree->first = NULL;
+	tree->last = NULL;
+	tree->count = 0;
+	tree->getkey = getkey;
+	tree->cmp = cmp;
+	tree->key_size = key_size;
+
+	if (key_size == 0)
+		tree->slot_size = sizeof(void *);
+	else if (key_size <= sizeof(uint32_t))
+		tree->slot_size = ALIGN_UP(key_size, sizeof(uint32_t));
+	else
+		tree->slot_size = ALIGN_UP(key_size, sizeof(uint64_t));
+
+	hdr_size = ALIGN_UP(sizeof(bptree_node_t), sizeof(uint64_t));
+
+	/* Room for one key and two pointers more for overflow */
+	order = (BPT_NODE_SIZE - hdr_size - tree->slot_size -
+	    2 * sizeof(void *)) / (tree->slot_size + sizeof(void *));
+	if (BPT_NODE_SIZE < hdr_size + tree->slot_size + 2 * sizeof(void *) ||
+	    order < BPT_MIN_ORDER)
+		order = BPT_MIN_ORDER;
+
+	tree->order = order;
+	tree->keys_off = hdr_size;
+	tree->ptrs_off = ALIGN_UP(hdr_size + (order + 1) * tree->slot_size,
+	    sizeof(void *));
+	tree->node_size = tree->ptrs_off + (order + 2) * sizeof(void *);
+}
+
+/** Finalize B+tree.
+ *
+ * Frees the tree nodes. The items are not touched.
+ *
+ * @param tree B+tree
+ */
+void bptree_finalize(bptree_t *tree)
+{
+	if (tree->root != NULL)
+		subtree_free(tree, tree->root);
+
+	tree->root = NULL;
+	tree->first = NULL;
+	tree->last = NULL;
+	tree->count = 0;
+}
+
+/** Get index of child in its parent. */
+static unsigned child_index(bptree_t *tree, bptree_node_t *parent,
+    bptree_node_t *child)
+{
+	void **ptrs = node_ptrs(tree, parent);
+	unsigned i;
+
+	for (i = 0; i <= parent->nkeys; i++) {
+		if (ptrs[i] == child)
+			return i;
+	}
+
+	assert(false);
+	return 0;
+}
+
+static void split_internal(bptree_t *, bptree_node_t *, bptree_node_t **);
+
+/** Insert separator and new right sibling into parent after a split.
+ *
+ * @param tree B+tree
+ * @param left Node that was split
+ * @param slot Key slot with separator key
+ * @param right New node to the right of @a left
+ * @param spare List of reserved nodes
+ */
+static void insert_in_parent(bptree_t *tree, bptree_node_t *left,
+    uint8_t *slot, bptree_node_t *right, bptree_node_t **spare)
+{
+	bptree_node_t *parent = left->parent;
+	unsigned idx;
+
+	if (parent == NULL) {
+		/* Grow the tree by one level */
+		parent = nodes_take(spare, false);
+		memcpy(node_slot(tree, parent, 0), slot, tree->slot_size);
+		node_ptrs(tree, parent)[0] = left;
+		node_ptrs(tree, parent)[1] = right;
+		parent->nkeys = 1;
+		left->parent = parent;
+		right->parent = parent;
+		tree->root = parent;
+		return;
+	}
+
+	idx = child_index(tree, parent, left);
+	node_move(tree, parent, idx + 1, parent, idx, parent->nkeys - idx, 1);
+	memcpy(node_slot(tree, parent, idx), slot, tree->slot_size);
+	node_ptrs(tree, parent)[idx + 1] = right;
+	right->parent = parent;
+	++parent->nkeys;
+
+	if (parent->nkeys > tree->order)
+		split_internal(tree, parent, spare);
+}
+
+/** Split overfull leaf. */
+static void split_leaf(bptree_t *tree, bptree_node_t *node,
+    bptree_node_t **spare)
+{
+	bptree_node_t *right = nodes_take(spare, true);
+	unsigned nright = node->nkeys / 2;
+	unsigned nleft = node->nkeys - nright;
+
+	node_move(tree, right, 0, node, nleft, nright, 0);
+	right->nkeys = nright;
+	node->nkeys = nleft;
+
+	right->prev = node;
+	right->next = node->next;
+	if (node->next != NULL)
+		node->next->prev = right;
+	else
+		tree->last = right;
+	node->next = right;
+
+	insert_in_parent(tree, node, node_slot(tree, right, 0), right, spare);
+}
+
+/** Split overfull internal node, moving the middle key up. */
+static void split_internal(bptree_t *tree, bptree_node_t *node,
+    bptree_node_t **spare)
+{
+	bptree_node_t *right = nodes_take(spare, false);
+	unsigned mid = node->nkeys / 2;
+	void **ptrs;
+	unsigned i;
+
+	right->nkeys = node->nkeys - mid - 1;
+	memcpy(node_slot(tree, right, 0), node_slot(tree, node, mid + 1),
+	    right->nkeys * tree->slot_size);
+	memcpy(node_ptrs(tree, right), &node_ptrs(tree, node)[mid + 1],
+	    (right->nkeys + 1) * sizeof(void *));
+	node->nkeys = mid;
+
+	ptrs = node_ptrs(tree, right);
+	for (i = 0; i <= right->nkeys; i++)
+		((bptree_node_t *) ptrs[i])->parent = right;
+
+	/* Key slot mid of node stays intact until copied to the parent */
+	insert_in_parent(tree, node, node_slot(tree, node, mid), right, spare);
+}
+
+/** Insert item into B+tree.
+ *
+ * The item is inserted after all items with an equal key. The tree
+ * is left unchanged if there is not enough memory.
+ *
+ * @param tree B+tree
+ * @param item Item
+ * @return EOK on success, ENOMEM if out of memory
+ */
+errno_t bptree_insert(bptree_t *tree, void *item)
+{
+	bptree_node_t *spare = NULL;
+	bptree_node_t *leaf;
+	bptree_node_t *node;
+	void *key = tree->getkey(item);
+	size_t nsplit = 0;
+	unsigned idx;
+
+	if (tree->root == NULL) {
+		leaf = node_alloc(tree, true);
+		if (leaf == NULL)
+			return ENOMEM;
+
+		tree->root = leaf;
+		tree->first = leaf;
+		tree->last = leaf;
+	}
+
+	leaf = find_leaf(tree, key, true);
+
+	/* Reserve nodes for all splits this insertion will cause */
+	for (node = leaf; node != NULL && node->nkeys == tree->order;
+	    node = node->parent) {
+		++nsplit;
+		if (node->parent == NULL)
+			++nsplit;
+	}
+
+	if (nsplit > 0) {
+		spare = nodes_reserve(tree, nsplit);
+		if (spare == NULL)
+			return ENOMEM;
+	}
+
+	idx = node_rank(tree, leaf, key, true);
+	node_move(tree, leaf, idx + 1, leaf, idx, leaf->nkeys - idx, 0);
+	node_set_key(tree, leaf, idx, item);
+	node_ptrs(tree, leaf)[idx] = item;
+	++leaf->nkeys;
+	++tree->count;
+
+	if (leaf->nkeys > tree->order)
+		split_leaf(tree, leaf, &spare);
+
+	assert(spare == NULL);
+	return EOK;
+}
+
+/** Build B+tree from sorted items.
+ *
+ * Much faster than inserting the items one by one. The nodes are filled
+ * almost completely.
+ *
+ * @param tree Empty B+tree
+ * @param items Items sorted by key in ascending order
+ * @param cnt Number of items
+ * @return EOK on success, ENOMEM if out of memory (the tree stays empty)
+ */
+errno_t bptree_bulk_load(bptree_t *tree, void **items, size_t cnt)
+{
+	bptree_node_t **level;
+	bptree_node_t *spare;
+	bptree_node_t *node;
+	bptree_node_t *child;
+	size_t nnodes, nparents;
+	size_t total;
+	size_t i, j, k, n;
+
+	assert(tree->root == NULL);
+
+	if (cnt == 0)
+		return EOK;
+
+	/* Count nodes on all levels and reserve them beforehand */
+	nnodes = (cnt + tree->order - 1) / tree->order;
+	total = nnodes;
+	for (n = nnodes; n > 1; n = (n + tree->order) / (tree->order + 1))
+		total += (n + tree->order) / (tree->order + 1);
+
+	level = malloc(nnodes * sizeof(bptree_node_t *));
+	if (level == NULL)
+		return ENOMEM;
+
+	spare = nodes_reserve(tree, total);
+	if (spare == NULL) {
+		free(level);
+		return ENOMEM;
+	}
+
+	/* Leaves, with the items distributed evenly */
+	k = 0;
+	for (i = 0; i < nnodes; i++) {
+		node = nodes_take(&spare, true);
+		node->nkeys = cnt / nnodes + (i < cnt % nnodes ? 1 : 0);
+
+		for (j = 0; j < node->nkeys; j++, k++) {
+			assert(k == 0 || tree->cmp(tree->getkey(items[k - 1]),
+			    tree->getkey(items[k])) <= 0);
+			node_set_key(tree, node, j, items[k]);
+			node_ptrs(tree, node)[j] = items[k];
+		}
+
+		if (i > 0) {
+			node->prev = level[i - 1];
+			level[i - 1]->next = node;
+		}
+
+		level[i] = node;
+	}
+
+	tree->first = level[0];
+	tree->last = level[nnodes - 1];
+
+	/* Internal levels, until a single root remains */
+	while (nnodes > 1) {
+		nparents = (nnodes + tree->order) / (tree->order + 1);
+		k = 0;
+
+		for (i = 0; i < nparents; i++) {
+			node = nodes_take(&spare, false);
+			n = nnodes / nparents + (i < nnodes % nparents ? 1 : 0);
+			node->nkeys = n - 1;
+
+			for (j = 0; j < n; j++, k++) {
+				node_ptrs(tree, node)[j] = level[k];
+				level[k]->parent = node;
+				if (j == 0)
+					continue;
+
+				/* Separator is the least key in the subtree */
+				child = level[k];
+				while (!child->leaf)
+					child = node_ptrs(tree, child)[0];
+
+				memcpy(node_slot(tree, node, j - 1),
+				    node_slot(tree, child, 0), tree->slot_size);
+			}
+
+			/* Children up to index k have been consumed */
+			level[i] = node;
+		}
+
+		nnodes = nparents;
+	}
+
+	assert(spare == NULL);
+
+	tree->root = level[0];
+	tree->count = cnt;
+	free(level);
+	return EOK;
+}
+
+/** Move one key from left sibling to @a node.
+ *
+ * @param tree B+tree
+ * @param parent Parent node
+ * @param idx Index of @a node in @a parent
+ * @param left Left sibling of @a node
+ * @param node Node
+ */
+static void borrow_left(bptree_t *tree, bptree_node_t *parent, unsigned idx,
+    bptree_node_t *left, bptree_node_t *node)
+{
+	void **lptrs = node_ptrs(tree, left);
+	void **ptrs = node_ptrs(tree, node);
+
+	if (node->leaf) {
+		node_move(tree, node, 1, node, 0, node->nkeys, 0);
+		memcpy(node_slot(tree, node, 0),
+		    node_slot(tree, left, left->nkeys - 1), tree->slot_size);
+		ptrs[0] = lptrs[left->nkeys - 1];
+		memcpy(node_slot(tree, parent, idx - 1), node_slot(tree, node, 0),
+		    tree->slot_size);
+	} else {
+		node_move(tree, node, 1, node, 0, node->nkeys, 1);
+		ptrs[1] = ptrs[0];
+		memcpy(node_slot(tree, node, 0), node_slot(tree, parent, idx - 1),
+		    tree->slot_size);
+		ptrs[0] = lptrs[left->nkeys];
+		((bptree_node_t *) ptrs[0])->parent = node;
+		memcpy(node_slot(tree, parent, idx - 1),
+		    node_slot(tree, left, left->nkeys - 1), tree->slot_size);
+	}
+
+	--left->nkeys;
+	++node->nkeys;
+}
+
+/** Move one key from right sibling to @a node.
+ *
+ * @param tree B+tree
+ * @param parent Parent node
+ * @param idx Index of @a node in @a parent
+ * @param node Node
+ * @param right Right sibling of @a node
+ */
+static void borrow_right(bptree_t *tree, bptree_node_t *parent, unsigned idx,
+    bptree_node_t *node, bptree_node_t *right)
+{
+	void **rptrs = node_ptrs(tree, right);
+	void **ptrs = node_ptrs(tree, node);
+
+	if (node->leaf) {
+		memcpy(node_slot(tree, node, node->nkeys),
+		    node_slot(tree, right, 0), tree->slot_size);
+		ptrs[node->nkeys] = rptrs[0];
+		node_move(tree, right, 0, right, 1, right->nkeys - 1, 0);
+		memcpy(node_slot(tree, parent, idx), node_slot(tree, right, 0),
+		    tree->slot_size);
+	} else {
+		memcpy(node_slot(tree, node, node->nkeys),
+		    node_slot(tree, parent, idx), tree->slot_size);
+		ptrs[node->nkeys + 1] = rptrs[0];
+		((bptree_node_t *) rptrs[0])->parent = node;
+		memcpy(node_slot(tree, parent, idx), node_slot(tree, right, 0),
+		    tree->slot_size);
+		rptrs[0] = rptrs[1];
+		node_move(tree, right, 0, right, 1, right->nkeys - 1, 1);
+	}
+
+	++node->nkeys;
+	--right->nkeys;
+}
+
+/** Merge node with its right sibling.
+ *
+ * @param tree B+tree
+ * @param parent Parent node
+ * @param idx Index of @a left in @a parent
+ * @param left Node
+ * @param right Right sibling of @a left, freed by this function
+ */
+static void merge(bptree_t *tree, bptree_node_t *parent, unsigned idx,
+    bptree_node_t *left, bptree_node_t *right)
+{
+	void **ptrs = node_ptrs(tree, left);
+	unsigned i;
+
+	if (left->leaf) {
+		node_move(tree, left, left->nkeys, right, 0, right->nkeys, 0);
+		left->nkeys += right->nkeys;
+
+		left->next = right->next;
+		if (right->next != NULL)
+			right->next->prev = left;
+		else
+			tree->last = left;
+	} else {
+		/* The separator comes down between the two halves */
+		memcpy(node_slot(tree, left, left->nkeys),
+		    node_slot(tree, parent, idx), tree->slot_size);
+		ptrs[left->nkeys + 1] = node_ptrs(tree, right)[0];
+		node_move(tree, left, left->nkeys + 1, right, 0, right->nkeys, 1);
+		left->nkeys += right->nkeys + 1;
+
+		for (i = 0; i <= left->nkeys; i++)
+			((bptree_node_t *) ptrs[i])->parent = left;
+	}
+
+	/* Remove separator and right sibling from parent */
+	node_move(tree, parent, idx, parent, idx + 1, parent->nkeys - idx - 1, 1);
+	--parent->nkeys;
+
+	free(right);
+}
+
+/** Restore minimum occupancy of nodes after a removal.
+ *
+ * @param tree B+tree
+ * @param node Node that lost a key
+ */
+static void rebalance(bptree_t *tree, bptree_node_t *node)
+{
+	bptree_node_t *parent;
+	bptree_node_t *left;
+	bptree_node_t *right;
+	unsigned min = tree->order / 2;
+	unsigned idx;
+
+	while (node->parent != NULL && node->nkeys < min) {
+		parent = node->parent;
+		idx = child_index(tree, parent, node);
+		left = idx > 0 ? node_ptrs(tree, parent)[idx - 1] : NULL;
+		right = idx < parent->nkeys ?
+		    node_ptrs(tree, parent)[idx + 1] : NULL;
+
+		if (left != NULL && left->nkeys > min) {
+			borrow_left(tree, parent, idx, left, node);
+			return;
+		}
+
+		if (right != NULL && right->nkeys > min) {
+			borrow_right(tree, parent, idx, node, right);
+			return;
+		}
+
+		if (left != NULL)
+			merge(tree, parent, idx - 1, left, node);
+		else
+			merge(tree, parent, idx, node, right);
+
+		node = parent;
+	}
+
+	if (node->parent != NULL || node->nkeys > 0)
+		return;
+
+	/* Root lost its last key */
+	if (node->leaf) {
+		tree->root = NULL;
+		tree->first = NULL;
+		tree->last = NULL;
+	} else {
+		tree->root = node_ptrs(tree, node)[0];
+		tree->root->parent = NULL;
+	}
+
+	free(node);
+}
+
+/** Redirect separator pointing to the key of a removed item.
+ *
+ * Only used with key pointers. The removed item was the first in its
+ * leaf, so it was the first item in the subtree to the right of one
+ * separator unless the leaf is the first one in the tree. That separator
+ * is in the nearest ancestor in which the leaf is not in the leftmost
+ * subtree.
+ *
+ * @param tree B+tree
+ * @param leaf Leaf that lost its first item (and still has some)
+ * @param key Key pointer of the removed item
+ */
+static void separator_update(bptree_t *tree, bptree_node_t *leaf, void *key)
+{
+	bptree_node_t *node = leaf;
+	uint8_t *slot;
+	unsigned idx;
+
+	while (node->parent != NULL) {
+		idx = child_index(tree, node->parent, node);
+		if (idx > 0) {
+			slot = node_slot(tree, node->parent, idx - 1);
+			assert(*(void **) slot == key);
+			*(void **) slot = *(void **) node_slot(tree, leaf, 0);
+			return;
+		}
+
+		node = node->parent;
+	}
+}
+
+/** Remove item from B+tree.
+ *
+ * @param tree B+tree
+ * @param item Item, must be in the tree
+ */
+void bptree_remove(bptree_t *tree, void *item)
+{
+	bptree_iter_t iter;
+	bptree_node_t *leaf;
+	void *key = tree->getkey(item);
+
+	/* Find the item among those with an equal key */
+	iter_bound(tree, key, false, &iter);
+	while (iter_item(&iter) != item) {
+		assert(iter.node != NULL);
+		(void) bptree_next(&iter);
+	}
+
+	leaf = iter.node;
+	node_move(tree, leaf, iter.idx, leaf, iter.idx + 1,
+	    leaf->nkeys - iter.idx - 1, 0);
+	--leaf->nkeys;
+	--tree->count;
+
+	/* Only the root leaf can become empty, it has no separators */
+	if (tree->key_size == 0 && iter.idx == 0 && leaf->parent != NULL)
+		separator_update(tree, leaf, key);
+
+	rebalance(tree, leaf);
+}
+
+/** Return @c true if B+tree is empty. */
+bool bptree_empty(bptree_t *tree)
+{
+	return tree->count == 0;
+}
+
+/** Return number of items in B+tree. */
+size_t bptree_count(bptree_t *tree)
+{
+	return tree->count;
+}
+
+/** Get first item.
+ *
+ * @param tree B+tree
+ * @param iter Place to store position or @c NULL
+ * @return First item or @c NULL if the tree is empty
+ */
+void *bptree_first(bptree_t *tree, bptree_iter_t *iter)
+{
+	bptree_iter_t it;
+
+	if (iter == NULL)
+		iter = &it;
+
+	iter->tree = tree;
+	iter->node = tree->first;
+	iter->idx = 0;
+	return iter_item(iter);
+}
+
+/** Get last item.
+ *
+ * @param tree B+tree
+ * @param iter Place to store position or @c NULL
+ * @return Last item or @c NULL if the tree is empty
+ */
+void *bptree_last(bptree_t *tree, bptree_iter_t *iter)
+{
+	bptree_iter_t it;
+
+	if (iter == NULL)
+		iter = &it;
+
+	iter->tree = tree;
+	iter->node = NULL;
+	iter->idx = 0;
+	return iter_back(iter);
+}
+
+/** Move to next item.
+ *
+ * @param iter Position
+ * @return Next item or @c NULL if there is none
+ */
+void *bptree_next(bptree_iter_t *iter)
+{
+	if (iter->node == NULL)
+		return NULL;
+
+	if (++iter->idx == iter->node->nkeys) {
+		iter->node = iter->node->next;
+		iter->idx = 0;
+	}
+
+	return iter_item(iter);
+}
+
+/** Move to previous item.
+ *
+ * @param iter Position
+ * @return Previous item or @c NULL if there is none
+ */
+void *bptree_prev(bptree_iter_t *iter)
+{
+	if (iter->node == NULL)
+		return NULL;
+
+	return iter_back(iter);
+}
+
+/** Find first item whose key is equal to @a key.
+ *
+ * @param tree B+tree
+ * @param key Key
+ * @param iter Place to store position or @c NULL
+ * @return Item or @c NULL if there is none
+ */
+void *bptree_find_eq(bptree_t *tree, const void *key,
+    bptree_iter_t *iter)
+{
+	bptree_iter_t it;
+
+	if (iter == NULL)
+		iter = &it;
+
+	iter_bound(tree, key, false, iter);
+	if (iter->node == NULL ||
+	    tree->cmp(node_key(tree, iter->node, iter->idx), key) != 0)
+		return NULL;
+
+	return iter_item(iter);
+}
+
+/** Find first item whose key is greater than or equal to @a key.
+ *
+ * @param tree B+tree
+ * @param key Key
+ * @param iter Place to store position or @c NULL
+ * @return Item or @c NULL if there is none
+ */
+void *bptree_find_geq(bptree_t *tree, const void *key,
+    bptree_iter_t *iter)
+{
+	bptree_iter_t it;
+
+	if (iter == NULL)
+		iter = &it;
+
+	iter_bound(tree, key, false, iter);
+	return iter_item(iter);
+}
+
+/** Find first item whose key is greater than @a key.
+ *
+ * @param tree B+tree
+ * @param key Key
+ * @param iter Place to store position or @c NULL
+ * @return Item or @c NULL if there is none
+ */
+void *bptree_find_gt(bptree_t *tree, const void *key,
+    bptree_iter_t *iter)
+{
+	bptree_iter_t it;
+
+	if (iter == NULL)
+		iter = &it;
+
+	iter_bound(tree, key, true, iter);
+	return iter_item(iter);
+}
+
+/** Find last item whose key is less than or equal to @a key.
+ *
+ * @param tree B+tree
+ * @param key Key
+ * @param iter Place to store position or @c NULL
+ * @return Item or @c NULL if there is none
+ */
+void *bptree_find_leq(bptree_t *tree, const void *key,
+    bptree_iter_t *iter)
+{
+	bptree_iter_t it;
+
+	if (iter == NULL)
+		iter = &it;
+
+	iter_bound(tree, key, true, iter);
+	return iter_back(iter);
+}
+
+/** Find last item whose key is less than @a key.
+ *
+ * @param tree B+tree
+ * @param key Key
+ * @param iter Place to store position or @c NULL
+ * @return Item or @c NULL if there is none
+ */
+void *bptree_find_lt(bptree_t *tree, const void *key,
+    bptree_iter_t *iter)
+{
+	bptree_iter_t it;
+
+	if (iter == NULL)
+		iter = &it;
+
+	iter_bound(tree, key, false, iter);
+	return iter_back(iter);
+}
+
+/** Validate subtree.
+ *
+ * @param tree B+tree
+ * @param node Root of subtree
+ * @param depth Depth of @a node
+ * @param ldepth Place holding the depth of leaves (-1 if not known yet)
+ * @param lo Lower bound for keys in the subtree or @c NULL
+ * @param hi Upper bound for keys in the subtree or @c NULL
+ * @return EOK on success, EINVAL on failure
+ */
+static errno_t subtree_validate(bptree_t *tree, bptree_node_t *node,
+    int depth, int *ldepth, void *lo, void *hi)
+{
+	bptree_node_t *child;
+	bptree_node_t *first;
+	errno_t rc;
+	unsigned i;
+
+	if (node->nkeys > tree->order)
+		return EINVAL;
+
+	if (node->parent != NULL && node->nkeys < tree->order / 2)
+		return EINVAL;
+
+	for (i = 0; i < node->nkeys; i++) {
+		if (lo != NULL && tree->cmp(lo, node_key(tree, node, i)) > 0)
+			return EINVAL;
+		if (hi != NULL && tree->cmp(node_key(tree, node, i), hi) > 0)
+			return EINVAL;
+		if (i > 0 && tree->cmp(node_key(tree, node, i - 1),
+		    node_key(tree, node, i)) > 0)
+			return EINVAL;
+	}
+
+	if (node->leaf) {
+		if (*ldepth < 0)
+			*ldepth = depth;
+		if (*ldepth != depth || node->nkeys == 0)
+			return EINVAL;
+
+		for (i = 0; i < node->nkeys; i++) {
+			if (tree->cmp(node_key(tree, node, i),
+			    tree->getkey(node_ptrs(tree, node)[i])) != 0)
+				return EINVAL;
+		}
+
+		return EOK;
+	}
+
+	if (node->nkeys == 0)
+		return EINVAL;
+
+	for (i = 0; i <= node->nkeys; i++) {
+		child = node_ptrs(tree, node)[i];
+		if (child->parent != node)
+			return EINVAL;
+
+		if (tree->key_size == 0 && i > 0) {
+			/* Key pointer must refer to the first item in child */
+			first = child;
+			while (!first->leaf)
+				first = node_ptrs(tree, first)[0];
+
+			if (first->nkeys == 0 || node_key(tree, node, i - 1) !=
+			    node_key(tree, first, 0))
+				return EINVAL;
+		}
+
+		rc = subtree_validate(tree, child, depth + 1, ldepth,
+		    i > 0 ? node_key(tree, node, i - 1) : lo,
+		    i < node->nkeys ? node_key(tree, node, i) : hi);
+		if (rc != EOK)
+			return rc;
+	}
+
+	return EOK;
+}
+
+/** Validate B+tree.
+ *
+ * Verify that the tree structure is consistent.
+ *
+ * @param tree B+tree
+ * @return EOK on success, EINVAL on failure
+ */
+errno_t bptree_validate(bptree_t *tree)
+{
+	bptree_node_t *leaf;
+	bptree_node_t *prev;
+	void *item;
+	void *pitem;
+	size_t cnt;
+	int ldepth = -1;
+	errno_t rc;
+	unsigned i;
+
+	if (tree->root == NULL) {
+		if (tree->count != 0 || tree->first != NULL ||
+		    tree->last != NULL)
+			return EINVAL;
+		return EOK;
+	}
+
+	if (tree->root->parent != NULL)
+		return EINVAL;
+
+	rc = subtree_validate(tree, tree->root, 0, &ldepth, NULL, NULL);
+	if (rc != EOK)
+		return rc;
+
+	/* Leaf list must contain all items in order */
+	cnt = 0;
+	prev = NULL;
+	pitem = NULL;
+	for (leaf = tree->first; leaf != NULL; leaf = leaf->next) {
+		if (!leaf->leaf || leaf->prev != prev)
+			return EINVAL;
+
+		for (i = 0; i < leaf->nkeys; i++) {
+			item = node_ptrs(tree, leaf)[i];
+			if (pitem != NULL && tree->cmp(tree->getkey(pitem),
+			    tree->getkey(item)) > 0)
+				return EINVAL;
+
+			pitem = item;
+			++cnt;
+		}
+
+		prev = leaf;
+	}
+
+	if (prev != tree->last || cnt != tree->count)
+		return EINVAL;
+
+	return EOK;
+}
+
+/** @}
+ */
@@ -0,0 +1,664 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libc
+ * @{
+ */
+/** @file Open addressing hash table
+ */
+
+/*
+ * This is an open addressing hash table in the style of the "Swiss
+ * table". Slots are organized in groups of FH_GROUP consecutive slots.
+ * Each slot has a one byte control word which is either FH_EMPTY,
+ * FH_DELETED or, for a full slot, the low seven bits (h2) of the item's
+ * hash. The remaining bits (h1) select the group where probing starts.
+ *
+ * Lookup compares the control bytes of a whole group against h2 at once
+ * (with SSE2 where available, otherwise with 64-bit word arithmetic) and
+ * only calls key_equal() on the few candidates that match. Probing moves
+ * on to the next group in a triangular sequence, which visits every group
+ * because the number of groups is a power of two. It stops at the first
+ * group containing an empty slot.
+ *
+ * A removed item leaves an FH_DELETED tombstone, unless its group still
+ * contains an empty slot (then no probe sequence can pass through the
+ * group and the slot can become empty again). At most 7/8 of the slots
+ * are ever in use, which keeps probe sequences short and guarantees
+ * that every probe terminates.
+ *
+ * Compared to the chained hash_table, items need not embed a link and
+ * a lookup touches only the control bytes and slots of one or two
+ * groups in the common case, instead of chasing a list of pointers.
+ * On the other hand the table stores pointers only and growing it may
+ * fail for lack of memory.
+ */
+
+#include <adt/flat_hash.h>
+#include <adt/hash.h>
+#include <assert.h>
+#include <byteorder.h>
+#include <errno.h>
+#include <mem.h>
+#include <stdlib.h>
+
+/** Control byte of an empty slot */
+#define FH_EMPTY    0x80
+/** Control byte of a slot whose item has been removed */
+#define FH_DELETED  0xfe
+
+#ifdef __SSE2__
+
+/** Number of slots in a group */
+#define FH_GROUP  16
+
+/** Bit mask of matching slots within a group (one bit per slot) */
+typedef uint32_t fh_mask_t;
+
+typedef uint8_t fh_vec_t __attribute__((vector_size(16), aligned(1),
+    may_alias));
+typedef char fh_v16qi_t __attribute__((vector_size(16)));
+
+/** Find slots of a group whose control byte equals @a c. */
+static inline fh_mask_t group_match(const uint8_t *ctrl, uint8_t c)
+{
+	fh_vec_t g = *(const fh_vec_t *) ctrl;
+	fh_vec_t v = {
+		c, c, c, c, c, c, c, c, c, c, c, c, c, c, c, c
+	};
+
+	return __builtin_ia32_pmovmskb128((fh_v16qi_t) (g == v));
+}
+
+/** Find empty slots in a group. */
+static inline fh_mask_t group_match_empty(const uint8_t *ctrl)
+{
+	return group_match(ctrl, FH_EMPTY);
+}
+
+/** Find empty or deleted slots in a group. */
+static inline fh_mask_t group_match_free(const uint8_t *ctrl)
+{
+	fh_vec_t g = *(const fh_vec_t *) ctrl;
+
+	/* Exactly the free slots have the most significant bit set. */
+	return __builtin_ia32_pmovmskb128((fh_v16qi_t) g);
+}
+
+/** Remove the lowest set bit from @a mask and return its slot index. */
+static inline size_t mask_next(fh_mask_t *mask)
+{
+	size_t idx = __builtin_ctz(*mask);
+
+	*mask &= *mask - 1;
+	return idx;
+}
+
+#else
+
+/** Number of slots in a group */
+#define FH_GROUP  8
+
+/** Bit mask of matching slots within a group (bit 7 of each byte) */
+typedef uint64_t fh_mask_t;
+
+#define FH_LSBS  UINT64_C(0x0101010101010101)
+#define FH_MSBS  UINT64_C(0x8080808080808080)
+
+/** Load control bytes of a group, first slot in the lowest byte. */
+static inline uint64_t group_load(const uint8_t *ctrl)
+{
+	uint64_t g;
+
+	memcpy(&g, ctrl, sizeof(g));
+	return uint64_t_le2host(g);
+}
+
+/** Find slots of a group whose control byte equals @a c.
+ *
+ * May report false positives, but only for slots that are full, so
+ * that candidates must be verified by comparing keys anyway.
+ */
+static inline fh_mask_t group_match(const uint8_t *ctrl, uint8_t c)
+{
+	uint64_t x = group_load(ctrl) ^ (FH_LSBS * c);
+
+	return (x - FH_LSBS) & ~x & FH_MSBS;
+}
+
+/** Find empty slots in a group. */
+static inline fh_mask_t group_match_empty(const uint8_t *ctrl)
+{
+	uint64_t g = group_load(ctrl);
+
+	/* FH_EMPTY is the only control byte with bit 7 set and bit 1 clear */
+	return g & ~(g << 6) & FH_MSBS;
+}
+
+/** Find empty or deleted slots in a group. */
+static inline fh_mask_t group_match_free(const uint8_t *ctrl)
+{
+	return group_load(ctrl) & FH_MSBS;
+}
+
+/** Remove the lowest set bit from @a mask and return its slot index. */
+static inline size_t mask_next(fh_mask_t *mask)
+{
+	size_t idx = __builtin_ctzll(*mask) / 8;
+
+	*mask &= *mask - 1;
+	return idx;
+}
+
+#endif
+
+/** Minimum number of slots */
+#define FH_MIN_SLOTS  (2 * FH_GROUP)
+
+/** Mix the user-supplied hash, which may be of poor quality. */
+static inline size_t fh_hash(size_t hash)
+{
+	return hash_mix(hash);
+}
+
+/** Control byte of a full slot holding an item with the given hash. */
+static inline uint8_t fh_h2(size_t hash)
+{
+	return hash & 0x7f;
+}
+
+/** Number of items that fit in a table with @a slot_cnt slots. */
+static inline size_t fh_capacity(size_t slot_cnt)
+{
+	return slot_cnt - slot_cnt / 8;
+}
+
+/** Probe sequence over the groups of a table. */
+typedef struct {
+	/** Index of the first slot of the current group */
+	size_t pos;
+	/** Number of groups visited so far */
+	size_t step;
+	/** Mask for slot indices */
+	size_t mask;
+} fh_probe_t;
+
+/** Start probe sequence for the given hash. */
+static inline void probe_start(fh_probe_t *probe, size_t slot_cnt, size_t hash)
+{
+	probe->mask = slot_cnt - 1;
+	probe->pos = ((hash >> 7) * FH_GROUP) & probe->mask;
+	probe->step = 0;
+}
+
+/** Move to the next group of a probe sequence. */
+static inline void probe_next(fh_probe_t *probe)
+{
+	++probe->step;
+	assert(probe->step * FH_GROUP <= probe->mask);
+	probe->pos = (probe->pos + probe->step * FH_GROUP) & probe->mask;
+}
+
+/** Allocate slot and control arrays, all slots empty. */
+static bool alloc_table(size_t slot_cnt, void ***rslot, uint8_t **rctrl)
+{
+	void **slot;
+
+	assert(slot_cnt >= FH_MIN_SLOTS);
+	assert((slot_cnt & (slot_cnt - 1)) == 0);
+
+	/* Control bytes follow the slots in the same allocation. */
+	slot = malloc(slot_cnt * (sizeof(void *) + 1));
+	if (slot == NULL)
+		return false;
+
+	*rslot = slot;
+	*rctrl = (uint8_t *) (slot + slot_cnt);
+	memset(*rctrl, FH_EMPTY, slot_cnt);
+	return true;
+}
+
+/** Find an empty or deleted slot for an item with the given hash. */
+static size_t find_free(uint8_t *ctrl, size_t slot_cnt, size_t hash)
+{
+	fh_probe_t probe;
+	fh_mask_t mask;
+
+	probe_start(&probe, slot_cnt, hash);
+
+	while (true) {
+		mask = group_match_free(ctrl + probe.pos);
+		if (mask != 0)
+			return probe.pos + mask_next(&mask);
+
+		probe_next(&probe);
+	}
+}
+
+/** Move all items to new arrays of @a slot_cnt slots. */
+static bool rehash(flat_hash_t *h, size_t slot_cnt)
+{
+	void **slot;
+	uint8_t *ctrl;
+	size_t i;
+
+	if (!alloc_table(slot_cnt, &slot, &ctrl))
+		return false;
+
+	for (i = 0; i < h->slot_cnt; i++) {
+		if ((h->ctrl[i] & FH_EMPTY) != 0)
+			continue;
+
+		size_t hash = fh_hash(h->op->hash(h->slot[i]));
+		size_t idx = find_free(ctrl, slot_cnt, hash);
+
+		ctrl[idx] = fh_h2(hash);
+		slot[idx] = h->slot[i];
+	}
+
+	free(h->slot);
+	h->slot = slot;
+	h->ctrl = ctrl;
+	h->slot_cnt = slot_cnt;
+	h->growth_left = fh_capacity(slot_cnt) - h->item_cnt;
+	return true;
+}
+
+/** Make room for one more item.
+ *
+ * If much of the table is taken by tombstones, rehash it at the same
+ * size to get rid of them, otherwise double its size.
+ */
+static bool reserve_one(flat_hash_t *h)
+{
+	if (h->item_cnt < fh_capacity(h->slot_cnt) / 2)
+		return rehash(h, h->slot_cnt);
+
+	return rehash(h, 2 * h->slot_cnt);
+}
+
+/** Create open addressing hash table.
+ *
+ * @param h         Hash table structure. Will be initialized by this call.
+ * @param init_size Number of items the table should hold without growing.
+ *                  Pass zero if you want the default initial size.
+ * @param op        Hash table operations structure. remove_callback()
+ *                  is optional and can be NULL if no action is to be taken
+ *                  upon removal. equal() is optional if and only if
+ *                  flat_hash_insert_unique() will never be invoked.
+ *                  All other operations are mandatory.
+ *
+ * @return True on success
+ */
+bool flat_hash_create(flat_hash_t *h, size_t init_size,
+    const flat_hash_ops_t *op)
+{
+	size_t slot_cnt = FH_MIN_SLOTS;
+
+	assert(h);
+	assert(op && op->hash && op->key_hash && op->key_equal);
+
+	/* Check for compulsory ops. */
+	if (!op || !op->hash || !op->key_hash || !op->key_equal)
+		return false;
+
+	while (fh_capacity(slot_cnt) < init_size)
+		slot_cnt *= 2;
+
+	if (!alloc_table(slot_cnt, &h->slot, &h->ctrl))
+		return false;
+
+	h->op = op;
+	h->slot_cnt = slot_cnt;
+	h->item_cnt = 0;
+	h->growth_left = fh_capacity(slot_cnt);
+	h->apply_ongoing = false;
+	return true;
+}
+
+/** Destroy a hash table instance.
+ *
+ * Calls remove_callback() for all items still in the table.
+ *
+ * @param h Hash table to be destroyed.
+ */
+void flat_hash_destroy(flat_hash_t *h)
+{
+	assert(h && h->slot);
+	assert(!h->apply_ongoing);
+
+	flat_hash_clear(h);
+	free(h->slot);
+
+	h->slot = NULL;
+	h->ctrl = NULL;
+	h->slot_cnt = 0;
+}
+
+/** Returns true if there are no items in the table. */
+bool flat_hash_empty(flat_hash_t *h)
+{
+	assert(h && h->slot);
+	return h->item_cnt == 0;
+}
+
+/** Returns the number of items in the table. */
+size_t flat_hash_size(flat_hash_t *h)
+{
+	assert(h && h->slot);
+	return h->item_cnt;
+}
+
+/** Remove all items from the hash table.
+ *
+ * @param h Hash table to be cleared
+ */
+void flat_hash_clear(flat_hash_t *h)
+{
+	void **slot;
+	uint8_t *ctrl;
+	size_t i;
+
+	assert(h && h->slot);
+	assert(!h->apply_ongoing);
+
+	if (h->op->remove_callback != NULL && h->item_cnt > 0) {
+		for (i = 0; i < h->slot_cnt; i++) {
+			if ((h->ctrl[i] & FH_EMPTY) == 0)
+				h->op->remove_callback(h->slot[i]);
+		}
+	}
+
+	h->item_cnt = 0;
+
+	/* Shrink the table to its minimum size if possible. */
+	if (h->slot_cnt > FH_MIN_SLOTS &&
+	    alloc_table(FH_MIN_SLOTS, &slot, &ctrl)) {
+		free(h->slot);
+		h->slot = slot;
+		h->ctrl = ctrl;
+		h->slot_cnt = FH_MIN_SLOTS;
+	} else {
+		memset(h->ctrl, FH_EMPTY, h->slot_cnt);
+	}
+
+	h->growth_left = fh_capacity(h->slot_cnt);
+}
+
+/** Store item in a free slot. */
+static errno_t insert_hashed(flat_hash_t *h, void *item, size_t hash)
+{
+	size_t idx;
+
+	idx = find_free(h->ctrl, h->slot_cnt, hash);
+
+	/* Reusing a tombstone does not make probe sequences longer. */
+	if (h->ctrl[idx] == FH_EMPTY) {
+		if (h->growth_left == 0) {
+			if (!reserve_one(h))
+				return ENOMEM;
+
+			idx = find_free(h->ctrl, h->slot_cnt, hash);
+		}
+
+		if (h->ctrl[idx] == FH_EMPTY)
+			--h->growth_left;
+	}
+
+	h->ctrl[idx] = fh_h2(hash);
+	h->slot[idx] = item;
+	++h->item_cnt;
+	return EOK;
+}
+
+/** Insert item into a hash table.
+ *
+ * @param h    Hash table.
+ * @param item Item to be inserted into the hash table.
+ *
+ * @return EOK on success, ENOMEM if the table needed to grow and there
+ *         was not enough memory
+ */
+errno_t flat_hash_insert(flat_hash_t *h, void *item)
+{
+	assert(item);
+	assert(h && h->slot);
+	assert(!h->apply_ongoing);
+
+	return insert_hashed(h, item, fh_hash(h->op->hash(item)));
+}
+
+/** Insert item into a hash table if not already present.
+ *
+ * @param h    Hash table.
+ * @param item Item to be inserted into the hash table.
+ *
+ * @return EOK on success, EEXIST if an item with the same lookup key
+ *         is already present, ENOMEM if out of memory
+ */
+errno_t flat_hash_insert_unique(flat_hash_t *h, void *item)
+{
+	fh_probe_t probe;
+	fh_mask_t mask;
+	size_t hash;
+	size_t idx;
+
+	assert(item);
+	assert(h && h->slot);
+	assert(h->op && h->op->equal);
+	assert(!h->apply_ongoing);
+
+	hash = fh_hash(h->op->hash(item));
+	probe_start(&probe, h->slot_cnt, hash);
+
+	while (true) {
+		mask = group_match(h->ctrl + probe.pos, fh_h2(hash));
+		while (mask != 0) {
+			idx = probe.pos + mask_next(&mask);
+			if (h->op->equal(h->slot[idx], item))
+				return EEXIST;
+		}
+
+		if (group_match_empty(h->ctrl + probe.pos) != 0)
+			break;
+
+		probe_next(&probe);
+	}
+
+	return insert_hashed(h, item, hash);
+}
+
+/** Search hash table for an item matching key.
+ *
+ * @param h   Hash table.
+ * @param key Key to look for.
+ *
+ * @return Matching item on success, NULL if there is no such item.
+ */
+void *flat_hash_find(const flat_hash_t *h, const void *key)
+{
+	fh_probe_t probe;
+	fh_mask_t mask;
+	size_t hash;
+	size_t idx;
+
+	assert(h && h->slot);
+
+	hash = fh_hash(h->op->key_hash(key));
+	probe_start(&probe, h->slot_cnt, hash);
+
+	while (true) {
+		mask = group_match(h->ctrl + probe.pos, fh_h2(hash));
+		while (mask != 0) {
+			idx = probe.pos + mask_next(&mask);
+			if (h->op->key_equal(key, h->slot[idx]))
+				return h->slot[idx];
+		}
+
+		if (group_match_empty(h->ctrl + probe.pos) != 0)
+			return NULL;
+
+		probe_next(&probe);
+	}
+}
+
+/** Free slot of a removed item.
+ *
+ * If the group has an empty slot, no probe sequence continues past
+ * it and the slot can become empty too. Otherwise a tombstone must be
+ * left so that lookups of items further along the sequence succeed.
+ */
+static void erase_slot(flat_hash_t *h, size_t group, size_t idx)
+{
+	if (group_match_empty(h->ctrl + group) != 0) {
+		h->ctrl[idx] = FH_EMPTY;
+		++h->growth_left;
+	} else {
+		h->ctrl[idx] = FH_DELETED;
+	}
+
+	--h->item_cnt;
+}
+
+/** Remove all matching items from hash table.
+ *
+ * For each removed item, h->remove_callback() is called.
+ *
+ * @param h   Hash table.
+ * @param key Key that will be compared against items of the hash table.
+ *
+ * @return Returns the number of removed items.
+ */
+size_t flat_hash_remove(flat_hash_t *h, const void *key)
+{
+	fh_probe_t probe;
+	fh_mask_t mask;
+	size_t removed = 0;
+	size_t hash;
+	size_t idx;
+	void *item;
+	bool last;
+
+	assert(h && h->slot);
+	assert(!h->apply_ongoing);
+
+	hash = fh_hash(h->op->key_hash(key));
+	probe_start(&probe, h->slot_cnt, hash);
+
+	while (true) {
+		/* Removal does not change whether the group has an empty slot */
+		last = group_match_empty(h->ctrl + probe.pos) != 0;
+
+		mask = group_match(h->ctrl + probe.pos, fh_h2(hash));
+		while (mask != 0) {
+			idx = probe.pos + mask_next(&mask);
+			item = h->slot[idx];
+
+			if (h->op->key_equal(key, item)) {
+				erase_slot(h, probe.pos, idx);
+				++removed;
+
+				if (h->op->remove_callback)
+					h->op->remove_callback(item);
+			}
+		}
+
+		if (last)
+			return removed;
+
+		probe_next(&probe);
+	}
+}
+
+/** Remove an item already present in the table.
+ *
+ * @param h    Hash table.
+ * @param item Item to remove. Must be in the table.
+ */
+void flat_hash_remove_item(flat_hash_t *h, void *item)
+{
+	fh_probe_t probe;
+	fh_mask_t mask;
+	size_t hash;
+	size_t idx;
+
+	assert(item);
+	assert(h && h->slot);
+
+	hash = fh_hash(h->op->hash(item));
+	probe_start(&probe, h->slot_cnt, hash);
+
+	while (true) {
+		mask = group_match(h->ctrl + probe.pos, fh_h2(hash));
+		while (mask != 0) {
+			idx = probe.pos + mask_next(&mask);
+			if (h->slot[idx] == item) {
+				erase_slot(h, probe.pos, idx);
+
+				if (h->op->remove_callback)
+					h->op->remove_callback(item);
+				return;
+			}
+		}
+
+		/* The item must be in the table. */
+		assert(group_match_empty(h->ctrl + probe.pos) == 0);
+		probe_next(&probe);
+	}
+}
+
+/** Apply function to all items in hash table.
+ *
+ * @param h   Hash table.
+ * @param f   Function to be applied. Return false if no more items
+ *            should be visited. The functor may only remove the supplied
+ *            item.
+ * @param arg Argument to be passed to the function.
+ */
+void flat_hash_apply(flat_hash_t *h, bool (*f)(void *, void *), void *arg)
+{
+	size_t i;
+
+	assert(f);
+	assert(h && h->slot);
+
+	h->apply_ongoing = true;
+
+	for (i = 0; i < h->slot_cnt && h->item_cnt > 0; i++) {
+		if ((h->ctrl[i] & FH_EMPTY) != 0)
+			continue;
+
+		if (!f(h->slot[i], arg))
+			break;
+	}
+
+	h->apply_ongoing = false;
+}
+
+/** @}
+ */
@@ -46,6 +46,14 @@
  * have fairly large (prime/odd) divisors. Having a prime table size
  * mitigates the use of suboptimal hash functions and distributes
  * items over the whole table.
+ *
+ * Resizing is incremental. A resize only allocates the new bucket array
+ * and each subsequent operation that modifies the table migrates
+ * HT_MIGRATE_STEP buckets of the old array, so no single insertion or
+ * removal has to rehash the whole table. While the migration is under
+ * way, an item lives in its old bucket unless that bucket has already
+ * been migrated. Items with equal keys thus always share one bucket
+ * and every lookup still examines only a single chain.
  */
 
 #include <adt/hash_table.h>
@@ -58,11 +66,14 @@
 #define HT_MIN_BUCKETS  89
 /* The table is resized when the average load per bucket exceeds this number. */
 #define HT_MAX_LOAD     2
+/* Number of old buckets migrated by each modifying operation during resize. */
+#define HT_MIGRATE_STEP  4
 
 static size_t round_up_size(size_t);
 static bool alloc_table(size_t, list_t **);
 static void clear_items(hash_table_t *);
 static void resize(hash_table_t *, size_t);
+static void migrate_step(hash_table_t *);
 static void grow_if_needed(hash_table_t *);
 static void shrink_if_needed(hash_table_t *);
 
@@ -103,6 +114,9 @@ bool hash_table_create(hash_table_t *h, size_t init_size, size_t max_load,
 	if (!alloc_table(h->bucket_cnt, &h->bucket))
 		return false;
 
+	h->old_bucket = NULL;
+	h->old_bucket_cnt = 0;
+	h->migrate_idx = 0;
 	h->max_load = (max_load == 0) ? HT_MAX_LOAD : max_load;
 	h->item_cnt = 0;
 	h->op = op;
@@ -124,8 +138,11 @@ void hash_table_destroy(hash_table_t *h)
 
 	clear_items(h);
 
+	if (h->old_bucket)
+		free(h->old_bucket);
 	free(h->bucket);
 
+	h->old_bucket = NULL;
 	h->bucket = NULL;
 	h->bucket_cnt = 0;
 }
@@ -155,12 +172,34 @@ void hash_table_clear(hash_table_t *h)
 
 	clear_items(h);
 
+	/* All old buckets are empty now, abort the migration. */
+	if (h->old_bucket) {
+		free(h->old_bucket);
+		h->old_bucket = NULL;
+		h->old_bucket_cnt = 0;
+	}
+
 	/* Shrink the table to its minimum size if possible. */
 	if (HT_MIN_BUCKETS < h->bucket_cnt) {
 		resize(h, HT_MIN_BUCKETS);
 	}
 }
 
+/** Unlinks and removes all items of a bucket array. */
+static void clear_buckets(list_t *buckets, size_t bucket_cnt,
+    void (*remove_cb)(ht_link_t *))
+{
+	for (size_t idx = 0; idx < bucket_cnt; ++idx) {
+		list_foreach_safe(buckets[idx], cur, next) {
+			assert(cur);
+			ht_link_t *cur_link = member_to_inst(cur, ht_link_t, link);
+
+			list_remove(cur);
+			remove_cb(cur_link);
+		}
+	}
+}
+
 /** Unlinks and removes all items but does not resize. */
 static void clear_items(hash_table_t *h)
 {
@@ -169,19 +208,33 @@ static void clear_items(hash_table_t *h)
 
 	void (*remove_cb)(ht_link_t *) = h->op->remove_callback ? h->op->remove_callback : nop_remove_callback;
 
-	for (size_t idx = 0; idx < h->bucket_cnt; ++idx) {
-		list_foreach_safe(h->bucket[idx], cur, next) {
-			assert(cur);
-			ht_link_t *cur_link = member_to_inst(cur, ht_link_t, link);
-
-			list_remove(cur);
-			remove_cb(cur_link);
-		}
+	if (h->old_bucket) {
+		clear_buckets(h->old_bucket + h->migrate_idx,
+		    h->old_bucket_cnt - h->migrate_idx, remove_cb);
 	}
 
+	clear_buckets(h->bucket, h->bucket_cnt, remove_cb);
+
 	h->item_cnt = 0;
 }
 
+/** Returns the bucket holding items with the given hash.
+ *
+ * During resize this is the old bucket, unless it has already been
+ * migrated to the new bucket array.
+ */
+static inline list_t *get_bucket(const hash_table_t *h, size_t hash)
+{
+	if (h->old_bucket) {
+		size_t old_idx = hash % h->old_bucket_cnt;
+
+		if (h->migrate_idx <= old_idx)
+			return &h->old_bucket[old_idx];
+	}
+
+	return &h->bucket[hash % h->bucket_cnt];
+}
+
 /** Insert item into a hash table.
  *
  * @param h    Hash table.
@@ -193,10 +246,9 @@ void hash_table_insert(hash_table_t *h, ht_link_t *item)
 	assert(h && h->bucket);
 	assert(!h->apply_ongoing);
 
-	size_t idx = h->op->hash(item) % h->bucket_cnt;
-
-	list_append(&item->link, &h->bucket[idx]);
+	list_append(&item->link, get_bucket(h, h->op->hash(item)));
 	++h->item_cnt;
+	migrate_step(h);
 	grow_if_needed(h);
 }
 
@@ -215,10 +267,10 @@ bool hash_table_insert_unique(hash_table_t *h, ht_link_t *item)
 	assert(h->op && h->op->hash && h->op->equal);
 	assert(!h->apply_ongoing);
 
-	size_t idx = h->op->hash(item) % h->bucket_cnt;
+	list_t *bucket = get_bucket(h, h->op->hash(item));
 
 	/* Check for duplicates. */
-	list_foreach(h->bucket[idx], link, ht_link_t, cur_link) {
+	list_foreach(*bucket, link, ht_link_t, cur_link) {
 		/*
 		 * We could filter out items using their hashes first, but
 		 * calling equal() might very well be just as fast.
@@ -227,8 +279,9 @@ bool hash_table_insert_unique(hash_table_t *h, ht_link_t *item)
 			return false;
 	}
 
-	list_append(&item->link, &h->bucket[idx]);
+	list_append(&item->link, bucket);
 	++h->item_cnt;
+	migrate_step(h);
 	grow_if_needed(h);
 
 	return true;
@@ -246,9 +299,9 @@ ht_link_t *hash_table_find(const hash_table_t *h, const void *key)
 {
 	assert(h && h->bucket);
 
-	size_t idx = h->op->key_hash(key) % h->bucket_cnt;
+	list_t *bucket = get_bucket(h, h->op->key_hash(key));
 
-	list_foreach(h->bucket[idx], link, ht_link_t, cur_link) {
+	list_foreach(*bucket, link, ht_link_t, cur_link) {
 		/*
 		 * Is this is the item we are looking for? We could have first
 		 * checked if the hashes match but op->key_equal() may very well be
@@ -269,14 +322,14 @@ hash_table_find_next(const hash_table_t *h, ht_link_t *first, ht_link_t *item)
 	assert(item);
 	assert(h && h->bucket);
 
-	size_t idx = h->op->hash(item) % h->bucket_cnt;
+	list_t *bucket = get_bucket(h, h->op->hash(item));
 
 	/* Traverse the circular list until we reach the starting item again. */
 	for (link_t *cur = item->link.next; cur != &first->link;
 	    cur = cur->next) {
 		assert(cur);
 
-		if (cur == &h->bucket[idx].head)
+		if (cur == &bucket->head)
 			continue;
 
 		ht_link_t *cur_link = member_to_inst(cur, ht_link_t, link);
@@ -308,11 +361,11 @@ size_t hash_table_remove(hash_table_t *h, const void *key)
 	assert(h && h->bucket);
 	assert(!h->apply_ongoing);
 
-	size_t idx = h->op->key_hash(key) % h->bucket_cnt;
+	list_t *bucket = get_bucket(h, h->op->key_hash(key));
 
 	size_t removed = 0;
 
-	list_foreach_safe(h->bucket[idx], cur, next) {
+	list_foreach_safe(*bucket, cur, next) {
 		ht_link_t *cur_link = member_to_inst(cur, ht_link_t, link);
 
 		if (h->op->key_equal(key, cur_link)) {
@@ -325,6 +378,7 @@ size_t hash_table_remove(hash_table_t *h, const void *key)
 	}
 
 	h->item_cnt -= removed;
+	migrate_step(h);
 	shrink_if_needed(h);
 
 	return removed;
@@ -342,9 +396,32 @@ void hash_table_remove_item(hash_table_t *h, ht_link_t *item)
 
 	if (h->op->remove_callback)
 		h->op->remove_callback(item);
+	migrate_step(h);
 	shrink_if_needed(h);
 }
 
+/** Apply function to all items in a bucket array.
+ *
+ * @return False if @a f asked to stop visiting items.
+ */
+static bool apply_buckets(list_t *buckets, size_t bucket_cnt,
+    bool (*f)(ht_link_t *, void *), void *arg)
+{
+	for (size_t idx = 0; idx < bucket_cnt; ++idx) {
+		list_foreach_safe(buckets[idx], cur, next) {
+			ht_link_t *cur_link = member_to_inst(cur, ht_link_t, link);
+			/*
+			 * The next pointer had already been saved. f() may safely
+			 * delete cur (but not next!).
+			 */
+			if (!f(cur_link, arg))
+				return false;
+		}
+	}
+
+	return true;
+}
+
 /** Apply function to all items in hash table.
  *
  * @param h   Hash table.
@@ -364,17 +441,13 @@ void hash_table_apply(hash_table_t *h, bool (*f)(ht_link_t *, void *), void *arg
 
 	h->apply_ongoing = true;
 
-	for (size_t idx = 0; idx < h->bucket_cnt; ++idx) {
-		list_foreach_safe(h->bucket[idx], cur, next) {
-			ht_link_t *cur_link = member_to_inst(cur, ht_link_t, link);
-			/*
-			 * The next pointer had already been saved. f() may safely
-			 * delete cur (but not next!).
-			 */
-			if (!f(cur_link, arg))
-				goto out;
-		}
+	if (h->old_bucket) {
+		if (!apply_buckets(h->old_bucket + h->migrate_idx,
+		    h->old_bucket_cnt - h->migrate_idx, f, arg))
+			goto out;
 	}
+
+	apply_buckets(h->bucket, h->bucket_cnt, f, arg);
 out:
 	h->apply_ongoing = false;
 
@@ -434,7 +507,10 @@ static inline void grow_if_needed(hash_table_t *h)
 	}
 }
 
-/** Allocates and rehashes items to a new table. Frees the old table. */
+/** Allocates a new table and starts migrating items to it.
+ *
+ * The old table is freed once all of its buckets have been migrated.
+ */
 static void resize(hash_table_t *h, size_t new_bucket_cnt)
 {
 	assert(h && h->bucket);
@@ -444,29 +520,57 @@ static void resize(hash_table_t *h, size_t new_bucket_cnt)
 	if (h->apply_ongoing)
 		return;
 
+	/* Let the previous resize finish first. */
+	if (h->old_bucket)
+		return;
+
 	list_t *new_buckets;
 
 	/* Leave the table as is if we cannot resize. */
 	if (!alloc_table(new_bucket_cnt, &new_buckets))
 		return;
 
-	if (0 < h->item_cnt) {
-		/* Rehash all the items to the new table. */
-		for (size_t old_idx = 0; old_idx < h->bucket_cnt; ++old_idx) {
-			list_foreach_safe(h->bucket[old_idx], cur, next) {
-				ht_link_t *cur_link = member_to_inst(cur, ht_link_t, link);
-
-				size_t new_idx = h->op->hash(cur_link) % new_bucket_cnt;
-				list_remove(cur);
-				list_append(cur, &new_buckets[new_idx]);
-			}
-		}
+	if (h->item_cnt == 0) {
+		free(h->bucket);
+	} else {
+		h->old_bucket = h->bucket;
+		h->old_bucket_cnt = h->bucket_cnt;
+		h->migrate_idx = 0;
 	}
 
-	free(h->bucket);
 	h->bucket = new_buckets;
 	h->bucket_cnt = new_bucket_cnt;
 	h->full_item_cnt = h->max_load * h->bucket_cnt;
+
+	migrate_step(h);
+}
+
+/** Rehashes the next few old buckets to the new table during resize. */
+static void migrate_step(hash_table_t *h)
+{
+	/* Moving items would mess up the traversal. */
+	if (!h->old_bucket || h->apply_ongoing)
+		return;
+
+	for (size_t i = 0; i < HT_MIGRATE_STEP &&
+	    h->migrate_idx < h->old_bucket_cnt; ++i) {
+		list_foreach_safe(h->old_bucket[h->migrate_idx], cur, next) {
+			ht_link_t *cur_link = member_to_inst(cur, ht_link_t, link);
+
+			size_t new_idx = h->op->hash(cur_link) % h->bucket_cnt;
+			list_remove(cur);
+			list_append(cur, &h->bucket[new_idx]);
+		}
+
+		++h->migrate_idx;
+	}
+
+	if (h->migrate_idx == h->old_bucket_cnt) {
+		free(h->old_bucket);
+		h->old_bucket = NULL;
+		h->old_bucket_cnt = 0;
+		h->migrate_idx = 0;
+	}
 }
 
 /** @}
@@ -32,14 +32,23 @@
 
 /**
  * @file
- * @brief Gnome Sort.
+ * @brief Stable merge sort.
  *
- * This file contains an implementation of gnome sort
+ * Runs of up to GSORT_RUN elements are first sorted by binary insertion,
+ * then merged bottom-up. Each merge copies only the shorter of the two
+ * runs aside, so the scratch buffer never needs more than half of the
+ * array. Merges of runs that are already in order are skipped, which
+ * makes sorted input cost a single linear pass.
+ *
+ * If the scratch buffer cannot be allocated, the whole array is sorted
+ * by binary insertion instead, which is still stable and needs only
+ * O(n log n) comparisons, but O(n^2) element moves.
  *
  */
 
 #include <gsort.h>
 #include <inttypes.h>
+#include <macros.h>
 #include <mem.h>
 #include <stdlib.h>
 
@@ -49,51 +58,188 @@
  * and use the stack.
  *
  */
-#define IBUF_SIZE  32
+#define IBUF_SIZE  256
 
 /** Array accessor.
  *
  */
-#define INDEX(buf, i, elem_size)  ((buf) + (i) * (elem_size))
+#define INDEX(buf, i, elem_size)  ((uint8_t *) (buf) + (i) * (elem_size))
+
+enum {
+	/** Length of runs sorted by insertion before merging */
+	GSORT_RUN = 16
+};
+
+/** Sort state */
+typedef struct {
+	/** Array being sorted */
+	void *data;
+	/** Size of one element */
+	size_t elem_size;
+	/** Comparator function */
+	sort_cmp_t cmp;
+	/** 3rd argument passed to cmp */
+	void *arg;
+	/** Scratch memory for one element */
+	void *slot;
+	/** Scratch memory for the shorter run of a merge or @c NULL */
+	void *buf;
+} gsort_t;
 
-/** Gnome sort
+/** Compare two elements of the array being sorted.
  *
- * Apply generic gnome sort algorithm on supplied data,
- * using pre-allocated buffer.
+ * @return Result of the comparator
+ */
+static inline int gsort_cmp(gsort_t *gs, size_t i, size_t j)
+{
+	return gs->cmp(INDEX(gs->data, i, gs->elem_size),
+	    INDEX(gs->data, j, gs->elem_size), gs->arg);
+}
+
+/** Binary insertion sort.
  *
- * @param data      Pointer to data to be sorted.
- * @param cnt       Number of elements to be sorted.
- * @param elem_size Size of one element.
- * @param cmp       Comparator function.
- * @param arg       3rd argument passed to cmp.
- * @param slot      Pointer to scratch memory buffer
- *                  elem_size bytes long.
+ * Elements in [begin, start) must already be sorted. Each following
+ * element is inserted after all elements that compare equal to it,
+ * which keeps the sort stable.
  *
+ * @param gs    Sort state
+ * @param begin Index of the first element
+ * @param start Index of the first element not known to be in order
+ * @param end   Index one past the last element
  */
-static void _gsort(void *data, size_t cnt, size_t elem_size, sort_cmp_t cmp,
-    void *arg, void *slot)
+static void binary_insertion(gsort_t *gs, size_t begin, size_t start,
+    size_t end)
 {
-	size_t i = 0;
-
-	while (i < cnt) {
-		if ((i != 0) &&
-		    (cmp(INDEX(data, i, elem_size),
-		    INDEX(data, i - 1, elem_size), arg) < 0)) {
-			memcpy(slot, INDEX(data, i, elem_size), elem_size);
-			memcpy(INDEX(data, i, elem_size), INDEX(data, i - 1, elem_size),
-			    elem_size);
-			memcpy(INDEX(data, i - 1, elem_size), slot, elem_size);
-			i--;
-		} else
-			i++;
+	size_t es = gs->elem_size;
+	size_t i;
+
+	if (start == begin)
+		start++;
+
+	for (i = start; i < end; i++) {
+		size_t lo = begin;
+		size_t hi = i - 1;
+
+		if (gsort_cmp(gs, i - 1, i) <= 0)
+			continue;
+
+		/* Find the first element greater than element i */
+		while (lo < hi) {
+			size_t mid = lo + (hi - lo) / 2;
+
+			if (gsort_cmp(gs, i, mid) < 0)
+				hi = mid;
+			else
+				lo = mid + 1;
+		}
+
+		memcpy(gs->slot, INDEX(gs->data, i, es), es);
+		memmove(INDEX(gs->data, lo + 1, es), INDEX(gs->data, lo, es),
+		    (i - lo) * es);
+		memcpy(INDEX(gs->data, lo, es), gs->slot, es);
 	}
 }
 
-/** Gnome sort wrapper
+/** Merge two adjacent sorted runs.
+ *
+ * The shorter run is copied to the scratch buffer. A shorter left run
+ * is merged from the front, a shorter right run from the back, so that
+ * the output never overtakes unread elements of the run left in place.
+ * On ties the element of the left run goes first.
+ *
+ * @param gs  Sort state
+ * @param lo  Index of the first element of the left run
+ * @param mid Index of the first element of the right run
+ * @param hi  Index one past the last element of the right run
+ */
+static void merge(gsort_t *gs, size_t lo, size_t mid, size_t hi)
+{
+	size_t es = gs->elem_size;
+	uint8_t *data = gs->data;
+	uint8_t *buf = gs->buf;
+
+	/* Runs already in order */
+	if (gsort_cmp(gs, mid - 1, mid) <= 0)
+		return;
+
+	if (mid - lo <= hi - mid) {
+		size_t nl = mid - lo;
+		size_t i = 0;
+		size_t j = mid;
+		size_t k = lo;
+
+		memcpy(buf, INDEX(data, lo, es), nl * es);
+
+		while (i < nl && j < hi) {
+			if (gs->cmp(INDEX(data, j, es), INDEX(buf, i, es),
+			    gs->arg) < 0) {
+				memcpy(INDEX(data, k, es), INDEX(data, j, es), es);
+				j++;
+			} else {
+				memcpy(INDEX(data, k, es), INDEX(buf, i, es), es);
+				i++;
+			}
+
+			k++;
+		}
+
+		/* Whatever remains of the right run is already in place */
+		memcpy(INDEX(data, k, es), INDEX(buf, i, es), (nl - i) * es);
+	} else {
+		size_t nr = hi - mid;
+		size_t i = mid;
+		size_t j = nr;
+		size_t k = hi;
+
+		memcpy(buf, INDEX(data, mid, es), nr * es);
+
+		while (i > lo && j > 0) {
+			k--;
+
+			if (gs->cmp(INDEX(buf, j - 1, es), INDEX(data, i - 1, es),
+			    gs->arg) < 0) {
+				memcpy(INDEX(data, k, es), INDEX(data, i - 1, es), es);
+				i--;
+			} else {
+				memcpy(INDEX(data, k, es), INDEX(buf, j - 1, es), es);
+				j--;
+			}
+		}
+
+		/* Whatever remains of the left run is already in place */
+		memcpy(INDEX(data, lo, es), buf, j * es);
+	}
+}
+
+/** Merge sort
+ *
+ * @param gs  Sort state
+ * @param cnt Number of elements to be sorted.
+ *
+ */
+static void _gsort(gsort_t *gs, size_t cnt)
+{
+	size_t width;
+	size_t lo;
+
+	if (gs->buf == NULL) {
+		binary_insertion(gs, 0, 1, cnt);
+		return;
+	}
+
+	for (lo = 0; lo < cnt; lo += GSORT_RUN)
+		binary_insertion(gs, lo, lo + 1, min(lo + GSORT_RUN, cnt));
+
+	for (width = GSORT_RUN; width < cnt; width *= 2) {
+		for (lo = 0; lo + width < cnt; lo += 2 * width)
+			merge(gs, lo, lo + width, lo + min(2 * width, cnt - lo));
+	}
+}
+
+/** Stable sort
  *
  * This is only a wrapper that takes care of memory
- * allocations for storing the slot element for generic
- * gnome sort algorithm.
+ * allocations for the slot element and the merge buffer.
  *
  * @param data      Pointer to data to be sorted.
  * @param cnt       Number of elements to be sorted.
@@ -106,20 +252,47 @@ static void _gsort(void *data, size_t cnt, size_t elem_size, sort_cmp_t cmp,
  */
 bool gsort(void *data, size_t cnt, size_t elem_size, sort_cmp_t cmp, void *arg)
 {
-	uint8_t ibuf_slot[IBUF_SIZE];
-	void *slot;
+	uint8_t ibuf[IBUF_SIZE];
+	gsort_t gs;
+	size_t bsize;
+	void *mem = NULL;
+
+	if (cnt < 2)
+		return true;
+
+	gs.data = data;
+	gs.elem_size = elem_size;
+	gs.cmp = cmp;
+	gs.arg = arg;
 
-	if (elem_size > IBUF_SIZE) {
-		slot = (void *) malloc(elem_size);
-		if (!slot)
-			return false;
-	} else
-		slot = (void *) ibuf_slot;
+	/* Slot followed by room for half of the array */
+	bsize = (1 + cnt / 2) * elem_size;
+
+	if (bsize <= IBUF_SIZE) {
+		gs.slot = ibuf;
+		gs.buf = ibuf + elem_size;
+	} else {
+		mem = malloc(bsize);
+		if (mem != NULL) {
+			gs.slot = mem;
+			gs.buf = INDEX(mem, 1, elem_size);
+		} else if (elem_size <= IBUF_SIZE) {
+			gs.slot = ibuf;
+			gs.buf = NULL;
+		} else {
+			mem = malloc(elem_size);
+			if (mem == NULL)
+				return false;
+
+			gs.slot = mem;
+			gs.buf = NULL;
+		}
+	}
 
-	_gsort(data, cnt, elem_size, cmp, arg, slot);
+	_gsort(&gs, cnt);
 
-	if (elem_size > IBUF_SIZE)
-		free(slot);
+	if (mem != NULL)
+		free(mem);
 
 	return true;
 }
@@ -42,12 +42,23 @@
 #define BITMAP_ELEMENT   8
 #define BITMAP_REMAINER  7
 
+/** Number of bits in a word of the bitmap searched at once */
+#define BITMAP_WORD  (sizeof(unsigned long) * 8)
+
 typedef struct {
 	size_t elements;
 	uint8_t *bits;
 	size_t next_fit;
+	/**
+	 * Optional second level bitmap with one bit per BITMAP_WORD bits
+	 * of @c bits. If the bit is set, all the bits of the word are set.
+	 * NULL if the bitmap has no second level.
+	 */
+	unsigned long *summary;
 } bitmap_t;
 
+extern void bitmap_summary_update(bitmap_t *, size_t);
+
 static inline void bitmap_set(bitmap_t *bitmap, size_t element,
     unsigned int value)
 {
@@ -63,6 +74,9 @@ static inline void bitmap_set(bitmap_t *bitmap, size_t element,
 		bitmap->bits[byte] &= ~mask;
 		bitmap->next_fit = byte;
 	}
+
+	if (bitmap->summary != NULL)
+		bitmap_summary_update(bitmap, element);
 }
 
 static inline unsigned int bitmap_get(bitmap_t *bitmap, size_t element)
@@ -77,7 +91,9 @@ static inline unsigned int bitmap_get(bitmap_t *bitmap, size_t element)
 }
 
 extern size_t bitmap_size(size_t);
+extern size_t bitmap_size_summary(size_t);
 extern void bitmap_initialize(bitmap_t *, size_t, void *);
+extern void bitmap_initialize_summary(bitmap_t *, size_t, void *);
 
 extern void bitmap_set_range(bitmap_t *, size_t, size_t);
 extern void bitmap_clear_range(bitmap_t *, size_t, size_t);
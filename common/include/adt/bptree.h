@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup kernel_generic_adt
+ * @{
+ */
+/** @file B+tree ordered dictionary
+ */
+
+#ifndef _LIBC_BPTREE_H_
+#define _LIBC_BPTREE_H_
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/** Get key of an item */
+typedef void *(*bpgetkey_t)(void *);
+/** Compare two keys */
+typedef int (*bpcmp_t)(const void *, const void *);
+
+/** B+tree node (opaque) */
+typedef struct bptree_node bptree_node_t;
+
+/** B+tree ordered dictionary.
+ *
+ * Stores pointers to items sorted by key. Unlike odict, items need not
+ * embed a link, several keys share each node and the leaves form a list.
+ */
+typedef struct {
+	/** Root node or @c NULL if the tree is empty */
+	bptree_node_t *root;
+	/** First leaf */
+	bptree_node_t *first;
+	/** Last leaf */
+	bptree_node_t *last;
+	/** Number of items */
+	size_t count;
+	/** Get key operation */
+	bpgetkey_t getkey;
+	/** Compare operation */
+	bpcmp_t cmp;
+	/** Size of keys copied to the nodes or zero to store key pointers */
+	size_t key_size;
+	/** Size of a key slot in a node */
+	size_t slot_size;
+	/** Maximum number of keys in a node */
+	unsigned order;
+	/** Offset of keys in a node */
+	size_t keys_off;
+	/** Offset of items or children in a node */
+	size_t ptrs_off;
+	/** Allocation size of a node */
+	size_t node_size;
+} bptree_t;
+
+/** Position in a B+tree.
+ *
+ * Becomes invalid when the tree is modified.
+ */
+typedef struct {
+	/** Tree */
+	bptree_t *tree;
+	/** Leaf or @c NULL at the end of the tree */
+	bptree_node_t *node;
+	/** Index of the item in the leaf */
+	unsigned idx;
+} bptree_iter_t;
+
+extern void bptree_initialize(bptree_t *, size_t, bpgetkey_t, bpcmp_t);
+extern void bptree_finalize(bptree_t *);
+extern errno_t bptree_insert(bptree_t *, void *);
+extern errno_t bptree_bulk_load(bptree_t *, void **, size_t);
+extern void bptree_remove(bptree_t *, void *);
+extern bool bptree_empty(bptree_t *);
+extern size_t bptree_count(bptree_t *);
+extern void *bptree_first(bptree_t *, bptree_iter_t *);
+extern void *bptree_last(bptree_t *, bptree_iter_t *);
+extern void *bptree_next(bptree_iter_t *);
+extern void *bptree_prev(bptree_iter_t *);
+extern void *bptree_find_eq(bptree_t *, const void *,
+    bptree_iter_t *);
+extern void *bptree_find_geq(bptree_t *, const void *,
+    bptree_iter_t *);
+extern void *bptree_find_gt(bptree_t *, const void *,
+    bptree_iter_t *);
+extern void *bptree_find_leq(bptree_t *, const void *,
+    bptree_iter_t *);
+extern void *bptree_find_lt(bptree_t *, const void *,
+    bptree_iter_t *);
+extern errno_t bptree_validate(bptree_t *);
+
+#endif
+
+/** @}
+ */
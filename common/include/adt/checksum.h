@@ -38,8 +38,10 @@
 #include <stddef.h>
 #include <stdint.h>
 
-extern uint32_t compute_crc32(uint8_t *, size_t);
-extern uint32_t compute_crc32_seed(uint8_t *, size_t, uint32_t);
+extern uint32_t compute_crc32(const uint8_t *, size_t);
+extern uint32_t compute_crc32_seed(const uint8_t *, size_t, uint32_t);
+extern uint32_t compute_crc32c(const uint8_t *, size_t);
+extern uint32_t compute_crc32c_seed(const uint8_t *, size_t, uint32_t);
 
 #endif
 
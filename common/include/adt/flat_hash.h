@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libc
+ * @{
+ */
+/** @file Open addressing hash table
+ */
+
+#ifndef _LIBC_FLAT_HASH_H_
+#define _LIBC_FLAT_HASH_H_
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Set of operations for open addressing hash table. */
+typedef struct {
+	/** Returns the hash of the key stored in the item (ie its lookup key). */
+	size_t (*hash)(const void *item);
+
+	/** Returns the hash of the key. */
+	size_t (*key_hash)(const void *key);
+
+	/** True if the items are equal (have the same lookup keys). */
+	bool (*equal)(const void *item1, const void *item2);
+
+	/** Returns true if the key is equal to the item's lookup key. */
+	bool (*key_equal)(const void *key, const void *item);
+
+	/** Hash table item removal callback.
+	 *
+	 * Must not invoke any mutating functions of the hash table.
+	 *
+	 * @param item Item that was removed from the hash table.
+	 */
+	void (*remove_callback)(void *item);
+} flat_hash_ops_t;
+
+/** Open addressing hash table.
+ *
+ * Stores pointers to items in a flat array of slots. Each slot has
+ * a control byte that tells whether the slot is empty, deleted or full
+ * and in the latter case holds seven bits of the item's hash.
+ */
+typedef struct {
+	const flat_hash_ops_t *op;
+	/** Control bytes, one per slot */
+	uint8_t *ctrl;
+	/** Item pointers */
+	void **slot;
+	/** Number of slots (power of two) */
+	size_t slot_cnt;
+	/** Number of items */
+	size_t item_cnt;
+	/** Number of items that can be added before the table is rehashed */
+	size_t growth_left;
+	bool apply_ongoing;
+} flat_hash_t;
+
+extern bool flat_hash_create(flat_hash_t *, size_t, const flat_hash_ops_t *);
+extern void flat_hash_destroy(flat_hash_t *);
+
+extern bool flat_hash_empty(flat_hash_t *);
+extern size_t flat_hash_size(flat_hash_t *);
+
+extern void flat_hash_clear(flat_hash_t *);
+extern errno_t flat_hash_insert(flat_hash_t *, void *);
+extern errno_t flat_hash_insert_unique(flat_hash_t *, void *);
+extern void *flat_hash_find(const flat_hash_t *, const void *);
+extern size_t flat_hash_remove(flat_hash_t *, const void *);
+extern void flat_hash_remove_item(flat_hash_t *, void *);
+extern void flat_hash_apply(flat_hash_t *, bool (*)(void *, void *), void *);
+
+#endif
+
+/** @}
+ */
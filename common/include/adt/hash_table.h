@@ -75,6 +75,11 @@ typedef struct {
 	const hash_table_ops_t *op;
 	list_t *bucket;
 	size_t bucket_cnt;
+	/** Buckets being migrated to @c bucket during resize or @c NULL. */
+	list_t *old_bucket;
+	size_t old_bucket_cnt;
+	/** Old buckets with lower indices have already been migrated. */
+	size_t migrate_idx;
 	size_t full_item_cnt;
 	size_t item_cnt;
 	size_t max_load;
@@ -44,6 +44,7 @@
 #include <str.h>
 #include <assert.h>
 #include <macros.h>
+#include <mem.h>
 #include <uchar.h>
 
 /* Disable float support in kernel, because we usually disable floating operations there. */
@@ -87,11 +88,11 @@
 #define __PRINTF_FLAG_NOFRACZEROS  0x00000200
 
 /**
- * Buffer big enough for 64-bit number printed in base 2, sign, prefix and 0
- * to terminate string... (last one is only for better testing end of buffer by
- * zero-filling subroutine)
+ * Buffer big enough for 64-bit number printed in base 2, sign and prefix,
+ * with room for leading zeroes so that most numbers can be printed with
+ * a single write.
  */
-#define PRINT_NUMBER_BUFFER_SIZE  (64 + 5)
+#define PRINT_NUMBER_BUFFER_SIZE  128
 
 /** Get signed or unsigned integer argument */
 #define PRINTF_GET_INT_ARGUMENT(type, ap, flags) \
@@ -130,6 +131,27 @@ static const char *digits_small = "0123456789abcdef";
 static const char *digits_big = "0123456789ABCDEF";
 static const char invalch = U_SPECIAL;
 
+/** Decimal representation of numbers 0 .. 99 */
+static const char digit_pairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+/** Span of characters used for padding */
+#define PRINT_PADDING_SPAN  32
+
+static const char spaces[PRINT_PADDING_SPAN + 1] =
+    "                                ";
+static const char zeroes[PRINT_PADDING_SPAN + 1] =
+    "00000000000000000000000000000000";
+
 /** Print one or more characters without adding newline.
  *
  * @param buf  Buffer holding characters with size of
@@ -210,6 +232,38 @@ static int printf_putuchar(const char32_t ch, printf_spec_t *ps)
 	return ps->wstr_write(&ch, sizeof(char32_t), ps->data);
 }
 
+/** Print character repeatedly.
+ *
+ * The characters are written in spans rather than one by one.
+ *
+ * @param ch    Character to print (space or zero).
+ * @param count Number of characters to print (may be negative).
+ * @param ps    Output method.
+ *
+ * @return Number of characters printed, negative value on failure.
+ *
+ */
+static int print_padding(char ch, int count, printf_spec_t *ps)
+{
+	const char *span = (ch == '0') ? zeroes : spaces;
+	int counter = 0;
+	int retval;
+	int n;
+
+	assert(ch == '0' || ch == ' ');
+
+	while (count > 0) {
+		n = min(count, PRINT_PADDING_SPAN);
+		if ((retval = printf_putnchars(span, n, ps)) < 0)
+			return -1;
+
+		counter += retval;
+		count -= n;
+	}
+
+	return counter;
+}
+
 /** Print one formatted ASCII character.
  *
  * @param ch    Character to print.
@@ -222,28 +276,20 @@ static int printf_putuchar(const char32_t ch, printf_spec_t *ps)
 static int print_char(const char ch, int width, uint32_t flags, printf_spec_t *ps)
 {
 	size_t counter = 0;
+	int retval;
+
+	/* One space is consumed by the character itself */
 	if (!(flags & __PRINTF_FLAG_LEFTALIGNED)) {
-		while (--width > 0) {
-			/*
-			 * One space is consumed by the character itself, hence
-			 * the predecrement.
-			 */
-			if (printf_putchar(' ', ps) > 0)
-				counter++;
-		}
+		if ((retval = print_padding(' ', width - 1, ps)) > 0)
+			counter += retval;
+		width = 0;
 	}
 
 	if (printf_putchar(ch, ps) > 0)
 		counter++;
 
-	while (--width > 0) {
-		/*
-		 * One space is consumed by the character itself, hence
-		 * the predecrement.
-		 */
-		if (printf_putchar(' ', ps) > 0)
-			counter++;
-	}
+	if ((retval = print_padding(' ', width - 1, ps)) > 0)
+		counter += retval;
 
 	return (int) (counter);
 }
@@ -260,28 +306,20 @@ static int print_char(const char ch, int width, uint32_t flags, printf_spec_t *p
 static int print_wchar(const char32_t ch, int width, uint32_t flags, printf_spec_t *ps)
 {
 	size_t counter = 0;
+	int retval;
+
+	/* One space is consumed by the character itself */
 	if (!(flags & __PRINTF_FLAG_LEFTALIGNED)) {
-		while (--width > 0) {
-			/*
-			 * One space is consumed by the character itself, hence
-			 * the predecrement.
-			 */
-			if (printf_putchar(' ', ps) > 0)
-				counter++;
-		}
+		if ((retval = print_padding(' ', width - 1, ps)) > 0)
+			counter += retval;
+		width = 0;
 	}
 
 	if (printf_putuchar(ch, ps) > 0)
 		counter++;
 
-	while (--width > 0) {
-		/*
-		 * One space is consumed by the character itself, hence
-		 * the predecrement.
-		 */
-		if (printf_putchar(' ', ps) > 0)
-			counter++;
-	}
+	if ((retval = print_padding(' ', width - 1, ps)) > 0)
+		counter += retval;
 
 	return (int) (counter);
 }
@@ -309,16 +347,15 @@ static int print_str(char *str, int width, unsigned int precision,
 
 	/* Left padding */
 	size_t counter = 0;
+	int retval;
 	width -= precision;
 	if (!(flags & __PRINTF_FLAG_LEFTALIGNED)) {
-		while (width-- > 0) {
-			if (printf_putchar(' ', ps) == 1)
-				counter++;
-		}
+		if ((retval = print_padding(' ', width, ps)) > 0)
+			counter += retval;
+		width = 0;
 	}
 
 	/* Part of @a str fitting into the alloted space. */
-	int retval;
 	size_t size = str_lsize(str, precision);
 	if ((retval = printf_putnchars(str, size, ps)) < 0)
 		return -counter;
@@ -326,10 +363,8 @@ static int print_str(char *str, int width, unsigned int precision,
 	counter += retval;
 
 	/* Right padding */
-	while (width-- > 0) {
-		if (printf_putchar(' ', ps) == 1)
-			counter++;
-	}
+	if ((retval = print_padding(' ', width, ps)) > 0)
+		counter += retval;
 
 	return ((int) counter);
 
@@ -358,16 +393,15 @@ static int print_wstr(char32_t *str, int width, unsigned int precision,
 
 	/* Left padding */
 	size_t counter = 0;
+	int retval;
 	width -= precision;
 	if (!(flags & __PRINTF_FLAG_LEFTALIGNED)) {
-		while (width-- > 0) {
-			if (printf_putchar(' ', ps) == 1)
-				counter++;
-		}
+		if ((retval = print_padding(' ', width, ps)) > 0)
+			counter += retval;
+		width = 0;
 	}
 
 	/* Part of @a wstr fitting into the alloted space. */
-	int retval;
 	size_t size = wstr_lsize(str, precision);
 	if ((retval = printf_wputnchars(str, size, ps)) < 0)
 		return -counter;
@@ -375,22 +409,83 @@ static int print_wstr(char32_t *str, int width, unsigned int precision,
 	counter += retval;
 
 	/* Right padding */
-	while (width-- > 0) {
-		if (printf_putchar(' ', ps) == 1)
-			counter++;
-	}
+	if ((retval = print_padding(' ', width, ps)) > 0)
+		counter += retval;
 
 	return ((int) counter);
 }
 
+/** Convert a number to digits in a given base.
+ *
+ * Decimal numbers are converted two digits at a time, numbers in other
+ * bases (which are powers of two) using shifts instead of divisions.
+ *
+ * @param num   Number to convert.
+ * @param base  Base (2, 8, 10 or 16).
+ * @param flags Flags (only __PRINTF_FLAG_BIGCHARS is used).
+ * @param end   End of buffer to store digits to.
+ *
+ * @return Pointer to the first digit. The digits end at @a end.
+ *
+ */
+static char *print_digits(uint64_t num, unsigned int base, uint32_t flags,
+    char *end)
+{
+	char *ptr = end;
+	unsigned int r;
+
+	if (base == 10) {
+		/* Avoid 64-bit division where it is expensive */
+		while (num > UINT32_MAX) {
+			r = num % 100;
+			num /= 100;
+			*--ptr = digit_pairs[2 * r + 1];
+			*--ptr = digit_pairs[2 * r];
+		}
+
+		uint32_t num32 = num;
+		while (num32 >= 100) {
+			r = num32 % 100;
+			num32 /= 100;
+			*--ptr = digit_pairs[2 * r + 1];
+			*--ptr = digit_pairs[2 * r];
+		}
+
+		if (num32 >= 10) {
+			*--ptr = digit_pairs[2 * num32 + 1];
+			*--ptr = digit_pairs[2 * num32];
+		} else {
+			*--ptr = '0' + num32;
+		}
+
+		return ptr;
+	}
+
+	const char *digits;
+	if (flags & __PRINTF_FLAG_BIGCHARS)
+		digits = digits_big;
+	else
+		digits = digits_small;
+
+	unsigned int shift = (base == 16) ? 4 : (base == 8) ? 3 : 1;
+
+	do {
+		*--ptr = digits[num & (base - 1)];
+		num >>= shift;
+	} while (num != 0);
+
+	return ptr;
+}
+
 /** Print a number in a given base.
  *
- * Print significant digits of a number in given base.
+ * Print significant digits of a number in given base. The sign, prefix,
+ * leading zeroes and digits are assembled in a buffer and printed at once.
  *
  * @param num       Number to print.
  * @param width     Width modifier.
  * @param precision Precision modifier.
- * @param base      Base to print the number in (must be between 2 and 16).
+ * @param base      Base to print the number in (2, 8, 10 or 16).
  * @param flags     Flags that modify the way the number is printed.
  *
  * @return Number of characters printed.
@@ -404,53 +499,35 @@ static int print_number(uint64_t num, int width, int precision, int base,
 		precision = 0;
 	}
 
-	const char *digits;
-	if (flags & __PRINTF_FLAG_BIGCHARS)
-		digits = digits_big;
-	else
-		digits = digits_small;
-
 	char data[PRINT_NUMBER_BUFFER_SIZE];
-	char *ptr = &data[PRINT_NUMBER_BUFFER_SIZE - 1];
-
-	/* Size of number with all prefixes and signs */
-	int size = 0;
-
-	/* Put zero at end of string */
-	*ptr-- = 0;
-
-	if (num == 0) {
-		*ptr-- = '0';
-		size++;
-	} else {
-		do {
-			*ptr-- = digits[num % base];
-			size++;
-		} while (num /= base);
-	}
+	char *end = &data[PRINT_NUMBER_BUFFER_SIZE];
+	char *ptr = print_digits(num, base, flags, end);
 
 	/* Size of plain number */
-	int number_size = size;
+	int number_size = end - ptr;
 
-	/*
-	 * Collect the sum of all prefixes/signs/etc. to calculate padding and
-	 * leading zeroes.
-	 */
+	/* Prefix */
+	const char *prefix = "";
 	if (flags & __PRINTF_FLAG_PREFIX) {
 		switch (base) {
 		case 2:
-			/* Binary formating is not standard, but usefull */
-			size += 2;
+			/* Binary formating is not standard, but useful */
+			prefix = (flags & __PRINTF_FLAG_BIGCHARS) ? "0B" : "0b";
 			break;
 		case 8:
-			size++;
+			prefix = "o";
 			break;
 		case 16:
-			size += 2;
+			prefix = (flags & __PRINTF_FLAG_BIGCHARS) ? "0X" : "0x";
 			break;
 		}
 	}
 
+	int prefix_size = str_size(prefix);
+
+	/* Size of number with all prefixes and signs */
+	int size = number_size + prefix_size;
+
 	char sgn = 0;
 	if (flags & __PRINTF_FLAG_SIGNED) {
 		if (flags & __PRINTF_FLAG_NEGATIVE) {
@@ -485,72 +562,52 @@ static int print_number(uint64_t num, int width, int precision, int base,
 
 	width -= precision + size - number_size;
 	size_t counter = 0;
+	int retval;
 
 	if (!(flags & __PRINTF_FLAG_LEFTALIGNED)) {
-		while (width-- > 0) {
-			if (printf_putchar(' ', ps) == 1)
-				counter++;
-		}
+		if ((retval = print_padding(' ', width, ps)) > 0)
+			counter += retval;
+		width = 0;
 	}
 
-	/* Print sign */
-	if (sgn) {
-		if (printf_putchar(sgn, ps) == 1)
-			counter++;
-	}
+	int zeroes = precision - number_size;
 
-	/* Print prefix */
-	if (flags & __PRINTF_FLAG_PREFIX) {
-		switch (base) {
-		case 2:
-			/* Binary formating is not standard, but useful */
-			if (printf_putchar('0', ps) == 1)
-				counter++;
-			if (flags & __PRINTF_FLAG_BIGCHARS) {
-				if (printf_putchar('B', ps) == 1)
-					counter++;
-			} else {
-				if (printf_putchar('b', ps) == 1)
-					counter++;
-			}
-			break;
-		case 8:
-			if (printf_putchar('o', ps) == 1)
-				counter++;
-			break;
-		case 16:
-			if (printf_putchar('0', ps) == 1)
-				counter++;
-			if (flags & __PRINTF_FLAG_BIGCHARS) {
-				if (printf_putchar('X', ps) == 1)
-					counter++;
-			} else {
-				if (printf_putchar('x', ps) == 1)
-					counter++;
-			}
-			break;
-		}
-	}
+	if (zeroes <= ptr - data - prefix_size - 1) {
+		/* Leading zeroes, prefix and sign fit in front of the digits */
+		ptr -= zeroes;
+		memset(ptr, '0', zeroes);
+		ptr -= prefix_size;
+		memcpy(ptr, prefix, prefix_size);
+		if (sgn)
+			*--ptr = sgn;
 
-	/* Print leading zeroes */
-	precision -= number_size;
-	while (precision-- > 0) {
-		if (printf_putchar('0', ps) == 1)
-			counter++;
-	}
+		if ((retval = printf_putnchars(ptr, end - ptr, ps)) > 0)
+			counter += retval;
+	} else {
+		char head[3];
+		int head_size = 0;
 
-	/* Print the number itself */
-	int retval;
-	if ((retval = printf_putstr(++ptr, ps)) > 0)
-		counter += retval;
+		if (sgn)
+			head[head_size++] = sgn;
+		memcpy(&head[head_size], prefix, prefix_size);
+		head_size += prefix_size;
 
-	/* Print trailing spaces */
+		if (head_size > 0) {
+			if ((retval = printf_putnchars(head, head_size, ps)) > 0)
+				counter += retval;
+		}
+
+		if ((retval = print_padding('0', zeroes, ps)) > 0)
+			counter += retval;
 
-	while (width-- > 0) {
-		if (printf_putchar(' ', ps) == 1)
-			counter++;
+		if ((retval = printf_putnchars(ptr, number_size, ps)) > 0)
+			counter += retval;
 	}
 
+	/* Print trailing spaces */
+	if ((retval = print_padding(' ', width, ps)) > 0)
+		counter += retval;
+
 	return ((int) counter);
 }
 
@@ -582,18 +639,6 @@ static int get_sign_char(bool negative, uint32_t flags)
 	}
 }
 
-/** Prints count times character ch. */
-static int print_padding(char ch, int count, printf_spec_t *ps)
-{
-	for (int i = 0; i < count; ++i) {
-		if (ps->str_write(&ch, 1, ps->data) < 0) {
-			return -1;
-		}
-	}
-
-	return count;
-}
-
 /** Prints a special double (ie NaN, infinity) padded to width characters. */
 static int print_special(ieee_double_t val, int width, uint32_t flags,
     printf_spec_t *ps)
@@ -1340,61 +1385,98 @@ int printf_core(const char *fmt, printf_spec_t *ps, va_list ap)
 	int retval;           /* Return values from nested functions */
 
 	while (true) {
+		/*
+		 * Find the next conversion specification. Neither '%' nor
+		 * the null character can be a part of a multi-byte
+		 * sequence, so the plain characters need not be decoded.
+		 */
 		i = nxt;
-		char32_t uc = str_decode(fmt, &nxt, STR_NO_LIMIT);
+		while (fmt[i] != '%' && fmt[i] != 0)
+			i++;
 
-		if (uc == 0)
+		if (fmt[i] == 0)
 			break;
 
-		/* Control character */
-		if (uc == '%') {
-			/* Print common characters if any processed */
-			if (i > j) {
-				if ((retval = printf_putnchars(&fmt[j], i - j, ps)) < 0) {
-					/* Error */
-					counter = -counter;
-					goto out;
-				}
-				counter += retval;
+		nxt = i + 1;
+		char32_t uc;
+
+		/* Print common characters if any processed */
+		if (i > j) {
+			if ((retval = printf_putnchars(&fmt[j], i - j, ps)) < 0) {
+				/* Error */
+				counter = -counter;
+				goto out;
 			}
+			counter += retval;
+		}
 
-			j = i;
+		j = i;
+
+		/* Parse modifiers */
+		uint32_t flags = 0;
+		bool end = false;
+
+		do {
+			i = nxt;
+			uc = str_decode(fmt, &nxt, STR_NO_LIMIT);
+			switch (uc) {
+			case '#':
+				flags |= __PRINTF_FLAG_PREFIX;
+				flags |= __PRINTF_FLAG_DECIMALPT;
+				break;
+			case '-':
+				flags |= __PRINTF_FLAG_LEFTALIGNED;
+				break;
+			case '+':
+				flags |= __PRINTF_FLAG_SHOWPLUS;
+				break;
+			case ' ':
+				flags |= __PRINTF_FLAG_SPACESIGN;
+				break;
+			case '0':
+				flags |= __PRINTF_FLAG_ZEROPADDED;
+				break;
+			default:
+				end = true;
+			}
+		} while (!end);
 
-			/* Parse modifiers */
-			uint32_t flags = 0;
-			bool end = false;
+		/* Width & '*' operator */
+		int width = 0;
+		if (isdigit(uc)) {
+			while (true) {
+				width *= 10;
+				width += uc - '0';
 
-			do {
 				i = nxt;
 				uc = str_decode(fmt, &nxt, STR_NO_LIMIT);
-				switch (uc) {
-				case '#':
-					flags |= __PRINTF_FLAG_PREFIX;
-					flags |= __PRINTF_FLAG_DECIMALPT;
-					break;
-				case '-':
-					flags |= __PRINTF_FLAG_LEFTALIGNED;
-					break;
-				case '+':
-					flags |= __PRINTF_FLAG_SHOWPLUS;
+				if (uc == 0)
 					break;
-				case ' ':
-					flags |= __PRINTF_FLAG_SPACESIGN;
+				if (!isdigit(uc))
 					break;
-				case '0':
-					flags |= __PRINTF_FLAG_ZEROPADDED;
-					break;
-				default:
-					end = true;
-				}
-			} while (!end);
+			}
+		} else if (uc == '*') {
+			/* Get width value from argument list */
+			i = nxt;
+			uc = str_decode(fmt, &nxt, STR_NO_LIMIT);
+			width = (int) va_arg(ap, int);
+			if (width < 0) {
+				/* Negative width sets '-' flag */
+				width *= -1;
+				flags |= __PRINTF_FLAG_LEFTALIGNED;
+			}
+		}
 
-			/* Width & '*' operator */
-			int width = 0;
+		/* Precision and '*' operator */
+		int precision = -1;
+		if (uc == '.') {
+			i = nxt;
+			uc = str_decode(fmt, &nxt, STR_NO_LIMIT);
 			if (isdigit(uc)) {
+				precision = 0;
 				while (true) {
-					width *= 10;
-					width += uc - '0';
+					precision *= 10;
+					precision += uc - '0';
 
 					i = nxt;
 					uc = str_decode(fmt, &nxt, STR_NO_LIMIT);
@@ -1404,257 +1486,234 @@ int printf_core(const char *fmt, printf_spec_t *ps, va_list ap)
 						break;
 				}
 			} else if (uc == '*') {
-				/* Get width value from argument list */
+				/* Get precision value from the argument list */
 				i = nxt;
 				uc = str_decode(fmt, &nxt, STR_NO_LIMIT);
-				width = (int) va_arg(ap, int);
-				if (width < 0) {
-					/* Negative width sets '-' flag */
-					width *= -1;
-					flags |= __PRINTF_FLAG_LEFTALIGNED;
+				precision = (int) va_arg(ap, int);
+				if (precision < 0) {
+					/* Ignore negative precision - use default instead */
+					precision = -1;
 				}
 			}
+		}
 
-			/* Precision and '*' operator */
-			int precision = -1;
-			if (uc == '.') {
-				i = nxt;
-				uc = str_decode(fmt, &nxt, STR_NO_LIMIT);
-				if (isdigit(uc)) {
-					precision = 0;
-					while (true) {
-						precision *= 10;
-						precision += uc - '0';
-
-						i = nxt;
-						uc = str_decode(fmt, &nxt, STR_NO_LIMIT);
-						if (uc == 0)
-							break;
-						if (!isdigit(uc))
-							break;
-					}
-				} else if (uc == '*') {
-					/* Get precision value from the argument list */
-					i = nxt;
-					uc = str_decode(fmt, &nxt, STR_NO_LIMIT);
-					precision = (int) va_arg(ap, int);
-					if (precision < 0) {
-						/* Ignore negative precision - use default instead */
-						precision = -1;
-					}
-				}
-			}
+		/* Incomplete specification at the end of the string */
+		if (uc == 0)
+			break;
 
-			qualifier_t qualifier;
+		qualifier_t qualifier;
 
-			switch (uc) {
-			case 't':
-				/* ptrdiff_t */
-				if (sizeof(ptrdiff_t) == sizeof(int32_t))
-					qualifier = PrintfQualifierInt;
-				else
-					qualifier = PrintfQualifierLongLong;
-				i = nxt;
-				uc = str_decode(fmt, &nxt, STR_NO_LIMIT);
-				break;
-			case 'h':
-				/* Char or short */
-				qualifier = PrintfQualifierShort;
-				i = nxt;
-				uc = str_decode(fmt, &nxt, STR_NO_LIMIT);
-				if (uc == 'h') {
-					i = nxt;
-					uc = str_decode(fmt, &nxt, STR_NO_LIMIT);
-					qualifier = PrintfQualifierByte;
-				}
-				break;
-			case 'l':
-				/* Long or long long */
-				qualifier = PrintfQualifierLong;
-				i = nxt;
-				uc = str_decode(fmt, &nxt, STR_NO_LIMIT);
-				if (uc == 'l') {
-					i = nxt;
-					uc = str_decode(fmt, &nxt, STR_NO_LIMIT);
-					qualifier = PrintfQualifierLongLong;
-				}
-				break;
-			case 'z':
-				qualifier = PrintfQualifierSize;
+		switch (uc) {
+		case 't':
+			/* ptrdiff_t */
+			if (sizeof(ptrdiff_t) == sizeof(int32_t))
+				qualifier = PrintfQualifierInt;
+			else
+				qualifier = PrintfQualifierLongLong;
+			i = nxt;
+			uc = str_decode(fmt, &nxt, STR_NO_LIMIT);
+			break;
+		case 'h':
+			/* Char or short */
+			qualifier = PrintfQualifierShort;
+			i = nxt;
+			uc = str_decode(fmt, &nxt, STR_NO_LIMIT);
+			if (uc == 'h') {
 				i = nxt;
 				uc = str_decode(fmt, &nxt, STR_NO_LIMIT);
-				break;
-			case 'j':
-				qualifier = PrintfQualifierMax;
+				qualifier = PrintfQualifierByte;
+			}
+			break;
+		case 'l':
+			/* Long or long long */
+			qualifier = PrintfQualifierLong;
+			i = nxt;
+			uc = str_decode(fmt, &nxt, STR_NO_LIMIT);
+			if (uc == 'l') {
 				i = nxt;
 				uc = str_decode(fmt, &nxt, STR_NO_LIMIT);
-				break;
-			default:
-				/* Default type */
-				qualifier = PrintfQualifierInt;
+				qualifier = PrintfQualifierLongLong;
 			}
+			break;
+		case 'z':
+			qualifier = PrintfQualifierSize;
+			i = nxt;
+			uc = str_decode(fmt, &nxt, STR_NO_LIMIT);
+			break;
+		case 'j':
+			qualifier = PrintfQualifierMax;
+			i = nxt;
+			uc = str_decode(fmt, &nxt, STR_NO_LIMIT);
+			break;
+		default:
+			/* Default type */
+			qualifier = PrintfQualifierInt;
+		}
 
-			unsigned int base = 10;
-
-			switch (uc) {
-				/*
-				 * String and character conversions.
-				 */
-			case 's':
-				precision = max(0,  precision);
-
-				if (qualifier == PrintfQualifierLong)
-					retval = print_wstr(va_arg(ap, char32_t *), width, precision, flags, ps);
-				else
-					retval = print_str(va_arg(ap, char *), width, precision, flags, ps);
-
-				if (retval < 0) {
-					counter = -counter;
-					goto out;
-				}
-
-				counter += retval;
-				j = nxt;
-				continue;
-			case 'c':
-				if (qualifier == PrintfQualifierLong)
-					retval = print_wchar(va_arg(ap, wint_t), width, flags, ps);
-				else
-					retval = print_char(va_arg(ap, unsigned int), width, flags, ps);
-
-				if (retval < 0) {
-					counter = -counter;
-					goto out;
-				}
-
-				counter += retval;
-				j = nxt;
-				continue;
-
-#ifdef HAS_FLOAT
-				/*
-				 * Floating point values
-				 */
-			case 'G':
-			case 'g':
-			case 'F':
-			case 'f':
-			case 'E':
-			case 'e':
-				retval = print_double(va_arg(ap, double), uc, precision,
-				    width, flags, ps);
-
-				if (retval < 0) {
-					counter = -counter;
-					goto out;
-				}
+		/* Incomplete specification at the end of the string */
+		if (uc == 0)
+			break;
 
-				counter += retval;
-				j = nxt;
-				continue;
-#endif
+		unsigned int base = 10;
 
-				/*
-				 * Integer values
-				 */
-			case 'P':
-				/* Pointer */
-				flags |= __PRINTF_FLAG_BIGCHARS;
-				/* Fallthrough */
-			case 'p':
-				flags |= __PRINTF_FLAG_PREFIX;
-				flags |= __PRINTF_FLAG_ZEROPADDED;
-				base = 16;
-				qualifier = PrintfQualifierPointer;
-				break;
-			case 'b':
-				base = 2;
-				break;
-			case 'o':
-				base = 8;
-				break;
-			case 'd':
-			case 'i':
-				flags |= __PRINTF_FLAG_SIGNED;
-				/* Fallthrough */
-			case 'u':
-				break;
-			case 'X':
-				flags |= __PRINTF_FLAG_BIGCHARS;
-				/* Fallthrough */
-			case 'x':
-				base = 16;
-				break;
+		switch (uc) {
+			/*
+			 * String and character conversions.
+			 */
+		case 's':
+			precision = max(0,  precision);
 
-			case '%':
-				/* Percentile itself */
-				j = i;
-				continue;
+			if (qualifier == PrintfQualifierLong)
+				retval = print_wstr(va_arg(ap, char32_t *), width, precision, flags, ps);
+			else
+				retval = print_str(va_arg(ap, char *), width, precision, flags, ps);
 
-				/*
-				 * Bad formatting.
-				 */
-			default:
-				/*
-				 * Unknown format. Now, j is the index of '%'
-				 * so we will print whole bad format sequence.
-				 */
-				continue;
+			if (retval < 0) {
+				counter = -counter;
+				goto out;
 			}
 
-			/* Print integers */
-			size_t size;
-			uint64_t number;
-
-			switch (qualifier) {
-			case PrintfQualifierByte:
-				size = sizeof(unsigned char);
-				number = PRINTF_GET_INT_ARGUMENT(int, ap, flags);
-				break;
-			case PrintfQualifierShort:
-				size = sizeof(unsigned short);
-				number = PRINTF_GET_INT_ARGUMENT(int, ap, flags);
-				break;
-			case PrintfQualifierInt:
-				size = sizeof(unsigned int);
-				number = PRINTF_GET_INT_ARGUMENT(int, ap, flags);
-				break;
-			case PrintfQualifierLong:
-				size = sizeof(unsigned long);
-				number = PRINTF_GET_INT_ARGUMENT(long, ap, flags);
-				break;
-			case PrintfQualifierLongLong:
-				size = sizeof(unsigned long long);
-				number = PRINTF_GET_INT_ARGUMENT(long long, ap, flags);
-				break;
-			case PrintfQualifierPointer:
-				size = sizeof(void *);
-				precision = size << 1;
-				number = (uint64_t) (uintptr_t) va_arg(ap, void *);
-				break;
-			case PrintfQualifierSize:
-				size = sizeof(size_t);
-				number = (uint64_t) va_arg(ap, size_t);
-				break;
-			case PrintfQualifierMax:
-				size = sizeof(uintmax_t);
-				number = (uint64_t) va_arg(ap, uintmax_t);
-				break;
-			default:
-				/* Unknown qualifier */
+			counter += retval;
+			j = nxt;
+			continue;
+		case 'c':
+			if (qualifier == PrintfQualifierLong)
+				retval = print_wchar(va_arg(ap, wint_t), width, flags, ps);
+			else
+				retval = print_char(va_arg(ap, unsigned int), width, flags, ps);
+
+			if (retval < 0) {
 				counter = -counter;
 				goto out;
 			}
 
-			if ((retval = print_number(number, width, precision,
-			    base, flags, ps)) < 0) {
+			counter += retval;
+			j = nxt;
+			continue;
+
+#ifdef HAS_FLOAT
+			/*
+			 * Floating point values
+			 */
+		case 'G':
+		case 'g':
+		case 'F':
+		case 'f':
+		case 'E':
+		case 'e':
+			retval = print_double(va_arg(ap, double), uc, precision,
+			    width, flags, ps);
+
+			if (retval < 0) {
 				counter = -counter;
 				goto out;
 			}
 
 			counter += retval;
 			j = nxt;
+			continue;
+#endif
+
+			/*
+			 * Integer values
+			 */
+		case 'P':
+			/* Pointer */
+			flags |= __PRINTF_FLAG_BIGCHARS;
+			/* Fallthrough */
+		case 'p':
+			flags |= __PRINTF_FLAG_PREFIX;
+			flags |= __PRINTF_FLAG_ZEROPADDED;
+			base = 16;
+			qualifier = PrintfQualifierPointer;
+			break;
+		case 'b':
+			base = 2;
+			break;
+		case 'o':
+			base = 8;
+			break;
+		case 'd':
+		case 'i':
+			flags |= __PRINTF_FLAG_SIGNED;
+			/* Fallthrough */
+		case 'u':
+			break;
+		case 'X':
+			flags |= __PRINTF_FLAG_BIGCHARS;
+			/* Fallthrough */
+		case 'x':
+			base = 16;
+			break;
+
+		case '%':
+			/* Percentile itself */
+			j = i;
+			continue;
+
+			/*
+			 * Bad formatting.
+			 */
+		default:
+			/*
+			 * Unknown format. Now, j is the index of '%'
+			 * so we will print whole bad format sequence.
+			 */
+			continue;
 		}
+
+		/* Print integers */
+		size_t size;
+		uint64_t number;
+
+		switch (qualifier) {
+		case PrintfQualifierByte:
+			size = sizeof(unsigned char);
+			number = PRINTF_GET_INT_ARGUMENT(int, ap, flags);
+			break;
+		case PrintfQualifierShort:
+			size = sizeof(unsigned short);
+			number = PRINTF_GET_INT_ARGUMENT(int, ap, flags);
+			break;
+		case PrintfQualifierInt:
+			size = sizeof(unsigned int);
+			number = PRINTF_GET_INT_ARGUMENT(int, ap, flags);
+			break;
+		case PrintfQualifierLong:
+			size = sizeof(unsigned long);
+			number = PRINTF_GET_INT_ARGUMENT(long, ap, flags);
+			break;
+		case PrintfQualifierLongLong:
+			size = sizeof(unsigned long long);
+			number = PRINTF_GET_INT_ARGUMENT(long long, ap, flags);
+			break;
+		case PrintfQualifierPointer:
+			size = sizeof(void *);
+			precision = size << 1;
+			number = (uint64_t) (uintptr_t) va_arg(ap, void *);
+			break;
+		case PrintfQualifierSize:
+			size = sizeof(size_t);
+			number = (uint64_t) va_arg(ap, size_t);
+			break;
+		case PrintfQualifierMax:
+			size = sizeof(uintmax_t);
+			number = (uint64_t) va_arg(ap, uintmax_t);
+			break;
+		default:
+			/* Unknown qualifier */
+			counter = -counter;
+			goto out;
+		}
+
+		if ((retval = print_number(number, width, precision,
+		    base, flags, ps)) < 0) {
+			counter = -counter;
+			goto out;
+		}
+
+		counter += retval;
+		j = nxt;
 	}
 
 	if (i > j) {
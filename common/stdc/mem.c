@@ -31,25 +31,664 @@
  * @{
  */
 /** @file
+ *
+ * The generic implementations work a machine word at a time. Targets
+ * built with 128-bit SIMD (SSE2 on amd64 and on ia32 for processors that
+ * have it, NEON on arm64) use 16-byte vectors via GCC vector extensions
+ * instead. This excludes the kernel, which is built without them. Blocks are handled
+ * by size class: up to 16 bytes with two possibly overlapping scalar
+ * accesses, up to 64 bytes with up to four overlapping vectors, larger
+ * blocks with a loop aligned to the destination plus overlapping head
+ * and tail vectors loaded in advance, which also makes them safe for
+ * memmove().
+ *
+ * On amd64 the CPU is probed once on first use. Large blocks are copied
+ * and filled with 'rep movsb' and 'rep stosb' if the CPU has enhanced
+ * REP MOVSB/STOSB (ERMS), which also benefits the kernel. Otherwise huge
+ * copies use non-temporal stores so that they do not evict the whole
+ * cache. 32-byte AVX2 loops are only used if the operating system has
+ * enabled the AVX register state in XCR0.
  */
 
 #include "../include/mem.h"
 
+#include <stdbool.h>
 #include <stdlib.h>
 #include <stddef.h>
 #include <stdint.h>
 #include "cc.h"
 
+#if defined(__x86_64__)
+#include <stdatomic.h>
+#endif
+
 #undef memset
 #undef memcpy
 #undef memcmp
 #undef memmove
 #undef memchr
 
+#if defined(__SSE2__) || defined(__ARM_NEON)
+#define MEM_SIMD
+#endif
+
+#if defined(__x86_64__)
+
+enum {
+	/** Features have been determined */
+	mem_feat_known = 1,
+	/** Enhanced REP MOVSB/STOSB */
+	mem_feat_erms = 2,
+	/** AVX2 available and its state enabled by the OS */
+	mem_feat_avx2 = 4
+};
+
+/** Minimum block size for which 'rep movsb' and 'rep stosb' are used */
+#define MEM_ERMS_THRESHOLD  2048
+
+/** Cached CPU features (mem_feat_xxx), zero until determined */
+static atomic_uint mem_features;
+
+/** Determine (once) which CPU features can be used.
+ *
+ * @return Bitmask of mem_feat_xxx
+ */
+static unsigned mem_features_get(void)
+{
+	unsigned features;
+	uint32_t eax, ebx, ecx, edx;
+	uint32_t max_leaf;
+	uint32_t xcr0;
+	bool os_avx = false;
+
+	features = atomic_load_explicit(&mem_features, memory_order_relaxed);
+	if (features != 0)
+		return features;
+
+	features = mem_feat_known;
+
+	asm volatile (
+	    "cpuid\n"
+	    : "=a" (eax), "=b" (ebx), "=c" (ecx), "=d" (edx)
+	    : "a" (0), "c" (0)
+	);
+	max_leaf = eax;
+
+	asm volatile (
+	    "cpuid\n"
+	    : "=a" (eax), "=b" (ebx), "=c" (ecx), "=d" (edx)
+	    : "a" (1), "c" (0)
+	);
+
+	/* OSXSAVE and AVX */
+	if ((ecx & (1 << 27)) != 0 && (ecx & (1 << 28)) != 0) {
+		asm volatile (
+		    "xgetbv\n"
+		    : "=a" (xcr0), "=d" (edx)
+		    : "c" (0)
+		);
+
+		/* SSE and AVX state enabled */
+		os_avx = (xcr0 & 0x6) == 0x6;
+	}
+
+	if (max_leaf >= 7) {
+		asm volatile (
+		    "cpuid\n"
+		    : "=a" (eax), "=b" (ebx), "=c" (ecx), "=d" (edx)
+		    : "a" (7), "c" (0)
+		);
+
+		if ((ebx & (1 << 9)) != 0)
+			features |= mem_feat_erms;
+		if (os_avx && (ebx & (1 << 5)) != 0)
+			features |= mem_feat_avx2;
+	}
+
+	atomic_store_explicit(&mem_features, features, memory_order_relaxed);
+	return features;
+}
+
+/** Determine if block of @a n bytes should be handled by a string
+ * instruction.
+ */
+static inline bool mem_use_erms(size_t n)
+{
+	return n >= MEM_ERMS_THRESHOLD &&
+	    (mem_features_get() & mem_feat_erms) != 0;
+}
+
+/** Copy memory block using 'rep movsb'. */
+static inline void mem_movsb(void *dst, const void *src, size_t n)
+{
+	asm volatile (
+	    "rep movsb\n"
+	    : "+D" (dst), "+S" (src), "+c" (n)
+	    :
+	    : "memory"
+	);
+}
+
+/** Fill memory block using 'rep stosb'. */
+static inline void mem_stosb(void *dst, uint8_t b, size_t n)
+{
+	asm volatile (
+	    "rep stosb\n"
+	    : "+D" (dst), "+c" (n)
+	    : "a" (b)
+	    : "memory"
+	);
+}
+
+#endif
+
+#ifdef MEM_SIMD
+
+/** Vector size in bytes */
+#define MEM_VEC_SIZE  16
+
+/** 16 bytes at a 16-byte aligned address */
+typedef uint8_t mem_avec_t __attribute__((vector_size(16), may_alias));
+/** 16 bytes at any address */
+typedef uint8_t mem_vec_t __attribute__((vector_size(16), aligned(1),
+    may_alias));
+
+/** Scalars at any address */
+typedef uint64_t mem_u64_t __attribute__((aligned(1), may_alias));
+typedef uint32_t mem_u32_t __attribute__((aligned(1), may_alias));
+typedef uint16_t mem_u16_t __attribute__((aligned(1), may_alias));
+
+#if defined(__SSE2__)
+typedef char mem_v16qi_t __attribute__((vector_size(16)));
+#else
+typedef uint64_t mem_v2du_t __attribute__((vector_size(16)));
+#endif
+
+#if defined(__x86_64__)
+
+/** Minimum size of a copy for which non-temporal stores are used */
+#define MEM_NT_THRESHOLD  (4 * 1024 * 1024)
+
+/** 32 bytes at a 32-byte aligned address */
+typedef uint8_t mem_avec32_t __attribute__((vector_size(32), may_alias));
+/** 32 bytes at any address */
+typedef uint8_t mem_vec32_t __attribute__((vector_size(32), aligned(1),
+    may_alias));
+
+#endif
+
+/** Create vector with all bytes set to @a b. */
+static inline mem_vec_t mem_vec_splat(uint8_t b)
+{
+	mem_vec_t v = { 0 };
+
+	return v + b;
+}
+
+/** Find first matching byte in result of vector comparison.
+ *
+ * @param eq Result of comparison (0xff in matching bytes, zero elsewhere)
+ * @param idx Place to store index of the first matching byte
+ * @return @c true if there is a matching byte
+ */
+static inline bool mem_vec_first(mem_vec_t eq, size_t *idx)
+{
+#if defined(__SSE2__)
+	unsigned mask = __builtin_ia32_pmovmskb128((mem_v16qi_t) eq);
+
+	if (mask == 0)
+		return false;
+
+	*idx = __builtin_ctz(mask);
+	return true;
+#else
+	mem_v2du_t w = (mem_v2du_t) eq;
+
+	if (w[0] != 0) {
+		*idx = __builtin_ctzll(w[0]) / 8;
+		return true;
+	}
+
+	if (w[1] != 0) {
+		*idx = 8 + __builtin_ctzll(w[1]) / 8;
+		return true;
+	}
+
+	return false;
+#endif
+}
+
+/** Determine if result of vector comparison has any matching byte. */
+static inline bool mem_vec_any(mem_vec_t eq)
+{
+#if defined(__SSE2__)
+	return __builtin_ia32_pmovmskb128((mem_v16qi_t) eq) != 0;
+#else
+	mem_v2du_t w = (mem_v2du_t) eq;
+
+	return (w[0] | w[1]) != 0;
+#endif
+}
+
+/** Move up to 16 bytes, blocks may overlap. */
+static inline void mem_move_small(uint8_t *d, const uint8_t *s, size_t n)
+{
+	if (n >= 8) {
+		uint64_t a = *(const mem_u64_t *) s;
+		uint64_t b = *(const mem_u64_t *) (s + n - 8);
+		*(mem_u64_t *) d = a;
+		*(mem_u64_t *) (d + n - 8) = b;
+	} else if (n >= 4) {
+		uint32_t a = *(const mem_u32_t *) s;
+		uint32_t b = *(const mem_u32_t *) (s + n - 4);
+		*(mem_u32_t *) d = a;
+		*(mem_u32_t *) (d + n - 4) = b;
+	} else if (n >= 2) {
+		uint16_t a = *(const mem_u16_t *) s;
+		uint16_t b = *(const mem_u16_t *) (s + n - 2);
+		*(mem_u16_t *) d = a;
+		*(mem_u16_t *) (d + n - 2) = b;
+	} else if (n == 1) {
+		*d = *s;
+	}
+}
+
+/** Move 17 to 64 bytes, blocks may overlap. */
+static inline void mem_move_medium(uint8_t *d, const uint8_t *s, size_t n)
+{
+	mem_vec_t a, b, c, e;
+
+	a = *(const mem_vec_t *) s;
+	b = *(const mem_vec_t *) (s + n - 16);
+
+	if (n <= 32) {
+		*(mem_vec_t *) d = a;
+		*(mem_vec_t *) (d + n - 16) = b;
+		return;
+	}
+
+	c = *(const mem_vec_t *) (s + 16);
+	e = *(const mem_vec_t *) (s + n - 32);
+	*(mem_vec_t *) d = a;
+	*(mem_vec_t *) (d + 16) = c;
+	*(mem_vec_t *) (d + n - 32) = e;
+	*(mem_vec_t *) (d + n - 16) = b;
+}
+
+/** Move more than 64 bytes front to back.
+ *
+ * Safe unless @a d lies inside the source block. The head and the last
+ * 64 bytes are loaded before anything is stored and written last, the
+ * loop in between stores to 16-byte aligned addresses.
+ */
+ATTRIBUTE_OPTIMIZE_NO_TLDP
+static void mem_move_fwd(uint8_t *d, const uint8_t *s, size_t n)
+{
+	mem_vec_t head = *(const mem_vec_t *) s;
+	mem_vec_t t0 = *(const mem_vec_t *) (s + n - 64);
+	mem_vec_t t1 = *(const mem_vec_t *) (s + n - 48);
+	mem_vec_t t2 = *(const mem_vec_t *) (s + n - 32);
+	mem_vec_t t3 = *(const mem_vec_t *) (s + n - 16);
+	mem_vec_t v0, v1, v2, v3;
+	uint8_t *end = d + n;
+	size_t skip = -(uintptr_t) d & (MEM_VEC_SIZE - 1);
+	uint8_t *dp = d + skip;
+	const uint8_t *sp = s + skip;
+
+	while ((size_t) (end - dp) > 64) {
+		v0 = *(const mem_vec_t *) sp;
+		v1 = *(const mem_vec_t *) (sp + 16);
+		v2 = *(const mem_vec_t *) (sp + 32);
+		v3 = *(const mem_vec_t *) (sp + 48);
+		*(mem_avec_t *) dp = (mem_avec_t) v0;
+		*(mem_avec_t *) (dp + 16) = (mem_avec_t) v1;
+		*(mem_avec_t *) (dp + 32) = (mem_avec_t) v2;
+		*(mem_avec_t *) (dp + 48) = (mem_avec_t) v3;
+		dp += 64;
+		sp += 64;
+	}
+
+	*(mem_vec_t *) (end - 64) = t0;
+	*(mem_vec_t *) (end - 48) = t1;
+	*(mem_vec_t *) (end - 32) = t2;
+	*(mem_vec_t *) (end - 16) = t3;
+	*(mem_vec_t *) d = head;
+}
+
+/** Move more than 64 bytes back to front.
+ *
+ * Mirror image of mem_move_fwd(), safe unless @a s lies inside
+ * the destination block.
+ */
+ATTRIBUTE_OPTIMIZE_NO_TLDP
+static void mem_move_bwd(uint8_t *d, const uint8_t *s, size_t n)
+{
+	mem_vec_t tail = *(const mem_vec_t *) (s + n - 16);
+	mem_vec_t h0 = *(const mem_vec_t *) s;
+	mem_vec_t h1 = *(const mem_vec_t *) (s + 16);
+	mem_vec_t h2 = *(const mem_vec_t *) (s + 32);
+	mem_vec_t h3 = *(const mem_vec_t *) (s + 48);
+	mem_vec_t v0, v1, v2, v3;
+	size_t skip = (uintptr_t) (d + n) & (MEM_VEC_SIZE - 1);
+	uint8_t *dp = d + n - skip;
+	const uint8_t *sp = s + n - skip;
+
+	while ((size_t) (dp - d) > 64) {
+		v0 = *(const mem_vec_t *) (sp - 16);
+		v1 = *(const mem_vec_t *) (sp - 32);
+		v2 = *(const mem_vec_t *) (sp - 48);
+		v3 = *(const mem_vec_t *) (sp - 64);
+		*(mem_avec_t *) (dp - 16) = (mem_avec_t) v0;
+		*(mem_avec_t *) (dp - 32) = (mem_avec_t) v1;
+		*(mem_avec_t *) (dp - 48) = (mem_avec_t) v2;
+		*(mem_avec_t *) (dp - 64) = (mem_avec_t) v3;
+		dp -= 64;
+		sp -= 64;
+	}
+
+	*(mem_vec_t *) d = h0;
+	*(mem_vec_t *) (d + 16) = h1;
+	*(mem_vec_t *) (d + 32) = h2;
+	*(mem_vec_t *) (d + 48) = h3;
+	*(mem_vec_t *) (d + n - 16) = tail;
+}
+
+#if defined(__x86_64__)
+
+/** Move more than 128 bytes front to back using AVX2.
+ *
+ * Same as mem_move_fwd() with 32-byte vectors.
+ */
+ATTRIBUTE_OPTIMIZE_NO_TLDP
+__attribute__((target("avx2")))
+static void mem_move_fwd_avx2(uint8_t *d, const uint8_t *s, size_t n)
+{
+	mem_vec32_t head = *(const mem_vec32_t *) s;
+	mem_vec32_t t0 = *(const mem_vec32_t *) (s + n - 128);
+	mem_vec32_t t1 = *(const mem_vec32_t *) (s + n - 96);
+	mem_vec32_t t2 = *(const mem_vec32_t *) (s + n - 64);
+	mem_vec32_t t3 = *(const mem_vec32_t *) (s + n - 32);
+	mem_vec32_t v0, v1, v2, v3;
+	uint8_t *end = d + n;
+	size_t skip = -(uintptr_t) d & 31;
+	uint8_t *dp = d + skip;
+	const uint8_t *sp = s + skip;
+
+	while ((size_t) (end - dp) > 128) {
+		v0 = *(const mem_vec32_t *) sp;
+		v1 = *(const mem_vec32_t *) (sp + 32);
+		v2 = *(const mem_vec32_t *) (sp + 64);
+		v3 = *(const mem_vec32_t *) (sp + 96);
+		*(mem_avec32_t *) dp = (mem_avec32_t) v0;
+		*(mem_avec32_t *) (dp + 32) = (mem_avec32_t) v1;
+		*(mem_avec32_t *) (dp + 64) = (mem_avec32_t) v2;
+		*(mem_avec32_t *) (dp + 96) = (mem_avec32_t) v3;
+		dp += 128;
+		sp += 128;
+	}
+
+	*(mem_vec32_t *) (end - 128) = t0;
+	*(mem_vec32_t *) (end - 96) = t1;
+	*(mem_vec32_t *) (end - 64) = t2;
+	*(mem_vec32_t *) (end - 32) = t3;
+	*(mem_vec32_t *) d = head;
+}
+
+/** Store vector bypassing the cache. */
+static inline void mem_stream(uint8_t *d, mem_vec_t v)
+{
+	asm volatile (
+	    "movntdq %[v], %[d]\n"
+	    : [d] "=m" (*(mem_avec_t *) d)
+	    : [v] "x" (v)
+	);
+}
+
+/** Copy huge non-overlapping block with non-temporal stores.
+ *
+ * Same as mem_move_fwd(), except that the aligned stores do not
+ * allocate cache lines.
+ */
+ATTRIBUTE_OPTIMIZE_NO_TLDP
+static void mem_copy_nt(uint8_t *d, const uint8_t *s, size_t n)
+{
+	mem_vec_t head = *(const mem_vec_t *) s;
+	uint8_t *end = d + n;
+	size_t skip = -(uintptr_t) d & (MEM_VEC_SIZE - 1);
+	uint8_t *dp = d + skip;
+	const uint8_t *sp = s + skip;
+
+	while ((size_t) (end - dp) > 64) {
+		mem_stream(dp, *(const mem_vec_t *) sp);
+		mem_stream(dp + 16, *(const mem_vec_t *) (sp + 16));
+		mem_stream(dp + 32, *(const mem_vec_t *) (sp + 32));
+		mem_stream(dp + 48, *(const mem_vec_t *) (sp + 48));
+		dp += 64;
+		sp += 64;
+	}
+
+	/* Order the non-temporal stores before any later stores */
+	asm volatile (
+	    "sfence\n"
+	    ::: "memory"
+	);
+
+	mem_move_medium(end - 64, s + n - 64, 64);
+	*(mem_vec_t *) d = head;
+}
+
+/** Fill more than 128 bytes using AVX2. */
+ATTRIBUTE_OPTIMIZE_NO_TLDP
+__attribute__((target("avx2")))
+static void mem_set_avx2(uint8_t *d, uint8_t b, size_t n)
+{
+	mem_vec32_t v = { 0 };
+	uint8_t *end = d + n;
+	uint8_t *dp;
+
+	v += b;
+
+	*(mem_vec32_t *) d = v;
+	dp = d + (-(uintptr_t) d & 31);
+
+	while ((size_t) (end - dp) > 128) {
+		*(mem_avec32_t *) dp = (mem_avec32_t) v;
+		*(mem_avec32_t *) (dp + 32) = (mem_avec32_t) v;
+		*(mem_avec32_t *) (dp + 64) = (mem_avec32_t) v;
+		*(mem_avec32_t *) (dp + 96) = (mem_avec32_t) v;
+		dp += 128;
+	}
+
+	*(mem_vec32_t *) (end - 128) = v;
+	*(mem_vec32_t *) (end - 96) = v;
+	*(mem_vec32_t *) (end - 64) = v;
+	*(mem_vec32_t *) (end - 32) = v;
+}
+
+#endif
+
+/** Move memory block, blocks may overlap. */
+static void mem_move_simd(uint8_t *d, const uint8_t *s, size_t n)
+{
+	if (n <= 16) {
+		mem_move_small(d, s, n);
+		return;
+	}
+
+	if (n <= 64) {
+		mem_move_medium(d, s, n);
+		return;
+	}
+
+	/* Destination outside of (s, s + n)? */
+	if ((uintptr_t) d - (uintptr_t) s >= n) {
+#if defined(__x86_64__)
+		/*
+		 * Huge blocks only get here without ERMS. Non-temporal
+		 * stores require that the blocks do not overlap.
+		 */
+		if (n >= MEM_NT_THRESHOLD && (uintptr_t) s - (uintptr_t) d >= n) {
+			mem_copy_nt(d, s, n);
+			return;
+		}
+
+		if (n > 128 && (mem_features_get() & mem_feat_avx2) != 0) {
+			mem_move_fwd_avx2(d, s, n);
+			return;
+		}
+#endif
+		mem_move_fwd(d, s, n);
+	} else {
+		mem_move_bwd(d, s, n);
+	}
+}
+
 /** Fill memory block with a constant value. */
-DO_NOT_DISCARD
 ATTRIBUTE_OPTIMIZE_NO_TLDP
-    void *memset(void *dest, int b, size_t n)
+static void mem_set_simd(uint8_t *d, uint8_t b, size_t n)
+{
+	mem_vec_t v;
+	uint64_t p;
+	uint8_t *end = d + n;
+	uint8_t *dp;
+
+	if (n < 16) {
+		p = b * UINT64_C(0x0101010101010101);
+
+		if (n >= 8) {
+			*(mem_u64_t *) d = p;
+			*(mem_u64_t *) (end - 8) = p;
+		} else if (n >= 4) {
+			*(mem_u32_t *) d = p;
+			*(mem_u32_t *) (end - 4) = p;
+		} else if (n >= 2) {
+			*(mem_u16_t *) d = p;
+			*(mem_u16_t *) (end - 2) = p;
+		} else if (n == 1) {
+			*d = b;
+		}
+
+		return;
+	}
+
+	v = mem_vec_splat(b);
+
+	if (n <= 32) {
+		*(mem_vec_t *) d = v;
+		*(mem_vec_t *) (end - 16) = v;
+		return;
+	}
+
+	if (n <= 64) {
+		*(mem_vec_t *) d = v;
+		*(mem_vec_t *) (d + 16) = v;
+		*(mem_vec_t *) (end - 32) = v;
+		*(mem_vec_t *) (end - 16) = v;
+		return;
+	}
+
+#if defined(__x86_64__)
+	if (n > 128 && (mem_features_get() & mem_feat_avx2) != 0) {
+		mem_set_avx2(d, b, n);
+		return;
+	}
+#endif
+
+	*(mem_vec_t *) d = v;
+	dp = d + (-(uintptr_t) d & (MEM_VEC_SIZE - 1));
+
+	while ((size_t) (end - dp) > 64) {
+		*(mem_avec_t *) dp = (mem_avec_t) v;
+		*(mem_avec_t *) (dp + 16) = (mem_avec_t) v;
+		*(mem_avec_t *) (dp + 32) = (mem_avec_t) v;
+		*(mem_avec_t *) (dp + 48) = (mem_avec_t) v;
+		dp += 64;
+	}
+
+	*(mem_vec_t *) (end - 64) = v;
+	*(mem_vec_t *) (end - 48) = v;
+	*(mem_vec_t *) (end - 32) = v;
+	*(mem_vec_t *) (end - 16) = v;
+}
+
+/** Search memory block for a byte.
+ *
+ * Only bytes inside the block are read: the first and the last
+ * 16 bytes are checked with unaligned loads, which may overlap
+ * the aligned loads in between.
+ */
+static void *mem_chr_simd(const uint8_t *s, uint8_t c, size_t n)
+{
+	const uint8_t *end = s + n;
+	const uint8_t *p;
+	mem_vec_t vc;
+	mem_vec_t e0, e1, e2, e3;
+	size_t i;
+
+	if (n < 16) {
+		for (i = 0; i < n; i++) {
+			if (s[i] == c)
+				return (void *) &s[i];
+		}
+
+		return NULL;
+	}
+
+	vc = mem_vec_splat(c);
+
+	if (mem_vec_first((mem_vec_t) (*(const mem_vec_t *) s == vc), &i))
+		return (void *) (s + i);
+
+	p = s + MEM_VEC_SIZE - ((uintptr_t) s & (MEM_VEC_SIZE - 1));
+
+	while (end - p >= 64) {
+		e0 = (mem_vec_t) (*(const mem_avec_t *) p == (mem_avec_t) vc);
+		e1 = (mem_vec_t) (*(const mem_avec_t *) (p + 16) ==
+		    (mem_avec_t) vc);
+		e2 = (mem_vec_t) (*(const mem_avec_t *) (p + 32) ==
+		    (mem_avec_t) vc);
+		e3 = (mem_vec_t) (*(const mem_avec_t *) (p + 48) ==
+		    (mem_avec_t) vc);
+
+		if (mem_vec_any(e0 | e1 | e2 | e3)) {
+			if (mem_vec_first(e0, &i))
+				return (void *) (p + i);
+			if (mem_vec_first(e1, &i))
+				return (void *) (p + 16 + i);
+			if (mem_vec_first(e2, &i))
+				return (void *) (p + 32 + i);
+			if (mem_vec_first(e3, &i))
+				return (void *) (p + 48 + i);
+		}
+
+		p += 64;
+	}
+
+	while (end - p >= 16) {
+		e0 = (mem_vec_t) (*(const mem_avec_t *) p == (mem_avec_t) vc);
+		if (mem_vec_first(e0, &i))
+			return (void *) (p + i);
+		p += 16;
+	}
+
+	/* Bytes before p are known not to match */
+	if (p < end) {
+		e0 = (mem_vec_t) (*(const mem_vec_t *) (end - 16) == vc);
+		if (mem_vec_first(e0, &i))
+			return (void *) (end - 16 + i);
+	}
+
+	return NULL;
+}
+
+#else
+
+/** Machine word that may alias any other type */
+typedef unsigned long mem_word_t __attribute__((may_alias));
+
+/** Fill memory block with a constant value, a word at a time. */
+ATTRIBUTE_OPTIMIZE_NO_TLDP
+static void mem_set_generic(void *dest, int b, size_t n)
 {
 	char *pb;
 	unsigned long *pw;
@@ -75,7 +714,7 @@ ATTRIBUTE_OPTIMIZE_NO_TLDP
 	/* Compute remaining size. */
 	n -= fill;
 	if (n == 0)
-		return dest;
+		return;
 
 	n_words = n / word_size;
 	n = n % word_size;
@@ -98,8 +737,6 @@ ATTRIBUTE_OPTIMIZE_NO_TLDP
 	i = n;
 	while (i-- != 0)
 		*pb++ = b;
-
-	return dest;
 }
 
 struct along {
@@ -123,10 +760,9 @@ ATTRIBUTE_OPTIMIZE_NO_TLDP
 	return (char *) dst;
 }
 
-/** Copy memory block. */
-DO_NOT_DISCARD
+/** Copy memory block, a word at a time. */
 ATTRIBUTE_OPTIMIZE_NO_TLDP
-    void *memcpy(void *dst, const void *src, size_t n)
+static void mem_copy_generic(void *dst, const void *src, size_t n)
 {
 	size_t i;
 	size_t mod, fill;
@@ -146,8 +782,10 @@ ATTRIBUTE_OPTIMIZE_NO_TLDP
 	 */
 
 	if (((uintptr_t) dst & (word_size - 1)) !=
-	    ((uintptr_t) src & (word_size - 1)))
-		return unaligned_memcpy(dst, src, n);
+	    ((uintptr_t) src & (word_size - 1))) {
+		unaligned_memcpy(dst, src, n);
+		return;
+	}
 
 	/*
 	 * mod is the address modulo word size. fill is the length of the
@@ -173,7 +811,7 @@ ATTRIBUTE_OPTIMIZE_NO_TLDP
 
 	n -= fill;
 	if (n == 0)
-		return dst;
+		return;
 
 	/* Pointers to aligned segment. */
 
@@ -198,44 +836,182 @@ ATTRIBUTE_OPTIMIZE_NO_TLDP
 	i = n;
 	while (i-- != 0)
 		*dstb++ = *srcb++;
-
-	return dst;
 }
 
-/** Move memory block with possible overlapping. */
-DO_NOT_DISCARD
+/** Move memory block with possible overlapping.
+ *
+ * If source and destination are congruent modulo the word size, the
+ * overlapping part is moved a word at a time, otherwise byte by byte.
+ */
 ATTRIBUTE_OPTIMIZE_NO_TLDP
-void *memmove(void *dst, const void *src, size_t n)
+static void mem_move_generic(void *dst, const void *src, size_t n)
 {
+	const size_t word_size = sizeof(unsigned long);
 	const uint8_t *sp;
 	uint8_t *dp;
-
-	/* Nothing to do? */
-	if (src == dst)
-		return dst;
+	bool words;
 
 	/* Non-overlapping? */
 	if (dst >= src + n || src >= dst + n) {
-		return memcpy(dst, src, n);
+		mem_copy_generic(dst, src, n);
+		return;
 	}
 
+	words = (((uintptr_t) dst ^ (uintptr_t) src) & (word_size - 1)) == 0;
+
 	/* Which direction? */
 	if (src > dst) {
 		/* Forwards. */
 		sp = src;
 		dp = dst;
 
+		if (words) {
+			while (n > 0 && ((uintptr_t) dp & (word_size - 1)) != 0) {
+				*dp++ = *sp++;
+				n--;
+			}
+
+			while (n >= word_size) {
+				*(mem_word_t *) dp = *(const mem_word_t *) sp;
+				dp += word_size;
+				sp += word_size;
+				n -= word_size;
+			}
+		}
+
 		while (n-- != 0)
 			*dp++ = *sp++;
 	} else {
 		/* Backwards. */
-		sp = src + (n - 1);
-		dp = dst + (n - 1);
+		sp = src + n;
+		dp = dst + n;
+
+		if (words) {
+			while (n > 0 && ((uintptr_t) dp & (word_size - 1)) != 0) {
+				*--dp = *--sp;
+				n--;
+			}
+
+			while (n >= word_size) {
+				dp -= word_size;
+				sp -= word_size;
+				*(mem_word_t *) dp = *(const mem_word_t *) sp;
+				n -= word_size;
+			}
+		}
 
 		while (n-- != 0)
-			*dp-- = *sp--;
+			*--dp = *--sp;
+	}
+}
+
+/** Search memory block for a byte, a word at a time.
+ *
+ * A word contains the byte iff the word XORed with the byte repeated
+ * contains a zero byte, which is tested using the classic
+ * (x - 0x01..01) & ~x & 0x80..80 trick.
+ */
+static void *mem_chr_generic(const void *s, int c, size_t n)
+{
+	const size_t word_size = sizeof(unsigned long);
+	const unsigned long ones = ~0UL / 0xff;
+	const unsigned long highs = ones << 7;
+	const uint8_t *u = s;
+	uint8_t uc = (uint8_t) c;
+	unsigned long pattern;
+	unsigned long w;
+
+	while (n > 0 && ((uintptr_t) u & (word_size - 1)) != 0) {
+		if (*u == uc)
+			return (void *) u;
+		u++;
+		n--;
 	}
 
+	pattern = ones * uc;
+	while (n >= word_size) {
+		w = *(const mem_word_t *) u ^ pattern;
+		if (((w - ones) & ~w & highs) != 0)
+			break;
+
+		u += word_size;
+		n -= word_size;
+	}
+
+	while (n > 0) {
+		if (*u == uc)
+			return (void *) u;
+		u++;
+		n--;
+	}
+
+	return NULL;
+}
+
+#endif
+
+/** Fill memory block with a constant value. */
+DO_NOT_DISCARD
+ATTRIBUTE_OPTIMIZE_NO_TLDP
+    void *memset(void *dest, int b, size_t n)
+{
+#if defined(__x86_64__)
+	if (mem_use_erms(n)) {
+		mem_stosb(dest, b, n);
+		return dest;
+	}
+#endif
+
+#ifdef MEM_SIMD
+	mem_set_simd(dest, b, n);
+#else
+	mem_set_generic(dest, b, n);
+#endif
+	return dest;
+}
+
+/** Copy memory block. */
+DO_NOT_DISCARD
+ATTRIBUTE_OPTIMIZE_NO_TLDP
+    void *memcpy(void *dst, const void *src, size_t n)
+{
+#if defined(__x86_64__)
+	if (mem_use_erms(n)) {
+		mem_movsb(dst, src, n);
+		return dst;
+	}
+#endif
+
+#ifdef MEM_SIMD
+	mem_move_simd(dst, src, n);
+#else
+	mem_copy_generic(dst, src, n);
+#endif
+	return dst;
+}
+
+/** Move memory block with possible overlapping. */
+DO_NOT_DISCARD
+ATTRIBUTE_OPTIMIZE_NO_TLDP
+void *memmove(void *dst, const void *src, size_t n)
+{
+	/* Nothing to do? */
+	if (src == dst)
+		return dst;
+
+#if defined(__x86_64__)
+	/* 'rep movsb' is only fast for non-overlapping blocks */
+	if (mem_use_erms(n) && (dst >= src + n || src >= dst + n)) {
+		mem_movsb(dst, src, n);
+		return dst;
+	}
+#endif
+
+#ifdef MEM_SIMD
+	mem_move_simd(dst, src, n);
+#else
+	mem_move_generic(dst, src, n);
+#endif
 	return dst;
 }
 
@@ -281,16 +1057,11 @@ DO_NOT_DISCARD
 ATTRIBUTE_OPTIMIZE_NO_TLDP
 void *memchr(const void *s, int c, size_t n)
 {
-	uint8_t *u = (uint8_t *) s;
-	unsigned char uc = (unsigned char) c;
-	size_t i;
-
-	for (i = 0; i < n; i++) {
-		if (u[i] == uc)
-			return (void *) &u[i];
-	}
-
-	return NULL;
+#ifdef MEM_SIMD
+	return mem_chr_simd(s, (uint8_t) c, n);
+#else
+	return mem_chr_generic(s, c, n);
+#endif
 }
 
 /** @}
@@ -33,11 +33,31 @@
 /**
  * @file
  * @brief Quicksort.
+ *
+ * Pattern-defeating quicksort (after Orson Peters' pdqsort): introsort
+ * with median-of-three or ninther pivot selection, insertion sort for
+ * short ranges, a heapsort fallback after too many unbalanced partitions
+ * and detection of already partitioned ranges and of runs of elements
+ * equal to the pivot. The worst case is O(n log n) and recursion depth
+ * is O(log n).
+ *
+ * Elements are only ever swapped, using a swap function chosen
+ * once per call according to the element size and alignment.
  */
 
 #include <qsort.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
+
+enum {
+	/** Ranges shorter than this are sorted by insertion sort */
+	qs_insertion_threshold = 24,
+	/** Ranges longer than this use ninther pivot selection */
+	qs_ninther_threshold = 128,
+	/** Maximum number of element moves in partial insertion sort */
+	qs_partial_insertion_limit = 8
+};
 
 /** Quicksort spec */
 typedef struct {
@@ -46,6 +66,7 @@ typedef struct {
 	size_t size;
 	int (*compar)(const void *, const void *, void *);
 	void *arg;
+	void (*swap)(void *, void *, size_t);
 } qs_spec_t;
 
 /** Comparison function wrapper.
@@ -70,7 +91,7 @@ static int compar_wrap(const void *a, const void *b, void *arg)
  * @param i First element index
  * @param j Second element index
  */
-static bool elem_lt(qs_spec_t *qs, size_t i, size_t j)
+static inline bool elem_lt(qs_spec_t *qs, size_t i, size_t j)
 {
 	const void *a;
 	const void *b;
@@ -84,83 +105,405 @@ static bool elem_lt(qs_spec_t *qs, size_t i, size_t j)
 	return r < 0;
 }
 
+/** Swap two 32-bit aligned elements of 4 bytes. */
+static void swap_u32(void *a, void *b, size_t size)
+{
+	uint32_t t = *(uint32_t *) a;
+
+	*(uint32_t *) a = *(uint32_t *) b;
+	*(uint32_t *) b = t;
+}
+
+/** Swap two 64-bit aligned elements of 8 bytes. */
+static void swap_u64(void *a, void *b, size_t size)
+{
+	uint64_t t = *(uint64_t *) a;
+
+	*(uint64_t *) a = *(uint64_t *) b;
+	*(uint64_t *) b = t;
+}
+
+/** Swap two word-aligned elements whose size is a multiple of word size. */
+static void swap_words(void *a, void *b, size_t size)
+{
+	unsigned long *wa = a;
+	unsigned long *wb = b;
+	unsigned long t;
+	size_t k;
+
+	for (k = 0; k < size / sizeof(unsigned long); k++) {
+		t = wa[k];
+		wa[k] = wb[k];
+		wb[k] = t;
+	}
+}
+
+/** Swap two elements of any size and alignment. */
+static void swap_bytes(void *a, void *b, size_t size)
+{
+	char *ca = a;
+	char *cb = b;
+	char t;
+	size_t k;
+
+	for (k = 0; k < size; k++) {
+		t = ca[k];
+		ca[k] = cb[k];
+		cb[k] = t;
+	}
+}
+
+/** Choose swap function for elements of an array.
+ *
+ * @param base Array
+ * @param size Size of member in bytes
+ * @return Swap function
+ */
+static void (*swap_select(void *base, size_t size))(void *, void *, size_t)
+{
+	uintptr_t align = (uintptr_t) base | size;
+
+	if (size == sizeof(uint64_t) && align % _Alignof(uint64_t) == 0)
+		return swap_u64;
+	if (size == sizeof(uint32_t) && align % _Alignof(uint32_t) == 0)
+		return swap_u32;
+	if (align % sizeof(unsigned long) == 0)
+		return swap_words;
+
+	return swap_bytes;
+}
+
 /** Swap two elements.
  *
  * @param qs Quicksort spec
  * @param i First element index
  * @param j Second element index
  */
-static void elem_swap(qs_spec_t *qs, size_t i, size_t j)
+static inline void elem_swap(qs_spec_t *qs, size_t i, size_t j)
 {
-	char *a;
-	char *b;
-	char t;
-	size_t k;
+	qs->swap(qs->base + i * qs->size, qs->base + j * qs->size, qs->size);
+}
 
-	a = qs->base + i * qs->size;
-	b = qs->base + j * qs->size;
+/** Sort three elements.
+ *
+ * @param qs Quicksort spec
+ * @param a First element index
+ * @param b Second element index
+ * @param c Third element index
+ */
+static void sort3(qs_spec_t *qs, size_t a, size_t b, size_t c)
+{
+	if (elem_lt(qs, b, a))
+		elem_swap(qs, a, b);
+	if (elem_lt(qs, c, b))
+		elem_swap(qs, b, c);
+	if (elem_lt(qs, b, a))
+		elem_swap(qs, a, b);
+}
+
+/** Sort a range of indices using insertion sort.
+ *
+ * @param qs Quicksort spec
+ * @param begin Lower bound (inclusive)
+ * @param end Upper bound (exclusive)
+ * @param guarded @c false if the element before @a begin is known
+ *                not to be greater than any element of the range
+ */
+static void insertion_sort(qs_spec_t *qs, size_t begin, size_t end,
+    bool guarded)
+{
+	size_t i, j;
 
-	for (k = 0; k < qs->size; k++) {
-		t = a[k];
-		a[k] = b[k];
-		b[k] = t;
+	for (i = begin + 1; i < end; i++) {
+		j = i;
+		while ((!guarded || j > begin) && elem_lt(qs, j, j - 1)) {
+			elem_swap(qs, j, j - 1);
+			--j;
+		}
 	}
 }
 
-/** Partition a range of indices.
+/** Attempt to sort a range of indices using insertion sort.
+ *
+ * Gives up after moving elements by more than a few positions in total.
  *
  * @param qs Quicksort spec
- * @param lo Lower bound (inclusive)
- * @param hi Upper bound (inclusive)
- * @return Pivot index
+ * @param begin Lower bound (inclusive)
+ * @param end Upper bound (exclusive)
+ * @return @c true if the range has been sorted
  */
-static size_t partition(qs_spec_t *qs, size_t lo, size_t hi)
+static bool partial_insertion_sort(qs_spec_t *qs, size_t begin, size_t end)
 {
-	size_t pivot;
+	size_t moves = 0;
 	size_t i, j;
 
-	pivot = lo + (hi - lo) / 2;
-	i = lo;
-	j = hi;
-	while (true) {
-		while (elem_lt(qs, i, pivot))
-			++i;
-		while (elem_lt(qs, pivot, j))
+	for (i = begin + 1; i < end; i++) {
+		j = i;
+		while (j > begin && elem_lt(qs, j, j - 1)) {
+			elem_swap(qs, j, j - 1);
 			--j;
+		}
+
+		moves += i - j;
+		if (moves > qs_partial_insertion_limit)
+			return false;
+	}
+
+	return true;
+}
+
+/** Restore heap property below a node.
+ *
+ * @param qs Quicksort spec
+ * @param begin Index of the heap root
+ * @param node Node (relative to @a begin)
+ * @param n Number of heap nodes
+ */
+static void sift_down(qs_spec_t *qs, size_t begin, size_t node, size_t n)
+{
+	size_t child;
+
+	while ((child = 2 * node + 1) < n) {
+		if (child + 1 < n && elem_lt(qs, begin + child, begin + child + 1))
+			++child;
+		if (!elem_lt(qs, begin + node, begin + child))
+			break;
+
+		elem_swap(qs, begin + node, begin + child);
+		node = child;
+	}
+}
+
+/** Sort a range of indices using heapsort.
+ *
+ * @param qs Quicksort spec
+ * @param begin Lower bound (inclusive)
+ * @param end Upper bound (exclusive)
+ */
+static void heap_sort(qs_spec_t *qs, size_t begin, size_t end)
+{
+	size_t n = end - begin;
+	size_t i;
+
+	for (i = n / 2; i > 0; i--)
+		sift_down(qs, begin, i - 1, n);
+
+	for (i = n - 1; i > 0; i--) {
+		elem_swap(qs, begin, begin + i);
+		sift_down(qs, begin, 0, i);
+	}
+}
+
+/** Partition a range, placing elements equal to the pivot right.
+ *
+ * The pivot is at @a begin. An element not less than the pivot must
+ * exist in the range, which is ensured by pivot selection.
+ *
+ * @param qs Quicksort spec
+ * @param begin Lower bound (inclusive)
+ * @param end Upper bound (exclusive)
+ * @param already Place to store @c true if no elements had to be swapped
+ * @return Final pivot index
+ */
+static size_t partition_right(qs_spec_t *qs, size_t begin, size_t end,
+    bool *already)
+{
+	size_t first = begin;
+	size_t last = end;
+
+	/* Find first element not less than the pivot */
+	while (elem_lt(qs, ++first, begin))
+		;
+
+	/*
+	 * Find last element less than the pivot. If there is none before
+	 * @c first, guard against running past it.
+	 */
+	if (first - 1 == begin) {
+		while (first < last && !elem_lt(qs, --last, begin))
+			;
+	} else {
+		while (!elem_lt(qs, --last, begin))
+			;
+	}
+
+	*already = first >= last;
+
+	while (first < last) {
+		elem_swap(qs, first, last);
+		while (elem_lt(qs, ++first, begin))
+			;
+		while (!elem_lt(qs, --last, begin))
+			;
+	}
+
+	elem_swap(qs, begin, first - 1);
+	return first - 1;
+}
+
+/** Partition a range, placing elements equal to the pivot left.
+ *
+ * Used when the pivot is equal to the element before the range,
+ * so that all elements equal to it end up left of the returned index
+ * and need no further sorting.
+ *
+ * @param qs Quicksort spec
+ * @param begin Lower bound (inclusive)
+ * @param end Upper bound (exclusive)
+ * @return Final pivot index
+ */
+static size_t partition_left(qs_spec_t *qs, size_t begin, size_t end)
+{
+	size_t first = begin;
+	size_t last = end;
+
+	while (elem_lt(qs, begin, --last))
+		;
+
+	if (last + 1 == end) {
+		while (first < last && !elem_lt(qs, begin, ++first))
+			;
+	} else {
+		while (!elem_lt(qs, begin, ++first))
+			;
+	}
+
+	while (first < last) {
+		elem_swap(qs, first, last);
+		while (elem_lt(qs, begin, --last))
+			;
+		while (!elem_lt(qs, begin, ++first))
+			;
+	}
 
-		if (i >= j)
-			return j;
+	elem_swap(qs, begin, last);
+	return last;
+}
 
-		elem_swap(qs, i, j);
+/** Swap a few elements of a range to break up patterns.
+ *
+ * @param qs Quicksort spec
+ * @param begin Lower bound (inclusive)
+ * @param end Upper bound (exclusive)
+ */
+static void break_patterns(qs_spec_t *qs, size_t begin, size_t end)
+{
+	size_t n = end - begin;
+	size_t q = n / 4;
 
-		/* Need to follow pivot movement */
-		if (i == pivot)
-			pivot = j;
-		else if (j == pivot)
-			pivot = i;
+	elem_swap(qs, begin, begin + q);
+	elem_swap(qs, end - 1, end - q);
 
-		i++;
-		j--;
+	if (n > qs_ninther_threshold) {
+		elem_swap(qs, begin + 1, begin + q + 1);
+		elem_swap(qs, begin + 2, begin + q + 2);
+		elem_swap(qs, end - 2, end - q - 1);
+		elem_swap(qs, end - 3, end - q - 2);
 	}
 }
 
 /** Sort a range of indices.
+ *
+ * Recurses into the smaller part and iterates over the larger one.
  *
  * @param qs Quicksort spec
- * @param lo Lower bound (inclusive)
- * @param hi Upper bound (inclusive)
+ * @param begin Lower bound (inclusive)
+ * @param end Upper bound (exclusive)
+ * @param bad_allowed Number of unbalanced partitions allowed before
+ *                    switching to heapsort
+ * @param leftmost @c true if there is no element before @a begin
+ *                 known to be less than or equal to the whole range
  */
-static void quicksort(qs_spec_t *qs, size_t lo, size_t hi)
+static void quicksort(qs_spec_t *qs, size_t begin, size_t end,
+    unsigned bad_allowed, bool leftmost)
 {
-	size_t p;
+	size_t size, half;
+	size_t pivot;
+	size_t lsize, rsize;
+	bool already;
+
+	while (true) {
+		size = end - begin;
+
+		if (size < qs_insertion_threshold) {
+			insertion_sort(qs, begin, end, leftmost);
+			return;
+		}
+
+		/* Move median of three (or ninther) to begin */
+		half = size / 2;
+		if (size > qs_ninther_threshold) {
+			sort3(qs, begin, begin + half, end - 1);
+			sort3(qs, begin + 1, begin + half - 1, end - 2);
+			sort3(qs, begin + 2, begin + half + 1, end - 3);
+			sort3(qs, begin + half - 1, begin + half, begin + half + 1);
+			elem_swap(qs, begin, begin + half);
+		} else {
+			sort3(qs, begin + half, begin, end - 1);
+		}
+
+		/*
+		 * Pivot equal to the preceding element (which is not greater
+		 * than any element in the range): skip all elements equal
+		 * to it.
+		 */
+		if (!leftmost && !elem_lt(qs, begin - 1, begin)) {
+			begin = partition_left(qs, begin, end) + 1;
+			continue;
+		}
+
+		pivot = partition_right(qs, begin, end, &already);
+		lsize = pivot - begin;
+		rsize = end - (pivot + 1);
 
-	if (lo < hi) {
-		p = partition(qs, lo, hi);
-		quicksort(qs, lo, p);
-		quicksort(qs, p + 1, hi);
+		if (lsize < size / 8 || rsize < size / 8) {
+			/* Highly unbalanced partition */
+			if (--bad_allowed == 0) {
+				heap_sort(qs, begin, end);
+				return;
+			}
+
+			if (lsize >= qs_insertion_threshold)
+				break_patterns(qs, begin, pivot);
+			if (rsize >= qs_insertion_threshold)
+				break_patterns(qs, pivot + 1, end);
+		} else if (already &&
+		    partial_insertion_sort(qs, begin, pivot) &&
+		    partial_insertion_sort(qs, pivot + 1, end)) {
+			/* Probably sorted input */
+			return;
+		}
+
+		if (lsize < rsize) {
+			quicksort(qs, begin, pivot, bad_allowed, leftmost);
+			begin = pivot + 1;
+			leftmost = false;
+		} else {
+			quicksort(qs, pivot + 1, end, bad_allowed, false);
+			end = pivot;
+		}
 	}
 }
 
+/** Sort array.
+ *
+ * @param qs Quicksort spec
+ */
+static void qs_sort(qs_spec_t *qs)
+{
+	unsigned log2n = 0;
+	size_t n;
+
+	if (qs->nmemb < 2)
+		return;
+
+	for (n = qs->nmemb; n > 1; n >>= 1)
+		++log2n;
+
+	qs->swap = swap_select(qs->base, qs->size);
+	quicksort(qs, 0, qs->nmemb, log2n, true);
+}
+
 /** Quicksort.
  *
  * @param base Array to sort
@@ -173,16 +516,13 @@ void qsort(void *base, size_t nmemb, size_t size, int (*compar)(const void *,
 {
 	qs_spec_t qs;
 
-	if (nmemb == 0)
-		return;
-
 	qs.base = base;
 	qs.nmemb = nmemb;
 	qs.size = size;
 	qs.compar = compar_wrap;
 	qs.arg = compar;
 
-	quicksort(&qs, 0, nmemb - 1);
+	qs_sort(&qs);
 }
 
 /** Quicksort with extra argument to comparison function.
@@ -198,16 +538,13 @@ void qsort_r(void *base, size_t nmemb, size_t size, int (*compar)(const void *,
 {
 	qs_spec_t qs;
 
-	if (nmemb == 0)
-		return;
-
 	qs.base = base;
 	qs.nmemb = nmemb;
 	qs.size = size;
 	qs.compar = compar;
 	qs.arg = arg;
 
-	quicksort(&qs, 0, nmemb - 1);
+	qs_sort(&qs);
 }
 
 /** @}
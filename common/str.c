@@ -130,12 +130,238 @@
 /** Number of data bits in a UTF-8 continuation byte */
 #define CONT_BITS  6
 
+/*
+ * Most strings are mostly or entirely ASCII. Runs of ASCII characters are
+ * skipped in blocks of 16 bytes (with SSE2) or one machine word, decoding
+ * one character at a time only outside of them, so that the results are
+ * the same as with str_decode() even for invalid UTF-8.
+ *
+ * The length of a string is not known in advance, so a block may extend
+ * beyond the terminating null character. A block is only read if it does
+ * not cross a page boundary, hence it cannot fault if its first byte
+ * does not.
+ */
+
+/** Smallest page size of all supported architectures */
+#define STR_PAGE_SIZE  4096
+
+#if defined(__SSE2__)
+
+/** Number of bytes processed in one step */
+#define STR_BLOCK  16
+
+/** 16 bytes at any address */
+typedef char str_vec_t __attribute__((vector_size(16), aligned(1),
+    may_alias));
+
+/** Get mask with bit i set iff byte i is zero or not ASCII. */
+static inline unsigned str_block_mask(const char *p)
+{
+	str_vec_t v = *(const str_vec_t *) p;
+	str_vec_t z = { 0 };
+
+	return __builtin_ia32_pmovmskb128(v) |
+	    __builtin_ia32_pmovmskb128((str_vec_t) (v == z));
+}
+
+/** Get mask with bit i set iff byte i is zero. */
+static inline unsigned str_block_zero(const char *p)
+{
+	str_vec_t v = *(const str_vec_t *) p;
+	str_vec_t z = { 0 };
+
+	return __builtin_ia32_pmovmskb128((str_vec_t) (v == z));
+}
+
+/** Get mask with bit i set iff byte i is zero or not ASCII in @a a or
+ * bytes i of @a a and @a b differ.
+ */
+static inline unsigned str_block_mask2(const char *a, const char *b)
+{
+	str_vec_t va = *(const str_vec_t *) a;
+	str_vec_t vb = *(const str_vec_t *) b;
+	str_vec_t z = { 0 };
+
+	return __builtin_ia32_pmovmskb128(va) |
+	    __builtin_ia32_pmovmskb128((str_vec_t) (va == z)) |
+	    __builtin_ia32_pmovmskb128((str_vec_t) (va != vb));
+}
+
+/** Get index of first byte flagged in a non-zero mask. */
+static inline size_t str_mask_first(unsigned mask)
+{
+	return __builtin_ctz(mask);
+}
+
+#else
+
+/** Number of bytes processed in one step */
+#define STR_BLOCK  sizeof(size_t)
+
+/** Machine word at any address */
+typedef size_t str_word_t __attribute__((aligned(1), may_alias));
+
+/** Word with all bytes set to 0x7f */
+#define STR_LO7  ((size_t) -1 / 0xff * 0x7f)
+
+/** Get mask with the top bit of each zero byte of @a w set.
+ *
+ * Unlike the usual (w - 0x01..01) & ~w & 0x80..80, this is exact, so that
+ * the first zero byte can be found regardless of byte order.
+ */
+static inline size_t str_word_zero(size_t w)
+{
+	return ~(((w & STR_LO7) + STR_LO7) | w | STR_LO7);
+}
+
+/** Get mask with top bit set in each zero byte. */
+static inline size_t str_block_zero(const char *p)
+{
+	return str_word_zero(*(const str_word_t *) p);
+}
+
+/** Get mask with top bit set in each byte that is zero or not ASCII. */
+static inline size_t str_block_mask(const char *p)
+{
+	size_t w = *(const str_word_t *) p;
+
+	return (w & ~STR_LO7) | str_word_zero(w);
+}
+
+/** Get mask with top bit set in each byte that is zero or not ASCII in
+ * @a a or differs between @a a and @a b.
+ */
+static inline size_t str_block_mask2(const char *a, const char *b)
+{
+	size_t wa = *(const str_word_t *) a;
+	size_t wb = *(const str_word_t *) b;
+
+	return (wa & ~STR_LO7) | str_word_zero(wa) |
+	    (~str_word_zero(wa ^ wb) & ~STR_LO7);
+}
+
+/** Get index of first byte flagged in a non-zero mask. */
+static inline size_t str_mask_first(size_t mask)
+{
+#ifdef __BE__
+	return __builtin_clzl(mask) / 8;
+#else
+	return __builtin_ctzl(mask) / 8;
+#endif
+}
+
+#endif
+
+/** Determine if a block at @a p can be read without crossing a page. */
+static inline bool str_block_safe(const char *p)
+{
+	return ((uintptr_t) p & (STR_PAGE_SIZE - 1)) <= STR_PAGE_SIZE - STR_BLOCK;
+}
+
+/** Find terminating null character.
+ *
+ * @param s    String.
+ * @param size Maximum number of bytes to consider.
+ *
+ * @return Offset of the null character or @a size if there is no null
+ *         character among the first @a size bytes.
+ */
+static size_t str_zero_pos(const char *s, size_t size)
+{
+	size_t n = 0;
+
+	/* Align to block size so that the page boundary check is not needed */
+	while (n < size && ((uintptr_t) (s + n) & (STR_BLOCK - 1)) != 0) {
+		if (s[n] == 0)
+			return n;
+
+		n++;
+	}
+
+	while (size - n >= STR_BLOCK) {
+		if (str_block_zero(s + n) != 0)
+			return n + str_mask_first(str_block_zero(s + n));
+
+		n += STR_BLOCK;
+	}
+
+	while (n < size && s[n] != 0)
+		n++;
+
+	return n;
+}
+
+/** Get length of run of ASCII characters.
+ *
+ * @param s    String (not necessarily NULL-terminated).
+ * @param size Maximum number of bytes to consider.
+ *
+ * @return Number of leading bytes of @a s, up to @a size, that are
+ *         ASCII characters other than the null character.
+ */
+static size_t str_ascii_run(const char *s, size_t size)
+{
+	size_t n = 0;
+
+	while (n < size) {
+		if (size - n >= STR_BLOCK && str_block_safe(s + n)) {
+			if (str_block_mask(s + n) != 0)
+				return n + str_mask_first(str_block_mask(s + n));
+
+			n += STR_BLOCK;
+		} else {
+			if (s[n] == 0 || (s[n] & 0x80) != 0)
+				return n;
+
+			n++;
+		}
+	}
+
+	return n;
+}
+
+/** Get length of common prefix of two strings consisting of ASCII characters.
+ *
+ * @param a    First string.
+ * @param b    Second string.
+ * @param size Maximum number of bytes to consider.
+ *
+ * @return Number of leading bytes, up to @a size, that are equal in @a a
+ *         and @a b and are ASCII characters other than the null character.
+ */
+static size_t str_ascii_common(const char *a, const char *b, size_t size)
+{
+	size_t n = 0;
+
+	while (n < size) {
+		if (size - n >= STR_BLOCK && str_block_safe(a + n) &&
+		    str_block_safe(b + n)) {
+			if (str_block_mask2(a + n, b + n) != 0) {
+				return n +
+				    str_mask_first(str_block_mask2(a + n, b + n));
+			}
+
+			n += STR_BLOCK;
+		} else {
+			if (a[n] == 0 || (a[n] & 0x80) != 0 || a[n] != b[n])
+				return n;
+
+			n++;
+		}
+	}
+
+	return n;
+}
+
 /** Decode a single character from a string.
  *
  * Decode a single character from a string of size @a size. Decoding starts
  * at @a offset and this offset is moved to the beginning of the next
  * character. In case of decoding error, offset generally advances at least
- * by one. However, offset is never moved beyond size.
+ * by one. However, offset is never moved beyond size. A byte that cannot
+ * continue the current sequence (such as the terminating null character)
+ * is not consumed. Overlong sequences and sequences encoding values beyond
+ * the Unicode range are decoding errors.
  *
  * @param str    String (not necessarily NULL-terminated).
  * @param offset Byte offset in string where to start decoding.
@@ -157,23 +383,26 @@ char32_t str_decode(const char *str, size_t *offset, size_t size)
 
 	unsigned int b0_bits;  /* Data bits in first byte */
 	unsigned int cbytes;   /* Number of continuation bytes */
+	char32_t min;          /* Smallest value needing this many bytes */
 
 	if ((b0 & 0x80) == 0) {
 		/* 0xxxxxxx (Plain ASCII) */
-		b0_bits = 7;
-		cbytes = 0;
+		return b0;
 	} else if ((b0 & 0xe0) == 0xc0) {
 		/* 110xxxxx 10xxxxxx */
 		b0_bits = 5;
 		cbytes = 1;
+		min = 0x80;
 	} else if ((b0 & 0xf0) == 0xe0) {
 		/* 1110xxxx 10xxxxxx 10xxxxxx */
 		b0_bits = 4;
 		cbytes = 2;
+		min = 0x800;
 	} else if ((b0 & 0xf8) == 0xf0) {
 		/* 11110xxx 10xxxxxx 10xxxxxx 10xxxxxx */
 		b0_bits = 3;
 		cbytes = 3;
+		min = 0x10000;
 	} else {
 		/* 10xxxxxx -- unexpected continuation byte */
 		return U_SPECIAL;
@@ -186,7 +415,7 @@ char32_t str_decode(const char *str, size_t *offset, size_t size)
 
 	/* Decode continuation bytes */
 	while (cbytes > 0) {
-		uint8_t b = (uint8_t) str[(*offset)++];
+		uint8_t b = (uint8_t) str[*offset];
 
 		/* Must be 10xxxxxx */
 		if ((b & 0xc0) != 0x80)
@@ -194,9 +423,13 @@ char32_t str_decode(const char *str, size_t *offset, size_t size)
 
 		/* Shift data bits to ch */
 		ch = (ch << CONT_BITS) | (char32_t) (b & LO_MASK_8(CONT_BITS));
+		(*offset)++;
 		cbytes--;
 	}
 
+	if (ch < min || !chr_check(ch))
+		return U_SPECIAL;
+
 	return ch;
 }
 
@@ -326,12 +559,7 @@ errno_t chr_encode(const char32_t ch, char *str, size_t *offset, size_t size)
  */
 size_t str_size(const char *str)
 {
-	size_t size = 0;
-
-	while (*str++ != 0)
-		size++;
-
-	return size;
+	return str_zero_pos(str, STR_NO_LIMIT);
 }
 
 /** Get size of wide string.
@@ -390,12 +618,7 @@ size_t str_lsize(const char *str, size_t max_len)
  */
 size_t str_nsize(const char *str, size_t max_size)
 {
-	size_t size = 0;
-
-	while ((*str++ != 0) && (size < max_size))
-		size++;
-
-	return size;
+	return str_zero_pos(str, max_size);
 }
 
 /** Get size of wide string with size limit.
@@ -443,9 +666,18 @@ size_t str_length(const char *str)
 {
 	size_t len = 0;
 	size_t offset = 0;
+	size_t run;
+
+	while (true) {
+		run = str_ascii_run(str + offset, STR_NO_LIMIT);
+		len += run;
+		offset += run;
+
+		if (str_decode(str, &offset, STR_NO_LIMIT) == 0)
+			break;
 
-	while (str_decode(str, &offset, STR_NO_LIMIT) != 0)
 		len++;
+	}
 
 	return len;
 }
@@ -479,9 +711,18 @@ size_t str_nlength(const char *str, size_t size)
 {
 	size_t len = 0;
 	size_t offset = 0;
+	size_t run;
+
+	while (offset < size) {
+		run = str_ascii_run(str + offset, size - offset);
+		len += run;
+		offset += run;
+
+		if (str_decode(str, &offset, size) == 0)
+			break;
 
-	while (str_decode(str, &offset, size) != 0)
 		len++;
+	}
 
 	return len;
 }
@@ -587,7 +828,14 @@ int str_cmp(const char *s1, const char *s2)
 	size_t off1 = 0;
 	size_t off2 = 0;
 
+	size_t run;
+
 	while (true) {
+		/* Skip identical ASCII characters */
+		run = str_ascii_common(s1 + off1, s2 + off2, STR_NO_LIMIT);
+		off1 += run;
+		off2 += run;
+
 		c1 = str_decode(s1, &off1, STR_NO_LIMIT);
 		c2 = str_decode(s2, &off2, STR_NO_LIMIT);
 
@@ -635,8 +883,15 @@ int str_lcmp(const char *s1, const char *s2, size_t max_len)
 	size_t off2 = 0;
 
 	size_t len = 0;
+	size_t run;
 
 	while (true) {
+		/* Skip identical ASCII characters */
+		run = str_ascii_common(s1 + off1, s2 + off2, max_len - len);
+		off1 += run;
+		off2 += run;
+		len += run;
+
 		if (len >= max_len)
 			break;
 
@@ -686,7 +941,14 @@ int str_casecmp(const char *s1, const char *s2)
 	size_t off1 = 0;
 	size_t off2 = 0;
 
+	size_t run;
+
 	while (true) {
+		/* Skip identical ASCII characters */
+		run = str_ascii_common(s1 + off1, s2 + off2, STR_NO_LIMIT);
+		off1 += run;
+		off2 += run;
+
 		c1 = tolower(str_decode(s1, &off1, STR_NO_LIMIT));
 		c2 = tolower(str_decode(s2, &off2, STR_NO_LIMIT));
 
@@ -735,8 +997,15 @@ int str_lcasecmp(const char *s1, const char *s2, size_t max_len)
 	size_t off2 = 0;
 
 	size_t len = 0;
+	size_t run;
 
 	while (true) {
+		/* Skip identical ASCII characters */
+		run = str_ascii_common(s1 + off1, s2 + off2, max_len - len);
+		off1 += run;
+		off2 += run;
+		len += run;
+
 		if (len >= max_len)
 			break;
 
@@ -778,7 +1047,14 @@ bool str_test_prefix(const char *s, const char *p)
 	size_t off1 = 0;
 	size_t off2 = 0;
 
+	size_t run;
+
 	while (true) {
+		/* Skip identical ASCII characters */
+		run = str_ascii_common(s + off1, p + off2, STR_NO_LIMIT);
+		off1 += run;
+		off2 += run;
+
 		c1 = str_decode(s, &off1, STR_NO_LIMIT);
 		c2 = str_decode(p, &off2, STR_NO_LIMIT);
 
@@ -1169,6 +1445,8 @@ void str_to_wstr(char32_t *dest, size_t dlen, const char *src)
 {
 	size_t offset;
 	size_t di;
+	size_t run;
+	size_t i;
 	char32_t c;
 
 	assert(dlen > 0);
@@ -1177,6 +1455,14 @@ void str_to_wstr(char32_t *dest, size_t dlen, const char *src)
 	di = 0;
 
 	do {
+		/* Widen ASCII characters without decoding */
+		run = str_ascii_run(src + offset, dlen - 1 - di);
+		for (i = 0; i < run; i++)
+			dest[di + i] = (uint8_t) src[offset + i];
+
+		offset += run;
+		di += run;
+
 		if (di >= dlen - 1)
 			break;
 
@@ -1217,12 +1503,27 @@ char *str_chr(const char *str, char32_t ch)
 {
 	char32_t acc;
 	size_t off = 0;
-	size_t last = 0;
+	size_t last;
+	size_t run;
+	const char *p;
+
+	while (true) {
+		run = str_ascii_run(str + off, STR_NO_LIMIT);
+		if (ascii_check(ch) && run > 0) {
+			p = memchr(str + off, ch, run);
+			if (p != NULL)
+				return (char *) p;
+		}
+
+		off += run;
+		last = off;
+
+		acc = str_decode(str, &off, STR_NO_LIMIT);
+		if (acc == 0)
+			break;
 
-	while ((acc = str_decode(str, &off, STR_NO_LIMIT)) != 0) {
 		if (acc == ch)
 			return (char *) (str + last);
-		last = off;
 	}
 
 	return NULL;
@@ -1315,13 +1616,31 @@ char *str_rchr(const char *str, char32_t ch)
 {
 	char32_t acc;
 	size_t off = 0;
-	size_t last = 0;
+	size_t last;
+	size_t run;
+	size_t i;
 	const char *res = NULL;
 
-	while ((acc = str_decode(str, &off, STR_NO_LIMIT)) != 0) {
-		if (acc == ch)
-			res = (str + last);
+	while (true) {
+		run = str_ascii_run(str + off, STR_NO_LIMIT);
+		if (ascii_check(ch)) {
+			for (i = run; i > 0; i--) {
+				if ((uint8_t) str[off + i - 1] == ch) {
+					res = str + off + i - 1;
+					break;
+				}
+			}
+		}
+
+		off += run;
 		last = off;
+
+		acc = str_decode(str, &off, STR_NO_LIMIT);
+		if (acc == 0)
+			break;
+
+		if (acc == ch)
+			res = str + last;
 	}
 
 	return (char *) res;
@@ -40,9 +40,33 @@
 #include <adt/hash_table.h>
 #include <synch/spinlock.h>
 
+/** Maximum number of quantum multiples with a quantum cache. */
+#define RA_QCACHE_MAX		8
+
+/** Number of resources in a magazine of a quantum cache. */
+#define RA_MAGAZINE_SIZE	16
+
+/** Magazine holding free resources of one size. */
+typedef struct {
+	size_t busy;				/**< Number of resources. */
+	uintptr_t objs[RA_MAGAZINE_SIZE];	/**< Resource bases. */
+} ra_magazine_t;
+
+/** Per-CPU quantum cache. */
+typedef struct {
+	IRQ_SPINLOCK_DECLARE(lock);
+	/** Magazine for each multiple of the quantum. */
+	ra_magazine_t mags[RA_QCACHE_MAX];
+} ra_qcache_t;
+
 typedef struct {
 	IRQ_SPINLOCK_DECLARE(lock);
 	list_t spans;		/**< List of arena's spans. */
+
+	size_t quantum;		/**< Quantum of cached resources. */
+	size_t qcache_max;	/**< Number of cached quantum multiples. */
+	ra_qcache_t *qcache;	/**< Per-CPU quantum caches or NULL. */
+	link_t arena_link;	/**< Link in the list of cached arenas. */
 } ra_arena_t;
 
 typedef struct {
@@ -52,6 +76,7 @@ typedef struct {
 
 	size_t max_order;	/**< Base 2 logarithm of span's size. */
 	list_t *free;		/**< max_order segment free lists. */
+	size_t free_mask;	/**< Bit set for each non-empty free list. */
 
 	hash_table_t used;
 
@@ -85,7 +110,9 @@ typedef struct {
 } ra_segment_t;
 
 extern void ra_init(void);
+extern void ra_enable_qcache(void);
 extern ra_arena_t *ra_arena_create(void);
+extern ra_arena_t *ra_arena_create_qcache(size_t, size_t);
 extern void ra_arena_destroy(ra_arena_t *);
 extern bool ra_span_add(ra_arena_t *, uintptr_t, size_t);
 extern bool ra_alloc(ra_arena_t *, size_t, size_t, uintptr_t *);
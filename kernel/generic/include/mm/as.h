@@ -43,6 +43,7 @@
 #include <arch/istate.h>
 #include <synch/spinlock.h>
 #include <synch/mutex.h>
+#include <adt/bptree.h>
 #include <adt/list.h>
 #include <adt/odict.h>
 #include <lib/elf.h>
@@ -124,7 +125,7 @@ typedef struct as {
 	 *
 	 * Members are of type as_area_t.
 	 */
-	odict_t as_areas;
+	bptree_t as_areas;
 
 	/** Non-generic content. */
 	as_genarch_t genarch;
@@ -256,9 +257,6 @@ typedef struct {
 	/** Containing address space. */
 	as_t *as;
 
-	/** Link to @c as->as_areas */
-	odlink_t las_areas;
-
 	/** Memory flags. */
 	unsigned int flags;
 
@@ -324,8 +322,8 @@ extern errno_t as_area_resize(as_t *, uintptr_t, size_t, unsigned int);
 extern errno_t as_area_share(as_t *, uintptr_t, size_t, as_t *, unsigned int,
     uintptr_t *, uintptr_t);
 extern errno_t as_area_change_flags(as_t *, unsigned int, uintptr_t);
-extern as_area_t *as_area_first(as_t *);
-extern as_area_t *as_area_next(as_area_t *);
+extern as_area_t *as_area_first(as_t *, bptree_iter_t *);
+extern as_area_t *as_area_next(bptree_iter_t *);
 
 extern void as_pagemap_initialize(as_pagemap_t *);
 extern void as_pagemap_finalize(as_pagemap_t *);
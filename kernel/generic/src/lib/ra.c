@@ -40,6 +40,17 @@
  *   Bonwick J., Adams J.: Magazines and Vmem: Extending the Slab Allocator to
  *   Many CPUs and Arbitrary Resources, USENIX 2001
  *
+ * Free segments are kept on power-of-two free lists and allocations are
+ * satisfied from the smallest non-empty list guaranteed to fit (instant-fit),
+ * which is found using a bit mask of non-empty lists. Neighboring free
+ * segments are coalesced when a segment is freed.
+ *
+ * Arenas created by ra_arena_create_qcache() additionally have per-CPU
+ * quantum caches for small multiples of the quantum, which satisfy most
+ * allocations and frees without taking the arena lock. Similarly to slab
+ * magazines, the quantum caches are only enabled once the number of
+ * processors is known (see ra_enable_qcache()).
+ *
  */
 
 #include <assert.h>
@@ -55,9 +66,18 @@
 #include <macros.h>
 #include <synch/spinlock.h>
 #include <stdlib.h>
+#include <config.h>
+#include <cpu.h>
 
 static slab_cache_t *ra_segment_cache;
 
+/** Whether quantum caches can be created. */
+static bool ra_qcache_enabled = false;
+
+/** List of arenas with quantum caches and the lock protecting it. */
+IRQ_SPINLOCK_STATIC_INITIALIZE(ra_arena_lock);
+static LIST_INITIALIZE(ra_arena_list);
+
 /** Return the hash of the key stored in the item */
 static size_t used_hash(const ht_link_t *item)
 {
@@ -96,6 +116,23 @@ static size_t ra_segment_size_get(ra_segment_t *seg)
 	return nextseg->base - seg->base;
 }
 
+/** Put a free segment on the appropriate free list. */
+static void ra_fl_insert(ra_span_t *span, ra_segment_t *seg)
+{
+	size_t order = fnzb(ra_segment_size_get(seg));
+
+	list_append(&seg->fl_link, &span->free[order]);
+	span->free_mask |= (size_t) 1 << order;
+}
+
+/** Remove a free segment from the free list of the given order. */
+static void ra_fl_remove(ra_span_t *span, ra_segment_t *seg, size_t order)
+{
+	list_remove(&seg->fl_link);
+	if (list_empty(&span->free[order]))
+		span->free_mask &= ~((size_t) 1 << order);
+}
+
 static ra_segment_t *ra_segment_create(uintptr_t base)
 {
 	ra_segment_t *seg;
@@ -129,6 +166,7 @@ static ra_span_t *ra_span_create(uintptr_t base, size_t size)
 		return NULL;
 
 	span->max_order = fnzb(size);
+	span->free_mask = 0;
 	span->base = base;
 	span->size = size;
 
@@ -178,7 +216,7 @@ static ra_span_t *ra_span_create(uintptr_t base, size_t size)
 	list_append(&lastseg->segment_link, &span->segments);
 
 	/* Insert the first segment into the respective free list. */
-	list_append(&seg->fl_link, &span->free[span->max_order]);
+	ra_fl_insert(span, seg);
 
 	return span;
 }
@@ -196,6 +234,7 @@ static void ra_span_destroy(ra_span_t *span)
 		ra_segment_destroy(seg);
 	}
 
+	free(span->free);
 	free(span);
 }
 
@@ -211,15 +250,97 @@ ra_arena_t *ra_arena_create(void)
 	irq_spinlock_initialize(&arena->lock, "arena_lock");
 	list_initialize(&arena->spans);
 
+	arena->quantum = 1;
+	arena->qcache_max = 0;
+	arena->qcache = NULL;
+	link_initialize(&arena->arena_link);
+
+	return arena;
+}
+
+/** Create per-CPU quantum caches of an arena. */
+static bool ra_qcache_create(ra_arena_t *arena)
+{
+	ra_qcache_t *qcache;
+	size_t i;
+	size_t j;
+
+	assert(ra_qcache_enabled);
+
+	qcache = malloc(config.cpu_count * sizeof(ra_qcache_t));
+	if (!qcache)
+		return false;
+
+	for (i = 0; i < config.cpu_count; i++) {
+		irq_spinlock_initialize(&qcache[i].lock, "ra.qcache.lock");
+		for (j = 0; j < RA_QCACHE_MAX; j++)
+			qcache[i].mags[j].busy = 0;
+	}
+
+	arena->qcache = qcache;
+	return true;
+}
+
+/** Create an empty arena with quantum caches.
+ *
+ * Allocations of up to @a qcache_max multiples of @a quantum aligned
+ * to at most @a quantum are served from per-CPU caches. The quantum
+ * caches hold on to freed resources, so they are only suitable for
+ * arenas whose resources are plentiful (e.g. kernel virtual addresses).
+ *
+ * @param quantum    Quantum (power of two).
+ * @param qcache_max Number of multiples of quantum to cache
+ *                   (at most RA_QCACHE_MAX).
+ *
+ * @return New arena or NULL if out of memory.
+ */
+ra_arena_t *ra_arena_create_qcache(size_t quantum, size_t qcache_max)
+{
+	ra_arena_t *arena;
+
+	assert(ispwr2(quantum));
+	assert(qcache_max <= RA_QCACHE_MAX);
+
+	arena = ra_arena_create();
+	if (!arena)
+		return NULL;
+
+	arena->quantum = quantum;
+	arena->qcache_max = qcache_max;
+
+	if (qcache_max == 0)
+		return arena;
+
+	irq_spinlock_lock(&ra_arena_lock, true);
+
+	if (ra_qcache_enabled && !ra_qcache_create(arena)) {
+		irq_spinlock_unlock(&ra_arena_lock, true);
+		free(arena);
+		return NULL;
+	}
+
+	list_append(&arena->arena_link, &ra_arena_list);
+	irq_spinlock_unlock(&ra_arena_lock, true);
+
 	return arena;
 }
 
 void ra_arena_destroy(ra_arena_t *arena)
 {
+	if (link_in_use(&arena->arena_link)) {
+		irq_spinlock_lock(&ra_arena_lock, true);
+		list_remove(&arena->arena_link);
+		irq_spinlock_unlock(&ra_arena_lock, true);
+	}
+
 	/*
 	 * No locking necessary as this is the cleanup and all users should have
-	 * stopped using the arena already.
+	 * stopped using the arena already. Resources held by the quantum
+	 * caches are part of the spans and go away with them.
 	 */
+	if (arena->qcache)
+		free(arena->qcache);
+
 	list_foreach_safe(arena->spans, cur, next) {
 		ra_span_t *span = list_get_instance(cur, ra_span_t, span_link);
 		list_remove(&span->span_link);
@@ -245,6 +366,78 @@ bool ra_span_add(ra_arena_t *arena, uintptr_t base, size_t size)
 	return true;
 }
 
+/** Allocate resources from a free segment.
+ *
+ * @param span  Span containing the segment.
+ * @param seg   Free segment large enough for the request.
+ * @param order Order of the free list the segment is on.
+ * @param size  Size of the request.
+ * @param align Alignment of the request.
+ * @param base  Place to store the base of the allocated resources.
+ *
+ * @return False if unable to split the segment.
+ */
+static bool ra_segment_alloc(ra_span_t *span, ra_segment_t *seg, size_t order,
+    size_t size, size_t align, uintptr_t *base)
+{
+	ra_segment_t *pred = NULL;
+	ra_segment_t *succ = NULL;
+	uintptr_t newbase;
+
+	assert(seg->flags & RA_SEGMENT_FREE);
+
+	/*
+	 * See if we need to allocate new segments for the chopped-off
+	 * parts of this segment.
+	 */
+	if (!IS_ALIGNED(seg->base, align)) {
+		pred = ra_segment_create(seg->base);
+		if (!pred) {
+			/*
+			 * Fail as we are unable to split the segment.
+			 */
+			return false;
+		}
+		pred->flags |= RA_SEGMENT_FREE;
+	}
+	newbase = ALIGN_UP(seg->base, align);
+	if (newbase + size != seg->base + ra_segment_size_get(seg)) {
+		assert(newbase + (size - 1) < seg->base +
+		    (ra_segment_size_get(seg) - 1));
+		succ = ra_segment_create(newbase + size);
+		if (!succ) {
+			if (pred)
+				ra_segment_destroy(pred);
+			/*
+			 * Fail as we are unable to split the segment.
+			 */
+			return false;
+		}
+		succ->flags |= RA_SEGMENT_FREE;
+	}
+
+	/* Now remove the found segment from the free list. */
+	ra_fl_remove(span, seg, order);
+	seg->base = newbase;
+	seg->flags &= ~RA_SEGMENT_FREE;
+
+	/* Put unneeded parts back. */
+	if (pred) {
+		list_insert_before(&pred->segment_link, &seg->segment_link);
+		ra_fl_insert(span, pred);
+	}
+	if (succ) {
+		list_insert_after(&succ->segment_link, &seg->segment_link);
+		ra_fl_insert(span, succ);
+	}
+
+	/* Hash-in the segment into the used hash. */
+	hash_table_insert(&span->used, &seg->uh_link);
+
+	*base = newbase;
+	return true;
+}
+
 static bool
 ra_span_alloc(ra_span_t *span, size_t size, size_t align, uintptr_t *base)
 {
@@ -254,84 +447,40 @@ ra_span_alloc(ra_span_t *span, size_t size, size_t align, uintptr_t *base)
 	 */
 	size_t needed = size + align - 1;
 	size_t order = ispwr2(needed) ? fnzb(needed) : fnzb(needed) + 1;
-	ra_segment_t *pred = NULL;
-	ra_segment_t *succ = NULL;
+	size_t mask;
 
 	/*
 	 * Find the free list of the smallest order which can satisfy this
-	 * request.
+	 * request. Any segment on it is large enough, so take the first one.
 	 */
-	for (; order <= span->max_order; order++) {
-		ra_segment_t *seg;
-		uintptr_t newbase;
-
-		if (list_empty(&span->free[order]))
-			continue;
-
-		/* Take the first segment from the free list. */
-		seg = list_get_instance(list_first(&span->free[order]),
-		    ra_segment_t, fl_link);
-
-		assert(seg->flags & RA_SEGMENT_FREE);
-
-		/*
-		 * See if we need to allocate new segments for the chopped-off
-		 * parts of this segment.
-		 */
-		if (!IS_ALIGNED(seg->base, align)) {
-			pred = ra_segment_create(seg->base);
-			if (!pred) {
-				/*
-				 * Fail as we are unable to split the segment.
-				 */
-				break;
-			}
-			pred->flags |= RA_SEGMENT_FREE;
-		}
-		newbase = ALIGN_UP(seg->base, align);
-		if (newbase + size != seg->base + ra_segment_size_get(seg)) {
-			assert(newbase + (size - 1) < seg->base +
-			    (ra_segment_size_get(seg) - 1));
-			succ = ra_segment_create(newbase + size);
-			if (!succ) {
-				if (pred)
-					ra_segment_destroy(pred);
-				/*
-				 * Fail as we are unable to split the segment.
-				 */
-				break;
-			}
-			succ->flags |= RA_SEGMENT_FREE;
-		}
-
-		/* Put unneeded parts back. */
-		if (pred) {
-			size_t pred_order;
-
-			list_insert_before(&pred->segment_link,
-			    &seg->segment_link);
-			pred_order = fnzb(ra_segment_size_get(pred));
-			list_append(&pred->fl_link, &span->free[pred_order]);
-		}
-		if (succ) {
-			size_t succ_order;
-
-			list_insert_after(&succ->segment_link,
-			    &seg->segment_link);
-			succ_order = fnzb(ra_segment_size_get(succ));
-			list_append(&succ->fl_link, &span->free[succ_order]);
+	if (order <= span->max_order) {
+		mask = span->free_mask & ~(((size_t) 1 << order) - 1);
+		if (mask != 0) {
+			order = __builtin_ctzl(mask);
+			return ra_segment_alloc(span, list_get_instance(
+			    list_first(&span->free[order]), ra_segment_t,
+			    fl_link), order, size, align, base);
 		}
+	}
 
-		/* Now remove the found segment from the free list. */
-		list_remove(&seg->fl_link);
-		seg->base = newbase;
-		seg->flags &= ~RA_SEGMENT_FREE;
+	/*
+	 * Segments on the free list of the next lower order may or may not
+	 * be large enough. Searching it is slow, but it is only needed
+	 * when the span is nearly exhausted (or the request is as large
+	 * as the span itself).
+	 */
+	if (order == 0 || order - 1 > span->max_order)
+		return false;
 
-		/* Hash-in the segment into the used hash. */
-		hash_table_insert(&span->used, &seg->uh_link);
+	order--;
+	list_foreach(span->free[order], fl_link, ra_segment_t, seg) {
+		uintptr_t end = seg->base + (ra_segment_size_get(seg) - 1);
+		uintptr_t newbase = ALIGN_UP(seg->base, align);
 
-		*base = newbase;
-		return true;
+		if (newbase >= seg->base && newbase <= end &&
+		    size - 1 <= end - newbase)
+			return ra_segment_alloc(span, seg, order, size, align,
+			    base);
 	}
 
 	return false;
@@ -344,7 +493,6 @@ static void ra_span_free(ra_span_t *span, size_t base, size_t size)
 	ra_segment_t *seg;
 	ra_segment_t *pred;
 	ra_segment_t *succ;
-	size_t order;
 
 	/*
 	 * Locate the segment in the used hash table.
@@ -369,7 +517,7 @@ static void ra_span_free(ra_span_t *span, size_t base, size_t size)
 	 * Check whether the segment can be coalesced with its left neighbor.
 	 */
 	if (list_first(&span->segments) != &seg->segment_link) {
-		pred = hash_table_get_inst(seg->segment_link.prev,
+		pred = list_get_instance(seg->segment_link.prev,
 		    ra_segment_t, segment_link);
 
 		assert(pred->base < seg->base);
@@ -381,7 +529,8 @@ static void ra_span_free(ra_span_t *span, size_t base, size_t size)
 			 * lists, rebase the segment and throw the predecessor
 			 * away.
 			 */
-			list_remove(&pred->fl_link);
+			ra_fl_remove(span, pred,
+			    fnzb(ra_segment_size_get(pred)));
 			list_remove(&pred->segment_link);
 			seg->base = pred->base;
 			ra_segment_destroy(pred);
@@ -391,7 +540,7 @@ static void ra_span_free(ra_span_t *span, size_t base, size_t size)
 	/*
 	 * Check whether the segment can be coalesced with its right neighbor.
 	 */
-	succ = hash_table_get_inst(seg->segment_link.next, ra_segment_t,
+	succ = list_get_instance(seg->segment_link.next, ra_segment_t,
 	    segment_link);
 	assert(succ->base > seg->base);
 	if (succ->flags & RA_SEGMENT_FREE) {
@@ -400,33 +549,206 @@ static void ra_span_free(ra_span_t *span, size_t base, size_t size)
 		 * Remove the successor from the free and segment lists
 		 * and throw it away.
 		 */
-		list_remove(&succ->fl_link);
+		ra_fl_remove(span, succ, fnzb(ra_segment_size_get(succ)));
 		list_remove(&succ->segment_link);
 		ra_segment_destroy(succ);
 	}
 
 	/* Put the segment on the appropriate free list. */
 	seg->flags |= RA_SEGMENT_FREE;
-	order = fnzb(ra_segment_size_get(seg));
-	list_append(&seg->fl_link, &span->free[order]);
+	ra_fl_insert(span, seg);
+}
+
+/** Allocate resources from the spans of an arena.
+ *
+ * The arena lock must be held.
+ */
+static bool ra_arena_alloc(ra_arena_t *arena, size_t size, size_t alignment,
+    uintptr_t *base)
+{
+	assert(irq_spinlock_locked(&arena->lock));
+
+	list_foreach(arena->spans, span_link, ra_span_t, span) {
+		if (ra_span_alloc(span, size, alignment, base))
+			return true;
+	}
+
+	return false;
+}
+
+/** Return resources to the spans of an arena.
+ *
+ * The arena lock must be held.
+ *
+ * @return False if the resources do not belong to the arena.
+ */
+static bool ra_arena_free(ra_arena_t *arena, uintptr_t base, size_t size)
+{
+	assert(irq_spinlock_locked(&arena->lock));
+
+	list_foreach(arena->spans, span_link, ra_span_t, span) {
+		if (iswithin(span->base, span->size, base, size)) {
+			ra_span_free(span, base, size);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/** Return resources held by a magazine to the spans of an arena.
+ *
+ * The arena lock must be held.
+ *
+ * @param arena Arena.
+ * @param mag   Magazine.
+ * @param size  Size of the resources in the magazine.
+ * @param count Number of resources to return.
+ */
+static void ra_magazine_flush(ra_arena_t *arena, ra_magazine_t *mag,
+    size_t size, size_t count)
+{
+	while (count-- > 0) {
+		uintptr_t base = mag->objs[--mag->busy];
+
+		if (!ra_arena_free(arena, base, size)) {
+			panic("Cached resource not in arena (base=%" PRIxPTR
+			    ", size=%zd).", base, size);
+		}
+	}
+}
+
+/** Get the quantum cache magazine index for an allocation.
+ *
+ * @return Magazine index or RA_QCACHE_MAX if the allocation is not cached.
+ */
+static size_t ra_qcache_index(ra_arena_t *arena, size_t size,
+    size_t alignment)
+{
+	if (!CPU || !arena->qcache || alignment > arena->quantum ||
+	    (size % arena->quantum) != 0 ||
+	    size / arena->quantum > arena->qcache_max)
+		return RA_QCACHE_MAX;
+
+	return size / arena->quantum - 1;
+}
+
+/** Allocate resources using the quantum cache of the current CPU.
+ *
+ * An empty magazine is filled with half of its capacity at once, so
+ * that the arena lock is taken only once for several allocations.
+ */
+static bool ra_qcache_alloc(ra_arena_t *arena, size_t idx, uintptr_t *base)
+{
+	size_t size = (idx + 1) * arena->quantum;
+	ra_qcache_t *qc = &arena->qcache[CPU->id];
+	ra_magazine_t *mag;
+	uintptr_t obj;
+
+	irq_spinlock_lock(&qc->lock, true);
+	mag = &qc->mags[idx];
+
+	if (mag->busy == 0) {
+		irq_spinlock_lock(&arena->lock, false);
+		while (mag->busy < RA_MAGAZINE_SIZE / 2 &&
+		    ra_arena_alloc(arena, size, arena->quantum, &obj))
+			mag->objs[mag->busy++] = obj;
+		irq_spinlock_unlock(&arena->lock, false);
+
+		if (mag->busy == 0) {
+			irq_spinlock_unlock(&qc->lock, true);
+			return false;
+		}
+	}
+
+	*base = mag->objs[--mag->busy];
+	irq_spinlock_unlock(&qc->lock, true);
+	return true;
+}
+
+/** Free resources to the quantum cache of the current CPU.
+ *
+ * If the magazine is full, half of it is returned to the arena first.
+ */
+static void ra_qcache_free(ra_arena_t *arena, size_t idx, uintptr_t base)
+{
+	size_t size = (idx + 1) * arena->quantum;
+	ra_qcache_t *qc = &arena->qcache[CPU->id];
+	ra_magazine_t *mag;
+
+	irq_spinlock_lock(&qc->lock, true);
+	mag = &qc->mags[idx];
+
+	if (mag->busy == RA_MAGAZINE_SIZE) {
+		irq_spinlock_lock(&arena->lock, false);
+		ra_magazine_flush(arena, mag, size, RA_MAGAZINE_SIZE / 2);
+		irq_spinlock_unlock(&arena->lock, false);
+	}
+
+	mag->objs[mag->busy++] = base;
+	irq_spinlock_unlock(&qc->lock, true);
+}
+
+/** Return all resources held by the quantum caches to the arena. */
+static void ra_qcache_reap(ra_arena_t *arena)
+{
+	size_t i;
+	size_t j;
+
+	if (!arena->qcache)
+		return;
+
+	for (i = 0; i < config.cpu_count; i++) {
+		ra_qcache_t *qc = &arena->qcache[i];
+
+		irq_spinlock_lock(&qc->lock, true);
+		irq_spinlock_lock(&arena->lock, false);
+
+		for (j = 0; j < arena->qcache_max; j++) {
+			ra_magazine_flush(arena, &qc->mags[j],
+			    (j + 1) * arena->quantum, qc->mags[j].busy);
+		}
+
+		irq_spinlock_unlock(&arena->lock, false);
+		irq_spinlock_unlock(&qc->lock, true);
+	}
 }
 
 /** Allocate resources from arena. */
 bool
 ra_alloc(ra_arena_t *arena, size_t size, size_t alignment, uintptr_t *base)
 {
-	bool success = false;
+	bool success;
+	size_t idx;
 
 	assert(size >= 1);
 	assert(alignment >= 1);
 	assert(ispwr2(alignment));
 
-	irq_spinlock_lock(&arena->lock, true);
-	list_foreach(arena->spans, span_link, ra_span_t, span) {
-		success = ra_span_alloc(span, size, alignment, base);
-		if (success)
-			break;
+	idx = ra_qcache_index(arena, size, alignment);
+	if (idx < RA_QCACHE_MAX) {
+		if (ra_qcache_alloc(arena, idx, base))
+			return true;
+
+		/* Keep cached resources aligned to the quantum. */
+		alignment = arena->quantum;
+	} else {
+		irq_spinlock_lock(&arena->lock, true);
+		success = ra_arena_alloc(arena, size, alignment, base);
+		irq_spinlock_unlock(&arena->lock, true);
+
+		if (success || !arena->qcache)
+			return success;
 	}
+
+	/*
+	 * The arena might be fragmented by resources held in the quantum
+	 * caches. Return them to the arena and try again.
+	 */
+	ra_qcache_reap(arena);
+
+	irq_spinlock_lock(&arena->lock, true);
+	success = ra_arena_alloc(arena, size, alignment, base);
 	irq_spinlock_unlock(&arena->lock, true);
 
 	return success;
@@ -435,18 +757,42 @@ ra_alloc(ra_arena_t *arena, size_t size, size_t alignment, uintptr_t *base)
 /* Return resources to arena. */
 void ra_free(ra_arena_t *arena, uintptr_t base, size_t size)
 {
-	irq_spinlock_lock(&arena->lock, true);
-	list_foreach(arena->spans, span_link, ra_span_t, span) {
-		if (iswithin(span->base, span->size, base, size)) {
-			ra_span_free(span, base, size);
-			irq_spinlock_unlock(&arena->lock, true);
-			return;
-		}
+	bool success;
+	size_t idx;
+
+	idx = ra_qcache_index(arena, size, 1);
+	if (idx < RA_QCACHE_MAX && IS_ALIGNED(base, arena->quantum)) {
+		ra_qcache_free(arena, idx, base);
+		return;
 	}
+
+	irq_spinlock_lock(&arena->lock, true);
+	success = ra_arena_free(arena, base, size);
 	irq_spinlock_unlock(&arena->lock, true);
 
-	panic("Freeing to wrong arena (base=%" PRIxPTR ", size=%zd).",
-	    base, size);
+	if (!success) {
+		panic("Freeing to wrong arena (base=%" PRIxPTR ", size=%zd).",
+		    base, size);
+	}
+}
+
+/** Enable quantum caches.
+ *
+ * Must be called once the number of processors is known. Creates the
+ * quantum caches of all arenas created so far.
+ */
+void ra_enable_qcache(void)
+{
+	irq_spinlock_lock(&ra_arena_lock, true);
+
+	ra_qcache_enabled = true;
+
+	list_foreach(ra_arena_list, arena_link, ra_arena_t, arena) {
+		if (!arena->qcache)
+			(void) ra_qcache_create(arena);
+	}
+
+	irq_spinlock_unlock(&ra_arena_lock, true);
 }
 
 void ra_init(void)
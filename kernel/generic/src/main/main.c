@@ -233,6 +233,7 @@ void main_bsp_separated_stack(void)
 
 	/* Slab must be initialized after we know the number of processors. */
 	slab_enable_cpucache();
+	ra_enable_qcache();
 
 	uint64_t size;
 	const char *size_suffix;
@@ -115,8 +115,8 @@ LIST_INITIALIZE(inactive_as_with_asid_list);
 /** Kernel address space. */
 as_t *AS_KERNEL = NULL;
 
-static void *as_areas_getkey(odlink_t *);
-static int as_areas_cmp(void *, void *);
+static void *as_areas_getkey(void *);
+static int as_areas_cmp(const void *, const void *);
 
 static void used_space_initialize(used_space_t *);
 static void used_space_finalize(used_space_t *);
@@ -174,7 +174,8 @@ as_t *as_create(unsigned int flags)
 
 	(void) as_create_arch(as, 0);
 
-	odict_initialize(&as->as_areas, as_areas_getkey, as_areas_cmp);
+	bptree_initialize(&as->as_areas, sizeof(uintptr_t), as_areas_getkey,
+	    as_areas_cmp);
 
 	if (flags & FLAG_AS_KERNEL)
 		as->asid = ASID_KERNEL;
@@ -251,17 +252,17 @@ retry:
 	 * Need to start from the beginning each time since we are destroying
 	 * the areas.
 	 */
-	as_area_t *area = as_area_first(as);
+	as_area_t *area = as_area_first(as, NULL);
 	while (area != NULL) {
 		/*
 		 * XXX We already have as_area_t, but as_area_destroy will
 		 * have to search for it. This could be made faster.
 		 */
 		as_area_destroy(as, area->base);
-		area = as_area_first(as);
+		area = as_area_first(as, NULL);
 	}
 
-	odict_finalize(&as->as_areas);
+	bptree_finalize(&as->as_areas);
 
 #ifdef AS_PAGE_TABLE
 	page_table_destroy(as->genarch.page_table);
@@ -300,33 +301,29 @@ _NO_TRACE void as_release(as_t *as)
 }
 
 /** Return first address space area.
+ *
+ * The address space areas must not be modified while iterating
+ * with @a iter.
  *
  * @param as Address space
+ * @param iter Place to store position for as_area_next() or @c NULL
  * @return First area in @a as (i.e. area with the lowest base address)
  *         or @c NULL if there is none
  */
-as_area_t *as_area_first(as_t *as)
+as_area_t *as_area_first(as_t *as, bptree_iter_t *iter)
 {
-	odlink_t *odlink = odict_first(&as->as_areas);
-	if (odlink == NULL)
-		return NULL;
-
-	return odict_get_instance(odlink, as_area_t, las_areas);
+	return bptree_first(&as->as_areas, iter);
 }
 
 /** Return next address space area.
  *
- * @param cur Current area
- * @return Next area in the same address space or @c NULL if @a cur is the
- *         last area.
+ * @param iter Position of the current area, updated to the next one
+ * @return Next area in the same address space or @c NULL if the current
+ *         area is the last one
  */
-as_area_t *as_area_next(as_area_t *cur)
+as_area_t *as_area_next(bptree_iter_t *iter)
 {
-	odlink_t *odlink = odict_next(&cur->las_areas, &cur->as->as_areas);
-	if (odlink == NULL)
-		return NULL;
-
-	return odict_get_instance(odlink, as_area_t, las_areas);
+	return bptree_next(iter);
 }
 
 /** Determine if area with specified parameters would conflict with
@@ -405,11 +402,9 @@ _NO_TRACE static bool check_area_conflicts(as_t *as, uintptr_t addr,
 	 *
 	 * First find last area with <= base address.
 	 */
-	odlink_t *odlink = odict_find_leq(&as->as_areas, &addr, NULL);
-	if (odlink != NULL) {
-		as_area_t *area = odict_get_instance(odlink, as_area_t,
-		    las_areas);
-
+	bptree_iter_t iter;
+	as_area_t *area = bptree_find_leq(&as->as_areas, &addr, &iter);
+	if (area != NULL) {
 		if (area != avoid) {
 			mutex_lock(&area->lock);
 			if (area_is_conflicting(addr, count, guarded, area)) {
@@ -421,20 +416,16 @@ _NO_TRACE static bool check_area_conflicts(as_t *as, uintptr_t addr,
 		}
 
 		/* Next area */
-		odlink = odict_next(odlink, &as->as_areas);
+		area = bptree_next(&iter);
+	} else {
+		area = bptree_first(&as->as_areas, NULL);
 	}
 
 	/*
 	 * Next area, if any, is the first with base > than our base address.
 	 * If there was no area with <= base, we need to look at the first area.
 	 */
-	if (odlink == NULL)
-		odlink = odict_first(&as->as_areas);
-
-	if (odlink != NULL) {
-		as_area_t *area = odict_get_instance(odlink, as_area_t,
-		    las_areas);
-
+	if (area != NULL) {
 		if (area != avoid) {
 			mutex_lock(&area->lock);
 			if (area_is_conflicting(addr, count, guarded, area)) {
@@ -510,7 +501,8 @@ _NO_TRACE static uintptr_t as_get_unmapped_area(as_t *as, uintptr_t bound,
 	}
 
 	/* Eventually check the addresses behind each area */
-	as_area_t *area = as_area_first(as);
+	bptree_iter_t iter;
+	as_area_t *area = as_area_first(as, &iter);
 	while (area != NULL) {
 		mutex_lock(&area->lock);
 
@@ -533,7 +525,7 @@ _NO_TRACE static uintptr_t as_get_unmapped_area(as_t *as, uintptr_t bound,
 		if (avail)
 			return addr;
 
-		area = as_area_next(area);
+		area = as_area_next(&iter);
 	}
 
 	/* No suitable address space area found */
@@ -787,7 +779,6 @@ as_area_t *as_area_create(as_t *as, unsigned int flags, size_t size,
 	mutex_initialize(&area->lock, MUTEX_PASSIVE);
 
 	area->as = as;
-	odlink_initialize(&area->las_areas);
 	area->flags = flags;
 	area->attributes = attrs;
 	area->pages = pages;
@@ -800,6 +791,16 @@ as_area_t *as_area_create(as_t *as, unsigned int flags, size_t size,
 	else
 		memsetb(&area->backend_data, sizeof(area->backend_data), 0);
 
+	/*
+	 * Insert the area first. Inserting into the B+tree may need memory
+	 * and failing here does not require undoing the backend setup.
+	 */
+	if (bptree_insert(&as->as_areas, area) != EOK) {
+		free(area);
+		mutex_unlock(&as->lock);
+		return NULL;
+	}
+
 	share_info_t *si = NULL;
 
 	/*
@@ -810,6 +811,7 @@ as_area_t *as_area_create(as_t *as, unsigned int flags, size_t size,
 	if (!(attrs & AS_AREA_ATTR_PARTIAL)) {
 		si = (share_info_t *) malloc(sizeof(share_info_t));
 		if (!si) {
+			bptree_remove(&as->as_areas, area);
 			free(area);
 			mutex_unlock(&as->lock);
 			return NULL;
@@ -825,6 +827,7 @@ as_area_t *as_area_create(as_t *as, unsigned int flags, size_t size,
 
 		if (area->backend && area->backend->create_shared_data) {
 			if (!area->backend->create_shared_data(area)) {
+				bptree_remove(&as->as_areas, area);
 				free(area);
 				mutex_unlock(&as->lock);
 				sh_info_remove_reference(si);
@@ -835,6 +838,7 @@ as_area_t *as_area_create(as_t *as, unsigned int flags, size_t size,
 
 	if (area->backend && area->backend->create) {
 		if (!area->backend->create(area)) {
+			bptree_remove(&as->as_areas, area);
 			free(area);
 			mutex_unlock(&as->lock);
 			if (!(attrs & AS_AREA_ATTR_PARTIAL))
@@ -844,7 +848,6 @@ as_area_t *as_area_create(as_t *as, unsigned int flags, size_t size,
 	}
 
 	used_space_initialize(&area->used_space);
-	odict_insert(&area->las_areas, &as->as_areas, NULL);
 
 	mutex_unlock(&as->lock);
 
@@ -864,11 +867,10 @@ _NO_TRACE static as_area_t *find_area_and_lock(as_t *as, uintptr_t va)
 {
 	assert(mutex_locked(&as->lock));
 
-	odlink_t *odlink = odict_find_leq(&as->as_areas, &va, NULL);
-	if (odlink == NULL)
+	as_area_t *area = bptree_find_leq(&as->as_areas, &va, NULL);
+	if (area == NULL)
 		return NULL;
 
-	as_area_t *area = odict_get_instance(odlink, as_area_t, las_areas);
 	mutex_lock(&area->lock);
 
 	assert(area->base <= va);
@@ -1162,7 +1164,7 @@ errno_t as_area_destroy(as_t *as, uintptr_t address)
 	/*
 	 * Remove the empty area from address space.
 	 */
-	odict_remove(&area->las_areas);
+	bptree_remove(&as->as_areas, area);
 
 	free(area);
 
@@ -1709,27 +1711,30 @@ _NO_TRACE unsigned int as_area_get_flags(as_area_t *area)
 	return area_flags_to_page_flags(area->flags);
 }
 
-/** Get key function for the @c as_t.as_areas ordered dictionary.
+/** Get key function for the @c as_t.as_areas B+tree.
+ *
+ * The base address of an area never changes, so it can be copied
+ * into the tree nodes.
  *
- * @param odlink Link
- * @return Pointer to task ID cast as 'void *'
+ * @param item Address space area
+ * @return Pointer to area base cast as 'void *'
  */
-static void *as_areas_getkey(odlink_t *odlink)
+static void *as_areas_getkey(void *item)
 {
-	as_area_t *area = odict_get_instance(odlink, as_area_t, las_areas);
+	as_area_t *area = (as_area_t *) item;
 	return (void *) &area->base;
 }
 
-/** Key comparison function for the @c as_t.as_areas ordered dictionary.
+/** Key comparison function for the @c as_t.as_areas B+tree.
  *
  * @param a Pointer to area A base
  * @param b Pointer to area B base
  * @return -1, 0, 1 iff base of A is lower than, equal to, higher than B
  */
-static int as_areas_cmp(void *a, void *b)
+static int as_areas_cmp(const void *a, const void *b)
 {
-	uintptr_t base_a = *(uintptr_t *)a;
-	uintptr_t base_b = *(uintptr_t *)b;
+	uintptr_t base_a = *(const uintptr_t *)a;
+	uintptr_t base_b = *(const uintptr_t *)b;
 
 	if (base_a < base_b)
 		return -1;
@@ -2172,7 +2177,7 @@ as_area_info_t *as_get_area_info(as_t *as, size_t *osize)
 	mutex_lock(&as->lock);
 
 	/* Count number of areas. */
-	size_t area_cnt = odict_count(&as->as_areas);
+	size_t area_cnt = bptree_count(&as->as_areas);
 
 	size_t isize = area_cnt * sizeof(as_area_info_t);
 	as_area_info_t *info = malloc(isize);
@@ -2185,7 +2190,8 @@ as_area_info_t *as_get_area_info(as_t *as, size_t *osize)
 
 	size_t area_idx = 0;
 
-	as_area_t *area = as_area_first(as);
+	bptree_iter_t iter;
+	as_area_t *area = as_area_first(as, &iter);
 	while (area != NULL) {
 		assert(area_idx < area_cnt);
 		mutex_lock(&area->lock);
@@ -2196,7 +2202,7 @@ as_area_info_t *as_get_area_info(as_t *as, size_t *osize)
 		++area_idx;
 
 		mutex_unlock(&area->lock);
-		area = as_area_next(area);
+		area = as_area_next(&iter);
 	}
 
 	mutex_unlock(&as->lock);
@@ -2215,7 +2221,8 @@ void as_print(as_t *as)
 	mutex_lock(&as->lock);
 
 	/* Print out info about address space areas */
-	as_area_t *area = as_area_first(as);
+	bptree_iter_t iter;
+	as_area_t *area = as_area_first(as, &iter);
 	while (area != NULL) {
 		mutex_lock(&area->lock);
 		printf("as_area: %p, base=%p, pages=%zu"
@@ -2224,7 +2231,7 @@ void as_print(as_t *as)
 		    (void *) (area->base + P2SZ(area->pages)));
 		mutex_unlock(&area->lock);
 
-		area = as_area_next(area);
+		area = as_area_next(&iter);
 	}
 
 	mutex_unlock(&as->lock);
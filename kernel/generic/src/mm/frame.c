@@ -490,7 +490,7 @@ _NO_TRACE static void zone_merge_internal(size_t z1, size_t z2, zone_t *old_z1,
 	zones.info[z1].free_count += zones.info[z2].free_count;
 	zones.info[z1].busy_count += zones.info[z2].busy_count;
 
-	bitmap_initialize(&zones.info[z1].bitmap, zones.info[z1].count,
+	bitmap_initialize_summary(&zones.info[z1].bitmap, zones.info[z1].count,
 	    confdata + (sizeof(frame_t) * zones.info[z1].count));
 	bitmap_clear_range(&zones.info[z1].bitmap, 0, zones.info[z1].count);
 
@@ -667,7 +667,7 @@ _NO_TRACE static void zone_construct(zone_t *zone, pfn_t start, size_t count,
 		 * frame_t structures in the configuration space).
 		 */
 
-		bitmap_initialize(&zone->bitmap, count, confdata +
+		bitmap_initialize_summary(&zone->bitmap, count, confdata +
 		    (sizeof(frame_t) * count));
 		bitmap_clear_range(&zone->bitmap, 0, count);
 
@@ -694,7 +694,7 @@ _NO_TRACE static void zone_construct(zone_t *zone, pfn_t start, size_t count,
  */
 size_t zone_conf_size(size_t count)
 {
-	return (count * sizeof(frame_t) + bitmap_size(count));
+	return (count * sizeof(frame_t) + bitmap_size_summary(count));
 }
 
 /** Allocate external configuration frames from low memory. */
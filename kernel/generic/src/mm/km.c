@@ -93,7 +93,7 @@ void km_identity_init(void)
 /** Architecture dependent setup of non-identity-mapped kernel memory. */
 void km_non_identity_init(void)
 {
-	km_ni_arena = ra_arena_create();
+	km_ni_arena = ra_arena_create_qcache(PAGE_SIZE, RA_QCACHE_MAX);
 	assert(km_ni_arena != NULL);
 	km_non_identity_arch_init();
 	config.non_identity_configured = true;
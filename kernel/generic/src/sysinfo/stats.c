@@ -151,14 +151,15 @@ static size_t get_task_virtmem(as_t *as)
 	size_t pages = 0;
 
 	/* Walk areas in the address space and count pages */
-	as_area_t *area = as_area_first(as);
+	bptree_iter_t iter;
+	as_area_t *area = as_area_first(as, &iter);
 	while (area != NULL) {
 		if (mutex_trylock(&area->lock) != EOK)
 			continue;
 
 		pages += area->pages;
 		mutex_unlock(&area->lock);
-		area = as_area_next(area);
+		area = as_area_next(&iter);
 	}
 
 	mutex_unlock(&as->lock);
@@ -188,14 +189,15 @@ static size_t get_task_resmem(as_t *as)
 	size_t pages = 0;
 
 	/* Walk areas in the address space and count pages */
-	as_area_t *area = as_area_first(as);
+	bptree_iter_t iter;
+	as_area_t *area = as_area_first(as, &iter);
 	while (area != NULL) {
 		if (mutex_trylock(&area->lock) != EOK)
 			continue;
 
 		pages += area->used_space.pages;
 		mutex_unlock(&area->lock);
-		area = as_area_next(area);
+		area = as_area_next(&iter);
 	}
 
 	mutex_unlock(&as->lock);
@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <test.h>
+#include <lib/ra.h>
+#include <align.h>
+#include <atomic.h>
+#include <proc/thread.h>
+#include <arch.h>
+
+#define QUANTUM  16
+#define UNITS    4096
+
+#define SPAN_BASE  0x100000
+#define SPAN_SIZE  (UNITS * QUANTUM)
+
+#define THREADS     8
+#define ITERATIONS  20000
+#define SLOTS       32
+
+static ra_arena_t *arena;
+static atomic_size_t thread_fail;
+
+/** Owner of each unit of the span (thread number + 1 or 0 if free) */
+static uint8_t owner[SPAN_SIZE];
+
+typedef struct {
+	uintptr_t base;
+	size_t size;
+} ra1_slot_t;
+
+/** Simple pseudo-random number generator. */
+static uint32_t ra1_rand(uint32_t *seed)
+{
+	*seed = *seed * 1103515245 + 12345;
+	return *seed >> 16;
+}
+
+/** Mark allocated resources and check that they are not used already. */
+static bool ra1_claim(uintptr_t base, size_t size, uint8_t tag)
+{
+	if (base < SPAN_BASE || base + size > SPAN_BASE + SPAN_SIZE)
+		return false;
+
+	for (size_t i = base - SPAN_BASE; i < base - SPAN_BASE + size; i++) {
+		if (owner[i] != 0)
+			return false;
+		owner[i] = tag;
+	}
+
+	return true;
+}
+
+/** Unmark resources and check that they were owned by the caller. */
+static bool ra1_release(uintptr_t base, size_t size, uint8_t tag)
+{
+	for (size_t i = base - SPAN_BASE; i < base - SPAN_BASE + size; i++) {
+		if (owner[i] != tag)
+			return false;
+		owner[i] = 0;
+	}
+
+	return true;
+}
+
+static void ra1_thread(void *arg)
+{
+	uint8_t tag = (uintptr_t) arg + 1;
+	uint32_t seed = tag;
+	ra1_slot_t slots[SLOTS] = { };
+
+	for (unsigned int i = 0; i < ITERATIONS; i++) {
+		ra1_slot_t *slot = &slots[ra1_rand(&seed) % SLOTS];
+
+		if (slot->size != 0) {
+			if (!ra1_release(slot->base, slot->size, tag)) {
+				TPRINTF("Thread #%" PRIu64 " (cpu%u): "
+				    "Resource %" PRIxPTR " overwritten\n",
+				    THREAD->tid, CPU->id, slot->base);
+				atomic_inc(&thread_fail);
+				return;
+			}
+
+			ra_free(arena, slot->base, slot->size);
+			slot->size = 0;
+			continue;
+		}
+
+		size_t size;
+		size_t align;
+		uint32_t r = ra1_rand(&seed);
+
+		if (r % 8 != 0) {
+			/* Small multiple of the quantum (quantum-cached) */
+			size = (r / 8 % RA_QCACHE_MAX + 1) * QUANTUM;
+			align = QUANTUM;
+		} else {
+			/* Arbitrary size and alignment */
+			size = r / 8 % (8 * QUANTUM) + 1;
+			align = 1 << (r / 1024 % 10);
+		}
+
+		if (!ra_alloc(arena, size, align, &slot->base))
+			continue;
+
+		if (!IS_ALIGNED(slot->base, align) ||
+		    !ra1_claim(slot->base, size, tag)) {
+			TPRINTF("Thread #%" PRIu64 " (cpu%u): "
+			    "Bad resource %" PRIxPTR " (size %zu, align %zu)\n",
+			    THREAD->tid, CPU->id, slot->base, size, align);
+			atomic_inc(&thread_fail);
+			return;
+		}
+
+		slot->size = size;
+	}
+
+	for (unsigned int i = 0; i < SLOTS; i++) {
+		if (slots[i].size != 0) {
+			ra1_release(slots[i].base, slots[i].size, tag);
+			ra_free(arena, slots[i].base, slots[i].size);
+		}
+	}
+}
+
+const char *test_ra1(void)
+{
+	thread_t *threads[THREADS] = { };
+	uintptr_t base;
+
+	atomic_store(&thread_fail, 0);
+
+	arena = ra_arena_create_qcache(QUANTUM, RA_QCACHE_MAX);
+	if (!arena)
+		return "Unable to create arena";
+
+	if (!ra_span_add(arena, SPAN_BASE, SPAN_SIZE)) {
+		ra_arena_destroy(arena);
+		return "Unable to add span";
+	}
+
+	TPRINTF("Running %u threads...\n", THREADS);
+
+	for (unsigned int i = 0; i < THREADS; i++) {
+		thread_t *thrd = thread_create(ra1_thread, (void *) (uintptr_t) i,
+		    TASK, THREAD_FLAG_NONE, "ra1");
+		if (!thrd) {
+			TPRINTF("Could not create thread %u\n", i);
+			break;
+		}
+		thread_start(thrd);
+		threads[i] = thrd;
+	}
+
+	for (unsigned int i = 0; i < THREADS; i++) {
+		if (threads[i] != NULL)
+			thread_join(threads[i]);
+	}
+
+	if (atomic_load(&thread_fail) != 0) {
+		ra_arena_destroy(arena);
+		return "Test failed";
+	}
+
+	/*
+	 * Everything has been freed, so the whole span must be available
+	 * once the quantum caches are reaped and free segments coalesced.
+	 */
+	TPRINTF("Allocating whole span...\n");
+
+	if (!ra_alloc(arena, SPAN_SIZE, 1, &base) || base != SPAN_BASE) {
+		ra_arena_destroy(arena);
+		return "Resources lost";
+	}
+
+	ra_free(arena, base, SPAN_SIZE);
+	ra_arena_destroy(arena);
+	return NULL;
+}
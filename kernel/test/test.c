@@ -45,6 +45,7 @@ test_t tests[] = {
 #include <mm/falloc1.def>
 #include <mm/falloc2.def>
 #include <mm/mapping1.def>
+#include <mm/ra1.def>
 #include <mm/slab1.def>
 #include <mm/slab2.def>
 #include <synch/semaphore1.def>
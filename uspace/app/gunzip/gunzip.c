@@ -32,18 +32,116 @@
 /** @file
  */
 
+#include <adt/checksum.h>
 #include <errno.h>
 #include <gzip.h>
+#include <inflate.h>
+#include <mem.h>
 #include <stdio.h>
 #include <stdlib.h>
 
+/** Size of input and output buffers */
+#define BUF_SIZE  65536
+
+/** Decompress data from one file to another.
+ *
+ * Data is processed in chunks of BUF_SIZE bytes, so memory usage does
+ * not depend on the size of the file.
+ *
+ * @param f Source file
+ * @param wf Destination file
+ * @param inbuf Input buffer (BUF_SIZE bytes)
+ * @param outbuf Output buffer (BUF_SIZE bytes)
+ * @return EOK on success, EIO on I/O error, EINVAL on invalid data
+ */
+static errno_t gunzip_file(FILE *f, FILE *wf, uint8_t *inbuf, uint8_t *outbuf)
+{
+	inflate_t *inflate;
+	size_t ilen, ipos;
+	size_t hdrlen;
+	size_t consumed, produced;
+	uint64_t total = 0;
+	uint32_t dcrc = 0;
+	uint32_t crc, size;
+	bool done = false;
+	errno_t rc;
+
+	ilen = fread(inbuf, 1, BUF_SIZE, f);
+	if (ferror(f))
+		return EIO;
+
+	rc = gzip_parse_header(inbuf, ilen, &hdrlen);
+	if (rc != EOK)
+		return EINVAL;
+
+	rc = inflate_create(&inflate);
+	if (rc != EOK)
+		return rc;
+
+	ipos = hdrlen;
+
+	while (!done) {
+		if (ipos == ilen) {
+			ilen = fread(inbuf, 1, BUF_SIZE, f);
+			if (ferror(f)) {
+				rc = EIO;
+				goto error;
+			}
+
+			/* Stream truncated */
+			if (ilen == 0) {
+				rc = EINVAL;
+				goto error;
+			}
+
+			ipos = 0;
+		}
+
+		rc = inflate_stream(inflate, inbuf + ipos, ilen - ipos,
+		    &consumed, outbuf, BUF_SIZE, &produced, &done);
+		if (rc != EOK)
+			goto error;
+
+		ipos += consumed;
+
+		if (fwrite(outbuf, 1, produced, wf) != produced) {
+			rc = EIO;
+			goto error;
+		}
+
+		dcrc = compute_crc32_seed(outbuf, produced, dcrc);
+		total += produced;
+	}
+
+	inflate_destroy(inflate);
+
+	/* Read footer, which may continue in the next chunk */
+	memmove(inbuf, inbuf + ipos, ilen - ipos);
+	ilen -= ipos;
+
+	if (ilen < GZIP_FOOTER_SIZE) {
+		ilen += fread(inbuf + ilen, 1, GZIP_FOOTER_SIZE - ilen, f);
+		if (ferror(f))
+			return EIO;
+	}
+
+	if (ilen < GZIP_FOOTER_SIZE)
+		return EINVAL;
+
+	gzip_parse_footer(inbuf, &crc, &size);
+	if (size != (uint32_t) total || crc != dcrc)
+		return EINVAL;
+
+	return EOK;
+error:
+	inflate_destroy(inflate);
+	return rc;
+}
+
 int main(int argc, char *argv[])
 {
 	errno_t rc;
-	void *data, *ddata;
-	size_t size, dsize;
-	size_t nread, nwr;
-	long len;
+	uint8_t *inbuf, *outbuf;
 	FILE *f, *wf;
 
 	if (argc != 3) {
@@ -57,58 +155,39 @@ int main(int argc, char *argv[])
 		return 1;
 	}
 
-	if (fseek(f, 0, SEEK_END) < 0) {
-		printf("Error determining size of '%s'\n", argv[1]);
+	wf = fopen(argv[2], "wb");
+	if (wf == NULL) {
+		printf("Error creating file '%s'\n", argv[2]);
 		fclose(f);
 		return 1;
 	}
 
-	len = ftell(f);
-	if (len < 0) {
-		printf("Error determining size of '%s'\n", argv[1]);
+	inbuf = malloc(BUF_SIZE);
+	outbuf = malloc(BUF_SIZE);
+	if (inbuf == NULL || outbuf == NULL) {
+		printf("Out of memory.\n");
+		free(inbuf);
+		free(outbuf);
 		fclose(f);
+		fclose(wf);
 		return 1;
 	}
 
-	if (fseek(f, 0, SEEK_SET) < 0) {
-		printf ("Error rewinding '%s'\n", argv[1]);
-		fclose(f);
-		return 1;
-	}
+	rc = gunzip_file(f, wf, inbuf, outbuf);
 
-	data = malloc(len);
-	if (data == NULL) {
-		printf("Error allocating %ld bytes.\n", len);
-		fclose(f);
-		return 1;
-	}
+	free(inbuf);
+	free(outbuf);
+	fclose(f);
 
-	nread = fread(data, 1, len, f);
-	if (nread != (size_t)len) {
-		printf("Error reading '%s'\n", argv[1]);
-		fclose(f);
+	if (rc == EIO) {
+		printf("Error reading '%s' or writing '%s'\n", argv[1],
+		    argv[2]);
+		fclose(wf);
 		return 1;
 	}
 
-	fclose(f);
-
-	size = (size_t) len;
-
-	rc = gzip_expand(data, size, &ddata, &dsize);
 	if (rc != EOK) {
 		printf("Error decompressing data.\n");
-		return 1;
-	}
-
-	wf = fopen(argv[2], "wb");
-	if (wf == NULL) {
-		printf("Error creating file '%s'\n", argv[2]);
-		return 1;
-	}
-
-	nwr = fwrite(ddata, 1, dsize, wf);
-	if (nwr != dsize) {
-		printf("Error writing '%s'\n", argv[2]);
 		fclose(wf);
 		return 1;
 	}
@@ -0,0 +1,4 @@
+/** @addtogroup gzip gzip
+ * @brief Compress a file into .gz format
+ * @ingroup apps
+ */
@@ -0,0 +1,205 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup gzip
+ * @{
+ */
+/** @file
+ */
+
+#include <adt/checksum.h>
+#include <deflate.h>
+#include <errno.h>
+#include <gzip.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <str.h>
+
+/** Size of input buffer */
+#define BUF_SIZE  65536
+
+static void print_syntax(void)
+{
+	printf("syntax: gzip [-<level>] <src> <dest.gz>\n");
+	printf("  <level> is 0 (store) to 9 (best), default is %d\n",
+	    DEFLATE_LEVEL_DEFAULT);
+}
+
+/** Compress data from one file to another.
+ *
+ * Data is processed in chunks of BUF_SIZE bytes, so memory usage does
+ * not depend on the size of the file.
+ *
+ * @param f Source file
+ * @param wf Destination file
+ * @param level Compression level
+ * @param inbuf Input buffer (BUF_SIZE bytes)
+ * @param outbuf Output buffer (deflate_bound(BUF_SIZE) bytes)
+ * @return EOK on success, EIO on I/O error
+ */
+static errno_t gzip_file(FILE *f, FILE *wf, unsigned level, uint8_t *inbuf,
+    uint8_t *outbuf)
+{
+	deflate_t *deflate;
+	uint8_t hdr[GZIP_HEADER_SIZE];
+	uint8_t ftr[GZIP_FOOTER_SIZE];
+	size_t ilen;
+	size_t olen;
+	uint32_t crc = 0;
+	uint64_t total = 0;
+	bool eof = false;
+	errno_t rc;
+
+	rc = deflate_create(&deflate);
+	if (rc != EOK)
+		return rc;
+
+	rc = deflate_set_level(deflate, level);
+	if (rc != EOK)
+		goto error;
+
+	gzip_write_header(hdr, level);
+	if (fwrite(hdr, 1, sizeof(hdr), wf) != sizeof(hdr)) {
+		rc = EIO;
+		goto error;
+	}
+
+	while (!eof) {
+		ilen = fread(inbuf, 1, BUF_SIZE, f);
+		if (ferror(f)) {
+			rc = EIO;
+			goto error;
+		}
+
+		eof = ilen < BUF_SIZE;
+
+		crc = compute_crc32_seed(inbuf, ilen, crc);
+		total += ilen;
+
+		rc = deflate_compress(deflate, inbuf, ilen, outbuf,
+		    deflate_bound(BUF_SIZE), eof ? deflate_flush_finish :
+		    deflate_flush_none, &olen);
+		if (rc != EOK)
+			goto error;
+
+		if (fwrite(outbuf, 1, olen, wf) != olen) {
+			rc = EIO;
+			goto error;
+		}
+	}
+
+	deflate_destroy(deflate);
+
+	gzip_write_footer(ftr, crc, (uint32_t) total);
+	if (fwrite(ftr, 1, sizeof(ftr), wf) != sizeof(ftr))
+		return EIO;
+
+	return EOK;
+error:
+	deflate_destroy(deflate);
+	return rc;
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned level = DEFLATE_LEVEL_DEFAULT;
+	uint8_t *inbuf, *outbuf;
+	FILE *f, *wf;
+	int i = 1;
+	errno_t rc;
+
+	if (argc == 4 && argv[1][0] == '-') {
+		if (str_size(argv[1]) != 2 || argv[1][1] < '0' ||
+		    argv[1][1] > '0' + DEFLATE_LEVEL_MAX) {
+			print_syntax();
+			return 1;
+		}
+
+		level = argv[1][1] - '0';
+		++i;
+	}
+
+	if (argc - i != 2) {
+		print_syntax();
+		return 1;
+	}
+
+	f = fopen(argv[i], "rb");
+	if (f == NULL) {
+		printf("Error opening '%s'\n", argv[i]);
+		return 1;
+	}
+
+	wf = fopen(argv[i + 1], "wb");
+	if (wf == NULL) {
+		printf("Error creating file '%s'\n", argv[i + 1]);
+		fclose(f);
+		return 1;
+	}
+
+	inbuf = malloc(BUF_SIZE);
+	outbuf = malloc(deflate_bound(BUF_SIZE));
+	if (inbuf == NULL || outbuf == NULL) {
+		printf("Out of memory.\n");
+		free(inbuf);
+		free(outbuf);
+		fclose(f);
+		fclose(wf);
+		return 1;
+	}
+
+	rc = gzip_file(f, wf, level, inbuf, outbuf);
+
+	free(inbuf);
+	free(outbuf);
+	fclose(f);
+
+	if (rc == EIO) {
+		printf("Error reading '%s' or writing '%s'\n", argv[i],
+		    argv[i + 1]);
+		fclose(wf);
+		return 1;
+	}
+
+	if (rc != EOK) {
+		printf("Error compressing data.\n");
+		fclose(wf);
+		return 1;
+	}
+
+	if (fclose(wf) != 0) {
+		printf("Error writing '%s'\n", argv[i + 1]);
+		return 1;
+	}
+
+	return 0;
+}
+
+/** @}
+ */
@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <adt/bitmap.h>
+#include <stdlib.h>
+#include <str.h>
+#include "../hbench.h"
+
+/*
+ * Bitmap allocation benchmark. The bitmap has 'bits' bits (1M by default)
+ * and 'fill' percent of them (99 by default, one decimal place allowed)
+ * are allocated in runs of 16 bits scattered at random. One operation
+ * allocates a range of 'count' bits (1 by default) starting the search
+ * at a random position and frees it again. With 'summary' set to 'no',
+ * the bitmap has no second level bitmap.
+ */
+
+/** Length of preallocated runs of bits */
+#define BITMAP_RUN  16
+
+/** Parse fill level in tenths of percent.
+ *
+ * @param str String such as "99" or "99.9"
+ * @return Fill level in tenths of percent or -1 if invalid
+ */
+static int bitmap_parse_fill(const char *str)
+{
+	char *end;
+	unsigned long fill = strtoul(str, &end, 10) * 10;
+
+	if (*end == '.' && end[1] >= '0' && end[1] <= '9' && end[2] == '\0')
+		fill += end[1] - '0';
+	else if (*end != '\0')
+		return -1;
+
+	if (fill > 1000)
+		return -1;
+
+	return fill;
+}
+
+static bool bitmap_alloc_runner(bench_env_t *env, bench_run_t *run,
+    uint64_t size)
+{
+	const char *sbits = bench_env_param_get(env, "bits", "1048576");
+	const char *sfill = bench_env_param_get(env, "fill", "99");
+	const char *scount = bench_env_param_get(env, "count", "1");
+	const char *ssummary = bench_env_param_get(env, "summary", "yes");
+	bitmap_t bitmap;
+	size_t bits;
+	size_t count;
+	size_t index;
+	size_t failed;
+	bool summary;
+	void *data;
+	int fill;
+
+	bits = strtoul(sbits, NULL, 10);
+	if (bits < BITMAP_RUN)
+		return bench_run_fail(run, "invalid bits '%s'", sbits);
+
+	fill = bitmap_parse_fill(sfill);
+	if (fill < 0)
+		return bench_run_fail(run, "invalid fill '%s'", sfill);
+
+	count = strtoul(scount, NULL, 10);
+	if (count == 0 || count > bits)
+		return bench_run_fail(run, "invalid count '%s'", scount);
+
+	if (str_cmp(ssummary, "yes") == 0)
+		summary = true;
+	else if (str_cmp(ssummary, "no") == 0)
+		summary = false;
+	else
+		return bench_run_fail(run, "invalid summary '%s'", ssummary);
+
+	data = malloc(bitmap_size_summary(bits));
+	if (data == NULL)
+		return bench_run_fail(run, "out of memory");
+
+	if (summary)
+		bitmap_initialize_summary(&bitmap, bits, data);
+	else
+		bitmap_initialize(&bitmap, bits, data);
+
+	bitmap_clear_range(&bitmap, 0, bits);
+
+	srand(1);
+	for (size_t i = 0; i + BITMAP_RUN <= bits; i += BITMAP_RUN) {
+		if (rand() % 1000 < fill)
+			bitmap_set_range(&bitmap, i, BITMAP_RUN);
+	}
+
+	failed = 0;
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < size; i++) {
+		/* Start the search at a random position */
+		bitmap.next_fit = ((size_t) rand() + (size_t) rand() * RAND_MAX) %
+		    ((bits + 7) / 8);
+
+		if (bitmap_allocate_range(&bitmap, count, 0, 0, 0, &index))
+			bitmap_clear_range(&bitmap, index, count);
+		else
+			++failed;
+	}
+	bench_run_stop(run);
+
+	free(data);
+
+	if (failed > 0 && failed < size)
+		return bench_run_fail(run, "allocation failed %zu times", failed);
+
+	return true;
+}
+
+benchmark_t benchmark_bitmap_alloc = {
+	.name = "bitmap_alloc",
+	.desc = "Allocate and free 'count' bits in a bitmap filled to 'fill' %",
+	.entry = &bitmap_alloc_runner,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+/** @}
+ */
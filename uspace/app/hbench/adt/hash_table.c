@@ -0,0 +1,287 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <adt/flat_hash.h>
+#include <adt/hash.h>
+#include <adt/hash_table.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <str.h>
+#include "../hbench.h"
+
+/*
+ * Hash table benchmarks. 'table' selects the chained hash_table (default)
+ * or the open addressing flat_hash. One operation of hash_insert builds
+ * a table of 'n' items (100000 by default) and destroys it again, one
+ * operation of hash_find looks up all 'n' items of a prebuilt table in
+ * scattered order.
+ */
+
+/** Benchmark item */
+typedef struct {
+	ht_link_t link;
+	size_t key;
+} hb_item_t;
+
+/** Parameters and data of a benchmark run */
+typedef struct {
+	/** Use flat_hash instead of hash_table */
+	bool flat;
+	/** Number of items */
+	size_t n;
+	/** Items */
+	hb_item_t *items;
+	/** Order of lookups (indices into @c items) */
+	size_t *order;
+	/** Chained table */
+	hash_table_t ht;
+	/** Open addressing table */
+	flat_hash_t fh;
+} hb_hash_t;
+
+static size_t hb_ht_hash(const ht_link_t *item)
+{
+	return hash_mix(hash_table_get_inst(item, hb_item_t, link)->key);
+}
+
+static size_t hb_ht_key_hash(const void *key)
+{
+	return hash_mix(*(const size_t *) key);
+}
+
+static bool hb_ht_key_equal(const void *key, const ht_link_t *item)
+{
+	return *(const size_t *) key ==
+	    hash_table_get_inst(item, hb_item_t, link)->key;
+}
+
+static const hash_table_ops_t hb_ht_ops = {
+	.hash = hb_ht_hash,
+	.key_hash = hb_ht_key_hash,
+	.key_equal = hb_ht_key_equal
+};
+
+/* flat_hash mixes the hash itself */
+
+static size_t hb_fh_hash(const void *item)
+{
+	return ((const hb_item_t *) item)->key;
+}
+
+static size_t hb_fh_key_hash(const void *key)
+{
+	return *(const size_t *) key;
+}
+
+static bool hb_fh_key_equal(const void *key, const void *item)
+{
+	return *(const size_t *) key == ((const hb_item_t *) item)->key;
+}
+
+static const flat_hash_ops_t hb_fh_ops = {
+	.hash = hb_fh_hash,
+	.key_hash = hb_fh_key_hash,
+	.key_equal = hb_fh_key_equal
+};
+
+/** Parse parameters and generate items.
+ *
+ * @param env Benchmark environment
+ * @param run Benchmark run
+ * @param hb Place to store parameters and data
+ * @return @c true on success
+ */
+static bool hb_setup(bench_env_t *env, bench_run_t *run, hb_hash_t *hb)
+{
+	const char *stable = bench_env_param_get(env, "table", "chained");
+	const char *sn = bench_env_param_get(env, "n", "100000");
+	uint32_t seed = 1;
+	size_t i, j, t;
+
+	if (str_cmp(stable, "chained") == 0)
+		hb->flat = false;
+	else if (str_cmp(stable, "flat") == 0)
+		hb->flat = true;
+	else
+		return bench_run_fail(run, "invalid table '%s'", stable);
+
+	hb->n = strtoul(sn, NULL, 10);
+	if (hb->n == 0)
+		return bench_run_fail(run, "invalid n '%s'", sn);
+
+	hb->items = malloc(hb->n * sizeof(hb_item_t));
+	hb->order = malloc(hb->n * sizeof(size_t));
+	if (hb->items == NULL || hb->order == NULL) {
+		free(hb->items);
+		free(hb->order);
+		return bench_run_fail(run, "out of memory");
+	}
+
+	for (i = 0; i < hb->n; i++) {
+		/* Distinct, but not consecutive keys */
+		hb->items[i].key = i * 2654435761u;
+		hb->order[i] = i;
+	}
+
+	/* Shuffle lookup order */
+	for (i = hb->n - 1; i > 0; i--) {
+		seed = seed * 1103515245 + 12345;
+		j = (seed >> 8) % (i + 1);
+		t = hb->order[i];
+		hb->order[i] = hb->order[j];
+		hb->order[j] = t;
+	}
+
+	return true;
+}
+
+/** Free items. */
+static void hb_teardown(hb_hash_t *hb)
+{
+	free(hb->items);
+	free(hb->order);
+}
+
+/** Create table and insert all items. */
+static bool hb_fill(bench_run_t *run, hb_hash_t *hb)
+{
+	size_t i;
+
+	if (hb->flat) {
+		if (!flat_hash_create(&hb->fh, 0, &hb_fh_ops))
+			return bench_run_fail(run, "out of memory");
+
+		for (i = 0; i < hb->n; i++) {
+			if (flat_hash_insert(&hb->fh, &hb->items[i]) != EOK) {
+				flat_hash_destroy(&hb->fh);
+				return bench_run_fail(run, "out of memory");
+			}
+		}
+	} else {
+		if (!hash_table_create(&hb->ht, 0, 0, &hb_ht_ops))
+			return bench_run_fail(run, "out of memory");
+
+		for (i = 0; i < hb->n; i++)
+			hash_table_insert(&hb->ht, &hb->items[i].link);
+	}
+
+	return true;
+}
+
+/** Destroy table. */
+static void hb_destroy(hb_hash_t *hb)
+{
+	if (hb->flat)
+		flat_hash_destroy(&hb->fh);
+	else
+		hash_table_destroy(&hb->ht);
+}
+
+static bool hash_insert_runner(bench_env_t *env, bench_run_t *run,
+    uint64_t size)
+{
+	hb_hash_t hb;
+	bool ok = true;
+
+	if (!hb_setup(env, run, &hb))
+		return false;
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < size && ok; i++) {
+		ok = hb_fill(run, &hb);
+		if (ok)
+			hb_destroy(&hb);
+	}
+	bench_run_stop(run);
+
+	hb_teardown(&hb);
+	return ok;
+}
+
+static bool hash_find_runner(bench_env_t *env, bench_run_t *run,
+    uint64_t size)
+{
+	hb_hash_t hb;
+	size_t found = 0;
+	size_t key;
+	size_t i;
+
+	if (!hb_setup(env, run, &hb))
+		return false;
+
+	if (!hb_fill(run, &hb)) {
+		hb_teardown(&hb);
+		return false;
+	}
+
+	bench_run_start(run);
+	for (uint64_t j = 0; j < size; j++) {
+		for (i = 0; i < hb.n; i++) {
+			key = hb.items[hb.order[i]].key;
+			if (hb.flat) {
+				if (flat_hash_find(&hb.fh, &key) != NULL)
+					++found;
+			} else {
+				if (hash_table_find(&hb.ht, &key) != NULL)
+					++found;
+			}
+		}
+	}
+	bench_run_stop(run);
+
+	hb_destroy(&hb);
+	hb_teardown(&hb);
+
+	if (found != size * hb.n)
+		return bench_run_fail(run, "lookup failed");
+
+	return true;
+}
+
+benchmark_t benchmark_hash_find = {
+	.name = "hash_find",
+	.desc = "Hash table lookups (params table=chained|flat, n)",
+	.entry = &hash_find_runner,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+benchmark_t benchmark_hash_insert = {
+	.name = "hash_insert",
+	.desc = "Hash table build-up (params table=chained|flat, n)",
+	.entry = &hash_insert_runner,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+/** @}
+ */
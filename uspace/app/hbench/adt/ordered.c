@@ -0,0 +1,281 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <adt/bptree.h>
+#include <adt/odict.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <str.h>
+#include "../hbench.h"
+
+/*
+ * Ordered dictionary benchmarks. 'dict' selects odict (default) or
+ * bptree. The dictionary holds 'n' items (100000 by default) with
+ * keys spaced apart like address space areas. One operation of
+ * ordered_find looks up the last item with key <= x for 'n' values
+ * of x in scattered order, one operation of ordered_scan walks
+ * through all items.
+ */
+
+/** Benchmark item */
+typedef struct {
+	odlink_t link;
+	uintptr_t key;
+} ob_item_t;
+
+/** Parameters and data of a benchmark run */
+typedef struct {
+	/** Use bptree instead of odict */
+	bool bptree;
+	/** Number of items */
+	size_t n;
+	/** Items */
+	ob_item_t *items;
+	/** Order of lookups (indices into @c items) */
+	size_t *order;
+	/** Red-black tree */
+	odict_t od;
+	/** B+tree */
+	bptree_t bt;
+} ob_dict_t;
+
+static int ob_bt_cmp(const void *a, const void *b)
+{
+	uintptr_t ka = *(const uintptr_t *) a;
+	uintptr_t kb = *(const uintptr_t *) b;
+
+	if (ka < kb)
+		return -1;
+	else if (ka == kb)
+		return 0;
+	else
+		return +1;
+}
+
+static int ob_od_cmp(void *a, void *b)
+{
+	return ob_bt_cmp(a, b);
+}
+
+static void *ob_od_getkey(odlink_t *odlink)
+{
+	return &odict_get_instance(odlink, ob_item_t, link)->key;
+}
+
+static void *ob_bt_getkey(void *item)
+{
+	return &((ob_item_t *) item)->key;
+}
+
+/** Parse parameters, generate items and fill dictionary.
+ *
+ * @param env Benchmark environment
+ * @param run Benchmark run
+ * @param ob Place to store parameters and data
+ * @return @c true on success
+ */
+static bool ob_setup(bench_env_t *env, bench_run_t *run, ob_dict_t *ob)
+{
+	const char *sdict = bench_env_param_get(env, "dict", "odict");
+	const char *sn = bench_env_param_get(env, "n", "100000");
+	uint32_t seed = 1;
+	size_t i, j, t;
+
+	if (str_cmp(sdict, "odict") == 0)
+		ob->bptree = false;
+	else if (str_cmp(sdict, "bptree") == 0)
+		ob->bptree = true;
+	else
+		return bench_run_fail(run, "invalid dict '%s'", sdict);
+
+	ob->n = strtoul(sn, NULL, 10);
+	if (ob->n == 0)
+		return bench_run_fail(run, "invalid n '%s'", sn);
+
+	ob->items = malloc(ob->n * sizeof(ob_item_t));
+	ob->order = malloc(ob->n * sizeof(size_t));
+	if (ob->items == NULL || ob->order == NULL) {
+		free(ob->items);
+		free(ob->order);
+		return bench_run_fail(run, "out of memory");
+	}
+
+	for (i = 0; i < ob->n; i++)
+		ob->order[i] = i;
+
+	/* Shuffle insertion and lookup order */
+	for (i = ob->n - 1; i > 0; i--) {
+		seed = seed * 1103515245 + 12345;
+		j = (seed >> 8) % (i + 1);
+		t = ob->order[i];
+		ob->order[i] = ob->order[j];
+		ob->order[j] = t;
+	}
+
+	odict_initialize(&ob->od, ob_od_getkey, ob_od_cmp);
+	bptree_initialize(&ob->bt, sizeof(uintptr_t), ob_bt_getkey, ob_bt_cmp);
+
+	for (i = 0; i < ob->n; i++) {
+		j = ob->order[i];
+		ob->items[j].key = j * 0x10000;
+
+		if (ob->bptree) {
+			if (bptree_insert(&ob->bt, &ob->items[j]) != EOK) {
+				bptree_finalize(&ob->bt);
+				free(ob->items);
+				free(ob->order);
+				return bench_run_fail(run, "out of memory");
+			}
+		} else {
+			odlink_initialize(&ob->items[j].link);
+			odict_insert(&ob->items[j].link, &ob->od, NULL);
+		}
+	}
+
+	return true;
+}
+
+/** Destroy dictionary and free items. */
+static void ob_teardown(ob_dict_t *ob)
+{
+	odlink_t *odlink;
+
+	odlink = odict_first(&ob->od);
+	while (odlink != NULL) {
+		odict_remove(odlink);
+		odlink = odict_first(&ob->od);
+	}
+
+	bptree_finalize(&ob->bt);
+	odict_finalize(&ob->od);
+	free(ob->items);
+	free(ob->order);
+}
+
+static bool ordered_find_runner(bench_env_t *env, bench_run_t *run,
+    uint64_t size)
+{
+	ob_dict_t ob;
+	ob_item_t *item;
+	odlink_t *odlink;
+	size_t found = 0;
+	uintptr_t key;
+	size_t i;
+
+	if (!ob_setup(env, run, &ob))
+		return false;
+
+	bench_run_start(run);
+	for (uint64_t j = 0; j < size; j++) {
+		for (i = 0; i < ob.n; i++) {
+			/* Address somewhere inside the item's range */
+			key = ob.order[i] * 0x10000 + 0x1234;
+			if (ob.bptree) {
+				item = bptree_find_leq(&ob.bt, &key, NULL);
+			} else {
+				odlink = odict_find_leq(&ob.od, &key, NULL);
+				item = odlink != NULL ? odict_get_instance(odlink,
+				    ob_item_t, link) : NULL;
+			}
+
+			if (item == &ob.items[ob.order[i]])
+				++found;
+		}
+	}
+	bench_run_stop(run);
+
+	ob_teardown(&ob);
+
+	if (found != size * ob.n)
+		return bench_run_fail(run, "lookup failed");
+
+	return true;
+}
+
+static bool ordered_scan_runner(bench_env_t *env, bench_run_t *run,
+    uint64_t size)
+{
+	ob_dict_t ob;
+	bptree_iter_t iter;
+	ob_item_t *item;
+	odlink_t *odlink;
+	uintptr_t sum = 0;
+
+	if (!ob_setup(env, run, &ob))
+		return false;
+
+	bench_run_start(run);
+	for (uint64_t j = 0; j < size; j++) {
+		if (ob.bptree) {
+			item = bptree_first(&ob.bt, &iter);
+			while (item != NULL) {
+				sum += item->key;
+				item = bptree_next(&iter);
+			}
+		} else {
+			odlink = odict_first(&ob.od);
+			while (odlink != NULL) {
+				item = odict_get_instance(odlink, ob_item_t, link);
+				sum += item->key;
+				odlink = odict_next(odlink, &ob.od);
+			}
+		}
+	}
+	bench_run_stop(run);
+
+	ob_teardown(&ob);
+
+	/* Sum of j * 0x10000 for j < n, repeated size times */
+	if (sum != (uintptr_t) (size * (ob.n * (ob.n - 1) / 2 * 0x10000)))
+		return bench_run_fail(run, "scan failed");
+
+	return true;
+}
+
+benchmark_t benchmark_ordered_find = {
+	.name = "ordered_find",
+	.desc = "Ordered dictionary lookups (params dict=odict|bptree, n)",
+	.entry = &ordered_find_runner,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+benchmark_t benchmark_ordered_scan = {
+	.name = "ordered_scan",
+	.desc = "Ordered dictionary iteration (params dict=odict|bptree, n)",
+	.entry = &ordered_scan_runner,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+/** @}
+ */
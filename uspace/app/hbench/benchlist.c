@@ -38,16 +38,46 @@
 #include "hbench.h"
 
 benchmark_t *benchmarks[] = {
+	&benchmark_bitmap_alloc,
+	&benchmark_crc32,
+	&benchmark_crc32c,
+	&benchmark_deflate,
 	&benchmark_dir_read,
 	&benchmark_fibril_mutex,
 	&benchmark_file_read,
+	&benchmark_fprintf,
+	&benchmark_gsort,
+	&benchmark_hash_find,
+	&benchmark_hash_insert,
+	&benchmark_inflate,
 	&benchmark_rand_read,
 	&benchmark_seq_read,
+	&benchmark_snprintf,
 	&benchmark_malloc1,
 	&benchmark_malloc2,
+	&benchmark_memchr,
+	&benchmark_memcpy,
+	&benchmark_memgc_blit,
+	&benchmark_memgc_color_key,
+	&benchmark_memgc_colorize,
+	&benchmark_memgc_fill,
+	&benchmark_memmove,
+	&benchmark_memset,
+	&benchmark_mpmc_ring,
+	&benchmark_mpsc_queue,
 	&benchmark_ns_ping,
+	&benchmark_ordered_find,
+	&benchmark_ordered_scan,
 	&benchmark_ping_pong,
+	&benchmark_prodcons,
+	&benchmark_qsort,
 	&benchmark_read1k,
+	&benchmark_spsc_ring,
+	&benchmark_str_chr,
+	&benchmark_str_cmp,
+	&benchmark_str_length,
+	&benchmark_str_size,
+	&benchmark_str_to_wstr,
 	&benchmark_taskgetid,
 	&benchmark_write1k,
 };
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <adt/checksum.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "../hbench.h"
+
+/*
+ * CRC throughput benchmarks. Each operation checksums a buffer of 'size'
+ * bytes (1 MiB by default), thus with the default size the number of
+ * operations per second equals the throughput in MiB/s.
+ */
+
+typedef uint32_t (*crc_func_t)(const uint8_t *, size_t, uint32_t);
+
+/** Checksum the buffer @a size times using @a func. */
+static bool crc_runner(bench_env_t *env, bench_run_t *run, uint64_t size,
+    crc_func_t func)
+{
+	const char *sbufsize = bench_env_param_get(env, "size", "1048576");
+	uint32_t crc = 0;
+	uint8_t *buf;
+	size_t bufsize;
+	size_t i;
+
+	bufsize = strtoul(sbufsize, NULL, 10);
+	if (bufsize == 0)
+		return bench_run_fail(run, "invalid size '%s'", sbufsize);
+
+	buf = malloc(bufsize);
+	if (buf == NULL)
+		return bench_run_fail(run, "out of memory");
+
+	for (i = 0; i < bufsize; i++)
+		buf[i] = i * 7 + (i >> 8);
+
+	bench_run_start(run);
+	for (uint64_t j = 0; j < size; j++)
+		crc = func(buf, bufsize, crc);
+	bench_run_stop(run);
+
+	free(buf);
+	return true;
+}
+
+static bool crc32_runner(bench_env_t *env, bench_run_t *run, uint64_t size)
+{
+	return crc_runner(env, run, size, compute_crc32_seed);
+}
+
+static bool crc32c_runner(bench_env_t *env, bench_run_t *run, uint64_t size)
+{
+	return crc_runner(env, run, size, compute_crc32c_seed);
+}
+
+benchmark_t benchmark_crc32 = {
+	.name = "crc32",
+	.desc = "CRC32 throughput (1 MiB buffer or 'size' bytes)",
+	.entry = &crc32_runner,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+benchmark_t benchmark_crc32c = {
+	.name = "crc32c",
+	.desc = "CRC32C throughput (1 MiB buffer or 'size' bytes)",
+	.entry = &crc32c_runner,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+/** @}
+ */
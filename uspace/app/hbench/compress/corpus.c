@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+/**
+ * @file Test data for compression benchmarks
+ */
+
+#include <mem.h>
+#include <stdlib.h>
+#include <str.h>
+#include "corpus.h"
+
+static const char *corpus_words[] = {
+	"the ", "of ", "kernel ", "task ", "thread ", "and ", "to ", "a ",
+	"memory ", "page ", "in ", "is ", "server ", "IPC ", "call ", "for ",
+	"with ", "driver ", "device ", "file ", "system ", "that ", "on ",
+	"returns ", "error ", "buffer ", "\n", ", ", ". "
+};
+
+/** Create synthetic text corpus.
+ *
+ * The text consists of pseudo-randomly chosen words, so it compresses
+ * roughly like English text. The same corpus is generated every time.
+ *
+ * @param size Size of the corpus
+ * @return Newly allocated corpus or @c NULL if out of memory
+ */
+uint8_t *compress_corpus_create(size_t size)
+{
+	uint8_t *corpus;
+	uint32_t seed = 1;
+	size_t pos = 0;
+	size_t wlen;
+	const char *w;
+
+	corpus = malloc(size);
+	if (corpus == NULL)
+		return NULL;
+
+	while (pos < size) {
+		seed = seed * 1103515245 + 12345;
+		w = corpus_words[(seed >> 16) % (sizeof(corpus_words) /
+		    sizeof(corpus_words[0]))];
+		wlen = str_size(w);
+		if (wlen > size - pos)
+			wlen = size - pos;
+		memcpy(corpus + pos, w, wlen);
+		pos += wlen;
+	}
+
+	return corpus;
+}
+
+/** @}
+ */
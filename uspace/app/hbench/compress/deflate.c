@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <deflate.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <str_error.h>
+#include "../hbench.h"
+#include "corpus.h"
+
+/*
+ * Deflate benchmark. Each operation compresses the whole input in chunks
+ * of 64 KiB at the level given by the level parameter. The input is
+ * the file given by the filename parameter or a synthetic text corpus.
+ * The compression ratio is printed during setup.
+ */
+
+enum {
+	/** Size of input chunks */
+	in_chunk = 65536
+};
+
+/** Data to compress */
+static uint8_t *data;
+/** Size of data to compress */
+static size_t data_size;
+/** Compression output buffer */
+static uint8_t *out;
+/** Compressor */
+static deflate_t *deflate;
+
+/** Load data to compress from file. */
+static bool load_file(bench_run_t *run, const char *path)
+{
+	FILE *f;
+	long fsize;
+
+	f = fopen(path, "rb");
+	if (f == NULL) {
+		return bench_run_fail(run, "failed to open %s for reading: %s",
+		    path, str_error(errno));
+	}
+
+	if (fseek(f, 0, SEEK_END) != 0 || (fsize = ftell(f)) < 0 ||
+	    fseek(f, 0, SEEK_SET) != 0) {
+		fclose(f);
+		return bench_run_fail(run, "failed to determine size of %s",
+		    path);
+	}
+
+	data = malloc(fsize);
+	if (data == NULL) {
+		fclose(f);
+		return bench_run_fail(run, "out of memory");
+	}
+
+	if (fread(data, 1, fsize, f) != (size_t) fsize) {
+		fclose(f);
+		return bench_run_fail(run, "failed to read from %s", path);
+	}
+
+	fclose(f);
+	data_size = fsize;
+	return true;
+}
+
+/** Compress all data.
+ *
+ * @param rsize Place to store compressed size
+ * @return EOK on success or an error code
+ */
+static errno_t compress_all(size_t *rsize)
+{
+	size_t pos = 0;
+	size_t len;
+	size_t olen;
+	size_t total = 0;
+	errno_t rc;
+
+	do {
+		len = data_size - pos < in_chunk ? data_size - pos : in_chunk;
+		rc = deflate_compress(deflate, data + pos, len, out,
+		    deflate_bound(in_chunk), pos + len == data_size ?
+		    deflate_flush_finish : deflate_flush_none, &olen);
+		if (rc != EOK)
+			return rc;
+
+		pos += len;
+		total += olen;
+	} while (pos < data_size);
+
+	*rsize = total;
+	return EOK;
+}
+
+static bool teardown(bench_env_t *env, bench_run_t *run)
+{
+	deflate_destroy(deflate);
+	deflate = NULL;
+	free(out);
+	out = NULL;
+	free(data);
+	data = NULL;
+	return true;
+}
+
+static bool setup(bench_env_t *env, bench_run_t *run)
+{
+	const char *path = bench_env_param_get(env, "filename", NULL);
+	const char *slevel = bench_env_param_get(env, "level", "6");
+	unsigned level;
+	size_t csize;
+	errno_t rc;
+
+	level = strtoul(slevel, NULL, 10);
+
+	if (path != NULL) {
+		if (!load_file(run, path)) {
+			teardown(env, run);
+			return false;
+		}
+	} else {
+		data = compress_corpus_create(COMPRESS_CORPUS_SIZE);
+		if (data == NULL)
+			return bench_run_fail(run, "out of memory");
+		data_size = COMPRESS_CORPUS_SIZE;
+	}
+
+	out = malloc(deflate_bound(in_chunk));
+	if (out == NULL) {
+		teardown(env, run);
+		return bench_run_fail(run, "out of memory");
+	}
+
+	rc = deflate_create(&deflate);
+	if (rc != EOK) {
+		teardown(env, run);
+		return bench_run_fail(run, "failed creating compressor: %s",
+		    str_error(rc));
+	}
+
+	rc = deflate_set_level(deflate, level);
+	if (rc != EOK) {
+		teardown(env, run);
+		return bench_run_fail(run, "invalid compression level '%s'",
+		    slevel);
+	}
+
+	rc = compress_all(&csize);
+	if (rc != EOK) {
+		teardown(env, run);
+		return bench_run_fail(run, "failed compressing data: %s",
+		    str_error(rc));
+	}
+
+	printf("Level %u: %zu bytes compressed to %zu bytes (%zu.%zu%%).\n",
+	    level, data_size, csize, csize * 100 / data_size,
+	    csize * 1000 / data_size % 10);
+	return true;
+}
+
+static bool runner(bench_env_t *env, bench_run_t *run, uint64_t size)
+{
+	size_t csize;
+	errno_t rc = EOK;
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < size; i++) {
+		rc = compress_all(&csize);
+		if (rc != EOK)
+			break;
+	}
+	bench_run_stop(run);
+
+	if (rc != EOK)
+		return bench_run_fail(run, "failed compressing data: %s",
+		    str_error(rc));
+
+	return true;
+}
+
+benchmark_t benchmark_deflate = {
+	.name = "deflate",
+	.desc = "Compress data at 'level' (synthetic 1 MiB text or 'filename')",
+	.entry = &runner,
+	.setup = &setup,
+	.teardown = &teardown
+};
+
+/** @}
+ */
@@ -0,0 +1,240 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <deflate.h>
+#include <errno.h>
+#include <gzip.h>
+#include <inflate.h>
+#include <mem.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <str_error.h>
+#include "../hbench.h"
+#include "corpus.h"
+
+/*
+ * Inflate benchmark. Each operation decodes the whole compressed stream
+ * in chunks, as gunzip does. Without the filename parameter a synthetic
+ * text corpus compressed with deflate_compress() is used.
+ */
+
+enum {
+	/** Size of input chunks */
+	in_chunk = 16384,
+	/** Size of output buffer */
+	out_size = 65536
+};
+
+/** Compressed stream to decode */
+typedef struct {
+	/** Deflate data */
+	uint8_t *data;
+	/** Size of deflate data */
+	size_t size;
+	/** Allocated buffer holding @c data */
+	uint8_t *buf;
+} inflate_input_t;
+
+/** Generate and compress synthetic corpus. */
+static bool inflate_input_synth(inflate_input_t *input, bench_run_t *run)
+{
+	deflate_t *deflate;
+	uint8_t *corpus;
+	size_t bound;
+	errno_t rc;
+
+	corpus = compress_corpus_create(COMPRESS_CORPUS_SIZE);
+	if (corpus == NULL)
+		return bench_run_fail(run, "out of memory");
+
+	bound = deflate_bound(COMPRESS_CORPUS_SIZE);
+	input->buf = malloc(bound);
+	if (input->buf == NULL) {
+		free(corpus);
+		return bench_run_fail(run, "out of memory");
+	}
+
+	rc = deflate_create(&deflate);
+	if (rc != EOK) {
+		free(corpus);
+		free(input->buf);
+		return bench_run_fail(run, "failed creating compressor: %s",
+		    str_error(rc));
+	}
+
+	rc = deflate_compress(deflate, corpus, COMPRESS_CORPUS_SIZE,
+	    input->buf, bound, deflate_flush_finish, &input->size);
+	deflate_destroy(deflate);
+	free(corpus);
+
+	if (rc != EOK) {
+		free(input->buf);
+		return bench_run_fail(run, "failed compressing corpus: %s",
+		    str_error(rc));
+	}
+
+	input->data = input->buf;
+	return true;
+}
+
+/** Load gzip file and locate the deflate stream in it. */
+static bool inflate_input_load(inflate_input_t *input, bench_run_t *run,
+    const char *path)
+{
+	FILE *f;
+	long fsize;
+	size_t hdrlen;
+	errno_t rc;
+
+	f = fopen(path, "rb");
+	if (f == NULL) {
+		return bench_run_fail(run, "failed to open %s for reading: %s",
+		    path, str_error(errno));
+	}
+
+	if (fseek(f, 0, SEEK_END) != 0 || (fsize = ftell(f)) < 0 ||
+	    fseek(f, 0, SEEK_SET) != 0) {
+		fclose(f);
+		return bench_run_fail(run, "failed to determine size of %s",
+		    path);
+	}
+
+	input->buf = malloc(fsize);
+	if (input->buf == NULL) {
+		fclose(f);
+		return bench_run_fail(run, "out of memory");
+	}
+
+	if (fread(input->buf, 1, fsize, f) != (size_t) fsize) {
+		fclose(f);
+		free(input->buf);
+		return bench_run_fail(run, "failed to read from %s", path);
+	}
+
+	fclose(f);
+
+	rc = gzip_parse_header(input->buf, fsize, &hdrlen);
+	if (rc != EOK) {
+		free(input->buf);
+		return bench_run_fail(run, "%s is not a gzip file", path);
+	}
+
+	input->data = input->buf + hdrlen;
+	input->size = fsize - hdrlen;
+	return true;
+}
+
+static bool inflate_runner(bench_env_t *env, bench_run_t *run, uint64_t size)
+{
+	const char *path = bench_env_param_get(env, "filename", NULL);
+	inflate_input_t input;
+	inflate_t *inflate;
+	uint8_t *out;
+	size_t ipos, ilen;
+	size_t consumed, produced;
+	bool done;
+	errno_t rc = EOK;
+
+	if (path != NULL) {
+		if (!inflate_input_load(&input, run, path))
+			return false;
+	} else {
+		if (!inflate_input_synth(&input, run))
+			return false;
+	}
+
+	out = malloc(out_size);
+	if (out == NULL) {
+		free(input.buf);
+		return bench_run_fail(run, "out of memory");
+	}
+
+	rc = inflate_create(&inflate);
+	if (rc != EOK) {
+		free(out);
+		free(input.buf);
+		return bench_run_fail(run, "failed creating decoder: %s",
+		    str_error(rc));
+	}
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < size; i++) {
+		inflate_reset(inflate);
+		ipos = 0;
+		done = false;
+
+		while (!done) {
+			ilen = input.size - ipos;
+			if (ilen > in_chunk)
+				ilen = in_chunk;
+
+			rc = inflate_stream(inflate, input.data + ipos, ilen,
+			    &consumed, out, out_size, &produced, &done);
+			if (rc != EOK)
+				break;
+
+			/* Truncated stream */
+			if (!done && consumed == 0 && produced == 0 &&
+			    ipos == input.size) {
+				rc = EINVAL;
+				break;
+			}
+
+			ipos += consumed;
+		}
+
+		if (rc != EOK)
+			break;
+	}
+	bench_run_stop(run);
+
+	inflate_destroy(inflate);
+	free(out);
+	free(input.buf);
+
+	if (rc != EOK)
+		return bench_run_fail(run, "failed decoding data: %s",
+		    str_error(rc));
+
+	return true;
+}
+
+benchmark_t benchmark_inflate = {
+	.name = "inflate",
+	.desc = "Decode deflate stream (synthetic 1 MiB text or 'filename')",
+	.entry = &inflate_runner,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+/** @}
+ */
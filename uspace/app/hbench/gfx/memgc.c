@@ -0,0 +1,304 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <gfx/bitmap.h>
+#include <gfx/color.h>
+#include <gfx/context.h>
+#include <gfx/coord.h>
+#include <gfx/render.h>
+#include <io/pixel.h>
+#include <memgfx/memgc.h>
+#include <stdlib.h>
+#include <str_error.h>
+#include "../hbench.h"
+
+/*
+ * Memory GC rendering benchmarks. Each operation renders a 1000 x 1000
+ * pixel rectangle, thus the reported ops/s equal megapixels per second.
+ */
+
+enum {
+	/** Width of rendered area */
+	memgc_width = 1000,
+	/** Height of rendered area */
+	memgc_height = 1000
+};
+
+static void memgc_invalidate(void *, gfx_rect_t *);
+static void memgc_update(void *);
+
+static mem_gc_cb_t memgc_cb = {
+	.invalidate = memgc_invalidate,
+	.update = memgc_update
+};
+
+/** Memory GC benchmark state */
+typedef struct {
+	/** Memory GC */
+	mem_gc_t *mgc;
+	/** Pixels of the memory GC */
+	pixel_t *pixels;
+	/** Bitmap to render */
+	gfx_bitmap_t *bitmap;
+	/** Pixels of the bitmap */
+	pixel_t *bm_pixels;
+} memgc_bench_t;
+
+static void memgc_invalidate(void *arg, gfx_rect_t *rect)
+{
+	(void) arg;
+	(void) rect;
+}
+
+static void memgc_update(void *arg)
+{
+	(void) arg;
+}
+
+/** Destroy benchmark state. */
+static void memgc_bench_destroy(memgc_bench_t *bench)
+{
+	if (bench->bitmap != NULL)
+		gfx_bitmap_destroy(bench->bitmap);
+	if (bench->mgc != NULL)
+		mem_gc_delete(bench->mgc);
+	free(bench->bm_pixels);
+	free(bench->pixels);
+}
+
+/** Create memory GC and optionally a bitmap with the given flags.
+ *
+ * Every other 4-pixel run of the bitmap has the key color so that color
+ * keying actually has to mask.
+ */
+static bool memgc_bench_create(memgc_bench_t *bench, bench_run_t *run,
+    bool with_bitmap, gfx_bitmap_flags_t flags)
+{
+	gfx_rect_t rect;
+	gfx_bitmap_alloc_t alloc;
+	gfx_bitmap_params_t params;
+	size_t npixels;
+	size_t i;
+	errno_t rc;
+
+	bench->mgc = NULL;
+	bench->bitmap = NULL;
+	bench->bm_pixels = NULL;
+
+	npixels = memgc_width * memgc_height;
+
+	bench->pixels = calloc(npixels, sizeof(pixel_t));
+	if (bench->pixels == NULL)
+		return bench_run_fail(run, "out of memory");
+
+	rect.p0.x = 0;
+	rect.p0.y = 0;
+	rect.p1.x = memgc_width;
+	rect.p1.y = memgc_height;
+
+	alloc.pitch = memgc_width * sizeof(pixel_t);
+	alloc.off0 = 0;
+	alloc.pixels = bench->pixels;
+
+	rc = mem_gc_create(&rect, &alloc, &memgc_cb, NULL, &bench->mgc);
+	if (rc != EOK) {
+		memgc_bench_destroy(bench);
+		return bench_run_fail(run, "failed creating memory GC: %s",
+		    str_error(rc));
+	}
+
+	if (!with_bitmap)
+		return true;
+
+	bench->bm_pixels = malloc(npixels * sizeof(pixel_t));
+	if (bench->bm_pixels == NULL) {
+		memgc_bench_destroy(bench);
+		return bench_run_fail(run, "out of memory");
+	}
+
+	for (i = 0; i < npixels; i++) {
+		bench->bm_pixels[i] = (i / 4) % 2 == 0 ?
+		    PIXEL(0, 255, 0, 255) : PIXEL(0, i & 0xff, 128, 0);
+	}
+
+	gfx_bitmap_params_init(&params);
+	params.rect = rect;
+	params.flags = flags;
+	params.key_color = PIXEL(0, 255, 0, 255);
+
+	alloc.pixels = bench->bm_pixels;
+
+	rc = gfx_bitmap_create(mem_gc_get_ctx(bench->mgc), &params, &alloc,
+	    &bench->bitmap);
+	if (rc != EOK) {
+		memgc_bench_destroy(bench);
+		return bench_run_fail(run, "failed creating bitmap: %s",
+		    str_error(rc));
+	}
+
+	return true;
+}
+
+/** Fill rectangle benchmark. */
+static bool fill_runner(bench_env_t *env, bench_run_t *run, uint64_t size)
+{
+	memgc_bench_t bench;
+	gfx_context_t *gc;
+	gfx_color_t *color;
+	gfx_rect_t rect;
+	errno_t rc;
+
+	if (!memgc_bench_create(&bench, run, false, 0))
+		return false;
+
+	gc = mem_gc_get_ctx(bench.mgc);
+
+	rc = gfx_color_new_rgb_i16(0xffff, 0x8000, 0, &color);
+	if (rc != EOK) {
+		memgc_bench_destroy(&bench);
+		return bench_run_fail(run, "failed creating color: %s",
+		    str_error(rc));
+	}
+
+	rc = gfx_set_color(gc, color);
+	gfx_color_delete(color);
+	if (rc != EOK) {
+		memgc_bench_destroy(&bench);
+		return bench_run_fail(run, "failed setting color: %s",
+		    str_error(rc));
+	}
+
+	rect.p0.x = 0;
+	rect.p0.y = 0;
+	rect.p1.x = memgc_width;
+	rect.p1.y = memgc_height;
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < size; i++) {
+		rc = gfx_fill_rect(gc, &rect);
+		if (rc != EOK)
+			break;
+	}
+	bench_run_stop(run);
+
+	memgc_bench_destroy(&bench);
+
+	if (rc != EOK)
+		return bench_run_fail(run, "failed filling rectangle: %s",
+		    str_error(rc));
+
+	return true;
+}
+
+/** Bitmap rendering benchmark.
+ *
+ * @param run Benchmark run
+ * @param size Number of iterations
+ * @param flags Bitmap flags
+ */
+static bool render_bench(bench_run_t *run, uint64_t size,
+    gfx_bitmap_flags_t flags)
+{
+	memgc_bench_t bench;
+	errno_t rc = EOK;
+
+	if (!memgc_bench_create(&bench, run, true, flags))
+		return false;
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < size; i++) {
+		rc = gfx_bitmap_render(bench.bitmap, NULL, NULL);
+		if (rc != EOK)
+			break;
+	}
+	bench_run_stop(run);
+
+	memgc_bench_destroy(&bench);
+
+	if (rc != EOK)
+		return bench_run_fail(run, "failed rendering bitmap: %s",
+		    str_error(rc));
+
+	return true;
+}
+
+static bool blit_runner(bench_env_t *env, bench_run_t *run, uint64_t size)
+{
+	return render_bench(run, size, 0);
+}
+
+static bool color_key_runner(bench_env_t *env, bench_run_t *run,
+    uint64_t size)
+{
+	return render_bench(run, size, bmpf_color_key);
+}
+
+static bool colorize_runner(bench_env_t *env, bench_run_t *run,
+    uint64_t size)
+{
+	return render_bench(run, size, bmpf_color_key | bmpf_colorize);
+}
+
+benchmark_t benchmark_memgc_fill = {
+	.name = "memgc_fill",
+	.desc = "Memory GC rectangle fill (ops/s = megapixels/s)",
+	.entry = &fill_runner,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+benchmark_t benchmark_memgc_blit = {
+	.name = "memgc_blit",
+	.desc = "Memory GC bitmap copy (ops/s = megapixels/s)",
+	.entry = &blit_runner,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+benchmark_t benchmark_memgc_color_key = {
+	.name = "memgc_color_key",
+	.desc = "Memory GC color-keyed bitmap render (ops/s = megapixels/s)",
+	.entry = &color_key_runner,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+benchmark_t benchmark_memgc_colorize = {
+	.name = "memgc_colorize",
+	.desc = "Memory GC colorized bitmap render (ops/s = megapixels/s)",
+	.entry = &colorize_runner,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+/** @}
+ */
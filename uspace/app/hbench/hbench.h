@@ -131,16 +131,46 @@ extern benchmark_t *benchmarks[];
 extern size_t benchmark_count;
 
 /* Put your benchmark descriptors here (and also to benchlist.c). */
+extern benchmark_t benchmark_bitmap_alloc;
+extern benchmark_t benchmark_crc32;
+extern benchmark_t benchmark_crc32c;
+extern benchmark_t benchmark_deflate;
 extern benchmark_t benchmark_dir_read;
 extern benchmark_t benchmark_fibril_mutex;
 extern benchmark_t benchmark_file_read;
+extern benchmark_t benchmark_fprintf;
+extern benchmark_t benchmark_gsort;
+extern benchmark_t benchmark_hash_find;
+extern benchmark_t benchmark_hash_insert;
+extern benchmark_t benchmark_inflate;
 extern benchmark_t benchmark_rand_read;
 extern benchmark_t benchmark_seq_read;
+extern benchmark_t benchmark_snprintf;
 extern benchmark_t benchmark_malloc1;
 extern benchmark_t benchmark_malloc2;
+extern benchmark_t benchmark_memchr;
+extern benchmark_t benchmark_memcpy;
+extern benchmark_t benchmark_memgc_blit;
+extern benchmark_t benchmark_memgc_color_key;
+extern benchmark_t benchmark_memgc_colorize;
+extern benchmark_t benchmark_memgc_fill;
+extern benchmark_t benchmark_memmove;
+extern benchmark_t benchmark_memset;
+extern benchmark_t benchmark_mpmc_ring;
+extern benchmark_t benchmark_mpsc_queue;
 extern benchmark_t benchmark_ns_ping;
+extern benchmark_t benchmark_ordered_find;
+extern benchmark_t benchmark_ordered_scan;
 extern benchmark_t benchmark_ping_pong;
+extern benchmark_t benchmark_prodcons;
+extern benchmark_t benchmark_qsort;
 extern benchmark_t benchmark_read1k;
+extern benchmark_t benchmark_spsc_ring;
+extern benchmark_t benchmark_str_chr;
+extern benchmark_t benchmark_str_cmp;
+extern benchmark_t benchmark_str_length;
+extern benchmark_t benchmark_str_size;
+extern benchmark_t benchmark_str_to_wstr;
 extern benchmark_t benchmark_taskgetid;
 extern benchmark_t benchmark_write1k;
 
@@ -0,0 +1,261 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <mem.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "../hbench.h"
+
+/*
+ * Benchmarks of the libc memory block functions. One operation processes
+ * one block of 'size' bytes (4096 by default, suffixes K and M may be
+ * used, e.g. size=64M). 'salign' and 'dalign' give the offset of source
+ * and destination from a 64-byte boundary. The memmove benchmark moves
+ * a block within one buffer by 'shift' bytes (negative shift moves it
+ * towards lower addresses).
+ */
+
+/** Parameters and buffers of a benchmark run */
+typedef struct {
+	/** Block size */
+	size_t size;
+	/** Source offset */
+	size_t salign;
+	/** Destination offset */
+	size_t dalign;
+	/** Allocated source buffer */
+	uint8_t *sbuf;
+	/** Allocated destination buffer */
+	uint8_t *dbuf;
+} memops_t;
+
+/** Parse size with optional K or M suffix.
+ *
+ * @param str String to parse
+ * @param rsize Place to store size
+ * @return @c true on success
+ */
+static bool memops_parse_size(const char *str, size_t *rsize)
+{
+	char *end;
+	unsigned long val;
+
+	val = strtoul(str, &end, 10);
+	if (end == str)
+		return false;
+
+	if (*end == 'K') {
+		val *= 1024;
+		++end;
+	} else if (*end == 'M') {
+		val *= 1024 * 1024;
+		++end;
+	}
+
+	if (*end != '\0')
+		return false;
+
+	*rsize = val;
+	return true;
+}
+
+/** Parse parameters and allocate buffers.
+ *
+ * @param env Benchmark environment
+ * @param run Benchmark run
+ * @param extra Extra bytes to allocate in each buffer
+ * @param ops Place to store parameters and buffers
+ * @return @c true on success
+ */
+static bool memops_setup(bench_env_t *env, bench_run_t *run, size_t extra,
+    memops_t *ops)
+{
+	const char *ssize = bench_env_param_get(env, "size", "4096");
+	const char *ssalign = bench_env_param_get(env, "salign", "0");
+	const char *sdalign = bench_env_param_get(env, "dalign", "0");
+	size_t bsize;
+
+	if (!memops_parse_size(ssize, &ops->size))
+		return bench_run_fail(run, "invalid size '%s'", ssize);
+
+	ops->salign = strtoul(ssalign, NULL, 10) % 64;
+	ops->dalign = strtoul(sdalign, NULL, 10) % 64;
+
+	bsize = ops->size + 64 + extra;
+	ops->sbuf = memalign(64, bsize);
+	ops->dbuf = memalign(64, bsize);
+	if (ops->sbuf == NULL || ops->dbuf == NULL) {
+		free(ops->sbuf);
+		free(ops->dbuf);
+		return bench_run_fail(run, "out of memory");
+	}
+
+	/* Touch all pages and make sure 'z' does not occur (for memchr) */
+	memset(ops->sbuf, 'a', bsize);
+	memset(ops->dbuf, 'b', bsize);
+	return true;
+}
+
+/** Free buffers. */
+static void memops_teardown(memops_t *ops)
+{
+	free(ops->sbuf);
+	free(ops->dbuf);
+}
+
+static bool memcpy_runner(bench_env_t *env, bench_run_t *run, uint64_t size)
+{
+	memops_t ops;
+	uint8_t *src;
+	uint8_t *dst;
+
+	if (!memops_setup(env, run, 0, &ops))
+		return false;
+
+	src = ops.sbuf + ops.salign;
+	dst = ops.dbuf + ops.dalign;
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < size; i++)
+		memcpy(dst, src, ops.size);
+	bench_run_stop(run);
+
+	memops_teardown(&ops);
+	return true;
+}
+
+static bool memmove_runner(bench_env_t *env, bench_run_t *run, uint64_t size)
+{
+	const char *sshift = bench_env_param_get(env, "shift", "1");
+	memops_t ops;
+	uint8_t *src;
+	uint8_t *dst;
+	long shift;
+
+	shift = strtol(sshift, NULL, 10);
+	if (shift < -4096 || shift > 4096)
+		return bench_run_fail(run, "shift '%s' out of range", sshift);
+
+	if (!memops_setup(env, run, 2 * 4096, &ops))
+		return false;
+
+	src = ops.sbuf + 4096 + ops.salign;
+	dst = src + shift;
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < size; i++)
+		memmove(dst, src, ops.size);
+	bench_run_stop(run);
+
+	memops_teardown(&ops);
+	return true;
+}
+
+static bool memset_runner(bench_env_t *env, bench_run_t *run, uint64_t size)
+{
+	memops_t ops;
+	uint8_t *dst;
+
+	if (!memops_setup(env, run, 0, &ops))
+		return false;
+
+	dst = ops.dbuf + ops.dalign;
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < size; i++)
+		memset(dst, (int) i, ops.size);
+	bench_run_stop(run);
+
+	memops_teardown(&ops);
+	return true;
+}
+
+static bool memchr_runner(bench_env_t *env, bench_run_t *run, uint64_t size)
+{
+	memops_t ops;
+	uint8_t *src;
+	bool found = false;
+
+	if (!memops_setup(env, run, 0, &ops))
+		return false;
+
+	src = ops.sbuf + ops.salign;
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < size; i++) {
+		if (memchr(src, 'z', ops.size) != NULL)
+			found = true;
+	}
+	bench_run_stop(run);
+
+	memops_teardown(&ops);
+
+	if (found)
+		return bench_run_fail(run, "memchr() found absent byte");
+
+	return true;
+}
+
+benchmark_t benchmark_memchr = {
+	.name = "memchr",
+	.desc = "memchr() of 'size' bytes (byte not present)",
+	.entry = &memchr_runner,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+benchmark_t benchmark_memcpy = {
+	.name = "memcpy",
+	.desc = "memcpy() of 'size' bytes",
+	.entry = &memcpy_runner,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+benchmark_t benchmark_memmove = {
+	.name = "memmove",
+	.desc = "memmove() of 'size' bytes by 'shift' bytes",
+	.entry = &memmove_runner,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+benchmark_t benchmark_memset = {
+	.name = "memset",
+	.desc = "memset() of 'size' bytes",
+	.entry = &memset_runner,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+/** @}
+ */
@@ -0,0 +1,205 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <gsort.h>
+#include <mem.h>
+#include <qsort.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <str.h>
+#include "../hbench.h"
+
+/*
+ * Sorting benchmarks. One operation sorts a fresh copy of an array of
+ * 'n' elements (10000 by default) of 'esize' bytes (4 by default) with
+ * a 32-bit key at the start of each element. 'input' selects the initial
+ * order: random (default), sorted, reversed or dups (random keys from
+ * a set of four values). The time includes copying the array.
+ */
+
+/** Parameters and buffers of a benchmark run */
+typedef struct {
+	/** Number of elements */
+	size_t n;
+	/** Element size */
+	size_t esize;
+	/** Unsorted input */
+	uint8_t *input;
+	/** Array being sorted */
+	uint8_t *work;
+} sort_bench_t;
+
+/** Get key of element. */
+static inline uint32_t sort_key(const void *elem)
+{
+	uint32_t key;
+
+	memcpy(&key, elem, sizeof(key));
+	return key;
+}
+
+static int qsort_cmp(const void *a, const void *b)
+{
+	uint32_t ka = sort_key(a);
+	uint32_t kb = sort_key(b);
+
+	return ka < kb ? -1 : (ka > kb ? 1 : 0);
+}
+
+static int gsort_cmp(void *a, void *b, void *arg)
+{
+	(void) arg;
+	return qsort_cmp(a, b);
+}
+
+/** Parse parameters, allocate buffers and generate input.
+ *
+ * @param env Benchmark environment
+ * @param run Benchmark run
+ * @param sb Place to store parameters and buffers
+ * @return @c true on success
+ */
+static bool sort_setup(bench_env_t *env, bench_run_t *run, sort_bench_t *sb)
+{
+	const char *sn = bench_env_param_get(env, "n", "10000");
+	const char *sesize = bench_env_param_get(env, "esize", "4");
+	const char *sinput = bench_env_param_get(env, "input", "random");
+	uint32_t seed = 1;
+	uint32_t key;
+	size_t i;
+
+	sb->n = strtoul(sn, NULL, 10);
+	if (sb->n == 0)
+		return bench_run_fail(run, "invalid n '%s'", sn);
+
+	sb->esize = strtoul(sesize, NULL, 10);
+	if (sb->esize < sizeof(uint32_t))
+		return bench_run_fail(run, "invalid esize '%s'", sesize);
+
+	if (str_cmp(sinput, "random") != 0 && str_cmp(sinput, "sorted") != 0 &&
+	    str_cmp(sinput, "reversed") != 0 && str_cmp(sinput, "dups") != 0)
+		return bench_run_fail(run, "invalid input '%s'", sinput);
+
+	sb->input = malloc(sb->n * sb->esize);
+	sb->work = malloc(sb->n * sb->esize);
+	if (sb->input == NULL || sb->work == NULL) {
+		free(sb->input);
+		free(sb->work);
+		return bench_run_fail(run, "out of memory");
+	}
+
+	memset(sb->input, 0, sb->n * sb->esize);
+
+	for (i = 0; i < sb->n; i++) {
+		seed = seed * 1103515245 + 12345;
+
+		if (str_cmp(sinput, "sorted") == 0)
+			key = i;
+		else if (str_cmp(sinput, "reversed") == 0)
+			key = sb->n - i;
+		else if (str_cmp(sinput, "dups") == 0)
+			key = (seed >> 16) % 4;
+		else
+			key = seed;
+
+		memcpy(sb->input + i * sb->esize, &key, sizeof(key));
+	}
+
+	return true;
+}
+
+/** Free buffers. */
+static void sort_teardown(sort_bench_t *sb)
+{
+	free(sb->input);
+	free(sb->work);
+}
+
+static bool qsort_runner(bench_env_t *env, bench_run_t *run, uint64_t size)
+{
+	sort_bench_t sb;
+
+	if (!sort_setup(env, run, &sb))
+		return false;
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < size; i++) {
+		memcpy(sb.work, sb.input, sb.n * sb.esize);
+		qsort(sb.work, sb.n, sb.esize, qsort_cmp);
+	}
+	bench_run_stop(run);
+
+	sort_teardown(&sb);
+	return true;
+}
+
+static bool gsort_runner(bench_env_t *env, bench_run_t *run, uint64_t size)
+{
+	sort_bench_t sb;
+	bool ok = true;
+
+	if (!sort_setup(env, run, &sb))
+		return false;
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < size && ok; i++) {
+		memcpy(sb.work, sb.input, sb.n * sb.esize);
+		ok = gsort(sb.work, sb.n, sb.esize, gsort_cmp, NULL);
+	}
+	bench_run_stop(run);
+
+	sort_teardown(&sb);
+
+	if (!ok)
+		return bench_run_fail(run, "gsort failed");
+
+	return true;
+}
+
+benchmark_t benchmark_gsort = {
+	.name = "gsort",
+	.desc = "Stable sort of 'n' elements (params n, esize, input)",
+	.entry = &gsort_runner,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+benchmark_t benchmark_qsort = {
+	.name = "qsort",
+	.desc = "Quicksort of 'n' elements (params n, esize, input)",
+	.entry = &qsort_runner,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+/** @}
+ */
@@ -0,0 +1,224 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <stdio.h>
+#include <str.h>
+#include <str_error.h>
+#include "../hbench.h"
+
+/*
+ * Formatted output benchmarks. One operation formats one line. 'fmt'
+ * selects the kind of line: 'int' (decimal integers), 'hex' (padded
+ * hexadecimal numbers and a pointer), 'str' (padded strings) or 'log'
+ * (default, a typical log message mixing all of them). fprintf writes
+ * the lines to file 'filename', rewinding it every PRINTF_REWIND lines
+ * to keep its size bounded.
+ */
+
+/** Number of lines after which the fprintf benchmark rewinds the file */
+#define PRINTF_REWIND  1024
+
+/** Kind of formatted line */
+typedef enum {
+	pf_int,
+	pf_hex,
+	pf_str,
+	pf_log
+} pf_kind_t;
+
+/** Parse format kind parameter.
+ *
+ * @param env Benchmark environment
+ * @param run Benchmark run
+ * @param rkind Place to store format kind
+ * @return @c true on success
+ */
+static bool pf_get_kind(bench_env_t *env, bench_run_t *run, pf_kind_t *rkind)
+{
+	const char *sfmt = bench_env_param_get(env, "fmt", "log");
+
+	if (str_cmp(sfmt, "int") == 0)
+		*rkind = pf_int;
+	else if (str_cmp(sfmt, "hex") == 0)
+		*rkind = pf_hex;
+	else if (str_cmp(sfmt, "str") == 0)
+		*rkind = pf_str;
+	else if (str_cmp(sfmt, "log") == 0)
+		*rkind = pf_log;
+	else
+		return bench_run_fail(run, "invalid fmt '%s'", sfmt);
+
+	return true;
+}
+
+/** Format one line.
+ *
+ * @param f File to print to or @c NULL to print to @a buf
+ * @param buf Buffer
+ * @param bsize Size of @a buf
+ * @param kind Kind of line
+ * @param i Iteration number (varies the printed values)
+ * @return Number of characters printed or negative value on error
+ */
+static int pf_line(FILE *f, char *buf, size_t bsize, pf_kind_t kind,
+    uint64_t i)
+{
+	switch (kind) {
+	case pf_int:
+		if (f != NULL) {
+			return fprintf(f, "%d %u %zu %lld\n", (int) i,
+			    (unsigned) i * 7, (size_t) i * 1000003,
+			    (long long) i * 123456789);
+		}
+
+		return snprintf(buf, bsize, "%d %u %zu %lld\n", (int) i,
+		    (unsigned) i * 7, (size_t) i * 1000003,
+		    (long long) i * 123456789);
+	case pf_hex:
+		if (f != NULL) {
+			return fprintf(f, "%08x %#lx %p\n", (unsigned) i,
+			    (unsigned long) i * 77, (void *) buf);
+		}
+
+		return snprintf(buf, bsize, "%08x %#lx %p\n", (unsigned) i,
+		    (unsigned long) i * 77, (void *) buf);
+	case pf_str:
+		if (f != NULL) {
+			return fprintf(f, "%s: %-20s|%10s\n", "name", "value",
+			    "right");
+		}
+
+		return snprintf(buf, bsize, "%s: %-20s|%10s\n", "name", "value",
+		    "right");
+	case pf_log:
+		if (f != NULL) {
+			return fprintf(f, "[%5u.%03u] %s: device '%s' added at "
+			    "address %#x, %zu bytes\n", (unsigned) i / 1000,
+			    (unsigned) i % 1000, "ddf", "pci0/00:1f.2",
+			    0xfee00000 + (unsigned) i % 4096, (size_t) 4096);
+		}
+
+		return snprintf(buf, bsize, "[%5u.%03u] %s: device '%s' added at "
+		    "address %#x, %zu bytes\n", (unsigned) i / 1000,
+		    (unsigned) i % 1000, "ddf", "pci0/00:1f.2",
+		    0xfee00000 + (unsigned) i % 4096, (size_t) 4096);
+	}
+
+	assert(false);
+	return -1;
+}
+
+static bool snprintf_runner(bench_env_t *env, bench_run_t *run, uint64_t size)
+{
+	char buf[128];
+	pf_kind_t kind;
+	bool ok = true;
+
+	if (!pf_get_kind(env, run, &kind))
+		return false;
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < size; i++) {
+		if (pf_line(NULL, buf, sizeof(buf), kind, i) < 0)
+			ok = false;
+	}
+	bench_run_stop(run);
+
+	if (!ok)
+		return bench_run_fail(run, "snprintf() failed");
+
+	return true;
+}
+
+static bool fprintf_runner(bench_env_t *env, bench_run_t *run, uint64_t size)
+{
+	const char *path = bench_env_param_get(env, "filename",
+	    "/tmp/hbench-printf.txt");
+	pf_kind_t kind;
+	FILE *f;
+	bool ok = true;
+
+	if (!pf_get_kind(env, run, &kind))
+		return false;
+
+	f = fopen(path, "w");
+	if (f == NULL) {
+		return bench_run_fail(run, "failed to open %s for writing: %s",
+		    path, str_error(errno));
+	}
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < size; i++) {
+		if (pf_line(f, NULL, 0, kind, i) < 0)
+			ok = false;
+
+		if (i % PRINTF_REWIND == PRINTF_REWIND - 1) {
+			if (fseek(f, 0, SEEK_SET) != 0)
+				ok = false;
+		}
+	}
+
+	if (fflush(f) != 0)
+		ok = false;
+	bench_run_stop(run);
+
+	fclose(f);
+	remove(path);
+
+	if (!ok) {
+		return bench_run_fail(run, "failed to write to %s: %s",
+		    path, str_error(errno));
+	}
+
+	return true;
+}
+
+benchmark_t benchmark_fprintf = {
+	.name = "fprintf",
+	.desc = "fprintf() of one line of kind 'fmt' to file 'filename'",
+	.entry = &fprintf_runner,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+benchmark_t benchmark_snprintf = {
+	.name = "snprintf",
+	.desc = "snprintf() of one line of kind 'fmt' (int, hex, str or log)",
+	.entry = &snprintf_runner,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+/** @}
+ */
@@ -0,0 +1,285 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <str.h>
+#include <uchar.h>
+#include "../hbench.h"
+
+/*
+ * Benchmarks of the string functions. One operation processes one string
+ * of about 'len' bytes (4096 by default). 'text' selects the kind of
+ * text: 'ascii' (default) is plain ASCII, 'mixed' is mostly ASCII with
+ * an occasional two-byte (Cyrillic) character, as in natural language
+ * text with diacritics, 'cyrillic' consists of two-byte characters
+ * and spaces and 'cjk' of three-byte characters only.
+ */
+
+/** Parameters and buffers of a benchmark run */
+typedef struct {
+	/** String */
+	char *str;
+	/** Copy of @c str */
+	char *copy;
+	/** Size of @c str in bytes */
+	size_t size;
+	/** Length of @c str in characters */
+	size_t length;
+} strops_t;
+
+/** Parse parameters and generate text.
+ *
+ * @param env Benchmark environment
+ * @param run Benchmark run
+ * @param ops Place to store parameters and buffers
+ * @return @c true on success
+ */
+static bool strops_setup(bench_env_t *env, bench_run_t *run, strops_t *ops)
+{
+	const char *stext = bench_env_param_get(env, "text", "ascii");
+	const char *slen = bench_env_param_get(env, "len", "4096");
+	char32_t ch;
+	size_t len;
+	size_t off;
+	size_t i;
+	errno_t rc;
+
+	len = strtoul(slen, NULL, 10);
+	if (len == 0)
+		return bench_run_fail(run, "invalid len '%s'", slen);
+
+	if (str_cmp(stext, "ascii") != 0 && str_cmp(stext, "mixed") != 0 &&
+	    str_cmp(stext, "cyrillic") != 0 && str_cmp(stext, "cjk") != 0)
+		return bench_run_fail(run, "invalid text '%s'", stext);
+
+	ops->str = malloc(len + 1);
+	ops->copy = malloc(len + 1);
+	if (ops->str == NULL || ops->copy == NULL) {
+		free(ops->str);
+		free(ops->copy);
+		return bench_run_fail(run, "out of memory");
+	}
+
+	off = 0;
+	ops->length = 0;
+	for (i = 0; true; i++) {
+		if (str_cmp(stext, "ascii") == 0)
+			ch = (i % 7 == 6) ? ' ' : 'a' + i % 26;
+		else if (str_cmp(stext, "mixed") == 0)
+			ch = (i % 7 == 6) ? ' ' : (i % 23 == 0) ? 0x430 + i % 32 :
+			    'a' + i % 26;
+		else if (str_cmp(stext, "cyrillic") == 0)
+			ch = (i % 7 == 6) ? ' ' : 0x430 + i % 32;
+		else
+			ch = 0x4e00 + i % 1024;
+
+		rc = chr_encode(ch, ops->str, &off, len);
+		if (rc != EOK)
+			break;
+
+		++ops->length;
+	}
+
+	ops->str[off] = '\0';
+	ops->size = off;
+	str_cpy(ops->copy, len + 1, ops->str);
+	return true;
+}
+
+/** Free buffers. */
+static void strops_teardown(strops_t *ops)
+{
+	free(ops->str);
+	free(ops->copy);
+}
+
+static bool str_size_runner(bench_env_t *env, bench_run_t *run, uint64_t size)
+{
+	strops_t ops;
+	bool ok = true;
+
+	if (!strops_setup(env, run, &ops))
+		return false;
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < size; i++) {
+		if (str_size(ops.str) != ops.size)
+			ok = false;
+	}
+	bench_run_stop(run);
+
+	strops_teardown(&ops);
+
+	if (!ok)
+		return bench_run_fail(run, "str_size() returned wrong size");
+
+	return true;
+}
+
+static bool str_length_runner(bench_env_t *env, bench_run_t *run,
+    uint64_t size)
+{
+	strops_t ops;
+	bool ok = true;
+
+	if (!strops_setup(env, run, &ops))
+		return false;
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < size; i++) {
+		if (str_length(ops.str) != ops.length)
+			ok = false;
+	}
+	bench_run_stop(run);
+
+	strops_teardown(&ops);
+
+	if (!ok)
+		return bench_run_fail(run, "str_length() returned wrong length");
+
+	return true;
+}
+
+static bool str_cmp_runner(bench_env_t *env, bench_run_t *run, uint64_t size)
+{
+	strops_t ops;
+	bool ok = true;
+
+	if (!strops_setup(env, run, &ops))
+		return false;
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < size; i++) {
+		if (str_cmp(ops.str, ops.copy) != 0)
+			ok = false;
+	}
+	bench_run_stop(run);
+
+	strops_teardown(&ops);
+
+	if (!ok)
+		return bench_run_fail(run, "str_cmp() found difference");
+
+	return true;
+}
+
+static bool str_chr_runner(bench_env_t *env, bench_run_t *run, uint64_t size)
+{
+	strops_t ops;
+	bool ok = true;
+
+	if (!strops_setup(env, run, &ops))
+		return false;
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < size; i++) {
+		if (str_chr(ops.str, '/') != NULL)
+			ok = false;
+	}
+	bench_run_stop(run);
+
+	strops_teardown(&ops);
+
+	if (!ok)
+		return bench_run_fail(run, "str_chr() found absent character");
+
+	return true;
+}
+
+static bool str_to_wstr_runner(bench_env_t *env, bench_run_t *run,
+    uint64_t size)
+{
+	strops_t ops;
+	char32_t *wstr;
+
+	if (!strops_setup(env, run, &ops))
+		return false;
+
+	wstr = malloc((ops.length + 1) * sizeof(char32_t));
+	if (wstr == NULL) {
+		strops_teardown(&ops);
+		return bench_run_fail(run, "out of memory");
+	}
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < size; i++)
+		str_to_wstr(wstr, ops.length + 1, ops.str);
+	bench_run_stop(run);
+
+	free(wstr);
+	strops_teardown(&ops);
+	return true;
+}
+
+benchmark_t benchmark_str_chr = {
+	.name = "str_chr",
+	.desc = "str_chr() of absent character in 'len' bytes of 'text'",
+	.entry = &str_chr_runner,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+benchmark_t benchmark_str_cmp = {
+	.name = "str_cmp",
+	.desc = "str_cmp() of two equal strings of 'len' bytes of 'text'",
+	.entry = &str_cmp_runner,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+benchmark_t benchmark_str_length = {
+	.name = "str_length",
+	.desc = "str_length() of 'len' bytes of 'text'",
+	.entry = &str_length_runner,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+benchmark_t benchmark_str_size = {
+	.name = "str_size",
+	.desc = "str_size() of 'len' bytes of 'text'",
+	.entry = &str_size_runner,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+benchmark_t benchmark_str_to_wstr = {
+	.name = "str_to_wstr",
+	.desc = "str_to_wstr() of 'len' bytes of 'text'",
+	.entry = &str_to_wstr_runner,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+/** @}
+ */
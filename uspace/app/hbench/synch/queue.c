@@ -0,0 +1,303 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <adt/mpmc_ring.h>
+#include <adt/mpsc_queue.h>
+#include <adt/prodcons.h>
+#include <adt/spsc_ring.h>
+#include <errno.h>
+#include <fibril.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include "../hbench.h"
+
+/*
+ * Throughput of queues handing off items between fibrils. 'producers'
+ * fibrils (1 by default, always 1 for spsc_ring) push 'size' items
+ * altogether, the benchmark fibril pops them. The fibrils are spread
+ * over as many runner threads. The rings hold 'ring' items (1024 by
+ * default), the producers and the consumer yield when the ring is
+ * full or empty. prodcons (mutex and condition variable) serves as
+ * a baseline for mpsc_queue.
+ */
+
+/** Maximum number of producers */
+#define QUEUE_MAX_PRODUCERS  16
+
+typedef enum {
+	qk_spsc_ring,
+	qk_mpmc_ring,
+	qk_mpsc_queue,
+	qk_prodcons
+} queue_kind_t;
+
+/** Item of the linked queues */
+typedef struct {
+	mpsc_link_t mlink;
+	link_t link;
+	uint64_t value;
+} queue_item_t;
+
+/** Shared state of a benchmark run */
+typedef struct {
+	queue_kind_t kind;
+	spsc_ring_t spsc;
+	mpmc_ring_t mpmc;
+	mpsc_queue_t mpsc;
+	prodcons_t pc;
+	/** Items for the linked queues */
+	queue_item_t *items;
+	/** Number of items per producer */
+	uint64_t count;
+	/** Next producer number */
+	atomic_size_t next_id;
+	/** Number of producers that have finished */
+	atomic_size_t done;
+} queue_shared_t;
+
+/** Number of runner threads spawned so far */
+static int queue_runners;
+
+static errno_t queue_producer(void *arg)
+{
+	queue_shared_t *shared = arg;
+	size_t id = atomic_fetch_add(&shared->next_id, 1);
+	queue_item_t *items = shared->items + id * shared->count;
+
+	fibril_detach(fibril_get_id());
+
+	for (uint64_t i = 0; i < shared->count; i++) {
+		uint64_t value = i + 1;
+
+		switch (shared->kind) {
+		case qk_spsc_ring:
+			while (spsc_ring_push(&shared->spsc, &value) != EOK)
+				fibril_yield();
+			break;
+		case qk_mpmc_ring:
+			while (mpmc_ring_push(&shared->mpmc, &value) != EOK)
+				fibril_yield();
+			break;
+		case qk_mpsc_queue:
+			items[i].value = value;
+			mpsc_queue_push(&shared->mpsc, &items[i].mlink);
+			break;
+		case qk_prodcons:
+			items[i].value = value;
+			prodcons_produce(&shared->pc, &items[i].link);
+			break;
+		}
+	}
+
+	atomic_fetch_add(&shared->done, 1);
+	return EOK;
+}
+
+/** Pop one item. */
+static uint64_t queue_consume(queue_shared_t *shared)
+{
+	queue_item_t *item;
+	uint64_t value;
+
+	switch (shared->kind) {
+	case qk_spsc_ring:
+		while (spsc_ring_pop(&shared->spsc, &value) != EOK)
+			fibril_yield();
+		return value;
+	case qk_mpmc_ring:
+		while (mpmc_ring_pop(&shared->mpmc, &value) != EOK)
+			fibril_yield();
+		return value;
+	case qk_mpsc_queue:
+		item = mpsc_queue_get_instance(mpsc_queue_pop(&shared->mpsc),
+		    queue_item_t, mlink);
+		return item->value;
+	case qk_prodcons:
+		item = list_get_instance(prodcons_consume(&shared->pc),
+		    queue_item_t, link);
+		return item->value;
+	}
+
+	return 0;
+}
+
+static bool queue_runner(bench_env_t *env, bench_run_t *run, uint64_t size,
+    queue_kind_t kind)
+{
+	const char *sproducers = bench_env_param_get(env, "producers", "1");
+	const char *sring = bench_env_param_get(env, "ring", "1024");
+	queue_shared_t *shared;
+	size_t producers;
+	size_t ring;
+	uint64_t sum;
+	errno_t rc;
+
+	producers = strtoul(sproducers, NULL, 10);
+	if (kind == qk_spsc_ring)
+		producers = 1;
+	if (producers == 0 || producers > QUEUE_MAX_PRODUCERS)
+		return bench_run_fail(run, "invalid producers '%s'", sproducers);
+
+	ring = strtoul(sring, NULL, 10);
+
+	shared = calloc(1, sizeof(queue_shared_t));
+	if (shared == NULL)
+		return bench_run_fail(run, "out of memory");
+
+	shared->kind = kind;
+	shared->count = size / producers;
+	atomic_store(&shared->next_id, 0);
+	atomic_store(&shared->done, 0);
+
+	switch (kind) {
+	case qk_spsc_ring:
+		rc = spsc_ring_init(&shared->spsc, ring, sizeof(uint64_t));
+		break;
+	case qk_mpmc_ring:
+		rc = mpmc_ring_init(&shared->mpmc, ring, sizeof(uint64_t));
+		break;
+	case qk_mpsc_queue:
+	case qk_prodcons:
+		if (kind == qk_mpsc_queue)
+			mpsc_queue_initialize(&shared->mpsc);
+		else
+			prodcons_initialize(&shared->pc);
+
+		shared->items = calloc(shared->count * producers,
+		    sizeof(queue_item_t));
+		rc = (shared->items != NULL) ? EOK : ENOMEM;
+		break;
+	}
+
+	if (rc != EOK) {
+		free(shared);
+		if (rc == EINVAL)
+			return bench_run_fail(run, "invalid ring '%s'", sring);
+		return bench_run_fail(run, "out of memory");
+	}
+
+	/* One runner for each producer and one for the consumer */
+	if (queue_runners < (int) producers + 1) {
+		queue_runners += fibril_test_spawn_runners(producers + 1 -
+		    queue_runners);
+	}
+
+	bench_run_start(run);
+
+	for (size_t i = 0; i < producers; i++) {
+		fid_t fid = fibril_create(queue_producer, shared);
+		if (fid == 0) {
+			/* Cannot recover, the producers started would hang */
+			abort();
+		}
+		fibril_add_ready(fid);
+	}
+
+	sum = 0;
+	for (uint64_t i = 0; i < shared->count * producers; i++)
+		sum += queue_consume(shared);
+
+	bench_run_stop(run);
+
+	while (atomic_load(&shared->done) < producers)
+		fibril_yield();
+
+	uint64_t expected = producers * (shared->count * (shared->count + 1) / 2);
+
+	if (kind == qk_spsc_ring)
+		spsc_ring_fini(&shared->spsc);
+	else if (kind == qk_mpmc_ring)
+		mpmc_ring_fini(&shared->mpmc);
+
+	free(shared->items);
+	free(shared);
+
+	if (sum != expected)
+		return bench_run_fail(run, "items lost");
+
+	return true;
+}
+
+static bool spsc_ring_runner(bench_env_t *env, bench_run_t *run, uint64_t size)
+{
+	return queue_runner(env, run, size, qk_spsc_ring);
+}
+
+static bool mpmc_ring_runner(bench_env_t *env, bench_run_t *run, uint64_t size)
+{
+	return queue_runner(env, run, size, qk_mpmc_ring);
+}
+
+static bool mpsc_queue_runner(bench_env_t *env, bench_run_t *run, uint64_t size)
+{
+	return queue_runner(env, run, size, qk_mpsc_queue);
+}
+
+static bool prodcons_runner(bench_env_t *env, bench_run_t *run, uint64_t size)
+{
+	return queue_runner(env, run, size, qk_prodcons);
+}
+
+benchmark_t benchmark_spsc_ring = {
+	.name = "spsc_ring",
+	.desc = "Throughput of wait-free SPSC ring",
+	.entry = &spsc_ring_runner,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+benchmark_t benchmark_mpmc_ring = {
+	.name = "mpmc_ring",
+	.desc = "Throughput of lock-free MPMC ring",
+	.entry = &mpmc_ring_runner,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+benchmark_t benchmark_mpsc_queue = {
+	.name = "mpsc_queue",
+	.desc = "Throughput of lock-free intrusive MPSC queue",
+	.entry = &mpsc_queue_runner,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+benchmark_t benchmark_prodcons = {
+	.name = "prodcons",
+	.desc = "Throughput of mutex-based producer-consumer queue",
+	.entry = &prodcons_runner,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+/** @}
+ */
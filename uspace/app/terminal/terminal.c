@@ -48,6 +48,7 @@
 #include <io/console.h>
 #include <io/pixelmap.h>
 #include <macros.h>
+#include <mem.h>
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -73,6 +74,8 @@
 	CONSOLE_CAP_RGB)
 
 #define SCROLLBACK_MAX_LINES 1000
+/** Minimum interval between presenting two frames (microseconds) */
+#define TERM_FRAME_USEC 16667
 #define MIN_WINDOW_COLS 8
 #define MIN_WINDOW_ROWS 4
 
@@ -256,8 +259,31 @@ static void term_update_region(terminal_t *term, sysarg_t x, sysarg_t y,
 	term->update = nupdate;
 }
 
+/** Forget what is drawn in the cells.
+ *
+ * The contents of the shadow cell array is set to a value that no real
+ * cell can have so that all cells are redrawn on next update.
+ */
+static void term_cells_invalidate(terminal_t *term)
+{
+	if (term->cells != NULL) {
+		memset(term->cells, 0xff, (size_t) term->cell_cols *
+		    term->cell_rows * sizeof(termui_cell_t));
+	}
+}
+
 static void term_draw_cell(terminal_t *term, pixelmap_t *pixelmap, int col, int row, const termui_cell_t *cell)
 {
+	/* Skip cells that already look the same */
+	if (term->cells != NULL && col < term->cell_cols &&
+	    row < term->cell_rows) {
+		termui_cell_t *drawn = &term->cells[row * term->cell_cols + col];
+		if (memcmp(drawn, cell, sizeof(termui_cell_t)) == 0)
+			return;
+
+		*drawn = *cell;
+	}
+
 	termui_color_t bg = cell->bgcolor;
 	if (bg == TERMUI_COLOR_DEFAULT)
 		bg = term->default_bgcolor;
@@ -302,7 +328,8 @@ static void term_draw_cell(terminal_t *term, pixelmap_t *pixelmap, int col, int
 
 static void term_render(terminal_t *term)
 {
-	(void) gfx_bitmap_render(term->bmp, &term->update, &term->off);
+	if (!gfx_rect_is_empty(&term->update))
+		(void) gfx_bitmap_render(term->bmp, &term->update, &term->off);
 
 	term->update.p0.x = 0;
 	term->update.p0.y = 0;
@@ -310,6 +337,55 @@ static void term_render(terminal_t *term)
 	term->update.p1.y = 0;
 }
 
+static void term_frame_timer(void *arg)
+{
+	terminal_t *term = (terminal_t *) arg;
+
+	fibril_mutex_lock(&term->mtx);
+
+	if (term->frame_pending) {
+		term->frame_pending = false;
+		term_render(term);
+		gfx_update(term->gc);
+		fibril_timer_set(term->frame_timer, TERM_FRAME_USEC,
+		    term_frame_timer, term);
+	} else {
+		term->frame_active = false;
+	}
+
+	fibril_mutex_unlock(&term->mtx);
+}
+
+/** Present terminal contents, at most once per frame.
+ *
+ * The first change after an idle period is presented immediately,
+ * further changes are collected and presented when the frame timer
+ * fires. This way a client producing a lot of output is limited by
+ * how fast we can parse it, not by how fast we can draw it.
+ *
+ * Must be called with term->mtx held.
+ */
+static void term_schedule_render(terminal_t *term)
+{
+	if (term->frame_timer == NULL) {
+		term_render(term);
+		gfx_update(term->gc);
+		return;
+	}
+
+	if (term->frame_active) {
+		term->frame_pending = true;
+		return;
+	}
+
+	term_render(term);
+	gfx_update(term->gc);
+
+	term->frame_active = true;
+	fibril_timer_set(term->frame_timer, TERM_FRAME_USEC,
+	    term_frame_timer, term);
+}
+
 static void termui_refresh_cb(void *userdata)
 {
 	terminal_t *term = userdata;
@@ -317,12 +393,55 @@ static void termui_refresh_cb(void *userdata)
 	termui_force_viewport_update(term->termui, 0, termui_get_rows(term->termui));
 }
 
+static pixelmap_t term_get_pixelmap(terminal_t *term);
+
 static void termui_scroll_cb(void *userdata, int delta)
 {
-	(void) delta;
+	terminal_t *term = userdata;
+	int rows = termui_get_rows(term->termui);
+	int cols = termui_get_cols(term->termui);
+	int keep;
+	size_t line;
+	size_t cline;
+
+	pixelmap_t pixelmap = term_get_pixelmap(term);
+
+	if (pixelmap.data == NULL || term->cells == NULL ||
+	    cols != term->cell_cols || rows != term->cell_rows ||
+	    delta >= rows || -delta >= rows) {
+		termui_refresh_cb(userdata);
+		return;
+	}
+
+	/*
+	 * Move the rows that stay visible, both in the bitmap and in the
+	 * shadow cells. The shadow cells of the uncovered rows still
+	 * describe the pixels there, so redrawing them only touches cells
+	 * that actually differ.
+	 */
+	line = (size_t) pixelmap.width * FONT_SCANLINES;
+	cline = (size_t) cols;
+
+	if (delta > 0) {
+		keep = rows - delta;
+		memmove(pixelmap.data, pixelmap.data + delta * line,
+		    keep * line * sizeof(pixel_t));
+		memmove(term->cells, term->cells + delta * cline,
+		    keep * cline * sizeof(termui_cell_t));
+	} else {
+		keep = rows + delta;
+		memmove(pixelmap.data - delta * line, pixelmap.data,
+		    keep * line * sizeof(pixel_t));
+		memmove(term->cells - delta * cline, term->cells,
+		    keep * cline * sizeof(termui_cell_t));
+	}
 
-	// Until we have support for hardware accelerated scrolling, just redraw everything.
-	termui_refresh_cb(userdata);
+	term_update_region(term, 0, 0, pixelmap.width, rows * FONT_SCANLINES);
+
+	if (delta > 0)
+		termui_force_viewport_update(term->termui, keep, delta);
+	else
+		termui_force_viewport_update(term->termui, 0, -delta);
 }
 
 static pixelmap_t term_get_pixelmap(terminal_t *term)
@@ -350,6 +469,7 @@ static void term_clear_bitmap(terminal_t *term, pixel_t color)
 	for (sysarg_t i = 0; i < pixels; i++)
 		pixelmap.data[i] = color;
 
+	term_cells_invalidate(term);
 	term_update_region(term, 0, 0, pixelmap.width, pixelmap.height);
 }
 
@@ -460,10 +580,9 @@ static errno_t term_write(con_srv_t *srv, void *data, size_t size, size_t *nwrit
 	while (off < size)
 		term_write_char(term, str_decode(data, &off, size));
 
+	term_schedule_render(term);
 	fibril_mutex_unlock(&term->mtx);
 
-	term_render(term);
-	gfx_update(term->gc);
 	*nwritten = size;
 
 	return EOK;
@@ -473,8 +592,11 @@ static void term_sync(con_srv_t *srv)
 {
 	terminal_t *term = srv_to_terminal(srv);
 
+	fibril_mutex_lock(&term->mtx);
+	term->frame_pending = false;
 	term_render(term);
 	gfx_update(term->gc);
+	fibril_mutex_unlock(&term->mtx);
 }
 
 static void term_clear(con_srv_t *srv)
@@ -483,10 +605,8 @@ static void term_clear(con_srv_t *srv)
 
 	fibril_mutex_lock(&term->mtx);
 	termui_clear_screen(term->termui);
+	term_schedule_render(term);
 	fibril_mutex_unlock(&term->mtx);
-
-	term_render(term);
-	gfx_update(term->gc);
 }
 
 static void term_set_pos(con_srv_t *srv, sysarg_t col, sysarg_t row)
@@ -495,10 +615,8 @@ static void term_set_pos(con_srv_t *srv, sysarg_t col, sysarg_t row)
 
 	fibril_mutex_lock(&term->mtx);
 	termui_set_pos(term->termui, col, row);
+	term_schedule_render(term);
 	fibril_mutex_unlock(&term->mtx);
-
-	term_render(term);
-	gfx_update(term->gc);
 }
 
 static errno_t term_get_pos(con_srv_t *srv, sysarg_t *col, sysarg_t *row)
@@ -606,10 +724,8 @@ static void term_set_cursor_visibility(con_srv_t *srv, bool visible)
 
 	fibril_mutex_lock(&term->mtx);
 	termui_set_cursor_visibility(term->termui, visible);
+	term_schedule_render(term);
 	fibril_mutex_unlock(&term->mtx);
-
-	term_render(term);
-	gfx_update(term->gc);
 }
 
 static errno_t term_set_caption(con_srv_t *srv, const char *caption)
@@ -754,11 +870,9 @@ static void term_buf_update(con_srv_t *srv, sysarg_t c0, sysarg_t r0,
 		termui_update_cb(term, c0, row, &cells[c0], c1 - c0);
 	}
 
-	fibril_mutex_unlock(&term->mtx);
-
 	/* Update terminal */
-	term_render(term);
-	gfx_update(term->gc);
+	term_schedule_render(term);
+	fibril_mutex_unlock(&term->mtx);
 }
 
 static errno_t terminal_window_resize(terminal_t *term)
@@ -787,9 +901,19 @@ static errno_t terminal_window_resize(terminal_t *term)
 	params.rect.p1.x = width;
 	params.rect.p1.y = height;
 
+	int cell_cols = width / FONT_WIDTH;
+	int cell_rows = height / FONT_SCANLINES;
+	termui_cell_t *new_cells = calloc((size_t) cell_cols * cell_rows,
+	    sizeof(termui_cell_t));
+	if (new_cells == NULL && cell_cols > 0 && cell_rows > 0) {
+		fprintf(stderr, "Error allocating screen cells.\n");
+		return ENOMEM;
+	}
+
 	errno_t rc = gfx_bitmap_create(term->gc, &params, NULL, &new_bmp);
 	if (rc != EOK) {
 		fprintf(stderr, "Error allocating new screen bitmap: %s\n", str_error(rc));
+		free(new_cells);
 		return rc;
 	}
 
@@ -803,6 +927,11 @@ static errno_t terminal_window_resize(terminal_t *term)
 	term->w = width;
 	term->h = height;
 
+	free(term->cells);
+	term->cells = new_cells;
+	term->cell_cols = cell_cols;
+	term->cell_rows = cell_rows;
+
 	term_clear_bitmap(term, termui_color_to_pixel(term->default_bgcolor));
 
 	return EOK;
@@ -812,12 +941,18 @@ void terminal_destroy(terminal_t *term)
 {
 	list_remove(&term->link);
 
+	if (term->frame_timer != NULL) {
+		fibril_timer_clear(term->frame_timer);
+		fibril_timer_destroy(term->frame_timer);
+	}
+
 	termui_destroy(term->termui);
 
 	if (term->ubuf)
 		as_area_destroy(term->ubuf);
 
 	ui_destroy(term->ui);
+	free(term->cells);
 	free(term);
 }
 
@@ -1070,6 +1205,13 @@ errno_t terminal_create(const char *display_spec, sysarg_t width,
 	prodcons_initialize(&term->input_pc);
 	term->char_remains_len = 0;
 
+	term->frame_timer = fibril_timer_create(NULL);
+	if (term->frame_timer == NULL) {
+		printf("Out of memory.\n");
+		free(term);
+		return ENOMEM;
+	}
+
 	term->default_bgcolor = termui_color_from_pixel(_basic_colors[COLOR_WHITE | COLOR_BRIGHT]);
 	term->default_fgcolor = termui_color_from_pixel(_basic_colors[COLOR_BLACK]);
 
@@ -1149,6 +1291,9 @@ error:
 		ui_destroy(term->ui);
 	if (term->termui != NULL)
 		termui_destroy(term->termui);
+	fibril_timer_clear(term->frame_timer);
+	fibril_timer_destroy(term->frame_timer);
+	free(term->cells);
 	free(term);
 	return rc;
 }
@@ -73,6 +73,18 @@ typedef struct {
 	gfx_coord2_t off;
 	bool is_focused;
 
+	/** Cells as currently drawn in @c bmp (cell_cols * cell_rows) */
+	termui_cell_t *cells;
+	int cell_cols;
+	int cell_rows;
+
+	/** Limits presenting the bitmap to once per frame */
+	fibril_timer_t *frame_timer;
+	/** Frame timer is running */
+	bool frame_active;
+	/** Bitmap has changed since the last frame was presented */
+	bool frame_pending;
+
 	fibril_mutex_t mtx;
 	link_t link;
 	atomic_flag refcnt;
@@ -51,6 +51,7 @@ char **test_argv;
 test_t tests[] = {
 #include "thread/deadlock.def"
 #include "thread/thread1.def"
+#include "thread/queue1.def"
 #include "thread/setjmp1.def"
 #include "print/print1.def"
 #include "print/print2.def"
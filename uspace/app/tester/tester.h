@@ -81,6 +81,7 @@ typedef struct {
 
 extern const char *test_deadlock(void);
 extern const char *test_thread1(void);
+extern const char *test_queue1(void);
 extern const char *test_setjmp1(void);
 extern const char *test_print1(void);
 extern const char *test_print2(void);
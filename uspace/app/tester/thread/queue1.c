@@ -0,0 +1,264 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define PRODUCERS  4
+#define CONSUMERS  2
+#define COUNT      100000
+#define RING_SIZE  64
+
+#include <adt/mpmc_ring.h>
+#include <adt/mpsc_queue.h>
+#include <adt/spsc_ring.h>
+#include <errno.h>
+#include <fibril.h>
+#include <fibril_synch.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "../tester.h"
+
+/*
+ * Producers tag each item with their number in the upper and with
+ * a sequence number in the lower 32 bits. Every consumer must see
+ * the items of each producer in increasing order and all items must
+ * arrive exactly once.
+ */
+
+typedef struct {
+	mpsc_link_t link;
+	uint64_t value;
+} queue1_item_t;
+
+static spsc_ring_t spsc;
+static mpmc_ring_t mpmc;
+static mpsc_queue_t mpsc;
+static queue1_item_t *items;
+
+static atomic_size_t next_id;
+static atomic_size_t consumed;
+static atomic_uint_fast64_t sum;
+static atomic_bool failed;
+
+static FIBRIL_SEMAPHORE_INITIALIZE(fibrils_finished, 0);
+
+static uint64_t expected_sum(size_t producers)
+{
+	uint64_t s = 0;
+
+	for (size_t id = 0; id < producers; id++)
+		s += id * COUNT * ((uint64_t) 1 << 32) +
+		    (uint64_t) COUNT * (COUNT - 1) / 2;
+
+	return s;
+}
+
+/** Check that @a value follows the previous item of its producer. */
+static void check_order(uint64_t *last, uint64_t value)
+{
+	size_t id = value >> 32;
+
+	if (id >= PRODUCERS || (uint32_t) value < last[id])
+		atomic_store(&failed, true);
+	last[id] = (uint32_t) value + 1;
+}
+
+static void reset(void)
+{
+	atomic_store(&next_id, 0);
+	atomic_store(&consumed, 0);
+	atomic_store(&sum, 0);
+}
+
+static errno_t spsc_producer(void *arg)
+{
+	fibril_detach(fibril_get_id());
+
+	for (uint64_t i = 0; i < COUNT; i++) {
+		while (spsc_ring_push(&spsc, &i) != EOK)
+			fibril_yield();
+	}
+
+	fibril_semaphore_up(&fibrils_finished);
+	return EOK;
+}
+
+static errno_t spsc_consumer(void *arg)
+{
+	uint64_t last[PRODUCERS] = { 0 };
+	uint64_t value;
+
+	fibril_detach(fibril_get_id());
+
+	for (size_t i = 0; i < COUNT; i++) {
+		while (spsc_ring_pop(&spsc, &value) != EOK)
+			fibril_yield();
+		check_order(last, value);
+		atomic_fetch_add(&sum, value);
+	}
+
+	fibril_semaphore_up(&fibrils_finished);
+	return EOK;
+}
+
+static errno_t mpmc_producer(void *arg)
+{
+	uint64_t id = atomic_fetch_add(&next_id, 1);
+
+	fibril_detach(fibril_get_id());
+
+	for (uint64_t i = 0; i < COUNT; i++) {
+		uint64_t value = (id << 32) | i;
+		while (mpmc_ring_push(&mpmc, &value) != EOK)
+			fibril_yield();
+	}
+
+	fibril_semaphore_up(&fibrils_finished);
+	return EOK;
+}
+
+static errno_t mpmc_consumer(void *arg)
+{
+	uint64_t last[PRODUCERS] = { 0 };
+	uint64_t value;
+
+	fibril_detach(fibril_get_id());
+
+	while (atomic_load(&consumed) < PRODUCERS * COUNT) {
+		if (mpmc_ring_pop(&mpmc, &value) != EOK) {
+			fibril_yield();
+			continue;
+		}
+
+		check_order(last, value);
+		atomic_fetch_add(&sum, value);
+		atomic_fetch_add(&consumed, 1);
+	}
+
+	fibril_semaphore_up(&fibrils_finished);
+	return EOK;
+}
+
+static errno_t mpsc_producer(void *arg)
+{
+	uint64_t id = atomic_fetch_add(&next_id, 1);
+
+	fibril_detach(fibril_get_id());
+
+	for (uint64_t i = 0; i < COUNT; i++) {
+		queue1_item_t *item = &items[id * COUNT + i];
+		item->value = (id << 32) | i;
+		mpsc_queue_push(&mpsc, &item->link);
+
+		/* Let the consumer block now and then */
+		if (i % 10000 == 0)
+			fibril_usleep(1000);
+	}
+
+	fibril_semaphore_up(&fibrils_finished);
+	return EOK;
+}
+
+static errno_t mpsc_consumer(void *arg)
+{
+	uint64_t last[PRODUCERS] = { 0 };
+	queue1_item_t *item;
+
+	fibril_detach(fibril_get_id());
+
+	for (size_t i = 0; i < PRODUCERS * COUNT; i++) {
+		item = mpsc_queue_get_instance(mpsc_queue_pop(&mpsc),
+		    queue1_item_t, link);
+		check_order(last, item->value);
+		atomic_fetch_add(&sum, item->value);
+	}
+
+	fibril_semaphore_up(&fibrils_finished);
+	return EOK;
+}
+
+/** Run producers and consumers and wait for them to finish. */
+static const char *run(errno_t (*producer)(void *), size_t producers,
+    errno_t (*consumer)(void *), size_t consumers)
+{
+	reset();
+
+	for (size_t i = 0; i < producers + consumers; i++) {
+		fid_t f = fibril_create(i < producers ? producer : consumer,
+		    NULL);
+		if (f == 0) {
+			/* Cannot recover, the fibrils started would hang */
+			abort();
+		}
+		fibril_add_ready(f);
+	}
+
+	for (size_t i = 0; i < producers + consumers; i++)
+		fibril_semaphore_down(&fibrils_finished);
+
+	if (atomic_load(&failed))
+		return "Items out of order";
+
+	if (atomic_load(&sum) != expected_sum(producers))
+		return "Items lost or duplicated";
+
+	return NULL;
+}
+
+const char *test_queue1(void)
+{
+	const char *err;
+
+	atomic_store(&failed, false);
+	fibril_test_spawn_runners(PRODUCERS + CONSUMERS);
+
+	TPRINTF("Testing SPSC ring...\n");
+	if (spsc_ring_init(&spsc, RING_SIZE, sizeof(uint64_t)) != EOK)
+		return "Out of memory";
+	err = run(spsc_producer, 1, spsc_consumer, 1);
+	spsc_ring_fini(&spsc);
+	if (err != NULL)
+		return err;
+
+	TPRINTF("Testing MPMC ring...\n");
+	if (mpmc_ring_init(&mpmc, RING_SIZE, sizeof(uint64_t)) != EOK)
+		return "Out of memory";
+	err = run(mpmc_producer, PRODUCERS, mpmc_consumer, CONSUMERS);
+	mpmc_ring_fini(&mpmc);
+	if (err != NULL)
+		return err;
+
+	TPRINTF("Testing MPSC queue...\n");
+	items = calloc(PRODUCERS * COUNT, sizeof(queue1_item_t));
+	if (items == NULL)
+		return "Out of memory";
+	mpsc_queue_initialize(&mpsc);
+	err = run(mpsc_producer, PRODUCERS, mpsc_consumer, 1);
+	free(items);
+
+	return err;
+}
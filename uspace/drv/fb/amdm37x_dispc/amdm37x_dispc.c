@@ -45,6 +45,7 @@
 #include <ddi.h>
 #include <gfx/color.h>
 #include <io/pixelmap.h>
+#include <macros.h>
 
 #include "amdm37x_dispc.h"
 
@@ -93,22 +94,38 @@ gfx_context_ops_t amdm37x_gc_ops = {
 static const struct {
 	unsigned bpp;
 	pixel2visual_t func;
+	pixel2visual_span_t span;
 } pixel2visual_table[] = {
-	[VISUAL_INDIRECT_8] = { .bpp = 1, .func = pixel2bgr_323 },
-	[VISUAL_RGB_5_5_5_LE] = { .bpp = 2, .func = pixel2rgb_555_le },
-	[VISUAL_RGB_5_5_5_BE] = { .bpp = 2, .func = pixel2rgb_555_be },
-	[VISUAL_RGB_5_6_5_LE] = { .bpp = 2, .func = pixel2rgb_565_le },
-	[VISUAL_RGB_5_6_5_BE] = { .bpp = 2, .func = pixel2rgb_565_be },
-	[VISUAL_BGR_8_8_8] = { .bpp = 3, .func = pixel2bgr_888 },
-	[VISUAL_RGB_8_8_8] = { .bpp = 3, .func = pixel2rgb_888 },
-	[VISUAL_BGR_0_8_8_8] = { .bpp = 4, .func = pixel2rgb_0888 },
-	[VISUAL_BGR_8_8_8_0] = { .bpp = 4, .func = pixel2bgr_8880 },
-	[VISUAL_ABGR_8_8_8_8] = { .bpp = 4, .func = pixel2abgr_8888 },
-	[VISUAL_BGRA_8_8_8_8] = { .bpp = 4, .func = pixel2bgra_8888 },
-	[VISUAL_RGB_0_8_8_8] = { .bpp = 4, .func = pixel2rgb_0888 },
-	[VISUAL_RGB_8_8_8_0] = { .bpp = 4, .func = pixel2rgb_8880 },
-	[VISUAL_ARGB_8_8_8_8] = { .bpp = 4, .func = pixel2argb_8888 },
-	[VISUAL_RGBA_8_8_8_8] = { .bpp = 4, .func = pixel2rgba_8888 },
+	[VISUAL_INDIRECT_8] = { .bpp = 1, .func = pixel2bgr_323,
+	    .span = pixel2bgr_323_span },
+	[VISUAL_RGB_5_5_5_LE] = { .bpp = 2, .func = pixel2rgb_555_le,
+	    .span = pixel2rgb_555_le_span },
+	[VISUAL_RGB_5_5_5_BE] = { .bpp = 2, .func = pixel2rgb_555_be,
+	    .span = pixel2rgb_555_be_span },
+	[VISUAL_RGB_5_6_5_LE] = { .bpp = 2, .func = pixel2rgb_565_le,
+	    .span = pixel2rgb_565_le_span },
+	[VISUAL_RGB_5_6_5_BE] = { .bpp = 2, .func = pixel2rgb_565_be,
+	    .span = pixel2rgb_565_be_span },
+	[VISUAL_BGR_8_8_8] = { .bpp = 3, .func = pixel2bgr_888,
+	    .span = pixel2bgr_888_span },
+	[VISUAL_RGB_8_8_8] = { .bpp = 3, .func = pixel2rgb_888,
+	    .span = pixel2rgb_888_span },
+	[VISUAL_BGR_0_8_8_8] = { .bpp = 4, .func = pixel2rgb_0888,
+	    .span = pixel2rgb_0888_span },
+	[VISUAL_BGR_8_8_8_0] = { .bpp = 4, .func = pixel2bgr_8880,
+	    .span = pixel2bgr_8880_span },
+	[VISUAL_ABGR_8_8_8_8] = { .bpp = 4, .func = pixel2abgr_8888,
+	    .span = pixel2abgr_8888_span },
+	[VISUAL_BGRA_8_8_8_8] = { .bpp = 4, .func = pixel2bgra_8888,
+	    .span = pixel2bgra_8888_span },
+	[VISUAL_RGB_0_8_8_8] = { .bpp = 4, .func = pixel2rgb_0888,
+	    .span = pixel2rgb_0888_span },
+	[VISUAL_RGB_8_8_8_0] = { .bpp = 4, .func = pixel2rgb_8880,
+	    .span = pixel2rgb_8880_span },
+	[VISUAL_ARGB_8_8_8_8] = { .bpp = 4, .func = pixel2argb_8888,
+	    .span = pixel2argb_8888_span },
+	[VISUAL_RGBA_8_8_8_8] = { .bpp = 4, .func = pixel2rgba_8888,
+	    .span = pixel2rgba_8888_span },
 };
 
 errno_t amdm37x_dispc_init(amdm37x_dispc_t *instance, ddf_fun_t *fun)
@@ -268,6 +285,7 @@ static errno_t amdm37x_change_mode(amdm37x_dispc_t *dispc, unsigned x,
 	assert((size_t)visual < sizeof(pixel2visual_table) / sizeof(pixel2visual_table[0]));
 	const unsigned bpp = pixel2visual_table[visual].bpp;
 	pixel2visual_t p2v = pixel2visual_table[visual].func;
+	pixel2visual_span_t p2v_span = pixel2visual_table[visual].span;
 	ddf_log_note("Setting mode: %ux%ux%u\n", x, y, bpp * 8);
 	const size_t size = ALIGN_UP(x * y * bpp, PAGE_SIZE);
 	uintptr_t pa;
@@ -288,6 +306,7 @@ static errno_t amdm37x_change_mode(amdm37x_dispc_t *dispc, unsigned x,
 	dispc->active_fb.pitch = 0;
 	dispc->active_fb.bpp = bpp;
 	dispc->active_fb.pixel2visual = p2v;
+	dispc->active_fb.pixel2visual_span = p2v_span;
 	dispc->rect.p0.x = 0;
 	dispc->rect.p0.y = 0;
 	dispc->rect.p1.x = x;
@@ -298,6 +317,9 @@ static errno_t amdm37x_change_mode(amdm37x_dispc_t *dispc, unsigned x,
 	return EOK;
 }
 
+/** Number of pixels converted at once when filling a rectangle */
+#define AMDM37X_FILL_PIXELS 64
+
 #define FB_POS(d, x, y) \
     (((y) * ((d)->active_fb.width + (d)->active_fb.pitch) + (x)) \
     * (d)->active_fb.bpp)
@@ -371,16 +393,23 @@ static errno_t amdm37x_gc_set_color(void *arg, gfx_color_t *color)
 static errno_t amdm37x_gc_fill_rect(void *arg, gfx_rect_t *rect)
 {
 	amdm37x_dispc_t *dispc = (amdm37x_dispc_t *) arg;
+	pixel_t pattern[AMDM37X_FILL_PIXELS];
 	gfx_rect_t crect;
 	gfx_coord_t x, y;
+	gfx_coord_t cnt;
+	size_t i;
 
 	/* Make sure we have a sorted, clipped rectangle */
 	gfx_rect_clip(rect, &dispc->clip_rect, &crect);
 
+	for (i = 0; i < AMDM37X_FILL_PIXELS; i++)
+		pattern[i] = dispc->color;
+
 	for (y = crect.p0.y; y < crect.p1.y; y++) {
-		for (x = crect.p0.x; x < crect.p1.x; x++) {
-			dispc->active_fb.pixel2visual(dispc->fb_data +
-			    FB_POS(dispc, x, y), dispc->color);
+		for (x = crect.p0.x; x < crect.p1.x; x += cnt) {
+			cnt = min(crect.p1.x - x, AMDM37X_FILL_PIXELS);
+			dispc->active_fb.pixel2visual_span(dispc->fb_data +
+			    FB_POS(dispc, x, y), pattern, cnt);
 		}
 	}
 
@@ -475,7 +504,10 @@ static errno_t amdm37x_gc_bitmap_render(void *bm, gfx_rect_t *srect0,
 	gfx_coord2_t dp;
 	gfx_coord2_t pos;
 	pixelmap_t pbm;
-	pixel_t color;
+	pixel_t *src;
+	uint8_t *dst;
+	gfx_coord_t width;
+	gfx_coord_t x, x0, i;
 
 	/* Clip source rectangle to bitmap bounds */
 
@@ -509,44 +541,45 @@ static errno_t amdm37x_gc_bitmap_render(void *bm, gfx_rect_t *srect0,
 	 */
 	gfx_rect_clip(&srect, &skfbrect, &crect);
 
-	if ((dcbm->flags & bmpf_color_key) == 0) {
-		/* Simple copy */
-		for (pos.y = crect.p0.y; pos.y < crect.p1.y; pos.y++) {
-			for (pos.x = crect.p0.x; pos.x < crect.p1.x; pos.x++) {
-				gfx_coord2_subtract(&pos, &dcbm->rect.p0, &sp);
-				gfx_coord2_add(&pos, &offs, &dp);
+	if (gfx_rect_is_empty(&crect))
+		return EOK;
 
-				color = pixelmap_get_pixel(&pbm, sp.x, sp.y);
-				dispc->active_fb.pixel2visual(dispc->fb_data +
-				    FB_POS(dispc, dp.x, dp.y), color);
-			}
+	width = crect.p1.x - crect.p0.x;
+
+	for (pos.y = crect.p0.y; pos.y < crect.p1.y; pos.y++) {
+		pos.x = crect.p0.x;
+		gfx_coord2_subtract(&pos, &dcbm->rect.p0, &sp);
+		gfx_coord2_add(&pos, &offs, &dp);
+
+		src = pixelmap_pixel_at(&pbm, sp.x, sp.y);
+		dst = dispc->fb_data + FB_POS(dispc, dp.x, dp.y);
+
+		if ((dcbm->flags & bmpf_color_key) == 0) {
+			/* Simple copy */
+			dispc->active_fb.pixel2visual_span(dst, src, width);
+			continue;
 		}
-	} else if ((dcbm->flags & bmpf_colorize) == 0) {
-		/* Color key */
-		for (pos.y = crect.p0.y; pos.y < crect.p1.y; pos.y++) {
-			for (pos.x = crect.p0.x; pos.x < crect.p1.x; pos.x++) {
-				gfx_coord2_subtract(&pos, &dcbm->rect.p0, &sp);
-				gfx_coord2_add(&pos, &offs, &dp);
-
-				color = pixelmap_get_pixel(&pbm, sp.x, sp.y);
-				if (color != dcbm->key_color) {
-					dispc->active_fb.pixel2visual(dispc->fb_data +
-					    FB_POS(dispc, dp.x, dp.y), color);
-				}
+
+		/* Color key, convert runs of non-key pixels */
+		x = 0;
+		while (x < width) {
+			if (src[x] == dcbm->key_color) {
+				++x;
+				continue;
 			}
-		}
-	} else {
-		/* Color key & colorize */
-		for (pos.y = crect.p0.y; pos.y < crect.p1.y; pos.y++) {
-			for (pos.x = crect.p0.x; pos.x < crect.p1.x; pos.x++) {
-				gfx_coord2_subtract(&pos, &dcbm->rect.p0, &sp);
-				gfx_coord2_add(&pos, &offs, &dp);
-
-				color = pixelmap_get_pixel(&pbm, sp.x, sp.y);
-				if (color != dcbm->key_color) {
-					dispc->active_fb.pixel2visual(dispc->fb_data +
-					    FB_POS(dispc, dp.x, dp.y),
-					    dcbm->dispc->color);
+
+			x0 = x;
+			while (x < width && src[x] != dcbm->key_color)
+				++x;
+
+			if ((dcbm->flags & bmpf_colorize) == 0) {
+				dispc->active_fb.pixel2visual_span(dst + FB_POS(dispc, x0, 0),
+				    src + x0, x - x0);
+			} else {
+				/* Colorize */
+				for (i = x0; i < x; i++) {
+					dispc->active_fb.pixel2visual(dst + FB_POS(dispc, i, 0),
+					    dispc->color);
 				}
 			}
 		}
@@ -54,6 +54,7 @@ typedef struct {
 
 	struct {
 		pixel2visual_t pixel2visual;
+		pixel2visual_span_t pixel2visual_span;
 		unsigned width;
 		unsigned height;
 		unsigned pitch;
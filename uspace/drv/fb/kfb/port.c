@@ -51,6 +51,7 @@
 #include <gfx/coord.h>
 #include <io/pixelmap.h>
 #include <ipcgfx/server.h>
+#include <macros.h>
 #include <mem.h>
 #include <pixconv.h>
 #include <stddef.h>
@@ -63,6 +64,9 @@
 
 #define FB_POS(fb, x, y)  ((y) * (fb)->scanline + (x) * (fb)->pixel_bytes)
 
+/** Number of pixels converted at once when filling a rectangle */
+#define KFB_FILL_PIXELS  64
+
 typedef struct {
 	ddf_fun_t *fun;
 
@@ -74,6 +78,7 @@ typedef struct {
 	visual_t visual;
 
 	pixel2visual_t pixel2visual;
+	pixel2visual_span_t pixel2visual_span;
 	visual2pixel_t visual2pixel;
 	visual_mask_t visual_mask;
 	size_t pixel_bytes;
@@ -187,16 +192,23 @@ static errno_t kfb_gc_set_color(void *arg, gfx_color_t *color)
 static errno_t kfb_gc_fill_rect(void *arg, gfx_rect_t *rect)
 {
 	kfb_t *kfb = (kfb_t *) arg;
+	pixel_t pattern[KFB_FILL_PIXELS];
 	gfx_rect_t crect;
 	gfx_coord_t x, y;
+	gfx_coord_t cnt;
+	size_t i;
 
 	/* Make sure we have a sorted, clipped rectangle */
 	gfx_rect_clip(rect, &kfb->rect, &crect);
 
+	for (i = 0; i < KFB_FILL_PIXELS; i++)
+		pattern[i] = kfb->color;
+
 	for (y = crect.p0.y; y < crect.p1.y; y++) {
-		for (x = crect.p0.x; x < crect.p1.x; x++) {
-			kfb->pixel2visual(kfb->addr + FB_POS(kfb, x, y),
-			    kfb->color);
+		for (x = crect.p0.x; x < crect.p1.x; x += cnt) {
+			cnt = min(crect.p1.x - x, KFB_FILL_PIXELS);
+			kfb->pixel2visual_span(kfb->addr +
+			    FB_POS(kfb, x, y), pattern, cnt);
 		}
 	}
 
@@ -292,7 +304,10 @@ static errno_t kfb_gc_bitmap_render(void *bm, gfx_rect_t *srect0,
 	gfx_coord2_t dp;
 	gfx_coord2_t pos;
 	pixelmap_t pbm;
-	pixel_t color;
+	pixel_t *src;
+	uint8_t *dst;
+	gfx_coord_t width;
+	gfx_coord_t x, x0, i;
 
 	/* Clip source rectangle to bitmap bounds */
 
@@ -326,42 +341,46 @@ static errno_t kfb_gc_bitmap_render(void *bm, gfx_rect_t *srect0,
 	 */
 	gfx_rect_clip(&srect, &skfbrect, &crect);
 
-	if ((kfbbm->flags & bmpf_color_key) != 0) {
-		/* Simple copy */
-		for (pos.y = crect.p0.y; pos.y < crect.p1.y; pos.y++) {
-			for (pos.x = crect.p0.x; pos.x < crect.p1.x; pos.x++) {
-				gfx_coord2_subtract(&pos, &kfbbm->rect.p0, &sp);
-				gfx_coord2_add(&pos, &offs, &dp);
-
-				color = pixelmap_get_pixel(&pbm, sp.x, sp.y);
-				if (color != kfbbm->key_color) {
-					kfb->pixel2visual(kfb->addr +
-					    FB_POS(kfb, dp.x, dp.y), color);
-				}
-			}
+	if (gfx_rect_is_empty(&crect))
+		return EOK;
+
+	width = crect.p1.x - crect.p0.x;
+
+	for (pos.y = crect.p0.y; pos.y < crect.p1.y; pos.y++) {
+		pos.x = crect.p0.x;
+		gfx_coord2_subtract(&pos, &kfbbm->rect.p0, &sp);
+		gfx_coord2_add(&pos, &offs, &dp);
+
+		src = pixelmap_pixel_at(&pbm, sp.x, sp.y);
+		dst = kfb->addr + FB_POS(kfb, dp.x, dp.y);
+
+		if ((kfbbm->flags & bmpf_color_key) == 0) {
+			/* Simple copy */
+			kfb->pixel2visual_span(dst, src, width);
+			continue;
 		}
-	} else if ((kfbbm->flags & bmpf_colorize) != 0) {
-		/* Color key */
-		for (pos.y = crect.p0.y; pos.y < crect.p1.y; pos.y++) {
-			for (pos.x = crect.p0.x; pos.x < crect.p1.x; pos.x++) {
-				gfx_coord2_subtract(&pos, &kfbbm->rect.p0, &sp);
-				gfx_coord2_add(&pos, &offs, &dp);
-
-				color = pixelmap_get_pixel(&pbm, sp.x, sp.y);
-				kfb->pixel2visual(kfb->addr +
-				    FB_POS(kfb, dp.x, dp.y), color);
+
+		/* Color key, convert runs of non-key pixels */
+		x = 0;
+		while (x < width) {
+			if (src[x] == kfbbm->key_color) {
+				++x;
+				continue;
 			}
-		}
-	} else {
-		/* Color key & colorize */
-		for (pos.y = crect.p0.y; pos.y < crect.p1.y; pos.y++) {
-			for (pos.x = crect.p0.x; pos.x < crect.p1.x; pos.x++) {
-				gfx_coord2_subtract(&pos, &kfbbm->rect.p0, &sp);
-				gfx_coord2_add(&pos, &offs, &dp);
-
-				color = pixelmap_get_pixel(&pbm, sp.x, sp.y);
-				kfb->pixel2visual(kfb->addr +
-				    FB_POS(kfb, dp.x, dp.y), color);
+
+			x0 = x;
+			while (x < width && src[x] != kfbbm->key_color)
+				++x;
+
+			if ((kfbbm->flags & bmpf_colorize) == 0) {
+				kfb->pixel2visual_span(dst + FB_POS(kfb, x0, 0),
+				    src + x0, x - x0);
+			} else {
+				/* Colorize */
+				for (i = x0; i < x; i++) {
+					kfb->pixel2visual(dst + FB_POS(kfb, i, 0),
+					    kfb->color);
+				}
 			}
 		}
 	}
@@ -526,66 +545,77 @@ errno_t port_init(ddf_dev_t *dev)
 	switch (visual) {
 	case VISUAL_INDIRECT_8:
 		kfb->pixel2visual = pixel2bgr_323;
+		kfb->pixel2visual_span = pixel2bgr_323_span;
 		kfb->visual2pixel = bgr_323_2pixel;
 		kfb->visual_mask = visual_mask_323;
 		kfb->pixel_bytes = 1;
 		break;
 	case VISUAL_RGB_5_5_5_LE:
 		kfb->pixel2visual = pixel2rgb_555_le;
+		kfb->pixel2visual_span = pixel2rgb_555_le_span;
 		kfb->visual2pixel = rgb_555_le_2pixel;
 		kfb->visual_mask = visual_mask_555;
 		kfb->pixel_bytes = 2;
 		break;
 	case VISUAL_RGB_5_5_5_BE:
 		kfb->pixel2visual = pixel2rgb_555_be;
+		kfb->pixel2visual_span = pixel2rgb_555_be_span;
 		kfb->visual2pixel = rgb_555_be_2pixel;
 		kfb->visual_mask = visual_mask_555;
 		kfb->pixel_bytes = 2;
 		break;
 	case VISUAL_RGB_5_6_5_LE:
 		kfb->pixel2visual = pixel2rgb_565_le;
+		kfb->pixel2visual_span = pixel2rgb_565_le_span;
 		kfb->visual2pixel = rgb_565_le_2pixel;
 		kfb->visual_mask = visual_mask_565;
 		kfb->pixel_bytes = 2;
 		break;
 	case VISUAL_RGB_5_6_5_BE:
 		kfb->pixel2visual = pixel2rgb_565_be;
+		kfb->pixel2visual_span = pixel2rgb_565_be_span;
 		kfb->visual2pixel = rgb_565_be_2pixel;
 		kfb->visual_mask = visual_mask_565;
 		kfb->pixel_bytes = 2;
 		break;
 	case VISUAL_RGB_8_8_8:
 		kfb->pixel2visual = pixel2rgb_888;
+		kfb->pixel2visual_span = pixel2rgb_888_span;
 		kfb->visual2pixel = rgb_888_2pixel;
 		kfb->visual_mask = visual_mask_888;
 		kfb->pixel_bytes = 3;
 		break;
 	case VISUAL_BGR_8_8_8:
 		kfb->pixel2visual = pixel2bgr_888;
+		kfb->pixel2visual_span = pixel2bgr_888_span;
 		kfb->visual2pixel = bgr_888_2pixel;
 		kfb->visual_mask = visual_mask_888;
 		kfb->pixel_bytes = 3;
 		break;
 	case VISUAL_RGB_8_8_8_0:
 		kfb->pixel2visual = pixel2rgb_8880;
+		kfb->pixel2visual_span = pixel2rgb_8880_span;
 		kfb->visual2pixel = rgb_8880_2pixel;
 		kfb->visual_mask = visual_mask_8880;
 		kfb->pixel_bytes = 4;
 		break;
 	case VISUAL_RGB_0_8_8_8:
 		kfb->pixel2visual = pixel2rgb_0888;
+		kfb->pixel2visual_span = pixel2rgb_0888_span;
 		kfb->visual2pixel = rgb_0888_2pixel;
 		kfb->visual_mask = visual_mask_0888;
 		kfb->pixel_bytes = 4;
 		break;
 	case VISUAL_BGR_0_8_8_8:
 		kfb->pixel2visual = pixel2bgr_0888;
+		kfb->pixel2visual_span = pixel2bgr_0888_span;
 		kfb->visual2pixel = bgr_0888_2pixel;
 		kfb->visual_mask = visual_mask_0888;
 		kfb->pixel_bytes = 4;
 		break;
 	case VISUAL_BGR_8_8_8_0:
 		kfb->pixel2visual = pixel2bgr_8880;
+		kfb->pixel2visual_span = pixel2bgr_8880_span;
 		kfb->visual2pixel = bgr_8880_2pixel;
 		kfb->visual_mask = visual_mask_8880;
 		kfb->pixel_bytes = 4;
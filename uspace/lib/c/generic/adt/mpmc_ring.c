@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libc
+ * @{
+ */
+/** @file Lock-free bounded multi-producer multi-consumer ring
+ *
+ * This is the bounded queue by Dmitry Vyukov. Each cell carries
+ * a sequence number telling which lap of the ring it is ready for.
+ * A producer claims position @c pos by advancing @c tail when the cell
+ * sequence equals @c pos, stores the member and publishes it by setting
+ * the sequence to @c pos + 1. A consumer claims the position by advancing
+ * @c head when the sequence equals @c pos + 1 and releases the cell for
+ * the next lap by setting the sequence to @c pos + nmemb. Producers and
+ * consumers only contend on their own index.
+ */
+
+#include <adt/mpmc_ring.h>
+#include <align.h>
+#include <errno.h>
+#include <mem.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/** Get sequence number of a cell. */
+static atomic_size_t *mpmc_ring_seq(mpmc_ring_t *ring, size_t pos)
+{
+	return (atomic_size_t *) ((char *) ring->cells +
+	    (pos & ring->mask) * ring->cell_size);
+}
+
+/** Get member stored in a cell. */
+static void *mpmc_ring_data(atomic_size_t *seq)
+{
+	return seq + 1;
+}
+
+/** Initialize ring.
+ *
+ * @param ring Ring
+ * @param nmemb Number of members the ring can hold (power of two)
+ * @param size Size of a member
+ * @return EOK on success, EINVAL if @a nmemb is not a power of two,
+ *         ENOMEM if out of memory
+ */
+errno_t mpmc_ring_init(mpmc_ring_t *ring, size_t nmemb, size_t size)
+{
+	if (nmemb == 0 || (nmemb & (nmemb - 1)) != 0)
+		return EINVAL;
+
+	ring->cell_size = ALIGN_UP(sizeof(atomic_size_t) + size,
+	    sizeof(atomic_size_t));
+	ring->cells = malloc(nmemb * ring->cell_size);
+	if (ring->cells == NULL)
+		return ENOMEM;
+
+	ring->mask = nmemb - 1;
+	ring->size = size;
+
+	for (size_t i = 0; i < nmemb; i++)
+		atomic_init(mpmc_ring_seq(ring, i), i);
+
+	atomic_init(&ring->tail, 0);
+	atomic_init(&ring->head, 0);
+	return EOK;
+}
+
+/** Finalize ring.
+ *
+ * @param ring Ring
+ */
+void mpmc_ring_fini(mpmc_ring_t *ring)
+{
+	free(ring->cells);
+	ring->cells = NULL;
+}
+
+/** Push member to ring.
+ *
+ * @param ring Ring
+ * @param data Member to push
+ * @return EOK on success, EAGAIN if the ring is full
+ */
+errno_t mpmc_ring_push(mpmc_ring_t *ring, const void *data)
+{
+	size_t pos = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+	atomic_size_t *seq;
+
+	while (true) {
+		seq = mpmc_ring_seq(ring, pos);
+		size_t s = atomic_load_explicit(seq, memory_order_acquire);
+		intptr_t diff = (intptr_t) (s - pos);
+
+		if (diff == 0) {
+			/* The cell is free, try to claim it. */
+			if (atomic_compare_exchange_weak_explicit(&ring->tail,
+			    &pos, pos + 1, memory_order_relaxed,
+			    memory_order_relaxed))
+				break;
+		} else if (diff < 0) {
+			/* The cell still holds a member from the last lap. */
+			return EAGAIN;
+		} else {
+			/* Another producer claimed the cell. */
+			pos = atomic_load_explicit(&ring->tail,
+			    memory_order_relaxed);
+		}
+	}
+
+	memcpy(mpmc_ring_data(seq), data, ring->size);
+	atomic_store_explicit(seq, pos + 1, memory_order_release);
+	return EOK;
+}
+
+/** Pop member from ring.
+ *
+ * @param ring Ring
+ * @param data Place to store the member
+ * @return EOK on success, EAGAIN if the ring is empty
+ */
+errno_t mpmc_ring_pop(mpmc_ring_t *ring, void *data)
+{
+	size_t pos = atomic_load_explicit(&ring->head, memory_order_relaxed);
+	atomic_size_t *seq;
+
+	while (true) {
+		seq = mpmc_ring_seq(ring, pos);
+		size_t s = atomic_load_explicit(seq, memory_order_acquire);
+		intptr_t diff = (intptr_t) (s - (pos + 1));
+
+		if (diff == 0) {
+			/* The cell holds a member, try to claim it. */
+			if (atomic_compare_exchange_weak_explicit(&ring->head,
+			    &pos, pos + 1, memory_order_relaxed,
+			    memory_order_relaxed))
+				break;
+		} else if (diff < 0) {
+			/* The cell has not been filled yet. */
+			return EAGAIN;
+		} else {
+			/* Another consumer claimed the cell. */
+			pos = atomic_load_explicit(&ring->head,
+			    memory_order_relaxed);
+		}
+	}
+
+	memcpy(data, mpmc_ring_data(seq), ring->size);
+	atomic_store_explicit(seq, pos + ring->mask + 1, memory_order_release);
+	return EOK;
+}
+
+/** @}
+ */
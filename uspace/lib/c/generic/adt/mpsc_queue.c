@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libc
+ * @{
+ */
+/** @file Intrusive lock-free multi-producer single-consumer queue
+ *
+ * This is the intrusive MPSC queue by Dmitry Vyukov. A producer appends
+ * an item by atomically exchanging @c tail and then linking the item
+ * from the previous tail. The consumer follows the links from @c head.
+ * A stub item is reinserted whenever the consumer would take the last
+ * item, so that the queue never becomes truly empty. Between the exchange
+ * and the link store, the items pushed later are not reachable yet,
+ * so mpsc_queue_trypop() can transiently report an empty queue.
+ *
+ * To wait for items, the consumer announces itself in @c waiting before
+ * checking the queue one last time. A producer that finds the flag set
+ * after linking its item clears it and wakes the consumer up. Producers
+ * pushing to a busy consumer thus never touch the semaphore.
+ */
+
+#include <adt/mpsc_queue.h>
+#include <assert.h>
+#include <errno.h>
+#include <fibril_synch.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/** Initialize queue.
+ *
+ * @param q Queue
+ */
+void mpsc_queue_initialize(mpsc_queue_t *q)
+{
+	atomic_init(&q->stub.next, NULL);
+	atomic_init(&q->tail, &q->stub);
+	q->head = &q->stub;
+	atomic_init(&q->waiting, false);
+	fibril_semaphore_initialize(&q->wakeup, 0);
+}
+
+/** Append item to queue.
+ *
+ * @param q Queue
+ * @param link Link of the item
+ */
+static void mpsc_queue_append(mpsc_queue_t *q, mpsc_link_t *link)
+{
+	atomic_store_explicit(&link->next, NULL, memory_order_relaxed);
+	mpsc_link_t *prev = atomic_exchange_explicit(&q->tail, link,
+	    memory_order_acq_rel);
+	atomic_store_explicit(&prev->next, link, memory_order_release);
+}
+
+/** Push item to queue.
+ *
+ * Can be called by any number of threads or fibrils concurrently.
+ *
+ * @param q Queue
+ * @param link Link of the item
+ */
+void mpsc_queue_push(mpsc_queue_t *q, mpsc_link_t *link)
+{
+	mpsc_queue_append(q, link);
+
+	/* Pairs with the fence in mpsc_queue_pop_timeout(). */
+	atomic_thread_fence(memory_order_seq_cst);
+
+	if (atomic_load_explicit(&q->waiting, memory_order_relaxed) &&
+	    atomic_exchange(&q->waiting, false))
+		fibril_semaphore_up(&q->wakeup);
+}
+
+/** Pop item from queue without waiting.
+ *
+ * Must only be called by the consumer. Can return NULL even though
+ * a concurrent push has already started.
+ *
+ * @param q Queue
+ * @return Link of the first item or NULL if there is none
+ */
+mpsc_link_t *mpsc_queue_trypop(mpsc_queue_t *q)
+{
+	mpsc_link_t *head = q->head;
+	mpsc_link_t *next = atomic_load_explicit(&head->next,
+	    memory_order_acquire);
+
+	if (head == &q->stub) {
+		if (next == NULL)
+			return NULL;
+
+		/* Skip the stub. */
+		q->head = next;
+		head = next;
+		next = atomic_load_explicit(&next->next, memory_order_acquire);
+	}
+
+	if (next != NULL) {
+		q->head = next;
+		return head;
+	}
+
+	if (head != atomic_load_explicit(&q->tail, memory_order_acquire)) {
+		/* A push is in progress. */
+		return NULL;
+	}
+
+	/* Put the stub behind the last item so that it can be taken. */
+	mpsc_queue_append(q, &q->stub);
+
+	next = atomic_load_explicit(&head->next, memory_order_acquire);
+	if (next != NULL) {
+		q->head = next;
+		return head;
+	}
+
+	return NULL;
+}
+
+/** Pop item from queue, waiting for it if necessary.
+ *
+ * Must only be called by the consumer.
+ *
+ * @param q Queue
+ * @param timeout Timeout in microseconds (zero means no timeout)
+ * @param rlink Place to store link of the first item
+ * @return EOK on success, ETIMEOUT if no item arrived in time
+ */
+errno_t mpsc_queue_pop_timeout(mpsc_queue_t *q, usec_t timeout,
+    mpsc_link_t **rlink)
+{
+	mpsc_link_t *link;
+	errno_t rc;
+
+	while (true) {
+		link = mpsc_queue_trypop(q);
+		if (link != NULL)
+			break;
+
+		atomic_store(&q->waiting, true);
+
+		/* Pairs with the fence in mpsc_queue_push(). */
+		atomic_thread_fence(memory_order_seq_cst);
+
+		link = mpsc_queue_trypop(q);
+		if (link != NULL) {
+			/* Consume the wakeup if a producer has sent it. */
+			if (!atomic_exchange(&q->waiting, false))
+				fibril_semaphore_down(&q->wakeup);
+			break;
+		}
+
+		rc = fibril_semaphore_down_timeout(&q->wakeup, timeout);
+		if (rc != EOK) {
+			if (!atomic_exchange(&q->waiting, false))
+				fibril_semaphore_down(&q->wakeup);
+
+			link = mpsc_queue_trypop(q);
+			if (link != NULL)
+				break;
+
+			return rc;
+		}
+	}
+
+	*rlink = link;
+	return EOK;
+}
+
+/** Pop item from queue, waiting for it if necessary.
+ *
+ * Must only be called by the consumer.
+ *
+ * @param q Queue
+ * @return Link of the first item
+ */
+mpsc_link_t *mpsc_queue_pop(mpsc_queue_t *q)
+{
+	mpsc_link_t *link;
+	errno_t rc;
+
+	rc = mpsc_queue_pop_timeout(q, 0, &link);
+	assert(rc == EOK);
+	(void) rc;
+
+	return link;
+}
+
+/** @}
+ */
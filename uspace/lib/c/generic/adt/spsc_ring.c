@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libc
+ * @{
+ */
+/** @file Wait-free bounded single-producer single-consumer ring
+ *
+ * The producer only writes @c tail and the consumer only writes @c head.
+ * Each side keeps a private copy of the other side's index and only
+ * reads the shared one when the copy says the ring is full (empty),
+ * so that the cache line of the other side is not touched on every
+ * operation.
+ */
+
+#include <adt/spsc_ring.h>
+#include <errno.h>
+#include <mem.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+/** Initialize ring.
+ *
+ * @param ring Ring
+ * @param nmemb Number of members the ring can hold (power of two)
+ * @param size Size of a member
+ * @return EOK on success, EINVAL if @a nmemb is not a power of two,
+ *         ENOMEM if out of memory
+ */
+errno_t spsc_ring_init(spsc_ring_t *ring, size_t nmemb, size_t size)
+{
+	if (nmemb == 0 || (nmemb & (nmemb - 1)) != 0)
+		return EINVAL;
+
+	ring->buf = malloc(nmemb * size);
+	if (ring->buf == NULL)
+		return ENOMEM;
+
+	ring->mask = nmemb - 1;
+	ring->size = size;
+
+	atomic_init(&ring->tail, 0);
+	ring->head_cache = 0;
+	atomic_init(&ring->head, 0);
+	ring->tail_cache = 0;
+	return EOK;
+}
+
+/** Finalize ring.
+ *
+ * @param ring Ring
+ */
+void spsc_ring_fini(spsc_ring_t *ring)
+{
+	free(ring->buf);
+	ring->buf = NULL;
+}
+
+/** Push member to ring.
+ *
+ * Must only be called by the producer.
+ *
+ * @param ring Ring
+ * @param data Member to push
+ * @return EOK on success, EAGAIN if the ring is full
+ */
+errno_t spsc_ring_push(spsc_ring_t *ring, const void *data)
+{
+	size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+	if (tail - ring->head_cache > ring->mask) {
+		ring->head_cache = atomic_load_explicit(&ring->head,
+		    memory_order_acquire);
+		if (tail - ring->head_cache > ring->mask)
+			return EAGAIN;
+	}
+
+	memcpy((char *) ring->buf + (tail & ring->mask) * ring->size, data,
+	    ring->size);
+	atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+	return EOK;
+}
+
+/** Pop member from ring.
+ *
+ * Must only be called by the consumer.
+ *
+ * @param ring Ring
+ * @param data Place to store the member
+ * @return EOK on success, EAGAIN if the ring is empty
+ */
+errno_t spsc_ring_pop(spsc_ring_t *ring, void *data)
+{
+	size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+
+	if (head == ring->tail_cache) {
+		ring->tail_cache = atomic_load_explicit(&ring->tail,
+		    memory_order_acquire);
+		if (head == ring->tail_cache)
+			return EAGAIN;
+	}
+
+	memcpy(data, (char *) ring->buf + (head & ring->mask) * ring->size,
+	    ring->size);
+	atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+	return EOK;
+}
+
+/** @}
+ */
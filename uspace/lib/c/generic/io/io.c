@@ -37,6 +37,8 @@
 #include <str.h>
 #include <errno.h>
 #include <limits.h>
+#include <macros.h>
+#include <mem.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <async.h>
@@ -51,6 +53,12 @@
 #include "../private/io.h"
 #include "../private/stdio.h"
 
+/** Largest size a stream buffer is enlarged to */
+#define STDIO_BUF_MAX  (64 * 1024)
+
+/** Number of consecutive full buffer transfers before enlarging buffer */
+#define STDIO_BUF_GROW_CNT  2
+
 static void _ffillbuf(FILE *stream);
 static void _fflushbuf(FILE *stream);
 
@@ -270,9 +278,15 @@ int setvbuf(FILE *stream, void *buf, int mode, size_t size)
 	if (mode != _IONBF && mode != _IOLBF && mode != _IOFBF)
 		return -1;
 
+	if (stream->buf_alloc)
+		free(stream->buf);
+
 	stream->btype = mode;
 	stream->buf = buf;
 	stream->buf_size = size;
+	stream->buf_alloc = false;
+	stream->buf_grow = false;
+	stream->buf_full = 0;
 	stream->buf_head = stream->buf;
 	stream->buf_tail = stream->buf;
 	stream->buf_state = _bs_empty;
@@ -308,6 +322,8 @@ static void _setvbuf(FILE *stream)
 		break;
 	default:
 		setvbuf(stream, NULL, _IOFBF, BUFSIZ);
+		/* Start small, grow if the stream turns out to be used for bulk I/O */
+		stream->buf_grow = true;
 	}
 }
 
@@ -324,9 +340,41 @@ static int _fallocbuf(FILE *stream)
 
 	stream->buf_head = stream->buf;
 	stream->buf_tail = stream->buf;
+	stream->buf_alloc = true;
 	return 0;
 }
 
+/** Enlarge stream buffer if it keeps being used in whole.
+ *
+ * Reading or writing a stream sequentially in small pieces costs one
+ * request to the file system per buffer. Doubling the buffer after
+ * a few consecutive full transfers (up to STDIO_BUF_MAX) amortizes that.
+ * The buffer must be empty. If there is not enough memory, the current
+ * buffer is kept.
+ */
+static void _fgrowbuf(FILE *stream)
+{
+	uint8_t *nbuf;
+
+	if (!stream->buf_grow || !stream->buf_alloc ||
+	    stream->buf_full < STDIO_BUF_GROW_CNT ||
+	    stream->buf_size >= STDIO_BUF_MAX)
+		return;
+
+	assert(stream->buf_head == stream->buf_tail);
+	stream->buf_full = 0;
+
+	nbuf = malloc(2 * stream->buf_size);
+	if (nbuf == NULL)
+		return;
+
+	free(stream->buf);
+	stream->buf = nbuf;
+	stream->buf_size *= 2;
+	stream->buf_head = nbuf;
+	stream->buf_tail = nbuf;
+}
+
 /** Open a stream.
  *
  * @param path Path of the file to open.
@@ -389,6 +437,7 @@ FILE *fopen(const char *path, const char *fmode)
 	stream->arg = NULL;
 	stream->sess = NULL;
 	stream->need_sync = false;
+	stream->buf_alloc = false;
 	_setvbuf(stream);
 	stream->ungetc_chars = 0;
 
@@ -414,6 +463,7 @@ FILE *fdopen(int fd, const char *mode)
 	stream->arg = NULL;
 	stream->sess = NULL;
 	stream->need_sync = false;
+	stream->buf_alloc = false;
 	_setvbuf(stream);
 	stream->ungetc_chars = 0;
 
@@ -434,6 +484,12 @@ static int _fclose_nofree(FILE *stream)
 	if (stream->fd >= 0)
 		rc = vfs_put(stream->fd);
 
+	if (stream->buf_alloc) {
+		free(stream->buf);
+		stream->buf = NULL;
+		stream->buf_alloc = false;
+	}
+
 	list_remove(&stream->link);
 
 	if (rc != EOK) {
@@ -531,6 +587,7 @@ static void _ffillbuf(FILE *stream)
 	size_t nread;
 
 	stream->buf_head = stream->buf_tail = stream->buf;
+	_fgrowbuf(stream);
 
 	rc = vfs_read(stream->fd, &stream->pos, stream->buf, stream->buf_size,
 	    &nread);
@@ -545,6 +602,11 @@ static void _ffillbuf(FILE *stream)
 		return;
 	}
 
+	if (nread == stream->buf_size)
+		++stream->buf_full;
+	else
+		stream->buf_full = 0;
+
 	stream->buf_head += nread;
 	stream->buf_state = _bs_read;
 }
@@ -591,7 +653,6 @@ size_t fread(void *dest, size_t size, size_t nmemb, FILE *stream)
 	size_t now;
 	size_t data_avail;
 	size_t total_read;
-	size_t i;
 
 	if (size == 0 || nmemb == 0)
 		return 0;
@@ -624,8 +685,21 @@ size_t fread(void *dest, size_t size, size_t nmemb, FILE *stream)
 	}
 
 	while ((!stream->error) && (!stream->eof) && (bytes_left > 0)) {
-		if (stream->buf_head == stream->buf_tail)
+		if (stream->buf_head == stream->buf_tail) {
+			if (bytes_left >= stream->buf_size) {
+				/*
+				 * Buffering would only add a copy, read directly
+				 * to the destination.
+				 */
+				now = _fread(dp, 1, bytes_left, stream);
+				dp += now;
+				bytes_left -= now;
+				total_read += now;
+				continue;
+			}
+
 			_ffillbuf(stream);
+		}
 
 		if (stream->error || stream->eof) {
 			/* On error errno was set by _ffillbuf() */
@@ -639,9 +713,7 @@ size_t fread(void *dest, size_t size, size_t nmemb, FILE *stream)
 		else
 			now = bytes_left;
 
-		for (i = 0; i < now; i++) {
-			dp[i] = stream->buf_tail[i];
-		}
+		memcpy(dp, stream->buf_tail, now);
 
 		dp += now;
 		stream->buf_tail += now;
@@ -667,8 +739,6 @@ size_t fwrite(const void *buf, size_t size, size_t nmemb, FILE *stream)
 	size_t now;
 	size_t buf_free;
 	size_t total_written;
-	size_t i;
-	uint8_t b;
 	bool need_flush;
 
 	if (size == 0 || nmemb == 0)
@@ -697,19 +767,34 @@ size_t fwrite(const void *buf, size_t size, size_t nmemb, FILE *stream)
 	need_flush = false;
 
 	while ((!stream->error) && (bytes_left > 0)) {
+		if (stream->buf_head == stream->buf &&
+		    bytes_left >= stream->buf_size) {
+			/* Buffer is empty and would not help, write directly. */
+			now = _fwrite(data, 1, bytes_left, stream);
+			if (now == 0)
+				break;
+
+			/* The data are written out, but the stream needs sync */
+			if ((stream->btype == _IOLBF) &&
+			    (memchr(data, '\n', now) != NULL))
+				need_flush = true;
+
+			data += now;
+			bytes_left -= now;
+			total_written += now;
+			continue;
+		}
+
 		buf_free = stream->buf_size - (stream->buf_head - stream->buf);
 		if (bytes_left > buf_free)
 			now = buf_free;
 		else
 			now = bytes_left;
 
-		for (i = 0; i < now; i++) {
-			b = data[i];
-			stream->buf_head[i] = b;
+		memcpy(stream->buf_head, data, now);
 
-			if ((b == '\n') && (stream->btype == _IOLBF))
-				need_flush = true;
-		}
+		if ((stream->btype == _IOLBF) && (memchr(data, '\n', now) != NULL))
+			need_flush = true;
 
 		data += now;
 		stream->buf_head += now;
@@ -721,8 +806,11 @@ size_t fwrite(const void *buf, size_t size, size_t nmemb, FILE *stream)
 		if (buf_free == 0) {
 			/* Only need to drain buffer. */
 			_fflushbuf(stream);
-			if (!stream->error)
+			if (!stream->error) {
 				need_flush = false;
+				++stream->buf_full;
+				_fgrowbuf(stream);
+			}
 		}
 	}
 
@@ -822,24 +910,72 @@ int fgetc(FILE *stream)
 	if (fread(&c, sizeof(char), 1, stream) < sizeof(char))
 		return EOF;
 
-	return (int) c;
+	return (int) (uint8_t) c;
 }
 
-char *fgets(char *str, int size, FILE *stream)
+/** Read characters up to delimiter.
+ *
+ * Takes as much as possible directly from the stream buffer, scanning
+ * it for the delimiter. If the buffer is empty, reads one character
+ * with fgetc(), which refills it.
+ *
+ * @param stream Stream
+ * @param dest Destination buffer
+ * @param size Maximum number of characters to read (at least one)
+ * @param delim Delimiter character
+ * @param found Place to store @c true iff the delimiter was read (it is
+ *              stored as the last character)
+ * @return Number of characters read, zero on end of file or error
+ */
+static size_t _fgetdelim(FILE *stream, char *dest, size_t size, int delim,
+    bool *found)
 {
+	uint8_t *end;
+	size_t now;
 	int c;
-	int idx;
 
-	idx = 0;
-	while (idx < size - 1) {
-		c = fgetc(stream);
-		if (c == EOF)
-			break;
+	assert(size > 0);
 
-		str[idx++] = c;
+	if (stream->ungetc_chars == 0 && stream->buf_state == _bs_read &&
+	    stream->buf_head != stream->buf_tail) {
+		now = min((size_t) (stream->buf_head - stream->buf_tail), size);
+		end = memchr(stream->buf_tail, delim, now);
+		if (end != NULL)
+			now = end - stream->buf_tail + 1;
 
-		if (c == '\n')
+		memcpy(dest, stream->buf_tail, now);
+		stream->buf_tail += now;
+		*found = (end != NULL);
+		return now;
+	}
+
+	c = fgetc(stream);
+	if (c == EOF)
+		return 0;
+
+	dest[0] = c;
+	*found = (c == (uint8_t) delim);
+	return 1;
+}
+
+char *fgets(char *str, int size, FILE *stream)
+{
+	size_t idx;
+	size_t now;
+	bool found;
+
+	if (size <= 1)
+		return NULL;
+
+	idx = 0;
+	found = false;
+	while (idx < (size_t) size - 1 && !found) {
+		now = _fgetdelim(stream, str + idx, size - 1 - idx, '\n',
+		    &found);
+		if (now == 0)
 			break;
+
+		idx += now;
 	}
 
 	if (ferror(stream))
@@ -852,6 +988,79 @@ char *fgets(char *str, int size, FILE *stream)
 	return str;
 }
 
+/** Read stream up to and including a delimiter.
+ *
+ * @param lineptr Pointer to a buffer allocated with malloc() or to
+ *                @c NULL. The buffer is enlarged as needed.
+ * @param n Pointer to the size of @a *lineptr
+ * @param delim Delimiter character
+ * @param stream Stream
+ * @return Number of characters read (including the delimiter, not including
+ *         the terminating null character) or -1 on end of file or error
+ *         (errno is set).
+ */
+ssize_t getdelim(char **lineptr, size_t *n, int delim, FILE *stream)
+{
+	size_t cnt;
+	size_t nsize;
+	size_t now;
+	char *nline;
+	bool found;
+
+	if (lineptr == NULL || n == NULL) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (*lineptr == NULL)
+		*n = 0;
+
+	cnt = 0;
+	found = false;
+	while (!found) {
+		/* Keep room for at least one more character and terminator */
+		if (*n < cnt + 2) {
+			nsize = max(2 * *n, (size_t) 128);
+			nline = realloc(*lineptr, nsize);
+			if (nline == NULL) {
+				errno = ENOMEM;
+				return -1;
+			}
+
+			*lineptr = nline;
+			*n = nsize;
+		}
+
+		now = _fgetdelim(stream, *lineptr + cnt, *n - cnt - 1, delim,
+		    &found);
+		if (now == 0)
+			break;
+
+		cnt += now;
+	}
+
+	if (ferror(stream) || cnt == 0)
+		return -1;
+
+	(*lineptr)[cnt] = '\0';
+	return cnt;
+}
+
+/** Read line from stream.
+ *
+ * @param lineptr Pointer to a buffer allocated with malloc() or to
+ *                @c NULL. The buffer is enlarged as needed.
+ * @param n Pointer to the size of @a *lineptr
+ * @param stream Stream
+ * @return Number of characters read (including the newline, not including
+ *         the terminating null character) or -1 on end of file or error
+ *         (errno is set).
+ */
+ssize_t getline(char **lineptr, size_t *n, FILE *stream)
+{
+	return getdelim(lineptr, n, '\n', stream);
+}
+
 int getchar(void)
 {
 	return fgetc(stdin);
@@ -886,6 +1095,7 @@ int fseek64(FILE *stream, off64_t offset, int whence)
 	}
 
 	stream->ungetc_chars = 0;
+	stream->buf_full = 0;
 
 	vfs_stat_t st;
 	switch (whence) {
@@ -952,6 +1162,9 @@ int fflush(FILE *stream)
 	if (stream->error)
 		return EOF;
 
+	/* Explicit flushes mean the stream is not used for bulk writes */
+	stream->buf_full = 0;
+
 	_fflushbuf(stream);
 	if (stream->error) {
 		/* errno was set by _fflushbuf() */
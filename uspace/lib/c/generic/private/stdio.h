@@ -38,6 +38,7 @@
 #include <adt/list.h>
 #include <stdio.h>
 #include <async.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <offset.h>
 
@@ -106,6 +107,15 @@ struct _IO_FILE {
 	/** Buffer size */
 	size_t buf_size;
 
+	/** Buffer was allocated by the library and is freed on close */
+	bool buf_alloc;
+
+	/** Buffer can be enlarged when the stream is used sequentially */
+	bool buf_grow;
+
+	/** Number of consecutive transfers that used the whole buffer */
+	unsigned buf_full;
+
 	/** Buffer state */
 	enum __buffer_state buf_state;
 
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libc
+ * @{
+ */
+/** @file Lock-free bounded multi-producer multi-consumer ring
+ */
+
+#ifndef _LIBC_ADT_MPMC_RING_H_
+#define _LIBC_ADT_MPMC_RING_H_
+
+#include <errno.h>
+#include <stdatomic.h>
+#include <stddef.h>
+
+/** Lock-free bounded multi-producer multi-consumer ring buffer.
+ *
+ * Any number of threads and fibrils can push and pop concurrently.
+ * The operations never block, they fail with EAGAIN if the ring is full
+ * or empty, respectively.
+ */
+typedef struct {
+	/** Cells, each a sequence number followed by a member */
+	void *cells;
+	/** Number of cells minus one */
+	size_t mask;
+	/** Member size */
+	size_t size;
+	/** Cell size */
+	size_t cell_size;
+	/** Keep producers and consumers off each other's cache line */
+	char pad0[64];
+	/** Position of the next push */
+	atomic_size_t tail;
+	char pad1[64 - sizeof(atomic_size_t)];
+	/** Position of the next pop */
+	atomic_size_t head;
+	char pad2[64 - sizeof(atomic_size_t)];
+} mpmc_ring_t;
+
+extern errno_t mpmc_ring_init(mpmc_ring_t *, size_t, size_t);
+extern void mpmc_ring_fini(mpmc_ring_t *);
+extern errno_t mpmc_ring_push(mpmc_ring_t *, const void *);
+extern errno_t mpmc_ring_pop(mpmc_ring_t *, void *);
+
+#endif
+
+/** @}
+ */
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libc
+ * @{
+ */
+/** @file Intrusive lock-free multi-producer single-consumer queue
+ */
+
+#ifndef _LIBC_ADT_MPSC_QUEUE_H_
+#define _LIBC_ADT_MPSC_QUEUE_H_
+
+#include <fibril_synch.h>
+#include <member.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+
+/** Link of an item in an MPSC queue */
+typedef struct mpsc_link {
+	_Atomic(struct mpsc_link *) next;
+} mpsc_link_t;
+
+/** Intrusive lock-free multi-producer single-consumer FIFO queue.
+ *
+ * Any number of threads and fibrils can push items while a single
+ * fibril pops them. Pushing never blocks. The consumer can wait for
+ * items, the producers only wake it up if it actually waits.
+ */
+typedef struct {
+	/** Last item (producers) */
+	_Atomic(mpsc_link_t *) tail;
+	char pad0[64 - sizeof(mpsc_link_t *)];
+	/** First item (consumer) */
+	mpsc_link_t *head;
+	/** Stub item, in the queue whenever the queue would be empty */
+	mpsc_link_t stub;
+	/** The consumer is about to wait for an item */
+	atomic_bool waiting;
+	/** Wakes up the consumer */
+	fibril_semaphore_t wakeup;
+} mpsc_queue_t;
+
+#define mpsc_queue_get_instance(link, type, member) \
+	member_to_inst(link, type, member)
+
+extern void mpsc_queue_initialize(mpsc_queue_t *);
+extern void mpsc_queue_push(mpsc_queue_t *, mpsc_link_t *);
+extern mpsc_link_t *mpsc_queue_trypop(mpsc_queue_t *);
+extern mpsc_link_t *mpsc_queue_pop(mpsc_queue_t *);
+extern errno_t mpsc_queue_pop_timeout(mpsc_queue_t *, usec_t, mpsc_link_t **);
+
+#endif
+
+/** @}
+ */
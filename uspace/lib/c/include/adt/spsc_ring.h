@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libc
+ * @{
+ */
+/** @file Wait-free bounded single-producer single-consumer ring
+ */
+
+#ifndef _LIBC_ADT_SPSC_RING_H_
+#define _LIBC_ADT_SPSC_RING_H_
+
+#include <errno.h>
+#include <stdatomic.h>
+#include <stddef.h>
+
+/** Wait-free bounded single-producer single-consumer ring buffer.
+ *
+ * One thread or fibril can push while another one pops. Neither side
+ * ever waits for the other, push fails with EAGAIN if the ring is full
+ * and pop if it is empty.
+ */
+typedef struct {
+	/** Buffer */
+	void *buf;
+	/** Number of buffer members minus one */
+	size_t mask;
+	/** Member size */
+	size_t size;
+	/** Keep producer and consumer fields off each other's cache line */
+	char pad0[64];
+	/** Position of the next push (written by the producer) */
+	atomic_size_t tail;
+	/** Producer's copy of @c head */
+	size_t head_cache;
+	char pad1[64 - sizeof(atomic_size_t) - sizeof(size_t)];
+	/** Position of the next pop (written by the consumer) */
+	atomic_size_t head;
+	/** Consumer's copy of @c tail */
+	size_t tail_cache;
+	char pad2[64 - sizeof(atomic_size_t) - sizeof(size_t)];
+} spsc_ring_t;
+
+extern errno_t spsc_ring_init(spsc_ring_t *, size_t, size_t);
+extern void spsc_ring_fini(spsc_ring_t *);
+extern errno_t spsc_ring_push(spsc_ring_t *, const void *);
+extern errno_t spsc_ring_pop(spsc_ring_t *, void *);
+
+#endif
+
+/** @}
+ */
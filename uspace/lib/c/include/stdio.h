@@ -194,6 +194,7 @@ __C_DECLS_END;
 #ifdef _HELENOS_SOURCE
 
 #include <_bits/off64_t.h>
+#include <_bits/ssize_t.h>
 
 __HELENOS_DECLS_BEGIN;
 
@@ -217,6 +218,9 @@ extern int fileno(FILE *);
 extern int fseek64(FILE *, off64_t, int);
 extern off64_t ftell64(FILE *);
 
+extern ssize_t getdelim(char **, size_t *, int, FILE *);
+extern ssize_t getline(char **, size_t *, FILE *);
+
 __HELENOS_DECLS_END;
 #endif
 
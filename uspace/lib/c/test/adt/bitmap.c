@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <adt/bitmap.h>
+#include <pcut/pcut.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(bitmap);
+
+enum {
+	/** Number of bits in the large test bitmap */
+	large_elements = 100000
+};
+
+static unsigned long storage[large_elements / 32 + 64];
+
+/** Setting and clearing ranges */
+PCUT_TEST(set_clear_range)
+{
+	bitmap_t bitmap;
+	size_t i;
+
+	bitmap_initialize(&bitmap, 300, storage);
+	bitmap_clear_range(&bitmap, 0, 300);
+
+	bitmap_set_range(&bitmap, 3, 5);
+	bitmap_set_range(&bitmap, 60, 150);
+	bitmap_clear_range(&bitmap, 100, 9);
+
+	for (i = 0; i < 300; i++) {
+		bool set = (i >= 3 && i < 8) || (i >= 60 && i < 100) ||
+		    (i >= 109 && i < 210);
+		PCUT_ASSERT_INT_EQUALS(set ? 1 : 0, bitmap_get(&bitmap, i));
+	}
+}
+
+/** First range of free bits is allocated */
+PCUT_TEST(allocate_first_fit)
+{
+	bitmap_t bitmap;
+	size_t index;
+	bool found;
+
+	bitmap_initialize(&bitmap, 300, storage);
+	bitmap_set_range(&bitmap, 0, 300);
+	bitmap_clear_range(&bitmap, 70, 3);
+	bitmap_clear_range(&bitmap, 130, 70);
+	bitmap.next_fit = 0;
+
+	found = bitmap_allocate_range(&bitmap, 4, 0, 0, 0, NULL);
+	PCUT_ASSERT_TRUE(found);
+	PCUT_ASSERT_INT_EQUALS(0, bitmap_get(&bitmap, 130));
+
+	found = bitmap_allocate_range(&bitmap, 3, 0, 0, 0, &index);
+	PCUT_ASSERT_TRUE(found);
+	PCUT_ASSERT_INT_EQUALS(70, index);
+
+	found = bitmap_allocate_range(&bitmap, 64, 0, 0, 0, &index);
+	PCUT_ASSERT_TRUE(found);
+	PCUT_ASSERT_INT_EQUALS(130, index);
+	PCUT_ASSERT_INT_EQUALS(1, bitmap_get(&bitmap, 193));
+	PCUT_ASSERT_INT_EQUALS(0, bitmap_get(&bitmap, 194));
+
+	found = bitmap_allocate_range(&bitmap, 7, 0, 0, 0, &index);
+	PCUT_ASSERT_FALSE(found);
+}
+
+/** Allocation respects the alignment constraint */
+PCUT_TEST(allocate_constraint)
+{
+	bitmap_t bitmap;
+	size_t index;
+	bool found;
+
+	bitmap_initialize(&bitmap, 1000, storage);
+	bitmap_clear_range(&bitmap, 0, 1000);
+	bitmap_set_range(&bitmap, 0, 5);
+
+	/* Address base + index must be a multiple of 256 */
+	found = bitmap_allocate_range(&bitmap, 16, 200, 0, 255, &index);
+	PCUT_ASSERT_TRUE(found);
+	PCUT_ASSERT_INT_EQUALS(56, index);
+
+	found = bitmap_allocate_range(&bitmap, 16, 200, 0, 255, &index);
+	PCUT_ASSERT_TRUE(found);
+	PCUT_ASSERT_INT_EQUALS(312, index);
+
+	/* No multiple of 2048 within the bitmap */
+	found = bitmap_allocate_range(&bitmap, 1, 200, 0, 2047, &index);
+	PCUT_ASSERT_FALSE(found);
+}
+
+/** Search wraps around from the next-fit position */
+PCUT_TEST(allocate_wrap)
+{
+	bitmap_t bitmap;
+	size_t index;
+	bool found;
+
+	bitmap_initialize(&bitmap, 203, storage);
+	bitmap_clear_range(&bitmap, 0, 203);
+
+	found = bitmap_allocate_range(&bitmap, 200, 0, 0, 0, &index);
+	PCUT_ASSERT_TRUE(found);
+	PCUT_ASSERT_INT_EQUALS(0, index);
+
+	/* Bits beyond the end of the bitmap are never free */
+	found = bitmap_allocate_range(&bitmap, 4, 0, 0, 0, &index);
+	PCUT_ASSERT_FALSE(found);
+
+	found = bitmap_allocate_range(&bitmap, 3, 0, 0, 0, &index);
+	PCUT_ASSERT_TRUE(found);
+	PCUT_ASSERT_INT_EQUALS(200, index);
+
+	bitmap_clear_range(&bitmap, 10, 5);
+	bitmap_clear_range(&bitmap, 150, 5);
+	bitmap.next_fit = 100 / BITMAP_ELEMENT;
+
+	found = bitmap_allocate_range(&bitmap, 5, 0, 0, 0, &index);
+	PCUT_ASSERT_TRUE(found);
+	PCUT_ASSERT_INT_EQUALS(150, index);
+
+	found = bitmap_allocate_range(&bitmap, 5, 0, 0, 0, &index);
+	PCUT_ASSERT_TRUE(found);
+	PCUT_ASSERT_INT_EQUALS(10, index);
+}
+
+/** Bitmap with second level bitmap */
+PCUT_TEST(summary)
+{
+	bitmap_t bitmap;
+	size_t index;
+	size_t i;
+	bool found;
+
+	PCUT_ASSERT_TRUE(bitmap_size_summary(large_elements) <=
+	    sizeof(storage));
+
+	bitmap_initialize_summary(&bitmap, large_elements, storage);
+	bitmap_set_range(&bitmap, 0, large_elements);
+
+	found = bitmap_allocate_range(&bitmap, 1, 0, 0, 0, &index);
+	PCUT_ASSERT_FALSE(found);
+
+	/* Single free bits far apart */
+	bitmap_set(&bitmap, 77777, 0);
+	bitmap_set(&bitmap, large_elements - 1, 0);
+	bitmap.next_fit = 0;
+
+	found = bitmap_allocate_range(&bitmap, 1, 0, 0, 0, &index);
+	PCUT_ASSERT_TRUE(found);
+	PCUT_ASSERT_INT_EQUALS(77777, index);
+
+	found = bitmap_allocate_range(&bitmap, 1, 0, 0, 0, &index);
+	PCUT_ASSERT_TRUE(found);
+	PCUT_ASSERT_INT_EQUALS(large_elements - 1, index);
+
+	found = bitmap_allocate_range(&bitmap, 1, 0, 0, 0, &index);
+	PCUT_ASSERT_FALSE(found);
+
+	/* Fill a cleared range again bit by bit */
+	bitmap_clear_range(&bitmap, 5000, 1000);
+	for (i = 0; i < 1000; i++) {
+		found = bitmap_allocate_range(&bitmap, 1, 0, 0, 0, &index);
+		PCUT_ASSERT_TRUE(found);
+		PCUT_ASSERT_INT_EQUALS(5000 + i, index);
+	}
+
+	found = bitmap_allocate_range(&bitmap, 1, 0, 0, 0, &index);
+	PCUT_ASSERT_FALSE(found);
+}
+
+PCUT_EXPORT(bitmap);
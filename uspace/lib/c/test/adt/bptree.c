@@ -0,0 +1,458 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <adt/bptree.h>
+#include <pcut/pcut.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <str.h>
+
+/** Test entry */
+typedef struct {
+	int key;
+	char name[8];
+} test_entry_t;
+
+enum {
+	/** Length of test number sequences */
+	test_seq_len = 1000,
+	/** Number of operations in the random test */
+	test_rand_ops = 20000
+};
+
+/** Test get key function.
+ *
+ * @param item Test entry
+ * @return Pointer to key
+ */
+static void *test_getkey(void *item)
+{
+	return &((test_entry_t *) item)->key;
+}
+
+/** Test compare function.
+ *
+ * @param a First key
+ * @param b Second key
+ * @return <0, 0, >0 if @a a is less than, equal or greater than @a b
+ */
+static int test_cmp(const void *a, const void *b)
+{
+	const int *ia = (const int *)a;
+	const int *ib = (const int *)b;
+
+	return *ia - *ib;
+}
+
+/** Test get string key function. */
+static void *test_getname(void *item)
+{
+	return ((test_entry_t *) item)->name;
+}
+
+/** Test string compare function. */
+static int test_strcmp(const void *a, const void *b)
+{
+	return str_cmp((const char *) a, (const char *) b);
+}
+
+/** Test entry with separately allocated string key */
+typedef struct {
+	char *name;
+} test_sentry_t;
+
+/** Test get separately allocated string key function. */
+static void *test_getsname(void *item)
+{
+	return ((test_sentry_t *) item)->name;
+}
+
+/** Walk tree in both directions, checking keys are 0, 1, ..., cnt - 1. */
+static void test_walk(bptree_t *tree, int cnt)
+{
+	bptree_iter_t iter;
+	test_entry_t *e;
+	int i;
+
+	i = 0;
+	e = bptree_first(tree, &iter);
+	while (e != NULL) {
+		PCUT_ASSERT_INT_EQUALS(i, e->key);
+		e = bptree_next(&iter);
+		++i;
+	}
+	PCUT_ASSERT_INT_EQUALS(cnt, i);
+
+	e = bptree_last(tree, &iter);
+	while (e != NULL) {
+		--i;
+		PCUT_ASSERT_INT_EQUALS(i, e->key);
+		e = bptree_prev(&iter);
+	}
+	PCUT_ASSERT_INT_EQUALS(0, i);
+}
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(bptree);
+
+/** Increasing and decreasing sequence test.
+ *
+ * Test insertion of increasing and decreasing sequences, walking
+ * and removal.
+ */
+PCUT_TEST(seq)
+{
+	bptree_t tree;
+	test_entry_t *e;
+	int i;
+
+	e = calloc(test_seq_len, sizeof(test_entry_t));
+	PCUT_ASSERT_NOT_NULL(e);
+
+	bptree_initialize(&tree, sizeof(int), test_getkey, test_cmp);
+	PCUT_ASSERT_TRUE(bptree_empty(&tree));
+	PCUT_ASSERT_NULL(bptree_first(&tree, NULL));
+	PCUT_ASSERT_NULL(bptree_last(&tree, NULL));
+
+	for (i = 0; i < test_seq_len; i++) {
+		e[i].key = i;
+		PCUT_ASSERT_ERRNO_VAL(EOK, bptree_insert(&tree, &e[i]));
+		PCUT_ASSERT_ERRNO_VAL(EOK, bptree_validate(&tree));
+	}
+
+	PCUT_ASSERT_INT_EQUALS(test_seq_len, bptree_count(&tree));
+	test_walk(&tree, test_seq_len);
+
+	for (i = 0; i < test_seq_len; i++) {
+		bptree_remove(&tree, &e[i]);
+		PCUT_ASSERT_ERRNO_VAL(EOK, bptree_validate(&tree));
+	}
+
+	PCUT_ASSERT_TRUE(bptree_empty(&tree));
+
+	for (i = test_seq_len - 1; i >= 0; i--) {
+		PCUT_ASSERT_ERRNO_VAL(EOK, bptree_insert(&tree, &e[i]));
+		PCUT_ASSERT_ERRNO_VAL(EOK, bptree_validate(&tree));
+	}
+
+	test_walk(&tree, test_seq_len);
+
+	for (i = test_seq_len - 1; i >= 0; i--) {
+		bptree_remove(&tree, &e[i]);
+		PCUT_ASSERT_ERRNO_VAL(EOK, bptree_validate(&tree));
+	}
+
+	PCUT_ASSERT_TRUE(bptree_empty(&tree));
+	bptree_finalize(&tree);
+	free(e);
+}
+
+/** Random test.
+ *
+ * Randomly insert and remove entries with many duplicate keys and
+ * compare with a simple model.
+ */
+PCUT_TEST(random)
+{
+	bptree_t tree;
+	bptree_iter_t iter;
+	test_entry_t *e;
+	test_entry_t *f;
+	bool *in;
+	bool eq;
+	int cnt;
+	int key;
+	int lt, gt;
+	int i, j;
+
+	e = calloc(test_seq_len, sizeof(test_entry_t));
+	PCUT_ASSERT_NOT_NULL(e);
+	in = calloc(test_seq_len, sizeof(bool));
+	PCUT_ASSERT_NOT_NULL(in);
+
+	bptree_initialize(&tree, sizeof(int), test_getkey, test_cmp);
+
+	srand(1);
+	cnt = 0;
+	for (i = 0; i < test_rand_ops; i++) {
+		j = rand() % test_seq_len;
+		if (in[j]) {
+			bptree_remove(&tree, &e[j]);
+			in[j] = false;
+			--cnt;
+		} else {
+			e[j].key = rand() % (test_seq_len / 4);
+			PCUT_ASSERT_ERRNO_VAL(EOK, bptree_insert(&tree, &e[j]));
+			in[j] = true;
+			++cnt;
+		}
+
+		if (i % 64 == 0)
+			PCUT_ASSERT_ERRNO_VAL(EOK, bptree_validate(&tree));
+	}
+
+	PCUT_ASSERT_ERRNO_VAL(EOK, bptree_validate(&tree));
+	PCUT_ASSERT_INT_EQUALS(cnt, bptree_count(&tree));
+
+	/* Every entry in the tree is reachable through its key */
+	for (j = 0; j < test_seq_len; j++) {
+		if (!in[j])
+			continue;
+
+		f = bptree_find_eq(&tree, &e[j].key, &iter);
+		PCUT_ASSERT_NOT_NULL(f);
+		while (f != &e[j]) {
+			PCUT_ASSERT_NOT_NULL(f);
+			PCUT_ASSERT_INT_EQUALS(e[j].key, f->key);
+			f = bptree_next(&iter);
+		}
+	}
+
+	/* Bounds agree with the model */
+	for (key = -1; key <= test_seq_len / 4; key++) {
+		lt = -1;
+		gt = -1;
+		eq = false;
+		for (j = 0; j < test_seq_len; j++) {
+			if (!in[j])
+				continue;
+			if (e[j].key < key && e[j].key > lt)
+				lt = e[j].key;
+			if (e[j].key > key && (gt < 0 || e[j].key < gt))
+				gt = e[j].key;
+			if (e[j].key == key)
+				eq = true;
+		}
+
+		f = bptree_find_lt(&tree, &key, NULL);
+		PCUT_ASSERT_INT_EQUALS(lt, f != NULL ? f->key : -1);
+		f = bptree_find_gt(&tree, &key, NULL);
+		PCUT_ASSERT_INT_EQUALS(gt, f != NULL ? f->key : -1);
+		f = bptree_find_leq(&tree, &key, NULL);
+		PCUT_ASSERT_INT_EQUALS(eq ? key : lt, f != NULL ? f->key : -1);
+		f = bptree_find_geq(&tree, &key, NULL);
+		PCUT_ASSERT_INT_EQUALS(eq ? key : gt, f != NULL ? f->key : -1);
+		f = bptree_find_eq(&tree, &key, NULL);
+		PCUT_ASSERT_EQUALS(eq, f != NULL);
+	}
+
+	bptree_finalize(&tree);
+	free(in);
+	free(e);
+}
+
+/** Duplicate keys keep the order of insertion. */
+PCUT_TEST(dup_order)
+{
+	bptree_t tree;
+	bptree_iter_t iter;
+	test_entry_t *e;
+	test_entry_t *f;
+	int key = 1;
+	int i;
+
+	e = calloc(test_seq_len, sizeof(test_entry_t));
+	PCUT_ASSERT_NOT_NULL(e);
+
+	bptree_initialize(&tree, sizeof(int), test_getkey, test_cmp);
+
+	for (i = 0; i < test_seq_len; i++) {
+		e[i].key = i % 3;
+		PCUT_ASSERT_ERRNO_VAL(EOK, bptree_insert(&tree, &e[i]));
+	}
+
+	PCUT_ASSERT_ERRNO_VAL(EOK, bptree_validate(&tree));
+
+	i = 1;
+	f = bptree_find_eq(&tree, &key, &iter);
+	while (f != NULL && f->key == key) {
+		PCUT_ASSERT_EQUALS(&e[i], f);
+		f = bptree_next(&iter);
+		i += 3;
+	}
+
+	PCUT_ASSERT_TRUE(i >= test_seq_len);
+
+	bptree_finalize(&tree);
+	free(e);
+}
+
+/** Bulk load test. */
+PCUT_TEST(bulk_load)
+{
+	bptree_t tree;
+	test_entry_t *e;
+	void **items;
+	int cnt;
+	int i;
+
+	e = calloc(test_seq_len, sizeof(test_entry_t));
+	PCUT_ASSERT_NOT_NULL(e);
+	items = calloc(test_seq_len, sizeof(void *));
+	PCUT_ASSERT_NOT_NULL(items);
+
+	for (i = 0; i < test_seq_len; i++) {
+		e[i].key = i;
+		items[i] = &e[i];
+	}
+
+	bptree_initialize(&tree, sizeof(int), test_getkey, test_cmp);
+
+	for (cnt = 0; cnt <= test_seq_len; cnt += cnt < 40 ? 1 : 97) {
+		PCUT_ASSERT_ERRNO_VAL(EOK, bptree_bulk_load(&tree, items, cnt));
+		PCUT_ASSERT_ERRNO_VAL(EOK, bptree_validate(&tree));
+		PCUT_ASSERT_INT_EQUALS(cnt, bptree_count(&tree));
+		test_walk(&tree, cnt);
+
+		/* The tree must stay usable after bulk load */
+		for (i = 0; i < cnt; i += 2) {
+			bptree_remove(&tree, &e[i]);
+			PCUT_ASSERT_ERRNO_VAL(EOK, bptree_validate(&tree));
+		}
+
+		for (i = 0; i < cnt; i += 2) {
+			PCUT_ASSERT_ERRNO_VAL(EOK, bptree_insert(&tree, &e[i]));
+			PCUT_ASSERT_ERRNO_VAL(EOK, bptree_validate(&tree));
+		}
+
+		test_walk(&tree, cnt);
+		bptree_finalize(&tree);
+	}
+
+	free(items);
+	free(e);
+}
+
+/** Keys stored by reference.
+ *
+ * Test a tree with string keys that cannot be copied into the nodes.
+ */
+PCUT_TEST(ref_keys)
+{
+	bptree_t tree;
+	bptree_iter_t iter;
+	test_entry_t *e;
+	test_entry_t *f;
+	char name[8];
+	int i;
+
+	e = calloc(test_seq_len, sizeof(test_entry_t));
+	PCUT_ASSERT_NOT_NULL(e);
+
+	bptree_initialize(&tree, 0, test_getname, test_strcmp);
+
+	for (i = 0; i < test_seq_len; i++) {
+		e[i].key = i;
+		snprintf(e[i].name, sizeof(e[i].name), "%04d", (i * 7) %
+		    test_seq_len);
+		PCUT_ASSERT_ERRNO_VAL(EOK, bptree_insert(&tree, &e[i]));
+	}
+
+	PCUT_ASSERT_ERRNO_VAL(EOK, bptree_validate(&tree));
+
+	snprintf(name, sizeof(name), "%04d", 500);
+	f = bptree_find_eq(&tree, name, &iter);
+	PCUT_ASSERT_NOT_NULL(f);
+	PCUT_ASSERT_STR_EQUALS("0500", f->name);
+	f = bptree_next(&iter);
+	PCUT_ASSERT_NOT_NULL(f);
+	PCUT_ASSERT_STR_EQUALS("0501", f->name);
+
+	f = bptree_find_lt(&tree, "0000", NULL);
+	PCUT_ASSERT_NULL(f);
+	f = bptree_find_gt(&tree, "0998", NULL);
+	PCUT_ASSERT_NOT_NULL(f);
+	PCUT_ASSERT_STR_EQUALS("0999", f->name);
+
+	for (i = 0; i < test_seq_len; i++)
+		bptree_remove(&tree, &e[i]);
+
+	PCUT_ASSERT_ERRNO_VAL(EOK, bptree_validate(&tree));
+	PCUT_ASSERT_TRUE(bptree_empty(&tree));
+
+	bptree_finalize(&tree);
+	free(e);
+}
+
+/** Removed items with keys stored by reference can be freed.
+ *
+ * The nodes keep pointers to the keys of items, so no node may refer to
+ * a removed item's key after bptree_remove() returns.
+ */
+PCUT_TEST(ref_keys_free)
+{
+	bptree_t tree;
+	test_sentry_t *e[200];
+	test_sentry_t *f;
+	char name[8];
+	int i;
+
+	bptree_initialize(&tree, 0, test_getsname, test_strcmp);
+
+	for (i = 0; i < 200; i++) {
+		snprintf(name, sizeof(name), "%04d", (i * 37) % 200);
+		e[i] = malloc(sizeof(test_sentry_t));
+		PCUT_ASSERT_NOT_NULL(e[i]);
+		e[i]->name = str_dup(name);
+		PCUT_ASSERT_NOT_NULL(e[i]->name);
+		PCUT_ASSERT_ERRNO_VAL(EOK, bptree_insert(&tree, e[i]));
+	}
+
+	/* Remove and free every seventh item */
+	for (i = 0; i < 200; i += 7) {
+		bptree_remove(&tree, e[i]);
+		PCUT_ASSERT_ERRNO_VAL(EOK, bptree_validate(&tree));
+		free(e[i]->name);
+		free(e[i]);
+		e[i] = NULL;
+	}
+
+	for (i = 0; i < 200; i++) {
+		if (e[i] == NULL)
+			continue;
+
+		f = bptree_find_eq(&tree, e[i]->name, NULL);
+		PCUT_ASSERT_EQUALS(e[i], f);
+	}
+
+	for (i = 0; i < 200; i++) {
+		if (e[i] == NULL)
+			continue;
+
+		bptree_remove(&tree, e[i]);
+		PCUT_ASSERT_ERRNO_VAL(EOK, bptree_validate(&tree));
+		free(e[i]->name);
+		free(e[i]);
+	}
+
+	PCUT_ASSERT_TRUE(bptree_empty(&tree));
+	bptree_finalize(&tree);
+}
+
+PCUT_EXPORT(bptree);
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <adt/checksum.h>
+#include <pcut/pcut.h>
+#include <stddef.h>
+#include <stdint.h>
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(checksum);
+
+enum {
+	data_size = 1200,
+	max_offset = 16
+};
+
+static uint8_t data[data_size + max_offset];
+
+/** Fill test buffer with pseudo-random data. */
+static void fill_data(void)
+{
+	uint32_t x = 0x12345678;
+	size_t i;
+
+	for (i = 0; i < sizeof(data); i++) {
+		x = x * 1103515245 + 12345;
+		data[i] = x >> 16;
+	}
+}
+
+/** Bit-by-bit reference implementation. */
+static uint32_t ref_crc(uint32_t poly, const uint8_t *buf, size_t len,
+    uint32_t seed)
+{
+	uint32_t crc = ~seed;
+	size_t i;
+	unsigned j;
+
+	for (i = 0; i < len; i++) {
+		crc ^= buf[i];
+		for (j = 0; j < 8; j++)
+			crc = (crc >> 1) ^ (poly & -(crc & 1));
+	}
+
+	return ~crc;
+}
+
+/** Standard check values */
+PCUT_TEST(check_value)
+{
+	const uint8_t *check = (const uint8_t *) "123456789";
+
+	PCUT_ASSERT_INT_EQUALS(0xcbf43926, compute_crc32(check, 9));
+	PCUT_ASSERT_INT_EQUALS(0xe3069283, compute_crc32c(check, 9));
+	PCUT_ASSERT_INT_EQUALS(0, compute_crc32(check, 0));
+	PCUT_ASSERT_INT_EQUALS(0, compute_crc32c(check, 0));
+}
+
+/** Compare with reference for all lengths and misalignments.
+ *
+ * Lengths of 64 bytes and more also exercise the folding path on
+ * processors that support carry-less multiplication.
+ */
+PCUT_TEST(reference)
+{
+	size_t off;
+	size_t len;
+
+	fill_data();
+
+	for (off = 0; off < max_offset; off++) {
+		for (len = 0; len <= data_size; len += (len < 160) ? 1 : 37) {
+			PCUT_ASSERT_INT_EQUALS(
+			    ref_crc(0xedb88320, data + off, len, 0),
+			    compute_crc32(data + off, len));
+			PCUT_ASSERT_INT_EQUALS(
+			    ref_crc(0x82f63b78, data + off, len, 0),
+			    compute_crc32c(data + off, len));
+		}
+	}
+}
+
+/** Checksum computed in pieces equals checksum of the whole */
+PCUT_TEST(seed_chain)
+{
+	uint32_t crc;
+	uint32_t crcc;
+	size_t pos;
+	size_t n;
+
+	fill_data();
+
+	crc = 0;
+	crcc = 0;
+	pos = 0;
+	n = 1;
+	while (pos < data_size) {
+		if (n > data_size - pos)
+			n = data_size - pos;
+
+		crc = compute_crc32_seed(data + pos, n, crc);
+		crcc = compute_crc32c_seed(data + pos, n, crcc);
+		pos += n;
+		n = n * 3 + 1;
+	}
+
+	PCUT_ASSERT_INT_EQUALS(compute_crc32(data, data_size), crc);
+	PCUT_ASSERT_INT_EQUALS(compute_crc32c(data, data_size), crcc);
+	PCUT_ASSERT_INT_EQUALS(ref_crc(0xedb88320, data, data_size,
+	    0x5a5a5a5a), compute_crc32_seed(data, data_size, 0x5a5a5a5a));
+}
+
+PCUT_EXPORT(checksum);
@@ -0,0 +1,286 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <adt/flat_hash.h>
+#include <errno.h>
+#include <pcut/pcut.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/** Test entry */
+typedef struct {
+	int key;
+	bool present;
+} test_entry_t;
+
+enum {
+	/** Number of test entries (enough for several resizes) */
+	test_seq_len = 2000,
+	/** Number of distinct hashes returned by the colliding hash */
+	test_coll_hashes = 5
+};
+
+static test_entry_t entries[test_seq_len];
+
+static size_t test_hash(const void *item)
+{
+	return ((const test_entry_t *)item)->key;
+}
+
+static size_t test_key_hash(const void *key)
+{
+	return *(const int *)key;
+}
+
+static size_t test_coll_hash(const void *item)
+{
+	return ((const test_entry_t *)item)->key % test_coll_hashes;
+}
+
+static size_t test_coll_key_hash(const void *key)
+{
+	return *(const int *)key % test_coll_hashes;
+}
+
+static bool test_equal(const void *item1, const void *item2)
+{
+	return ((const test_entry_t *)item1)->key ==
+	    ((const test_entry_t *)item2)->key;
+}
+
+static bool test_key_equal(const void *key, const void *item)
+{
+	return *(const int *)key == ((const test_entry_t *)item)->key;
+}
+
+static void test_remove_callback(void *item)
+{
+	((test_entry_t *)item)->present = false;
+}
+
+static flat_hash_ops_t test_ops = {
+	.hash = test_hash,
+	.key_hash = test_key_hash,
+	.equal = test_equal,
+	.key_equal = test_key_equal,
+	.remove_callback = test_remove_callback
+};
+
+/** Operations with a hash that makes most items collide */
+static flat_hash_ops_t test_coll_ops = {
+	.hash = test_coll_hash,
+	.key_hash = test_coll_key_hash,
+	.equal = test_equal,
+	.key_equal = test_key_equal,
+	.remove_callback = test_remove_callback
+};
+
+/** Initialize test entries with keys 0, 1, ... */
+static void entries_init(void)
+{
+	int i;
+
+	for (i = 0; i < test_seq_len; i++) {
+		entries[i].key = i;
+		entries[i].present = false;
+	}
+}
+
+/** Check that exactly the entries marked present can be found. */
+static void check_present(flat_hash_t *h, int n)
+{
+	size_t cnt = 0;
+	void *item;
+	int i;
+
+	for (i = 0; i < n; i++) {
+		item = flat_hash_find(h, &entries[i].key);
+		if (entries[i].present) {
+			PCUT_ASSERT_EQUALS(&entries[i], item);
+			++cnt;
+		} else {
+			PCUT_ASSERT_NULL(item);
+		}
+	}
+
+	PCUT_ASSERT_INT_EQUALS(cnt, flat_hash_size(h));
+}
+
+/** Apply callback removing entries with odd keys. */
+static bool remove_odd(void *item, void *arg)
+{
+	flat_hash_t *h = (flat_hash_t *)arg;
+	test_entry_t *e = (test_entry_t *)item;
+
+	PCUT_ASSERT_TRUE(e->present);
+	if ((e->key % 2) != 0)
+		flat_hash_remove_item(h, item);
+
+	return true;
+}
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(flat_hash);
+
+/** Items can be found while the table grows */
+PCUT_TEST(insert_find)
+{
+	flat_hash_t h;
+	errno_t rc;
+	bool ok;
+	int i;
+
+	entries_init();
+
+	ok = flat_hash_create(&h, 0, &test_ops);
+	PCUT_ASSERT_TRUE(ok);
+	PCUT_ASSERT_TRUE(flat_hash_empty(&h));
+
+	for (i = 0; i < test_seq_len; i++) {
+		rc = flat_hash_insert(&h, &entries[i]);
+		PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+		entries[i].present = true;
+
+		if (i % 97 == 0)
+			check_present(&h, test_seq_len);
+	}
+
+	check_present(&h, test_seq_len);
+
+	flat_hash_destroy(&h);
+	for (i = 0; i < test_seq_len; i++)
+		PCUT_ASSERT_FALSE(entries[i].present);
+}
+
+/** Duplicates are rejected */
+PCUT_TEST(insert_unique)
+{
+	test_entry_t dup;
+	flat_hash_t h;
+	errno_t rc;
+	bool ok;
+	int i;
+
+	entries_init();
+
+	ok = flat_hash_create(&h, 0, &test_ops);
+	PCUT_ASSERT_TRUE(ok);
+
+	for (i = 0; i < test_seq_len; i++) {
+		rc = flat_hash_insert_unique(&h, &entries[i]);
+		PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+		entries[i].present = true;
+
+		dup.key = i / 2;
+		rc = flat_hash_insert_unique(&h, &dup);
+		PCUT_ASSERT_ERRNO_VAL(EEXIST, rc);
+	}
+
+	check_present(&h, test_seq_len);
+	flat_hash_destroy(&h);
+}
+
+/** Removal and reinsertion with colliding hashes (long probe sequences) */
+PCUT_TEST(remove_collisions)
+{
+	flat_hash_t h;
+	size_t removed;
+	errno_t rc;
+	bool ok;
+	int n = test_seq_len / 4;
+	int round;
+	int i;
+
+	entries_init();
+
+	ok = flat_hash_create(&h, 0, &test_coll_ops);
+	PCUT_ASSERT_TRUE(ok);
+
+	for (i = 0; i < n; i++) {
+		rc = flat_hash_insert(&h, &entries[i]);
+		PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+		entries[i].present = true;
+	}
+
+	/* Leave tombstones and fill them again */
+	for (round = 0; round < 3; round++) {
+		for (i = round; i < n; i += 3) {
+			removed = flat_hash_remove(&h, &entries[i].key);
+			PCUT_ASSERT_INT_EQUALS(1, removed);
+			PCUT_ASSERT_FALSE(entries[i].present);
+		}
+
+		check_present(&h, n);
+
+		for (i = round; i < n; i += 3) {
+			rc = flat_hash_insert(&h, &entries[i]);
+			PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+			entries[i].present = true;
+		}
+
+		check_present(&h, n);
+	}
+
+	flat_hash_destroy(&h);
+}
+
+/** Apply visits all items and lets the callback remove them */
+PCUT_TEST(apply_remove)
+{
+	flat_hash_t h;
+	errno_t rc;
+	bool ok;
+	int i;
+
+	entries_init();
+
+	ok = flat_hash_create(&h, 0, &test_ops);
+	PCUT_ASSERT_TRUE(ok);
+
+	for (i = 0; i < test_seq_len; i++) {
+		rc = flat_hash_insert(&h, &entries[i]);
+		PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+		entries[i].present = true;
+	}
+
+	flat_hash_apply(&h, remove_odd, &h);
+
+	for (i = 0; i < test_seq_len; i++)
+		PCUT_ASSERT_EQUALS((i % 2) == 0, entries[i].present);
+
+	check_present(&h, test_seq_len);
+
+	flat_hash_clear(&h);
+	PCUT_ASSERT_TRUE(flat_hash_empty(&h));
+	check_present(&h, test_seq_len);
+
+	flat_hash_destroy(&h);
+}
+
+PCUT_EXPORT(flat_hash);
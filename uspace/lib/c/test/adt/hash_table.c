@@ -0,0 +1,286 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <adt/hash_table.h>
+#include <pcut/pcut.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/** Test entry */
+typedef struct {
+	ht_link_t link;
+	int key;
+	bool present;
+} test_entry_t;
+
+enum {
+	/** Number of test entries (enough for several resizes) */
+	test_seq_len = 2000
+};
+
+static test_entry_t entries[test_seq_len];
+
+static size_t test_hash(const ht_link_t *item)
+{
+	return hash_table_get_inst(item, test_entry_t, link)->key;
+}
+
+static size_t test_key_hash(const void *key)
+{
+	return *(const int *)key;
+}
+
+static bool test_equal(const ht_link_t *item1, const ht_link_t *item2)
+{
+	return hash_table_get_inst(item1, test_entry_t, link)->key ==
+	    hash_table_get_inst(item2, test_entry_t, link)->key;
+}
+
+static bool test_key_equal(const void *key, const ht_link_t *item)
+{
+	return *(const int *)key ==
+	    hash_table_get_inst(item, test_entry_t, link)->key;
+}
+
+static void test_remove_callback(ht_link_t *item)
+{
+	hash_table_get_inst(item, test_entry_t, link)->present = false;
+}
+
+static hash_table_ops_t test_ops = {
+	.hash = test_hash,
+	.key_hash = test_key_hash,
+	.equal = test_equal,
+	.key_equal = test_key_equal,
+	.remove_callback = test_remove_callback
+};
+
+/** Initialize test entries with keys 0, 1, ... */
+static void entries_init(void)
+{
+	int i;
+
+	for (i = 0; i < test_seq_len; i++) {
+		entries[i].key = i;
+		entries[i].present = false;
+	}
+}
+
+/** Check that exactly the entries marked present can be found. */
+static void check_present(hash_table_t *h)
+{
+	ht_link_t *link;
+	size_t cnt = 0;
+	int i;
+
+	for (i = 0; i < test_seq_len; i++) {
+		link = hash_table_find(h, &entries[i].key);
+		if (entries[i].present) {
+			PCUT_ASSERT_EQUALS(&entries[i].link, link);
+			++cnt;
+		} else {
+			PCUT_ASSERT_NULL(link);
+		}
+	}
+
+	PCUT_ASSERT_INT_EQUALS(cnt, hash_table_size(h));
+}
+
+/** Apply callback removing entries with odd keys. */
+static bool remove_odd(ht_link_t *item, void *arg)
+{
+	hash_table_t *h = (hash_table_t *)arg;
+	test_entry_t *e = hash_table_get_inst(item, test_entry_t, link);
+
+	PCUT_ASSERT_TRUE(e->present);
+	if ((e->key % 2) != 0)
+		hash_table_remove_item(h, item);
+
+	return true;
+}
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(hash_table);
+
+/** Items can be found while the table grows and migrates buckets */
+PCUT_TEST(insert_find)
+{
+	hash_table_t h;
+	bool ok;
+	int i;
+
+	entries_init();
+
+	ok = hash_table_create(&h, 0, 0, &test_ops);
+	PCUT_ASSERT_TRUE(ok);
+	PCUT_ASSERT_TRUE(hash_table_empty(&h));
+
+	for (i = 0; i < test_seq_len; i++) {
+		hash_table_insert(&h, &entries[i].link);
+		entries[i].present = true;
+
+		if (i % 97 == 0)
+			check_present(&h);
+	}
+
+	check_present(&h);
+
+	hash_table_destroy(&h);
+	for (i = 0; i < test_seq_len; i++)
+		PCUT_ASSERT_FALSE(entries[i].present);
+}
+
+/** Duplicates are rejected even if the table is being resized */
+PCUT_TEST(insert_unique)
+{
+	test_entry_t dup;
+	hash_table_t h;
+	bool ok;
+	int i;
+
+	entries_init();
+
+	ok = hash_table_create(&h, 0, 0, &test_ops);
+	PCUT_ASSERT_TRUE(ok);
+
+	for (i = 0; i < test_seq_len; i++) {
+		ok = hash_table_insert_unique(&h, &entries[i].link);
+		PCUT_ASSERT_TRUE(ok);
+		entries[i].present = true;
+
+		dup.key = i / 2;
+		ok = hash_table_insert_unique(&h, &dup.link);
+		PCUT_ASSERT_FALSE(ok);
+	}
+
+	check_present(&h);
+	hash_table_destroy(&h);
+}
+
+/** Removal while the table shrinks */
+PCUT_TEST(remove)
+{
+	hash_table_t h;
+	size_t removed;
+	bool ok;
+	int i;
+
+	entries_init();
+
+	ok = hash_table_create(&h, 0, 0, &test_ops);
+	PCUT_ASSERT_TRUE(ok);
+
+	for (i = 0; i < test_seq_len; i++) {
+		hash_table_insert(&h, &entries[i].link);
+		entries[i].present = true;
+	}
+
+	for (i = 0; i < test_seq_len; i++) {
+		removed = hash_table_remove(&h, &entries[i].key);
+		PCUT_ASSERT_INT_EQUALS(1, removed);
+		PCUT_ASSERT_FALSE(entries[i].present);
+
+		if (i % 97 == 0)
+			check_present(&h);
+	}
+
+	PCUT_ASSERT_TRUE(hash_table_empty(&h));
+	hash_table_destroy(&h);
+}
+
+/** Apply visits all items and lets the callback remove them */
+PCUT_TEST(apply_remove)
+{
+	hash_table_t h;
+	bool ok;
+	int i;
+
+	entries_init();
+
+	ok = hash_table_create(&h, 0, 0, &test_ops);
+	PCUT_ASSERT_TRUE(ok);
+
+	/* Stop in the middle of a resize */
+	for (i = 0; i < test_seq_len / 2 + 7; i++) {
+		hash_table_insert(&h, &entries[i].link);
+		entries[i].present = true;
+	}
+
+	hash_table_apply(&h, remove_odd, &h);
+
+	for (i = 0; i < test_seq_len / 2 + 7; i++)
+		PCUT_ASSERT_EQUALS((i % 2) == 0, entries[i].present);
+
+	check_present(&h);
+	hash_table_destroy(&h);
+}
+
+/** Equal items can be enumerated with find_next */
+PCUT_TEST(find_next)
+{
+	test_entry_t same[3];
+	hash_table_t h;
+	ht_link_t *first;
+	ht_link_t *cur;
+	int key = 5;
+	int cnt;
+	bool ok;
+	int i;
+
+	entries_init();
+
+	ok = hash_table_create(&h, 0, 0, &test_ops);
+	PCUT_ASSERT_TRUE(ok);
+
+	for (i = 0; i < 3; i++) {
+		same[i].key = key;
+		hash_table_insert(&h, &same[i].link);
+	}
+
+	for (i = 0; i < test_seq_len; i++) {
+		if (i != key)
+			hash_table_insert(&h, &entries[i].link);
+	}
+
+	first = hash_table_find(&h, &key);
+	PCUT_ASSERT_NOT_NULL(first);
+
+	cnt = 1;
+	cur = first;
+	while ((cur = hash_table_find_next(&h, first, cur)) != NULL) {
+		PCUT_ASSERT_INT_EQUALS(key,
+		    hash_table_get_inst(cur, test_entry_t, link)->key);
+		++cnt;
+	}
+
+	PCUT_ASSERT_INT_EQUALS(3, cnt);
+	hash_table_destroy(&h);
+}
+
+PCUT_EXPORT(hash_table);
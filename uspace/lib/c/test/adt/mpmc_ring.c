@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <adt/mpmc_ring.h>
+#include <errno.h>
+#include <pcut/pcut.h>
+#include <stdint.h>
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(mpmc_ring);
+
+enum {
+	ring_size = 16
+};
+
+/** Ring size must be a power of two. */
+PCUT_TEST(init_size)
+{
+	mpmc_ring_t ring;
+	errno_t rc;
+
+	rc = mpmc_ring_init(&ring, 0, sizeof(int));
+	PCUT_ASSERT_ERRNO_VAL(EINVAL, rc);
+
+	rc = mpmc_ring_init(&ring, 12, sizeof(int));
+	PCUT_ASSERT_ERRNO_VAL(EINVAL, rc);
+
+	rc = mpmc_ring_init(&ring, 1, sizeof(int));
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	mpmc_ring_fini(&ring);
+}
+
+/** Fill the ring until it is full, then empty it again. */
+PCUT_TEST(push_pop)
+{
+	mpmc_ring_t ring;
+	int i;
+	int j;
+	errno_t rc;
+
+	rc = mpmc_ring_init(&ring, ring_size, sizeof(int));
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = mpmc_ring_pop(&ring, &j);
+	PCUT_ASSERT_ERRNO_VAL(EAGAIN, rc);
+
+	for (i = 0; i < ring_size; i++) {
+		rc = mpmc_ring_push(&ring, &i);
+		PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	}
+
+	rc = mpmc_ring_push(&ring, &i);
+	PCUT_ASSERT_ERRNO_VAL(EAGAIN, rc);
+
+	for (i = 0; i < ring_size; i++) {
+		rc = mpmc_ring_pop(&ring, &j);
+		PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+		PCUT_ASSERT_INT_EQUALS(i, j);
+	}
+
+	rc = mpmc_ring_pop(&ring, &j);
+	PCUT_ASSERT_ERRNO_VAL(EAGAIN, rc);
+
+	mpmc_ring_fini(&ring);
+}
+
+/** Items keep FIFO order as the indices wrap around many times. */
+PCUT_TEST(wrap)
+{
+	mpmc_ring_t ring;
+	uint64_t next_in = 0;
+	uint64_t next_out = 0;
+	uint64_t v;
+	int i;
+	errno_t rc;
+
+	rc = mpmc_ring_init(&ring, ring_size, sizeof(uint64_t));
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	while (next_out < 100 * ring_size) {
+		/* Push a varying number of items, then pop a few */
+		for (i = 0; i < (int) (next_in % 7) + 1; i++) {
+			rc = mpmc_ring_push(&ring, &next_in);
+			if (rc == EAGAIN)
+				break;
+			PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+			next_in++;
+		}
+
+		for (i = 0; i < 5; i++) {
+			rc = mpmc_ring_pop(&ring, &v);
+			if (rc == EAGAIN) {
+				PCUT_ASSERT_INT_EQUALS(next_in, next_out);
+				break;
+			}
+			PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+			PCUT_ASSERT_INT_EQUALS(next_out, v);
+			next_out++;
+		}
+	}
+
+	mpmc_ring_fini(&ring);
+}
+
+PCUT_EXPORT(mpmc_ring);
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <adt/mpsc_queue.h>
+#include <errno.h>
+#include <pcut/pcut.h>
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(mpsc_queue);
+
+enum {
+	item_count = 16
+};
+
+typedef struct {
+	int value;
+	mpsc_link_t link;
+} test_item_t;
+
+static test_item_t items[item_count];
+
+/** Items are popped in the order they were pushed. */
+PCUT_TEST(push_pop)
+{
+	mpsc_queue_t queue;
+	mpsc_link_t *link;
+	test_item_t *item;
+	int i;
+
+	mpsc_queue_initialize(&queue);
+
+	link = mpsc_queue_trypop(&queue);
+	PCUT_ASSERT_NULL(link);
+
+	for (i = 0; i < item_count; i++) {
+		items[i].value = i;
+		mpsc_queue_push(&queue, &items[i].link);
+	}
+
+	for (i = 0; i < item_count; i++) {
+		link = mpsc_queue_trypop(&queue);
+		PCUT_ASSERT_NOT_NULL(link);
+		item = mpsc_queue_get_instance(link, test_item_t, link);
+		PCUT_ASSERT_INT_EQUALS(i, item->value);
+	}
+
+	link = mpsc_queue_trypop(&queue);
+	PCUT_ASSERT_NULL(link);
+}
+
+/** Popped items can be pushed again, including the last one. */
+PCUT_TEST(reuse)
+{
+	mpsc_queue_t queue;
+	mpsc_link_t *link;
+	test_item_t *item;
+	int i;
+
+	mpsc_queue_initialize(&queue);
+
+	for (i = 0; i < 3 * item_count; i++) {
+		items[i % item_count].value = i;
+		mpsc_queue_push(&queue, &items[i % item_count].link);
+
+		link = mpsc_queue_pop(&queue);
+		PCUT_ASSERT_NOT_NULL(link);
+		item = mpsc_queue_get_instance(link, test_item_t, link);
+		PCUT_ASSERT_INT_EQUALS(i, item->value);
+	}
+
+	link = mpsc_queue_trypop(&queue);
+	PCUT_ASSERT_NULL(link);
+}
+
+/** Blocking pop times out on an empty queue and returns queued items. */
+PCUT_TEST(pop_timeout)
+{
+	mpsc_queue_t queue;
+	mpsc_link_t *link;
+	errno_t rc;
+
+	mpsc_queue_initialize(&queue);
+
+	link = NULL;
+	rc = mpsc_queue_pop_timeout(&queue, 1000, &link);
+	PCUT_ASSERT_ERRNO_VAL(ETIMEOUT, rc);
+	PCUT_ASSERT_NULL(link);
+
+	mpsc_queue_push(&queue, &items[0].link);
+	rc = mpsc_queue_pop_timeout(&queue, 1000, &link);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_TRUE(link == &items[0].link);
+
+	/* A timed-out wait must not leave a stale wakeup behind */
+	rc = mpsc_queue_pop_timeout(&queue, 1000, &link);
+	PCUT_ASSERT_ERRNO_VAL(ETIMEOUT, rc);
+}
+
+PCUT_EXPORT(mpsc_queue);
@@ -28,6 +28,13 @@
 
 #include <pcut/pcut.h>
 #include <gsort.h>
+#include <stdlib.h>
+
+/** Element with a key and its original position */
+typedef struct {
+	int key;
+	int pos;
+} rec_t;
 
 static int cmp_func(void *a, void *b, void *param)
 {
@@ -40,6 +47,17 @@ static int cmp_func(void *a, void *b, void *param)
 	return ia < ib ? -1 : 1;
 }
 
+static int rec_cmp_func(void *a, void *b, void *param)
+{
+	rec_t *ra = (rec_t *)a;
+	rec_t *rb = (rec_t *)b;
+
+	if (ra->key == rb->key)
+		return 0;
+
+	return ra->key < rb->key ? -1 : 1;
+}
+
 PCUT_INIT;
 
 PCUT_TEST_SUITE(gsort);
@@ -105,4 +123,54 @@ PCUT_TEST(gsort_desc)
 	}
 }
 
+/* elements with equal keys keep their original order */
+PCUT_TEST(gsort_stable)
+{
+	int size = 1000;
+	rec_t *data;
+
+	data = calloc(size, sizeof(rec_t));
+	PCUT_ASSERT_NOT_NULL(data);
+
+	for (int i = 0; i < size; i++) {
+		data[i].key = (i * 7919) % 13;
+		data[i].pos = i;
+	}
+
+	bool ret = gsort(data, size, sizeof(rec_t), rec_cmp_func, NULL);
+	PCUT_ASSERT_TRUE(ret);
+
+	for (int i = 1; i < size; i++) {
+		PCUT_ASSERT_TRUE(data[i - 1].key <= data[i].key);
+		if (data[i - 1].key == data[i].key)
+			PCUT_ASSERT_TRUE(data[i - 1].pos < data[i].pos);
+	}
+
+	free(data);
+}
+
+/* sort large pseudorandom sequence */
+PCUT_TEST(gsort_large)
+{
+	int size = 10000;
+	int *data;
+	int v = 1;
+
+	data = calloc(size, sizeof(int));
+	PCUT_ASSERT_NOT_NULL(data);
+
+	for (int i = 0; i < size; i++) {
+		data[i] = v;
+		v = (v * 1951) % 1000000;
+	}
+
+	bool ret = gsort(data, size, sizeof(int), cmp_func, NULL);
+	PCUT_ASSERT_TRUE(ret);
+
+	for (int i = 1; i < size; i++)
+		PCUT_ASSERT_TRUE(data[i - 1] <= data[i]);
+
+	free(data);
+}
+
 PCUT_EXPORT(gsort);
@@ -32,24 +32,32 @@
 
 PCUT_INIT;
 
+PCUT_IMPORT(bitmap);
+PCUT_IMPORT(bptree);
 PCUT_IMPORT(capa);
 PCUT_IMPORT(casting);
+PCUT_IMPORT(checksum);
 PCUT_IMPORT(circ_buf);
 PCUT_IMPORT(double_to_str);
 PCUT_IMPORT(fibril_timer);
+PCUT_IMPORT(flat_hash);
 PCUT_IMPORT(getopt);
 PCUT_IMPORT(gsort);
+PCUT_IMPORT(hash_table);
 PCUT_IMPORT(ieee_double);
 PCUT_IMPORT(imath);
 PCUT_IMPORT(inttypes);
 PCUT_IMPORT(loc);
 PCUT_IMPORT(mem);
+PCUT_IMPORT(mpmc_ring);
+PCUT_IMPORT(mpsc_queue);
 PCUT_IMPORT(odict);
 PCUT_IMPORT(perf);
 PCUT_IMPORT(perm);
 PCUT_IMPORT(qsort);
 PCUT_IMPORT(scanf);
 PCUT_IMPORT(sprintf);
+PCUT_IMPORT(spsc_ring);
 PCUT_IMPORT(stdio);
 PCUT_IMPORT(stdlib);
 PCUT_IMPORT(str);
@@ -28,11 +28,58 @@
 
 #include <mem.h>
 #include <pcut/pcut.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
 
 PCUT_INIT;
 
 PCUT_TEST_SUITE(mem);
 
+enum {
+	/** Largest size tested with all alignments */
+	sweep_max = 300,
+	/** Number of alignments tested */
+	sweep_align = 16,
+	/** Size of test buffers */
+	sweep_buf = 8192
+};
+
+/** Sizes above sweep_max to test (cover all copy strategies) */
+static const size_t sweep_large[] = { 1000, 2047, 2048, 5000, 8000 };
+
+/** Fill buffer with pseudo-random data.
+ *
+ * @param buf Buffer
+ * @param size Buffer size
+ * @param seed Seed
+ */
+static void fill_random(uint8_t *buf, size_t size, uint32_t seed)
+{
+	size_t i;
+
+	for (i = 0; i < size; i++) {
+		seed = seed * 1103515245 + 12345;
+		buf[i] = seed >> 16;
+	}
+}
+
+/** Return next size to test after @a n */
+static size_t sweep_next(size_t n)
+{
+	size_t i;
+
+	if (n < sweep_max)
+		return n + 1;
+
+	for (i = 0; i < sizeof(sweep_large) / sizeof(sweep_large[0]); i++) {
+		if (sweep_large[i] > n)
+			return sweep_large[i];
+	}
+
+	return SIZE_MAX;
+}
+
 /** memcpy function */
 PCUT_TEST(memcpy)
 {
@@ -115,4 +162,130 @@ PCUT_TEST(memset)
 	PCUT_ASSERT_INT_EQUALS('x', buf[4]);
 }
 
+/** memcpy function with various sizes and alignments */
+PCUT_TEST(memcpy_sweep)
+{
+	uint8_t *src, *dst, *ref;
+	size_t n, so, dof, i;
+
+	src = malloc(sweep_buf);
+	dst = malloc(sweep_buf);
+	ref = malloc(sweep_buf);
+	PCUT_ASSERT_NOT_NULL(src);
+	PCUT_ASSERT_NOT_NULL(dst);
+	PCUT_ASSERT_NOT_NULL(ref);
+
+	fill_random(src, sweep_buf, 1);
+
+	for (n = 0; n < sweep_buf - sweep_align; n = sweep_next(n)) {
+		for (so = 0; so < sweep_align; so++) {
+			dof = (so * 7 + n) % sweep_align;
+
+			fill_random(dst, sweep_buf, n);
+			fill_random(ref, sweep_buf, n);
+			for (i = 0; i < n; i++)
+				ref[dof + i] = src[so + i];
+
+			memcpy(dst + dof, src + so, n);
+			PCUT_ASSERT_INT_EQUALS(0, memcmp(dst, ref, sweep_buf));
+		}
+	}
+
+	free(src);
+	free(dst);
+	free(ref);
+}
+
+/** memmove function with overlapping blocks in both directions */
+PCUT_TEST(memmove_sweep)
+{
+	uint8_t *buf, *ref, *tmp;
+	size_t n, i;
+	size_t base = 100;
+	int shift;
+
+	buf = malloc(sweep_buf);
+	ref = malloc(sweep_buf);
+	tmp = malloc(sweep_buf);
+	PCUT_ASSERT_NOT_NULL(buf);
+	PCUT_ASSERT_NOT_NULL(ref);
+	PCUT_ASSERT_NOT_NULL(tmp);
+
+	for (n = 0; n < sweep_buf - 2 * base; n = sweep_next(n)) {
+		for (shift = -80; shift <= 80; shift += (n < 100) ? 1 : 7) {
+			fill_random(buf, sweep_buf, n + shift);
+			memcpy(ref, buf, sweep_buf);
+			for (i = 0; i < n; i++)
+				tmp[i] = ref[base + i];
+			for (i = 0; i < n; i++)
+				ref[base + shift + i] = tmp[i];
+
+			memmove(buf + base + shift, buf + base, n);
+			PCUT_ASSERT_INT_EQUALS(0, memcmp(buf, ref, sweep_buf));
+		}
+	}
+
+	free(buf);
+	free(ref);
+	free(tmp);
+}
+
+/** memset function with various sizes and alignments */
+PCUT_TEST(memset_sweep)
+{
+	uint8_t *buf, *ref;
+	size_t n, off, i;
+
+	buf = malloc(sweep_buf);
+	ref = malloc(sweep_buf);
+	PCUT_ASSERT_NOT_NULL(buf);
+	PCUT_ASSERT_NOT_NULL(ref);
+
+	for (n = 0; n < sweep_buf - sweep_align; n = sweep_next(n)) {
+		for (off = 0; off < sweep_align; off++) {
+			fill_random(buf, sweep_buf, n);
+			fill_random(ref, sweep_buf, n);
+			for (i = 0; i < n; i++)
+				ref[off + i] = 0xa5;
+
+			memset(buf + off, 0x1a5, n);
+			PCUT_ASSERT_INT_EQUALS(0, memcmp(buf, ref, sweep_buf));
+		}
+	}
+
+	free(buf);
+	free(ref);
+}
+
+/** memchr function with various sizes, alignments and match positions */
+PCUT_TEST(memchr_sweep)
+{
+	uint8_t *buf;
+	uint8_t *s;
+	size_t n, off, pos;
+
+	buf = malloc(sweep_buf);
+	PCUT_ASSERT_NOT_NULL(buf);
+
+	for (n = 0; n < sweep_buf - sweep_align - 1; n = sweep_next(n)) {
+		for (off = 1; off < sweep_align; off++) {
+			memset(buf, 'a', sweep_buf);
+			s = buf + off;
+
+			/* Matches just outside of the block are not found */
+			s[-1] = 'z';
+			s[n] = 'z';
+			PCUT_ASSERT_NULL(memchr(s, 'z', n));
+
+			for (pos = 0; pos < n; pos += (n < 100) ? 1 : 37) {
+				s[pos] = 'z';
+				PCUT_ASSERT_TRUE(memchr(s, 'z', n) == s + pos);
+				s[pos] = 'a';
+			}
+		}
+	}
+
+	free(buf);
+}
+
 PCUT_EXPORT(mem);
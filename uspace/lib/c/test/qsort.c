@@ -28,14 +28,44 @@
 
 #include <pcut/pcut.h>
 #include <qsort.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <str.h>
 
 enum {
 	/** Length of test number sequences */
-	test_seq_len = 5
+	test_seq_len = 5,
+	/** Length of large test sequences */
+	large_seq_len = 10000
 };
 
+/** Input patterns for large sequences */
+typedef enum {
+	pat_random,
+	pat_sorted,
+	pat_reversed,
+	pat_organ_pipe,
+	pat_few_unique,
+	pat_equal,
+	pat_limit
+} test_pattern_t;
+
+/** Element with a payload that must travel with its key */
+typedef struct {
+	uint32_t key;
+	uint8_t payload[20];
+} test_rec_t;
+
+/** Argument of test_cmp_r() */
+typedef struct {
+	/** Sort in descending order */
+	bool descending;
+	/** Number of calls */
+	size_t ncalls;
+} test_cmp_arg_t;
+
 /** Test compare function.
  *
  * @param a First key
@@ -66,6 +96,87 @@ static void bubble_sort(int *seq, size_t nmemb)
 		}
 }
 
+/** Generate pseudorandom sequence. */
+static int seq_next(int cur)
+{
+	return (cur * 1951) % 1000000;
+}
+
+/** Fill sequence according to pattern.
+ *
+ * @param seq Sequence
+ * @param n Number of elements
+ * @param pat Pattern
+ */
+static void fill_pattern(int *seq, size_t n, test_pattern_t pat)
+{
+	size_t i;
+	int v = 1;
+
+	for (i = 0; i < n; i++) {
+		switch (pat) {
+		case pat_random:
+			seq[i] = v;
+			v = seq_next(v);
+			break;
+		case pat_sorted:
+			seq[i] = i;
+			break;
+		case pat_reversed:
+			seq[i] = n - i;
+			break;
+		case pat_organ_pipe:
+			seq[i] = i < n / 2 ? i : n - i;
+			break;
+		case pat_few_unique:
+			seq[i] = v % 4;
+			v = seq_next(v);
+			break;
+		default:
+			seq[i] = 42;
+			break;
+		}
+	}
+}
+
+/** Compare function that takes sort direction and counts calls.
+ *
+ * @param a First key
+ * @param b Second key
+ * @param arg Pointer to test_cmp_arg_t
+ * @return <0, 0, >0 if @a a is less than, equal or greater than @a b
+ */
+
+static int test_cmp_r(const void *a, const void *b, void *arg)
+{
+	test_cmp_arg_t *carg = (test_cmp_arg_t *)arg;
+	int r = test_cmp(a, b);
+
+	++carg->ncalls;
+	return carg->descending ? -r : r;
+}
+
+/** Record compare function.
+ *
+ * @param a First record
+ * @param b Second record
+ * @param arg Not used
+ * @return <0, 0, >0 if @a a is less than, equal or greater than @a b
+ */
+static int test_rec_cmp(const void *a, const void *b, void *arg)
+{
+	uint32_t ka, kb;
+
+	(void)arg;
+	memcpy(&ka, a, sizeof(ka));
+	memcpy(&kb, b, sizeof(kb));
+
+	if (ka == kb)
+		return 0;
+
+	return ka < kb ? -1 : 1;
+}
+
 PCUT_INIT;
 
 PCUT_TEST_SUITE(qsort);
@@ -134,12 +245,6 @@ PCUT_TEST(decr2_seq)
 	free(seq);
 }
 
-/** Generate pseudorandom sequence. */
-static int seq_next(int cur)
-{
-	return (cur * 1951) % 1000000;
-}
-
 /** Test sorting pseudorandom sequence. */
 PCUT_TEST(pseudorandom_seq)
 {
@@ -171,4 +276,113 @@ PCUT_TEST(pseudorandom_seq)
 	free(seq2);
 }
 
+/** Test sorting large sequences with various input patterns */
+PCUT_TEST(large_patterns)
+{
+	test_pattern_t pat;
+	int64_t sum, sum2;
+	int *seq;
+	size_t i;
+
+	seq = calloc(large_seq_len, sizeof(int));
+	PCUT_ASSERT_NOT_NULL(seq);
+
+	for (pat = 0; pat < pat_limit; pat++) {
+		fill_pattern(seq, large_seq_len, pat);
+
+		sum = 0;
+		for (i = 0; i < large_seq_len; i++)
+			sum += seq[i];
+
+		qsort(seq, large_seq_len, sizeof(int), test_cmp);
+
+		sum2 = seq[0];
+		for (i = 1; i < large_seq_len; i++) {
+			PCUT_ASSERT_TRUE(seq[i - 1] <= seq[i]);
+			sum2 += seq[i];
+		}
+
+		PCUT_ASSERT_INT_EQUALS(sum, sum2);
+	}
+
+	free(seq);
+}
+
+/** Test sorting with user argument, checking number of comparisons */
+PCUT_TEST(qsort_r_arg)
+{
+	test_cmp_arg_t carg;
+	test_pattern_t pat;
+	int *seq;
+	size_t i;
+
+	seq = calloc(large_seq_len, sizeof(int));
+	PCUT_ASSERT_NOT_NULL(seq);
+
+	for (pat = 0; pat < pat_limit; pat++) {
+		fill_pattern(seq, large_seq_len, pat);
+
+		carg.descending = true;
+		carg.ncalls = 0;
+		qsort_r(seq, large_seq_len, sizeof(int), test_cmp_r, &carg);
+
+		for (i = 1; i < large_seq_len; i++)
+			PCUT_ASSERT_TRUE(seq[i - 1] >= seq[i]);
+
+		/* O(n log n) even for adversarial inputs */
+		PCUT_ASSERT_TRUE(carg.ncalls < 4 * 14 * large_seq_len);
+	}
+
+	free(seq);
+}
+
+/** Test sorting elements of various sizes and alignment */
+PCUT_TEST(elem_sizes)
+{
+	size_t sizes[] = { 4, 7, 8, 12, sizeof(test_rec_t) };
+	uint8_t *buf;
+	uint32_t key, key2;
+	size_t esize;
+	size_t n = 1000;
+	size_t s, i, j;
+	int v;
+
+	/* Leave room to make the array misaligned */
+	buf = malloc(n * sizeof(test_rec_t) + 1);
+	PCUT_ASSERT_NOT_NULL(buf);
+
+	for (s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+		esize = sizes[s];
+
+		v = 1;
+		for (i = 0; i < n; i++) {
+			key = v % 500;
+			v = seq_next(v);
+
+			/* Payload is derived from the key */
+			memcpy(buf + 1 + i * esize, &key, sizeof(key));
+			for (j = sizeof(key); j < esize; j++)
+				buf[1 + i * esize + j] = (uint8_t)(key * 7 + j);
+		}
+
+		qsort_r(buf + 1, n, esize, test_rec_cmp, NULL);
+
+		for (i = 0; i < n; i++) {
+			memcpy(&key, buf + 1 + i * esize, sizeof(key));
+			if (i > 0) {
+				memcpy(&key2, buf + 1 + (i - 1) * esize,
+				    sizeof(key2));
+				PCUT_ASSERT_TRUE(key2 <= key);
+			}
+
+			for (j = sizeof(key); j < esize; j++) {
+				PCUT_ASSERT_INT_EQUALS((uint8_t)(key * 7 + j),
+				    buf[1 + i * esize + j]);
+			}
+		}
+	}
+
+	free(buf);
+}
+
 PCUT_EXPORT(qsort);
@@ -82,4 +82,54 @@ SPRINTF_TEST(int_as_hex, "[0x11] [0x012] [0x013] [0x00014] [0x00015]",
     "[%#x] [%#5.3x] [%#-5.3x] [%#3.5x] [%#-3.5x]",
     17, 18, 19, 20, 21);
 
+SPRINTF_TEST(int_decimal_digits, "[0] [9] [10] [99] [100] [4294967295] [18446744073709551615]",
+    "[%d] [%d] [%d] [%u] [%u] [%u] [%llu]",
+    0, 9, 10, 99u, 100u, 4294967295u, 18446744073709551615ull);
+
+SPRINTF_TEST(long_long_min, "-9223372036854775808", "%lld",
+    (long long) (-9223372036854775807ll - 1));
+
+SPRINTF_TEST(int_bases, "[11111111] [0b101] [377] [ff] [0XFF] [FFFFFFFFFFFFFFFF]",
+    "[%b] [%#b] [%o] [%x] [%#X] [%llX]",
+    255, 5, 255, 255, 255, 18446744073709551615ull);
+
+SPRINTF_TEST(int_sign_flags, "[+5] [ 5] [-5] [+0005] [   +5] [+5   ]",
+    "[%+d] [% d] [% d] [%+05d] [%+5d] [%-+5d]",
+    5, 5, -5, 5, 5, 5);
+
+SPRINTF_TEST(int_zero_padded, "[00042] [-0042] [0x002a] [   42]",
+    "[%05d] [%05d] [%#06x] [%5.0d]",
+    42, -42, 42, 42);
+
+SPRINTF_TEST(int_long_zero_padding,
+    "-00000000000000000000000000000000000000000000000000"
+    "000000000000000000000000000000000000000000000000000000000000000000000000"
+    "00000000000000000000000000000042",
+    "%.154d", -42);
+
+SPRINTF_TEST(int_wide_padding,
+    "                                                                      "
+    "                             7|",
+    "%100d|", 7);
+
+SPRINTF_TEST(char_padding, "[  a] [a  ]", "[%3c] [%-3c]", 'a', 'a');
+
+SPRINTF_TEST(percent, "100% [%5]", "100%% [%%5]");
+
+/*
+ * Length modifiers at the very end of the format string. The formats are
+ * not literals so that the compiler does not warn about them.
+ */
+PCUT_TEST(incomplete_qualifier)
+{
+	static const char *formats[] = {
+		"x%", "x%l", "x%ll", "x%h", "x%hh", "x%j", "x%z", "x%t", "x%5l"
+	};
+
+	for (size_t i = 0; i < sizeof(formats) / sizeof(formats[0]); i++) {
+		snprintf(buffer, BUFFER_SIZE, formats[i], 0);
+		PCUT_ASSERT_STR_EQUALS(formats[i], buffer);
+	}
+}
+
 PCUT_EXPORT(sprintf);
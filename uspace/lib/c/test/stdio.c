@@ -37,6 +37,7 @@
 #include <errno.h>
 #include <pcut/pcut.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <str.h>
 #include <tmpfile.h>
 #include <vfs/vfs.h>
@@ -203,6 +204,138 @@ PCUT_TEST(fgetpos_setpos)
 	(void) fclose(f);
 }
 
+/** fread and fwrite with requests larger than the stream buffer */
+PCUT_TEST(fread_fwrite_large)
+{
+	uint8_t *buf;
+	size_t size = 4 * BUFSIZ + 17;
+	size_t n;
+	size_t i;
+	FILE *f;
+
+	buf = malloc(size);
+	PCUT_ASSERT_NOT_NULL(buf);
+
+	for (i = 0; i < size; i++)
+		buf[i] = i % 251;
+
+	f = tmpfile();
+	PCUT_ASSERT_NOT_NULL(f);
+
+	/* Partially fill the buffer first */
+	n = fwrite(buf, 1, 3, f);
+	PCUT_ASSERT_INT_EQUALS(3, n);
+	n = fwrite(buf + 3, 1, size - 3, f);
+	PCUT_ASSERT_INT_EQUALS(size - 3, n);
+
+	rewind(f);
+	memset(buf, 0, size);
+
+	n = fread(buf, 1, 5, f);
+	PCUT_ASSERT_INT_EQUALS(5, n);
+	n = fread(buf + 5, 1, size, f);
+	PCUT_ASSERT_INT_EQUALS(size - 5, n);
+	PCUT_ASSERT_TRUE(feof(f));
+
+	for (i = 0; i < size; i++)
+		PCUT_ASSERT_INT_EQUALS(i % 251, buf[i]);
+
+	(void) fclose(f);
+	free(buf);
+}
+
+/** fgets function with lines longer than the stream buffer */
+PCUT_TEST(fgets_long)
+{
+	char buf[64];
+	size_t len = 2 * BUFSIZ + 5;
+	size_t total;
+	size_t i;
+	char *p;
+	FILE *f;
+
+	f = tmpfile();
+	PCUT_ASSERT_NOT_NULL(f);
+
+	for (i = 0; i < len; i++)
+		PCUT_ASSERT_INT_EQUALS('a' + i % 26, fputc('a' + i % 26, f));
+	PCUT_ASSERT_TRUE(fputs("\n\xffshort\n\nlast", f) >= 0);
+
+	rewind(f);
+
+	total = 0;
+	do {
+		p = fgets(buf, sizeof(buf), f);
+		PCUT_ASSERT_NOT_NULL(p);
+		PCUT_ASSERT_INT_EQUALS('a' + total % 26, buf[0]);
+		total += str_size(buf);
+	} while (buf[str_size(buf) - 1] != '\n');
+
+	PCUT_ASSERT_INT_EQUALS(len + 1, total);
+
+	p = fgets(buf, sizeof(buf), f);
+	PCUT_ASSERT_NOT_NULL(p);
+	PCUT_ASSERT_STR_EQUALS("\xffshort\n", buf);
+
+	p = fgets(buf, sizeof(buf), f);
+	PCUT_ASSERT_NOT_NULL(p);
+	PCUT_ASSERT_STR_EQUALS("\n", buf);
+
+	p = fgets(buf, sizeof(buf), f);
+	PCUT_ASSERT_NOT_NULL(p);
+	PCUT_ASSERT_STR_EQUALS("last", buf);
+
+	p = fgets(buf, sizeof(buf), f);
+	PCUT_ASSERT_NULL(p);
+	PCUT_ASSERT_TRUE(feof(f));
+
+	(void) fclose(f);
+}
+
+/** getline and getdelim functions */
+PCUT_TEST(getline)
+{
+	char *line = NULL;
+	size_t size = 0;
+	ssize_t n;
+	int c;
+	FILE *f;
+
+	f = tmpfile();
+	PCUT_ASSERT_NOT_NULL(f);
+
+	PCUT_ASSERT_TRUE(fputs("first\nsecond:third\nfourth", f) >= 0);
+	rewind(f);
+
+	n = getline(&line, &size, f);
+	PCUT_ASSERT_INT_EQUALS(6, n);
+	PCUT_ASSERT_STR_EQUALS("first\n", line);
+	PCUT_ASSERT_TRUE(size > (size_t) n);
+
+	/* Pushed back character must come first */
+	c = fgetc(f);
+	PCUT_ASSERT_INT_EQUALS('s', c);
+	PCUT_ASSERT_INT_EQUALS('s', ungetc(c, f));
+
+	n = getdelim(&line, &size, ':', f);
+	PCUT_ASSERT_INT_EQUALS(7, n);
+	PCUT_ASSERT_STR_EQUALS("second:", line);
+
+	n = getline(&line, &size, f);
+	PCUT_ASSERT_INT_EQUALS(6, n);
+	PCUT_ASSERT_STR_EQUALS("third\n", line);
+
+	n = getline(&line, &size, f);
+	PCUT_ASSERT_INT_EQUALS(6, n);
+	PCUT_ASSERT_STR_EQUALS("fourth", line);
+
+	n = getline(&line, &size, f);
+	PCUT_ASSERT_INT_EQUALS(-1, n);
+
+	(void) fclose(f);
+	free(line);
+}
+
 /** perror function with NULL as argument */
 PCUT_TEST(perror_null_msg)
 {
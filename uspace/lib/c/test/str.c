@@ -114,4 +114,170 @@ PCUT_TEST(str_str_empty_n)
 	PCUT_ASSERT_TRUE((const char *)p == hs);
 }
 
+/** Long string with non-ASCII characters and invalid sequences */
+static const char *mixed_str(void)
+{
+	size_t i;
+
+	/* Plain ASCII across several blocks */
+	for (i = 0; i < 40; i++)
+		buffer[i] = 'a' + i % 26;
+
+	/*
+	 * Two-byte character, truncated sequence, stray continuation byte,
+	 * overlong encoding of '/' and more ASCII (str_cpy() would replace
+	 * the invalid sequences)
+	 */
+	memcpy(buffer + 40, "\xc5\xa1xyz\xc5" "A\x80" "B" "\xc0\xaf"
+	    "qrstuvwxyz0123456789", 32);
+	return buffer;
+}
+
+PCUT_TEST(size_length)
+{
+	const char *s = mixed_str();
+
+	PCUT_ASSERT_INT_EQUALS(71, str_size(s));
+	PCUT_ASSERT_INT_EQUALS(10, str_nsize(s, 10));
+	PCUT_ASSERT_INT_EQUALS(71, str_nsize(s, 100));
+
+	/* 40 + 1 + 3 + 1 + 1 + 1 + 1 + 1 (overlong) + 20 */
+	PCUT_ASSERT_INT_EQUALS(69, str_length(s));
+	PCUT_ASSERT_INT_EQUALS(41, str_nlength(s, 42));
+	PCUT_ASSERT_INT_EQUALS(40, str_nlength(s, 40));
+	PCUT_ASSERT_INT_EQUALS(0, str_length(""));
+}
+
+PCUT_TEST(decode_invalid)
+{
+	size_t off;
+
+	/* Truncated sequence must not consume the terminator */
+	off = 0;
+	PCUT_ASSERT_INT_EQUALS(U_SPECIAL, str_decode("\xc5", &off, 2));
+	PCUT_ASSERT_INT_EQUALS(1, off);
+	PCUT_ASSERT_INT_EQUALS(0, str_decode("\xc5", &off, 2));
+
+	/* Overlong encoding */
+	off = 0;
+	PCUT_ASSERT_INT_EQUALS(U_SPECIAL, str_decode("\xe0\x80\xaf", &off, 3));
+	PCUT_ASSERT_INT_EQUALS(3, off);
+
+	/* Beyond the Unicode range */
+	off = 0;
+	PCUT_ASSERT_INT_EQUALS(U_SPECIAL,
+	    str_decode("\xf4\x90\x80\x80", &off, 4));
+
+	off = 0;
+	PCUT_ASSERT_INT_EQUALS(0x10ffff,
+	    str_decode("\xf4\x8f\xbf\xbf", &off, 4));
+}
+
+PCUT_TEST(cmp_long)
+{
+	char s2[BUFFER_SIZE];
+	const char *s1 = mixed_str();
+
+	memcpy(s2, s1, BUFFER_SIZE);
+	PCUT_ASSERT_INT_EQUALS(0, str_cmp(s1, s2));
+	PCUT_ASSERT_TRUE(str_test_prefix(s1, s2));
+
+	s2[60] = 'a';
+	PCUT_ASSERT_INT_EQUALS(1, str_cmp(s1, s2));
+	PCUT_ASSERT_INT_EQUALS(-1, str_cmp(s2, s1));
+	PCUT_ASSERT_INT_EQUALS(0, str_lcmp(s1, s2, 58));
+	PCUT_ASSERT_INT_EQUALS(1, str_lcmp(s1, s2, 59));
+	PCUT_ASSERT_FALSE(str_test_prefix(s1, s2));
+
+	s2[60] = '\0';
+	PCUT_ASSERT_TRUE(str_test_prefix(s1, s2));
+	PCUT_ASSERT_INT_EQUALS(1, str_cmp(s1, s2));
+
+	s2[20] = 'U';
+	PCUT_ASSERT_INT_EQUALS(0, str_lcasecmp(s1, s2, 58));
+	PCUT_ASSERT_INT_EQUALS(1, str_casecmp(s1, s2));
+}
+
+PCUT_TEST(chr_rchr)
+{
+	const char *s = mixed_str();
+
+	PCUT_ASSERT_TRUE(str_chr(s, 'c') == s + 2);
+	PCUT_ASSERT_TRUE(str_rchr(s, 'c') == s + 28);
+	PCUT_ASSERT_TRUE(str_chr(s, 'z') == s + 25);
+	PCUT_ASSERT_TRUE(str_rchr(s, 'z') == s + 60);
+	PCUT_ASSERT_TRUE(str_chr(s, L'š') == s + 40);
+	PCUT_ASSERT_TRUE(str_rchr(s, L'š') == s + 40);
+	PCUT_ASSERT_TRUE(str_chr(s, '9') == s + 70);
+	PCUT_ASSERT_TRUE(str_chr(s, '/') == NULL);
+	PCUT_ASSERT_TRUE(str_chr(s, 0) == NULL);
+
+	/* Invalid sequences decode as U_SPECIAL */
+	PCUT_ASSERT_TRUE(str_chr(s, U_SPECIAL) == s + 45);
+	PCUT_ASSERT_TRUE(str_rchr(s, U_SPECIAL) == s + 49);
+}
+
+PCUT_TEST(to_wstr)
+{
+	char32_t wbuf[80];
+	const char *s = mixed_str();
+
+	str_to_wstr(wbuf, 80, s);
+	PCUT_ASSERT_INT_EQUALS('a', wbuf[0]);
+	PCUT_ASSERT_INT_EQUALS('n', wbuf[39]);
+	PCUT_ASSERT_INT_EQUALS(L'š', wbuf[40]);
+	PCUT_ASSERT_INT_EQUALS('x', wbuf[41]);
+	PCUT_ASSERT_INT_EQUALS(U_SPECIAL, wbuf[44]);
+	PCUT_ASSERT_INT_EQUALS('A', wbuf[45]);
+	PCUT_ASSERT_INT_EQUALS(U_SPECIAL, wbuf[46]);
+	PCUT_ASSERT_INT_EQUALS('B', wbuf[47]);
+	PCUT_ASSERT_INT_EQUALS(U_SPECIAL, wbuf[48]);
+	PCUT_ASSERT_INT_EQUALS('q', wbuf[49]);
+	PCUT_ASSERT_INT_EQUALS('9', wbuf[68]);
+	PCUT_ASSERT_INT_EQUALS(0, wbuf[69]);
+
+	/* Truncated output */
+	str_to_wstr(wbuf, 11, s);
+	PCUT_ASSERT_INT_EQUALS('j', wbuf[9]);
+	PCUT_ASSERT_INT_EQUALS(0, wbuf[10]);
+}
+
+/** Compare ASCII strings at all alignments, differing at every position. */
+PCUT_TEST(cmp_words)
+{
+	char s1[80];
+	char s2[80];
+	size_t a, b, i;
+
+	for (a = 0; a < 8; a++) {
+		for (b = 0; b < 8; b++) {
+			memset(s1, 0, sizeof(s1));
+			memset(s2, 0, sizeof(s2));
+			for (i = 0; i < 64; i++) {
+				s1[a + i] = 'A' + i % 26;
+				s2[b + i] = 'A' + i % 26;
+			}
+
+			PCUT_ASSERT_INT_EQUALS(0, str_cmp(s1 + a, s2 + b));
+			PCUT_ASSERT_INT_EQUALS(0, str_lcmp(s1 + a, s2 + b, 64));
+
+			for (i = 0; i < 64; i++) {
+				s2[b + i] = 'a';
+				PCUT_ASSERT_INT_EQUALS(-1, str_cmp(s1 + a, s2 + b));
+				PCUT_ASSERT_INT_EQUALS(1, str_cmp(s2 + b, s1 + a));
+				PCUT_ASSERT_INT_EQUALS(0,
+				    str_lcmp(s1 + a, s2 + b, i));
+				PCUT_ASSERT_INT_EQUALS(-1,
+				    str_lcmp(s1 + a, s2 + b, i + 1));
+				s2[b + i] = 'A' + i % 26;
+			}
+
+			/* Shorter string compares as smaller */
+			s2[b + 63] = '\0';
+			PCUT_ASSERT_INT_EQUALS(1, str_cmp(s1 + a, s2 + b));
+			PCUT_ASSERT_TRUE(str_test_prefix(s1 + a, s2 + b));
+		}
+	}
+}
+
 PCUT_EXPORT(str);
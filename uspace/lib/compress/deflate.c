@@ -0,0 +1,1176 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file
+ * @brief Implementation of deflate compression
+ *
+ * A compressor producing a `deflate' stream as described by RFC 1951.
+ * Repeated strings are found using hash chains. How hard the compressor
+ * searches for matches is given by the compression level: levels 1 to 3
+ * take the first good match (greedy parsing), levels 4 to 9 check
+ * whether a match starting one byte later is longer (lazy evaluation)
+ * and examine longer hash chains. Level 0 only stores the data.
+ *
+ * Each block is coded with whichever of a dynamic Huffman code, the fixed
+ * Huffman code or plain storing gives the smallest output. The sizes are
+ * computed exactly from the symbol frequencies before the block is written.
+ *
+ * Matches are only searched for in the data passed to a single call
+ * of deflate_compress(), no history is kept between calls. This makes
+ * each call independent, but still allows producing one long stream
+ * from many calls, as required e.g. by the RFB ZRLE encoding or by
+ * a streaming GZIP writer.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <macros.h>
+#include <mem.h>
+#include "deflate.h"
+
+/** Window size */
+#define WSIZE  32768
+/** Window mask */
+#define WMASK  (WSIZE - 1)
+
+/** Number of bits of the hash of the first bytes of a match */
+#define HASH_BITS  15
+/** Hash table size */
+#define HASH_SIZE  (1 << HASH_BITS)
+
+/** Minimum length of match */
+#define MIN_MATCH  3
+/** Maximum length of match */
+#define MAX_MATCH  258
+/** Matches of minimum length farther than this are not worth coding */
+#define TOO_FAR  4096
+
+/** Maximum size of input data coded in one block (limit of stored block) */
+#define MAX_BLOCK  65535
+/** Maximum number of symbols in one block */
+#define SYM_BUF  16384
+
+/** Number of length codes */
+#define MAX_LEN   29
+/** Number of distance codes */
+#define MAX_DIST  30
+
+/** Number of literal/length symbols (including the two unused ones) */
+#define NUM_LITLEN  288
+/** Number of literal/length symbols that can appear in a stream */
+#define NUM_LITLEN_USED  286
+/** Number of code length symbols */
+#define NUM_CLEN  19
+/** End of block symbol */
+#define END_BLOCK  256
+
+/** Maximum length of literal/length and distance codes */
+#define MAX_BITS  15
+/** Maximum length of code length codes */
+#define MAX_CLEN_BITS  7
+
+/** Match finder parameters for one compression level */
+typedef struct {
+	/** Maximum number of hash chain entries to examine */
+	uint16_t chain;
+	/** Examine only a quarter of the chain once we have a match this long */
+	uint16_t good;
+	/**
+	 * Lazy evaluation: try a later match only if the current one is
+	 * shorter than this. Greedy parsing: do not insert strings inside
+	 * matches longer than this.
+	 */
+	uint16_t lazy;
+	/** Stop searching once we have a match this long */
+	uint16_t nice;
+	/** Use lazy evaluation */
+	bool lazy_match;
+} deflate_config_t;
+
+/** Match finder parameters for levels 0 to 9 */
+static const deflate_config_t deflate_configs[DEFLATE_LEVEL_MAX + 1] = {
+	{ 0, 0, 0, 0, false },
+	{ 4, 4, 4, 8, false },
+	{ 8, 4, 5, 16, false },
+	{ 32, 4, 6, 32, false },
+	{ 16, 4, 4, 16, true },
+	{ 32, 8, 16, 32, true },
+	{ 128, 8, 16, 128, true },
+	{ 256, 8, 32, 128, true },
+	{ 1024, 32, 128, 258, true },
+	{ 4096, 32, 258, 258, true }
+};
+
+/** Huffman code used for writing */
+typedef struct {
+	/** Codes, bit-reversed so that they can be written LSB first */
+	uint16_t code[NUM_LITLEN];
+	/** Code lengths (zero for unused symbols) */
+	uint8_t len[NUM_LITLEN];
+} deflate_huff_t;
+
+/** Deflate compressor state
+ *
+ * Positions in the hash chains are stored as @c base + position + 1,
+ * so that entries from previous calls need not be cleared. Values
+ * less than or equal to @c base are stale.
+ *
+ */
+struct deflate {
+	uint8_t *dest;    /**< Output buffer */
+	size_t destlen;   /**< Output buffer size */
+	size_t destcnt;   /**< Position in the output buffer */
+
+	uint32_t bitbuf;  /**< Bit buffer */
+	size_t bitlen;    /**< Number of bits in the bit buffer */
+
+	bool overrun;     /**< Overrun condition */
+
+	unsigned level;                  /**< Compression level */
+	const deflate_config_t *config;  /**< Match finder parameters */
+
+	uint32_t base;    /**< Base of positions in hash chains */
+
+	uint32_t head[HASH_SIZE];  /**< Most recent position for each hash */
+	uint32_t prev[WSIZE];      /**< Previous position with the same hash */
+
+	size_t nsyms;                /**< Number of symbols in current block */
+	uint16_t sym_len[SYM_BUF];   /**< Literal or match length */
+	uint16_t sym_dist[SYM_BUF];  /**< Match distance or 0 for literal */
+
+	uint32_t litlen_freq[NUM_LITLEN];  /**< Literal/length frequencies */
+	uint32_t dist_freq[MAX_DIST];      /**< Distance code frequencies */
+
+	uint8_t len_code[MAX_MATCH - MIN_MATCH + 1];  /**< Length to code */
+	uint8_t dist_code[512];  /**< Distance to code, see get_dist_code() */
+
+	deflate_huff_t fixed_litlen;  /**< Fixed literal/length code */
+	deflate_huff_t fixed_dist;    /**< Fixed distance code */
+	deflate_huff_t dyn_litlen;    /**< Dynamic literal/length code */
+	deflate_huff_t dyn_dist;      /**< Dynamic distance code */
+	deflate_huff_t clen;          /**< Code length code */
+};
+
+/** Length codes
+ *
+ */
+static const uint16_t lens[MAX_LEN] = {
+	3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+	35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+
+/** Extended length codes
+ *
+ */
+static const uint16_t lens_ext[MAX_LEN] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+	3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+
+/** Distance codes
+ *
+ */
+static const uint16_t dists[MAX_DIST] = {
+	1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+	257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+	8193, 12289, 16385, 24577
+};
+
+/** Extended distance codes
+ *
+ */
+static const uint16_t dists_ext[MAX_DIST] = {
+	0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+	7, 7, 8, 8, 9, 9, 10, 10, 11, 11,
+	12, 12, 13, 13
+};
+
+/** Order of code length code lengths in the block header
+ *
+ */
+static const uint8_t clen_order[NUM_CLEN] = {
+	16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+
+/** Number of extra bits of code length symbols 16, 17 and 18
+ *
+ */
+static const uint8_t clen_ext[3] = { 2, 3, 7 };
+
+/** Reverse bits of a code
+ *
+ * @param code Code
+ * @param len  Code length
+ *
+ * @return Code with the order of the lowest @a len bits reversed
+ *
+ */
+static uint16_t bit_reverse(uint16_t code, size_t len)
+{
+	uint16_t rev = 0;
+
+	for (size_t i = 0; i < len; i++) {
+		rev = (rev << 1) | (code & 1);
+		code >>= 1;
+	}
+
+	return rev;
+}
+
+/** Assign canonical Huffman codes to code lengths
+ *
+ * @param huff Huffman code with code lengths filled in
+ * @param n    Number of symbols
+ *
+ */
+static void huff_codes(deflate_huff_t *huff, size_t n)
+{
+	uint16_t count[MAX_BITS + 1];
+	uint16_t next[MAX_BITS + 1];
+	uint16_t code = 0;
+	size_t i;
+
+	memset(count, 0, sizeof(count));
+	for (i = 0; i < n; i++)
+		count[huff->len[i]]++;
+
+	count[0] = 0;
+	for (i = 1; i <= MAX_BITS; i++) {
+		code = (code + count[i - 1]) << 1;
+		next[i] = code;
+	}
+
+	for (i = 0; i < n; i++) {
+		if (huff->len[i] != 0) {
+			huff->code[i] = bit_reverse(next[huff->len[i]]++,
+			    huff->len[i]);
+		}
+	}
+}
+
+/** Compare sort keys of Huffman symbols
+ *
+ */
+static int huff_key_cmp(const void *a, const void *b)
+{
+	uint32_t ka = *(const uint32_t *) a;
+	uint32_t kb = *(const uint32_t *) b;
+
+	return ka < kb ? -1 : (ka > kb ? 1 : 0);
+}
+
+/** Build length-limited Huffman code
+ *
+ * Optimal code lengths are computed in place using the algorithm of
+ * Moffat and Katajainen. Lengths exceeding @a maxbits are then clamped
+ * and the Kraft inequality is restored by lengthening the codes of
+ * the least frequent symbols.
+ *
+ * The resulting code is always complete. If fewer than two symbols are
+ * used, unused symbols are added, as a one-symbol code is not complete.
+ *
+ * @param huff    Huffman code to build
+ * @param freq    Symbol frequencies (less than 65536 each)
+ * @param n       Number of symbols
+ * @param maxbits Maximum code length
+ *
+ */
+static void huff_build(deflate_huff_t *huff, const uint32_t *freq,
+    size_t n, size_t maxbits)
+{
+	uint32_t key[NUM_LITLEN];
+	uint32_t a[NUM_LITLEN] = { 0 };
+	size_t count[MAX_BITS + 1];
+	uint32_t total;
+	size_t nsyms = 0;
+	size_t i, j, b;
+	int root, leaf, next, avbl, used, depth;
+
+	memset(huff->len, 0, n);
+
+	/* Sort used symbols by frequency */
+	for (i = 0; i < n; i++) {
+		if (freq[i] != 0)
+			key[nsyms++] = (freq[i] << 16) | i;
+	}
+
+	for (i = 0; i < n && nsyms < 2; i++) {
+		if (freq[i] == 0)
+			key[nsyms++] = i;
+	}
+
+	qsort(key, nsyms, sizeof(uint32_t), huff_key_cmp);
+
+	for (i = 0; i < nsyms; i++)
+		a[i] = key[i] >> 16;
+
+	/* Combine the two lightest nodes into internal nodes */
+	a[0] += a[1];
+	root = 0;
+	leaf = 2;
+	for (next = 1; next < (int) nsyms - 1; next++) {
+		if (leaf >= (int) nsyms || a[root] < a[leaf]) {
+			a[next] = a[root];
+			a[root++] = next;
+		} else {
+			a[next] = a[leaf++];
+		}
+
+		if (leaf >= (int) nsyms || (root < next && a[root] < a[leaf])) {
+			a[next] += a[root];
+			a[root++] = next;
+		} else {
+			a[next] += a[leaf++];
+		}
+	}
+
+	/* Depths of internal nodes */
+	a[nsyms - 2] = 0;
+	for (next = (int) nsyms - 3; next >= 0; next--)
+		a[next] = a[a[next]] + 1;
+
+	/* Depths of leaves */
+	avbl = 1;
+	used = 0;
+	depth = 0;
+	root = (int) nsyms - 2;
+	next = (int) nsyms - 1;
+	while (avbl > 0) {
+		while (root >= 0 && (int) a[root] == depth) {
+			used++;
+			root--;
+		}
+
+		while (avbl > used) {
+			a[next--] = depth;
+			avbl--;
+		}
+
+		avbl = 2 * used;
+		depth++;
+		used = 0;
+	}
+
+	/* Limit code lengths */
+	memset(count, 0, sizeof(count));
+	for (i = 0; i < nsyms; i++)
+		count[a[i] > maxbits ? maxbits : a[i]]++;
+
+	total = 0;
+	for (b = 1; b <= maxbits; b++)
+		total += (uint32_t) count[b] << (maxbits - b);
+
+	while (total > ((uint32_t) 1 << maxbits)) {
+		count[maxbits]--;
+		for (b = maxbits - 1; b > 0; b--) {
+			if (count[b] != 0) {
+				count[b]--;
+				count[b + 1] += 2;
+				break;
+			}
+		}
+
+		total--;
+	}
+
+	/* Least frequent symbols get the longest codes */
+	i = 0;
+	for (b = maxbits; b > 0; b--) {
+		for (j = 0; j < count[b]; j++)
+			huff->len[key[i++] & 0xffff] = b;
+	}
+
+	huff_codes(huff, n);
+}
+
+/** Create deflate compressor.
+ *
+ * The compressor is created with the default compression level.
+ *
+ * @param rdeflate Place to store pointer to new compressor
+ *
+ * @return EOK on success, ENOMEM if out of memory
+ *
+ */
+errno_t deflate_create(deflate_t **rdeflate)
+{
+	deflate_t *deflate;
+	size_t code;
+	size_t i;
+
+	deflate = calloc(1, sizeof(deflate_t));
+	if (deflate == NULL)
+		return ENOMEM;
+
+	deflate->level = DEFLATE_LEVEL_DEFAULT;
+	deflate->config = &deflate_configs[DEFLATE_LEVEL_DEFAULT];
+
+	/* Length 258 has its own code */
+	for (code = 0; code < MAX_LEN - 1; code++) {
+		for (i = 0; i < (1u << lens_ext[code]); i++)
+			deflate->len_code[lens[code] + i - MIN_MATCH] = code;
+	}
+
+	deflate->len_code[MAX_MATCH - MIN_MATCH] = MAX_LEN - 1;
+
+	for (code = 0; code < MAX_DIST; code++) {
+		for (i = 0; i < (1u << dists_ext[code]); i++) {
+			if (dists[code] + i <= 256)
+				deflate->dist_code[dists[code] + i - 1] = code;
+			else
+				deflate->dist_code[256 + ((dists[code] + i - 1) >> 7)] = code;
+		}
+	}
+
+	/* Fixed codes (RFC 1951, 3.2.6) */
+	for (i = 0; i < NUM_LITLEN; i++) {
+		if (i < 144)
+			deflate->fixed_litlen.len[i] = 8;
+		else if (i < 256)
+			deflate->fixed_litlen.len[i] = 9;
+		else if (i < 280)
+			deflate->fixed_litlen.len[i] = 7;
+		else
+			deflate->fixed_litlen.len[i] = 8;
+	}
+
+	huff_codes(&deflate->fixed_litlen, NUM_LITLEN);
+
+	for (i = 0; i < MAX_DIST; i++)
+		deflate->fixed_dist.len[i] = 5;
+
+	huff_codes(&deflate->fixed_dist, MAX_DIST);
+
+	*rdeflate = deflate;
+	return EOK;
+}
+
+/** Destroy deflate compressor.
+ *
+ * @param deflate Compressor or @c NULL
+ *
+ */
+void deflate_destroy(deflate_t *deflate)
+{
+	free(deflate);
+}
+
+/** Set compression level.
+ *
+ * The level can be changed between calls of deflate_compress(), it takes
+ * effect with the next call.
+ *
+ * @param deflate Compressor
+ * @param level   Compression level (DEFLATE_LEVEL_NONE to
+ *                DEFLATE_LEVEL_MAX)
+ *
+ * @return EOK on success, EINVAL if the level is out of range
+ *
+ */
+errno_t deflate_set_level(deflate_t *deflate, unsigned level)
+{
+	if (level > DEFLATE_LEVEL_MAX)
+		return EINVAL;
+
+	deflate->level = level;
+	deflate->config = &deflate_configs[level];
+	return EOK;
+}
+
+/** Get maximum size of compressed data.
+ *
+ * @param srclen Size of uncompressed data
+ *
+ * @return Output buffer size that is always sufficient for
+ *         deflate_compress() with @a srclen bytes of input
+ *
+ */
+size_t deflate_bound(size_t srclen)
+{
+	/*
+	 * No block is larger than storing its data. Every block but the
+	 * last one of a call covers at least SYM_BUF bytes.
+	 */
+	return srclen + 6 * (srclen / SYM_BUF + 2);
+}
+
+/** Write byte to output
+ *
+ * @param state Compressor state
+ * @param byte  Byte to write
+ *
+ */
+static void put_byte(deflate_t *state, uint8_t byte)
+{
+	if (state->destcnt >= state->destlen) {
+		state->overrun = true;
+		return;
+	}
+
+	state->dest[state->destcnt++] = byte;
+}
+
+/** Write bits to output
+ *
+ * @param state Compressor state
+ * @param bits  Bits to write (least significant bit first)
+ * @param cnt   Number of bits to write (at most 16)
+ *
+ */
+static void put_bits(deflate_t *state, uint32_t bits, size_t cnt)
+{
+	state->bitbuf |= bits << state->bitlen;
+	state->bitlen += cnt;
+
+	while (state->bitlen >= 8) {
+		put_byte(state, state->bitbuf & 0xff);
+		state->bitbuf >>= 8;
+		state->bitlen -= 8;
+	}
+}
+
+/** Pad output to byte boundary
+ *
+ * @param state Compressor state
+ *
+ */
+static void put_align(deflate_t *state)
+{
+	if (state->bitlen > 0)
+		put_bits(state, 0, 8 - state->bitlen);
+}
+
+/** Write symbol using a Huffman code
+ *
+ * @param state Compressor state
+ * @param huff  Huffman code
+ * @param sym   Symbol
+ *
+ */
+static void put_sym(deflate_t *state, const deflate_huff_t *huff,
+    size_t sym)
+{
+	put_bits(state, huff->code[sym], huff->len[sym]);
+}
+
+/** Get distance code
+ *
+ * Distances up to 256 are looked up directly, longer distances by
+ * their upper bits, as all distance codes above 256 start at
+ * a multiple of 128 (plus one).
+ *
+ * @param state Compressor state
+ * @param dist  Match distance
+ *
+ * @return Distance code
+ *
+ */
+static size_t get_dist_code(deflate_t *state, size_t dist)
+{
+	if (dist <= 256)
+		return state->dist_code[dist - 1];
+
+	return state->dist_code[256 + ((dist - 1) >> 7)];
+}
+
+/** Compute hash of the first bytes of a potential match
+ *
+ * @param p Pointer to at least MIN_MATCH bytes
+ *
+ * @return Hash
+ *
+ */
+static size_t hash3(const uint8_t *p)
+{
+	return ((p[0] << 10) ^ (p[1] << 5) ^ p[2]) & (HASH_SIZE - 1);
+}
+
+/** Insert positions into hash chains
+ *
+ * @param state  Compressor state
+ * @param src    Input data
+ * @param srclen Input data size
+ * @param ins    Next position to insert, updated
+ * @param end    Insert positions up to (excluding) this one
+ *
+ */
+static void insert_upto(deflate_t *state, const uint8_t *src, size_t srclen,
+    size_t *ins, size_t end)
+{
+	size_t pos;
+	size_t h;
+
+	if (end + MIN_MATCH > srclen)
+		end = srclen >= MIN_MATCH ? srclen - MIN_MATCH + 1 : 0;
+
+	for (pos = *ins; pos < end; pos++) {
+		h = hash3(src + pos);
+		state->prev[pos & WMASK] = state->head[h];
+		state->head[h] = state->base + pos + 1;
+	}
+
+	if (pos > *ins)
+		*ins = pos;
+}
+
+/** Load 64 bits from unaligned memory
+ *
+ */
+static uint64_t load64(const uint8_t *p)
+{
+	uint64_t v;
+
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+/** Find longest match for string at a position
+ *
+ * @param state  Compressor state
+ * @param src    Input data
+ * @param pos    Position of the string
+ * @param maxlen Maximum match length
+ * @param chain  Maximum number of hash chain entries to examine
+ * @param rdist  Place to store distance of the match
+ *
+ * @return Match length (zero if there is no usable match)
+ *
+ */
+static size_t find_match(deflate_t *state, const uint8_t *src, size_t pos,
+    size_t maxlen, size_t chain, size_t *rdist)
+{
+	size_t nice = state->config->nice;
+	size_t best_len = 0;
+	size_t best_dist = 0;
+	const uint8_t *p;
+	const uint8_t *c;
+	uint32_t cand;
+	size_t cpos;
+	size_t len;
+
+	if (maxlen < MIN_MATCH)
+		return 0;
+
+	if (nice > maxlen)
+		nice = maxlen;
+
+	p = src + pos;
+
+	cand = state->head[hash3(p)];
+
+	/* The position itself may already be in the chain */
+	if (cand == state->base + pos + 1)
+		cand = state->prev[pos & WMASK];
+
+	while (cand > state->base && chain-- > 0) {
+		cpos = cand - state->base - 1;
+		if (pos - cpos > WSIZE)
+			break;
+
+		c = src + cpos;
+		if (c[best_len] == p[best_len] && c[0] == p[0]) {
+			len = 0;
+			while (len + 8 <= maxlen && load64(c + len) == load64(p + len))
+				len += 8;
+			while (len < maxlen && c[len] == p[len])
+				len++;
+
+			if (len > best_len) {
+				best_len = len;
+				best_dist = pos - cpos;
+				if (len >= nice)
+					break;
+			}
+		}
+
+		cand = state->prev[cpos & WMASK];
+	}
+
+	if (best_len < MIN_MATCH ||
+	    (best_len == MIN_MATCH && best_dist > TOO_FAR))
+		return 0;
+
+	*rdist = best_dist;
+	return best_len;
+}
+
+/** Record literal in current block
+ *
+ * @param state Compressor state
+ * @param lit   Literal byte
+ *
+ */
+static void record_lit(deflate_t *state, uint8_t lit)
+{
+	state->sym_len[state->nsyms] = lit;
+	state->sym_dist[state->nsyms] = 0;
+	state->nsyms++;
+	state->litlen_freq[lit]++;
+}
+
+/** Record match in current block
+ *
+ * @param state Compressor state
+ * @param len   Match length
+ * @param dist  Match distance
+ *
+ */
+static void record_match(deflate_t *state, size_t len, size_t dist)
+{
+	state->sym_len[state->nsyms] = len;
+	state->sym_dist[state->nsyms] = dist;
+	state->nsyms++;
+	state->litlen_freq[257 + state->len_code[len - MIN_MATCH]]++;
+	state->dist_freq[get_dist_code(state, dist)]++;
+}
+
+/** Parse input data of one block into literals and matches
+ *
+ * The block ends when the symbol buffer is full, after MAX_BLOCK bytes
+ * of input or at the end of input, whichever comes first.
+ *
+ * @param state  Compressor state
+ * @param src    Input data
+ * @param srclen Input data size
+ * @param start  Start of block data in @a src
+ * @param ins    Next position to insert into hash chains, updated
+ *
+ * @return End of block data in @a src
+ *
+ */
+static size_t deflate_parse(deflate_t *state, const uint8_t *src,
+    size_t srclen, size_t start, size_t *ins)
+{
+	const deflate_config_t *config = state->config;
+	size_t limit;
+	size_t pos;
+	size_t len = 0;
+	size_t dist = 0;
+	size_t nlen;
+	size_t ndist;
+	size_t chain;
+	bool have = false;
+
+	limit = srclen - start > MAX_BLOCK ? start + MAX_BLOCK : srclen;
+
+	state->nsyms = 0;
+	memset(state->litlen_freq, 0, sizeof(state->litlen_freq));
+	memset(state->dist_freq, 0, sizeof(state->dist_freq));
+
+	pos = start;
+	while (pos < limit && state->nsyms < SYM_BUF) {
+		if (!have) {
+			insert_upto(state, src, srclen, ins, pos);
+			len = find_match(state, src, pos,
+			    min(limit - pos, MAX_MATCH), config->chain, &dist);
+		}
+
+		have = false;
+
+		if (len == 0) {
+			record_lit(state, src[pos]);
+			pos++;
+			continue;
+		}
+
+		if (config->lazy_match && len < config->lazy &&
+		    pos + 1 < limit) {
+			/* Is there a longer match at the next position? */
+			chain = len >= config->good ? config->chain / 4 :
+			    config->chain;
+
+			insert_upto(state, src, srclen, ins, pos + 1);
+			nlen = find_match(state, src, pos + 1,
+			    min(limit - pos - 1, MAX_MATCH), chain, &ndist);
+
+			if (nlen > len) {
+				record_lit(state, src[pos]);
+				pos++;
+				len = nlen;
+				dist = ndist;
+				have = true;
+				continue;
+			}
+		}
+
+		record_match(state, len, dist);
+
+		if (!config->lazy_match && len > config->lazy) {
+			/* Do not spend time indexing inside long matches */
+			insert_upto(state, src, srclen, ins, pos + 1);
+			if (*ins < pos + len)
+				*ins = pos + len;
+		}
+
+		pos += len;
+	}
+
+	return pos;
+}
+
+/** Encode code lengths of literal/length and distance codes
+ *
+ * The code lengths are run-length encoded using code length symbols
+ * 16 (repeat previous), 17 and 18 (repeat zero).
+ *
+ * @param lens  Code lengths
+ * @param n     Number of code lengths
+ * @param syms  Array to store code length symbols
+ * @param extra Array to store extra bits of the symbols
+ * @param freq  Array of NUM_CLEN frequencies to fill in
+ *
+ * @return Number of code length symbols
+ *
+ */
+static size_t clen_encode(const uint8_t *lens, size_t n, uint8_t *syms,
+    uint8_t *extra, uint32_t *freq)
+{
+	size_t nsyms = 0;
+	size_t i = 0;
+	size_t run;
+	size_t r;
+	uint8_t cur;
+
+	memset(freq, 0, NUM_CLEN * sizeof(uint32_t));
+
+	while (i < n) {
+		cur = lens[i];
+		run = 1;
+		while (i + run < n && lens[i + run] == cur)
+			run++;
+
+		i += run;
+
+		if (cur == 0) {
+			while (run >= 3) {
+				r = min(run, 138);
+				syms[nsyms] = r >= 11 ? 18 : 17;
+				extra[nsyms] = r >= 11 ? r - 11 : r - 3;
+				freq[syms[nsyms++]]++;
+				run -= r;
+			}
+		} else {
+			syms[nsyms] = cur;
+			extra[nsyms] = 0;
+			freq[syms[nsyms++]]++;
+			run--;
+
+			while (run >= 3) {
+				r = min(run, 6);
+				syms[nsyms] = 16;
+				extra[nsyms] = r - 3;
+				freq[syms[nsyms++]]++;
+				run -= r;
+			}
+		}
+
+		while (run > 0) {
+			syms[nsyms] = cur;
+			extra[nsyms] = 0;
+			freq[syms[nsyms++]]++;
+			run--;
+		}
+	}
+
+	return nsyms;
+}
+
+/** Compute size of block data coded with given Huffman codes
+ *
+ * @param state  Compressor state
+ * @param litlen Literal/length code
+ * @param dist   Distance code
+ *
+ * @return Size in bits (without block header)
+ *
+ */
+static size_t block_data_bits(deflate_t *state, const deflate_huff_t *litlen,
+    const deflate_huff_t *dist)
+{
+	size_t bits = 0;
+	size_t i;
+
+	for (i = 0; i < NUM_LITLEN_USED; i++) {
+		bits += state->litlen_freq[i] * litlen->len[i];
+		if (i > END_BLOCK)
+			bits += state->litlen_freq[i] * lens_ext[i - 257];
+	}
+
+	for (i = 0; i < MAX_DIST; i++)
+		bits += state->dist_freq[i] * (dist->len[i] + dists_ext[i]);
+
+	return bits;
+}
+
+/** Write symbols of current block
+ *
+ * @param state  Compressor state
+ * @param litlen Literal/length code
+ * @param dist   Distance code
+ *
+ */
+static void put_block_data(deflate_t *state, const deflate_huff_t *litlen,
+    const deflate_huff_t *dist)
+{
+	size_t len;
+	size_t d;
+	size_t code;
+	size_t i;
+
+	for (i = 0; i < state->nsyms && !state->overrun; i++) {
+		len = state->sym_len[i];
+		d = state->sym_dist[i];
+
+		if (d == 0) {
+			put_sym(state, litlen, len);
+			continue;
+		}
+
+		code = state->len_code[len - MIN_MATCH];
+		put_sym(state, litlen, 257 + code);
+		put_bits(state, len - lens[code], lens_ext[code]);
+
+		code = get_dist_code(state, d);
+		put_sym(state, dist, code);
+		put_bits(state, d - dists[code], dists_ext[code]);
+	}
+
+	put_sym(state, litlen, END_BLOCK);
+}
+
+/** Write stored block
+ *
+ * @param state Compressor state
+ * @param src   Input data
+ * @param start Start of block data in @a src
+ * @param end   End of block data in @a src
+ * @param last  Last block flag
+ *
+ */
+static void deflate_stored(deflate_t *state, const uint8_t *src,
+    size_t start, size_t end, bool last)
+{
+	size_t len = end - start;
+
+	put_bits(state, last ? 1 : 0, 1);
+	put_bits(state, 0, 2);
+	put_align(state);
+
+	put_byte(state, len & 0xff);
+	put_byte(state, (len >> 8) & 0xff);
+	put_byte(state, ~len & 0xff);
+	put_byte(state, (~len >> 8) & 0xff);
+
+	if (state->destlen - state->destcnt < len) {
+		state->overrun = true;
+		return;
+	}
+
+	memcpy(state->dest + state->destcnt, src + start, len);
+	state->destcnt += len;
+}
+
+/** Write block in the smallest of the three possible codings
+ *
+ * @param state Compressor state
+ * @param src   Input data
+ * @param start Start of block data in @a src
+ * @param end   End of block data in @a src
+ * @param last  Last block flag
+ *
+ */
+static void deflate_block(deflate_t *state, const uint8_t *src,
+    size_t start, size_t end, bool last)
+{
+	uint8_t lens[NUM_LITLEN_USED + MAX_DIST];
+	uint8_t syms[NUM_LITLEN_USED + MAX_DIST];
+	uint8_t extra[NUM_LITLEN_USED + MAX_DIST];
+	uint32_t clen_freq[NUM_CLEN];
+	size_t stored_bits;
+	size_t fixed_bits;
+	size_t dyn_bits;
+	size_t nlitlen;
+	size_t ndist;
+	size_t nclen;
+	size_t nsyms;
+	size_t i;
+
+	state->litlen_freq[END_BLOCK] = 1;
+
+	/* Build dynamic codes and their description */
+	huff_build(&state->dyn_litlen, state->litlen_freq, NUM_LITLEN_USED,
+	    MAX_BITS);
+	huff_build(&state->dyn_dist, state->dist_freq, MAX_DIST, MAX_BITS);
+
+	nlitlen = NUM_LITLEN_USED;
+	while (nlitlen > 257 && state->dyn_litlen.len[nlitlen - 1] == 0)
+		nlitlen--;
+
+	ndist = MAX_DIST;
+	while (ndist > 1 && state->dyn_dist.len[ndist - 1] == 0)
+		ndist--;
+
+	memcpy(lens, state->dyn_litlen.len, nlitlen);
+	memcpy(lens + nlitlen, state->dyn_dist.len, ndist);
+
+	nsyms = clen_encode(lens, nlitlen + ndist, syms, extra, clen_freq);
+	huff_build(&state->clen, clen_freq, NUM_CLEN, MAX_CLEN_BITS);
+
+	nclen = NUM_CLEN;
+	while (nclen > 4 && state->clen.len[clen_order[nclen - 1]] == 0)
+		nclen--;
+
+	/* Sizes of the three codings */
+	dyn_bits = 3 + 5 + 5 + 4 + 3 * nclen +
+	    block_data_bits(state, &state->dyn_litlen, &state->dyn_dist);
+	for (i = 0; i < NUM_CLEN; i++) {
+		dyn_bits += clen_freq[i] * state->clen.len[i];
+		if (i >= 16)
+			dyn_bits += clen_freq[i] * clen_ext[i - 16];
+	}
+
+	fixed_bits = 3 +
+	    block_data_bits(state, &state->fixed_litlen, &state->fixed_dist);
+
+	stored_bits = 3 + (8 - (state->bitlen + 3) % 8) % 8 + 32 +
+	    8 * (end - start);
+
+	if (stored_bits <= fixed_bits && stored_bits <= dyn_bits) {
+		deflate_stored(state, src, start, end, last);
+	} else if (fixed_bits <= dyn_bits) {
+		put_bits(state, last ? 1 : 0, 1);
+		put_bits(state, 1, 2);
+		put_block_data(state, &state->fixed_litlen, &state->fixed_dist);
+	} else {
+		put_bits(state, last ? 1 : 0, 1);
+		put_bits(state, 2, 2);
+		put_bits(state, nlitlen - 257, 5);
+		put_bits(state, ndist - 1, 5);
+		put_bits(state, nclen - 4, 4);
+
+		for (i = 0; i < nclen; i++)
+			put_bits(state, state->clen.len[clen_order[i]], 3);
+
+		for (i = 0; i < nsyms; i++) {
+			put_sym(state, &state->clen, syms[i]);
+			if (syms[i] >= 16)
+				put_bits(state, extra[i], clen_ext[syms[i] - 16]);
+		}
+
+		put_block_data(state, &state->dyn_litlen, &state->dyn_dist);
+	}
+}
+
+/** Compress data
+ *
+ * With @c deflate_flush_none output may end in the middle of a byte.
+ * The remaining bits are kept and written by the next call, so that
+ * the output of consecutive calls can be concatenated. With
+ * @c deflate_flush_sync the output ends with an empty stored
+ * block so that everything compressed so far can be decoded, and further
+ * output can continue the same stream. With @c deflate_flush_finish
+ * the last block is marked as final.
+ *
+ * If the output buffer turns out to be too small, the stream cannot
+ * be continued.
+ *
+ * @param state   Compressor state
+ * @param src     Input data
+ * @param srclen  Input data size
+ * @param dest    Output buffer
+ * @param destlen Output buffer size (deflate_bound() is always enough)
+ * @param flush   What to do at the end of input
+ * @param rdlen   Place to store size of output data
+ *
+ * @return EOK on success, ELIMIT if output buffer is too small,
+ *         EINVAL if input is too large
+ *
+ */
+errno_t deflate_compress(deflate_t *state, const void *src, size_t srclen,
+    void *dest, size_t destlen, deflate_flush_t flush, size_t *rdlen)
+{
+	const uint8_t *sp = (const uint8_t *) src;
+	size_t start;
+	size_t end;
+	size_t ins;
+	bool last;
+
+	state->dest = (uint8_t *) dest;
+	state->destlen = destlen;
+	state->destcnt = 0;
+	state->overrun = false;
+
+	if (srclen > UINT32_MAX - WSIZE)
+		return EINVAL;
+
+	/* Positions from previous calls become stale */
+	if ((uint64_t) state->base + WSIZE + srclen > UINT32_MAX) {
+		memset(state->head, 0, sizeof(state->head));
+		state->base = 0;
+	} else {
+		state->base += WSIZE;
+	}
+
+	start = 0;
+	ins = 0;
+	while (start < srclen && !state->overrun) {
+		if (state->level == DEFLATE_LEVEL_NONE) {
+			end = srclen - start > MAX_BLOCK ? start + MAX_BLOCK :
+			    srclen;
+			last = (flush == deflate_flush_finish && end == srclen);
+			deflate_stored(state, sp, start, end, last);
+		} else {
+			end = deflate_parse(state, sp, srclen, start, &ins);
+			last = (flush == deflate_flush_finish && end == srclen);
+			deflate_block(state, sp, start, end, last);
+		}
+
+		start = end;
+	}
+
+	state->base += srclen;
+
+	if (flush == deflate_flush_finish) {
+		/* Empty input still needs a final block */
+		if (srclen == 0)
+			deflate_stored(state, sp, 0, 0, true);
+		put_align(state);
+	} else if (flush == deflate_flush_sync) {
+		/* Empty stored block ends on byte boundary */
+		deflate_stored(state, sp, 0, 0, false);
+	}
+
+	if (state->overrun)
+		return ELIMIT;
+
+	*rdlen = state->destcnt;
+	return EOK;
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LIBCOMPRESS_DEFLATE_H_
+#define LIBCOMPRESS_DEFLATE_H_
+
+#include <errno.h>
+#include <stddef.h>
+
+/** Deflate compressor state */
+typedef struct deflate deflate_t;
+
+/** Only store data, do not compress */
+#define DEFLATE_LEVEL_NONE     0
+/** Fastest compression */
+#define DEFLATE_LEVEL_FAST     1
+/** Default compression level */
+#define DEFLATE_LEVEL_DEFAULT  6
+/** Best compression */
+#define DEFLATE_LEVEL_MAX      9
+
+/** What to do at the end of input passed to deflate_compress() */
+typedef enum {
+	/** Keep the stream open, output may end in the middle of a byte */
+	deflate_flush_none,
+	/** Make all output decodable, but leave the stream open */
+	deflate_flush_sync,
+	/** Terminate the stream */
+	deflate_flush_finish
+} deflate_flush_t;
+
+extern errno_t deflate_create(deflate_t **);
+extern void deflate_destroy(deflate_t *);
+extern errno_t deflate_set_level(deflate_t *, unsigned);
+extern size_t deflate_bound(size_t);
+extern errno_t deflate_compress(deflate_t *, const void *, size_t, void *,
+    size_t, deflate_flush_t, size_t *);
+
+#endif
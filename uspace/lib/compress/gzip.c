@@ -26,12 +26,15 @@
  * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <adt/checksum.h>
+#include <assert.h>
 #include <stdint.h>
 #include <stddef.h>
 #include <errno.h>
 #include <mem.h>
 #include <byteorder.h>
 #include <stdlib.h>
+#include "deflate.h"
 #include "gzip.h"
 #include "inflate.h"
 
@@ -46,6 +49,11 @@
 #define GZIP_FLAG_FNAME     UINT8_C(1 << 3)
 #define GZIP_FLAG_FCOMMENT  UINT8_C(1 << 4)
 
+#define GZIP_XFL_MAX   UINT8_C(2)
+#define GZIP_XFL_FAST  UINT8_C(4)
+
+#define GZIP_OS_UNKNOWN  UINT8_C(255)
+
 typedef struct {
 	uint8_t id1;
 	uint8_t id2;
@@ -61,41 +69,55 @@ typedef struct {
 	uint32_t size;
 } __attribute__((packed)) gzip_footer_t;
 
-/** Expand GZIP compressed data
+static_assert(sizeof(gzip_header_t) == GZIP_HEADER_SIZE, "");
+static_assert(sizeof(gzip_footer_t) == GZIP_FOOTER_SIZE, "");
+
+/** Skip zero-terminated string in GZIP header
  *
- * The routine allocates the output buffer based
- * on the size encoded in the input stream. This
- * effectively limits the size of the uncompressed
- * data to 4 GiB (expanding input streams that actually
- * encode more data will always fail).
+ * @param src    Header data.
+ * @param srclen Size of header data.
+ * @param pos    Position of the string, updated to point past it.
  *
- * So far, no CRC is perfomed.
+ * @return EOK on success.
+ * @return ELIMIT if the string is not terminated within @a srclen.
+ *
+ */
+static errno_t gzip_skip_string(const uint8_t *src, size_t srclen,
+    size_t *pos)
+{
+	const uint8_t *end = memchr(src + *pos, 0, srclen - *pos);
+	if (end == NULL)
+		return ELIMIT;
+
+	*pos = end - src + 1;
+	return EOK;
+}
+
+/** Parse GZIP header
+ *
+ * Validates the GZIP header at the start of @a src and determines its
+ * size, i.e. the offset of the deflate stream.
  *
  * @param[in]  src     Source data buffer.
  * @param[in]  srclen  Source buffer size (bytes).
- * @param[out] dest    Destination data buffer.
- * @param[out] destlen Destination buffer size (bytes).
+ * @param[out] rhdrlen Place to store size of the header (bytes).
  *
  * @return EOK on success.
- * @return ENOENT on distance too large.
- * @return EINVAL on invalid Huffman code, invalid deflate data,
- *                   invalid compression method or invalid stream.
- * @return ELIMIT on input buffer overrun.
- * @return ENOMEM on output buffer overrun.
+ * @return EINVAL if the data is not a GZIP stream supported by us.
+ * @return ELIMIT if the header does not fit into @a srclen bytes.
  *
  */
-errno_t gzip_expand(void *src, size_t srclen, void **dest, size_t *destlen)
+errno_t gzip_parse_header(const void *src, size_t srclen, size_t *rhdrlen)
 {
+	const uint8_t *bsrc = (const uint8_t *) src;
 	gzip_header_t header;
-	gzip_footer_t footer;
-
-	if ((srclen < sizeof(header)) || (srclen < sizeof(footer)))
-		return EINVAL;
+	size_t pos;
+	errno_t rc;
 
-	/* Decode header and footer */
+	if (srclen < sizeof(header))
+		return ELIMIT;
 
 	memcpy(&header, src, sizeof(header));
-	memcpy(&footer, src + srclen - sizeof(footer), sizeof(footer));
 
 	if ((header.id1 != GZIP_ID1) ||
 	    (header.id2 != GZIP_ID2) ||
@@ -103,69 +125,111 @@ errno_t gzip_expand(void *src, size_t srclen, void **dest, size_t *destlen)
 	    ((header.flags & (~GZIP_FLAGS_MASK)) != 0))
 		return EINVAL;
 
-	*destlen = uint32_t_le2host(footer.size);
+	pos = sizeof(header);
 
 	/* Ignore extra metadata */
 
-	void *stream = src + sizeof(header);
-	size_t stream_length = srclen - sizeof(header) - sizeof(footer);
-
 	if ((header.flags & GZIP_FLAG_FEXTRA) != 0) {
 		uint16_t extra_length;
 
-		if (stream_length < sizeof(extra_length))
-			return EINVAL;
+		if (srclen - pos < sizeof(extra_length))
+			return ELIMIT;
 
-		memcpy(&extra_length, stream, sizeof(extra_length));
-		stream += sizeof(extra_length);
-		stream_length -= sizeof(extra_length);
+		memcpy(&extra_length, bsrc + pos, sizeof(extra_length));
+		pos += sizeof(extra_length);
 
-		if (stream_length < extra_length)
-			return EINVAL;
+		extra_length = uint16_t_le2host(extra_length);
+		if (srclen - pos < extra_length)
+			return ELIMIT;
 
-		stream += extra_length;
-		stream_length -= extra_length;
+		pos += extra_length;
 	}
 
 	if ((header.flags & GZIP_FLAG_FNAME) != 0) {
-		while (*((uint8_t *) stream) != 0) {
-			if (stream_length == 0)
-				return EINVAL;
+		rc = gzip_skip_string(bsrc, srclen, &pos);
+		if (rc != EOK)
+			return rc;
+	}
 
-			stream++;
-			stream_length--;
-		}
+	if ((header.flags & GZIP_FLAG_FCOMMENT) != 0) {
+		rc = gzip_skip_string(bsrc, srclen, &pos);
+		if (rc != EOK)
+			return rc;
+	}
 
-		if (stream_length == 0)
-			return EINVAL;
+	if ((header.flags & GZIP_FLAG_FHCRC) != 0) {
+		if (srclen - pos < 2)
+			return ELIMIT;
 
-		stream++;
-		stream_length--;
+		pos += 2;
 	}
 
-	if ((header.flags & GZIP_FLAG_FCOMMENT) != 0) {
-		while (*((uint8_t *) stream) != 0) {
-			if (stream_length == 0)
-				return EINVAL;
+	*rhdrlen = pos;
+	return EOK;
+}
 
-			stream++;
-			stream_length--;
-		}
+/** Parse GZIP footer
+ *
+ * @param[in]  src    Footer data (at least GZIP_FOOTER_SIZE bytes).
+ * @param[out] rcrc   Place to store CRC-32 of the uncompressed data.
+ * @param[out] rsize  Place to store size of the uncompressed data
+ *                    (modulo 2^32).
+ *
+ */
+void gzip_parse_footer(const void *src, uint32_t *rcrc, uint32_t *rsize)
+{
+	gzip_footer_t footer;
 
-		if (stream_length == 0)
-			return EINVAL;
+	memcpy(&footer, src, sizeof(footer));
 
-		stream++;
-		stream_length--;
-	}
+	*rcrc = uint32_t_le2host(footer.crc32);
+	*rsize = uint32_t_le2host(footer.size);
+}
 
-	if ((header.flags & GZIP_FLAG_FHCRC) != 0) {
-		if (stream_length < 2)
-			return EINVAL;
+/** Expand GZIP compressed data
+ *
+ * The routine allocates the output buffer based
+ * on the size encoded in the input stream. This
+ * effectively limits the size of the uncompressed
+ * data to 4 GiB (expanding input streams that actually
+ * encode more data will always fail).
+ *
+ * The CRC-32 of the expanded data is verified against
+ * the value stored in the stream footer.
+ *
+ * @param[in]  src     Source data buffer.
+ * @param[in]  srclen  Source buffer size (bytes).
+ * @param[out] dest    Destination data buffer.
+ * @param[out] destlen Destination buffer size (bytes).
+ *
+ * @return EOK on success.
+ * @return ENOENT on distance too large.
+ * @return EINVAL on invalid Huffman code, invalid deflate data,
+ *                   invalid compression method, invalid stream
+ *                   or CRC mismatch.
+ * @return ELIMIT on input buffer overrun.
+ * @return ENOMEM on output buffer overrun.
+ *
+ */
+errno_t gzip_expand(void *src, size_t srclen, void **dest, size_t *destlen)
+{
+	size_t hdrlen;
+	uint32_t crc;
+	uint32_t size;
+	errno_t rc;
 
-		stream += 2;
-		stream_length -= 2;
-	}
+	rc = gzip_parse_header(src, srclen, &hdrlen);
+	if (rc != EOK)
+		return EINVAL;
+
+	if (srclen - hdrlen < GZIP_FOOTER_SIZE)
+		return EINVAL;
+
+	gzip_parse_footer(src + srclen - GZIP_FOOTER_SIZE, &crc, &size);
+	*destlen = size;
+
+	void *stream = src + hdrlen;
+	size_t stream_length = srclen - hdrlen - GZIP_FOOTER_SIZE;
 
 	/* Allocate output buffer and inflate the data */
 
@@ -173,11 +237,130 @@ errno_t gzip_expand(void *src, size_t srclen, void **dest, size_t *destlen)
 	if (*dest == NULL)
 		return ENOMEM;
 
-	errno_t ret = inflate(stream, stream_length, *dest, *destlen);
-	if (ret != EOK) {
-		free(dest);
-		return ret;
+	rc = inflate(stream, stream_length, *dest, *destlen);
+	if (rc != EOK) {
+		free(*dest);
+		return rc;
 	}
 
+	if (compute_crc32(*dest, *destlen) != crc) {
+		free(*dest);
+		return EINVAL;
+	}
+
+	return EOK;
+}
+
+/** Write GZIP header
+ *
+ * Writes a header without any optional fields. The compression level
+ * is only used to set the informative extra flags.
+ *
+ * @param[out] dest  Output buffer (at least GZIP_HEADER_SIZE bytes).
+ * @param[in]  level Deflate compression level of the data.
+ *
+ */
+void gzip_write_header(void *dest, unsigned level)
+{
+	gzip_header_t header;
+
+	header.id1 = GZIP_ID1;
+	header.id2 = GZIP_ID2;
+	header.method = GZIP_METHOD_DEFLATE;
+	header.flags = 0;
+	header.mtime = 0;
+	header.extra_flags = 0;
+	header.os = GZIP_OS_UNKNOWN;
+
+	if (level == DEFLATE_LEVEL_MAX)
+		header.extra_flags = GZIP_XFL_MAX;
+	else if (level == DEFLATE_LEVEL_FAST)
+		header.extra_flags = GZIP_XFL_FAST;
+
+	memcpy(dest, &header, sizeof(header));
+}
+
+/** Write GZIP footer
+ *
+ * @param[out] dest Output buffer (at least GZIP_FOOTER_SIZE bytes).
+ * @param[in]  crc  CRC-32 of the uncompressed data.
+ * @param[in]  size Size of the uncompressed data (modulo 2^32).
+ *
+ */
+void gzip_write_footer(void *dest, uint32_t crc, uint32_t size)
+{
+	gzip_footer_t footer;
+
+	footer.crc32 = host2uint32_t_le(crc);
+	footer.size = host2uint32_t_le(size);
+
+	memcpy(dest, &footer, sizeof(footer));
+}
+
+/** Compress data into GZIP format
+ *
+ * The routine allocates the output buffer. Use deflate_compress()
+ * together with gzip_write_header() and gzip_write_footer() to produce
+ * GZIP data piece by piece.
+ *
+ * @param[in]  src     Source data buffer.
+ * @param[in]  srclen  Source buffer size (bytes).
+ * @param[in]  level   Deflate compression level.
+ * @param[out] dest    Destination data buffer.
+ * @param[out] destlen Destination buffer size (bytes).
+ *
+ * @return EOK on success.
+ * @return EINVAL on invalid compression level or input too large.
+ * @return ENOMEM if out of memory.
+ *
+ */
+errno_t gzip_compress(const void *src, size_t srclen, unsigned level,
+    void **dest, size_t *destlen)
+{
+	deflate_t *deflate;
+	uint8_t *buf;
+	size_t bufsize;
+	size_t clen;
+	uint32_t crc;
+	errno_t rc;
+
+	rc = deflate_create(&deflate);
+	if (rc != EOK)
+		return rc;
+
+	rc = deflate_set_level(deflate, level);
+	if (rc != EOK) {
+		deflate_destroy(deflate);
+		return rc;
+	}
+
+	bufsize = GZIP_HEADER_SIZE + deflate_bound(srclen) + GZIP_FOOTER_SIZE;
+	if (bufsize < srclen) {
+		deflate_destroy(deflate);
+		return EINVAL;
+	}
+
+	buf = malloc(bufsize);
+	if (buf == NULL) {
+		deflate_destroy(deflate);
+		return ENOMEM;
+	}
+
+	gzip_write_header(buf, level);
+
+	rc = deflate_compress(deflate, src, srclen, buf + GZIP_HEADER_SIZE,
+	    bufsize - GZIP_HEADER_SIZE - GZIP_FOOTER_SIZE,
+	    deflate_flush_finish, &clen);
+	deflate_destroy(deflate);
+	if (rc != EOK) {
+		free(buf);
+		return rc;
+	}
+
+	crc = compute_crc32(src, srclen);
+	gzip_write_footer(buf + GZIP_HEADER_SIZE + clen, crc, srclen);
+
+	*dest = buf;
+	*destlen = GZIP_HEADER_SIZE + clen + GZIP_FOOTER_SIZE;
 	return EOK;
 }
@@ -29,8 +29,22 @@
 #ifndef LIBCOMPRESS_GZIP_H_
 #define LIBCOMPRESS_GZIP_H_
 
+#include <errno.h>
 #include <stddef.h>
+#include <stdint.h>
 
+/** Size of GZIP header written by gzip_write_header() */
+#define GZIP_HEADER_SIZE  10
+
+/** Size of GZIP footer (CRC-32 and size of uncompressed data) */
+#define GZIP_FOOTER_SIZE  8
+
+extern errno_t gzip_parse_header(const void *, size_t, size_t *);
+extern void gzip_parse_footer(const void *, uint32_t *, uint32_t *);
 extern errno_t gzip_expand(void *, size_t, void **, size_t *);
+extern void gzip_write_header(void *, unsigned);
+extern void gzip_write_footer(void *, uint32_t, uint32_t);
+extern errno_t gzip_compress(const void *, size_t, unsigned, void **,
+    size_t *);
 
 #endif
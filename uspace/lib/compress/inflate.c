@@ -30,12 +30,20 @@
 /** @file
  * @brief Implementation of inflate decompression
  *
- * A simple inflate implementation (decompression of `deflate' stream as
- * described by RFC 1951) based on puff.c by Mark Adler. This code is
- * currently not optimized for speed but for readability.
+ * Decompression of `deflate' stream as described by RFC 1951. The code
+ * started as a port of puff.c by Mark Adler and keeps its canonical Huffman
+ * code construction.
  *
- * All dynamically allocated memory memory is taken from the stack. The
- * stack usage should be typically bounded by 2 KB.
+ * The decoder is a state machine that can be suspended whenever it runs
+ * out of input or output space, so the stream can be processed in chunks
+ * of any size (down to single bytes). Decoded data is first stored into
+ * a circular window (which also serves as the history for back
+ * references) and then copied to the caller's buffer.
+ *
+ * Huffman symbols are decoded with a single lookup in a table indexed by
+ * the next FAST_BITS input bits. Only codes longer than that fall back to
+ * the canonical bit-by-bit decoding. Input is read into a 64-bit bit
+ * buffer, eight bytes at a time when possible.
  *
  * Original copyright notice:
  *
@@ -63,11 +71,14 @@
  *
  */
 
-#include <stddef.h>
-#include <stdint.h>
-#include <stdbool.h>
+#include <byteorder.h>
 #include <errno.h>
+#include <macros.h>
 #include <mem.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
 #include "inflate.h"
 
 /** Maximum bits in the Huffman code */
@@ -87,39 +98,120 @@
 /** Number of all codes */
 #define MAX_CODE  (MAX_LITLEN + MAX_DIST)
 
-/** Check for input buffer overrun condition */
-#define CHECK_OVERRUN(state) \
-	do { \
-		if ((state).overrun) \
-			return ELIMIT; \
-	} while (false)
-
-/** Inflate algorithm state
- *
+/** End-of-block symbol */
+#define END_OF_BLOCK  256
+
+/** Number of input bits resolved by one lookup in the fast table */
+#define FAST_BITS  10
+/** Number of entries of the fast table */
+#define FAST_SIZE  (1 << FAST_BITS)
+/** Shift of code length in a fast table entry */
+#define FAST_LEN_SHIFT  9
+/** Mask of symbol in a fast table entry */
+#define FAST_SYM_MASK   ((1 << FAST_LEN_SHIFT) - 1)
+
+/** Longest back reference */
+#define MAX_MATCH     258
+/** Largest back reference distance */
+#define MAX_DISTANCE  32768
+
+/** Size of the circular output window (power of two) */
+#define WINDOW_SIZE  65536
+/** Mask for wrapping positions in the window */
+#define WINDOW_MASK  (WINDOW_SIZE - 1)
+/**
+ * Maximum amount of pending output for a new symbol to be decoded.
+ * Leaves room for the longest match plus the overshoot of the copy loop.
  */
-typedef struct {
-	uint8_t *dest;    /**< Output buffer */
-	size_t destlen;   /**< Output buffer size */
-	size_t destcnt;   /**< Position in the output buffer */
+#define WINDOW_LIMIT  (WINDOW_SIZE - MAX_MATCH - 8)
 
-	uint8_t *src;     /**< Input buffer */
-	size_t srclen;    /**< Input buffer size */
-	size_t srccnt;    /**< Position in the input buffer */
-
-	uint16_t bitbuf;  /**< Bit buffer */
-	size_t bitlen;    /**< Number of bits in the bit buffer */
-
-	bool overrun;     /**< Overrun condition */
-} inflate_state_t;
+/** Most bits needed to decode a length and distance pair */
+#define MAX_PAIR_BITS  48
 
 /** Huffman code description
  *
  */
 typedef struct {
-	uint16_t *count;   /**< Array of symbol counts */
-	uint16_t *symbol;  /**< Array of symbols */
+	/**
+	 * Fast lookup table indexed by the next FAST_BITS input bits.
+	 * Each entry holds code length << FAST_LEN_SHIFT | symbol, zero
+	 * if the code is longer than FAST_BITS.
+	 */
+	uint16_t fast[FAST_SIZE];
+	uint16_t count[MAX_HUFFMAN_BIT + 1];  /**< Array of symbol counts */
+	uint16_t symbol[MAX_FIXED_LITLEN];    /**< Array of symbols */
 } huffman_t;
 
+/** Input bit reader
+ *
+ * Bits of the bit buffer above @c bitcnt are either zero or equal to the
+ * input bits that follow, which allows refilling eight bytes at a time.
+ *
+ */
+typedef struct {
+	const uint8_t *src;  /**< Input buffer */
+	size_t srclen;       /**< Input buffer size */
+	size_t srccnt;       /**< Position in the input buffer */
+
+	uint64_t bitbuf;     /**< Bit buffer */
+	unsigned bitcnt;     /**< Number of bits in the bit buffer */
+} inflate_bits_t;
+
+/** Decoder state */
+typedef enum {
+	/** Expecting block header */
+	ist_header,
+	/** Expecting stored block length */
+	ist_stored_len,
+	/** Copying stored block */
+	ist_stored_copy,
+	/** Expecting dynamic block table sizes */
+	ist_table_counts,
+	/** Reading code length code lengths */
+	ist_table_clens,
+	/** Reading literal/length and distance code lengths */
+	ist_table_lens,
+	/** Decoding compressed block */
+	ist_codes,
+	/** Final block has been decoded */
+	ist_done,
+	/** Invalid data has been encountered */
+	ist_error
+} inflate_st_t;
+
+/** Inflate algorithm state
+ *
+ */
+struct inflate {
+	inflate_st_t phase;   /**< Decoder phase */
+	errno_t error;        /**< Error code in ist_error state */
+	bool last;            /**< Current block is the final one */
+
+	inflate_bits_t bits;  /**< Input */
+
+	uint8_t *window;      /**< Circular output window */
+	size_t wpos;          /**< Write position in the window */
+	size_t pending;       /**< Bytes in the window not passed to caller */
+	size_t whave;         /**< Valid history (at most MAX_DISTANCE) */
+
+	size_t remain;        /**< Bytes left to copy in stored block */
+
+	uint16_t nlen;        /**< Number of literal/length codes */
+	uint16_t ndist;       /**< Number of distance codes */
+	uint16_t ncode;       /**< Number of code length codes */
+	uint16_t index;       /**< Index of the next code length to read */
+	uint16_t length[MAX_CODE];  /**< Code lengths */
+
+	huffman_t *len_code;  /**< Literal/length code of current block */
+	huffman_t *dist_code; /**< Distance code of current block */
+
+	huffman_t fixed_len;  /**< Fixed literal/length code */
+	huffman_t fixed_dist; /**< Fixed distance code */
+	huffman_t dyn_len;    /**< Dynamic literal/length code */
+	huffman_t dyn_dist;   /**< Dynamic distance code */
+	huffman_t clen;       /**< Code length code */
+};
+
 /** Length codes
  *
  */
@@ -161,186 +253,118 @@ static const short order[MAX_ORDER] = {
 	16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
 };
 
-/** Static length symbol counts
+/** Refill the bit buffer
  *
- */
-static uint16_t len_count[MAX_HUFFMAN_BIT + 1] = {
-	0, 0, 0, 0, 0, 0, 0, 24, 152, 112, 0, 0, 0, 0, 0, 0
-};
-
-/** Static length symbols
+ * Loads eight bytes at once if that much input is available, otherwise
+ * loads byte by byte until the buffer is full or input is exhausted.
  *
- */
-static uint16_t len_symbol[MAX_FIXED_LITLEN] = {
-	256, 257, 258, 259, 260, 261, 262, 263, 264, 265, 266, 267, 268,
-	269, 270, 271, 272, 273, 274, 275, 276, 277, 278, 279, 0, 1, 2,
-	3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20,
-	21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36,
-	37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 52,
-	53, 54, 55, 56, 57, 58, 59, 60, 61, 62, 63, 64, 65, 66, 67, 68,
-	69, 70, 71, 72, 73, 74, 75, 76, 77, 78, 79, 80, 81, 82, 83, 84,
-	85, 86, 87, 88, 89, 90, 91, 92, 93, 94, 95, 96, 97, 98, 99, 100,
-	101, 102, 103, 104, 105, 106, 107, 108, 109, 110, 111, 112, 113,
-	114, 115, 116, 117, 118, 119, 120, 121, 122, 123, 124, 125, 126,
-	127, 128, 129, 130, 131, 132, 133, 134, 135, 136, 137, 138, 139,
-	140, 141, 142, 143, 280, 281, 282, 283, 284, 285, 286, 287, 144,
-	145, 146, 147, 148, 149, 150, 151, 152, 153, 154, 155, 156, 157,
-	158, 159, 160, 161, 162, 163, 164, 165, 166, 167, 168, 169, 170,
-	171, 172, 173, 174, 175, 176, 177, 178, 179, 180, 181, 182, 183,
-	184, 185, 186, 187, 188, 189, 190, 191, 192, 193, 194, 195, 196,
-	197, 198, 199, 200, 201, 202, 203, 204, 205, 206, 207, 208, 209,
-	210, 211, 212, 213, 214, 215, 216, 217, 218, 219, 220, 221, 222,
-	223, 224, 225, 226, 227, 228, 229, 230, 231, 232, 233, 234, 235,
-	236, 237, 238, 239, 240, 241, 242, 243, 244, 245, 246, 247, 248,
-	249, 250, 251, 252, 253, 254, 255
-};
-
-/** Static distance symbol counts
+ * @param bits Bit reader.
  *
  */
-static uint16_t dist_count[MAX_HUFFMAN_BIT + 1] = {
-	0, 0, 0, 0, 0, 30, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-};
+static inline void bits_refill(inflate_bits_t *bits)
+{
+	if (bits->srclen - bits->srccnt >= sizeof(uint64_t)) {
+		uint64_t val;
+
+		memcpy(&val, bits->src + bits->srccnt, sizeof(val));
+		bits->bitbuf |= uint64_t_le2host(val) << bits->bitcnt;
+		bits->srccnt += (63 - bits->bitcnt) >> 3;
+		bits->bitcnt |= 56;
+		return;
+	}
 
-/** Static distance symbols
- *
- */
-static uint16_t dist_symbol[MAX_DIST] = {
-	0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
-	16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29
-};
+	while (bits->bitcnt <= 56 && bits->srccnt < bits->srclen) {
+		bits->bitbuf |= ((uint64_t) bits->src[bits->srccnt]) <<
+		    bits->bitcnt;
+		bits->srccnt++;
+		bits->bitcnt += 8;
+	}
+}
 
-/** Huffman code for lengths
+/** Peek at bits in the bit buffer
  *
- */
-static huffman_t len_code = {
-	.count = len_count,
-	.symbol = len_symbol
-};
-
-/** Huffman code for distances
+ * @param bits Bit reader.
+ * @param cnt  Number of bits (at most 32, must be available).
+ *
+ * @return Returned bits.
  *
  */
-static huffman_t dist_code = {
-	.count = dist_count,
-	.symbol = dist_symbol
-};
+static inline uint32_t bits_peek(inflate_bits_t *bits, unsigned cnt)
+{
+	return (uint32_t) (bits->bitbuf & ((UINT64_C(1) << cnt) - 1));
+}
 
-/** Get bits from the bit buffer
+/** Drop bits from the bit buffer
  *
- * @param state Inflate state.
- * @param cnt   Number of bits to return (at most 16).
- *
- * @return Returned bits.
+ * @param bits Bit reader.
+ * @param cnt  Number of bits (must be available).
  *
  */
-static inline uint16_t get_bits(inflate_state_t *state, size_t cnt)
+static inline void bits_drop(inflate_bits_t *bits, unsigned cnt)
 {
-	/* Bit accumulator for at least 20 bits */
-	uint32_t val = state->bitbuf;
-
-	while (state->bitlen < cnt) {
-		if (state->srccnt == state->srclen) {
-			state->overrun = true;
-			return 0;
-		}
-
-		/* Load 8 more bits */
-		val |= ((uint32_t) state->src[state->srccnt]) << state->bitlen;
-		state->srccnt++;
-		state->bitlen += 8;
-	}
-
-	/* Update bits in the buffer */
-	state->bitbuf = (uint16_t) (val >> cnt);
-	state->bitlen -= cnt;
-
-	return ((uint16_t) (val & ((1 << cnt) - 1)));
+	bits->bitbuf >>= cnt;
+	bits->bitcnt -= cnt;
 }
 
-/** Decode `stored' block
+/** Get bits from the bit buffer
  *
- * @param state Inflate state.
+ * @param bits Bit reader.
+ * @param cnt  Number of bits (at most 32, must be available).
  *
- * @return EOK on success.
- * @return ELIMIT on input buffer overrun.
- * @return ENOMEM on output buffer overrun.
- * @return EINVAL on invalid data.
+ * @return Returned bits.
  *
  */
-static errno_t inflate_stored(inflate_state_t *state)
+static inline uint32_t bits_get(inflate_bits_t *bits, unsigned cnt)
 {
-	/* Discard bits in the bit buffer */
-	state->bitbuf = 0;
-	state->bitlen = 0;
-
-	if (state->srccnt + 4 > state->srclen)
-		return ELIMIT;
-
-	uint16_t len =
-	    state->src[state->srccnt] | (state->src[state->srccnt + 1] << 8);
-	uint16_t len_compl =
-	    state->src[state->srccnt + 2] | (state->src[state->srccnt + 3] << 8);
-
-	/* Check block length and its complement */
-	if (((int16_t) len) != ~((int16_t) len_compl))
-		return EINVAL;
-
-	state->srccnt += 4;
-
-	/* Check input buffer size */
-	if (state->srccnt + len > state->srclen)
-		return ELIMIT;
-
-	/* Check output buffer size */
-	if (state->destcnt + len > state->destlen)
-		return ENOMEM;
-
-	/* Copy data */
-	memcpy(state->dest + state->destcnt, state->src + state->srccnt, len);
-	state->srccnt += len;
-	state->destcnt += len;
-
-	return EOK;
+	uint32_t val = bits_peek(bits, cnt);
+	bits_drop(bits, cnt);
+	return val;
 }
 
-/** Decode a symbol using the Huffman code
+/** Decode a symbol whose code is longer than FAST_BITS
  *
- * @param state   Inflate state.
+ * @param bits    Bit reader.
  * @param huffman Huffman code.
  * @param symbol  Decoded symbol.
  *
- * @param EOK on success.
- * @param EINVAL on invalid Huffman code.
+ * @return EOK on success.
+ * @return EAGAIN if more input is needed.
+ * @return EINVAL on invalid Huffman code.
  *
  */
-static errno_t huffman_decode(inflate_state_t *state, huffman_t *huffman,
-    uint16_t *symbol)
+static errno_t huffman_decode_slow(inflate_bits_t *bits,
+    const huffman_t *huffman, uint16_t *symbol)
 {
+	uint64_t bitbuf = bits->bitbuf;
+
 	/* Decode bits */
-	uint16_t code = 0;
+	int code = 0;
 
 	/* First code of the given length */
-	size_t first = 0;
+	int first = 0;
 
 	/*
 	 * Index of the first code of the given length
 	 * in the symbol table
 	 */
-	size_t index = 0;
+	int index = 0;
 
 	/* Current number of bits in the code */
-	size_t len;
+	unsigned len;
 
 	for (len = 1; len <= MAX_HUFFMAN_BIT; len++) {
+		if (len > bits->bitcnt)
+			return EAGAIN;
+
 		/* Get next bit */
-		code |= get_bits(state, 1);
-		CHECK_OVERRUN(*state);
+		code |= bitbuf & 1;
+		bitbuf >>= 1;
 
-		uint16_t count = huffman->count[len];
+		int count = huffman->count[len];
 		if (code < first + count) {
 			/* Return decoded symbol */
 			*symbol = huffman->symbol[index + code - first];
+			bits_drop(bits, len);
 			return EOK;
 		}
 
@@ -354,6 +378,62 @@ static errno_t huffman_decode(inflate_state_t *state, huffman_t *huffman,
 	return EINVAL;
 }
 
+/** Decode a symbol using the Huffman code
+ *
+ * @param bits    Bit reader.
+ * @param huffman Huffman code.
+ * @param symbol  Decoded symbol.
+ *
+ * @return EOK on success.
+ * @return EAGAIN if more input is needed.
+ * @return EINVAL on invalid Huffman code.
+ *
+ */
+static inline errno_t huffman_decode(inflate_bits_t *bits,
+    const huffman_t *huffman, uint16_t *symbol)
+{
+	uint16_t entry = huffman->fast[bits->bitbuf & (FAST_SIZE - 1)];
+
+	if (entry != 0) {
+		unsigned len = entry >> FAST_LEN_SHIFT;
+
+		/*
+		 * Bits above bitcnt are zero (or real input), so if the code
+		 * found is longer than the available bits, no shorter code
+		 * can match the actual input either.
+		 */
+		if (len > bits->bitcnt)
+			return EAGAIN;
+
+		*symbol = entry & FAST_SYM_MASK;
+		bits_drop(bits, len);
+		return EOK;
+	}
+
+	return huffman_decode_slow(bits, huffman, symbol);
+}
+
+/** Reverse order of bits
+ *
+ * @param code Code.
+ * @param len  Number of bits in the code.
+ *
+ * @return @a code with the lowest @a len bits in reverse order.
+ *
+ */
+static unsigned bit_reverse(unsigned code, unsigned len)
+{
+	unsigned rev = 0;
+
+	while (len > 0) {
+		rev = (rev << 1) | (code & 1);
+		code >>= 1;
+		len--;
+	}
+
+	return rev;
+}
+
 /** Construct Huffman tables from canonical Huffman code
  *
  * @param huffman Constructed Huffman tables.
@@ -365,8 +445,11 @@ static errno_t huffman_decode(inflate_state_t *state, huffman_t *huffman,
  * @return Positive value for an incomplete code set.
  *
  */
-static int16_t huffman_construct(huffman_t *huffman, uint16_t *length, size_t n)
+static int16_t huffman_construct(huffman_t *huffman, const uint16_t *length,
+    size_t n)
 {
+	memset(huffman->fast, 0, sizeof(huffman->fast));
+
 	/* Count number of codes for each length */
 	size_t len;
 	for (len = 0; len <= MAX_HUFFMAN_BIT; len++)
@@ -407,268 +490,700 @@ static int16_t huffman_construct(huffman_t *huffman, uint16_t *length, size_t n)
 		}
 	}
 
+	/*
+	 * Fill in the fast table. Codes are stored starting with their most
+	 * significant bit, so the table index is the reversed code. Each
+	 * code occupies all entries that start with it.
+	 */
+	unsigned code = 0;
+	size_t index = 0;
+	for (len = 1; len <= FAST_BITS; len++) {
+		for (size_t i = 0; i < huffman->count[len]; i++) {
+			uint16_t entry = (len << FAST_LEN_SHIFT) |
+			    huffman->symbol[index];
+			unsigned fidx;
+
+			for (fidx = bit_reverse(code, len); fidx < FAST_SIZE;
+			    fidx += 1 << len)
+				huffman->fast[fidx] = entry;
+
+			code++;
+			index++;
+		}
+
+		code <<= 1;
+	}
+
 	return left;
 }
 
+/** Store bytes to the window
+ *
+ * @param state   Inflate state.
+ * @param src     Source data.
+ * @param len     Number of bytes (at most WINDOW_SIZE - pending).
+ *
+ */
+static void window_put(inflate_t *state, const uint8_t *src, size_t len)
+{
+	while (len > 0) {
+		size_t n = min(len, WINDOW_SIZE - state->wpos);
+
+		memcpy(state->window + state->wpos, src, n);
+		state->wpos = (state->wpos + n) & WINDOW_MASK;
+		state->pending += n;
+		state->whave = min(state->whave + n, MAX_DISTANCE);
+		src += n;
+		len -= n;
+	}
+}
+
+/** Copy pending output from the window
+ *
+ * @param state   Inflate state.
+ * @param dest    Destination buffer.
+ * @param destlen Destination buffer size.
+ *
+ * @return Number of bytes copied.
+ *
+ */
+static size_t window_flush(inflate_t *state, uint8_t *dest, size_t destlen)
+{
+	size_t copied = 0;
+
+	while (state->pending > 0 && copied < destlen) {
+		size_t rpos = (state->wpos - state->pending) & WINDOW_MASK;
+		size_t n = min(state->pending, destlen - copied);
+		n = min(n, WINDOW_SIZE - rpos);
+
+		memcpy(dest + copied, state->window + rpos, n);
+		state->pending -= n;
+		copied += n;
+	}
+
+	return copied;
+}
+
+/** Decode `stored' block
+ *
+ * @param state   Inflate state.
+ *
+ * @return EOK if the block is finished or the window is full.
+ * @return EAGAIN if more input is needed.
+ *
+ */
+static errno_t inflate_stored(inflate_t *state)
+{
+	inflate_bits_t *bits = &state->bits;
+
+	/* Bytes already in the bit buffer come first */
+	while (state->remain > 0 && bits->bitcnt >= 8) {
+		if (state->pending == WINDOW_SIZE)
+			return EOK;
+
+		uint8_t byte = bits_get(bits, 8);
+		window_put(state, &byte, 1);
+		state->remain--;
+	}
+
+	if (state->remain == 0)
+		return EOK;
+
+	/* Bit buffer is empty, clear the look-ahead bits, too */
+	bits->bitbuf = 0;
+
+	size_t n = min(state->remain, WINDOW_SIZE - state->pending);
+	n = min(n, bits->srclen - bits->srccnt);
+
+	window_put(state, bits->src + bits->srccnt, n);
+	bits->srccnt += n;
+	state->remain -= n;
+
+	if (state->remain > 0 && bits->srccnt == bits->srclen)
+		return EAGAIN;
+
+	return EOK;
+}
+
 /** Decode literal/length and distance codes
  *
- * Decode until end-of-block code.
+ * Decode until end-of-block code, until the window is full or until
+ * input is exhausted.
  *
- * @param state     Inflate state.
- * @param len_code  Huffman code for literal/length.
- * @param dist_code Huffman code for distance.
+ * @param state   Inflate state.
+ * @param eob     Place to store @c true if end of block was reached.
  *
  * @return EOK on success.
+ * @return EAGAIN if more input is needed.
  * @return ENOENT on distance too large.
  * @return EINVAL on invalid Huffman code.
- * @return ELIMIT on input buffer overrun.
- * @return ENOMEM on output buffer overrun.
  *
  */
-static errno_t inflate_codes(inflate_state_t *state, huffman_t *len_code,
-    huffman_t *dist_code)
+static errno_t inflate_codes(inflate_t *state, bool *eob)
 {
+	const huffman_t *len_code = state->len_code;
+	const huffman_t *dist_code = state->dist_code;
+	uint8_t *window = state->window;
+	inflate_bits_t bits = state->bits;
+	size_t wpos = state->wpos;
+	size_t pending = state->pending;
+	size_t whave = state->whave;
+	uint64_t save_bitbuf = 0;
+	unsigned save_bitcnt = 0;
 	uint16_t symbol;
+	errno_t rc = EOK;
 
-	do {
-		errno_t err = huffman_decode(state, len_code, &symbol);
-		if (err != EOK) {
-			/* Error decoding */
-			return err;
-		}
+	*eob = false;
+
+	while (pending <= WINDOW_LIMIT) {
+		if (bits.bitcnt < MAX_PAIR_BITS)
+			bits_refill(&bits);
+
+		save_bitbuf = bits.bitbuf;
+		save_bitcnt = bits.bitcnt;
+
+		rc = huffman_decode(&bits, len_code, &symbol);
+		if (rc != EOK)
+			break;
 
 		if (symbol < 256) {
 			/* Write out literal */
-			if (state->destcnt == state->destlen)
-				return ENOMEM;
-
-			state->dest[state->destcnt] = (uint8_t) symbol;
-			state->destcnt++;
-		} else if (symbol > 256) {
-			/* Compute length */
-			symbol -= 257;
-			if (symbol >= 29)
-				return EINVAL;
+			window[wpos] = (uint8_t) symbol;
+			wpos = (wpos + 1) & WINDOW_MASK;
+			pending++;
+			if (whave < MAX_DISTANCE)
+				whave++;
+			continue;
+		}
 
-			size_t len = lens[symbol] + get_bits(state, lens_ext[symbol]);
-			CHECK_OVERRUN(*state);
+		if (symbol == END_OF_BLOCK) {
+			*eob = true;
+			break;
+		}
 
-			/* Get distance */
-			err = huffman_decode(state, dist_code, &symbol);
-			if (err != EOK)
-				return err;
+		/* Compute length */
+		symbol -= 257;
+		if (symbol >= MAX_LEN) {
+			rc = EINVAL;
+			break;
+		}
 
-			size_t dist = dists[symbol] + get_bits(state, dists_ext[symbol]);
-			if (dist > state->destcnt)
-				return ENOENT;
+		if (lens_ext[symbol] > bits.bitcnt) {
+			rc = EAGAIN;
+			break;
+		}
+
+		size_t len = lens[symbol] + bits_get(&bits, lens_ext[symbol]);
 
-			if (state->destcnt + len > state->destlen)
-				return ENOMEM;
+		/* Get distance */
+		rc = huffman_decode(&bits, dist_code, &symbol);
+		if (rc != EOK)
+			break;
 
-			while (len > 0) {
-				/* Copy len bytes from distance bytes back */
-				state->dest[state->destcnt] =
-				    state->dest[state->destcnt - dist];
-				state->destcnt++;
-				len--;
+		if (symbol >= MAX_DIST) {
+			rc = EINVAL;
+			break;
+		}
+
+		if (dists_ext[symbol] > bits.bitcnt) {
+			rc = EAGAIN;
+			break;
+		}
+
+		size_t dist = dists[symbol] + bits_get(&bits, dists_ext[symbol]);
+		if (dist > whave) {
+			rc = ENOENT;
+			break;
+		}
+
+		/* Copy len bytes from distance bytes back */
+		size_t from = (wpos - dist) & WINDOW_MASK;
+
+		if (dist >= 8 && wpos + len + 8 <= WINDOW_SIZE &&
+		    from + len + 8 <= WINDOW_SIZE) {
+			/*
+			 * Neither range wraps and each eight byte chunk
+			 * only reads bytes that are already written.
+			 * This may write up to seven bytes past the match,
+			 * which is fine as WINDOW_LIMIT leaves room for it.
+			 */
+			uint8_t *dp = window + wpos;
+			const uint8_t *sp = window + from;
+			uint8_t *end = dp + len;
+
+			do {
+				memcpy(dp, sp, 8);
+				dp += 8;
+				sp += 8;
+			} while (dp < end);
+		} else if (dist == 1 && wpos + len <= WINDOW_SIZE) {
+			/* Run of a single byte */
+			memset(window + wpos, window[from], len);
+		} else {
+			for (size_t i = 0; i < len; i++) {
+				window[(wpos + i) & WINDOW_MASK] =
+				    window[(from + i) & WINDOW_MASK];
 			}
 		}
-	} while (symbol != 256);
 
-	return EOK;
+		wpos = (wpos + len) & WINDOW_MASK;
+		pending += len;
+		whave = min(whave + len, MAX_DISTANCE);
+		continue;
+	}
+
+	if (rc == EAGAIN) {
+		/*
+		 * The symbol is incomplete. Since we always refill before
+		 * decoding a symbol, all input is in the bit buffer now.
+		 * Put back the bits of the partially decoded symbol.
+		 */
+		bits.bitbuf = save_bitbuf;
+		bits.bitcnt = save_bitcnt;
+	}
+
+	state->bits = bits;
+	state->wpos = wpos;
+	state->pending = pending;
+	state->whave = whave;
+
+	return rc;
 }
 
-/** Decode `fixed codes' block
+/** Read code lengths of a dynamic block
  *
- * @param state     Inflate state.
- * @param len_code  Huffman code for literal/length.
- * @param dist_code Huffman code for distance.
+ * @param state   Inflate state.
  *
- * @return EOK on success.
- * @return ENOENT on distance too large.
- * @return EINVAL on invalid Huffman code.
- * @return ELIMIT on input buffer overrun.
- * @return ENOMEM on output buffer overrun.
+ * @return EOK when all code lengths have been read.
+ * @return EAGAIN if more input is needed.
+ * @return EINVAL on invalid data.
  *
  */
-static errno_t inflate_fixed(inflate_state_t *state, huffman_t *len_code,
-    huffman_t *dist_code)
+static errno_t inflate_table_lens(inflate_t *state)
 {
-	return inflate_codes(state, len_code, dist_code);
+	inflate_bits_t *bits = &state->bits;
+	uint16_t total = state->nlen + state->ndist;
+
+	while (state->index < total) {
+		uint64_t save_bitbuf;
+		unsigned save_bitcnt;
+		uint16_t symbol;
+
+		bits_refill(bits);
+		save_bitbuf = bits->bitbuf;
+		save_bitcnt = bits->bitcnt;
+
+		errno_t rc = huffman_decode(bits, &state->clen, &symbol);
+		if (rc != EOK)
+			return rc;
+
+		if (symbol < 16) {
+			state->length[state->index] = symbol;
+			state->index++;
+			continue;
+		}
+
+		uint16_t len = 0;
+		unsigned extra;
+		uint16_t base;
+
+		if (symbol == 16) {
+			if (state->index == 0)
+				return EINVAL;
+
+			len = state->length[state->index - 1];
+			extra = 2;
+			base = 3;
+		} else if (symbol == 17) {
+			extra = 3;
+			base = 3;
+		} else {
+			extra = 7;
+			base = 11;
+		}
+
+		if (extra > bits->bitcnt) {
+			/* Put back the repeat symbol */
+			bits->bitbuf = save_bitbuf;
+			bits->bitcnt = save_bitcnt;
+			return EAGAIN;
+		}
+
+		symbol = base + bits_get(bits, extra);
+		if (state->index + symbol > total)
+			return EINVAL;
+
+		while (symbol > 0) {
+			state->length[state->index] = len;
+			state->index++;
+			symbol--;
+		}
+	}
+
+	/* Check for end-of-block code */
+	if (state->length[END_OF_BLOCK] == 0)
+		return EINVAL;
+
+	/* Build Huffman tables for literal/length codes */
+	int16_t rc = huffman_construct(&state->dyn_len, state->length,
+	    state->nlen);
+	if ((rc < 0) || ((rc > 0) &&
+	    (state->dyn_len.count[0] + 1 != state->nlen)))
+		return EINVAL;
+
+	/* Build Huffman tables for distance codes */
+	rc = huffman_construct(&state->dyn_dist,
+	    state->length + state->nlen, state->ndist);
+	if ((rc < 0) || ((rc > 0) &&
+	    (state->dyn_dist.count[0] + 1 != state->ndist)))
+		return EINVAL;
+
+	return EOK;
 }
 
-/** Decode `dynamic codes' block
+/** Run the decoder
  *
- * @param state     Inflate state.
+ * Decode until the stream ends, the window is full or input is
+ * exhausted.
  *
- * @return EOK on success.
+ * @param state   Inflate state.
+ *
+ * @return EOK if the stream ended or the window needs to be flushed.
+ * @return EAGAIN if more input is needed.
  * @return ENOENT on distance too large.
- * @return EINVAL on invalid Huffman code.
- * @return ELIMIT on input buffer overrun.
- * @return ENOMEM on output buffer overrun.
+ * @return EINVAL on invalid Huffman code or invalid deflate data.
  *
  */
-static errno_t inflate_dynamic(inflate_state_t *state)
+static errno_t inflate_run(inflate_t *state)
 {
-	uint16_t length[MAX_CODE];
-	uint16_t dyn_len_count[MAX_HUFFMAN_BIT + 1];
-	uint16_t dyn_len_symbol[MAX_LITLEN];
-	uint16_t dyn_dist_count[MAX_HUFFMAN_BIT + 1];
-	uint16_t dyn_dist_symbol[MAX_DIST];
-	huffman_t dyn_len_code;
-	huffman_t dyn_dist_code;
+	inflate_bits_t *bits = &state->bits;
+	errno_t rc;
+	bool eob;
+
+	while (true) {
+		switch (state->phase) {
+		case ist_header:
+			bits_refill(bits);
+			if (bits->bitcnt < 3)
+				return EAGAIN;
+
+			/* Last block is indicated by a non-zero bit */
+			state->last = bits_get(bits, 1) != 0;
+
+			/* Block type */
+			switch (bits_get(bits, 2)) {
+			case 0:
+				/* Discard rest of the current byte */
+				bits_drop(bits, bits->bitcnt & 7);
+				state->phase = ist_stored_len;
+				break;
+			case 1:
+				state->len_code = &state->fixed_len;
+				state->dist_code = &state->fixed_dist;
+				state->phase = ist_codes;
+				break;
+			case 2:
+				state->phase = ist_table_counts;
+				break;
+			default:
+				return EINVAL;
+			}
+			break;
+		case ist_stored_len:
+			bits_refill(bits);
+			if (bits->bitcnt < 32)
+				return EAGAIN;
 
-	dyn_len_code.count = dyn_len_count;
-	dyn_len_code.symbol = dyn_len_symbol;
+			uint16_t len = bits_get(bits, 16);
+			uint16_t len_compl = bits_get(bits, 16);
 
-	dyn_dist_code.count = dyn_dist_count;
-	dyn_dist_code.symbol = dyn_dist_symbol;
+			/* Check block length and its complement */
+			if ((uint32_t) len != (~(uint32_t) len_compl & 0xffff))
+				return EINVAL;
 
-	/* Get number of bits in each table */
-	uint16_t nlen = get_bits(state, 5) + 257;
-	CHECK_OVERRUN(*state);
+			state->remain = len;
+			state->phase = ist_stored_copy;
+			break;
+		case ist_stored_copy:
+			if (state->pending == WINDOW_SIZE)
+				return EOK;
 
-	uint16_t ndist = get_bits(state, 5) + 1;
-	CHECK_OVERRUN(*state);
+			rc = inflate_stored(state);
+			if (rc != EOK)
+				return rc;
 
-	uint16_t ncode = get_bits(state, 4) + 4;
-	CHECK_OVERRUN(*state);
+			if (state->remain == 0)
+				state->phase = state->last ? ist_done : ist_header;
+			break;
+		case ist_table_counts:
+			bits_refill(bits);
+			if (bits->bitcnt < 14)
+				return EAGAIN;
+
+			/* Get number of bits in each table */
+			state->nlen = bits_get(bits, 5) + 257;
+			state->ndist = bits_get(bits, 5) + 1;
+			state->ncode = bits_get(bits, 4) + 4;
+
+			if ((state->nlen > MAX_LITLEN) ||
+			    (state->ndist > MAX_DIST) ||
+			    (state->ncode > MAX_ORDER))
+				return EINVAL;
 
-	if ((nlen > MAX_LITLEN) || (ndist > MAX_DIST) ||
-	    (ncode > MAX_ORDER))
-		return EINVAL;
+			state->index = 0;
+			state->phase = ist_table_clens;
+			break;
+		case ist_table_clens:
+			/* Read code length code lengths */
+			while (state->index < state->ncode) {
+				bits_refill(bits);
+				if (bits->bitcnt < 3)
+					return EAGAIN;
+
+				state->length[order[state->index]] =
+				    bits_get(bits, 3);
+				state->index++;
+			}
 
-	/* Read code length code lengths */
-	uint16_t index;
-	for (index = 0; index < ncode; index++) {
-		length[order[index]] = get_bits(state, 3);
-		CHECK_OVERRUN(*state);
-	}
+			/* Set missing lengths to zero */
+			for (uint16_t i = state->ncode; i < MAX_ORDER; i++)
+				state->length[order[i]] = 0;
 
-	/* Set missing lengths to zero */
-	for (index = ncode; index < MAX_ORDER; index++)
-		length[order[index]] = 0;
+			/* Build Huffman code */
+			if (huffman_construct(&state->clen, state->length,
+			    MAX_ORDER) != 0)
+				return EINVAL;
 
-	/* Build Huffman code */
-	int16_t rc = huffman_construct(&dyn_len_code, length, MAX_ORDER);
-	if (rc != 0)
-		return EINVAL;
+			state->index = 0;
+			state->phase = ist_table_lens;
+			break;
+		case ist_table_lens:
+			rc = inflate_table_lens(state);
+			if (rc != EOK)
+				return rc;
+
+			state->len_code = &state->dyn_len;
+			state->dist_code = &state->dyn_dist;
+			state->phase = ist_codes;
+			break;
+		case ist_codes:
+			rc = inflate_codes(state, &eob);
+			if (rc != EOK)
+				return rc;
+
+			if (!eob) {
+				/* Window is full */
+				return EOK;
+			}
 
-	/* Read length/literal and distance code length tables */
-	index = 0;
-	while (index < nlen + ndist) {
-		uint16_t symbol;
-		errno_t err = huffman_decode(state, &dyn_len_code, &symbol);
-		if (err != EOK)
+			state->phase = state->last ? ist_done : ist_header;
+			break;
+		case ist_done:
 			return EOK;
+		case ist_error:
+			return state->error;
+		}
+	}
+}
 
-		if (symbol < 16) {
-			length[index] = symbol;
-			index++;
-		} else {
-			uint16_t len = 0;
-
-			if (symbol == 16) {
-				if (index == 0)
-					return EINVAL;
-
-				len = length[index - 1];
-				symbol = get_bits(state, 2) + 3;
-				CHECK_OVERRUN(*state);
-			} else if (symbol == 17) {
-				symbol = get_bits(state, 3) + 3;
-				CHECK_OVERRUN(*state);
-			} else {
-				symbol = get_bits(state, 7) + 11;
-				CHECK_OVERRUN(*state);
-			}
+/** Create inflate decoder
+ *
+ * @param rinflate Place to store pointer to the new decoder.
+ *
+ * @return EOK on success.
+ * @return ENOMEM if out of memory.
+ *
+ */
+errno_t inflate_create(inflate_t **rinflate)
+{
+	inflate_t *state;
+	size_t i;
 
-			if (index + symbol > nlen + ndist)
-				return EINVAL;
+	state = calloc(1, sizeof(inflate_t));
+	if (state == NULL)
+		return ENOMEM;
 
-			while (symbol > 0) {
-				length[index] = len;
-				index++;
-				symbol--;
-			}
-		}
+	state->window = malloc(WINDOW_SIZE);
+	if (state->window == NULL) {
+		free(state);
+		return ENOMEM;
 	}
 
-	/* Check for end-of-block code */
-	if (length[256] == 0)
-		return EINVAL;
+	/* Fixed literal/length code (RFC 1951, section 3.2.6) */
+	for (i = 0; i < 144; i++)
+		state->length[i] = 8;
+	for (; i < 256; i++)
+		state->length[i] = 9;
+	for (; i < 280; i++)
+		state->length[i] = 7;
+	for (; i < MAX_FIXED_LITLEN; i++)
+		state->length[i] = 8;
 
-	/* Build Huffman tables for literal/length codes */
-	rc = huffman_construct(&dyn_len_code, length, nlen);
-	if ((rc < 0) || ((rc > 0) && (dyn_len_code.count[0] + 1 != nlen)))
-		return EINVAL;
+	(void) huffman_construct(&state->fixed_len, state->length,
+	    MAX_FIXED_LITLEN);
 
-	/* Build Huffman tables for distance codes */
-	rc = huffman_construct(&dyn_dist_code, length + nlen, ndist);
-	if ((rc < 0) || ((rc > 0) && (dyn_dist_code.count[0] + 1 != ndist)))
-		return EINVAL;
+	/* Fixed distance code */
+	for (i = 0; i < MAX_DIST; i++)
+		state->length[i] = 5;
+
+	(void) huffman_construct(&state->fixed_dist, state->length,
+	    MAX_DIST);
 
-	return inflate_codes(state, &dyn_len_code, &dyn_dist_code);
+	inflate_reset(state);
+	*rinflate = state;
+	return EOK;
 }
 
-/** Inflate data
+/** Destroy inflate decoder
  *
- * @param src     Source data buffer.
- * @param srclen  Source buffer size (bytes).
- * @param dest    Destination data buffer.
- * @param destlen Destination buffer size (bytes).
+ * @param state Inflate decoder or @c NULL.
  *
- * @return EOK on success.
+ */
+void inflate_destroy(inflate_t *state)
+{
+	if (state == NULL)
+		return;
+
+	free(state->window);
+	free(state);
+}
+
+/** Reset inflate decoder to start decoding a new stream
+ *
+ * @param state Inflate decoder.
+ *
+ */
+void inflate_reset(inflate_t *state)
+{
+	state->phase = ist_header;
+	state->error = EOK;
+	state->last = false;
+
+	state->bits.bitbuf = 0;
+	state->bits.bitcnt = 0;
+
+	state->wpos = 0;
+	state->pending = 0;
+	state->whave = 0;
+	state->remain = 0;
+}
+
+/** Decode part of a deflate stream
+ *
+ * Decodes as much of @a src as possible, limited by the space in @a dest.
+ * Input which is not consumed must be passed again in the next call
+ * (followed by more input). The decoder keeps what it needs from the
+ * consumed input, so the chunks can be arbitrarily small.
+ *
+ * When the end of the stream is reached, @a rconsumed does not include
+ * the bytes following the stream (such as gzip trailer).
+ *
+ * @param state     Inflate decoder.
+ * @param src       Source data buffer.
+ * @param srclen    Source buffer size (bytes).
+ * @param rconsumed Place to store number of input bytes consumed.
+ * @param dest      Destination data buffer.
+ * @param destlen   Destination buffer size (bytes).
+ * @param rproduced Place to store number of bytes written to @a dest.
+ * @param rdone     Place to store @c true if the stream has ended and
+ *                  all of its data has been written out.
+ *
+ * @return EOK on success (including when more input or output space
+ *         is needed).
  * @return ENOENT on distance too large.
  * @return EINVAL on invalid Huffman code or invalid deflate data.
- * @return ELIMIT on input buffer overrun.
- * @return ENOMEM on output buffer overrun.
  *
  */
-errno_t inflate(void *src, size_t srclen, void *dest, size_t destlen)
+errno_t inflate_stream(inflate_t *state, const void *src, size_t srclen,
+    size_t *rconsumed, void *dest, size_t destlen, size_t *rproduced,
+    bool *rdone)
 {
-	/* Initialize the state */
-	inflate_state_t state;
+	size_t produced = 0;
+	errno_t rc;
 
-	state.dest = (uint8_t *) dest;
-	state.destlen = destlen;
-	state.destcnt = 0;
+	state->bits.src = (const uint8_t *) src;
+	state->bits.srclen = srclen;
+	state->bits.srccnt = 0;
 
-	state.src = (uint8_t *) src;
-	state.srclen = srclen;
-	state.srccnt = 0;
+	*rdone = false;
 
-	state.bitbuf = 0;
-	state.bitlen = 0;
+	while (true) {
+		rc = inflate_run(state);
+		if (rc != EOK && rc != EAGAIN) {
+			state->phase = ist_error;
+			state->error = rc;
+			break;
+		}
 
-	state.overrun = false;
+		produced += window_flush(state, (uint8_t *) dest + produced,
+		    destlen - produced);
 
-	uint16_t last;
-	errno_t ret = EOK;
+		if (rc == EAGAIN) {
+			/* All input has been consumed */
+			rc = EOK;
+			break;
+		}
 
-	do {
-		/* Last block is indicated by a non-zero bit */
-		last = get_bits(&state, 1);
-		CHECK_OVERRUN(state);
+		if (state->phase == ist_done) {
+			/* Give back whole bytes we have read ahead */
+			size_t unused = min(state->bits.bitcnt / 8,
+			    state->bits.srccnt);
 
-		/* Block type */
-		uint16_t type = get_bits(&state, 2);
-		CHECK_OVERRUN(state);
+			state->bits.srccnt -= unused;
+			state->bits.bitbuf = 0;
+			state->bits.bitcnt = 0;
 
-		switch (type) {
-		case 0:
-			ret = inflate_stored(&state);
-			break;
-		case 1:
-			ret = inflate_fixed(&state, &len_code, &dist_code);
+			*rdone = state->pending == 0;
 			break;
-		case 2:
-			ret = inflate_dynamic(&state);
+		}
+
+		if (state->pending > 0) {
+			/* Output buffer is full */
 			break;
-		default:
-			ret = EINVAL;
 		}
-	} while ((!last) && (ret == 0));
+	}
+
+	*rconsumed = state->bits.srccnt;
+	*rproduced = produced;
+
+	state->bits.src = NULL;
+	state->bits.srclen = 0;
+	state->bits.srccnt = 0;
+
+	return rc;
+}
 
-	return ret;
+/** Inflate data
+ *
+ * @param src     Source data buffer.
+ * @param srclen  Source buffer size (bytes).
+ * @param dest    Destination data buffer.
+ * @param destlen Destination buffer size (bytes).
+ *
+ * @return EOK on success.
+ * @return ENOENT on distance too large.
+ * @return EINVAL on invalid Huffman code or invalid deflate data.
+ * @return ELIMIT on input buffer overrun.
+ * @return ENOMEM on output buffer overrun or if out of memory.
+ *
+ */
+errno_t inflate(void *src, size_t srclen, void *dest, size_t destlen)
+{
+	inflate_t *state;
+	size_t consumed;
+	size_t produced;
+	bool done;
+	errno_t rc;
+
+	rc = inflate_create(&state);
+	if (rc != EOK)
+		return rc;
+
+	rc = inflate_stream(state, src, srclen, &consumed, dest, destlen,
+	    &produced, &done);
+	if (rc == EOK && !done)
+		rc = (produced == destlen) ? ENOMEM : ELIMIT;
+
+	inflate_destroy(state);
+	return rc;
 }
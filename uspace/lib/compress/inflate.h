@@ -29,8 +29,19 @@
 #ifndef LIBCOMPRESS_INFLATE_H_
 #define LIBCOMPRESS_INFLATE_H_
 
+#include <errno.h>
+#include <stdbool.h>
 #include <stddef.h>
 
+/** Inflate decoder state */
+typedef struct inflate inflate_t;
+
 extern errno_t inflate(void *, size_t, void *, size_t);
 
+extern errno_t inflate_create(inflate_t **);
+extern void inflate_destroy(inflate_t *);
+extern void inflate_reset(inflate_t *);
+extern errno_t inflate_stream(inflate_t *, const void *, size_t, size_t *,
+    void *, size_t, size_t *, bool *);
+
 #endif
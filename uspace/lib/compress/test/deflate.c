@@ -0,0 +1,291 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <deflate.h>
+#include <errno.h>
+#include <inflate.h>
+#include <mem.h>
+#include <pcut/pcut.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(deflate);
+
+enum {
+	test_data_size = 100000
+};
+
+/** Kinds of test data */
+typedef enum {
+	test_data_text,
+	test_data_zeros,
+	test_data_random
+} test_data_t;
+
+/** Fill buffer with test data. */
+static void test_data_fill(uint8_t *buf, size_t size, test_data_t kind)
+{
+	static const char *words[] = {
+		"alpha ", "beta ", "gamma ", "delta ", "\n", "epsilon "
+	};
+	uint32_t seed = 1;
+	size_t pos = 0;
+	const char *w;
+
+	while (pos < size) {
+		seed = seed * 1103515245 + 12345;
+
+		switch (kind) {
+		case test_data_text:
+			w = words[(seed >> 16) % 6];
+			while (*w != '\0' && pos < size)
+				buf[pos++] = *w++;
+			break;
+		case test_data_zeros:
+			buf[pos++] = 0;
+			break;
+		case test_data_random:
+			buf[pos++] = seed >> 24;
+			break;
+		}
+	}
+}
+
+/** Compress data in chunks and check that it inflates back.
+ *
+ * @param data Data
+ * @param size Size of data
+ * @param level Compression level
+ * @param chunk Size of chunks passed to deflate_compress()
+ * @param flush Flush mode used between chunks
+ * @param rcsize Place to store compressed size or @c NULL
+ */
+static void test_roundtrip(const uint8_t *data, size_t size, unsigned level,
+    size_t chunk, deflate_flush_t flush, size_t *rcsize)
+{
+	deflate_t *deflate;
+	uint8_t *cbuf;
+	uint8_t *dbuf;
+	size_t cbufsize;
+	size_t csize = 0;
+	size_t pos = 0;
+	size_t len;
+	size_t olen;
+	errno_t rc;
+
+	cbufsize = deflate_bound(chunk) * (size / chunk + 1);
+	cbuf = malloc(cbufsize);
+	PCUT_ASSERT_NOT_NULL(cbuf);
+
+	dbuf = malloc(size + 1);
+	PCUT_ASSERT_NOT_NULL(dbuf);
+
+	rc = deflate_create(&deflate);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = deflate_set_level(deflate, level);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	do {
+		len = size - pos < chunk ? size - pos : chunk;
+		rc = deflate_compress(deflate, data + pos, len, cbuf + csize,
+		    cbufsize - csize, pos + len == size ?
+		    deflate_flush_finish : flush, &olen);
+		PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+		pos += len;
+		csize += olen;
+	} while (pos < size);
+
+	deflate_destroy(deflate);
+
+	rc = inflate(cbuf, csize, dbuf, size);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_INT_EQUALS(0, memcmp(data, dbuf, size));
+
+	if (rcsize != NULL)
+		*rcsize = csize;
+
+	free(cbuf);
+	free(dbuf);
+}
+
+/** Level out of range is rejected */
+PCUT_TEST(set_level_invalid)
+{
+	deflate_t *deflate;
+	errno_t rc;
+
+	rc = deflate_create(&deflate);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = deflate_set_level(deflate, DEFLATE_LEVEL_MAX + 1);
+	PCUT_ASSERT_ERRNO_VAL(EINVAL, rc);
+
+	deflate_destroy(deflate);
+}
+
+/** Empty input produces a valid stream */
+PCUT_TEST(empty)
+{
+	uint8_t byte = 0;
+
+	test_roundtrip(&byte, 0, DEFLATE_LEVEL_DEFAULT, 1,
+	    deflate_flush_finish, NULL);
+}
+
+/** Text round-trips at all levels and compresses better at higher ones */
+PCUT_TEST(text_levels)
+{
+	uint8_t *data;
+	size_t csize[DEFLATE_LEVEL_MAX + 1];
+	unsigned level;
+
+	data = malloc(test_data_size);
+	PCUT_ASSERT_NOT_NULL(data);
+	test_data_fill(data, test_data_size, test_data_text);
+
+	for (level = 0; level <= DEFLATE_LEVEL_MAX; level++) {
+		test_roundtrip(data, test_data_size, level, test_data_size,
+		    deflate_flush_finish, &csize[level]);
+	}
+
+	PCUT_ASSERT_TRUE(csize[0] > test_data_size);
+	PCUT_ASSERT_TRUE(csize[1] < test_data_size / 3);
+	PCUT_ASSERT_TRUE(csize[DEFLATE_LEVEL_MAX] <= csize[1]);
+
+	free(data);
+}
+
+/** Long runs round-trip at all levels */
+PCUT_TEST(zeros_levels)
+{
+	uint8_t *data;
+	size_t csize;
+	unsigned level;
+
+	data = malloc(test_data_size);
+	PCUT_ASSERT_NOT_NULL(data);
+	test_data_fill(data, test_data_size, test_data_zeros);
+
+	for (level = 1; level <= DEFLATE_LEVEL_MAX; level++) {
+		test_roundtrip(data, test_data_size, level, test_data_size,
+		    deflate_flush_finish, &csize);
+		PCUT_ASSERT_TRUE(csize < test_data_size / 100);
+	}
+
+	free(data);
+}
+
+/** Incompressible data does not grow beyond deflate_bound() */
+PCUT_TEST(random_levels)
+{
+	uint8_t *data;
+	size_t csize;
+	unsigned level;
+
+	data = malloc(test_data_size);
+	PCUT_ASSERT_NOT_NULL(data);
+	test_data_fill(data, test_data_size, test_data_random);
+
+	for (level = 0; level <= DEFLATE_LEVEL_MAX; level++) {
+		test_roundtrip(data, test_data_size, level, test_data_size,
+		    deflate_flush_finish, &csize);
+		PCUT_ASSERT_TRUE(csize <= deflate_bound(test_data_size));
+	}
+
+	free(data);
+}
+
+/** One stream can be produced by many calls */
+PCUT_TEST(chunked)
+{
+	uint8_t *data;
+
+	data = malloc(test_data_size);
+	PCUT_ASSERT_NOT_NULL(data);
+	test_data_fill(data, test_data_size, test_data_text);
+
+	test_roundtrip(data, test_data_size, DEFLATE_LEVEL_DEFAULT, 1000,
+	    deflate_flush_none, NULL);
+	test_roundtrip(data, test_data_size, DEFLATE_LEVEL_DEFAULT, 1000,
+	    deflate_flush_sync, NULL);
+	test_roundtrip(data, test_data_size, DEFLATE_LEVEL_FAST, 7,
+	    deflate_flush_none, NULL);
+
+	free(data);
+}
+
+/** Output of each sync flush can be decoded right away */
+PCUT_TEST(sync_flush_stream)
+{
+	inflate_t *inflate;
+	deflate_t *deflate;
+	uint8_t *data;
+	uint8_t cbuf[2048];
+	uint8_t dbuf[1024];
+	size_t csize;
+	size_t consumed;
+	size_t produced;
+	bool done;
+	size_t pos;
+	errno_t rc;
+
+	data = malloc(test_data_size);
+	PCUT_ASSERT_NOT_NULL(data);
+	test_data_fill(data, test_data_size, test_data_text);
+
+	rc = deflate_create(&deflate);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = inflate_create(&inflate);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	for (pos = 0; pos < 10 * sizeof(dbuf); pos += sizeof(dbuf)) {
+		rc = deflate_compress(deflate, data + pos, sizeof(dbuf), cbuf,
+		    sizeof(cbuf), deflate_flush_sync, &csize);
+		PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+		rc = inflate_stream(inflate, cbuf, csize, &consumed, dbuf,
+		    sizeof(dbuf), &produced, &done);
+		PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+		PCUT_ASSERT_INT_EQUALS(csize, consumed);
+		PCUT_ASSERT_INT_EQUALS(sizeof(dbuf), produced);
+		PCUT_ASSERT_FALSE(done);
+		PCUT_ASSERT_INT_EQUALS(0, memcmp(data + pos, dbuf, produced));
+	}
+
+	inflate_destroy(inflate);
+	deflate_destroy(deflate);
+	free(data);
+}
+
+PCUT_EXPORT(deflate);
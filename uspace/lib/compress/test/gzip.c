@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <deflate.h>
+#include <errno.h>
+#include <gzip.h>
+#include <mem.h>
+#include <pcut/pcut.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(gzip);
+
+/** Written header can be parsed */
+PCUT_TEST(header)
+{
+	uint8_t buf[GZIP_HEADER_SIZE];
+	size_t hdrlen;
+	errno_t rc;
+
+	gzip_write_header(buf, DEFLATE_LEVEL_DEFAULT);
+
+	rc = gzip_parse_header(buf, sizeof(buf), &hdrlen);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_INT_EQUALS(GZIP_HEADER_SIZE, hdrlen);
+
+	rc = gzip_parse_header(buf, sizeof(buf) - 1, &hdrlen);
+	PCUT_ASSERT_ERRNO_VAL(ELIMIT, rc);
+
+	buf[0] = 0;
+	rc = gzip_parse_header(buf, sizeof(buf), &hdrlen);
+	PCUT_ASSERT_ERRNO_VAL(EINVAL, rc);
+}
+
+/** Written footer can be parsed */
+PCUT_TEST(footer)
+{
+	uint8_t buf[GZIP_FOOTER_SIZE];
+	uint32_t crc;
+	uint32_t size;
+
+	gzip_write_footer(buf, 0x12345678, 42);
+	gzip_parse_footer(buf, &crc, &size);
+
+	PCUT_ASSERT_INT_EQUALS(0x12345678, crc);
+	PCUT_ASSERT_INT_EQUALS(42, size);
+
+	/* Little endian */
+	PCUT_ASSERT_INT_EQUALS(0x78, buf[0]);
+	PCUT_ASSERT_INT_EQUALS(42, buf[4]);
+}
+
+/** Known CRC of a short string */
+PCUT_TEST(compress_crc)
+{
+	const char *str = "123456789";
+	uint8_t *buf;
+	size_t size;
+	uint32_t crc;
+	uint32_t isize;
+	errno_t rc;
+
+	rc = gzip_compress(str, 9, DEFLATE_LEVEL_DEFAULT, (void **) &buf,
+	    &size);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	gzip_parse_footer(buf + size - GZIP_FOOTER_SIZE, &crc, &isize);
+	PCUT_ASSERT_INT_EQUALS(0xcbf43926, crc);
+	PCUT_ASSERT_INT_EQUALS(9, isize);
+
+	free(buf);
+}
+
+/** gzip_compress() output can be expanded by gzip_expand() */
+PCUT_TEST(compress_expand)
+{
+	uint8_t *data;
+	void *cdata;
+	void *ddata;
+	size_t csize;
+	size_t dsize;
+	size_t size = 50000;
+	size_t i;
+	unsigned level;
+	errno_t rc;
+
+	data = malloc(size);
+	PCUT_ASSERT_NOT_NULL(data);
+
+	for (i = 0; i < size; i++)
+		data[i] = (i % 251) ^ (i / 1000);
+
+	for (level = 0; level <= DEFLATE_LEVEL_MAX; level++) {
+		rc = gzip_compress(data, size, level, &cdata, &csize);
+		PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+		rc = gzip_expand(cdata, csize, &ddata, &dsize);
+		PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+		PCUT_ASSERT_INT_EQUALS(size, dsize);
+		PCUT_ASSERT_INT_EQUALS(0, memcmp(data, ddata, size));
+
+		free(cdata);
+		free(ddata);
+	}
+
+	free(data);
+}
+
+/** Corrupted CRC is detected by gzip_expand() */
+PCUT_TEST(expand_bad_crc)
+{
+	const char *str = "The quick brown fox jumps over the lazy dog";
+	uint8_t *cdata;
+	void *ddata;
+	size_t csize;
+	size_t dsize;
+	errno_t rc;
+
+	rc = gzip_compress(str, 43, DEFLATE_LEVEL_DEFAULT, (void **) &cdata,
+	    &csize);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	cdata[csize - GZIP_FOOTER_SIZE] ^= 1;
+
+	rc = gzip_expand(cdata, csize, &ddata, &dsize);
+	PCUT_ASSERT_ERRNO_VAL(EINVAL, rc);
+
+	free(cdata);
+}
+
+/** Invalid level is rejected */
+PCUT_TEST(compress_invalid_level)
+{
+	void *cdata;
+	size_t csize;
+	errno_t rc;
+
+	rc = gzip_compress("x", 1, DEFLATE_LEVEL_MAX + 1, &cdata, &csize);
+	PCUT_ASSERT_ERRNO_VAL(EINVAL, rc);
+}
+
+PCUT_EXPORT(gzip);
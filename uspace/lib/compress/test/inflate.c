@@ -0,0 +1,380 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <deflate.h>
+#include <errno.h>
+#include <inflate.h>
+#include <mem.h>
+#include <pcut/pcut.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(inflate);
+
+enum {
+	/** Size of text compressed in @c test_dyn_stream */
+	test_dynamic_size = 2000,
+	/** Size of text compressed by deflate_compress() */
+	test_text_size = 100000
+};
+
+/** Text of test_dynamic_size bytes compressed by zlib at level 9.
+ *
+ * Contains a single block coded with a dynamic Huffman code.
+ */
+static uint8_t test_dyn_stream[] = {
+	0x8d, 0x54, 0x5b, 0x0e, 0xc2, 0x30, 0x0c, 0xfb, 0xcf, 0x29, 0x76, 0xb5,
+	0x21, 0xa6, 0x81, 0xb4, 0xc1, 0x24, 0xb8, 0xbf, 0x80, 0xa6, 0x55, 0xed,
+	0xc4, 0x05, 0x7e, 0x56, 0xc8, 0x3b, 0x76, 0x92, 0x75, 0xde, 0xf7, 0x79,
+	0x9a, 0xb7, 0xe3, 0x32, 0x4f, 0xe7, 0x65, 0x7b, 0xf2, 0xf7, 0xb4, 0xbc,
+	0x3f, 0x6b, 0x31, 0x59, 0x8e, 0xc7, 0x75, 0xbb, 0xdf, 0xea, 0x3f, 0x77,
+	0x28, 0xea, 0xa6, 0x70, 0x11, 0x1b, 0x93, 0x41, 0x7c, 0xdd, 0xd4, 0xdc,
+	0xaf, 0x09, 0x31, 0x3b, 0x56, 0x55, 0x22, 0x99, 0x59, 0x7d, 0xcb, 0xe3,
+	0xbf, 0x5d, 0xcf, 0x55, 0x98, 0xc7, 0xfe, 0xd1, 0x8a, 0xfb, 0x63, 0x96,
+	0x1a, 0xb8, 0x56, 0x86, 0x41, 0xb8, 0xbe, 0x9e, 0x1e, 0xed, 0x5d, 0xc7,
+	0x39, 0xda, 0x5b, 0xd3, 0x58, 0x7b, 0xfd, 0x01, 0x18, 0x87, 0x50, 0x23,
+	0x16, 0x23, 0x9e, 0x94, 0x9f, 0x20, 0x07, 0xa1, 0x1c, 0x27, 0xc1, 0xdf,
+	0x6c, 0x25, 0x12, 0x18, 0x75, 0x5d, 0x44, 0x0c, 0x68, 0xe0, 0xd7, 0x24,
+	0xaa, 0x28, 0x4b, 0x31, 0x5a, 0x24, 0x37, 0xe2, 0x4a, 0x5a, 0x7a, 0xe7,
+	0x0d, 0x02, 0xa8, 0xc6, 0x01, 0x6d, 0x4e, 0x4f, 0x03, 0x11, 0x19, 0x4e,
+	0x5e, 0x5d, 0x15, 0xfd, 0x33, 0x55, 0x38, 0x62, 0x34, 0xef, 0x82, 0xa3,
+	0x34, 0xa7, 0x46, 0x6a, 0x6c, 0x5f, 0x61, 0x08, 0x2b, 0xc1, 0xcd, 0x93,
+	0x41, 0x1a, 0x04, 0xb5, 0x3e, 0xc9, 0xb2, 0xd6, 0xc3, 0x95, 0x0e, 0x67,
+	0x02, 0x5b, 0x08, 0xcb, 0x4e, 0x9b, 0xd2, 0x88, 0xfd, 0xb2, 0xbb, 0x7a,
+	0x99, 0x50, 0x37, 0xc2, 0x59, 0x4d, 0xb1, 0x00, 0x0c, 0xc9, 0x52, 0xa8,
+	0xa2, 0x1e, 0x52, 0x41, 0xb7, 0x69, 0x6a, 0xd5, 0x21, 0x34, 0x3d, 0x70,
+	0xed, 0x9e, 0x41, 0x20, 0xb5, 0x18, 0x61, 0x85, 0xb0, 0x59, 0x16, 0x6a,
+	0xa0, 0x2c, 0x72, 0x13, 0x00, 0x8f, 0x57, 0x08, 0xef, 0x6a, 0xde, 0x68,
+	0x3c, 0x22, 0xc4, 0x18, 0x85, 0xce, 0x67, 0x41, 0x11, 0x12, 0xc7, 0x05,
+	0xb2, 0x0d, 0x47, 0xbc, 0x63, 0x27, 0x16, 0xc7, 0x34, 0xd5, 0x9c, 0x35,
+	0xb1, 0x90, 0xc8, 0x53, 0xb5, 0xfe, 0xb5, 0x39, 0xbd, 0x28, 0x31, 0x8c,
+	0x88, 0x13, 0x12, 0x9b, 0xc4, 0xf2, 0x2e, 0x49, 0x96, 0x68, 0xad, 0x3e,
+	0x92, 0x17
+};
+
+/** Stream with a match before the start of the data */
+static uint8_t test_far[] = {
+	0x4b, 0xc7, 0x22, 0x06, 0x00
+};
+
+/** Simple linear congruential generator for reproducible test data */
+static uint32_t test_rand(uint32_t *seed)
+{
+	*seed = *seed * 1103515245 + 12345;
+	return *seed >> 16;
+}
+
+/** Fill buffer with text made of random words. */
+static void test_text_fill(uint8_t *buf, size_t size)
+{
+	static const char *words[] = {
+		"alpha ", "beta ", "gamma ", "delta ", "\n", "epsilon "
+	};
+	uint32_t seed = 1;
+	size_t pos = 0;
+	const char *w;
+
+	while (pos < size) {
+		w = words[test_rand(&seed) % 6];
+		while (*w != '\0' && pos < size)
+			buf[pos++] = *w++;
+	}
+}
+
+/** Decode stream using random sizes of input and output chunks.
+ *
+ * @param src Compressed data
+ * @param srclen Size of compressed data
+ * @param data Expected decompressed data
+ * @param size Size of expected decompressed data
+ * @param maxin Maximum size of input chunk
+ * @param maxout Maximum size of output chunk
+ */
+static void test_decode_chunked(const uint8_t *src, size_t srclen,
+    const uint8_t *data, size_t size, size_t maxin, size_t maxout)
+{
+	inflate_t *state;
+	uint8_t *dbuf;
+	uint32_t seed = 42;
+	size_t ipos = 0;
+	size_t opos = 0;
+	size_t ilen, olen;
+	size_t consumed;
+	size_t produced;
+	bool done = false;
+	errno_t rc;
+
+	dbuf = malloc(size + maxout);
+	PCUT_ASSERT_NOT_NULL(dbuf);
+
+	rc = inflate_create(&state);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	while (!done) {
+		ilen = 1 + test_rand(&seed) % maxin;
+		if (ilen > srclen - ipos)
+			ilen = srclen - ipos;
+		olen = 1 + test_rand(&seed) % maxout;
+
+		rc = inflate_stream(state, src + ipos, ilen, &consumed,
+		    dbuf + opos, olen, &produced, &done);
+		PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+		PCUT_ASSERT_TRUE(consumed <= ilen);
+		PCUT_ASSERT_TRUE(produced <= olen);
+
+		/* Progress is made unless the stream has ended */
+		PCUT_ASSERT_TRUE(done || consumed > 0 || produced > 0);
+
+		ipos += consumed;
+		opos += produced;
+		PCUT_ASSERT_TRUE(opos <= size);
+	}
+
+	PCUT_ASSERT_INT_EQUALS(srclen, ipos);
+	PCUT_ASSERT_INT_EQUALS(size, opos);
+	PCUT_ASSERT_INT_EQUALS(0, memcmp(data, dbuf, size));
+
+	inflate_destroy(state);
+	free(dbuf);
+}
+
+/** Compress text of test_text_size bytes with deflate_compress(). */
+static uint8_t *test_text_compress(uint8_t **rdata, size_t *rcsize)
+{
+	deflate_t *deflate;
+	uint8_t *data;
+	uint8_t *cbuf;
+	size_t csize;
+	errno_t rc;
+
+	data = malloc(test_text_size);
+	PCUT_ASSERT_NOT_NULL(data);
+	test_text_fill(data, test_text_size);
+
+	cbuf = malloc(deflate_bound(test_text_size));
+	PCUT_ASSERT_NOT_NULL(cbuf);
+
+	rc = deflate_create(&deflate);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = deflate_compress(deflate, data, test_text_size, cbuf,
+	    deflate_bound(test_text_size), deflate_flush_finish, &csize);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	deflate_destroy(deflate);
+
+	*rdata = data;
+	*rcsize = csize;
+	return cbuf;
+}
+
+/** Stored blocks, including an empty one, are copied */
+PCUT_TEST(stored)
+{
+	uint8_t src[] = {
+		0x00, 0x03, 0x00, 0xfc, 0xff, 'a', 'b', 'c',
+		0x00, 0x00, 0x00, 0xff, 0xff,
+		0x01, 0x02, 0x00, 0xfd, 0xff, 'd', 'e'
+	};
+	uint8_t dest[5];
+	errno_t rc;
+
+	rc = inflate(src, sizeof(src), dest, sizeof(dest));
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_INT_EQUALS(0, memcmp("abcde", dest, sizeof(dest)));
+}
+
+/** Block with a dynamic Huffman code is decoded */
+PCUT_TEST(dynamic)
+{
+	uint8_t data[test_dynamic_size];
+	uint8_t dest[test_dynamic_size];
+	errno_t rc;
+
+	test_text_fill(data, sizeof(data));
+
+	rc = inflate(test_dyn_stream, sizeof(test_dyn_stream), dest, sizeof(dest));
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_INT_EQUALS(0, memcmp(data, dest, sizeof(dest)));
+
+	/* Output buffer too small */
+	rc = inflate(test_dyn_stream, sizeof(test_dyn_stream), dest,
+	    sizeof(dest) - 1);
+	PCUT_ASSERT_ERRNO_VAL(ENOMEM, rc);
+}
+
+/** Decoding does not depend on how input and output are split */
+PCUT_TEST(chunked)
+{
+	uint8_t data[test_dynamic_size];
+	uint8_t *text;
+	uint8_t *cbuf;
+	size_t csize;
+
+	test_text_fill(data, sizeof(data));
+
+	test_decode_chunked(test_dyn_stream, sizeof(test_dyn_stream), data, sizeof(data),
+	    1, 1);
+	test_decode_chunked(test_dyn_stream, sizeof(test_dyn_stream), data, sizeof(data),
+	    7, 300);
+	test_decode_chunked(test_dyn_stream, sizeof(test_dyn_stream), data, sizeof(data),
+	    300, 7);
+
+	cbuf = test_text_compress(&text, &csize);
+	test_decode_chunked(cbuf, csize, text, test_text_size, 1, 1);
+	test_decode_chunked(cbuf, csize, text, test_text_size, 100, 1000);
+	test_decode_chunked(cbuf, csize, text, test_text_size, 5000, 40000);
+
+	free(cbuf);
+	free(text);
+}
+
+/** Bytes following the end of the stream are not consumed */
+PCUT_TEST(trailer)
+{
+	uint8_t src[sizeof(test_dyn_stream) + 8];
+	uint8_t dest[test_dynamic_size];
+	inflate_t *state;
+	size_t consumed;
+	size_t produced;
+	bool done;
+	errno_t rc;
+
+	memcpy(src, test_dyn_stream, sizeof(test_dyn_stream));
+	memset(src + sizeof(test_dyn_stream), 0xff, 8);
+
+	rc = inflate_create(&state);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = inflate_stream(state, src, sizeof(src), &consumed, dest,
+	    sizeof(dest), &produced, &done);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_TRUE(done);
+	PCUT_ASSERT_INT_EQUALS(sizeof(test_dyn_stream), consumed);
+	PCUT_ASSERT_INT_EQUALS(sizeof(dest), produced);
+
+	inflate_destroy(state);
+}
+
+/** Truncated stream is not reported as complete */
+PCUT_TEST(truncated)
+{
+	uint8_t dest[test_dynamic_size + 1];
+	inflate_t *state;
+	size_t consumed;
+	size_t produced;
+	size_t len;
+	bool done;
+	errno_t rc;
+
+	rc = inflate_create(&state);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	for (len = 0; len < sizeof(test_dyn_stream); len++) {
+		rc = inflate(test_dyn_stream, len, dest, sizeof(dest));
+		PCUT_ASSERT_ERRNO_VAL(ELIMIT, rc);
+
+		inflate_reset(state);
+		rc = inflate_stream(state, test_dyn_stream, len, &consumed,
+		    dest, sizeof(dest), &produced, &done);
+		PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+		PCUT_ASSERT_FALSE(done);
+		PCUT_ASSERT_INT_EQUALS(len, consumed);
+		PCUT_ASSERT_TRUE(produced <= test_dynamic_size);
+	}
+
+	inflate_destroy(state);
+}
+
+/** Invalid streams are rejected and the error is sticky until reset */
+PCUT_TEST(corrupt)
+{
+	/* Final block of reserved type 3 */
+	uint8_t badtype[] = { 0x07, 0x00 };
+	/* Stored block length does not match its complement */
+	uint8_t badlen[] = { 0x01, 0x03, 0x00, 0xfc, 0xfe, 'a', 'b', 'c' };
+	uint8_t dest[test_dynamic_size];
+	inflate_t *state;
+	size_t consumed;
+	size_t produced;
+	bool done;
+	errno_t rc;
+
+	rc = inflate(badtype, sizeof(badtype), dest, sizeof(dest));
+	PCUT_ASSERT_ERRNO_VAL(EINVAL, rc);
+
+	rc = inflate(badlen, sizeof(badlen), dest, sizeof(dest));
+	PCUT_ASSERT_ERRNO_VAL(EINVAL, rc);
+
+	rc = inflate(test_far, sizeof(test_far), dest, sizeof(dest));
+	PCUT_ASSERT_ERRNO_VAL(ENOENT, rc);
+
+	rc = inflate_create(&state);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = inflate_stream(state, badtype, sizeof(badtype), &consumed,
+	    dest, sizeof(dest), &produced, &done);
+	PCUT_ASSERT_ERRNO_VAL(EINVAL, rc);
+
+	rc = inflate_stream(state, test_dyn_stream, sizeof(test_dyn_stream),
+	    &consumed, dest, sizeof(dest), &produced, &done);
+	PCUT_ASSERT_ERRNO_VAL(EINVAL, rc);
+	PCUT_ASSERT_FALSE(done);
+
+	inflate_reset(state);
+	rc = inflate_stream(state, test_dyn_stream, sizeof(test_dyn_stream),
+	    &consumed, dest, sizeof(dest), &produced, &done);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_TRUE(done);
+
+	inflate_destroy(state);
+}
+
+/** Damaged streams are decoded without overrunning buffers */
+PCUT_TEST(damaged)
+{
+	uint8_t src[sizeof(test_dyn_stream)];
+	uint8_t dest[test_dynamic_size];
+	uint32_t seed = 7;
+	unsigned i;
+	size_t pos;
+
+	for (i = 0; i < 2000; i++) {
+		memcpy(src, test_dyn_stream, sizeof(src));
+		pos = test_rand(&seed) % sizeof(src);
+		src[pos] ^= 1 << (test_rand(&seed) % 8);
+
+		/* Any result is fine as long as it returns */
+		(void) inflate(src, sizeof(src), dest, sizeof(dest));
+	}
+}
+
+PCUT_EXPORT(inflate);
@@ -39,13 +39,33 @@
 
 #include <adt/list.h>
 #include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
+#include <uchar.h>
 #include <types/gfx/bitmap.h>
 #include <types/gfx/context.h>
 #include <types/gfx/font.h>
+#include <types/gfx/glyph.h>
 #include <types/gfx/typeface.h>
 #include <riff/chunk.h>
 
+/** Glyph index entry.
+ *
+ * The glyph index has one entry for each glyph pattern in the font.
+ * Entries are sorted by the first character of the pattern and then
+ * by the order in which a linear search through the glyphs and their
+ * patterns would try them.
+ */
+typedef struct {
+	/** First character of the pattern (0 if pattern is empty) */
+	char32_t c;
+	/** Search order */
+	size_t order;
+	/** Pattern */
+	gfx_glyph_pattern_t *pat;
+} gfx_font_ientry_t;
+
 /** Font
  *
  * This is private to libgfxfont.
@@ -69,6 +89,16 @@ struct gfx_font {
 	gfx_bitmap_t *bitmap;
 	/** Bitmap rectangle */
 	gfx_rect_t rect;
+	/** Glyph index (array of @c index_entries entries) */
+	gfx_font_ientry_t *index;
+	/** Number of entries in @c index */
+	size_t index_entries;
+	/** @c true iff @c index is up to date */
+	bool index_valid;
+	/** Scratch bitmap for composing text runs or @c NULL */
+	gfx_bitmap_t *run_bitmap;
+	/** Rectangle of @c run_bitmap */
+	gfx_rect_t run_rect;
 };
 
 /** Font info
@@ -88,6 +118,9 @@ struct gfx_font_info {
 	riff_rchunk_t fontck;
 };
 
+extern void gfx_font_invalidate_index(gfx_font_t *);
+extern errno_t gfx_font_get_run_bitmap(gfx_font_t *, gfx_coord_t, gfx_coord_t,
+    gfx_bitmap_t **);
 extern errno_t gfx_font_splice_at_glyph(gfx_font_t *, gfx_glyph_t *,
     gfx_rect_t *);
 extern errno_t gfx_font_info_load(gfx_typeface_t *, riff_rchunk_t *);
@@ -42,6 +42,7 @@
 #include <gfx/glyph.h>
 #include <mem.h>
 #include <stdlib.h>
+#include <str.h>
 #include "../private/font.h"
 #include "../private/glyph.h"
 #include "../private/tpf_file.h"
@@ -243,7 +244,11 @@ void gfx_font_close(gfx_font_t *font)
 		glyph = gfx_font_first_glyph(font);
 	}
 
+	if (font->run_bitmap != NULL)
+		gfx_bitmap_destroy(font->run_bitmap);
+
 	font->finfo->font = NULL;
+	free(font->index);
 	free(font);
 }
 
@@ -333,7 +338,131 @@ gfx_glyph_t *gfx_font_prev_glyph(gfx_glyph_t *cur)
 	return list_get_instance(link, gfx_glyph_t, lglyphs);
 }
 
+/** Invalidate glyph index.
+ *
+ * Must be called whenever glyphs or glyph patterns are added or removed.
+ * The index will be rebuilt on the next glyph search.
+ *
+ * @param font Font
+ */
+void gfx_font_invalidate_index(gfx_font_t *font)
+{
+	font->index_valid = false;
+}
+
+/** Compare two glyph index entries.
+ *
+ * @param a First entry
+ * @param b Second entry
+ * @return <0, 0, >0 if @a a sorts before, same as, after @a b
+ */
+static int gfx_font_ientry_cmp(const void *a, const void *b)
+{
+	const gfx_font_ientry_t *ea = (const gfx_font_ientry_t *) a;
+	const gfx_font_ientry_t *eb = (const gfx_font_ientry_t *) b;
+
+	if (ea->c != eb->c)
+		return ea->c < eb->c ? -1 : 1;
+
+	if (ea->order != eb->order)
+		return ea->order < eb->order ? -1 : 1;
+
+	return 0;
+}
+
+/** Build glyph index.
+ *
+ * @param font Font
+ * @return EOK on success, ENOMEM if out of memory
+ */
+static errno_t gfx_font_build_index(gfx_font_t *font)
+{
+	gfx_font_ientry_t *index;
+	gfx_glyph_t *glyph;
+	gfx_glyph_pattern_t *pat;
+	size_t count;
+	size_t off;
+
+	count = 0;
+	glyph = gfx_font_first_glyph(font);
+	while (glyph != NULL) {
+		pat = gfx_glyph_first_pattern(glyph);
+		while (pat != NULL) {
+			++count;
+			pat = gfx_glyph_next_pattern(pat);
+		}
+
+		glyph = gfx_font_next_glyph(glyph);
+	}
+
+	index = NULL;
+	if (count > 0) {
+		index = calloc(count, sizeof(gfx_font_ientry_t));
+		if (index == NULL)
+			return ENOMEM;
+	}
+
+	count = 0;
+	glyph = gfx_font_first_glyph(font);
+	while (glyph != NULL) {
+		pat = gfx_glyph_first_pattern(glyph);
+		while (pat != NULL) {
+			off = 0;
+			index[count].c = str_decode(pat->text, &off, STR_NO_LIMIT);
+			index[count].order = count;
+			index[count].pat = pat;
+			++count;
+
+			pat = gfx_glyph_next_pattern(pat);
+		}
+
+		glyph = gfx_font_next_glyph(glyph);
+	}
+
+	if (count > 1)
+		qsort(index, count, sizeof(gfx_font_ientry_t), gfx_font_ientry_cmp);
+
+	free(font->index);
+	font->index = index;
+	font->index_entries = count;
+	font->index_valid = true;
+	return EOK;
+}
+
+/** Find first index entry whose pattern starts with a character.
+ *
+ * @param font Font (with valid index)
+ * @param c Character
+ * @param str String whose beginning we would like to set
+ * @return Matching index entry with lowest search order or @c NULL
+ */
+static gfx_font_ientry_t *gfx_font_index_find(gfx_font_t *font, char32_t c,
+    const char *str)
+{
+	size_t lo, hi, mid;
+
+	lo = 0;
+	hi = font->index_entries;
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (font->index[mid].c < c)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	while (lo < font->index_entries && font->index[lo].c == c) {
+		if (str_test_prefix(str, font->index[lo].pat->text))
+			return &font->index[lo];
+		++lo;
+	}
+
+	return NULL;
+}
+
 /** Search for glyph that should be set for the beginning of a string.
+ *
+ * Same as gfx_font_search_glyph(), but does not use the glyph index.
  *
  * @param font Font
  * @param str String whose beginning we would like to set
@@ -341,7 +470,7 @@ gfx_glyph_t *gfx_font_prev_glyph(gfx_glyph_t *cur)
  * @param rsize Place to store number of bytes to advance in the string
  * @return EOK on success, ENOENT if no matching glyph was found
  */
-errno_t gfx_font_search_glyph(gfx_font_t *font, const char *str,
+static errno_t gfx_font_search_glyph_linear(gfx_font_t *font, const char *str,
     gfx_glyph_t **rglyph, size_t *rsize)
 {
 	gfx_glyph_t *glyph;
@@ -361,6 +490,108 @@ errno_t gfx_font_search_glyph(gfx_font_t *font, const char *str,
 	return ENOENT;
 }
 
+/** Search for glyph that should be set for the beginning of a string.
+ *
+ * The first glyph (in font order) with a pattern matching the beginning
+ * of @a str is returned. The search uses the glyph index, which is
+ * (re)built on demand.
+ *
+ * @param font Font
+ * @param str String whose beginning we would like to set
+ * @param rglyph Place to store glyph that should be set
+ * @param rsize Place to store number of bytes to advance in the string
+ * @return EOK on success, ENOENT if no matching glyph was found
+ */
+errno_t gfx_font_search_glyph(gfx_font_t *font, const char *str,
+    gfx_glyph_t **rglyph, size_t *rsize)
+{
+	gfx_font_ientry_t *e;
+	gfx_font_ientry_t *e0;
+	char32_t c;
+	size_t off;
+	errno_t rc;
+
+	if (!font->index_valid) {
+		rc = gfx_font_build_index(font);
+		if (rc != EOK) {
+			/* Fall back to searching without index */
+			return gfx_font_search_glyph_linear(font, str, rglyph,
+			    rsize);
+		}
+	}
+
+	off = 0;
+	c = str_decode(str, &off, STR_NO_LIMIT);
+
+	e = gfx_font_index_find(font, c, str);
+
+	/* Empty patterns match any string */
+	if (c != 0) {
+		e0 = gfx_font_index_find(font, 0, str);
+		if (e0 != NULL && (e == NULL || e0->order < e->order))
+			e = e0;
+	}
+
+	if (e == NULL)
+		return ENOENT;
+
+	*rglyph = e->pat->glyph;
+	*rsize = str_size(e->pat->text);
+	return EOK;
+}
+
+/** Get scratch bitmap for composing text runs.
+ *
+ * The bitmap is kept with the font and grown as needed. It has
+ * the same flags and key color as the font bitmap.
+ *
+ * @param font Font
+ * @param width Minimum width
+ * @param height Minimum height
+ * @param rbitmap Place to store pointer to bitmap
+ * @return EOK on success or an error code
+ */
+errno_t gfx_font_get_run_bitmap(gfx_font_t *font, gfx_coord_t width,
+    gfx_coord_t height, gfx_bitmap_t **rbitmap)
+{
+	gfx_bitmap_params_t params;
+	gfx_bitmap_t *bitmap;
+	errno_t rc;
+
+	if (font->run_bitmap != NULL && width <= font->run_rect.p1.x &&
+	    height <= font->run_rect.p1.y) {
+		*rbitmap = font->run_bitmap;
+		return EOK;
+	}
+
+	gfx_bitmap_params_init(&params);
+	params.rect.p0.x = 0;
+	params.rect.p0.y = 0;
+	params.rect.p1.x = width;
+	params.rect.p1.y = height;
+	if (font->run_bitmap != NULL) {
+		if (font->run_rect.p1.x > width)
+			params.rect.p1.x = font->run_rect.p1.x;
+		if (font->run_rect.p1.y > height)
+			params.rect.p1.y = font->run_rect.p1.y;
+	}
+
+	params.flags = bmpf_color_key | bmpf_colorize;
+	params.key_color = PIXEL(0, 0, 0, 0);
+
+	rc = gfx_bitmap_create(font->typeface->gc, &params, NULL, &bitmap);
+	if (rc != EOK)
+		return rc;
+
+	if (font->run_bitmap != NULL)
+		gfx_bitmap_destroy(font->run_bitmap);
+
+	font->run_bitmap = bitmap;
+	font->run_rect = params.rect;
+	*rbitmap = bitmap;
+	return EOK;
+}
+
 /** Replace glyph graphic with empty space of specified width.
  *
  * This is used to resize a glyph in the font bitmap. This changes
@@ -44,8 +44,37 @@
 #include <mem.h>
 #include <str.h>
 #include "../private/font.h"
+#include "../private/glyph.h"
 #include "../private/typeface.h"
 
+enum {
+	/** Maximum number of glyphs in a text run */
+	gfx_text_run_max = 64
+};
+
+/** Glyph placed in a text run */
+typedef struct {
+	/** Glyph */
+	gfx_glyph_t *glyph;
+	/** Pen position */
+	gfx_coord2_t pos;
+} gfx_text_run_glyph_t;
+
+/** Text run.
+ *
+ * A sequence of glyphs that is composed in the font's scratch bitmap
+ * and then rendered with a single bitmap render operation, instead
+ * of rendering each glyph from the font bitmap separately.
+ */
+typedef struct {
+	/** Font */
+	gfx_font_t *font;
+	/** Number of glyphs in @c glyphs */
+	size_t nglyphs;
+	/** Glyphs */
+	gfx_text_run_glyph_t glyphs[gfx_text_run_max];
+} gfx_text_run_t;
+
 /** Initialize text formatting structure.
  *
  * Text formatting structure must always be initialized using this function
@@ -191,6 +220,170 @@ static errno_t gfx_puttext_textmode(gfx_coord2_t *pos, gfx_text_fmt_t *fmt,
 	return rc;
 }
 
+/** Initialize text run.
+ *
+ * @param run Text run
+ * @param font Font
+ */
+static void gfx_text_run_init(gfx_text_run_t *run, gfx_font_t *font)
+{
+	run->font = font;
+	run->nglyphs = 0;
+}
+
+/** Compose text run in scratch bitmap and render it.
+ *
+ * @param run Text run
+ * @return EOK on success or an error code
+ */
+static errno_t gfx_text_run_compose(gfx_text_run_t *run)
+{
+	gfx_font_t *font = run->font;
+	gfx_text_run_glyph_t *rg;
+	gfx_bitmap_alloc_t falloc;
+	gfx_bitmap_alloc_t ralloc;
+	gfx_bitmap_t *bitmap;
+	gfx_coord2_t offs;
+	gfx_rect_t grect;
+	gfx_rect_t bbox;
+	gfx_rect_t env;
+	gfx_rect_t srect;
+	uint32_t *sp;
+	uint32_t *dp;
+	gfx_coord_t x, y;
+	gfx_coord_t dx, dy;
+	size_t i;
+	errno_t rc;
+
+	/* Compute bounding rectangle of the run on the destination */
+	bbox.p0.x = 0;
+	bbox.p0.y = 0;
+	bbox.p1.x = 0;
+	bbox.p1.y = 0;
+
+	for (i = 0; i < run->nglyphs; i++) {
+		rg = &run->glyphs[i];
+		gfx_coord2_subtract(&rg->pos, &rg->glyph->origin, &offs);
+		gfx_rect_translate(&offs, &rg->glyph->rect, &grect);
+		gfx_rect_envelope(&bbox, &grect, &env);
+		bbox = env;
+	}
+
+	if (gfx_rect_is_empty(&bbox))
+		return EOK;
+
+	rc = gfx_bitmap_get_alloc(font->bitmap, &falloc);
+	if (rc != EOK)
+		return rc;
+
+	rc = gfx_font_get_run_bitmap(font, bbox.p1.x - bbox.p0.x,
+	    bbox.p1.y - bbox.p0.y, &bitmap);
+	if (rc != EOK)
+		return rc;
+
+	rc = gfx_bitmap_get_alloc(bitmap, &ralloc);
+	if (rc != EOK)
+		return rc;
+
+	/* Clear the part of the scratch bitmap we are going to use */
+	for (y = 0; y < bbox.p1.y - bbox.p0.y; y++) {
+		dp = (uint32_t *) ((char *) ralloc.pixels + y * ralloc.pitch);
+		memset(dp, 0, (bbox.p1.x - bbox.p0.x) * sizeof(uint32_t));
+	}
+
+	/*
+	 * Copy glyphs. Key-colored (transparent) pixels are skipped so that
+	 * overlapping glyphs combine the same way as when they are rendered
+	 * one by one.
+	 */
+	for (i = 0; i < run->nglyphs; i++) {
+		rg = &run->glyphs[i];
+
+		/* Offset from font bitmap to scratch bitmap */
+		dx = rg->pos.x - rg->glyph->origin.x - bbox.p0.x;
+		dy = rg->pos.y - rg->glyph->origin.y - bbox.p0.y;
+
+		for (y = rg->glyph->rect.p0.y; y < rg->glyph->rect.p1.y; y++) {
+			sp = (uint32_t *) ((char *) falloc.pixels +
+			    y * falloc.pitch) + rg->glyph->rect.p0.x;
+			dp = (uint32_t *) ((char *) ralloc.pixels +
+			    (y + dy) * ralloc.pitch) + rg->glyph->rect.p0.x + dx;
+
+			for (x = rg->glyph->rect.p0.x; x < rg->glyph->rect.p1.x;
+			    x++) {
+				if (*sp != PIXEL(0, 0, 0, 0))
+					*dp = *sp;
+				++sp;
+				++dp;
+			}
+		}
+	}
+
+	srect.p0.x = 0;
+	srect.p0.y = 0;
+	srect.p1.x = bbox.p1.x - bbox.p0.x;
+	srect.p1.y = bbox.p1.y - bbox.p0.y;
+
+	return gfx_bitmap_render(bitmap, &srect, &bbox.p0);
+}
+
+/** Render text run and empty it.
+ *
+ * @param run Text run
+ * @return EOK on success or an error code
+ */
+static errno_t gfx_text_run_flush(gfx_text_run_t *run)
+{
+	size_t i;
+	errno_t rc;
+
+	if (run->nglyphs > 1) {
+		rc = gfx_text_run_compose(run);
+		if (rc == EOK) {
+			run->nglyphs = 0;
+			return EOK;
+		}
+
+		/* Could not compose the run, render glyphs one by one */
+	}
+
+	for (i = 0; i < run->nglyphs; i++) {
+		rc = gfx_glyph_render(run->glyphs[i].glyph,
+		    &run->glyphs[i].pos);
+		if (rc != EOK)
+			return rc;
+	}
+
+	run->nglyphs = 0;
+	return EOK;
+}
+
+/** Add glyph to text run.
+ *
+ * If the run is full, it is rendered first.
+ *
+ * @param run Text run
+ * @param glyph Glyph
+ * @param pos Pen position
+ * @return EOK on success or an error code
+ */
+static errno_t gfx_text_run_add(gfx_text_run_t *run, gfx_glyph_t *glyph,
+    gfx_coord2_t *pos)
+{
+	errno_t rc;
+
+	if (run->nglyphs >= gfx_text_run_max) {
+		rc = gfx_text_run_flush(run);
+		if (rc != EOK)
+			return rc;
+	}
+
+	run->glyphs[run->nglyphs].glyph = glyph;
+	run->glyphs[run->nglyphs].pos = *pos;
+	++run->nglyphs;
+	return EOK;
+}
+
 /** Get text starting position.
  *
  * @param pos Anchor position
@@ -246,6 +439,9 @@ void gfx_text_start_pos(gfx_coord2_t *pos, gfx_text_fmt_t *fmt,
 }
 
 /** Render text.
+ *
+ * Glyphs are collected into text runs which are rendered with a single
+ * bitmap render operation each.
  *
  * @param pos Anchor position
  * @param fmt Text formatting
@@ -261,10 +457,12 @@ errno_t gfx_puttext(gfx_coord2_t *pos, gfx_text_fmt_t *fmt, const char *str)
 	gfx_glyph_t *glyph;
 	gfx_coord2_t cpos;
 	gfx_coord2_t spos;
+	gfx_text_run_t run;
 	gfx_rect_t rect;
 	gfx_coord_t width;
 	gfx_coord_t rmargin;
 	bool ellipsis;
+	int i;
 	errno_t rc;
 
 	gfx_text_start_pos(pos, fmt, str, &spos);
@@ -288,6 +486,8 @@ errno_t gfx_puttext(gfx_coord2_t *pos, gfx_text_fmt_t *fmt, const char *str)
 		rmargin = spos.x + width;
 	}
 
+	gfx_text_run_init(&run, fmt->font);
+
 	cpos = spos;
 	cp = str;
 	while (*cp != '\0') {
@@ -303,7 +503,7 @@ errno_t gfx_puttext(gfx_coord2_t *pos, gfx_text_fmt_t *fmt, const char *str)
 		if (fmt->abbreviate && cpos.x + gmetrics.advance > rmargin)
 			break;
 
-		rc = gfx_glyph_render(glyph, &cpos);
+		rc = gfx_text_run_add(&run, glyph, &cpos);
 		if (rc != EOK)
 			return rc;
 
@@ -311,6 +511,10 @@ errno_t gfx_puttext(gfx_coord2_t *pos, gfx_text_fmt_t *fmt, const char *str)
 		cpos.x += gmetrics.advance;
 	}
 
+	rc = gfx_text_run_flush(&run);
+	if (rc != EOK)
+		return rc;
+
 	/* Text underlining */
 	if (fmt->underline) {
 		gfx_font_get_metrics(fmt->font, &fmetrics);
@@ -333,19 +537,15 @@ errno_t gfx_puttext(gfx_coord2_t *pos, gfx_text_fmt_t *fmt, const char *str)
 
 		gfx_glyph_get_metrics(glyph, &gmetrics);
 
-		rc = gfx_glyph_render(glyph, &cpos);
-		if (rc != EOK)
-			return rc;
-
-		cpos.x += gmetrics.advance;
+		for (i = 0; i < 3; i++) {
+			rc = gfx_text_run_add(&run, glyph, &cpos);
+			if (rc != EOK)
+				return rc;
 
-		rc = gfx_glyph_render(glyph, &cpos);
-		if (rc != EOK)
-			return rc;
-
-		cpos.x += gmetrics.advance;
+			cpos.x += gmetrics.advance;
+		}
 
-		rc = gfx_glyph_render(glyph, &cpos);
+		rc = gfx_text_run_flush(&run);
 		if (rc != EOK)
 			return rc;
 	}
@@ -419,6 +419,98 @@ PCUT_TEST(search_glyph)
 	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
 }
 
+/** gfx_font_search_glyph() returns first matching glyph in font order */
+PCUT_TEST(search_glyph_order)
+{
+	gfx_font_props_t props;
+	gfx_font_metrics_t metrics;
+	gfx_glyph_metrics_t gmetrics;
+	gfx_typeface_t *tface;
+	gfx_font_t *font;
+	gfx_context_t *gc;
+	gfx_glyph_t *glyph1;
+	gfx_glyph_t *glyph2;
+	gfx_glyph_t *glyph3;
+	gfx_glyph_t *glyph;
+	size_t bytes;
+	test_gc_t tgc;
+	errno_t rc;
+
+	rc = gfx_context_new(&test_ops, (void *)&tgc, &gc);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = gfx_typeface_create(gc, &tface);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	gfx_font_props_init(&props);
+	gfx_font_metrics_init(&metrics);
+	rc = gfx_font_create(tface, &props, &metrics, &font);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	gfx_glyph_metrics_init(&gmetrics);
+
+	rc = gfx_glyph_create(font, &gmetrics, &glyph1);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	rc = gfx_glyph_set_pattern(glyph1, "ab");
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = gfx_glyph_create(font, &gmetrics, &glyph2);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	rc = gfx_glyph_set_pattern(glyph2, "a");
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	rc = gfx_glyph_set_pattern(glyph2, "abc");
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = gfx_glyph_create(font, &gmetrics, &glyph3);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	rc = gfx_glyph_set_pattern(glyph3, "\u00e1");
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = gfx_font_search_glyph(font, "abc", &glyph, &bytes);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_EQUALS(glyph1, glyph);
+	PCUT_ASSERT_INT_EQUALS(2, bytes);
+
+	rc = gfx_font_search_glyph(font, "ax", &glyph, &bytes);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_EQUALS(glyph2, glyph);
+	PCUT_ASSERT_INT_EQUALS(1, bytes);
+
+	rc = gfx_font_search_glyph(font, "\u00e1x", &glyph, &bytes);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_EQUALS(glyph3, glyph);
+	PCUT_ASSERT_INT_EQUALS(2, bytes);
+
+	rc = gfx_font_search_glyph(font, "b", &glyph, &bytes);
+	PCUT_ASSERT_ERRNO_VAL(ENOENT, rc);
+
+	/* Index must be updated when patterns change */
+	gfx_glyph_clear_pattern(glyph1, "ab");
+
+	rc = gfx_font_search_glyph(font, "abc", &glyph, &bytes);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_EQUALS(glyph2, glyph);
+	PCUT_ASSERT_INT_EQUALS(1, bytes);
+
+	rc = gfx_glyph_set_pattern(glyph1, "b");
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = gfx_font_search_glyph(font, "b", &glyph, &bytes);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_EQUALS(glyph1, glyph);
+	PCUT_ASSERT_INT_EQUALS(1, bytes);
+
+	gfx_glyph_destroy(glyph2);
+
+	rc = gfx_font_search_glyph(font, "abc", &glyph, &bytes);
+	PCUT_ASSERT_ERRNO_VAL(ENOENT, rc);
+
+	gfx_font_close(font);
+	gfx_typeface_destroy(tface);
+	rc = gfx_context_delete(gc);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+}
+
 /** Test gfx_font_splice_at_glyph() */
 PCUT_TEST(splice_at_glyph)
 {
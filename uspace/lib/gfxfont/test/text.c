@@ -30,6 +30,7 @@
 #include <gfx/context.h>
 #include <gfx/font.h>
 #include <gfx/glyph.h>
+#include <gfx/glyph_bmp.h>
 #include <gfx/text.h>
 #include <gfx/typeface.h>
 #include <pcut/pcut.h>
@@ -119,6 +120,111 @@ PCUT_TEST(dummy_puttext)
 	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
 }
 
+/** gfx_puttext() renders glyphs in one batch */
+PCUT_TEST(puttext_run)
+{
+	gfx_font_props_t props;
+	gfx_font_metrics_t metrics;
+	gfx_glyph_metrics_t gmetrics;
+	gfx_typeface_t *tface;
+	gfx_font_t *font;
+	gfx_glyph_t *glyph1;
+	gfx_glyph_t *glyph2;
+	gfx_glyph_bmp_t *bmp;
+	gfx_context_t *gc;
+	gfx_color_t *color;
+	gfx_text_fmt_t fmt;
+	gfx_coord2_t pos;
+	uint32_t *pixels;
+	test_gc_t tgc;
+	errno_t rc;
+
+	rc = gfx_context_new(&test_ops, (void *)&tgc, &gc);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = gfx_color_new_rgb_i16(0, 0, 0, &color);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = gfx_typeface_create(gc, &tface);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	gfx_font_props_init(&props);
+	gfx_font_metrics_init(&metrics);
+	rc = gfx_font_create(tface, &props, &metrics, &font);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	gfx_glyph_metrics_init(&gmetrics);
+	gmetrics.advance = 2;
+
+	/* Glyph 'A' with pixels at (0, 0) and (1, 1) */
+	rc = gfx_glyph_create(font, &gmetrics, &glyph1);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	rc = gfx_glyph_set_pattern(glyph1, "A");
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = gfx_glyph_bmp_open(glyph1, &bmp);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	rc = gfx_glyph_bmp_setpix(bmp, 0, 0, 1);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	rc = gfx_glyph_bmp_setpix(bmp, 1, 1, 1);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	rc = gfx_glyph_bmp_save(bmp);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	gfx_glyph_bmp_close(bmp);
+
+	/* Glyph 'B' with pixel at (0, 0) */
+	rc = gfx_glyph_create(font, &gmetrics, &glyph2);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	rc = gfx_glyph_set_pattern(glyph2, "B");
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = gfx_glyph_bmp_open(glyph2, &bmp);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	rc = gfx_glyph_bmp_setpix(bmp, 0, 0, 1);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	rc = gfx_glyph_bmp_save(bmp);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	gfx_glyph_bmp_close(bmp);
+
+	gfx_text_fmt_init(&fmt);
+	fmt.font = font;
+	fmt.color = color;
+	pos.x = 10;
+	pos.y = 20;
+
+	rc = gfx_puttext(&pos, &fmt, "AB");
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	/* The whole run was rendered from the scratch bitmap at once */
+	PCUT_ASSERT_INT_EQUALS(0, tgc.bm_srect.p0.x);
+	PCUT_ASSERT_INT_EQUALS(0, tgc.bm_srect.p0.y);
+	PCUT_ASSERT_INT_EQUALS(3, tgc.bm_srect.p1.x);
+	PCUT_ASSERT_INT_EQUALS(2, tgc.bm_srect.p1.y);
+	PCUT_ASSERT_INT_EQUALS(10, tgc.bm_offs.x);
+	PCUT_ASSERT_INT_EQUALS(20, tgc.bm_offs.y);
+
+	/* Scratch bitmap was created last */
+	PCUT_ASSERT_INT_EQUALS(3, tgc.bm_params.rect.p1.x);
+	pixels = (uint32_t *) tgc.bm_pixels;
+
+	PCUT_ASSERT_TRUE(pixels[0] != 0);
+	PCUT_ASSERT_INT_EQUALS(0, pixels[1]);
+	PCUT_ASSERT_TRUE(pixels[2] != 0);
+	PCUT_ASSERT_INT_EQUALS(0, pixels[3]);
+	PCUT_ASSERT_TRUE(pixels[4] != 0);
+	PCUT_ASSERT_INT_EQUALS(0, pixels[5]);
+
+	gfx_glyph_destroy(glyph1);
+	gfx_glyph_destroy(glyph2);
+
+	gfx_font_close(font);
+	gfx_typeface_destroy(tface);
+	gfx_color_delete(color);
+
+	rc = gfx_context_delete(gc);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+}
+
 /** gfx_text_start_pos() correctly computes text start position */
 PCUT_TEST(text_start_pos)
 {
@@ -38,6 +38,7 @@
 #include <async.h>
 #include <inet/addr.h>
 #include <inet/eth_addr.h>
+#include <inet/pktring.h>
 
 struct iplink_ev_ops;
 
@@ -45,6 +46,8 @@ typedef struct {
 	async_sess_t *sess;
 	struct iplink_ev_ops *ev_ops;
 	void *arg;
+	/** Receive packet ring or @c NULL if not set up */
+	pktring_t *rx_ring;
 } iplink_t;
 
 /** IPv4 link Service Data Unit */
@@ -91,6 +94,7 @@ extern errno_t iplink_addr_remove(iplink_t *, inet_addr_t *);
 extern errno_t iplink_get_mtu(iplink_t *, size_t *);
 extern errno_t iplink_get_mac48(iplink_t *, eth_addr_t *);
 extern errno_t iplink_set_mac48(iplink_t *, eth_addr_t *);
+extern errno_t iplink_rx_ring_setup(iplink_t *, size_t, size_t);
 extern void *iplink_get_userptr(iplink_t *);
 
 #endif
@@ -40,6 +40,7 @@
 #include <inet/addr.h>
 #include <inet/eth_addr.h>
 #include <inet/iplink.h>
+#include <inet/pktring.h>
 #include <stdbool.h>
 
 struct iplink_ops;
@@ -50,6 +51,10 @@ typedef struct {
 	struct iplink_ops *ops;
 	void *arg;
 	async_sess_t *client_sess;
+	/** Synchronizes access to @c rx_ring (we are the only producer) */
+	fibril_mutex_t rx_lock;
+	/** Receive packet ring shared by the client or @c NULL */
+	pktring_t *rx_ring;
 } iplink_srv_t;
 
 typedef struct iplink_ops {
@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libinet
+ * @{
+ */
+/**
+ * @file
+ * @brief Shared-memory packet ring
+ */
+
+#ifndef LIBINET_INET_PKTRING_H
+#define LIBINET_INET_PKTRING_H
+
+#include <async.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <types/inet/pktring.h>
+
+extern errno_t pktring_create(size_t, size_t, pktring_t **);
+extern void pktring_destroy(pktring_t *);
+extern errno_t pktring_share_out(pktring_t *, async_exch_t *);
+extern errno_t pktring_accept(pktring_t **);
+extern size_t pktring_slot_size(pktring_t *);
+
+extern void *pktring_produce_begin(pktring_t *);
+extern void pktring_produce_commit(pktring_t *, size_t, uint32_t);
+extern errno_t pktring_enqueue(pktring_t *, const void *, size_t, uint32_t);
+extern bool pktring_kick_wanted(pktring_t *);
+
+extern bool pktring_consume_peek(pktring_t *, void **, size_t *, uint32_t *);
+extern void pktring_consume_release(pktring_t *);
+extern bool pktring_consume_idle(pktring_t *);
+
+#endif
+
+/** @}
+ */
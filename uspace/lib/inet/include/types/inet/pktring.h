@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libinet
+ * @{
+ */
+/** @file
+ */
+
+#ifndef LIBINETTYPES_INET_PKTRING_H
+#define LIBINETTYPES_INET_PKTRING_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Assumed cache line size used to separate producer and consumer state */
+#define PKTRING_CACHE_LINE 64
+
+/** Packet ring descriptor (in shared memory) */
+typedef struct {
+	/** Number of valid bytes in the slot */
+	uint32_t size;
+	/** Per-packet argument (e.g. IP version) */
+	uint32_t arg;
+} pktring_desc_t;
+
+/** Packet ring control block (at the start of the shared area).
+ *
+ * @c head is only written by the producer, @c tail is only written by
+ * the consumer. Both are free-running counters, the slot index is
+ * obtained by masking with @c nslots - 1.
+ */
+typedef struct {
+	/** Number of slots (power of two) */
+	uint32_t nslots;
+	/** Size of one slot in bytes */
+	uint32_t slot_size;
+	/** Producer index */
+	_Alignas(PKTRING_CACHE_LINE) atomic_uint head;
+	/** Consumer index */
+	_Alignas(PKTRING_CACHE_LINE) atomic_uint tail;
+	/** Consumer is idle and needs to be notified by the producer */
+	atomic_uint kick;
+} pktring_shared_t;
+
+/** Packet ring.
+ *
+ * Single-producer, single-consumer ring of fixed-size packet buffers
+ * living in a memory area shared between two tasks. Packets are
+ * handed off by publishing a descriptor, the payload is not copied
+ * through IPC.
+ */
+typedef struct {
+	/** Start of the shared area */
+	void *area;
+	/** Control block */
+	pktring_shared_t *shared;
+	/** Descriptor array */
+	pktring_desc_t *desc;
+	/** Packet buffers */
+	uint8_t *slots;
+	/** Number of slots (local copy, not trusted from shared memory) */
+	uint32_t nslots;
+	/** Slot size (local copy, not trusted from shared memory) */
+	uint32_t slot_size;
+	/** Local copy of producer index (valid on the producer side) */
+	uint32_t head;
+	/** Local copy of consumer index (valid on the consumer side) */
+	uint32_t tail;
+} pktring_t;
+
+#endif
+
+/** @}
+ */
@@ -82,6 +82,7 @@ error:
 void iplink_close(iplink_t *iplink)
 {
 	/* XXX Synchronize with iplink_cb_conn */
+	pktring_destroy(iplink->rx_ring);
 	free(iplink);
 }
 
@@ -239,6 +240,58 @@ errno_t iplink_addr_remove(iplink_t *iplink, inet_addr_t *addr)
 	return retval;
 }
 
+/** Set up shared-memory receive packet ring.
+ *
+ * Once the ring is set up, the IP link server places received packets
+ * into the ring instead of sending them using IPC data writes. If the
+ * server does not support packet rings, an error is returned and
+ * packets continue to be delivered the usual way.
+ *
+ * @param iplink IP link
+ * @param nslots Number of slots (power of two)
+ * @param slot_size Slot size, should be at least the link MTU
+ * @return EOK on success or an error code
+ */
+errno_t iplink_rx_ring_setup(iplink_t *iplink, size_t nslots,
+    size_t slot_size)
+{
+	pktring_t *ring;
+	errno_t rc;
+
+	if (iplink->rx_ring != NULL)
+		return EEXIST;
+
+	rc = pktring_create(nslots, slot_size, &ring);
+	if (rc != EOK)
+		return rc;
+
+	/* The server can start producing as soon as it accepts the ring */
+	iplink->rx_ring = ring;
+
+	async_exch_t *exch = async_exchange_begin(iplink->sess);
+
+	ipc_call_t answer;
+	aid_t req = async_send_0(exch, IPLINK_RX_RING_SETUP, &answer);
+
+	rc = pktring_share_out(ring, exch);
+	async_exchange_end(exch);
+
+	if (rc != EOK) {
+		async_forget(req);
+		goto error;
+	}
+
+	async_wait_for(req, &rc);
+	if (rc != EOK)
+		goto error;
+
+	return EOK;
+error:
+	iplink->rx_ring = NULL;
+	pktring_destroy(ring);
+	return rc;
+}
+
 void *iplink_get_userptr(iplink_t *iplink)
 {
 	return iplink->arg;
@@ -262,6 +315,26 @@ static void iplink_ev_recv(iplink_t *iplink, ipc_call_t *icall)
 	async_answer_0(icall, rc);
 }
 
+static void iplink_ev_recv_ring(iplink_t *iplink, ipc_call_t *icall)
+{
+	pktring_t *ring = iplink->rx_ring;
+	iplink_recv_sdu_t sdu;
+	uint32_t ver;
+
+	async_answer_0(icall, EOK);
+
+	if (ring == NULL)
+		return;
+
+	/* Drain the ring until it stays empty after requesting a kick */
+	do {
+		while (pktring_consume_peek(ring, &sdu.data, &sdu.size, &ver)) {
+			(void) iplink->ev_ops->recv(iplink, &sdu, (ip_ver_t) ver);
+			pktring_consume_release(ring);
+		}
+	} while (!pktring_consume_idle(ring));
+}
+
 static void iplink_ev_change_addr(iplink_t *iplink, ipc_call_t *icall)
 {
 	eth_addr_t *addr;
@@ -299,6 +372,9 @@ static void iplink_cb_conn(ipc_call_t *icall, void *arg)
 		case IPLINK_EV_CHANGE_ADDR:
 			iplink_ev_change_addr(iplink, &call);
 			break;
+		case IPLINK_EV_RECV_RING:
+			iplink_ev_recv_ring(iplink, &call);
+			break;
 		default:
 			async_answer_0(&call, ENOTSUP);
 		}
@@ -41,6 +41,7 @@
 #include <stddef.h>
 #include <inet/addr.h>
 #include <inet/iplink_srv.h>
+#include <inet/pktring.h>
 
 static void iplink_get_mtu_srv(iplink_srv_t *srv, ipc_call_t *call)
 {
@@ -224,13 +225,35 @@ static void iplink_send6_srv(iplink_srv_t *srv, ipc_call_t *icall)
 	async_answer_0(icall, rc);
 }
 
+static void iplink_rx_ring_setup_srv(iplink_srv_t *srv, ipc_call_t *icall)
+{
+	pktring_t *ring;
+	pktring_t *old_ring;
+
+	errno_t rc = pktring_accept(&ring);
+	if (rc != EOK) {
+		async_answer_0(icall, rc);
+		return;
+	}
+
+	fibril_mutex_lock(&srv->rx_lock);
+	old_ring = srv->rx_ring;
+	srv->rx_ring = ring;
+	fibril_mutex_unlock(&srv->rx_lock);
+
+	pktring_destroy(old_ring);
+	async_answer_0(icall, EOK);
+}
+
 void iplink_srv_init(iplink_srv_t *srv)
 {
 	fibril_mutex_initialize(&srv->lock);
+	fibril_mutex_initialize(&srv->rx_lock);
 	srv->connected = false;
 	srv->ops = NULL;
 	srv->arg = NULL;
 	srv->client_sess = NULL;
+	srv->rx_ring = NULL;
 }
 
 errno_t iplink_conn(ipc_call_t *icall, void *arg)
@@ -271,6 +294,12 @@ errno_t iplink_conn(ipc_call_t *icall, void *arg)
 			fibril_mutex_lock(&srv->lock);
 			srv->connected = false;
 			fibril_mutex_unlock(&srv->lock);
+
+			fibril_mutex_lock(&srv->rx_lock);
+			pktring_destroy(srv->rx_ring);
+			srv->rx_ring = NULL;
+			fibril_mutex_unlock(&srv->rx_lock);
+
 			async_answer_0(&call, EOK);
 			break;
 		}
@@ -297,6 +326,9 @@ errno_t iplink_conn(ipc_call_t *icall, void *arg)
 		case IPLINK_ADDR_REMOVE:
 			iplink_addr_remove_srv(srv, &call);
 			break;
+		case IPLINK_RX_RING_SETUP:
+			iplink_rx_ring_setup_srv(srv, &call);
+			break;
 		default:
 			async_answer_0(&call, EINVAL);
 		}
@@ -305,19 +337,56 @@ errno_t iplink_conn(ipc_call_t *icall, void *arg)
 	return srv->ops->close(srv);
 }
 
-/* XXX Version should be part of @a sdu */
+/** Deliver received SDU to the client.
+ *
+ * If the client has set up a receive ring, the SDU is copied into the
+ * next ring slot and the client is only notified when it has gone idle.
+ * This replaces the IPC data transfer, so the SDU is still copied once
+ * here. If the ring is full, the SDU is dropped and ELIMIT is returned,
+ * there is no fallback to IPLINK_EV_RECV. SDUs that do not fit into a
+ * slot are sent using IPLINK_EV_RECV.
+ *
+ * XXX Version should be part of @a sdu
+ *
+ * @param srv IP link server
+ * @param sdu Received SDU
+ * @param ver IP version
+ * @return EOK on success, ELIMIT if the receive ring is full or an error code
+ */
 errno_t iplink_ev_recv(iplink_srv_t *srv, iplink_recv_sdu_t *sdu, ip_ver_t ver)
 {
+	async_exch_t *exch;
+	bool kick;
+	errno_t rc;
+
 	if (srv->client_sess == NULL)
 		return EIO;
 
-	async_exch_t *exch = async_exchange_begin(srv->client_sess);
+	fibril_mutex_lock(&srv->rx_lock);
+	if (srv->rx_ring != NULL &&
+	    sdu->size <= pktring_slot_size(srv->rx_ring)) {
+		/* Hand off through the shared ring, drop if it is full */
+		rc = pktring_enqueue(srv->rx_ring, sdu->data, sdu->size, ver);
+		kick = (rc == EOK) && pktring_kick_wanted(srv->rx_ring);
+		fibril_mutex_unlock(&srv->rx_lock);
+
+		if (kick) {
+			exch = async_exchange_begin(srv->client_sess);
+			async_msg_0(exch, IPLINK_EV_RECV_RING);
+			async_exchange_end(exch);
+		}
+
+		return rc;
+	}
+	fibril_mutex_unlock(&srv->rx_lock);
+
+	exch = async_exchange_begin(srv->client_sess);
 
 	ipc_call_t answer;
 	aid_t req = async_send_1(exch, IPLINK_EV_RECV, (sysarg_t)ver,
 	    &answer);
 
-	errno_t rc = async_data_write_start(exch, sdu->data, sdu->size);
+	rc = async_data_write_start(exch, sdu->data, sdu->size);
 	async_exchange_end(exch);
 
 	if (rc != EOK) {
@@ -0,0 +1,419 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libinet
+ * @{
+ */
+/**
+ * @file
+ * @brief Shared-memory packet ring
+ *
+ * A packet ring is a single-producer, single-consumer queue of
+ * fixed-size packet buffers placed in a memory area that is created by
+ * one task and shared with another using async_share_out_start(). It
+ * allows handing off packets between adjacent network servers without
+ * copying the payload through an IPC data write.
+ *
+ * The producer fills a slot and publishes it by advancing the head
+ * index. The consumer processes published slots and releases them by
+ * advancing the tail index. To avoid an IPC call for every packet, the
+ * consumer sets the kick flag before it goes idle and the producer only
+ * notifies the consumer when it finds the flag set.
+ */
+
+#include <align.h>
+#include <as.h>
+#include <assert.h>
+#include <async.h>
+#include <errno.h>
+#include <inet/pktring.h>
+#include <mem.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+/** Maximum number of slots in a ring */
+#define PKTRING_SLOTS_MAX 4096
+/** Maximum slot size */
+#define PKTRING_SLOT_SIZE_MAX 65536
+
+/** Compute offset of the descriptor array within the shared area. */
+static size_t pktring_desc_off(void)
+{
+	return ALIGN_UP(sizeof(pktring_shared_t), PKTRING_CACHE_LINE);
+}
+
+/** Compute offset of the first slot within the shared area. */
+static size_t pktring_slots_off(size_t nslots)
+{
+	return ALIGN_UP(pktring_desc_off() + nslots * sizeof(pktring_desc_t),
+	    PKTRING_CACHE_LINE);
+}
+
+/** Compute size of the shared area.
+ *
+ * @param nslots Number of slots
+ * @param slot_size Slot size in bytes
+ * @return Area size in bytes (multiple of page size)
+ */
+static size_t pktring_area_size(size_t nslots, size_t slot_size)
+{
+	return PAGES2SIZE(SIZE2PAGES(pktring_slots_off(nslots) +
+	    nslots * slot_size));
+}
+
+/** Verify ring geometry.
+ *
+ * @param nslots Number of slots
+ * @param slot_size Slot size in bytes
+ * @return @c true iff geometry is acceptable
+ */
+static bool pktring_geometry_valid(size_t nslots, size_t slot_size)
+{
+	if (nslots == 0 || nslots > PKTRING_SLOTS_MAX)
+		return false;
+	if ((nslots & (nslots - 1)) != 0)
+		return false;
+	if (slot_size == 0 || slot_size > PKTRING_SLOT_SIZE_MAX)
+		return false;
+
+	return true;
+}
+
+/** Fill in ring structure pointing into a mapped shared area.
+ *
+ * @param ring Packet ring
+ * @param area Start of the shared area
+ * @param nslots Number of slots
+ * @param slot_size Slot size in bytes
+ */
+static void pktring_setup(pktring_t *ring, void *area, size_t nslots,
+    size_t slot_size)
+{
+	ring->area = area;
+	ring->shared = (pktring_shared_t *) area;
+	ring->desc = (pktring_desc_t *) ((uint8_t *) area + pktring_desc_off());
+	ring->slots = (uint8_t *) area + pktring_slots_off(nslots);
+	ring->nslots = nslots;
+	ring->slot_size = slot_size;
+	ring->head = atomic_load_explicit(&ring->shared->head,
+	    memory_order_acquire);
+	ring->tail = atomic_load_explicit(&ring->shared->tail,
+	    memory_order_acquire);
+}
+
+/** Create packet ring.
+ *
+ * Allocates a new shared-memory area for the ring. The ring can then
+ * be passed to the peer using pktring_share_out().
+ *
+ * @param nslots Number of slots (power of two)
+ * @param slot_size Size of one slot in bytes
+ * @param rring Place to store pointer to new packet ring
+ * @return EOK on success, EINVAL if the geometry is not valid,
+ *         ENOMEM if out of memory
+ */
+errno_t pktring_create(size_t nslots, size_t slot_size, pktring_t **rring)
+{
+	pktring_t *ring;
+	pktring_shared_t *shared;
+	void *area;
+
+	if (!pktring_geometry_valid(nslots, slot_size))
+		return EINVAL;
+
+	ring = calloc(1, sizeof(pktring_t));
+	if (ring == NULL)
+		return ENOMEM;
+
+	area = as_area_create(AS_AREA_ANY, pktring_area_size(nslots, slot_size),
+	    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE, AS_AREA_UNPAGED);
+	if (area == AS_MAP_FAILED) {
+		free(ring);
+		return ENOMEM;
+	}
+
+	shared = (pktring_shared_t *) area;
+	shared->nslots = nslots;
+	shared->slot_size = slot_size;
+	atomic_init(&shared->head, 0);
+	atomic_init(&shared->tail, 0);
+	atomic_init(&shared->kick, 1);
+
+	pktring_setup(ring, area, nslots, slot_size);
+	*rring = ring;
+	return EOK;
+}
+
+/** Destroy packet ring.
+ *
+ * Unmaps the shared area from the address space of the current task.
+ *
+ * @param ring Packet ring or @c NULL
+ */
+void pktring_destroy(pktring_t *ring)
+{
+	if (ring == NULL)
+		return;
+
+	as_area_destroy(ring->area);
+	free(ring);
+}
+
+/** Share packet ring with the peer.
+ *
+ * The peer must accept the ring using pktring_accept().
+ *
+ * @param ring Packet ring
+ * @param exch Exchange
+ * @return EOK on success or an error code
+ */
+errno_t pktring_share_out(pktring_t *ring, async_exch_t *exch)
+{
+	return async_share_out_start(exch, ring->area, AS_AREA_READ |
+	    AS_AREA_WRITE | AS_AREA_CACHEABLE);
+}
+
+/** Accept packet ring shared by the peer.
+ *
+ * Receives the share-out call on the current connection and maps the
+ * ring. The geometry stored in the shared area is validated against
+ * the area size so that a misbehaving peer cannot make us access memory
+ * outside of the area.
+ *
+ * @param rring Place to store pointer to new packet ring
+ * @return EOK on success or an error code
+ */
+errno_t pktring_accept(pktring_t **rring)
+{
+	pktring_t *ring;
+	pktring_shared_t *shared;
+	ipc_call_t call;
+	unsigned int flags;
+	size_t nslots;
+	size_t slot_size;
+	size_t size;
+	void *area;
+	errno_t rc;
+
+	if (!async_share_out_receive(&call, &size, &flags)) {
+		async_answer_0(&call, EINVAL);
+		return EINVAL;
+	}
+
+	if (size < sizeof(pktring_shared_t)) {
+		async_answer_0(&call, EINVAL);
+		return EINVAL;
+	}
+
+	ring = calloc(1, sizeof(pktring_t));
+	if (ring == NULL) {
+		async_answer_0(&call, ENOMEM);
+		return ENOMEM;
+	}
+
+	rc = async_share_out_finalize(&call, &area);
+	if (rc != EOK || area == AS_MAP_FAILED) {
+		free(ring);
+		return ENOMEM;
+	}
+
+	shared = (pktring_shared_t *) area;
+	nslots = shared->nslots;
+	slot_size = shared->slot_size;
+
+	if (!pktring_geometry_valid(nslots, slot_size) ||
+	    pktring_area_size(nslots, slot_size) > size) {
+		as_area_destroy(area);
+		free(ring);
+		return EINVAL;
+	}
+
+	pktring_setup(ring, area, nslots, slot_size);
+	*rring = ring;
+	return EOK;
+}
+
+/** Get slot size of packet ring.
+ *
+ * @param ring Packet ring
+ * @return Maximum packet size that fits into the ring
+ */
+size_t pktring_slot_size(pktring_t *ring)
+{
+	return ring->slot_size;
+}
+
+/** Begin producing a packet.
+ *
+ * Returns a pointer to the next free slot. The caller fills in up to
+ * pktring_slot_size() bytes and then publishes the packet with
+ * pktring_produce_commit().
+ *
+ * @param ring Packet ring
+ * @return Pointer to slot buffer or @c NULL if the ring is full
+ */
+void *pktring_produce_begin(pktring_t *ring)
+{
+	uint32_t tail;
+
+	tail = atomic_load_explicit(&ring->shared->tail, memory_order_acquire);
+	if (ring->head - tail >= ring->nslots)
+		return NULL;
+
+	return ring->slots + (ring->head & (ring->nslots - 1)) *
+	    ring->slot_size;
+}
+
+/** Publish packet in the slot returned by pktring_produce_begin().
+ *
+ * @param ring Packet ring
+ * @param size Packet size in bytes
+ * @param arg Per-packet argument passed to the consumer
+ */
+void pktring_produce_commit(pktring_t *ring, size_t size, uint32_t arg)
+{
+	pktring_desc_t *desc;
+
+	assert(size <= ring->slot_size);
+
+	desc = &ring->desc[ring->head & (ring->nslots - 1)];
+	desc->size = size;
+	desc->arg = arg;
+
+	++ring->head;
+	atomic_store_explicit(&ring->shared->head, ring->head,
+	    memory_order_release);
+}
+
+/** Copy packet into the ring.
+ *
+ * @param ring Packet ring
+ * @param data Packet data
+ * @param size Packet size in bytes
+ * @param arg Per-packet argument passed to the consumer
+ * @return EOK on success, EINVAL if the packet does not fit into a slot,
+ *         ELIMIT if the ring is full
+ */
+errno_t pktring_enqueue(pktring_t *ring, const void *data, size_t size,
+    uint32_t arg)
+{
+	void *slot;
+
+	if (size > ring->slot_size)
+		return EINVAL;
+
+	slot = pktring_produce_begin(ring);
+	if (slot == NULL)
+		return ELIMIT;
+
+	memcpy(slot, data, size);
+	pktring_produce_commit(ring, size, arg);
+	return EOK;
+}
+
+/** Determine whether consumer needs to be notified.
+ *
+ * Called by the producer after publishing one or more packets. Clears
+ * the kick flag so that only one notification is sent until the
+ * consumer goes idle again.
+ *
+ * @param ring Packet ring
+ * @return @c true iff the producer should notify the consumer
+ */
+bool pktring_kick_wanted(pktring_t *ring)
+{
+	/* Order head update before reading the kick flag */
+	atomic_thread_fence(memory_order_seq_cst);
+	return atomic_exchange_explicit(&ring->shared->kick, 0,
+	    memory_order_acq_rel) != 0;
+}
+
+/** Peek at the oldest published packet.
+ *
+ * @param ring Packet ring
+ * @param rdata Place to store pointer to packet data
+ * @param rsize Place to store packet size
+ * @param rarg Place to store per-packet argument
+ * @return @c true if a packet was returned, @c false if ring is empty
+ */
+bool pktring_consume_peek(pktring_t *ring, void **rdata, size_t *rsize,
+    uint32_t *rarg)
+{
+	pktring_desc_t desc;
+	uint32_t head;
+	uint32_t idx;
+
+	head = atomic_load_explicit(&ring->shared->head, memory_order_acquire);
+	if (head == ring->tail)
+		return false;
+
+	idx = ring->tail & (ring->nslots - 1);
+	desc = ring->desc[idx];
+
+	*rdata = ring->slots + idx * ring->slot_size;
+	*rsize = desc.size <= ring->slot_size ? desc.size : ring->slot_size;
+	*rarg = desc.arg;
+	return true;
+}
+
+/** Release the packet returned by pktring_consume_peek().
+ *
+ * The slot is returned to the producer and must not be accessed anymore.
+ *
+ * @param ring Packet ring
+ */
+void pktring_consume_release(pktring_t *ring)
+{
+	++ring->tail;
+	atomic_store_explicit(&ring->shared->tail, ring->tail,
+	    memory_order_release);
+}
+
+/** Prepare consumer for going idle.
+ *
+ * Requests a notification from the producer and checks the ring once
+ * more to close the race with a packet published in the meantime.
+ *
+ * @param ring Packet ring
+ * @return @c true if the ring is empty and the consumer can wait for
+ *         a notification, @c false if more packets need to be consumed
+ */
+bool pktring_consume_idle(pktring_t *ring)
+{
+	uint32_t head;
+
+	atomic_store_explicit(&ring->shared->kick, 1, memory_order_relaxed);
+	/* Order setting the kick flag before re-reading head */
+	atomic_thread_fence(memory_order_seq_cst);
+
+	head = atomic_load_explicit(&ring->shared->head, memory_order_acquire);
+	return head == ring->tail;
+}
+
+/** @}
+ */
@@ -32,5 +32,6 @@ PCUT_INIT;
 
 PCUT_IMPORT(addr);
 PCUT_IMPORT(eth_addr);
+PCUT_IMPORT(pktring);
 
 PCUT_MAIN();
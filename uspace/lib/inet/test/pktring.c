@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <inet/pktring.h>
+#include <mem.h>
+#include <pcut/pcut.h>
+#include <stdint.h>
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(pktring);
+
+/** pktring_create() rejects invalid geometry */
+PCUT_TEST(create_invalid)
+{
+	pktring_t *ring;
+
+	PCUT_ASSERT_ERRNO_VAL(EINVAL, pktring_create(0, 64, &ring));
+	PCUT_ASSERT_ERRNO_VAL(EINVAL, pktring_create(3, 64, &ring));
+	PCUT_ASSERT_ERRNO_VAL(EINVAL, pktring_create(4, 0, &ring));
+}
+
+/** Packets are consumed in the order they were produced */
+PCUT_TEST(enqueue_consume)
+{
+	pktring_t *ring;
+	void *data;
+	size_t size;
+	uint32_t arg;
+	uint8_t buf[16];
+	errno_t rc;
+	int i;
+
+	rc = pktring_create(4, 16, &ring);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_INT_EQUALS(16, pktring_slot_size(ring));
+
+	PCUT_ASSERT_FALSE(pktring_consume_peek(ring, &data, &size, &arg));
+
+	for (i = 0; i < 3; i++) {
+		memset(buf, i + 1, sizeof(buf));
+		rc = pktring_enqueue(ring, buf, i + 1, 10 + i);
+		PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	}
+
+	for (i = 0; i < 3; i++) {
+		PCUT_ASSERT_TRUE(pktring_consume_peek(ring, &data, &size,
+		    &arg));
+		PCUT_ASSERT_INT_EQUALS(i + 1, size);
+		PCUT_ASSERT_INT_EQUALS(10 + i, arg);
+		PCUT_ASSERT_INT_EQUALS(i + 1, ((uint8_t *) data)[0]);
+		pktring_consume_release(ring);
+	}
+
+	PCUT_ASSERT_FALSE(pktring_consume_peek(ring, &data, &size, &arg));
+	pktring_destroy(ring);
+}
+
+/** Producer cannot overrun the consumer */
+PCUT_TEST(full)
+{
+	pktring_t *ring;
+	void *data;
+	size_t size;
+	uint32_t arg;
+	uint8_t buf[8];
+	errno_t rc;
+	int i;
+
+	rc = pktring_create(2, 8, &ring);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	memset(buf, 0, sizeof(buf));
+
+	PCUT_ASSERT_ERRNO_VAL(EINVAL, pktring_enqueue(ring, buf, 9, 0));
+
+	for (i = 0; i < 2; i++) {
+		rc = pktring_enqueue(ring, buf, sizeof(buf), 0);
+		PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	}
+
+	PCUT_ASSERT_NULL(pktring_produce_begin(ring));
+	PCUT_ASSERT_ERRNO_VAL(ELIMIT, pktring_enqueue(ring, buf, 1, 0));
+
+	PCUT_ASSERT_TRUE(pktring_consume_peek(ring, &data, &size, &arg));
+	pktring_consume_release(ring);
+
+	/* Indices wrap around */
+	PCUT_ASSERT_NOT_NULL(pktring_produce_begin(ring));
+	pktring_produce_commit(ring, 5, 42);
+
+	PCUT_ASSERT_TRUE(pktring_consume_peek(ring, &data, &size, &arg));
+	pktring_consume_release(ring);
+	PCUT_ASSERT_TRUE(pktring_consume_peek(ring, &data, &size, &arg));
+	PCUT_ASSERT_INT_EQUALS(5, size);
+	PCUT_ASSERT_INT_EQUALS(42, arg);
+	pktring_consume_release(ring);
+
+	pktring_destroy(ring);
+}
+
+/** Producer only kicks an idle consumer, and only once */
+PCUT_TEST(kick)
+{
+	pktring_t *ring;
+	void *data;
+	size_t size;
+	uint32_t arg;
+	uint8_t b = 0;
+	errno_t rc;
+
+	rc = pktring_create(4, 1, &ring);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	/* Consumer starts out idle */
+	PCUT_ASSERT_ERRNO_VAL(EOK, pktring_enqueue(ring, &b, 1, 0));
+	PCUT_ASSERT_TRUE(pktring_kick_wanted(ring));
+
+	/* No more kicks until consumer goes idle */
+	PCUT_ASSERT_ERRNO_VAL(EOK, pktring_enqueue(ring, &b, 1, 0));
+	PCUT_ASSERT_FALSE(pktring_kick_wanted(ring));
+
+	/* Consumer cannot go idle with packets pending */
+	PCUT_ASSERT_FALSE(pktring_consume_idle(ring));
+
+	while (pktring_consume_peek(ring, &data, &size, &arg))
+		pktring_consume_release(ring);
+
+	PCUT_ASSERT_TRUE(pktring_consume_idle(ring));
+
+	PCUT_ASSERT_ERRNO_VAL(EOK, pktring_enqueue(ring, &b, 1, 0));
+	PCUT_ASSERT_TRUE(pktring_kick_wanted(ring));
+
+	pktring_destroy(ring);
+}
+
+PCUT_EXPORT(pktring);
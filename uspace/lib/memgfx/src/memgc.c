@@ -42,10 +42,10 @@
 #include <gfx/context.h>
 #include <gfx/render.h>
 #include <io/pixel.h>
-#include <io/pixelmap.h>
 #include <memgfx/memgc.h>
 #include <stdlib.h>
 #include "../private/memgc.h"
+#include "../private/memrow.h"
 
 static errno_t mem_gc_set_clip_rect(void *, gfx_rect_t *);
 static errno_t mem_gc_set_color(void *, gfx_color_t *);
@@ -61,6 +61,19 @@ static errno_t mem_gc_cursor_set_pos(void *, gfx_coord2_t *);
 static errno_t mem_gc_cursor_set_visible(void *, bool);
 static void mem_gc_invalidate_rect(mem_gc_t *, gfx_rect_t *);
 
+/** Get address of pixel in pixel array.
+ *
+ * @param alloc Allocation info
+ * @param x X coordinate (relative to the start of the array)
+ * @param y Y coordinate (relative to the start of the array)
+ * @return Address of the pixel
+ */
+static inline pixel_t *mem_gc_pixel_addr(gfx_bitmap_alloc_t *alloc,
+    gfx_coord_t x, gfx_coord_t y)
+{
+	return (pixel_t *) ((uint8_t *) alloc->pixels + y * alloc->pitch) + x;
+}
+
 gfx_context_ops_t mem_gc_ops = {
 	.set_clip_rect = mem_gc_set_clip_rect,
 	.set_color = mem_gc_set_color,
@@ -126,8 +139,8 @@ static errno_t mem_gc_fill_rect(void *arg, gfx_rect_t *rect)
 {
 	mem_gc_t *mgc = (mem_gc_t *) arg;
 	gfx_rect_t crect;
-	gfx_coord_t x, y;
-	pixelmap_t pixelmap;
+	gfx_coord_t y;
+	pixel_t *row;
 
 	/* Make sure we have a sorted, clipped rectangle */
 	gfx_rect_clip(rect, &mgc->clip_rect, &crect);
@@ -135,13 +148,11 @@ static errno_t mem_gc_fill_rect(void *arg, gfx_rect_t *rect)
 	assert(mgc->rect.p0.x == 0);
 	assert(mgc->rect.p0.y == 0);
 	assert(mgc->alloc.pitch == mgc->rect.p1.x * (int)sizeof(uint32_t));
-	pixelmap.width = mgc->rect.p1.x;
-	pixelmap.height = mgc->rect.p1.y;
-	pixelmap.data = mgc->alloc.pixels;
 
-	for (y = crect.p0.y; y < crect.p1.y; y++) {
-		for (x = crect.p0.x; x < crect.p1.x; x++) {
-			pixelmap_put_pixel(&pixelmap, x, y, mgc->color);
+	if (!gfx_rect_is_empty(&crect)) {
+		for (y = crect.p0.y; y < crect.p1.y; y++) {
+			row = mem_gc_pixel_addr(&mgc->alloc, crect.p0.x, y);
+			mem_row_fill(row, crect.p1.x - crect.p0.x, mgc->color);
 		}
 	}
 
@@ -379,10 +390,10 @@ static errno_t mem_gc_bitmap_render(void *bm, gfx_rect_t *srect0,
 	gfx_rect_t drect;
 	gfx_rect_t crect;
 	gfx_coord2_t offs;
-	gfx_coord_t x, y;
-	pixelmap_t smap;
-	pixelmap_t dmap;
-	pixel_t pixel;
+	gfx_coord_t y;
+	pixel_t *srow;
+	pixel_t *drow;
+	size_t width;
 
 	if (srect0 != NULL)
 		gfx_rect_clip(srect0, &mbm->rect, &srect);
@@ -404,51 +415,37 @@ static errno_t mem_gc_bitmap_render(void *bm, gfx_rect_t *srect0,
 
 	assert(mbm->alloc.pitch == (mbm->rect.p1.x - mbm->rect.p0.x) *
 	    (int)sizeof(uint32_t));
-	smap.width = mbm->rect.p1.x - mbm->rect.p0.x;
-	smap.height = mbm->rect.p1.y - mbm->rect.p0.y;
-	smap.data = mbm->alloc.pixels;
 
 	assert(mbm->mgc->rect.p0.x == 0);
 	assert(mbm->mgc->rect.p0.y == 0);
 	assert(mbm->mgc->alloc.pitch == mbm->mgc->rect.p1.x * (int)sizeof(uint32_t));
-	dmap.width = mbm->mgc->rect.p1.x;
-	dmap.height = mbm->mgc->rect.p1.y;
-	dmap.data = mbm->mgc->alloc.pixels;
 
-	if ((mbm->flags & bmpf_direct_output) != 0) {
+	if ((mbm->flags & bmpf_direct_output) != 0 ||
+	    gfx_rect_is_empty(&crect)) {
 		/* Nothing to do */
-	} else if ((mbm->flags & bmpf_color_key) == 0) {
-		/* Simple copy */
-		for (y = crect.p0.y; y < crect.p1.y; y++) {
-			for (x = crect.p0.x; x < crect.p1.x; x++) {
-				pixel = pixelmap_get_pixel(&smap,
-				    x - mbm->rect.p0.x - offs.x,
-				    y - mbm->rect.p0.y - offs.y);
-				pixelmap_put_pixel(&dmap, x, y, pixel);
-			}
-		}
-	} else if ((mbm->flags & bmpf_colorize) == 0) {
-		/* Color key */
-		for (y = crect.p0.y; y < crect.p1.y; y++) {
-			for (x = crect.p0.x; x < crect.p1.x; x++) {
-				pixel = pixelmap_get_pixel(&smap,
-				    x - mbm->rect.p0.x - offs.x,
-				    y - mbm->rect.p0.y - offs.y);
-				if (pixel != mbm->key_color)
-					pixelmap_put_pixel(&dmap, x, y, pixel);
-			}
-		}
-	} else {
-		/* Color key & colorization */
-		for (y = crect.p0.y; y < crect.p1.y; y++) {
-			for (x = crect.p0.x; x < crect.p1.x; x++) {
-				pixel = pixelmap_get_pixel(&smap,
-				    x - mbm->rect.p0.x - offs.x,
-				    y - mbm->rect.p0.y - offs.y);
-				if (pixel != mbm->key_color)
-					pixelmap_put_pixel(&dmap, x, y,
-					    mbm->mgc->color);
-			}
+		mem_gc_invalidate_rect(mbm->mgc, &crect);
+		return EOK;
+	}
+
+	width = crect.p1.x - crect.p0.x;
+
+	/* Process row by row, the row functions handle the inner loop */
+	for (y = crect.p0.y; y < crect.p1.y; y++) {
+		srow = mem_gc_pixel_addr(&mbm->alloc,
+		    crect.p0.x - mbm->rect.p0.x - offs.x,
+		    y - mbm->rect.p0.y - offs.y);
+		drow = mem_gc_pixel_addr(&mbm->mgc->alloc, crect.p0.x, y);
+
+		if ((mbm->flags & bmpf_color_key) == 0) {
+			/* Simple copy */
+			mem_row_copy(drow, srow, width);
+		} else if ((mbm->flags & bmpf_colorize) == 0) {
+			/* Color key */
+			mem_row_copy_key(drow, srow, width, mbm->key_color);
+		} else {
+			/* Color key & colorization */
+			mem_row_colorize(drow, srow, width, mbm->key_color,
+			    mbm->mgc->color);
 		}
 	}
 
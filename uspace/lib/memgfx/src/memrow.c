@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libmemgfx
+ * @{
+ */
+/**
+ * @file Pixel row operations
+ *
+ * These are the inner loops of the memory GC. Where the target has
+ * 128-bit SIMD as part of its base ABI (SSE2 on amd64, NEON on arm64)
+ * four pixels are processed at once using GCC vector extensions, which the
+ * compiler lowers to the native instructions. Other targets use plain
+ * loops. Wider vectors (AVX) cannot be used since the kernel does not
+ * preserve their state across context switches.
+ */
+
+#include <mem.h>
+#include <stdint.h>
+#include "../private/memrow.h"
+
+#if defined(__SSE2__) || defined(__ARM_NEON)
+#define MEM_ROW_SIMD
+#endif
+
+#ifdef MEM_ROW_SIMD
+
+/** Four pixels, may be accessed at any pixel-aligned address */
+typedef uint32_t mem_row_vec_t __attribute__((vector_size(16), aligned(4),
+    may_alias));
+
+/** Pixels per vector */
+#define MEM_ROW_VEC_PIXELS 4
+
+/** Create vector with all lanes set to @a pixel. */
+static inline mem_row_vec_t mem_row_vec_splat(pixel_t pixel)
+{
+	return (mem_row_vec_t) { pixel, pixel, pixel, pixel };
+}
+
+#endif
+
+/** Fill row of pixels with a color.
+ *
+ * @param dst Destination
+ * @param n Number of pixels
+ * @param color Color
+ */
+void mem_row_fill(pixel_t *dst, size_t n, pixel_t color)
+{
+#ifdef MEM_ROW_SIMD
+	mem_row_vec_t c = mem_row_vec_splat(color);
+
+	while (n >= 4 * MEM_ROW_VEC_PIXELS) {
+		((mem_row_vec_t *) dst)[0] = c;
+		((mem_row_vec_t *) dst)[1] = c;
+		((mem_row_vec_t *) dst)[2] = c;
+		((mem_row_vec_t *) dst)[3] = c;
+		dst += 4 * MEM_ROW_VEC_PIXELS;
+		n -= 4 * MEM_ROW_VEC_PIXELS;
+	}
+
+	while (n >= MEM_ROW_VEC_PIXELS) {
+		*(mem_row_vec_t *) dst = c;
+		dst += MEM_ROW_VEC_PIXELS;
+		n -= MEM_ROW_VEC_PIXELS;
+	}
+#endif
+	while (n > 0) {
+		*dst++ = color;
+		--n;
+	}
+}
+
+/** Copy row of pixels.
+ *
+ * @param dst Destination
+ * @param src Source
+ * @param n Number of pixels
+ */
+void mem_row_copy(pixel_t *dst, const pixel_t *src, size_t n)
+{
+	memcpy(dst, src, n * sizeof(pixel_t));
+}
+
+/** Copy row of pixels, skipping pixels of key color.
+ *
+ * @param dst Destination
+ * @param src Source
+ * @param n Number of pixels
+ * @param key Key color (pixels of this color are not copied)
+ */
+void mem_row_copy_key(pixel_t *dst, const pixel_t *src, size_t n,
+    pixel_t key)
+{
+#ifdef MEM_ROW_SIMD
+	mem_row_vec_t k = mem_row_vec_splat(key);
+	mem_row_vec_t s, d, m;
+
+	while (n >= MEM_ROW_VEC_PIXELS) {
+		s = *(const mem_row_vec_t *) src;
+		d = *(mem_row_vec_t *) dst;
+
+		/* All ones in lanes where the source pixel is the key */
+		m = (mem_row_vec_t) (s == k);
+		*(mem_row_vec_t *) dst = (d & m) | (s & ~m);
+
+		src += MEM_ROW_VEC_PIXELS;
+		dst += MEM_ROW_VEC_PIXELS;
+		n -= MEM_ROW_VEC_PIXELS;
+	}
+#endif
+	while (n > 0) {
+		if (*src != key)
+			*dst = *src;
+		++src;
+		++dst;
+		--n;
+	}
+}
+
+/** Paint color where source row is not of key color.
+ *
+ * @param dst Destination
+ * @param src Source
+ * @param n Number of pixels
+ * @param key Key color (pixels of this color are not painted)
+ * @param color Color to paint other pixels with
+ */
+void mem_row_colorize(pixel_t *dst, const pixel_t *src, size_t n,
+    pixel_t key, pixel_t color)
+{
+#ifdef MEM_ROW_SIMD
+	mem_row_vec_t k = mem_row_vec_splat(key);
+	mem_row_vec_t c = mem_row_vec_splat(color);
+	mem_row_vec_t s, d, m;
+
+	while (n >= MEM_ROW_VEC_PIXELS) {
+		s = *(const mem_row_vec_t *) src;
+		d = *(mem_row_vec_t *) dst;
+
+		m = (mem_row_vec_t) (s == k);
+		*(mem_row_vec_t *) dst = (d & m) | (c & ~m);
+
+		src += MEM_ROW_VEC_PIXELS;
+		dst += MEM_ROW_VEC_PIXELS;
+		n -= MEM_ROW_VEC_PIXELS;
+	}
+#endif
+	while (n > 0) {
+		if (*src != key)
+			*dst = color;
+		++src;
+		++dst;
+		--n;
+	}
+}
+
+/** @}
+ */
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <io/pixel.h>
+#include <pcut/pcut.h>
+#include <stdlib.h>
+#include "../private/memrow.h"
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(memrow);
+
+enum {
+	/** Size of test buffers (pixels) */
+	test_buf_size = 80,
+	/** Maximum row length tested */
+	test_max_len = 70,
+	/** Key color used in tests */
+	test_key = PIXEL(0, 255, 0, 255)
+};
+
+/** Fill buffers with pseudo-random pixels, about half of them @c test_key */
+static void test_init(pixel_t *src, pixel_t *dst, pixel_t *ref)
+{
+	size_t i;
+
+	for (i = 0; i < test_buf_size; i++) {
+		src[i] = (rand() % 2 == 0) ? test_key : (pixel_t) rand();
+		dst[i] = ref[i] = (pixel_t) rand();
+	}
+}
+
+/** Check that buffers are equal */
+static void test_check(pixel_t *dst, pixel_t *ref)
+{
+	size_t i;
+
+	for (i = 0; i < test_buf_size; i++)
+		PCUT_ASSERT_INT_EQUALS(ref[i], dst[i]);
+}
+
+/** Filling a row sets exactly the given pixels */
+PCUT_TEST(fill)
+{
+	pixel_t src[test_buf_size];
+	pixel_t dst[test_buf_size];
+	pixel_t ref[test_buf_size];
+	size_t offs, n, i;
+
+	/* All lengths and misalignments handled by vector and scalar code */
+	for (offs = 0; offs < 4; offs++) {
+		for (n = 0; n < test_max_len; n++) {
+			test_init(src, dst, ref);
+
+			mem_row_fill(dst + offs, n, PIXEL(0, 1, 2, 3));
+			for (i = 0; i < n; i++)
+				ref[offs + i] = PIXEL(0, 1, 2, 3);
+
+			test_check(dst, ref);
+		}
+	}
+}
+
+/** Copying a row copies exactly the given pixels */
+PCUT_TEST(copy)
+{
+	pixel_t src[test_buf_size];
+	pixel_t dst[test_buf_size];
+	pixel_t ref[test_buf_size];
+	size_t offs, n, i;
+
+	for (offs = 0; offs < 4; offs++) {
+		for (n = 0; n < test_max_len; n++) {
+			test_init(src, dst, ref);
+
+			mem_row_copy(dst + offs, src + 3, n);
+			for (i = 0; i < n; i++)
+				ref[offs + i] = src[3 + i];
+
+			test_check(dst, ref);
+		}
+	}
+}
+
+/** Color key copy skips key-colored pixels */
+PCUT_TEST(copy_key)
+{
+	pixel_t src[test_buf_size];
+	pixel_t dst[test_buf_size];
+	pixel_t ref[test_buf_size];
+	size_t offs, n, i;
+
+	for (offs = 0; offs < 4; offs++) {
+		for (n = 0; n < test_max_len; n++) {
+			test_init(src, dst, ref);
+
+			mem_row_copy_key(dst + offs, src + 1, n, test_key);
+			for (i = 0; i < n; i++) {
+				if (src[1 + i] != test_key)
+					ref[offs + i] = src[1 + i];
+			}
+
+			test_check(dst, ref);
+		}
+	}
+}
+
+/** Colorization paints non-key pixels with the color */
+PCUT_TEST(colorize)
+{
+	pixel_t src[test_buf_size];
+	pixel_t dst[test_buf_size];
+	pixel_t ref[test_buf_size];
+	size_t offs, n, i;
+
+	for (offs = 0; offs < 4; offs++) {
+		for (n = 0; n < test_max_len; n++) {
+			test_init(src, dst, ref);
+
+			mem_row_colorize(dst + offs, src + 2, n, test_key,
+			    PIXEL(0, 10, 20, 30));
+			for (i = 0; i < n; i++) {
+				if (src[2 + i] != test_key)
+					ref[offs + i] = PIXEL(0, 10, 20, 30);
+			}
+
+			test_check(dst, ref);
+		}
+	}
+}
+
+PCUT_EXPORT(memrow);
@@ -0,0 +1,470 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup softrend
+ * @{
+ */
+/**
+ * @file Pixel span conversion functions.
+ *
+ * These functions convert a span of consecutive ARGB pixels (usually
+ * a part of a scanline) to a visual, producing the same result as
+ * calling the corresponding per-pixel function for each pixel. They are
+ * meant to be selected once when the mode is set and then called once
+ * per scanline, avoiding an indirect call and address computation for
+ * every pixel.
+ *
+ * Where the target has 128-bit SIMD as part of its base ABI (SSE2 on
+ * amd64, NEON on arm64) four pixels are converted at once using GCC
+ * vector extensions. The channel shuffling is written as macros so that
+ * the same expression serves both the vector and the scalar path.
+ */
+
+#include <byteorder.h>
+#include <mem.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "pixconv.h"
+
+#if defined(__SSE2__) || defined(__ARM_NEON)
+#define PIXCONV_SIMD
+#endif
+
+/*
+ * Channel shuffling. The argument is an ARGB pixel (or a vector of them),
+ * the result is the value stored by the respective pixel2xxx() function.
+ */
+#define PIXCONV_ARGB_8888(v) (v)
+#define PIXCONV_ABGR_8888(v) \
+	(((v) & 0xff00ff00) | (((v) >> 16) & 0xff) | (((v) & 0xff) << 16))
+#define PIXCONV_RGBA_8888(v) (((v) << 8) | ((v) >> 24))
+#define PIXCONV_BGRA_8888(v) \
+	(((v) << 24) | (((v) << 8) & 0xff0000) | (((v) >> 8) & 0xff00) | \
+	((v) >> 24))
+#define PIXCONV_RGB_0888(v) ((v) & 0xffffff)
+#define PIXCONV_BGR_0888(v) \
+	((((v) & 0xff) << 16) | ((v) & 0xff00) | (((v) >> 16) & 0xff))
+#define PIXCONV_RGB_8880(v) ((v) << 8)
+#define PIXCONV_BGR_8880(v) \
+	((((v) & 0xff) << 24) | (((v) & 0xff00) << 8) | (((v) >> 8) & 0xff00))
+#define PIXCONV_RGB_555(v) \
+	((((v) >> 9) & 0x7c00) | (((v) >> 6) & 0x3e0) | (((v) >> 3) & 0x1f))
+#define PIXCONV_RGB_565(v) \
+	((((v) >> 8) & 0xf800) | (((v) >> 5) & 0x7e0) | (((v) >> 3) & 0x1f))
+#define PIXCONV_BGR_323(v) \
+	(~((((v) >> 16) & 0xe0) | (((v) >> 11) & 0x18) | (((v) >> 5) & 0x7)) & \
+	0xff)
+#define PIXCONV_GRAY_8(v) \
+	(((((v) >> 16) & 0xff) * 5034375 + (((v) >> 8) & 0xff) * 9886846 + \
+	((v) & 0xff) * 1920103) >> 24)
+
+static inline void pixconv_put32_be(uint8_t *dst, uint32_t val)
+{
+	val = host2uint32_t_be(val);
+	memcpy(dst, &val, sizeof(val));
+}
+
+static inline void pixconv_put16(uint8_t *dst, uint32_t val, bool be)
+{
+	uint16_t val16 = be ? host2uint16_t_be(val) : host2uint16_t_le(val);
+	memcpy(dst, &val16, sizeof(val16));
+}
+
+#ifdef PIXCONV_SIMD
+
+/** Four 32-bit lanes */
+typedef uint32_t pixconv_vec_t __attribute__((vector_size(16)));
+/** Four 16-bit lanes */
+typedef uint16_t pixconv_vec16_t __attribute__((vector_size(8)));
+/** Four 8-bit lanes */
+typedef uint8_t pixconv_vec8_t __attribute__((vector_size(4)));
+
+/** Pixels per vector */
+#define PIXCONV_VEC_PIXELS 4
+
+static inline pixconv_vec_t pixconv_load(const pixel_t *src)
+{
+	pixconv_vec_t v;
+
+	memcpy(&v, src, sizeof(v));
+	return v;
+}
+
+/** Store four 32-bit values in big-endian byte order. */
+static inline void pixconv_store32_be(uint8_t *dst, pixconv_vec_t v)
+{
+#ifdef __LE__
+	v = PIXCONV_BGRA_8888(v);
+#endif
+	memcpy(dst, &v, sizeof(v));
+}
+
+/** Store low halves of four 32-bit values. */
+static inline void pixconv_store16(uint8_t *dst, pixconv_vec_t v, bool be)
+{
+	pixconv_vec16_t v16;
+
+#ifdef __LE__
+	if (be)
+#else
+	if (!be)
+#endif
+		v = ((v << 8) & 0xff00) | ((v >> 8) & 0xff);
+
+	v16 = __builtin_convertvector(v, pixconv_vec16_t);
+	memcpy(dst, &v16, sizeof(v16));
+}
+
+/** Store low bytes of four 32-bit values. */
+static inline void pixconv_store8(uint8_t *dst, pixconv_vec_t v)
+{
+	pixconv_vec8_t v8 = __builtin_convertvector(v, pixconv_vec8_t);
+	memcpy(dst, &v8, sizeof(v8));
+}
+
+#endif
+
+void pixel2argb_8888_span(void *dst, const pixel_t *src, size_t n)
+{
+	uint8_t *d = dst;
+
+#ifdef PIXCONV_SIMD
+	for (; n >= PIXCONV_VEC_PIXELS; n -= PIXCONV_VEC_PIXELS) {
+		pixconv_store32_be(d, PIXCONV_ARGB_8888(pixconv_load(src)));
+		src += PIXCONV_VEC_PIXELS;
+		d += 4 * PIXCONV_VEC_PIXELS;
+	}
+#endif
+	for (; n > 0; n--) {
+		pixconv_put32_be(d, PIXCONV_ARGB_8888(*src));
+		src++;
+		d += 4;
+	}
+}
+
+void pixel2abgr_8888_span(void *dst, const pixel_t *src, size_t n)
+{
+	uint8_t *d = dst;
+
+#ifdef PIXCONV_SIMD
+	for (; n >= PIXCONV_VEC_PIXELS; n -= PIXCONV_VEC_PIXELS) {
+		pixconv_store32_be(d, PIXCONV_ABGR_8888(pixconv_load(src)));
+		src += PIXCONV_VEC_PIXELS;
+		d += 4 * PIXCONV_VEC_PIXELS;
+	}
+#endif
+	for (; n > 0; n--) {
+		pixconv_put32_be(d, PIXCONV_ABGR_8888(*src));
+		src++;
+		d += 4;
+	}
+}
+
+void pixel2rgba_8888_span(void *dst, const pixel_t *src, size_t n)
+{
+	uint8_t *d = dst;
+
+#ifdef PIXCONV_SIMD
+	for (; n >= PIXCONV_VEC_PIXELS; n -= PIXCONV_VEC_PIXELS) {
+		pixconv_store32_be(d, PIXCONV_RGBA_8888(pixconv_load(src)));
+		src += PIXCONV_VEC_PIXELS;
+		d += 4 * PIXCONV_VEC_PIXELS;
+	}
+#endif
+	for (; n > 0; n--) {
+		pixconv_put32_be(d, PIXCONV_RGBA_8888(*src));
+		src++;
+		d += 4;
+	}
+}
+
+void pixel2bgra_8888_span(void *dst, const pixel_t *src, size_t n)
+{
+	uint8_t *d = dst;
+
+#ifdef PIXCONV_SIMD
+	for (; n >= PIXCONV_VEC_PIXELS; n -= PIXCONV_VEC_PIXELS) {
+		pixconv_store32_be(d, PIXCONV_BGRA_8888(pixconv_load(src)));
+		src += PIXCONV_VEC_PIXELS;
+		d += 4 * PIXCONV_VEC_PIXELS;
+	}
+#endif
+	for (; n > 0; n--) {
+		pixconv_put32_be(d, PIXCONV_BGRA_8888(*src));
+		src++;
+		d += 4;
+	}
+}
+
+void pixel2rgb_0888_span(void *dst, const pixel_t *src, size_t n)
+{
+	uint8_t *d = dst;
+
+#ifdef PIXCONV_SIMD
+	for (; n >= PIXCONV_VEC_PIXELS; n -= PIXCONV_VEC_PIXELS) {
+		pixconv_store32_be(d, PIXCONV_RGB_0888(pixconv_load(src)));
+		src += PIXCONV_VEC_PIXELS;
+		d += 4 * PIXCONV_VEC_PIXELS;
+	}
+#endif
+	for (; n > 0; n--) {
+		pixconv_put32_be(d, PIXCONV_RGB_0888(*src));
+		src++;
+		d += 4;
+	}
+}
+
+void pixel2bgr_0888_span(void *dst, const pixel_t *src, size_t n)
+{
+	uint8_t *d = dst;
+
+#ifdef PIXCONV_SIMD
+	for (; n >= PIXCONV_VEC_PIXELS; n -= PIXCONV_VEC_PIXELS) {
+		pixconv_store32_be(d, PIXCONV_BGR_0888(pixconv_load(src)));
+		src += PIXCONV_VEC_PIXELS;
+		d += 4 * PIXCONV_VEC_PIXELS;
+	}
+#endif
+	for (; n > 0; n--) {
+		pixconv_put32_be(d, PIXCONV_BGR_0888(*src));
+		src++;
+		d += 4;
+	}
+}
+
+void pixel2rgb_8880_span(void *dst, const pixel_t *src, size_t n)
+{
+	uint8_t *d = dst;
+
+#ifdef PIXCONV_SIMD
+	for (; n >= PIXCONV_VEC_PIXELS; n -= PIXCONV_VEC_PIXELS) {
+		pixconv_store32_be(d, PIXCONV_RGB_8880(pixconv_load(src)));
+		src += PIXCONV_VEC_PIXELS;
+		d += 4 * PIXCONV_VEC_PIXELS;
+	}
+#endif
+	for (; n > 0; n--) {
+		pixconv_put32_be(d, PIXCONV_RGB_8880(*src));
+		src++;
+		d += 4;
+	}
+}
+
+void pixel2bgr_8880_span(void *dst, const pixel_t *src, size_t n)
+{
+	uint8_t *d = dst;
+
+#ifdef PIXCONV_SIMD
+	for (; n >= PIXCONV_VEC_PIXELS; n -= PIXCONV_VEC_PIXELS) {
+		pixconv_store32_be(d, PIXCONV_BGR_8880(pixconv_load(src)));
+		src += PIXCONV_VEC_PIXELS;
+		d += 4 * PIXCONV_VEC_PIXELS;
+	}
+#endif
+	for (; n > 0; n--) {
+		pixconv_put32_be(d, PIXCONV_BGR_8880(*src));
+		src++;
+		d += 4;
+	}
+}
+
+#ifdef __LE__
+
+/** Pack four pixels to three 24-bit values.
+ *
+ * @param dst Destination (12 bytes)
+ * @param p Four pixels with the first byte to store in the least
+ *          significant byte and the top byte ignored
+ */
+static inline void pixconv_pack_888(uint8_t *dst, const uint32_t *p)
+{
+	uint32_t w0 = (p[0] & 0xffffff) | (p[1] << 24);
+	uint32_t w1 = ((p[1] >> 8) & 0xffff) | (p[2] << 16);
+	uint32_t w2 = ((p[2] >> 16) & 0xff) | (p[3] << 8);
+
+	memcpy(dst, &w0, sizeof(w0));
+	memcpy(dst + 4, &w1, sizeof(w1));
+	memcpy(dst + 8, &w2, sizeof(w2));
+}
+
+#endif
+
+void pixel2rgb_888_span(void *dst, const pixel_t *src, size_t n)
+{
+	uint8_t *d = dst;
+
+#ifdef __LE__
+	uint32_t p[4];
+
+	for (; n >= 4; n -= 4) {
+		p[0] = PIXCONV_BGR_0888(src[0]);
+		p[1] = PIXCONV_BGR_0888(src[1]);
+		p[2] = PIXCONV_BGR_0888(src[2]);
+		p[3] = PIXCONV_BGR_0888(src[3]);
+		pixconv_pack_888(d, p);
+		src += 4;
+		d += 12;
+	}
+#endif
+	for (; n > 0; n--) {
+		d[0] = RED(*src);
+		d[1] = GREEN(*src);
+		d[2] = BLUE(*src);
+		src++;
+		d += 3;
+	}
+}
+
+void pixel2bgr_888_span(void *dst, const pixel_t *src, size_t n)
+{
+	uint8_t *d = dst;
+
+#ifdef __LE__
+	for (; n >= 4; n -= 4) {
+		pixconv_pack_888(d, src);
+		src += 4;
+		d += 12;
+	}
+#endif
+	for (; n > 0; n--) {
+		d[0] = BLUE(*src);
+		d[1] = GREEN(*src);
+		d[2] = RED(*src);
+		src++;
+		d += 3;
+	}
+}
+
+void pixel2rgb_555_be_span(void *dst, const pixel_t *src, size_t n)
+{
+	uint8_t *d = dst;
+
+#ifdef PIXCONV_SIMD
+	for (; n >= PIXCONV_VEC_PIXELS; n -= PIXCONV_VEC_PIXELS) {
+		pixconv_store16(d, PIXCONV_RGB_555(pixconv_load(src)), true);
+		src += PIXCONV_VEC_PIXELS;
+		d += 2 * PIXCONV_VEC_PIXELS;
+	}
+#endif
+	for (; n > 0; n--) {
+		pixconv_put16(d, PIXCONV_RGB_555(*src), true);
+		src++;
+		d += 2;
+	}
+}
+
+void pixel2rgb_555_le_span(void *dst, const pixel_t *src, size_t n)
+{
+	uint8_t *d = dst;
+
+#ifdef PIXCONV_SIMD
+	for (; n >= PIXCONV_VEC_PIXELS; n -= PIXCONV_VEC_PIXELS) {
+		pixconv_store16(d, PIXCONV_RGB_555(pixconv_load(src)), false);
+		src += PIXCONV_VEC_PIXELS;
+		d += 2 * PIXCONV_VEC_PIXELS;
+	}
+#endif
+	for (; n > 0; n--) {
+		pixconv_put16(d, PIXCONV_RGB_555(*src), false);
+		src++;
+		d += 2;
+	}
+}
+
+void pixel2rgb_565_be_span(void *dst, const pixel_t *src, size_t n)
+{
+	uint8_t *d = dst;
+
+#ifdef PIXCONV_SIMD
+	for (; n >= PIXCONV_VEC_PIXELS; n -= PIXCONV_VEC_PIXELS) {
+		pixconv_store16(d, PIXCONV_RGB_565(pixconv_load(src)), true);
+		src += PIXCONV_VEC_PIXELS;
+		d += 2 * PIXCONV_VEC_PIXELS;
+	}
+#endif
+	for (; n > 0; n--) {
+		pixconv_put16(d, PIXCONV_RGB_565(*src), true);
+		src++;
+		d += 2;
+	}
+}
+
+void pixel2rgb_565_le_span(void *dst, const pixel_t *src, size_t n)
+{
+	uint8_t *d = dst;
+
+#ifdef PIXCONV_SIMD
+	for (; n >= PIXCONV_VEC_PIXELS; n -= PIXCONV_VEC_PIXELS) {
+		pixconv_store16(d, PIXCONV_RGB_565(pixconv_load(src)), false);
+		src += PIXCONV_VEC_PIXELS;
+		d += 2 * PIXCONV_VEC_PIXELS;
+	}
+#endif
+	for (; n > 0; n--) {
+		pixconv_put16(d, PIXCONV_RGB_565(*src), false);
+		src++;
+		d += 2;
+	}
+}
+
+void pixel2bgr_323_span(void *dst, const pixel_t *src, size_t n)
+{
+	uint8_t *d = dst;
+
+#ifdef PIXCONV_SIMD
+	for (; n >= PIXCONV_VEC_PIXELS; n -= PIXCONV_VEC_PIXELS) {
+		pixconv_store8(d, PIXCONV_BGR_323(pixconv_load(src)));
+		src += PIXCONV_VEC_PIXELS;
+		d += PIXCONV_VEC_PIXELS;
+	}
+#endif
+	for (; n > 0; n--) {
+		*d++ = PIXCONV_BGR_323(*src);
+		src++;
+	}
+}
+
+void pixel2gray_8_span(void *dst, const pixel_t *src, size_t n)
+{
+	uint8_t *d = dst;
+
+#ifdef PIXCONV_SIMD
+	for (; n >= PIXCONV_VEC_PIXELS; n -= PIXCONV_VEC_PIXELS) {
+		pixconv_store8(d, PIXCONV_GRAY_8(pixconv_load(src)));
+		src += PIXCONV_VEC_PIXELS;
+		d += PIXCONV_VEC_PIXELS;
+	}
+#endif
+	for (; n > 0; n--) {
+		*d++ = PIXCONV_GRAY_8(*src);
+		src++;
+	}
+}
+
+/** @}
+ */
@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <mem.h>
+#include <pcut/pcut.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "../pixconv.h"
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(span);
+
+enum {
+	/** Maximum span length tested */
+	max_len = 37,
+	/** Maximum destination offset in pixels */
+	max_offs = 3,
+	/** Guard pixels after the span */
+	guard = 2,
+	/** Size of the destination buffers in 32-bit words */
+	buf_words = max_offs + max_len + guard
+};
+
+/** Generate test pixels covering all channel values. */
+static void gen_pixels(pixel_t *pixels, size_t n, uint32_t seed)
+{
+	for (size_t i = 0; i < n; i++) {
+		seed = seed * 1103515245 + 12345;
+		pixels[i] = seed ^ (seed >> 16) << 8;
+	}
+}
+
+/** Compare span function against per-pixel function.
+ *
+ * Every span length up to max_len and every destination offset up to
+ * max_offs pixels is tried, so that the vector loops start at different
+ * positions. Bytes around the span must stay untouched.
+ *
+ * @param pixel2visual Per-pixel function
+ * @param span Span function
+ * @param psize Pixel size in bytes
+ */
+static void test_span(pixel2visual_t pixel2visual, pixel2visual_span_t span,
+    size_t psize)
+{
+	pixel_t pixels[max_len];
+	/* Aligned as the per-pixel functions require */
+	uint32_t expected[buf_words];
+	uint32_t actual[buf_words];
+	uint8_t *edst;
+	uint8_t *adst;
+	size_t len;
+	size_t offs;
+	size_t i;
+
+	for (len = 0; len <= max_len; len++) {
+		for (offs = 0; offs <= max_offs; offs++) {
+			gen_pixels(pixels, len, len * 7 + offs);
+			memset(expected, 0xa5, sizeof(expected));
+			memset(actual, 0xa5, sizeof(actual));
+
+			edst = (uint8_t *) expected + offs * psize;
+			adst = (uint8_t *) actual + offs * psize;
+
+			for (i = 0; i < len; i++)
+				pixel2visual(edst + i * psize, pixels[i]);
+			span(adst, pixels, len);
+
+			PCUT_ASSERT_INT_EQUALS(0,
+			    memcmp(expected, actual, sizeof(expected)));
+		}
+	}
+}
+
+PCUT_TEST(argb_8888)
+{
+	test_span(pixel2argb_8888, pixel2argb_8888_span, 4);
+}
+
+PCUT_TEST(abgr_8888)
+{
+	test_span(pixel2abgr_8888, pixel2abgr_8888_span, 4);
+}
+
+PCUT_TEST(rgba_8888)
+{
+	test_span(pixel2rgba_8888, pixel2rgba_8888_span, 4);
+}
+
+PCUT_TEST(bgra_8888)
+{
+	test_span(pixel2bgra_8888, pixel2bgra_8888_span, 4);
+}
+
+PCUT_TEST(rgb_0888)
+{
+	test_span(pixel2rgb_0888, pixel2rgb_0888_span, 4);
+}
+
+PCUT_TEST(bgr_0888)
+{
+	test_span(pixel2bgr_0888, pixel2bgr_0888_span, 4);
+}
+
+PCUT_TEST(rgb_8880)
+{
+	test_span(pixel2rgb_8880, pixel2rgb_8880_span, 4);
+}
+
+PCUT_TEST(bgr_8880)
+{
+	test_span(pixel2bgr_8880, pixel2bgr_8880_span, 4);
+}
+
+PCUT_TEST(rgb_888)
+{
+	test_span(pixel2rgb_888, pixel2rgb_888_span, 3);
+}
+
+PCUT_TEST(bgr_888)
+{
+	test_span(pixel2bgr_888, pixel2bgr_888_span, 3);
+}
+
+PCUT_TEST(rgb_555_be)
+{
+	test_span(pixel2rgb_555_be, pixel2rgb_555_be_span, 2);
+}
+
+PCUT_TEST(rgb_555_le)
+{
+	test_span(pixel2rgb_555_le, pixel2rgb_555_le_span, 2);
+}
+
+PCUT_TEST(rgb_565_be)
+{
+	test_span(pixel2rgb_565_be, pixel2rgb_565_be_span, 2);
+}
+
+PCUT_TEST(rgb_565_le)
+{
+	test_span(pixel2rgb_565_le, pixel2rgb_565_le_span, 2);
+}
+
+PCUT_TEST(bgr_323)
+{
+	test_span(pixel2bgr_323, pixel2bgr_323_span, 1);
+}
+
+PCUT_TEST(gray_8)
+{
+	test_span(pixel2gray_8, pixel2gray_8_span, 1);
+}
+
+PCUT_EXPORT(span);
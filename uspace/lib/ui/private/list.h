@@ -108,6 +108,7 @@ typedef struct ui_list {
 extern gfx_coord_t ui_list_entry_height(ui_list_t *);
 extern errno_t ui_list_entry_paint(ui_list_entry_t *, size_t);
 extern errno_t ui_list_paint(ui_list_t *);
+extern errno_t ui_list_paint_scroll(ui_list_t *, size_t);
 extern ui_evclaim_t ui_list_kbd_event(ui_list_t *, kbd_event_t *);
 extern ui_evclaim_t ui_list_pos_event(ui_list_t *, pos_event_t *);
 extern unsigned ui_list_page_size(ui_list_t *);
@@ -50,6 +50,11 @@
 #include <types/ui/cursor.h>
 #include <types/ui/window.h>
 
+enum {
+	/** Maximum number of separately tracked dirty rectangles */
+	ui_window_dirty_max = 8
+};
+
 /** Actual structure of window.
  *
  * This is private to libui.
@@ -87,8 +92,10 @@ struct ui_window {
 	mem_gc_t *app_mgc;
 	/** Application area GC */
 	gfx_context_t *app_gc;
-	/** Dirty rectangle */
-	gfx_rect_t dirty_rect;
+	/** Dirty rectangles */
+	gfx_rect_t dirty_rect[ui_window_dirty_max];
+	/** Number of dirty rectangles */
+	size_t ndirty;
 	/** UI resource. Ideally this would be in ui_t. */
 	struct ui_resource *res;
 	/** Window decoration */
@@ -135,6 +142,8 @@ extern void ui_window_send_unfocus(ui_window_t *, unsigned);
 extern void ui_window_send_resize(ui_window_t *);
 extern errno_t ui_window_size_change(ui_window_t *, gfx_rect_t *,
     ui_wnd_sc_op_t);
+extern errno_t ui_window_scroll_rect(ui_window_t *, gfx_rect_t *,
+    gfx_coord_t);
 
 #endif
 
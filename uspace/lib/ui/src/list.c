@@ -46,6 +46,7 @@
 #include <ui/scrollbar.h>
 #include "../private/list.h"
 #include "../private/resource.h"
+#include "../private/window.h"
 
 static void ui_list_ctl_destroy(void *);
 static errno_t ui_list_ctl_paint(void *);
@@ -338,6 +339,99 @@ errno_t ui_list_paint(ui_list_t *list)
 	return EOK;
 }
 
+/** Repaint UI list after the page has been scrolled.
+ *
+ * Instead of repainting all entries, move the part of the list interior
+ * that remains visible and only paint the entries that have been scrolled
+ * into view. If the window contents cannot be moved (server-side rendering)
+ * or most of the page has changed, the list is repainted completely.
+ *
+ * Entries that change appearance for other reasons (such as the cursor
+ * moving) must be repainted by the caller. The caller is also responsible
+ * for calling gfx_update().
+ *
+ * @param list UI list
+ * @param old_page_idx Index of the first page entry before scrolling
+ * @return EOK on success or an error code
+ */
+errno_t ui_list_paint_scroll(ui_list_t *list, size_t old_page_idx)
+{
+	gfx_context_t *gc = ui_window_get_gc(list->window);
+	ui_resource_t *res = ui_window_get_res(list->window);
+	ui_list_entry_t *entry;
+	gfx_coord_t line_height;
+	gfx_rect_t irect;
+	gfx_rect_t band;
+	size_t rows;
+	size_t first;
+	size_t last;
+	size_t delta;
+	size_t i;
+	errno_t rc;
+
+	rows = ui_list_page_size(list) + 1;
+	line_height = ui_list_entry_height(list);
+	ui_list_inside_rect(list, &irect);
+
+	if (list->page_idx > old_page_idx)
+		delta = list->page_idx - old_page_idx;
+	else
+		delta = old_page_idx - list->page_idx;
+
+	if (delta == 0 || delta + 1 >= rows)
+		return ui_list_paint(list);
+
+	if (list->page_idx > old_page_idx) {
+		/*
+		 * Contents move up. The last row was only partially
+		 * visible, so it needs to be repainted, too.
+		 */
+		rc = ui_window_scroll_rect(list->window, &irect,
+		    -(gfx_coord_t) delta * line_height);
+		first = rows - 1 - delta;
+		last = rows;
+
+		band.p0.x = irect.p0.x;
+		band.p0.y = irect.p0.y + (gfx_coord_t) first * line_height;
+		band.p1 = irect.p1;
+	} else {
+		/* Contents move down */
+		rc = ui_window_scroll_rect(list->window, &irect,
+		    (gfx_coord_t) delta * line_height);
+		first = 0;
+		last = delta;
+
+		band.p0 = irect.p0;
+		band.p1.x = irect.p1.x;
+		band.p1.y = irect.p0.y + (gfx_coord_t) delta * line_height;
+	}
+
+	if (rc != EOK)
+		return ui_list_paint(list);
+
+	/* Clear the uncovered band, it may extend past the last entry */
+	rc = gfx_set_color(gc, res->entry_bg_color);
+	if (rc != EOK)
+		return rc;
+
+	rc = gfx_fill_rect(gc, &band);
+	if (rc != EOK)
+		return rc;
+
+	entry = list->page;
+	for (i = 0; i < last && entry != NULL; i++) {
+		if (i >= first) {
+			rc = ui_list_entry_paint(entry, list->page_idx + i);
+			if (rc != EOK)
+				return rc;
+		}
+
+		entry = ui_list_next(entry);
+	}
+
+	return EOK;
+}
+
 /** Handle list keyboard event.
  *
  * @param list UI list
@@ -1058,6 +1152,7 @@ void ui_list_cursor_move(ui_list_t *list,
 	gfx_context_t *gc = ui_window_get_gc(list->window);
 	ui_list_entry_t *old_cursor;
 	size_t old_idx;
+	size_t old_page_idx;
 	size_t rows;
 	ui_list_entry_t *e;
 	size_t i;
@@ -1066,6 +1161,7 @@ void ui_list_cursor_move(ui_list_t *list,
 
 	old_cursor = list->cursor;
 	old_idx = list->cursor_idx;
+	old_page_idx = list->page_idx;
 
 	list->cursor = entry;
 	list->cursor_idx = entry_idx;
@@ -1083,7 +1179,7 @@ void ui_list_cursor_move(ui_list_t *list,
 		(void) gfx_update(gc);
 	} else {
 		/*
-		 * Need to scroll and update all rows.
+		 * Need to scroll and update the rows scrolled into view.
 		 */
 
 		/* Scrolling up */
@@ -1112,7 +1208,10 @@ void ui_list_cursor_move(ui_list_t *list,
 		}
 
 		ui_list_scrollbar_update(list);
-		(void) ui_list_paint(list);
+		(void) ui_list_paint_scroll(list, old_page_idx);
+		ui_list_entry_paint(old_cursor, old_idx);
+		ui_list_entry_paint(list->cursor, list->cursor_idx);
+		(void) gfx_update(gc);
 	}
 }
 
@@ -1175,6 +1274,7 @@ void ui_list_page_up(ui_list_t *list)
 	ui_list_entry_t *old_page;
 	ui_list_entry_t *old_cursor;
 	size_t old_idx;
+	size_t old_page_idx;
 	size_t rows;
 	ui_list_entry_t *entry;
 	size_t i;
@@ -1182,6 +1282,7 @@ void ui_list_page_up(ui_list_t *list)
 	rows = ui_list_page_size(list);
 
 	old_page = list->page;
+	old_page_idx = list->page_idx;
 	old_cursor = list->cursor;
 	old_idx = list->cursor_idx;
 
@@ -1205,9 +1306,13 @@ void ui_list_page_up(ui_list_t *list)
 	}
 
 	if (list->page != old_page) {
-		/* We have scrolled. Need to repaint all entries */
+		/* We have scrolled. Move what stays visible, paint the rest */
 		ui_list_scrollbar_update(list);
-		(void) ui_list_paint(list);
+		(void) ui_list_paint_scroll(list, old_page_idx);
+		ui_list_entry_paint(old_cursor, old_idx);
+		ui_list_entry_paint(list->cursor, list->cursor_idx);
+
+		(void) gfx_update(gc);
 	} else if (list->cursor != old_cursor) {
 		/* No scrolling, but cursor has moved */
 		ui_list_entry_paint(old_cursor, old_idx);
@@ -1227,6 +1332,7 @@ void ui_list_page_down(ui_list_t *list)
 	ui_list_entry_t *old_page;
 	ui_list_entry_t *old_cursor;
 	size_t old_idx;
+	size_t old_page_idx;
 	size_t max_idx;
 	size_t rows;
 	ui_list_entry_t *entry;
@@ -1235,6 +1341,7 @@ void ui_list_page_down(ui_list_t *list)
 	rows = ui_list_page_size(list);
 
 	old_page = list->page;
+	old_page_idx = list->page_idx;
 	old_cursor = list->cursor;
 	old_idx = list->cursor_idx;
 
@@ -1264,9 +1371,13 @@ void ui_list_page_down(ui_list_t *list)
 	}
 
 	if (list->page != old_page) {
-		/* We have scrolled. Need to repaint all entries */
+		/* We have scrolled. Move what stays visible, paint the rest */
 		ui_list_scrollbar_update(list);
-		(void) ui_list_paint(list);
+		(void) ui_list_paint_scroll(list, old_page_idx);
+		ui_list_entry_paint(old_cursor, old_idx);
+		ui_list_entry_paint(list->cursor, list->cursor_idx);
+
+		(void) gfx_update(gc);
 	} else if (list->cursor != old_cursor) {
 		/* No scrolling, but cursor has moved */
 		ui_list_entry_paint(old_cursor, old_idx);
@@ -1282,7 +1393,9 @@ void ui_list_page_down(ui_list_t *list)
  */
 void ui_list_scroll_up(ui_list_t *list)
 {
+	gfx_context_t *gc = ui_window_get_gc(list->window);
 	ui_list_entry_t *prev;
+	size_t old_page_idx;
 
 	if (list->page == NULL)
 		return;
@@ -1291,12 +1404,14 @@ void ui_list_scroll_up(ui_list_t *list)
 	if (prev == NULL)
 		return;
 
+	old_page_idx = list->page_idx;
 	list->page = prev;
 	assert(list->page_idx > 0);
 	--list->page_idx;
 
 	ui_list_scrollbar_update(list);
-	(void) ui_list_paint(list);
+	(void) ui_list_paint_scroll(list, old_page_idx);
+	(void) gfx_update(gc);
 }
 
 /** Scroll one entry down.
@@ -1305,10 +1420,12 @@ void ui_list_scroll_up(ui_list_t *list)
  */
 void ui_list_scroll_down(ui_list_t *list)
 {
+	gfx_context_t *gc = ui_window_get_gc(list->window);
 	ui_list_entry_t *next;
 	ui_list_entry_t *pgend;
 	size_t i;
 	size_t rows;
+	size_t old_page_idx;
 
 	if (list->page == NULL)
 		return;
@@ -1325,6 +1442,8 @@ void ui_list_scroll_down(ui_list_t *list)
 		pgend = ui_list_next(pgend);
 	}
 
+	old_page_idx = list->page_idx;
+
 	/* Scroll down by one entry, if the page remains full */
 	if (pgend != NULL) {
 		list->page = next;
@@ -1332,7 +1451,8 @@ void ui_list_scroll_down(ui_list_t *list)
 	}
 
 	ui_list_scrollbar_update(list);
-	(void) ui_list_paint(list);
+	(void) ui_list_paint_scroll(list, old_page_idx);
+	(void) gfx_update(gc);
 }
 
 /** Scroll one page up.
@@ -1341,15 +1461,18 @@ void ui_list_scroll_down(ui_list_t *list)
  */
 void ui_list_scroll_page_up(ui_list_t *list)
 {
+	gfx_context_t *gc = ui_window_get_gc(list->window);
 	ui_list_entry_t *prev;
 	size_t i;
 	size_t rows;
+	size_t old_page_idx;
 
 	prev = ui_list_prev(list->page);
 	if (prev == NULL)
 		return;
 
 	rows = ui_list_page_size(list);
+	old_page_idx = list->page_idx;
 
 	for (i = 0; i < rows && prev != NULL; i++) {
 		list->page = prev;
@@ -1359,7 +1482,8 @@ void ui_list_scroll_page_up(ui_list_t *list)
 	}
 
 	ui_list_scrollbar_update(list);
-	(void) ui_list_paint(list);
+	(void) ui_list_paint_scroll(list, old_page_idx);
+	(void) gfx_update(gc);
 }
 
 /** Scroll one page down.
@@ -1368,10 +1492,12 @@ void ui_list_scroll_page_up(ui_list_t *list)
  */
 void ui_list_scroll_page_down(ui_list_t *list)
 {
+	gfx_context_t *gc = ui_window_get_gc(list->window);
 	ui_list_entry_t *next;
 	ui_list_entry_t *pgend;
 	size_t i;
 	size_t rows;
+	size_t old_page_idx;
 
 	next = ui_list_next(list->page);
 	if (next == NULL)
@@ -1385,6 +1511,8 @@ void ui_list_scroll_page_down(ui_list_t *list)
 		pgend = ui_list_next(pgend);
 	}
 
+	old_page_idx = list->page_idx;
+
 	/* Scroll by up to 'rows' entries, keeping the page full */
 	for (i = 0; i < rows && pgend != NULL; i++) {
 		list->page = next;
@@ -1394,7 +1522,8 @@ void ui_list_scroll_page_down(ui_list_t *list)
 	}
 
 	ui_list_scrollbar_update(list);
-	(void) ui_list_paint(list);
+	(void) ui_list_paint_scroll(list, old_page_idx);
+	(void) gfx_update(gc);
 }
 
 /** Scroll to a specific entry
@@ -1404,8 +1533,10 @@ void ui_list_scroll_page_down(ui_list_t *list)
  */
 void ui_list_scroll_pos(ui_list_t *list, size_t page_idx)
 {
+	gfx_context_t *gc = ui_window_get_gc(list->window);
 	ui_list_entry_t *entry;
 	size_t i;
+	size_t old_page_idx;
 
 	entry = ui_list_first(list);
 	for (i = 0; i < page_idx; i++) {
@@ -1413,10 +1544,12 @@ void ui_list_scroll_pos(ui_list_t *list, size_t page_idx)
 		assert(entry != NULL);
 	}
 
+	old_page_idx = list->page_idx;
 	list->page = entry;
 	list->page_idx = page_idx;
 
-	(void) ui_list_paint(list);
+	(void) ui_list_paint_scroll(list, old_page_idx);
+	(void) gfx_update(gc);
 }
 
 /** Request UI list activation.
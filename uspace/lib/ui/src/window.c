@@ -774,6 +774,75 @@ error:
 	return rc;
 }
 
+/** Scroll contents of window rectangle vertically.
+ *
+ * Moves the pixels inside @a rect by @a dy rows directly in the window
+ * bitmap. Pixels moved outside of @a rect are discarded, the band
+ * uncovered at the other edge keeps its old contents and must be
+ * repainted by the caller. The rectangle is marked as dirty and will be
+ * presented on the next gfx_update().
+ *
+ * This is only possible with client-side rendering. Otherwise the caller
+ * must repaint the whole rectangle.
+ *
+ * @param window Window
+ * @param rect Rectangle in window coordinates
+ * @param dy Vertical offset (positive moves contents down)
+ * @return EOK on success, ENOTSUP if window contents cannot be accessed
+ *         or an error code
+ */
+errno_t ui_window_scroll_rect(ui_window_t *window, gfx_rect_t *rect,
+    gfx_coord_t dy)
+{
+	gfx_bitmap_alloc_t alloc;
+	gfx_rect_t brect;
+	gfx_rect_t srect;
+	gfx_rect_t crect;
+	gfx_coord_t y;
+	uint8_t *pixels;
+	size_t rowlen;
+	errno_t rc;
+
+	/* mgc != NULL iff client-side rendering */
+	if (window->mgc == NULL)
+		return ENOTSUP;
+
+	rc = gfx_bitmap_get_alloc(window->bmp, &alloc);
+	if (rc != EOK)
+		return rc;
+
+	/* Window bitmap has its top-left corner at 0,0 */
+	gfx_rect_rtranslate(&window->rect.p0, &window->rect, &brect);
+	gfx_rect_points_sort(rect, &srect);
+	gfx_rect_clip(&srect, &brect, &crect);
+	if (gfx_rect_is_empty(&crect))
+		return EOK;
+
+	pixels = (uint8_t *) alloc.pixels + alloc.off0;
+	rowlen = (crect.p1.x - crect.p0.x) * sizeof(uint32_t);
+
+	if (dy < 0) {
+		/* Contents move up, copy rows top to bottom */
+		for (y = crect.p0.y; y - dy < crect.p1.y; y++) {
+			memmove(pixels + y * alloc.pitch +
+			    crect.p0.x * sizeof(uint32_t),
+			    pixels + (y - dy) * alloc.pitch +
+			    crect.p0.x * sizeof(uint32_t), rowlen);
+		}
+	} else if (dy > 0) {
+		/* Contents move down, copy rows bottom to top */
+		for (y = crect.p1.y - 1; y - dy >= crect.p0.y; y--) {
+			memmove(pixels + y * alloc.pitch +
+			    crect.p0.x * sizeof(uint32_t),
+			    pixels + (y - dy) * alloc.pitch +
+			    crect.p0.x * sizeof(uint32_t), rowlen);
+		}
+	}
+
+	ui_window_invalidate((void *) window, &crect);
+	return EOK;
+}
+
 /** Resize/move window.
  *
  * Resize window to the dimensions of @a rect. If @a rect.p0 is not 0,0,
@@ -1710,6 +1779,17 @@ static void wnd_sysmenu_press_accel(ui_menu_t *sysmenu, void *arg,
 	(void)idev_id;
 }
 
+/** Compute area of a sorted rectangle.
+ *
+ * @param rect Sorted rectangle
+ * @return Number of pixels in @a rect
+ */
+static uint64_t ui_window_rect_area(gfx_rect_t *rect)
+{
+	return (uint64_t) (rect->p1.x - rect->p0.x) *
+	    (uint64_t) (rect->p1.y - rect->p0.y);
+}
+
 /** Window invalidate callback
  *
  * @param arg Argument (ui_window_t *)
@@ -1718,10 +1798,55 @@ static void wnd_sysmenu_press_accel(ui_menu_t *sysmenu, void *arg,
 static void ui_window_invalidate(void *arg, gfx_rect_t *rect)
 {
 	ui_window_t *window = (ui_window_t *) arg;
+	gfx_rect_t srect;
 	gfx_rect_t env;
+	gfx_rect_t isect;
+	uint64_t growth;
+	uint64_t best_growth;
+	size_t best;
+	size_t i;
+
+	if (gfx_rect_is_empty(rect))
+		return;
+
+	gfx_rect_points_sort(rect, &srect);
+
+	/* Absorb dirty rectangles overlapping the new one */
+	i = 0;
+	while (i < window->ndirty) {
+		gfx_rect_clip(&window->dirty_rect[i], &srect, &isect);
+		if (gfx_rect_is_empty(&isect)) {
+			++i;
+			continue;
+		}
+
+		gfx_rect_envelope(&window->dirty_rect[i], &srect, &env);
+		srect = env;
+		window->dirty_rect[i] =
+		    window->dirty_rect[--window->ndirty];
+		i = 0;
+	}
+
+	if (window->ndirty < ui_window_dirty_max) {
+		window->dirty_rect[window->ndirty++] = srect;
+		return;
+	}
+
+	/* Merge with the rectangle whose envelope grows the least */
+	best = 0;
+	best_growth = UINT64_MAX;
+	for (i = 0; i < window->ndirty; i++) {
+		gfx_rect_envelope(&window->dirty_rect[i], &srect, &env);
+		growth = ui_window_rect_area(&env) -
+		    ui_window_rect_area(&window->dirty_rect[i]);
+		if (growth < best_growth) {
+			best_growth = growth;
+			best = i;
+		}
+	}
 
-	gfx_rect_envelope(&window->dirty_rect, rect, &env);
-	window->dirty_rect = env;
+	gfx_rect_envelope(&window->dirty_rect[best], &srect, &env);
+	window->dirty_rect[best] = env;
 }
 
 /** Window update callback
@@ -1731,16 +1856,14 @@ static void ui_window_invalidate(void *arg, gfx_rect_t *rect)
 static void ui_window_update(void *arg)
 {
 	ui_window_t *window = (ui_window_t *) arg;
+	size_t i;
 
-	if (!gfx_rect_is_empty(&window->dirty_rect)) {
-		(void) gfx_bitmap_render(window->bmp, &window->dirty_rect,
+	for (i = 0; i < window->ndirty; i++) {
+		(void) gfx_bitmap_render(window->bmp, &window->dirty_rect[i],
 		    &window->dpos);
 	}
 
-	window->dirty_rect.p0.x = 0;
-	window->dirty_rect.p0.y = 0;
-	window->dirty_rect.p1.x = 0;
-	window->dirty_rect.p1.y = 0;
+	window->ndirty = 0;
 }
 
 /** Window cursor get position callback
@@ -26,6 +26,7 @@
  * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <gfx/bitmap.h>
 #include <gfx/context.h>
 #include <gfx/coord.h>
 #include <gfx/render.h>
@@ -34,6 +35,7 @@
 #include <mem.h>
 #include <pcut/pcut.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <ui/control.h>
 #include <ui/resource.h>
 #include <ui/ui.h>
@@ -276,6 +278,82 @@ PCUT_TEST(resize)
 	ui_destroy(ui);
 }
 
+/** ui_window_scroll_rect() moves window contents */
+PCUT_TEST(scroll_rect)
+{
+	errno_t rc;
+	ui_t *ui = NULL;
+	ui_wnd_params_t params;
+	ui_window_t *window = NULL;
+	gfx_bitmap_alloc_t alloc;
+	gfx_rect_t rect;
+	uint32_t *pix;
+	gfx_coord_t x, y;
+
+	rc = ui_create_disp(NULL, &ui);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	ui_wnd_params_init(&params);
+	params.caption = "Hello";
+	params.rect.p0.x = 0;
+	params.rect.p0.y = 0;
+	params.rect.p1.x = 10;
+	params.rect.p1.y = 10;
+
+	rc = ui_window_create(ui, &params, &window);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_NOT_NULL(window);
+
+	rect.p0.x = 2;
+	rect.p0.y = 2;
+	rect.p1.x = 8;
+	rect.p1.y = 8;
+
+	if (window->mgc == NULL) {
+		/* Server-side rendering */
+		rc = ui_window_scroll_rect(window, &rect, -2);
+		PCUT_ASSERT_ERRNO_VAL(ENOTSUP, rc);
+		ui_window_destroy(window);
+		ui_destroy(ui);
+		return;
+	}
+
+	rc = gfx_bitmap_get_alloc(window->bmp, &alloc);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	/* Each pixel holds its row number */
+	for (y = 0; y < 10; y++) {
+		pix = (uint32_t *) ((uint8_t *) alloc.pixels + y * alloc.pitch);
+		for (x = 0; x < 10; x++)
+			pix[x] = y;
+	}
+
+	rc = ui_window_scroll_rect(window, &rect, -2);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	for (y = 0; y < 10; y++) {
+		pix = (uint32_t *) ((uint8_t *) alloc.pixels + y * alloc.pitch);
+		/* Outside of rect nothing changes */
+		PCUT_ASSERT_INT_EQUALS(y, pix[1]);
+		PCUT_ASSERT_INT_EQUALS(y, pix[8]);
+		if (y >= 2 && y < 6)
+			PCUT_ASSERT_INT_EQUALS(y + 2, pix[5]);
+		else
+			PCUT_ASSERT_INT_EQUALS(y, pix[5]);
+	}
+
+	rc = ui_window_scroll_rect(window, &rect, 3);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	for (y = 5; y < 8; y++) {
+		pix = (uint32_t *) ((uint8_t *) alloc.pixels + y * alloc.pitch);
+		PCUT_ASSERT_INT_EQUALS(y - 1, pix[5]);
+	}
+
+	ui_window_destroy(window);
+	ui_destroy(ui);
+}
+
 /** ui_window_get_ui() returns containing UI */
 PCUT_TEST(get_ui)
 {
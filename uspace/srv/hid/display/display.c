@@ -47,6 +47,7 @@
 #include "cursor.h"
 #include "display.h"
 #include "idevcfg.h"
+#include "region.h"
 #include "seat.h"
 #include "window.h"
 #include "wmclient.h"
@@ -873,10 +874,7 @@ static errno_t ds_display_alloc_backbuf(ds_display_t *disp)
 	if (rc != EOK)
 		goto error;
 
-	disp->dirty_rect.p0.x = 0;
-	disp->dirty_rect.p0.y = 0;
-	disp->dirty_rect.p1.x = 0;
-	disp->dirty_rect.p1.y = 0;
+	ds_region_init(&disp->dirty);
 
 	return EOK;
 error:
@@ -1186,6 +1184,7 @@ errno_t ds_display_paint_bg(ds_display_t *disp, gfx_rect_t *rect)
 
 /** Update front buffer from back buffer.
  *
+ * Only the rectangles of the dirty region are copied to the front buffer.
  * If the display is not double-buffered, no action is taken.
  *
  * @param disp Display
@@ -1194,20 +1193,73 @@ errno_t ds_display_paint_bg(ds_display_t *disp, gfx_rect_t *rect)
 static errno_t ds_display_update(ds_display_t *disp)
 {
 	errno_t rc;
+	size_t i;
 
 	if (disp->backbuf == NULL) {
 		/* Not double-buffered, nothing to do. */
 		return EOK;
 	}
 
-	rc = gfx_bitmap_render(disp->backbuf, &disp->dirty_rect, NULL);
-	if (rc != EOK)
-		return rc;
+	for (i = 0; i < disp->dirty.nrects; i++) {
+		rc = gfx_bitmap_render(disp->backbuf, &disp->dirty.rects[i],
+		    NULL);
+		if (rc != EOK)
+			return rc;
+	}
+
+	ds_region_init(&disp->dirty);
+	return EOK;
+}
+
+/** Paint display background and windows.
+ *
+ * Windows are painted top to bottom. Each window is only painted
+ * where it is not covered by windows above it, fully hidden windows
+ * are not painted at all. The background is painted where no window
+ * is visible.
+ *
+ * @param disp Display
+ * @param rect Display rectangle to paint
+ * @return EOK on success, ELIMIT if the visible regions are too complex
+ *         or another error code
+ */
+static errno_t ds_display_paint_visible(ds_display_t *disp, gfx_rect_t *rect)
+{
+	ds_region_t todo;
+	ds_region_t wreg;
+	gfx_rect_t drect;
+	ds_window_t *wnd;
+	size_t i;
+	errno_t rc;
 
-	disp->dirty_rect.p0.x = 0;
-	disp->dirty_rect.p0.y = 0;
-	disp->dirty_rect.p1.x = 0;
-	disp->dirty_rect.p1.y = 0;
+	ds_region_init_rect(&todo, rect);
+
+	wnd = ds_display_first_window(disp);
+	while (wnd != NULL && !ds_region_is_empty(&todo)) {
+		if (ds_window_is_visible(wnd)) {
+			/* Window bounding rectangle on display */
+			gfx_rect_translate(&wnd->dpos, &wnd->rect, &drect);
+
+			ds_region_clip(&todo, &drect, &wreg);
+			for (i = 0; i < wreg.nrects; i++) {
+				rc = ds_window_paint(wnd, &wreg.rects[i]);
+				if (rc != EOK)
+					return rc;
+			}
+
+			rc = ds_region_subtract_rect(&todo, &drect);
+			if (rc != EOK)
+				return rc;
+		}
+
+		wnd = ds_display_next_window(wnd);
+	}
+
+	for (i = 0; i < todo.nrects; i++) {
+		rc = ds_display_paint_bg(disp, &todo.rects[i]);
+		if (rc != EOK)
+			return rc;
+	}
 
 	return EOK;
 }
@@ -1220,22 +1272,33 @@ static errno_t ds_display_update(ds_display_t *disp)
 errno_t ds_display_paint(ds_display_t *disp, gfx_rect_t *rect)
 {
 	errno_t rc;
+	gfx_rect_t crect;
 	ds_window_t *wnd;
 	ds_seat_t *seat;
 
-	/* Paint background */
-	rc = ds_display_paint_bg(disp, rect);
-	if (rc != EOK)
-		return rc;
+	if (rect != NULL)
+		gfx_rect_clip(&disp->rect, rect, &crect);
+	else
+		crect = disp->rect;
 
-	/* Paint windows bottom to top */
-	wnd = ds_display_last_window(disp);
-	while (wnd != NULL) {
-		rc = ds_window_paint(wnd, rect);
+	/* Paint only visible parts of windows and background */
+	rc = ds_display_paint_visible(disp, &crect);
+	if (rc == ELIMIT) {
+		/* Too complex, paint background and windows bottom to top */
+		rc = ds_display_paint_bg(disp, &crect);
 		if (rc != EOK)
 			return rc;
 
-		wnd = ds_display_prev_window(wnd);
+		wnd = ds_display_last_window(disp);
+		while (wnd != NULL) {
+			rc = ds_window_paint(wnd, &crect);
+			if (rc != EOK)
+				return rc;
+
+			wnd = ds_display_prev_window(wnd);
+		}
+	} else if (rc != EOK) {
+		return rc;
 	}
 
 	/* Paint window previews for windows being resized or moved */
@@ -1264,7 +1327,7 @@ errno_t ds_display_paint(ds_display_t *disp, gfx_rect_t *rect)
 /** Display invalidate callback.
  *
  * Called by backbuffer memory GC when something is rendered into it.
- * Updates the display's dirty rectangle.
+ * Adds the rectangle to the display's dirty region.
  *
  * @param arg Argument (display cast as void *)
  * @param rect Rectangle to update
@@ -1272,10 +1335,8 @@ errno_t ds_display_paint(ds_display_t *disp, gfx_rect_t *rect)
 static void ds_display_invalidate_cb(void *arg, gfx_rect_t *rect)
 {
 	ds_display_t *disp = (ds_display_t *) arg;
-	gfx_rect_t env;
 
-	gfx_rect_envelope(&disp->dirty_rect, rect, &env);
-	disp->dirty_rect = env;
+	ds_region_add_rect(&disp->dirty, rect);
 }
 
 /** Display update callback.
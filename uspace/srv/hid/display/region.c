@@ -0,0 +1,280 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup display
+ * @{
+ */
+/**
+ * @file Display server region
+ *
+ * A region is a set of pixels stored as a list of disjoint rectangles.
+ * It is used to accumulate damage to the display and to determine which
+ * parts of a window are not covered by windows above it.
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <gfx/coord.h>
+#include <stdbool.h>
+#include "region.h"
+
+/** Subtract rectangle from rectangle.
+ *
+ * Splits the part of @a a not covered by @a b into at most four
+ * rectangles (bands above and below @a b and pieces left and right of it).
+ *
+ * @param a Sorted, non-empty rectangle
+ * @param b Sorted rectangle to subtract
+ * @param dest Array of at least four rectangles to store the result
+ * @return Number of rectangles stored to @a dest
+ */
+static size_t ds_rect_subtract(gfx_rect_t *a, gfx_rect_t *b,
+    gfx_rect_t *dest)
+{
+	gfx_rect_t isect;
+	size_t n = 0;
+
+	gfx_rect_clip(a, b, &isect);
+	if (gfx_rect_is_empty(&isect)) {
+		dest[0] = *a;
+		return 1;
+	}
+
+	if (a->p0.y < isect.p0.y) {
+		/* Band above */
+		dest[n].p0 = a->p0;
+		dest[n].p1.x = a->p1.x;
+		dest[n].p1.y = isect.p0.y;
+		++n;
+	}
+
+	if (isect.p1.y < a->p1.y) {
+		/* Band below */
+		dest[n].p0.x = a->p0.x;
+		dest[n].p0.y = isect.p1.y;
+		dest[n].p1 = a->p1;
+		++n;
+	}
+
+	if (a->p0.x < isect.p0.x) {
+		/* Piece on the left */
+		dest[n].p0.x = a->p0.x;
+		dest[n].p0.y = isect.p0.y;
+		dest[n].p1.x = isect.p0.x;
+		dest[n].p1.y = isect.p1.y;
+		++n;
+	}
+
+	if (isect.p1.x < a->p1.x) {
+		/* Piece on the right */
+		dest[n].p0.x = isect.p1.x;
+		dest[n].p0.y = isect.p0.y;
+		dest[n].p1.x = a->p1.x;
+		dest[n].p1.y = isect.p1.y;
+		++n;
+	}
+
+	return n;
+}
+
+/** Initialize empty region.
+ *
+ * @param region Region
+ */
+void ds_region_init(ds_region_t *region)
+{
+	region->nrects = 0;
+}
+
+/** Initialize region consisting of a single rectangle.
+ *
+ * @param region Region
+ * @param rect Rectangle
+ */
+void ds_region_init_rect(ds_region_t *region, gfx_rect_t *rect)
+{
+	region->nrects = 0;
+
+	if (!gfx_rect_is_empty(rect)) {
+		gfx_rect_points_sort(rect, &region->rects[0]);
+		region->nrects = 1;
+	}
+}
+
+/** Determine if region is empty.
+ *
+ * @param region Region
+ * @return @c true iff region contains no pixels
+ */
+bool ds_region_is_empty(ds_region_t *region)
+{
+	return region->nrects == 0;
+}
+
+/** Get bounding rectangle of region.
+ *
+ * @param region Region
+ * @param bbox Place to store bounding rectangle (empty if region is empty)
+ */
+void ds_region_get_bbox(ds_region_t *region, gfx_rect_t *bbox)
+{
+	gfx_rect_t env;
+	size_t i;
+
+	bbox->p0.x = 0;
+	bbox->p0.y = 0;
+	bbox->p1.x = 0;
+	bbox->p1.y = 0;
+
+	for (i = 0; i < region->nrects; i++) {
+		gfx_rect_envelope(bbox, &region->rects[i], &env);
+		*bbox = env;
+	}
+}
+
+/** Add rectangle to region.
+ *
+ * Only the parts of @a rect not already in the region are added, so that
+ * the rectangles stay disjoint. Rectangles of the region that lie inside
+ * @a rect are replaced by it. If the result would not fit, the region
+ * is replaced with its bounding rectangle, i.e. the region may grow
+ * larger than the exact union.
+ *
+ * @param region Region
+ * @param rect Rectangle to add
+ */
+void ds_region_add_rect(ds_region_t *region, gfx_rect_t *rect)
+{
+	gfx_rect_t pieces[2][ds_region_max_rects];
+	gfx_rect_t srect;
+	gfx_rect_t bbox;
+	size_t npieces;
+	size_t nnew;
+	size_t cur;
+	size_t i, j;
+
+	if (gfx_rect_is_empty(rect))
+		return;
+
+	gfx_rect_points_sort(rect, &srect);
+
+	/* Drop rectangles that are covered by the new one */
+	i = 0;
+	while (i < region->nrects) {
+		if (gfx_rect_is_inside(&region->rects[i], &srect))
+			region->rects[i] = region->rects[--region->nrects];
+		else
+			++i;
+	}
+
+	/* Cut away parts of the new rectangle already in the region */
+	cur = 0;
+	pieces[cur][0] = srect;
+	npieces = 1;
+
+	for (i = 0; i < region->nrects && npieces > 0; i++) {
+		nnew = 0;
+		for (j = 0; j < npieces; j++) {
+			if (nnew + 4 > ds_region_max_rects)
+				goto collapse;
+
+			nnew += ds_rect_subtract(&pieces[cur][j],
+			    &region->rects[i], &pieces[1 - cur][nnew]);
+		}
+
+		cur = 1 - cur;
+		npieces = nnew;
+	}
+
+	if (region->nrects + npieces > ds_region_max_rects)
+		goto collapse;
+
+	for (i = 0; i < npieces; i++)
+		region->rects[region->nrects++] = pieces[cur][i];
+
+	return;
+collapse:
+	ds_region_get_bbox(region, &bbox);
+	gfx_rect_envelope(&bbox, &srect, &region->rects[0]);
+	region->nrects = 1;
+}
+
+/** Subtract rectangle from region.
+ *
+ * @param region Region
+ * @param rect Rectangle to subtract
+ * @return EOK on success, ELIMIT if the result would have too many
+ *         rectangles (in that case the region is not modified)
+ */
+errno_t ds_region_subtract_rect(ds_region_t *region, gfx_rect_t *rect)
+{
+	ds_region_t result;
+	gfx_rect_t srect;
+	size_t i;
+
+	if (gfx_rect_is_empty(rect))
+		return EOK;
+
+	gfx_rect_points_sort(rect, &srect);
+
+	result.nrects = 0;
+	for (i = 0; i < region->nrects; i++) {
+		if (result.nrects + 4 > ds_region_max_rects)
+			return ELIMIT;
+
+		result.nrects += ds_rect_subtract(&region->rects[i], &srect,
+		    &result.rects[result.nrects]);
+	}
+
+	*region = result;
+	return EOK;
+}
+
+/** Clip region to a rectangle.
+ *
+ * @param region Region
+ * @param rect Clipping rectangle
+ * @param dest Place to store the part of @a region inside @a rect
+ */
+void ds_region_clip(ds_region_t *region, gfx_rect_t *rect, ds_region_t *dest)
+{
+	gfx_rect_t crect;
+	size_t i;
+
+	assert(dest != region);
+
+	dest->nrects = 0;
+	for (i = 0; i < region->nrects; i++) {
+		gfx_rect_clip(&region->rects[i], rect, &crect);
+		if (!gfx_rect_is_empty(&crect))
+			dest->rects[dest->nrects++] = crect;
+	}
+}
+
+/** @}
+ */
@@ -36,6 +36,7 @@ PCUT_IMPORT(clonegc);
 PCUT_IMPORT(cursor);
 PCUT_IMPORT(display);
 PCUT_IMPORT(ievent);
+PCUT_IMPORT(region);
 PCUT_IMPORT(seat);
 PCUT_IMPORT(window);
 PCUT_IMPORT(wmclient);
@@ -0,0 +1,329 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <gfx/coord.h>
+#include <pcut/pcut.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "../region.h"
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(region);
+
+/** Compute total area of region. */
+static gfx_coord_t region_area(ds_region_t *region)
+{
+	gfx_coord_t area = 0;
+	size_t i;
+
+	for (i = 0; i < region->nrects; i++) {
+		area += (region->rects[i].p1.x - region->rects[i].p0.x) *
+		    (region->rects[i].p1.y - region->rects[i].p0.y);
+	}
+
+	return area;
+}
+
+/** Determine if point is in region. */
+static bool region_has_pt(ds_region_t *region, gfx_coord_t x, gfx_coord_t y)
+{
+	gfx_coord2_t pt;
+	size_t i;
+
+	pt.x = x;
+	pt.y = y;
+
+	for (i = 0; i < region->nrects; i++) {
+		if (gfx_pix_inside_rect(&pt, &region->rects[i]))
+			return true;
+	}
+
+	return false;
+}
+
+/** Set rectangle coordinates. */
+static void set_rect(gfx_rect_t *rect, gfx_coord_t x0, gfx_coord_t y0,
+    gfx_coord_t x1, gfx_coord_t y1)
+{
+	rect->p0.x = x0;
+	rect->p0.y = y0;
+	rect->p1.x = x1;
+	rect->p1.y = y1;
+}
+
+/** Initialized region is empty */
+PCUT_TEST(init_empty)
+{
+	ds_region_t region;
+	gfx_rect_t rect;
+
+	ds_region_init(&region);
+	PCUT_ASSERT_TRUE(ds_region_is_empty(&region));
+
+	set_rect(&rect, 10, 10, 10, 20);
+	ds_region_init_rect(&region, &rect);
+	PCUT_ASSERT_TRUE(ds_region_is_empty(&region));
+
+	set_rect(&rect, 10, 10, 20, 20);
+	ds_region_init_rect(&region, &rect);
+	PCUT_ASSERT_FALSE(ds_region_is_empty(&region));
+	PCUT_ASSERT_INT_EQUALS(100, region_area(&region));
+}
+
+/** Adding disjoint rectangles keeps them separate */
+PCUT_TEST(add_disjoint)
+{
+	ds_region_t region;
+	gfx_rect_t rect;
+	gfx_rect_t bbox;
+
+	ds_region_init(&region);
+
+	set_rect(&rect, 0, 0, 10, 10);
+	ds_region_add_rect(&region, &rect);
+	set_rect(&rect, 100, 100, 110, 110);
+	ds_region_add_rect(&region, &rect);
+
+	PCUT_ASSERT_INT_EQUALS(2, region.nrects);
+	PCUT_ASSERT_INT_EQUALS(200, region_area(&region));
+
+	ds_region_get_bbox(&region, &bbox);
+	PCUT_ASSERT_INT_EQUALS(0, bbox.p0.x);
+	PCUT_ASSERT_INT_EQUALS(0, bbox.p0.y);
+	PCUT_ASSERT_INT_EQUALS(110, bbox.p1.x);
+	PCUT_ASSERT_INT_EQUALS(110, bbox.p1.y);
+}
+
+/** Adding overlapping rectangles does not count pixels twice */
+PCUT_TEST(add_overlap)
+{
+	ds_region_t region;
+	gfx_rect_t rect;
+
+	ds_region_init(&region);
+
+	set_rect(&rect, 0, 0, 10, 10);
+	ds_region_add_rect(&region, &rect);
+	set_rect(&rect, 5, 5, 15, 15);
+	ds_region_add_rect(&region, &rect);
+
+	PCUT_ASSERT_INT_EQUALS(175, region_area(&region));
+	PCUT_ASSERT_TRUE(region_has_pt(&region, 0, 0));
+	PCUT_ASSERT_TRUE(region_has_pt(&region, 14, 14));
+	PCUT_ASSERT_FALSE(region_has_pt(&region, 14, 0));
+	PCUT_ASSERT_FALSE(region_has_pt(&region, 0, 14));
+
+	/* Adding a contained rectangle changes nothing */
+	set_rect(&rect, 1, 1, 4, 4);
+	ds_region_add_rect(&region, &rect);
+	PCUT_ASSERT_INT_EQUALS(175, region_area(&region));
+
+	/* Adding a covering rectangle replaces everything */
+	set_rect(&rect, -1, -1, 20, 20);
+	ds_region_add_rect(&region, &rect);
+	PCUT_ASSERT_INT_EQUALS(1, region.nrects);
+	PCUT_ASSERT_INT_EQUALS(441, region_area(&region));
+}
+
+/** Region collapses to bounding rectangle when full */
+PCUT_TEST(add_overflow)
+{
+	ds_region_t region;
+	gfx_rect_t rect;
+	gfx_rect_t bbox;
+	size_t i;
+
+	ds_region_init(&region);
+
+	for (i = 0; i < ds_region_max_rects + 1; i++) {
+		set_rect(&rect, 2 * i, 0, 2 * i + 1, 1);
+		ds_region_add_rect(&region, &rect);
+	}
+
+	PCUT_ASSERT_INT_EQUALS(1, region.nrects);
+	ds_region_get_bbox(&region, &bbox);
+	PCUT_ASSERT_INT_EQUALS(0, bbox.p0.x);
+	PCUT_ASSERT_INT_EQUALS(0, bbox.p0.y);
+	PCUT_ASSERT_INT_EQUALS(2 * ds_region_max_rects + 1, bbox.p1.x);
+	PCUT_ASSERT_INT_EQUALS(1, bbox.p1.y);
+}
+
+/** Subtracting a rectangle from the middle leaves a frame */
+PCUT_TEST(subtract)
+{
+	ds_region_t region;
+	gfx_rect_t rect;
+	errno_t rc;
+
+	set_rect(&rect, 0, 0, 10, 10);
+	ds_region_init_rect(&region, &rect);
+
+	set_rect(&rect, 2, 2, 8, 8);
+	rc = ds_region_subtract_rect(&region, &rect);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	PCUT_ASSERT_INT_EQUALS(4, region.nrects);
+	PCUT_ASSERT_INT_EQUALS(64, region_area(&region));
+	PCUT_ASSERT_FALSE(region_has_pt(&region, 5, 5));
+	PCUT_ASSERT_TRUE(region_has_pt(&region, 1, 5));
+
+	/* Subtracting everything leaves the region empty */
+	set_rect(&rect, 0, 0, 10, 10);
+	rc = ds_region_subtract_rect(&region, &rect);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_TRUE(ds_region_is_empty(&region));
+}
+
+/** Subtraction fails with ELIMIT and leaves region intact if too complex */
+PCUT_TEST(subtract_limit)
+{
+	ds_region_t region;
+	gfx_rect_t rect;
+	size_t nrects;
+	size_t i;
+	gfx_coord_t area;
+	errno_t rc;
+
+	ds_region_init(&region);
+
+	for (i = 0; i < ds_region_max_rects; i++) {
+		set_rect(&rect, 10 * i, 0, 10 * i + 9, 9);
+		ds_region_add_rect(&region, &rect);
+	}
+
+	PCUT_ASSERT_INT_EQUALS(ds_region_max_rects, region.nrects);
+	nrects = region.nrects;
+	area = region_area(&region);
+
+	/* Punch a hole into every rectangle */
+	set_rect(&rect, 0, 4, 10 * ds_region_max_rects, 5);
+	rc = ds_region_subtract_rect(&region, &rect);
+	PCUT_ASSERT_ERRNO_VAL(ELIMIT, rc);
+
+	PCUT_ASSERT_INT_EQUALS(nrects, region.nrects);
+	PCUT_ASSERT_INT_EQUALS(area, region_area(&region));
+}
+
+/** Clipping region to a rectangle */
+PCUT_TEST(clip)
+{
+	ds_region_t region;
+	ds_region_t clipped;
+	gfx_rect_t rect;
+
+	ds_region_init(&region);
+
+	set_rect(&rect, 0, 0, 10, 10);
+	ds_region_add_rect(&region, &rect);
+	set_rect(&rect, 20, 0, 30, 10);
+	ds_region_add_rect(&region, &rect);
+
+	set_rect(&rect, 5, 5, 25, 25);
+	ds_region_clip(&region, &rect, &clipped);
+
+	PCUT_ASSERT_INT_EQUALS(2, clipped.nrects);
+	PCUT_ASSERT_INT_EQUALS(50, region_area(&clipped));
+
+	set_rect(&rect, 11, 0, 19, 10);
+	ds_region_clip(&region, &rect, &clipped);
+	PCUT_ASSERT_TRUE(ds_region_is_empty(&clipped));
+}
+
+/** Random adds and subtracts agree with a pixel map */
+PCUT_TEST(random)
+{
+	bool pix[64][64];
+	ds_region_t region;
+	gfx_rect_t rect;
+	gfx_coord_t x, y;
+	gfx_coord_t area;
+	unsigned i;
+	errno_t rc;
+
+	srand(1);
+
+	for (y = 0; y < 64; y++) {
+		for (x = 0; x < 64; x++)
+			pix[y][x] = false;
+	}
+
+	ds_region_init(&region);
+
+	for (i = 0; i < 200; i++) {
+		x = rand() % 56;
+		y = rand() % 56;
+		set_rect(&rect, x, y, x + 1 + rand() % 8, y + 1 + rand() % 8);
+
+		if (i % 3 == 2) {
+			rc = ds_region_subtract_rect(&region, &rect);
+			if (rc != EOK)
+				continue;
+
+			for (y = rect.p0.y; y < rect.p1.y; y++) {
+				for (x = rect.p0.x; x < rect.p1.x; x++)
+					pix[y][x] = false;
+			}
+		} else {
+			ds_region_add_rect(&region, &rect);
+			if (region.nrects == 1 && region_area(&region) >
+			    (rect.p1.x - rect.p0.x) * (rect.p1.y - rect.p0.y)) {
+				/* Possibly collapsed to bounding box, resync */
+				for (y = 0; y < 64; y++) {
+					for (x = 0; x < 64; x++) {
+						pix[y][x] = region_has_pt(&region,
+						    x, y);
+					}
+				}
+				continue;
+			}
+
+			for (y = rect.p0.y; y < rect.p1.y; y++) {
+				for (x = rect.p0.x; x < rect.p1.x; x++)
+					pix[y][x] = true;
+			}
+		}
+
+		area = 0;
+		for (y = 0; y < 64; y++) {
+			for (x = 0; x < 64; x++) {
+				PCUT_ASSERT_EQUALS(pix[y][x],
+				    region_has_pt(&region, x, y));
+				if (pix[y][x])
+					++area;
+			}
+		}
+
+		/* Rectangles are disjoint */
+		PCUT_ASSERT_INT_EQUALS(area, region_area(&region));
+	}
+}
+
+PCUT_EXPORT(region);
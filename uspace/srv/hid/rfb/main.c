@@ -65,7 +65,7 @@ static ddev_ops_t rfb_ddev_ops = {
 };
 
 typedef struct {
-	rfb_t rfb;
+	rfb_t *rfb;
 	pixel_t color;
 	gfx_rect_t rect;
 	gfx_rect_t clip_rect;
@@ -92,13 +92,15 @@ static gfx_context_ops_t rfb_gc_ops = {
 
 static void rfb_gc_invalidate_rect(rfb_gc_t *rfbgc, gfx_rect_t *rect)
 {
-	rfb_t *rfb = &rfbgc->rfb;
+	rfb_t *rfb = rfbgc->rfb;
 	gfx_rect_t old_rect;
 	gfx_rect_t new_rect;
 
 	if (gfx_rect_is_empty(rect))
 		return;
 
+	fibril_mutex_lock(&rfb->lock);
+
 	if (!rfb->damage_valid) {
 		old_rect.p0.x = old_rect.p0.y = 0;
 		old_rect.p1.x = old_rect.p1.y = 0;
@@ -115,6 +117,10 @@ static void rfb_gc_invalidate_rect(rfb_gc_t *rfbgc, gfx_rect_t *rect)
 	rfb->damage_rect.y = new_rect.p0.y;
 	rfb->damage_rect.width = new_rect.p1.x - new_rect.p0.x;
 	rfb->damage_rect.height = new_rect.p1.y - new_rect.p0.y;
+	rfb->damage_valid = true;
+
+	fibril_condvar_broadcast(&rfb->damage_cv);
+	fibril_mutex_unlock(&rfb->lock);
 }
 
 static errno_t rfb_ddev_get_gc(void *arg, sysarg_t *arg2, sysarg_t *arg3)
@@ -219,7 +225,7 @@ static errno_t rfb_gc_fill_rect(void *arg, gfx_rect_t *rect)
 
 	for (y = crect.p0.y; y < crect.p1.y; y++) {
 		for (x = crect.p0.x; x < crect.p1.x; x++) {
-			pixelmap_put_pixel(&rfb->rfb.framebuffer, x, y,
+			pixelmap_put_pixel(&rfb->rfb->framebuffer, x, y,
 			    rfb->color);
 		}
 	}
@@ -343,7 +349,7 @@ static errno_t rfb_gc_bitmap_render(void *bm, gfx_rect_t *srect0,
 		for (y = srect.p0.y; y < srect.p1.y; y++) {
 			for (x = srect.p0.x; x < srect.p1.x; x++) {
 				color = pixelmap_get_pixel(&pbm, x, y);
-				pixelmap_put_pixel(&rfbbm->rfb->rfb.framebuffer,
+				pixelmap_put_pixel(&rfbbm->rfb->rfb->framebuffer,
 				    x + offs.x, y + offs.y, color);
 			}
 		}
@@ -353,7 +359,7 @@ static errno_t rfb_gc_bitmap_render(void *bm, gfx_rect_t *srect0,
 			for (x = srect.p0.x; x < srect.p1.x; x++) {
 				color = pixelmap_get_pixel(&pbm, x, y);
 				if (color != rfbbm->key_color) {
-					pixelmap_put_pixel(&rfbbm->rfb->rfb.framebuffer,
+					pixelmap_put_pixel(&rfbbm->rfb->rfb->framebuffer,
 					    x + offs.x, y + offs.y, color);
 				}
 			}
@@ -364,7 +370,7 @@ static errno_t rfb_gc_bitmap_render(void *bm, gfx_rect_t *srect0,
 			for (x = srect.p0.x; x < srect.p1.x; x++) {
 				color = pixelmap_get_pixel(&pbm, x, y);
 				if (color != rfbbm->key_color) {
-					pixelmap_put_pixel(&rfbbm->rfb->rfb.framebuffer,
+					pixelmap_put_pixel(&rfbbm->rfb->rfb->framebuffer,
 					    x + offs.x, y + offs.y,
 					    rfbbm->rfb->color);
 				}
@@ -421,6 +427,7 @@ static void client_connection(ipc_call_t *icall, void *arg)
 			return;
 		}
 
+		rfbgc->rfb = rfb;
 		rfbgc->rect.p0.x = 0;
 		rfbgc->rect.p0.y = 0;
 		rfbgc->rect.p1.x = rfb->width;
@@ -478,11 +485,15 @@ int main(int argc, char **argv)
 		}
 	}
 
-	rfb_init(&rfb, width, height, rfb_name);
+	errno_t rc = rfb_init(&rfb, width, height, rfb_name);
+	if (rc != EOK) {
+		fprintf(stderr, NAME ": Unable to initialize RFB.\n");
+		return 1;
+	}
 
 	async_set_fallback_port_handler(client_connection, &rfb);
 
-	errno_t rc = loc_server_register(NAME, &srv);
+	rc = loc_server_register(NAME, &srv);
 	if (rc != EOK) {
 		printf("%s: Unable to register server.\n", NAME);
 		return rc;
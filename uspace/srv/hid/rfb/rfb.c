@@ -26,6 +26,7 @@
  * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <adt/hash.h>
 #include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -135,7 +136,7 @@ static void rfb_framebuffer_update_request_to_host(rfb_framebuffer_update_reques
     rfb_framebuffer_update_request_t *dst)
 {
 	dst->x = uint16_t_be2host(src->x);
-	dst->y = uint16_t_be2host(src->x);
+	dst->y = uint16_t_be2host(src->y);
 	dst->width = uint16_t_be2host(src->width);
 	dst->height = uint16_t_be2host(src->height);
 }
@@ -155,6 +156,12 @@ static void rfb_rectangle_to_be(rfb_rectangle_t *src, rfb_rectangle_t *dst)
 	dst->enctype = host2uint32_t_be(src->enctype);
 }
 
+static void rfb_copyrect_to_be(rfb_copyrect_t *src, rfb_copyrect_t *dst)
+{
+	dst->src_x = host2uint16_t_be(src->src_x);
+	dst->src_y = host2uint16_t_be(src->src_y);
+}
+
 static void rfb_key_event_to_host(rfb_key_event_t *src, rfb_key_event_t *dst)
 {
 	dst->key = uint32_t_be2host(src->key);
@@ -174,8 +181,11 @@ static void rfb_client_cut_text_to_host(rfb_client_cut_text_t *src,
 
 errno_t rfb_init(rfb_t *rfb, uint16_t width, uint16_t height, const char *name)
 {
+	errno_t rc;
+
 	memset(rfb, 0, sizeof(rfb_t));
 	fibril_mutex_initialize(&rfb->lock);
+	fibril_condvar_initialize(&rfb->damage_cv);
 
 	rfb_pixel_format_t *pf = &rfb->pixel_format;
 	pf->bpp = 32;
@@ -190,24 +200,51 @@ errno_t rfb_init(rfb_t *rfb, uint16_t width, uint16_t height, const char *name)
 	pf->b_shift = 16;
 
 	rfb->name = str_dup(name);
+	if (rfb->name == NULL)
+		return ENOMEM;
+
 	rfb->supports_trle = false;
 
+	rc = deflate_create(&rfb->zrle);
+	if (rc != EOK)
+		return rc;
+
+	/* Latency matters more than size, header says fastest compression */
+	rc = deflate_set_level(rfb->zrle, DEFLATE_LEVEL_FAST);
+	if (rc != EOK)
+		return rc;
+
 	return rfb_set_size(rfb, width, height);
 }
 
 errno_t rfb_set_size(rfb_t *rfb, uint16_t width, uint16_t height)
 {
 	size_t new_size = width * height * sizeof(pixel_t);
+	size_t hash_cols = (width + RFB_HASH_TILE_SIZE - 1) /
+	    RFB_HASH_TILE_SIZE;
+	size_t hash_size = hash_cols * height * sizeof(uint64_t);
 	void *pixbuf = malloc(new_size);
-	if (pixbuf == NULL)
+	uint64_t *line_hash = malloc(hash_size);
+	uint64_t *cur_hash = malloc(hash_size);
+	if (pixbuf == NULL || line_hash == NULL || cur_hash == NULL) {
+		free(pixbuf);
+		free(line_hash);
+		free(cur_hash);
 		return ENOMEM;
+	}
 
 	free(rfb->framebuffer.data);
+	free(rfb->line_hash);
+	free(rfb->cur_hash);
 	rfb->framebuffer.data = pixbuf;
 	rfb->framebuffer.width = width;
 	rfb->framebuffer.height = height;
 	rfb->width = width;
 	rfb->height = height;
+	rfb->line_hash = line_hash;
+	rfb->cur_hash = cur_hash;
+	rfb->hash_cols = hash_cols;
+	rfb->line_hash_valid = false;
 
 	/* Fill with white */
 	memset(rfb->framebuffer.data, 255, new_size);
@@ -423,6 +460,7 @@ static size_t rfb_tile_encode_raw(rfb_t *rfb, cpixel_ctx_t *cpixel,
 		for (uint16_t x = tile->x; x < tile->x + tile->width; x++) {
 			pixel_t pixel = pixelmap_get_pixel(&rfb->framebuffer, x, y);
 			cpixel_encode(rfb, cpixel, buf, pixel);
+			buf += cpixel->size;
 		}
 	}
 
@@ -457,8 +495,8 @@ static size_t rfb_rect_encode_trle(rfb_t *rfb, rfb_rectangle_t *rect, void *buf)
 	for (uint16_t y = 0; y < rect->height; y += 16) {
 		for (uint16_t x = 0; x < rect->width; x += 16) {
 			rfb_rectangle_t tile = {
-				.x = x,
-				.y = y,
+				.x = rect->x + x,
+				.y = rect->y + y,
 				.width = (x + 16 <= rect->width ? 16 : rect->width - x),
 				.height = (y + 16 <= rect->height ? 16 : rect->height - y)
 			};
@@ -486,51 +524,837 @@ static size_t rfb_rect_encode_trle(rfb_t *rfb, rfb_rectangle_t *rect, void *buf)
 	return size;
 }
 
+/** Maximum number of colors in a ZRLE tile palette */
+#define RFB_ZRLE_PALETTE_MAX 127
+
+/** Palette of a ZRLE tile */
+typedef struct {
+	/** Palette colors */
+	pixel_t color[RFB_ZRLE_PALETTE_MAX];
+	/** Number of colors used */
+	size_t count;
+	/** Open-addressing table mapping colors to palette index + 1 */
+	uint8_t slot[256];
+} rfb_palette_t;
+
+static void rfb_palette_init(rfb_palette_t *pal)
+{
+	pal->count = 0;
+	memset(pal->slot, 0, sizeof(pal->slot));
+}
+
+/** Find color in palette, adding it if it is not there yet.
+ *
+ * @param pal Palette
+ * @param color Color
+ * @return Palette index or -1 if the palette is full
+ */
+static int rfb_palette_index(rfb_palette_t *pal, pixel_t color)
+{
+	size_t h = hash_mix32(color) & 255;
+
+	while (pal->slot[h] != 0) {
+		if (pal->color[pal->slot[h] - 1] == color)
+			return pal->slot[h] - 1;
+		h = (h + 1) & 255;
+	}
+
+	if (pal->count >= RFB_ZRLE_PALETTE_MAX)
+		return -1;
+
+	pal->color[pal->count++] = color;
+	pal->slot[h] = pal->count;
+	return pal->count - 1;
+}
+
+/** Number of bytes needed to encode run length in (Z/T)RLE */
+static size_t rfb_run_length_size(size_t len)
+{
+	return (len - 1) / 255 + 1;
+}
+
+static uint8_t *rfb_put_run_length(uint8_t *p, size_t len)
+{
+	len--;
+	while (len >= 255) {
+		*p++ = 255;
+		len -= 255;
+	}
+
+	*p++ = len;
+	return p;
+}
+
+/** Encode one run of a (palette) RLE ZRLE tile. */
+static uint8_t *rfb_zrle_put_run(rfb_t *rfb, cpixel_ctx_t *cpixel,
+    rfb_palette_t *pal, uint8_t *p, pixel_t color, size_t len)
+{
+	if (pal != NULL) {
+		int idx = rfb_palette_index(pal, color);
+		if (len == 1) {
+			*p++ = idx;
+			return p;
+		}
+
+		*p++ = idx | 128;
+	} else {
+		cpixel_encode(rfb, cpixel, p, color);
+		p += cpixel->size;
+	}
+
+	return rfb_put_run_length(p, len);
+}
+
+/** Encode ZRLE tile.
+ *
+ * Determines the size of each possible subencoding (solid, packed
+ * palette, plain RLE, palette RLE and raw) and uses the smallest one.
+ *
+ * @param rfb RFB server
+ * @param cpixel CPIXEL context
+ * @param tile Tile
+ * @param buf Buffer with enough space for raw encoding of the tile
+ * @return Number of bytes written
+ */
+static size_t rfb_zrle_encode_tile(rfb_t *rfb, cpixel_ctx_t *cpixel,
+    rfb_rectangle_t *tile, uint8_t *buf)
+{
+	rfb_palette_t pal;
+	pixel_t *fb = rfb->framebuffer.data;
+	size_t stride = rfb->width;
+	size_t w = tile->width;
+	size_t h = tile->height;
+	pixel_t *line;
+	pixel_t prev;
+	size_t run;
+	size_t rle_size;
+	size_t prle_size;
+	size_t best;
+	size_t bits = 0;
+	size_t size;
+	uint8_t subenc;
+	bool pal_ok = true;
+	uint8_t *p;
+	size_t x, y, i;
+
+	rfb_palette_init(&pal);
+
+	/* Gather statistics */
+	rle_size = 1;
+	prle_size = 1;
+	prev = fb[tile->y * stride + tile->x];
+	(void) rfb_palette_index(&pal, prev);
+	run = 0;
+
+	for (y = 0; y < h; y++) {
+		line = fb + (tile->y + y) * stride + tile->x;
+		for (x = 0; x < w; x++) {
+			if (line[x] == prev) {
+				++run;
+				continue;
+			}
+
+			if (pal_ok && rfb_palette_index(&pal, line[x]) < 0)
+				pal_ok = false;
+
+			rle_size += cpixel->size + rfb_run_length_size(run);
+			prle_size += run == 1 ? 1 : 1 + rfb_run_length_size(run);
+			prev = line[x];
+			run = 1;
+		}
+	}
+
+	rle_size += cpixel->size + rfb_run_length_size(run);
+	prle_size += run == 1 ? 1 : 1 + rfb_run_length_size(run);
+
+	/* Choose subencoding */
+	best = 1 + w * h * cpixel->size;
+	subenc = RFB_TILE_ENCODING_RAW;
+
+	if (rle_size < best) {
+		best = rle_size;
+		subenc = RFB_TILE_ENCODING_PLAIN_RLE;
+	}
+
+	if (pal_ok && pal.count == 1) {
+		subenc = RFB_TILE_ENCODING_SOLID;
+	} else if (pal_ok) {
+		if (pal.count <= 16) {
+			bits = pal.count == 2 ? 1 : pal.count <= 4 ? 2 : 4;
+			size = 1 + pal.count * cpixel->size +
+			    h * ((w * bits + 7) / 8);
+			if (size < best) {
+				best = size;
+				subenc = pal.count;
+			}
+		}
+
+		size = prle_size + pal.count * cpixel->size;
+		if (size < best) {
+			best = size;
+			subenc = RFB_TILE_ENCODING_PLAIN_RLE + pal.count;
+		}
+	}
+
+	/* Encode */
+	p = buf;
+	*p++ = subenc;
+
+	if (subenc == RFB_TILE_ENCODING_SOLID) {
+		cpixel_encode(rfb, cpixel, p, pal.color[0]);
+		return 1 + cpixel->size;
+	}
+
+	if (subenc == RFB_TILE_ENCODING_RAW) {
+		for (y = 0; y < h; y++) {
+			line = fb + (tile->y + y) * stride + tile->x;
+			for (x = 0; x < w; x++) {
+				cpixel_encode(rfb, cpixel, p, line[x]);
+				p += cpixel->size;
+			}
+		}
+
+		return p - buf;
+	}
+
+	if (subenc != RFB_TILE_ENCODING_PLAIN_RLE) {
+		for (i = 0; i < pal.count; i++) {
+			cpixel_encode(rfb, cpixel, p, pal.color[i]);
+			p += cpixel->size;
+		}
+	}
+
+	if (subenc <= 16) {
+		/* Packed palette */
+		for (y = 0; y < h; y++) {
+			uint8_t acc = 0;
+			size_t nbits = 0;
+
+			line = fb + (tile->y + y) * stride + tile->x;
+			for (x = 0; x < w; x++) {
+				acc = (acc << bits) |
+				    rfb_palette_index(&pal, line[x]);
+				nbits += bits;
+				if (nbits == 8) {
+					*p++ = acc;
+					acc = 0;
+					nbits = 0;
+				}
+			}
+
+			if (nbits > 0)
+				*p++ = acc << (8 - nbits);
+		}
+
+		return p - buf;
+	}
+
+	/* Plain or palette RLE */
+	prev = fb[tile->y * stride + tile->x];
+	run = 0;
+	for (y = 0; y < h; y++) {
+		line = fb + (tile->y + y) * stride + tile->x;
+		for (x = 0; x < w; x++) {
+			if (line[x] == prev) {
+				++run;
+				continue;
+			}
+
+			p = rfb_zrle_put_run(rfb, cpixel,
+			    subenc == RFB_TILE_ENCODING_PLAIN_RLE ? NULL : &pal,
+			    p, prev, run);
+			prev = line[x];
+			run = 1;
+		}
+	}
+
+	p = rfb_zrle_put_run(rfb, cpixel,
+	    subenc == RFB_TILE_ENCODING_PLAIN_RLE ? NULL : &pal, p, prev, run);
+	return p - buf;
+}
+
+/** Upper bound of the uncompressed size of ZRLE-encoded rectangle. */
+static size_t rfb_rect_zrle_raw_bound(rfb_t *rfb, rfb_rectangle_t *rect)
+{
+	cpixel_ctx_t cpixel;
+	size_t ntiles;
+
+	cpixel_context_init(&cpixel, &rfb->pixel_format);
+	ntiles = ((rect->width + RFB_ZRLE_TILE_SIZE - 1) / RFB_ZRLE_TILE_SIZE) *
+	    ((rect->height + RFB_ZRLE_TILE_SIZE - 1) / RFB_ZRLE_TILE_SIZE);
+
+	return ntiles + rect->width * rect->height * cpixel.size;
+}
+
+/** Upper bound of the size of ZRLE-encoded rectangle. */
+static size_t rfb_rect_zrle_bound(rfb_t *rfb, rfb_rectangle_t *rect)
+{
+	/* Length, zlib header and compressed data */
+	return sizeof(uint32_t) + 2 +
+	    deflate_bound(rfb_rect_zrle_raw_bound(rfb, rect));
+}
+
+/** Encode rectangle using ZRLE.
+ *
+ * All ZRLE rectangles sent over the connection form a single zlib stream.
+ *
+ * @param rfb RFB server
+ * @param rect Rectangle
+ * @param scratch Scratch buffer of at least rfb_rect_zrle_raw_bound() bytes
+ * @param buf Output buffer of at least rfb_rect_zrle_bound() bytes
+ * @param rsize Place to store number of bytes written
+ * @return EOK on success or an error code
+ */
+static errno_t rfb_rect_encode_zrle(rfb_t *rfb, rfb_rectangle_t *rect,
+    uint8_t *scratch, uint8_t *buf, size_t *rsize)
+{
+	cpixel_ctx_t cpixel;
+	size_t rawsize = 0;
+	size_t hdrsize = 0;
+	size_t csize;
+	uint32_t length;
+	errno_t rc;
+
+	cpixel_context_init(&cpixel, &rfb->pixel_format);
+
+	for (uint16_t y = 0; y < rect->height; y += RFB_ZRLE_TILE_SIZE) {
+		for (uint16_t x = 0; x < rect->width; x += RFB_ZRLE_TILE_SIZE) {
+			rfb_rectangle_t tile = {
+				.x = rect->x + x,
+				.y = rect->y + y,
+				.width = min(RFB_ZRLE_TILE_SIZE, rect->width - x),
+				.height = min(RFB_ZRLE_TILE_SIZE, rect->height - y)
+			};
+
+			rawsize += rfb_zrle_encode_tile(rfb, &cpixel, &tile,
+			    scratch + rawsize);
+		}
+	}
+
+	if (!rfb->zrle_started) {
+		/* zlib header: deflate, 32K window, no dictionary */
+		buf[sizeof(uint32_t)] = 0x78;
+		buf[sizeof(uint32_t) + 1] = 0x01;
+		hdrsize = 2;
+		rfb->zrle_started = true;
+	}
+
+	rc = deflate_compress(rfb->zrle, scratch, rawsize,
+	    buf + sizeof(uint32_t) + hdrsize, 2 + deflate_bound(rawsize) -
+	    hdrsize, deflate_flush_sync, &csize);
+	if (rc != EOK)
+		return rc;
+
+	length = host2uint32_t_be(hdrsize + csize);
+	memcpy(buf, &length, sizeof(uint32_t));
+
+	*rsize = sizeof(uint32_t) + hdrsize + csize;
+	return EOK;
+}
+
+/** Rectangle of hash tiles */
+typedef struct {
+	/** First column */
+	size_t c0;
+	/** Column after the last one */
+	size_t c1;
+	/** First row */
+	size_t r0;
+	/** Row after the last one */
+	size_t r1;
+} rfb_tile_span_t;
+
+/** Compute hash of one line of a tile. */
+static uint64_t rfb_line_hash(pixel_t *pix, size_t n)
+{
+	uint64_t h = n;
+
+	for (size_t i = 0; i < n; i++)
+		h = (h ^ pix[i]) * 0x9e3779b97f4a7c15ULL;
+
+	return hash_mix64(h);
+}
+
+/** Compute tile line hashes of the current framebuffer.
+ *
+ * @param rfb RFB server
+ * @param c0 First tile column
+ * @param c1 Tile column after the last one
+ * @param y0 First line
+ * @param y1 Line after the last one
+ */
+static void rfb_hash_area(rfb_t *rfb, size_t c0, size_t c1, size_t y0,
+    size_t y1)
+{
+	for (size_t y = y0; y < y1; y++) {
+		pixel_t *line = rfb->framebuffer.data + y * rfb->width;
+		uint64_t *hash = rfb->cur_hash + y * rfb->hash_cols;
+
+		for (size_t c = c0; c < c1; c++) {
+			size_t x = c * RFB_HASH_TILE_SIZE;
+			hash[c] = rfb_line_hash(line + x,
+			    min(RFB_HASH_TILE_SIZE, rfb->width - x));
+		}
+	}
+}
+
+/** Compute signature of a line across a range of tile columns. */
+static uint64_t rfb_line_sig(uint64_t *hash, size_t c0, size_t c1)
+{
+	uint64_t sig = 0;
+
+	for (size_t c = c0; c < c1; c++)
+		sig = hash_mix64(sig ^ hash[c]);
+
+	return sig;
+}
+
+/** Find longest vertically moved block of lines.
+ *
+ * Looks for the longest run of lines in the current framebuffer that
+ * match consecutive lines the client has at a different vertical offset.
+ *
+ * @param rfb RFB server
+ * @param c0 First tile column
+ * @param c1 Tile column after the last one
+ * @param y0 First line
+ * @param y1 Line after the last one
+ * @param osig Buffer for y1 - y0 old line signatures
+ * @param nsig Buffer for y1 - y0 new line signatures
+ * @param map Buffer for lookup table of @a mapsize entries
+ * @param mapsize Size of lookup table (power of two larger than y1 - y0)
+ * @param rdst Place to store first destination line
+ * @param rsrc Place to store first source line
+ * @return Number of lines in the block or zero if none was found
+ */
+static size_t rfb_find_moved_lines(rfb_t *rfb, size_t c0, size_t c1,
+    size_t y0, size_t y1, uint64_t *osig, uint64_t *nsig, uint32_t *map,
+    size_t mapsize, size_t *rdst, size_t *rsrc)
+{
+	size_t n = y1 - y0;
+	size_t best_len = 0;
+	size_t best_start = 0;
+	ssize_t best_dy = 0;
+	size_t run_len = 0;
+	size_t run_start = 0;
+	size_t run_gain = 0;
+	ssize_t run_dy = 0;
+	ssize_t j;
+	size_t h;
+	size_t i;
+
+	memset(map, 0, mapsize * sizeof(uint32_t));
+
+	for (i = 0; i < n; i++) {
+		osig[i] = rfb_line_sig(rfb->line_hash +
+		    (y0 + i) * rfb->hash_cols, c0, c1);
+		nsig[i] = rfb_line_sig(rfb->cur_hash +
+		    (y0 + i) * rfb->hash_cols, c0, c1);
+
+		h = osig[i] & (mapsize - 1);
+		while (map[h] != 0 && osig[map[h] - 1] != osig[i])
+			h = (h + 1) & (mapsize - 1);
+		map[h] = i + 1;
+	}
+
+	for (i = 0; i <= n; i++) {
+		if (i < n && run_len > 0) {
+			j = (ssize_t) i - run_dy;
+			if (j >= 0 && (size_t) j < n && nsig[i] == osig[j]) {
+				++run_len;
+				if (nsig[i] != osig[i])
+					++run_gain;
+				continue;
+			}
+		}
+
+		/* Current run ended */
+		if (run_len > best_len && run_gain > 0) {
+			best_len = run_len;
+			best_start = run_start;
+			best_dy = run_dy;
+		}
+
+		run_len = 0;
+		if (i == n)
+			break;
+
+		/* Start a new run if the line is somewhere in the old image */
+		h = nsig[i] & (mapsize - 1);
+		while (map[h] != 0 && osig[map[h] - 1] != nsig[i])
+			h = (h + 1) & (mapsize - 1);
+
+		if (map[h] != 0 && map[h] - 1 != i) {
+			run_dy = (ssize_t) i - (ssize_t) (map[h] - 1);
+			run_start = i;
+			run_len = 1;
+			run_gain = nsig[i] != osig[i] ? 1 : 0;
+		}
+	}
+
+	if (best_len < RFB_COPYRECT_MIN_ROWS)
+		return 0;
+
+	*rdst = y0 + best_start;
+	*rsrc = y0 + best_start - best_dy;
+	return best_len;
+}
+
+/** Detect content that was scrolled vertically.
+ *
+ * If the client can reuse part of its framebuffer, fill in a CopyRect
+ * and update the stored line hashes to reflect the client's framebuffer
+ * after the copy.
+ *
+ * @param rfb RFB server
+ * @param c0 First tile column
+ * @param c1 Tile column after the last one
+ * @param y0 First line
+ * @param y1 Line after the last one
+ * @param rect Place to store destination rectangle
+ * @param src Place to store source position
+ * @return @c true iff CopyRect should be sent
+ */
+static bool rfb_detect_copy(rfb_t *rfb, size_t c0, size_t c1, size_t y0,
+    size_t y1, rfb_rectangle_t *rect, rfb_copyrect_t *src)
+{
+	size_t n = y1 - y0;
+	size_t mapsize;
+	uint64_t *sig;
+	uint32_t *map;
+	size_t dst_y = 0;
+	size_t src_y = 0;
+	size_t len;
+	size_t i, k;
+
+	if (n < RFB_COPYRECT_MIN_ROWS)
+		return false;
+
+	mapsize = 1;
+	while (mapsize < 2 * n)
+		mapsize <<= 1;
+
+	sig = malloc(2 * n * sizeof(uint64_t));
+	map = malloc(mapsize * sizeof(uint32_t));
+	if (sig == NULL || map == NULL) {
+		free(sig);
+		free(map);
+		return false;
+	}
+
+	len = rfb_find_moved_lines(rfb, c0, c1, y0, y1, sig, sig + n, map,
+	    mapsize, &dst_y, &src_y);
+	if (len == 0 && c1 - c0 >= 3) {
+		/*
+		 * Edges of the area (e.g. scroll bars or window frame)
+		 * might not have moved with the content.
+		 */
+		++c0;
+		--c1;
+		len = rfb_find_moved_lines(rfb, c0, c1, y0, y1, sig, sig + n,
+		    map, mapsize, &dst_y, &src_y);
+	}
+
+	free(sig);
+	free(map);
+
+	if (len == 0)
+		return false;
+
+	rect->x = c0 * RFB_HASH_TILE_SIZE;
+	rect->y = dst_y;
+	rect->width = min(c1 * RFB_HASH_TILE_SIZE, rfb->width) - rect->x;
+	rect->height = len;
+	rect->enctype = RFB_ENCODING_COPYRECT;
+	src->src_x = rect->x;
+	src->src_y = src_y;
+
+	/* Move stored hashes the same way the client moves pixels */
+	for (i = 0; i < len; i++) {
+		k = dst_y > src_y ? len - 1 - i : i;
+		memcpy(rfb->line_hash + (dst_y + k) * rfb->hash_cols + c0,
+		    rfb->line_hash + (src_y + k) * rfb->hash_cols + c0,
+		    (c1 - c0) * sizeof(uint64_t));
+	}
+
+	return true;
+}
+
+/** Determine if tile differs from what the client has. */
+static bool rfb_tile_changed(rfb_t *rfb, size_t c, size_t r)
+{
+	size_t y0 = r * RFB_HASH_TILE_SIZE;
+	size_t y1 = min(y0 + RFB_HASH_TILE_SIZE, rfb->height);
+
+	for (size_t y = y0; y < y1; y++) {
+		if (rfb->cur_hash[y * rfb->hash_cols + c] !=
+		    rfb->line_hash[y * rfb->hash_cols + c])
+			return true;
+	}
+
+	return false;
+}
+
+/** Cover changed tiles with rectangles.
+ *
+ * Changed tiles are merged horizontally into spans, spans with the same
+ * columns in consecutive tile rows are merged vertically.
+ *
+ * @param rfb RFB server
+ * @param all @c true to treat all tiles as changed
+ * @param area Tiles to examine
+ * @param spans Array with space for one span per tile in @a area
+ * @return Number of spans stored
+ */
+static size_t rfb_find_changed(rfb_t *rfb, bool all, rfb_tile_span_t *area,
+    rfb_tile_span_t *spans)
+{
+	size_t nspans = 0;
+	size_t row_start;
+	size_t c, ca;
+	size_t r, i;
+
+	for (r = area->r0; r < area->r1; r++) {
+		row_start = nspans;
+		c = area->c0;
+		while (c < area->c1) {
+			if (!all && !rfb_tile_changed(rfb, c, r)) {
+				++c;
+				continue;
+			}
+
+			ca = c;
+			while (c < area->c1 && (all || rfb_tile_changed(rfb, c, r)))
+				++c;
+
+			/* Extend span from the previous tile row if possible */
+			for (i = 0; i < row_start; i++) {
+				if (spans[i].r1 == r && spans[i].c0 == ca &&
+				    spans[i].c1 == c)
+					break;
+			}
+
+			if (i < row_start) {
+				spans[i].r1 = r + 1;
+			} else {
+				spans[nspans].c0 = ca;
+				spans[nspans].c1 = c;
+				spans[nspans].r0 = r;
+				spans[nspans].r1 = r + 1;
+				++nspans;
+			}
+		}
+	}
+
+	return nspans;
+}
+
+static void rfb_span_to_rect(rfb_t *rfb, rfb_tile_span_t *span,
+    rfb_rectangle_t *rect)
+{
+	rect->x = span->c0 * RFB_HASH_TILE_SIZE;
+	rect->y = span->r0 * RFB_HASH_TILE_SIZE;
+	rect->width = min(span->c1 * RFB_HASH_TILE_SIZE, rfb->width) - rect->x;
+	rect->height = min(span->r1 * RFB_HASH_TILE_SIZE, rfb->height) -
+	    rect->y;
+
+	if (rfb->supports_zrle)
+		rect->enctype = RFB_ENCODING_ZRLE;
+	else if (rfb->supports_trle)
+		rect->enctype = RFB_ENCODING_TRLE;
+	else
+		rect->enctype = RFB_ENCODING_RAW;
+}
+
+/** Send framebuffer update.
+ *
+ * Only tiles whose content differs from what the client already has
+ * are sent. Vertically scrolled content is sent as CopyRect if the
+ * client supports it.
+ *
+ * @param rfb RFB server
+ * @param conn Connection
+ * @param incremental @c true if the client requested incremental update
+ * @return EOK on success or an error code
+ */
 static errno_t rfb_send_framebuffer_update(rfb_t *rfb, tcp_conn_t *conn,
     bool incremental)
 {
+	rfb_tile_span_t area;
+	rfb_tile_span_t *spans = NULL;
+	size_t nspans;
+	rfb_rectangle_t copy_rect;
+	rfb_copyrect_t copy_src;
+	bool copy = false;
+	bool all;
+	rfb_rectangle_t *rect;
+	rfb_rectangle_t srect;
+	size_t buf_size;
+	size_t scratch_size = 0;
+	uint8_t *scratch = NULL;
+	void *buf = NULL;
+	void *pos;
+	size_t size;
+	size_t y0, y1;
+	size_t i;
+	errno_t rc;
+
 	fibril_mutex_lock(&rfb->lock);
-	if (!incremental || !rfb->damage_valid) {
-		rfb->damage_rect.x = 0;
-		rfb->damage_rect.y = 0;
-		rfb->damage_rect.width = rfb->width;
-		rfb->damage_rect.height = rfb->height;
+
+	if (incremental && !rfb->damage_valid) {
+		/* Wait for something to change instead of resending */
+		(void) fibril_condvar_wait_timeout(&rfb->damage_cv, &rfb->lock,
+		    RFB_UPDATE_TIMEOUT);
 	}
 
-	/* We send only single raw rectangle right now */
-	size_t buf_size = sizeof(rfb_framebuffer_update_t) +
-	    sizeof(rfb_rectangle_t) * 1 +
-	    rfb_rect_encode_raw(rfb, &rfb->damage_rect, NULL);
+	all = !incremental || !rfb->line_hash_valid;
+	if (all) {
+		area.c0 = 0;
+		area.c1 = rfb->hash_cols;
+		area.r0 = 0;
+		area.r1 = (rfb->height + RFB_HASH_TILE_SIZE - 1) /
+		    RFB_HASH_TILE_SIZE;
+	} else if (rfb->damage_valid) {
+		area.c0 = rfb->damage_rect.x / RFB_HASH_TILE_SIZE;
+		area.c1 = (rfb->damage_rect.x + rfb->damage_rect.width +
+		    RFB_HASH_TILE_SIZE - 1) / RFB_HASH_TILE_SIZE;
+		area.r0 = rfb->damage_rect.y / RFB_HASH_TILE_SIZE;
+		area.r1 = (rfb->damage_rect.y + rfb->damage_rect.height +
+		    RFB_HASH_TILE_SIZE - 1) / RFB_HASH_TILE_SIZE;
+		area.c1 = min(area.c1, rfb->hash_cols);
+		area.r1 = min(area.r1, (size_t) ((rfb->height +
+		    RFB_HASH_TILE_SIZE - 1) / RFB_HASH_TILE_SIZE));
+	} else {
+		area.c0 = area.c1 = 0;
+		area.r0 = area.r1 = 0;
+	}
 
-	void *buf = malloc(buf_size);
+	rfb->damage_valid = false;
+
+	if (area.c1 <= area.c0 || area.r1 <= area.r0) {
+		area.c0 = area.c1 = 0;
+		area.r0 = area.r1 = 0;
+	}
+
+	y0 = area.r0 * RFB_HASH_TILE_SIZE;
+	y1 = min(area.r1 * RFB_HASH_TILE_SIZE, rfb->height);
+	rfb_hash_area(rfb, area.c0, area.c1, y0, y1);
+
+	if (!all && rfb->supports_copyrect && area.c1 > area.c0) {
+		copy = rfb_detect_copy(rfb, area.c0, area.c1, y0, y1,
+		    &copy_rect, &copy_src);
+	}
+
+	spans = malloc(max(1, (area.c1 - area.c0) * (area.r1 - area.r0)) *
+	    sizeof(rfb_tile_span_t));
+	if (spans == NULL) {
+		rc = ENOMEM;
+		goto error;
+	}
+
+	nspans = rfb_find_changed(rfb, all, &area, spans);
+	if (nspans + 1 > UINT16_MAX) {
+		/* Too many rectangles for one message, send the whole area */
+		spans[0] = area;
+		nspans = 1;
+	}
+
+	/* Determine buffer sizes */
+	buf_size = sizeof(rfb_framebuffer_update_t);
+	if (copy)
+		buf_size += sizeof(rfb_rectangle_t) + sizeof(rfb_copyrect_t);
+
+	for (i = 0; i < nspans; i++) {
+		rfb_span_to_rect(rfb, &spans[i], &srect);
+		buf_size += sizeof(rfb_rectangle_t);
+
+		switch (srect.enctype) {
+		case RFB_ENCODING_ZRLE:
+			buf_size += rfb_rect_zrle_bound(rfb, &srect);
+			scratch_size = max(scratch_size,
+			    rfb_rect_zrle_raw_bound(rfb, &srect));
+			break;
+		case RFB_ENCODING_TRLE:
+			buf_size += rfb_rect_encode_trle(rfb, &srect, NULL);
+			break;
+		default:
+			buf_size += rfb_rect_encode_raw(rfb, &srect, NULL);
+			break;
+		}
+	}
+
+	buf = malloc(buf_size);
 	if (buf == NULL) {
-		fibril_mutex_unlock(&rfb->lock);
-		return ENOMEM;
+		rc = ENOMEM;
+		goto error;
 	}
-	memset(buf, 0, buf_size);
 
-	void *pos = buf;
+	if (scratch_size > 0) {
+		scratch = malloc(scratch_size);
+		if (scratch == NULL) {
+			rc = ENOMEM;
+			goto error;
+		}
+	}
+
+	/* Encode */
+	pos = buf;
 	rfb_framebuffer_update_t *fbu = buf;
 	fbu->message_type = RFB_SMSG_FRAMEBUFFER_UPDATE;
-	fbu->rect_count = 1;
+	fbu->pad = 0;
+	fbu->rect_count = nspans + (copy ? 1 : 0);
 	rfb_framebuffer_update_to_be(fbu, fbu);
 	pos += sizeof(rfb_framebuffer_update_t);
 
-	rfb_rectangle_t *rect = pos;
-	pos += sizeof(rfb_rectangle_t);
+	if (copy) {
+		/* Must come first, the other rectangles assume it is done */
+		rect = pos;
+		*rect = copy_rect;
+		rfb_rectangle_to_be(rect, rect);
+		pos += sizeof(rfb_rectangle_t);
+
+		rfb_copyrect_to_be(&copy_src, pos);
+		pos += sizeof(rfb_copyrect_t);
+	}
 
-	*rect = rfb->damage_rect;
+	for (i = 0; i < nspans; i++) {
+		rect = pos;
+		pos += sizeof(rfb_rectangle_t);
+		rfb_span_to_rect(rfb, &spans[i], rect);
 
-	if (rfb->supports_trle) {
-		rect->enctype = RFB_ENCODING_TRLE;
-		pos += rfb_rect_encode_trle(rfb, rect, pos);
-	} else {
-		rect->enctype = RFB_ENCODING_RAW;
-		pos += rfb_rect_encode_raw(rfb, rect, pos);
+		switch (rect->enctype) {
+		case RFB_ENCODING_ZRLE:
+			rc = rfb_rect_encode_zrle(rfb, rect, scratch, pos, &size);
+			if (rc != EOK)
+				goto error;
+			pos += size;
+			break;
+		case RFB_ENCODING_TRLE:
+			pos += rfb_rect_encode_trle(rfb, rect, pos);
+			break;
+		default:
+			pos += rfb_rect_encode_raw(rfb, rect, pos);
+			break;
+		}
+
+		rfb_rectangle_to_be(rect, rect);
 	}
-	rfb_rectangle_to_be(rect, rect);
 
-	rfb->damage_valid = false;
+	buf_size = pos - buf;
+
+	/* Client now has the current contents of the area */
+	for (size_t y = y0; y < y1; y++) {
+		memcpy(rfb->line_hash + y * rfb->hash_cols + area.c0,
+		    rfb->cur_hash + y * rfb->hash_cols + area.c0,
+		    (area.c1 - area.c0) * sizeof(uint64_t));
+	}
+
+	rfb->line_hash_valid = true;
+
+	free(scratch);
+	scratch = NULL;
+	free(spans);
+	spans = NULL;
 
 	size_t send_palette_size = 0;
 	void *send_palette = NULL;
@@ -538,25 +1362,33 @@ static errno_t rfb_send_framebuffer_update(rfb_t *rfb, tcp_conn_t *conn,
 	if (!rfb->pixel_format.true_color) {
 		send_palette = rfb_send_palette_message(rfb, &send_palette_size);
 		if (send_palette == NULL) {
-			free(buf);
-			fibril_mutex_unlock(&rfb->lock);
-			return ENOMEM;
+			rc = ENOMEM;
+			goto error;
 		}
 	}
 
 	fibril_mutex_unlock(&rfb->lock);
 
 	if (!rfb->pixel_format.true_color) {
-		errno_t rc = tcp_conn_send(conn, send_palette, send_palette_size);
+		rc = tcp_conn_send(conn, send_palette, send_palette_size);
+		free(send_palette);
 		if (rc != EOK) {
 			free(buf);
 			return rc;
 		}
 	}
 
-	errno_t rc = tcp_conn_send(conn, buf, buf_size);
+	rc = tcp_conn_send(conn, buf, buf_size);
 	free(buf);
 
+	return rc;
+error:
+	/* Client's framebuffer is unknown, next update must resend it */
+	rfb->line_hash_valid = false;
+	fibril_mutex_unlock(&rfb->lock);
+	free(scratch);
+	free(spans);
+	free(buf);
 	return rc;
 }
 
@@ -729,6 +1561,14 @@ static void rfb_socket_connection(rfb_t *rfb, tcp_conn_t *conn)
 					log_msg(LOG_DEFAULT, LVL_DEBUG,
 					    "Client supports TRLE encoding");
 					rfb->supports_trle = true;
+				} else if (encoding == RFB_ENCODING_ZRLE) {
+					log_msg(LOG_DEFAULT, LVL_DEBUG,
+					    "Client supports ZRLE encoding");
+					rfb->supports_zrle = true;
+				} else if (encoding == RFB_ENCODING_COPYRECT) {
+					log_msg(LOG_DEFAULT, LVL_DEBUG,
+					    "Client supports CopyRect encoding");
+					rfb->supports_copyrect = true;
 				}
 			}
 			break;
@@ -828,5 +1668,14 @@ static void rfb_new_conn(tcp_listener_t *lst, tcp_conn_t *conn)
 	rbuf_out = 0;
 	rbuf_in = 0;
 
+	/* The new client knows nothing about the previous session */
+	fibril_mutex_lock(&rfb->lock);
+	rfb->supports_trle = false;
+	rfb->supports_zrle = false;
+	rfb->supports_copyrect = false;
+	rfb->line_hash_valid = false;
+	rfb->zrle_started = false;
+	fibril_mutex_unlock(&rfb->lock);
+
 	rfb_socket_connection(rfb, conn);
 }
@@ -29,6 +29,7 @@
 #ifndef RFB_H__
 #define RFB_H__
 
+#include <deflate.h>
 #include <inet/tcp.h>
 #include <io/pixelmap.h>
 #include <fibril_synch.h>
@@ -49,10 +50,25 @@
 #define RFB_SMSG_SERVER_CUT_TEXT 3
 
 #define RFB_ENCODING_RAW 0
+#define RFB_ENCODING_COPYRECT 1
 #define RFB_ENCODING_TRLE 15
+#define RFB_ENCODING_ZRLE 16
 
 #define RFB_TILE_ENCODING_RAW 0
 #define RFB_TILE_ENCODING_SOLID 1
+#define RFB_TILE_ENCODING_PLAIN_RLE 128
+
+/** ZRLE tile size */
+#define RFB_ZRLE_TILE_SIZE 64
+
+/** Size of tiles used for detecting changes */
+#define RFB_HASH_TILE_SIZE 16
+
+/** Minimum number of rows to send as CopyRect */
+#define RFB_COPYRECT_MIN_ROWS 16
+
+/** How long to wait for damage before answering incremental update */
+#define RFB_UPDATE_TIMEOUT 1000000
 
 typedef struct {
 	uint8_t bpp;
@@ -127,6 +143,11 @@ typedef struct {
 	uint8_t data[0];
 } __attribute__((packed)) rfb_rectangle_t;
 
+typedef struct {
+	uint16_t src_x;
+	uint16_t src_y;
+} __attribute__((packed)) rfb_copyrect_t;
+
 typedef struct {
 	uint8_t message_type;
 	uint8_t pad;
@@ -157,9 +178,24 @@ typedef struct {
 	rfb_rectangle_t damage_rect;
 	bool damage_valid;
 	fibril_mutex_t lock;
+	fibril_condvar_t damage_cv;
 	pixel_t *palette;
 	size_t palette_used;
 	bool supports_trle;
+	bool supports_zrle;
+	bool supports_copyrect;
+	/** Hashes of tile lines as last sent to the client */
+	uint64_t *line_hash;
+	/** Hashes of tile lines in the current framebuffer */
+	uint64_t *cur_hash;
+	/** Number of tile columns */
+	size_t hash_cols;
+	/** @c true iff @c line_hash matches client's framebuffer */
+	bool line_hash_valid;
+	/** Compressor of the ZRLE zlib stream */
+	deflate_t *zrle;
+	/** @c true iff zlib stream header has been sent */
+	bool zrle_started;
 } rfb_t;
 
 extern errno_t rfb_init(rfb_t *, uint16_t, uint16_t, const char *);
@@ -0,0 +1,431 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup dnsrsrv
+ * @{
+ */
+/**
+ * @file Resolver cache
+ *
+ * Answers are cached per (name, query type) for the time allowed by their
+ * TTL. Authoritative negative answers (the name or record type does not
+ * exist) are cached as well, for the time given by the SOA record in the
+ * authority section (RFC 2308). Failures to reach the name server are never
+ * cached.
+ *
+ * While a query is in flight, its cache entry is kept in the pending state.
+ * Lookups of the same name and type that arrive meanwhile wait for that query
+ * to finish instead of sending their own.
+ */
+
+#include <adt/hash.h>
+#include <adt/hash_table.h>
+#include <adt/list.h>
+#include <assert.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fibril_synch.h>
+#include <mem.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <str.h>
+#include <time.h>
+
+#include "cache.h"
+
+/** Upper bound on positive answer lifetime (seconds) */
+#define DNS_CACHE_TTL_MAX (24 * 60 * 60)
+
+/** Upper bound on negative answer lifetime (seconds, RFC 2308) */
+#define DNS_CACHE_NEG_TTL_MAX (3 * 60 * 60)
+
+typedef enum {
+	/** Query is in flight */
+	dce_pending,
+	/** Query finished */
+	dce_done
+} dns_cache_state_t;
+
+/** Cache entry */
+typedef struct {
+	/** Link to @c dns_cache_map */
+	ht_link_t map_link;
+	/** Link to @c dns_cache_lru or @c dns_cache_pending */
+	link_t lru_link;
+	/** Queried name */
+	char *name;
+	/** Query type */
+	dns_qtype_t qtype;
+	/** Entry state */
+	dns_cache_state_t state;
+	/** @c true iff the entry is in @c dns_cache_map */
+	bool in_map;
+	/** Result of the query */
+	errno_t rc;
+	/** Canonical name (if @c rc is EOK) */
+	char *cname;
+	/** Address (if @c rc is EOK) */
+	inet_addr_t addr;
+	/** Time when the entry expires */
+	struct timespec expires;
+	/** Signalled when the query finishes */
+	fibril_condvar_t done_cv;
+	/** Number of fibrils waiting for the query to finish */
+	unsigned waiters;
+} dns_cache_entry_t;
+
+/** Cache lookup key */
+typedef struct {
+	const char *name;
+	dns_qtype_t qtype;
+} dns_cache_key_t;
+
+static FIBRIL_MUTEX_INITIALIZE(dns_cache_lock);
+static hash_table_t dns_cache_map;
+/** Finished entries, least recently used first */
+static LIST_INITIALIZE(dns_cache_lru);
+/** Entries with a query in flight */
+static LIST_INITIALIZE(dns_cache_pending);
+static size_t dns_cache_count;
+static dns_cache_resolve_t dns_cache_resolve;
+static dnsr_cache_stats_t dns_cache_stats;
+
+/** Compute case-insensitive hash of name and query type. */
+static size_t dns_cache_key_hash_impl(const char *name, dns_qtype_t qtype)
+{
+	size_t hash = qtype;
+
+	while (*name != '\0') {
+		hash = hash_combine(hash, tolower((unsigned char) *name));
+		++name;
+	}
+
+	return hash;
+}
+
+static size_t dns_cache_key_hash(const void *key)
+{
+	const dns_cache_key_t *k = key;
+	return dns_cache_key_hash_impl(k->name, k->qtype);
+}
+
+static size_t dns_cache_hash(const ht_link_t *item)
+{
+	dns_cache_entry_t *entry = hash_table_get_inst(item, dns_cache_entry_t,
+	    map_link);
+	return dns_cache_key_hash_impl(entry->name, entry->qtype);
+}
+
+static bool dns_cache_key_equal(const void *key, const ht_link_t *item)
+{
+	const dns_cache_key_t *k = key;
+	dns_cache_entry_t *entry = hash_table_get_inst(item, dns_cache_entry_t,
+	    map_link);
+
+	return entry->qtype == k->qtype &&
+	    str_casecmp(entry->name, k->name) == 0;
+}
+
+static const hash_table_ops_t dns_cache_ops = {
+	.hash = dns_cache_hash,
+	.key_hash = dns_cache_key_hash,
+	.key_equal = dns_cache_key_equal,
+	.equal = NULL,
+	.remove_callback = NULL
+};
+
+static void dns_cache_entry_destroy(dns_cache_entry_t *entry)
+{
+	free(entry->name);
+	free(entry->cname);
+	free(entry);
+}
+
+/** Remove entry from the cache.
+ *
+ * The entry is freed, unless there are fibrils still waiting for it,
+ * in which case the last of them frees it.
+ */
+static void dns_cache_remove(dns_cache_entry_t *entry)
+{
+	assert(fibril_mutex_is_locked(&dns_cache_lock));
+	assert(entry->in_map);
+
+	hash_table_remove_item(&dns_cache_map, &entry->map_link);
+	entry->in_map = false;
+	--dns_cache_count;
+
+	if (link_used(&entry->lru_link))
+		list_remove(&entry->lru_link);
+
+	if (entry->waiters == 0 && entry->state == dce_done)
+		dns_cache_entry_destroy(entry);
+}
+
+/** Make room for one more entry.
+ *
+ * Evicts the least recently used finished entry if the cache is full.
+ * Pending entries are never evicted, so the cache may temporarily hold
+ * more entries than the limit if many queries are in flight.
+ */
+static void dns_cache_make_room(void)
+{
+	assert(fibril_mutex_is_locked(&dns_cache_lock));
+
+	while (dns_cache_count >= DNS_CACHE_MAX_ENTRIES &&
+	    !list_empty(&dns_cache_lru)) {
+		dns_cache_entry_t *entry = list_get_instance(
+		    list_first(&dns_cache_lru), dns_cache_entry_t, lru_link);
+		dns_cache_remove(entry);
+		++dns_cache_stats.evictions;
+	}
+}
+
+/** Copy query result from cache entry to caller's host information. */
+static errno_t dns_cache_entry_result(dns_cache_entry_t *entry,
+    dns_host_info_t *info)
+{
+	if (entry->rc != EOK)
+		return entry->rc;
+
+	info->cname = str_dup(entry->cname);
+	if (info->cname == NULL)
+		return ENOMEM;
+
+	info->addr = entry->addr;
+	return EOK;
+}
+
+/** Initialize resolver cache.
+ *
+ * @param resolve Function used to resolve names on cache miss
+ */
+void dns_cache_init(dns_cache_resolve_t resolve)
+{
+	bool ok;
+
+	ok = hash_table_create(&dns_cache_map, 0, 0, &dns_cache_ops);
+	assert(ok);
+	(void) ok;
+
+	dns_cache_resolve = resolve;
+	memset(&dns_cache_stats, 0, sizeof(dns_cache_stats));
+}
+
+/** Finalize resolver cache.
+ *
+ * There must be no queries in flight.
+ */
+void dns_cache_fini(void)
+{
+	assert(list_empty(&dns_cache_pending));
+	dns_cache_flush();
+	assert(dns_cache_count == 0);
+	hash_table_destroy(&dns_cache_map);
+}
+
+/** Resolve name, using cached answer if available.
+ *
+ * @param name Name to resolve
+ * @param qtype Query type (DTYPE_A or DTYPE_AAAA)
+ * @param info Host information to fill in
+ * @return EOK on success, ENOENT if the name does not exist (or has
+ *         no record of the requested type), ENOMEM if out of memory,
+ *         EIO or other error code if the name server could not be queried
+ */
+errno_t dns_cache_query(const char *name, dns_qtype_t qtype,
+    dns_host_info_t *info)
+{
+	dns_cache_key_t key;
+	dns_cache_entry_t *entry;
+	struct timespec now;
+	ht_link_t *link;
+	uint32_t ttl;
+	errno_t rc;
+
+	key.name = name;
+	key.qtype = qtype;
+
+	fibril_mutex_lock(&dns_cache_lock);
+
+	link = hash_table_find(&dns_cache_map, &key);
+	if (link != NULL) {
+		entry = hash_table_get_inst(link, dns_cache_entry_t, map_link);
+
+		if (entry->state == dce_pending) {
+			/* Join the query in flight */
+			++dns_cache_stats.joined;
+			++entry->waiters;
+			while (entry->state == dce_pending) {
+				fibril_condvar_wait(&entry->done_cv,
+				    &dns_cache_lock);
+			}
+
+			--entry->waiters;
+			rc = dns_cache_entry_result(entry, info);
+
+			/* Entry was not cached, last waiter frees it */
+			if (!entry->in_map && entry->waiters == 0)
+				dns_cache_entry_destroy(entry);
+
+			fibril_mutex_unlock(&dns_cache_lock);
+			return rc;
+		}
+
+		getuptime(&now);
+		if (ts_gt(&entry->expires, &now)) {
+			if (entry->rc == EOK)
+				++dns_cache_stats.hits;
+			else
+				++dns_cache_stats.neg_hits;
+
+			/* Move to the most recently used end */
+			list_remove(&entry->lru_link);
+			list_append(&entry->lru_link, &dns_cache_lru);
+
+			rc = dns_cache_entry_result(entry, info);
+			fibril_mutex_unlock(&dns_cache_lock);
+			return rc;
+		}
+
+		/* Expired */
+		dns_cache_remove(entry);
+	}
+
+	++dns_cache_stats.misses;
+
+	entry = calloc(1, sizeof(dns_cache_entry_t));
+	if (entry == NULL) {
+		fibril_mutex_unlock(&dns_cache_lock);
+		return ENOMEM;
+	}
+
+	entry->name = str_dup(name);
+	if (entry->name == NULL) {
+		free(entry);
+		fibril_mutex_unlock(&dns_cache_lock);
+		return ENOMEM;
+	}
+
+	entry->qtype = qtype;
+	entry->state = dce_pending;
+	link_initialize(&entry->lru_link);
+	fibril_condvar_initialize(&entry->done_cv);
+
+	dns_cache_make_room();
+	hash_table_insert(&dns_cache_map, &entry->map_link);
+	list_append(&entry->lru_link, &dns_cache_pending);
+	entry->in_map = true;
+	++dns_cache_count;
+
+	fibril_mutex_unlock(&dns_cache_lock);
+
+	ttl = 0;
+	rc = dns_cache_resolve(name, qtype, info, &ttl);
+
+	fibril_mutex_lock(&dns_cache_lock);
+
+	entry->rc = rc;
+	if (rc == EOK) {
+		entry->addr = info->addr;
+		entry->cname = str_dup(info->cname);
+		if (entry->cname == NULL)
+			entry->rc = ENOMEM;
+	}
+
+	entry->state = dce_done;
+	fibril_condvar_broadcast(&entry->done_cv);
+
+	if (rc == EOK && ttl > DNS_CACHE_TTL_MAX)
+		ttl = DNS_CACHE_TTL_MAX;
+	if (rc == ENOENT && ttl > DNS_CACHE_NEG_TTL_MAX)
+		ttl = DNS_CACHE_NEG_TTL_MAX;
+
+	if (entry->in_map)
+		list_remove(&entry->lru_link);
+
+	if (entry->in_map && (entry->rc == EOK || entry->rc == ENOENT) &&
+	    ttl > 0) {
+		getuptime(&entry->expires);
+		ts_add_diff(&entry->expires, SEC2NSEC(ttl));
+		list_append(&entry->lru_link, &dns_cache_lru);
+	} else if (entry->in_map) {
+		/*
+		 * Do not cache transient failures or answers with zero TTL.
+		 * Waiters that joined this query still get the result.
+		 */
+		dns_cache_remove(entry);
+	} else if (entry->waiters == 0) {
+		/* Entry was flushed while the query was in flight */
+		dns_cache_entry_destroy(entry);
+	}
+
+	fibril_mutex_unlock(&dns_cache_lock);
+	return rc;
+}
+
+/** Discard all entries from the cache.
+ *
+ * Queries in flight are allowed to finish and fibrils waiting for them
+ * still receive the answer, but the answer will not be cached.
+ */
+void dns_cache_flush(void)
+{
+	dns_cache_entry_t *entry;
+
+	fibril_mutex_lock(&dns_cache_lock);
+
+	while (!list_empty(&dns_cache_lru)) {
+		entry = list_get_instance(list_first(&dns_cache_lru),
+		    dns_cache_entry_t, lru_link);
+		dns_cache_remove(entry);
+	}
+
+	while (!list_empty(&dns_cache_pending)) {
+		entry = list_get_instance(list_first(&dns_cache_pending),
+		    dns_cache_entry_t, lru_link);
+		dns_cache_remove(entry);
+	}
+
+	fibril_mutex_unlock(&dns_cache_lock);
+}
+
+/** Get cache statistics.
+ *
+ * @param stats Place to store statistics
+ */
+void dns_cache_get_stats(dnsr_cache_stats_t *stats)
+{
+	fibril_mutex_lock(&dns_cache_lock);
+	*stats = dns_cache_stats;
+	stats->entries = dns_cache_count;
+	fibril_mutex_unlock(&dns_cache_lock);
+}
+
+/** @}
+ */
@@ -45,6 +45,7 @@
 #include <str.h>
 #include <task.h>
 
+#include "cache.h"
 #include "dns_msg.h"
 #include "dns_std.h"
 #include "query.h"
@@ -66,6 +67,8 @@ static errno_t dnsr_init(void)
 		return EIO;
 	}
 
+	dns_query_init();
+
 	async_set_fallback_port_handler(dnsr_client_conn, NULL);
 
 	rc = loc_server_register(NAME, &srv);
@@ -205,9 +208,48 @@ static void dnsr_set_srvaddr_srv(dnsr_client_t *client, ipc_call_t *icall)
 		return;
 	}
 
+	/* Answers from the previous server are no longer relevant */
+	dns_cache_flush();
+
+	async_answer_0(icall, rc);
+}
+
+static void dnsr_get_cache_stats_srv(dnsr_client_t *client, ipc_call_t *icall)
+{
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "dnsr_get_cache_stats_srv()");
+
+	ipc_call_t call;
+	size_t size;
+	if (!async_data_read_receive(&call, &size)) {
+		async_answer_0(&call, EREFUSED);
+		async_answer_0(icall, EREFUSED);
+		return;
+	}
+
+	if (size != sizeof(dnsr_cache_stats_t)) {
+		async_answer_0(&call, EINVAL);
+		async_answer_0(icall, EINVAL);
+		return;
+	}
+
+	dnsr_cache_stats_t stats;
+	dns_cache_get_stats(&stats);
+
+	errno_t rc = async_data_read_finalize(&call, &stats, size);
+	if (rc != EOK)
+		async_answer_0(&call, rc);
+
 	async_answer_0(icall, rc);
 }
 
+static void dnsr_cache_flush_srv(dnsr_client_t *client, ipc_call_t *icall)
+{
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "dnsr_cache_flush_srv()");
+
+	dns_cache_flush();
+	async_answer_0(icall, EOK);
+}
+
 static void dnsr_client_conn(ipc_call_t *icall, void *arg)
 {
 	dnsr_client_t client;
@@ -238,6 +280,12 @@ static void dnsr_client_conn(ipc_call_t *icall, void *arg)
 		case DNSR_SET_SRVADDR:
 			dnsr_set_srvaddr_srv(&client, &call);
 			break;
+		case DNSR_GET_CACHE_STATS:
+			dnsr_get_cache_stats_srv(&client, &call);
+			break;
+		case DNSR_CACHE_FLUSH:
+			dnsr_cache_flush_srv(&client, &call);
+			break;
 		default:
 			async_answer_0(&call, EINVAL);
 		}
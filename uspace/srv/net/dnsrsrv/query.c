@@ -35,19 +35,75 @@
 
 #include <errno.h>
 #include <io/log.h>
+#include <macros.h>
 #include <mem.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <str.h>
+#include "cache.h"
 #include "dns_msg.h"
 #include "dns_std.h"
 #include "dns_type.h"
 #include "query.h"
 #include "transport.h"
 
+/** Negative answer lifetime if the server did not send SOA (seconds) */
+#define DNS_NEG_TTL_DEFAULT 10
+
 static uint16_t msg_id;
 
+/** Determine how long a negative answer can be cached.
+ *
+ * Per RFC 2308 this is the minimum of the SOA record TTL and the SOA
+ * MINIMUM field. The SOA record is found in the authority section.
+ *
+ * @param amsg Answer message
+ * @return Negative answer TTL in seconds
+ */
+static uint32_t dns_neg_ttl(dns_message_t *amsg)
+{
+	list_foreach(amsg->authority, msg, dns_rr_t, rr) {
+		if (rr->rtype != DTYPE_SOA || rr->rclass != DC_IN)
+			continue;
+
+		/* Skip MNAME and RNAME */
+		char *sname;
+		size_t eoff;
+		errno_t rc = dns_name_decode(&amsg->pdu, rr->roff, &sname,
+		    &eoff);
+		if (rc != EOK)
+			break;
+		free(sname);
+
+		rc = dns_name_decode(&amsg->pdu, eoff, &sname, &eoff);
+		if (rc != EOK)
+			break;
+		free(sname);
+
+		/* SERIAL, REFRESH, RETRY, EXPIRE, MINIMUM */
+		if (eoff + 5 * sizeof(uint32_t) > rr->roff + rr->rdata_size)
+			break;
+
+		uint32_t minimum = dns_uint32_t_decode(amsg->pdu.data + eoff +
+		    4 * sizeof(uint32_t), sizeof(uint32_t));
+
+		return min(rr->ttl, minimum);
+	}
+
+	return DNS_NEG_TTL_DEFAULT;
+}
+
+/** Query the name server.
+ *
+ * @param name Name to resolve
+ * @param qtype Query type
+ * @param info Host information to fill in
+ * @param rttl Place to store TTL of the answer (seconds)
+ * @return EOK on success, ENOENT if the name or record does not exist,
+ *         other error code on failure
+ */
 static errno_t dns_name_query(const char *name, dns_qtype_t qtype,
-    dns_host_info_t *info)
+    dns_host_info_t *info, uint32_t *rttl)
 {
 	/* Start with the caller-provided name */
 	char *sname = str_dup(name);
@@ -98,6 +154,18 @@ static errno_t dns_name_query(const char *name, dns_qtype_t qtype,
 		return rc;
 	}
 
+	if (amsg->rcode != RC_OK && amsg->rcode != RC_NAME_ERR) {
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "server error %u",
+		    amsg->rcode);
+		dns_message_destroy(msg);
+		dns_message_destroy(amsg);
+		free(sname);
+		return EIO;
+	}
+
+	/* The answer is valid for the shortest TTL along the CNAME chain */
+	uint32_t ttl = UINT32_MAX;
+
 	list_foreach(amsg->answer, msg, dns_rr_t, rr) {
 		log_msg(LOG_DEFAULT, LVL_DEBUG, " - '%s' %u/%u, dsize %zu",
 		    rr->name, rr->rtype, rr->rclass, rr->rdata_size);
@@ -129,6 +197,7 @@ static errno_t dns_name_query(const char *name, dns_qtype_t qtype,
 			/* Continue looking for the more canonical name */
 			free(sname);
 			sname = cname;
+			ttl = min(ttl, rr->ttl);
 		}
 
 		if ((qtype == DTYPE_A) && (rr->rtype == DTYPE_A) &&
@@ -146,6 +215,7 @@ static errno_t dns_name_query(const char *name, dns_qtype_t qtype,
 
 			inet_addr_set(dns_uint32_t_decode(rr->rdata, rr->rdata_size),
 			    &info->addr);
+			*rttl = min(ttl, rr->ttl);
 
 			dns_message_destroy(msg);
 			dns_message_destroy(amsg);
@@ -171,6 +241,7 @@ static errno_t dns_name_query(const char *name, dns_qtype_t qtype,
 			dns_addr128_t_decode(rr->rdata, rr->rdata_size, addr);
 
 			inet_addr_set6(addr, &info->addr);
+			*rttl = min(ttl, rr->ttl);
 
 			dns_message_destroy(msg);
 			dns_message_destroy(amsg);
@@ -182,11 +253,19 @@ static errno_t dns_name_query(const char *name, dns_qtype_t qtype,
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "'%s' not resolved, fail", sname);
 
+	*rttl = dns_neg_ttl(amsg);
+
 	dns_message_destroy(msg);
 	dns_message_destroy(amsg);
 	free(sname);
 
-	return EIO;
+	return ENOENT;
+}
+
+/** Initialize name resolution. */
+void dns_query_init(void)
+{
+	dns_cache_init(dns_name_query);
 }
 
 errno_t dns_name2host(const char *name, dns_host_info_t **rinfo, ip_ver_t ver)
@@ -199,22 +278,26 @@ errno_t dns_name2host(const char *name, dns_host_info_t **rinfo, ip_ver_t ver)
 
 	switch (ver) {
 	case ip_any:
-		rc = dns_name_query(name, DTYPE_AAAA, info);
+		rc = dns_cache_query(name, DTYPE_AAAA, info);
 
 		if (rc != EOK)
-			rc = dns_name_query(name, DTYPE_A, info);
+			rc = dns_cache_query(name, DTYPE_A, info);
 
 		break;
 	case ip_v4:
-		rc = dns_name_query(name, DTYPE_A, info);
+		rc = dns_cache_query(name, DTYPE_A, info);
 		break;
 	case ip_v6:
-		rc = dns_name_query(name, DTYPE_AAAA, info);
+		rc = dns_cache_query(name, DTYPE_AAAA, info);
 		break;
 	default:
 		rc = EINVAL;
 	}
 
+	/* Clients have always been told EIO for unresolvable names */
+	if (rc == ENOENT)
+		rc = EIO;
+
 	if (rc == EOK)
 		*rinfo = info;
 	else
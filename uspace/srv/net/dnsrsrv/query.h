@@ -39,6 +39,7 @@
 #include <inet/addr.h>
 #include "dns_type.h"
 
+extern void dns_query_init(void);
 extern errno_t dns_name2host(const char *, dns_host_info_t **, ip_ver_t);
 extern void dns_hostinfo_destroy(dns_host_info_t *);
 
@@ -0,0 +1,293 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <fibril.h>
+#include <fibril_synch.h>
+#include <inet/addr.h>
+#include <pcut/pcut.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <str.h>
+
+#include "../cache.h"
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(cache);
+
+/** Number of times the test resolver was called */
+static unsigned resolve_calls;
+/** Result the test resolver returns */
+static errno_t resolve_rc;
+/** TTL the test resolver returns */
+static uint32_t resolve_ttl;
+/** If @c true, the test resolver blocks until @c resolve_block is cleared */
+static bool resolve_block;
+static FIBRIL_MUTEX_INITIALIZE(resolve_lock);
+static FIBRIL_CONDVAR_INITIALIZE(resolve_cv);
+
+static errno_t test_resolve(const char *name, dns_qtype_t qtype,
+    dns_host_info_t *info, uint32_t *rttl)
+{
+	++resolve_calls;
+
+	fibril_mutex_lock(&resolve_lock);
+	while (resolve_block)
+		fibril_condvar_wait(&resolve_cv, &resolve_lock);
+	fibril_mutex_unlock(&resolve_lock);
+
+	*rttl = resolve_ttl;
+	if (resolve_rc != EOK)
+		return resolve_rc;
+
+	info->cname = str_dup(name);
+	if (info->cname == NULL)
+		return ENOMEM;
+
+	inet_addr(&info->addr, 192, 168, 0, 1);
+	return EOK;
+}
+
+static void test_setup(errno_t rc, uint32_t ttl)
+{
+	resolve_calls = 0;
+	resolve_rc = rc;
+	resolve_ttl = ttl;
+	resolve_block = false;
+	dns_cache_init(test_resolve);
+}
+
+static errno_t test_query(const char *name, dns_qtype_t qtype)
+{
+	dns_host_info_t info;
+	errno_t rc;
+
+	info.cname = NULL;
+	rc = dns_cache_query(name, qtype, &info);
+	free(info.cname);
+	return rc;
+}
+
+/** Repeated lookup is answered from the cache */
+PCUT_TEST(positive_hit)
+{
+	dns_host_info_t info;
+	dnsr_cache_stats_t stats;
+	inet_addr_t expected;
+	errno_t rc;
+
+	test_setup(EOK, 60);
+	inet_addr(&expected, 192, 168, 0, 1);
+
+	rc = dns_cache_query("example.org", DTYPE_A, &info);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	free(info.cname);
+
+	rc = dns_cache_query("example.org", DTYPE_A, &info);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_STR_EQUALS("example.org", info.cname);
+	PCUT_ASSERT_TRUE(inet_addr_compare(&expected, &info.addr));
+	free(info.cname);
+
+	PCUT_ASSERT_INT_EQUALS(1, resolve_calls);
+
+	dns_cache_get_stats(&stats);
+	PCUT_ASSERT_INT_EQUALS(1, stats.entries);
+	PCUT_ASSERT_INT_EQUALS(1, stats.hits);
+	PCUT_ASSERT_INT_EQUALS(1, stats.misses);
+
+	dns_cache_fini();
+}
+
+/** Names are compared case-insensitively, query types are distinguished */
+PCUT_TEST(key)
+{
+	test_setup(EOK, 60);
+
+	PCUT_ASSERT_ERRNO_VAL(EOK, test_query("example.org", DTYPE_A));
+	PCUT_ASSERT_ERRNO_VAL(EOK, test_query("Example.ORG", DTYPE_A));
+	PCUT_ASSERT_INT_EQUALS(1, resolve_calls);
+
+	PCUT_ASSERT_ERRNO_VAL(EOK, test_query("example.org", DTYPE_AAAA));
+	PCUT_ASSERT_INT_EQUALS(2, resolve_calls);
+
+	dns_cache_fini();
+}
+
+/** Non-existence of a name is cached */
+PCUT_TEST(negative_hit)
+{
+	dnsr_cache_stats_t stats;
+
+	test_setup(ENOENT, 60);
+
+	PCUT_ASSERT_ERRNO_VAL(ENOENT, test_query("nx.example.org", DTYPE_A));
+	PCUT_ASSERT_ERRNO_VAL(ENOENT, test_query("nx.example.org", DTYPE_A));
+	PCUT_ASSERT_INT_EQUALS(1, resolve_calls);
+
+	dns_cache_get_stats(&stats);
+	PCUT_ASSERT_INT_EQUALS(1, stats.neg_hits);
+
+	dns_cache_fini();
+}
+
+/** Failures to query the server are not cached */
+PCUT_TEST(failure_not_cached)
+{
+	dnsr_cache_stats_t stats;
+
+	test_setup(EIO, 60);
+
+	PCUT_ASSERT_ERRNO_VAL(EIO, test_query("example.org", DTYPE_A));
+	PCUT_ASSERT_ERRNO_VAL(EIO, test_query("example.org", DTYPE_A));
+	PCUT_ASSERT_INT_EQUALS(2, resolve_calls);
+
+	dns_cache_get_stats(&stats);
+	PCUT_ASSERT_INT_EQUALS(0, stats.entries);
+
+	dns_cache_fini();
+}
+
+/** Answers with zero TTL are not cached */
+PCUT_TEST(zero_ttl)
+{
+	test_setup(EOK, 0);
+
+	PCUT_ASSERT_ERRNO_VAL(EOK, test_query("example.org", DTYPE_A));
+	PCUT_ASSERT_ERRNO_VAL(EOK, test_query("example.org", DTYPE_A));
+	PCUT_ASSERT_INT_EQUALS(2, resolve_calls);
+
+	dns_cache_fini();
+}
+
+/** Flushing the cache forces a new query */
+PCUT_TEST(flush)
+{
+	dnsr_cache_stats_t stats;
+
+	test_setup(EOK, 60);
+
+	PCUT_ASSERT_ERRNO_VAL(EOK, test_query("example.org", DTYPE_A));
+	dns_cache_flush();
+
+	dns_cache_get_stats(&stats);
+	PCUT_ASSERT_INT_EQUALS(0, stats.entries);
+
+	PCUT_ASSERT_ERRNO_VAL(EOK, test_query("example.org", DTYPE_A));
+	PCUT_ASSERT_INT_EQUALS(2, resolve_calls);
+
+	dns_cache_fini();
+}
+
+/** Least recently used entry is evicted when the cache is full */
+PCUT_TEST(evict)
+{
+	dnsr_cache_stats_t stats;
+	char name[32];
+	unsigned i;
+
+	test_setup(EOK, 60);
+
+	for (i = 0; i < DNS_CACHE_MAX_ENTRIES; i++) {
+		snprintf(name, sizeof(name), "host%u.example.org", i);
+		PCUT_ASSERT_ERRNO_VAL(EOK, test_query(name, DTYPE_A));
+	}
+
+	/* Touch the oldest entry so that host1 becomes the LRU one */
+	PCUT_ASSERT_ERRNO_VAL(EOK, test_query("host0.example.org", DTYPE_A));
+	PCUT_ASSERT_ERRNO_VAL(EOK, test_query("new.example.org", DTYPE_A));
+
+	dns_cache_get_stats(&stats);
+	PCUT_ASSERT_INT_EQUALS(DNS_CACHE_MAX_ENTRIES, stats.entries);
+	PCUT_ASSERT_INT_EQUALS(1, stats.evictions);
+
+	resolve_calls = 0;
+	PCUT_ASSERT_ERRNO_VAL(EOK, test_query("host0.example.org", DTYPE_A));
+	PCUT_ASSERT_INT_EQUALS(0, resolve_calls);
+	PCUT_ASSERT_ERRNO_VAL(EOK, test_query("host1.example.org", DTYPE_A));
+	PCUT_ASSERT_INT_EQUALS(1, resolve_calls);
+
+	dns_cache_fini();
+}
+
+typedef struct {
+	errno_t rc;
+	bool done;
+} test_lookup_t;
+
+static errno_t test_lookup_fibril(void *arg)
+{
+	test_lookup_t *lookup = (test_lookup_t *) arg;
+
+	lookup->rc = test_query("example.org", DTYPE_A);
+	lookup->done = true;
+	return EOK;
+}
+
+/** Concurrent lookups of the same name share one query */
+PCUT_TEST(dedup)
+{
+	test_lookup_t lookup[2];
+	dnsr_cache_stats_t stats;
+	fid_t fid;
+	unsigned i;
+
+	test_setup(EOK, 60);
+	resolve_block = true;
+
+	for (i = 0; i < 2; i++) {
+		lookup[i].rc = EINVAL;
+		lookup[i].done = false;
+
+		fid = fibril_create(test_lookup_fibril, &lookup[i]);
+		PCUT_ASSERT_FALSE(fid == 0);
+		fibril_start(fid);
+		fibril_yield();
+	}
+
+	fibril_mutex_lock(&resolve_lock);
+	resolve_block = false;
+	fibril_condvar_broadcast(&resolve_cv);
+	fibril_mutex_unlock(&resolve_lock);
+
+	while (!lookup[0].done || !lookup[1].done)
+		fibril_yield();
+
+	PCUT_ASSERT_ERRNO_VAL(EOK, lookup[0].rc);
+	PCUT_ASSERT_ERRNO_VAL(EOK, lookup[1].rc);
+	PCUT_ASSERT_INT_EQUALS(1, resolve_calls);
+
+	dns_cache_get_stats(&stats);
+	PCUT_ASSERT_INT_EQUALS(1, stats.misses);
+	PCUT_ASSERT_INT_EQUALS(1, stats.joined);
+
+	dns_cache_fini();
+}
+
+PCUT_EXPORT(cache);
@@ -103,21 +103,28 @@ errno_t arp_translate(ethip_nic_t *nic, addr32_t src_addr, addr32_t ip_addr,
 		return EOK;
 	}
 
-	errno_t rc = atrans_lookup(ip_addr, mac_addr);
-	if (rc == EOK)
-		return EOK;
+	bool probe;
+	errno_t rc = atrans_query(ip_addr, mac_addr, &probe);
+	if (rc != EOK && rc != EAGAIN)
+		return rc;
 
-	arp_eth_packet_t packet;
+	if (probe) {
+		arp_eth_packet_t packet;
 
-	packet.opcode = aop_request;
-	packet.sender_hw_addr = nic->mac_addr;
-	packet.sender_proto_addr = src_addr;
-	packet.target_hw_addr = eth_addr_broadcast;
-	packet.target_proto_addr = ip_addr;
+		packet.opcode = aop_request;
+		packet.sender_hw_addr = nic->mac_addr;
+		packet.sender_proto_addr = src_addr;
+		packet.target_hw_addr = eth_addr_broadcast;
+		packet.target_proto_addr = ip_addr;
 
-	rc = arp_send_packet(nic, &packet);
-	if (rc != EOK)
-		return rc;
+		errno_t prc = arp_send_packet(nic, &packet);
+		if (prc != EOK && rc != EOK)
+			return prc;
+	}
+
+	/* Stale translation is used while it is being re-probed */
+	if (rc == EOK)
+		return EOK;
 
 	return atrans_lookup_timeout(ip_addr, ARP_REQUEST_TIMEOUT, mac_addr);
 }
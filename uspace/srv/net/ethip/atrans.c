@@ -34,53 +34,200 @@
  * @brief
  */
 
+#include <adt/hash.h>
+#include <adt/hash_table.h>
 #include <adt/list.h>
+#include <assert.h>
 #include <errno.h>
 #include <fibril_synch.h>
 #include <inet/eth_addr.h>
 #include <inet/iplink_srv.h>
 #include <stdlib.h>
+#include <time.h>
 
 #include "atrans.h"
 #include "ethip.h"
 
-/** Address translation list (of ethip_atrans_t) */
+/** Time after which a confirmed entry becomes stale (seconds) */
+#define ATRANS_REACHABLE_TIME 30
+/** Time after which an unconfirmed stale entry is discarded (seconds) */
+#define ATRANS_STALE_TIME 600
+/** Minimum interval between re-probes of a stale entry (seconds) */
+#define ATRANS_PROBE_INTERVAL 5
+/** Time for which a failed resolution is remembered (seconds) */
+#define ATRANS_FAILED_TIME 20
+/** Maximum number of entries in the table */
+#define ATRANS_MAX_ENTRIES 1024
+/** Maximum number of packets waiting for resolution of one address */
+#define ATRANS_MAX_PENDING 16
+
+/** Address translation table (of ethip_atrans_t) */
 static FIBRIL_MUTEX_INITIALIZE(atrans_list_lock);
-static LIST_INITIALIZE(atrans_list);
-static FIBRIL_CONDVAR_INITIALIZE(atrans_cv);
+static hash_table_t atrans_table;
+/** Entries in least-recently-updated order */
+static LIST_INITIALIZE(atrans_lru);
+
+static size_t atrans_key_hash(const void *key)
+{
+	const addr32_t *ip_addr = (const addr32_t *) key;
+	return hash_mix32(*ip_addr);
+}
+
+static size_t atrans_hash(const ht_link_t *item)
+{
+	ethip_atrans_t *atrans = hash_table_get_inst(item, ethip_atrans_t,
+	    atrans_link);
+	return hash_mix32(atrans->ip_addr);
+}
+
+static bool atrans_key_equal(const void *key, const ht_link_t *item)
+{
+	const addr32_t *ip_addr = (const addr32_t *) key;
+	ethip_atrans_t *atrans = hash_table_get_inst(item, ethip_atrans_t,
+	    atrans_link);
+	return atrans->ip_addr == *ip_addr;
+}
+
+static bool atrans_equal(const ht_link_t *item1, const ht_link_t *item2)
+{
+	ethip_atrans_t *a1 = hash_table_get_inst(item1, ethip_atrans_t,
+	    atrans_link);
+	ethip_atrans_t *a2 = hash_table_get_inst(item2, ethip_atrans_t,
+	    atrans_link);
+	return a1->ip_addr == a2->ip_addr;
+}
+
+static const hash_table_ops_t atrans_table_ops = {
+	.hash = atrans_hash,
+	.key_hash = atrans_key_hash,
+	.key_equal = atrans_key_equal,
+	.equal = atrans_equal,
+	.remove_callback = NULL
+};
+
+/** Initialize address translation table.
+ *
+ * @return EOK on success, ENOMEM if out of memory
+ */
+errno_t atrans_init(void)
+{
+	if (!hash_table_create(&atrans_table, 0, 0, &atrans_table_ops))
+		return ENOMEM;
+
+	return EOK;
+}
 
 static ethip_atrans_t *atrans_find(addr32_t ip_addr)
 {
-	list_foreach(atrans_list, atrans_list, ethip_atrans_t, atrans) {
-		if (atrans->ip_addr == ip_addr)
-			return atrans;
-	}
+	ht_link_t *link;
 
-	return NULL;
+	link = hash_table_find(&atrans_table, &ip_addr);
+	if (link == NULL)
+		return NULL;
+
+	return hash_table_get_inst(link, ethip_atrans_t, atrans_link);
 }
 
-errno_t atrans_add(addr32_t ip_addr, eth_addr_t *mac_addr)
+/** Set entry state and expiration time.
+ *
+ * @param atrans Entry
+ * @param state New state
+ * @param now Current time
+ * @param secs Seconds until the state expires
+ */
+static void atrans_set_state(ethip_atrans_t *atrans,
+    ethip_atrans_state_t state, struct timespec *now, unsigned secs)
+{
+	atrans->state = state;
+	atrans->expires = *now;
+	ts_add_diff(&atrans->expires, SEC2NSEC(secs));
+
+	/* Move to the most recently updated end */
+	list_remove(&atrans->atrans_lru);
+	list_append(&atrans->atrans_lru, &atrans_lru);
+}
+
+/** Remove entry from the hash table and the LRU list. */
+static void atrans_unlink(ethip_atrans_t *atrans)
+{
+	hash_table_remove_item(&atrans_table, &atrans->atrans_link);
+	list_remove(&atrans->atrans_lru);
+}
+
+static void atrans_destroy(ethip_atrans_t *atrans)
+{
+	assert(atrans->waiters == 0);
+	atrans_unlink(atrans);
+	free(atrans);
+}
+
+/** Create new entry, evicting the oldest idle entry if the table is full.
+ *
+ * @param ip_addr IP address
+ * @return New entry or @c NULL if out of memory or no entry can be evicted
+ */
+static ethip_atrans_t *atrans_create(addr32_t ip_addr)
 {
 	ethip_atrans_t *atrans;
-	ethip_atrans_t *prev;
+
+	if (hash_table_size(&atrans_table) >= ATRANS_MAX_ENTRIES) {
+		list_foreach(atrans_lru, atrans_lru, ethip_atrans_t, old) {
+			if (old->waiters == 0) {
+				atrans_destroy(old);
+				break;
+			}
+		}
+
+		if (hash_table_size(&atrans_table) >= ATRANS_MAX_ENTRIES)
+			return NULL;
+	}
 
 	atrans = calloc(1, sizeof(ethip_atrans_t));
 	if (atrans == NULL)
-		return ENOMEM;
+		return NULL;
 
 	atrans->ip_addr = ip_addr;
-	atrans->mac_addr = *mac_addr;
+	atrans->state = atrans_incomplete;
+	fibril_condvar_initialize(&atrans->cv);
+	link_initialize(&atrans->atrans_lru);
+	list_append(&atrans->atrans_lru, &atrans_lru);
+	hash_table_insert(&atrans_table, &atrans->atrans_link);
+
+	return atrans;
+}
+
+/** Add confirmed address translation.
+ *
+ * Creates or updates the entry for @a ip_addr and wakes up any fibrils
+ * waiting for its resolution.
+ *
+ * @param ip_addr IP address
+ * @param mac_addr MAC address
+ * @return EOK on success, ENOMEM if out of memory
+ */
+errno_t atrans_add(addr32_t ip_addr, eth_addr_t *mac_addr)
+{
+	ethip_atrans_t *atrans;
+	struct timespec now;
+
+	getuptime(&now);
 
 	fibril_mutex_lock(&atrans_list_lock);
-	prev = atrans_find(ip_addr);
-	if (prev != NULL) {
-		list_remove(&prev->atrans_list);
-		free(prev);
+	atrans = atrans_find(ip_addr);
+	if (atrans == NULL) {
+		atrans = atrans_create(ip_addr);
+		if (atrans == NULL) {
+			fibril_mutex_unlock(&atrans_list_lock);
+			return ENOMEM;
+		}
 	}
 
-	list_append(&atrans->atrans_list, &atrans_list);
+	atrans->mac_addr = *mac_addr;
+	atrans->confirmed = now;
+	atrans_set_state(atrans, atrans_reachable, &now,
+	    ATRANS_REACHABLE_TIME);
+	fibril_condvar_broadcast(&atrans->cv);
 	fibril_mutex_unlock(&atrans_list_lock);
-	fibril_condvar_broadcast(&atrans_cv);
 
 	return EOK;
 }
@@ -96,10 +243,20 @@ errno_t atrans_remove(addr32_t ip_addr)
 		return ENOENT;
 	}
 
-	list_remove(&atrans->atrans_list);
-	fibril_mutex_unlock(&atrans_list_lock);
-	free(atrans);
+	if (atrans->waiters > 0) {
+		/*
+		 * Fail pending resolution. The entry can no longer be
+		 * found, the last waiter frees it.
+		 */
+		atrans_unlink(atrans);
+		atrans->removed = true;
+		atrans->state = atrans_failed;
+		fibril_condvar_broadcast(&atrans->cv);
+	} else {
+		atrans_destroy(atrans);
+	}
 
+	fibril_mutex_unlock(&atrans_list_lock);
 	return EOK;
 }
 
@@ -109,6 +266,9 @@ static errno_t atrans_lookup_locked(addr32_t ip_addr, eth_addr_t *mac_addr)
 	if (atrans == NULL)
 		return ENOENT;
 
+	if (atrans->state != atrans_reachable && atrans->state != atrans_stale)
+		return ENOENT;
+
 	*mac_addr = atrans->mac_addr;
 	return EOK;
 }
@@ -124,41 +284,176 @@ errno_t atrans_lookup(addr32_t ip_addr, eth_addr_t *mac_addr)
 	return rc;
 }
 
-static void atrans_lookup_timeout_handler(void *arg)
+/** Query address translation for transmitting a packet.
+ *
+ * Ages the entry and decides whether an ARP request should be sent.
+ * Concurrent queries for an unresolved address result in a single
+ * request. Addresses that recently failed to resolve are rejected
+ * without sending a request.
+ *
+ * @param ip_addr IP address
+ * @param mac_addr Place to store MAC address
+ * @param rprobe Place to store @c true if the caller should send
+ *               an ARP request for @a ip_addr
+ * @return EOK if @a mac_addr is valid (the entry may still need to be
+ *         re-probed), EAGAIN if resolution is in progress and the caller
+ *         should wait using atrans_lookup_timeout(), ENOENT if resolution
+ *         recently failed, ENOMEM if out of memory
+ */
+errno_t atrans_query(addr32_t ip_addr, eth_addr_t *mac_addr, bool *rprobe)
 {
-	bool *timedout = (bool *)arg;
+	ethip_atrans_t *atrans;
+	struct timespec now;
+	struct timespec stale_end;
+	errno_t rc;
+
+	getuptime(&now);
+	*rprobe = false;
 
 	fibril_mutex_lock(&atrans_list_lock);
-	*timedout = true;
+	atrans = atrans_find(ip_addr);
+	if (atrans == NULL) {
+		atrans = atrans_create(ip_addr);
+		if (atrans == NULL) {
+			fibril_mutex_unlock(&atrans_list_lock);
+			return ENOMEM;
+		}
+
+		atrans_set_state(atrans, atrans_incomplete, &now, 0);
+		*rprobe = true;
+		fibril_mutex_unlock(&atrans_list_lock);
+		return EAGAIN;
+	}
+
+	switch (atrans->state) {
+	case atrans_incomplete:
+		rc = EAGAIN;
+		break;
+	case atrans_reachable:
+		if (ts_gt(&now, &atrans->expires)) {
+			/* Keep using the entry but confirm it */
+			atrans_set_state(atrans, atrans_stale, &now,
+			    ATRANS_PROBE_INTERVAL);
+			*rprobe = true;
+		}
+
+		*mac_addr = atrans->mac_addr;
+		rc = EOK;
+		break;
+	case atrans_stale:
+		/*
+		 * Expiration time of stale entry is the next probe time.
+		 * Stale entry is discarded ATRANS_STALE_TIME after
+		 * it was last confirmed.
+		 */
+		stale_end = atrans->confirmed;
+		ts_add_diff(&stale_end, SEC2NSEC(ATRANS_REACHABLE_TIME +
+		    ATRANS_STALE_TIME));
+		if (ts_gt(&now, &stale_end)) {
+			atrans_set_state(atrans, atrans_incomplete, &now, 0);
+			*rprobe = true;
+			rc = EAGAIN;
+			break;
+		}
+
+		if (ts_gt(&now, &atrans->expires)) {
+			atrans_set_state(atrans, atrans_stale, &now,
+			    ATRANS_PROBE_INTERVAL);
+			*rprobe = true;
+		}
+
+		*mac_addr = atrans->mac_addr;
+		rc = EOK;
+		break;
+	case atrans_failed:
+		if (ts_gt(&now, &atrans->expires)) {
+			/* Negative entry expired, try again */
+			atrans_set_state(atrans, atrans_incomplete, &now, 0);
+			*rprobe = true;
+			rc = EAGAIN;
+		} else {
+			rc = ENOENT;
+		}
+		break;
+	default:
+		assert(false);
+		rc = EINVAL;
+		break;
+	}
+
 	fibril_mutex_unlock(&atrans_list_lock);
-	fibril_condvar_broadcast(&atrans_cv);
+	return rc;
 }
 
+/** Wait for address resolution to complete.
+ *
+ * If resolution does not complete in time, the address is remembered
+ * as unresolvable for a while so that further packets to it fail fast.
+ * At most ATRANS_MAX_PENDING fibrils may wait for one address.
+ *
+ * @param ip_addr IP address
+ * @param timeout Timeout in microseconds
+ * @param mac_addr Place to store MAC address
+ * @return EOK on success, ENOENT if resolution failed or timed out,
+ *         ELIMIT if too many packets are already waiting
+ */
 errno_t atrans_lookup_timeout(addr32_t ip_addr, usec_t timeout,
     eth_addr_t *mac_addr)
 {
-	fibril_timer_t *t;
-	bool timedout;
+	ethip_atrans_t *atrans;
+	struct timespec now;
+	struct timespec deadline;
+	nsec_t remain;
 	errno_t rc;
 
-	t = fibril_timer_create(NULL);
-	if (t == NULL)
-		return ENOMEM;
-
-	timedout = false;
-	fibril_timer_set(t, timeout, atrans_lookup_timeout_handler, &timedout);
+	getuptime(&deadline);
+	ts_add_diff(&deadline, USEC2NSEC(timeout));
 
 	fibril_mutex_lock(&atrans_list_lock);
 
-	while ((rc = atrans_lookup_locked(ip_addr, mac_addr)) == ENOENT &&
-	    !timedout) {
-		fibril_condvar_wait(&atrans_cv, &atrans_list_lock);
+	atrans = atrans_find(ip_addr);
+	if (atrans == NULL) {
+		fibril_mutex_unlock(&atrans_list_lock);
+		return ENOENT;
+	}
+
+	if (atrans->state == atrans_incomplete &&
+	    atrans->waiters >= ATRANS_MAX_PENDING) {
+		fibril_mutex_unlock(&atrans_list_lock);
+		return ELIMIT;
 	}
 
-	fibril_mutex_unlock(&atrans_list_lock);
-	(void) fibril_timer_clear(t);
-	fibril_timer_destroy(t);
+	++atrans->waiters;
+
+	while (atrans->state == atrans_incomplete) {
+		getuptime(&now);
+		remain = ts_sub_diff(&deadline, &now);
+		if (NSEC2USEC(remain) <= 0) {
+			/* Remember failure */
+			atrans_set_state(atrans, atrans_failed, &now,
+			    ATRANS_FAILED_TIME);
+			fibril_condvar_broadcast(&atrans->cv);
+			break;
+		}
 
+		(void) fibril_condvar_wait_timeout(&atrans->cv,
+		    &atrans_list_lock, NSEC2USEC(remain));
+	}
+
+	--atrans->waiters;
+
+	if (atrans->state == atrans_reachable ||
+	    atrans->state == atrans_stale) {
+		*mac_addr = atrans->mac_addr;
+		rc = EOK;
+	} else {
+		rc = ENOENT;
+	}
+
+	if (atrans->removed && atrans->waiters == 0)
+		free(atrans);
+
+	fibril_mutex_unlock(&atrans_list_lock);
 	return rc;
 }
 
@@ -37,14 +37,18 @@
 #ifndef ETHIP_H_
 #define ETHIP_H_
 
+#include <adt/hash_table.h>
 #include <adt/list.h>
 #include <async.h>
+#include <fibril_synch.h>
 #include <inet/addr.h>
 #include <inet/eth_addr.h>
 #include <inet/iplink_srv.h>
 #include <loc.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <time.h>
 
 typedef struct {
 	link_t link;
@@ -109,11 +113,38 @@ typedef struct {
 	addr32_t target_proto_addr;
 } arp_eth_packet_t;
 
+/** Address translation table entry state */
+typedef enum {
+	/** Resolution in progress */
+	atrans_incomplete,
+	/** Recently confirmed */
+	atrans_reachable,
+	/** Not confirmed recently, usable but needs to be re-probed */
+	atrans_stale,
+	/** Resolution failed (negative entry) */
+	atrans_failed
+} ethip_atrans_state_t;
+
 /** Address translation table element */
 typedef struct {
-	link_t atrans_list;
+	/** Link to address translation hash table */
+	ht_link_t atrans_link;
+	/** Link to least-recently-updated list */
+	link_t atrans_lru;
 	addr32_t ip_addr;
 	eth_addr_t mac_addr;
+	/** Entry state */
+	ethip_atrans_state_t state;
+	/** Time when the current state expires */
+	struct timespec expires;
+	/** Time when the translation was last confirmed */
+	struct timespec confirmed;
+	/** Signalled when resolution completes or fails */
+	fibril_condvar_t cv;
+	/** Number of fibrils waiting for resolution */
+	unsigned waiters;
+	/** Removed from the table, the last waiter frees it */
+	bool removed;
 } ethip_atrans_t;
 
 extern errno_t ethip_iplink_init(ethip_nic_t *);
@@ -73,7 +73,10 @@ errno_t eth_pdu_encode(eth_frame_t *frame, void **rdata, size_t *rsize)
 	return EOK;
 }
 
-/** Decode Ethernet PDU. */
+/** Decode Ethernet PDU.
+ *
+ * The payload is not copied, @a frame->data points into @a data.
+ */
 errno_t eth_pdu_decode(void *data, size_t size, eth_frame_t *frame)
 {
 	eth_header_t *hdr;
@@ -88,17 +91,12 @@ errno_t eth_pdu_decode(void *data, size_t size, eth_frame_t *frame)
 	hdr = (eth_header_t *)data;
 
 	frame->size = size - sizeof(eth_header_t);
-	frame->data = calloc(frame->size, 1);
-	if (frame->data == NULL)
-		return ENOMEM;
+	frame->data = (uint8_t *)data + sizeof(eth_header_t);
 
 	eth_addr_decode(hdr->src, &frame->src);
 	eth_addr_decode(hdr->dest, &frame->dest);
 	frame->etype_len = uint16_t_be2host(hdr->etype_len);
 
-	memcpy(frame->data, (uint8_t *)data + sizeof(eth_header_t),
-	    frame->size);
-
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "Decoded Ethernet frame payload (%zu bytes)", frame->size);
 
 	return EOK;
@@ -48,6 +48,7 @@
 #include "inetsrv.h"
 #include "inet_link.h"
 #include "ndp.h"
+#include "rtrie.h"
 
 static inet_addrobj_t *inet_addrobj_find_by_name_locked(const char *, inet_link_t *);
 
@@ -55,6 +56,11 @@ static FIBRIL_MUTEX_INITIALIZE(addr_list_lock);
 static LIST_INITIALIZE(addr_list);
 static sysarg_t addr_id = 0;
 
+/** Address objects indexed by network prefix */
+static inet_rtrie_t addr_net_trie;
+/** Address objects indexed by host address */
+static inet_rtrie_t addr_host_trie;
+
 inet_addrobj_t *inet_addrobj_new(void)
 {
 	inet_addrobj_t *addr = calloc(1, sizeof(inet_addrobj_t));
@@ -83,6 +89,9 @@ void inet_addrobj_delete(inet_addrobj_t *addr)
 errno_t inet_addrobj_add(inet_addrobj_t *addr)
 {
 	inet_addrobj_t *aobj;
+	inet_addr_t iaddr;
+	inet_naddr_t host;
+	errno_t rc;
 
 	fibril_mutex_lock(&addr_list_lock);
 	aobj = inet_addrobj_find_by_name_locked(addr->name, addr->ilink);
@@ -92,6 +101,24 @@ errno_t inet_addrobj_add(inet_addrobj_t *addr)
 		return EEXIST;
 	}
 
+	rc = inet_rtrie_insert(&addr_net_trie, &addr->naddr, &addr->net_entry,
+	    addr);
+	if (rc != EOK) {
+		fibril_mutex_unlock(&addr_list_lock);
+		return rc;
+	}
+
+	inet_naddr_addr(&addr->naddr, &iaddr);
+	inet_addr_naddr(&iaddr, iaddr.version == ip_v4 ? 32 : 128, &host);
+
+	rc = inet_rtrie_insert(&addr_host_trie, &host, &addr->host_entry,
+	    addr);
+	if (rc != EOK) {
+		inet_rtrie_remove(&addr_net_trie, &addr->net_entry);
+		fibril_mutex_unlock(&addr_list_lock);
+		return rc;
+	}
+
 	list_append(&addr->addr_list, &addr_list);
 	fibril_mutex_unlock(&addr_list_lock);
 
@@ -101,6 +128,8 @@ errno_t inet_addrobj_add(inet_addrobj_t *addr)
 void inet_addrobj_remove(inet_addrobj_t *addr)
 {
 	fibril_mutex_lock(&addr_list_lock);
+	inet_rtrie_remove(&addr_net_trie, &addr->net_entry);
+	inet_rtrie_remove(&addr_host_trie, &addr->host_entry);
 	list_remove(&addr->addr_list);
 	fibril_mutex_unlock(&addr_list_lock);
 }
@@ -108,39 +137,36 @@ void inet_addrobj_remove(inet_addrobj_t *addr)
 /** Find address object matching address @a addr.
  *
  * @param addr Address
- * @oaram find iaf_net to find network (using mask),
+ * @oaram find iaf_net to find network (using mask, the most specific
+ *             network is returned),
  *             iaf_addr to find local address (exact match)
  *
  */
 inet_addrobj_t *inet_addrobj_find(inet_addr_t *addr, inet_addrobj_find_t find)
 {
+	inet_addrobj_t *naddr = NULL;
+
 	fibril_mutex_lock(&addr_list_lock);
 
-	list_foreach(addr_list, addr_list, inet_addrobj_t, naddr) {
-		switch (find) {
-		case iaf_net:
-			if (inet_naddr_compare_mask(&naddr->naddr, addr)) {
-				fibril_mutex_unlock(&addr_list_lock);
-				log_msg(LOG_DEFAULT, LVL_DEBUG, "inet_addrobj_find: found %p",
-				    naddr);
-				return naddr;
-			}
-			break;
-		case iaf_addr:
-			if (inet_naddr_compare(&naddr->naddr, addr)) {
-				fibril_mutex_unlock(&addr_list_lock);
-				log_msg(LOG_DEFAULT, LVL_DEBUG, "inet_addrobj_find: found %p",
-				    naddr);
-				return naddr;
-			}
-			break;
-		}
+	switch (find) {
+	case iaf_net:
+		naddr = inet_rtrie_lookup(&addr_net_trie, addr);
+		break;
+	case iaf_addr:
+		naddr = inet_rtrie_lookup(&addr_host_trie, addr);
+		break;
+	}
+
+	if (naddr != NULL) {
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "inet_addrobj_find: found %p",
+		    naddr);
+	} else {
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "inet_addrobj_find: Not found");
 	}
 
-	log_msg(LOG_DEFAULT, LVL_DEBUG, "inet_addrobj_find: Not found");
 	fibril_mutex_unlock(&addr_list_lock);
 
-	return NULL;
+	return naddr;
 }
 
 /** Find address object on a link, with a specific name.
@@ -374,7 +400,12 @@ static errno_t inet_addrobj_load(sif_node_t *anode)
 		return ENOMEM;
 	}
 
-	inet_addrobj_add(addr);
+	rc = inet_addrobj_add(addr);
+	if (rc != EOK) {
+		inet_addrobj_delete(addr);
+		return rc;
+	}
+
 	return EOK;
 }
 
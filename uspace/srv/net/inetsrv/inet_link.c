@@ -50,6 +50,9 @@
 #include "inet_link.h"
 #include "pdu.h"
 
+/** Number of slots in the receive packet ring of each link */
+#define INET_LINK_RX_RING_SLOTS 256
+
 static bool first_link = true;
 static bool first_link6 = true;
 
@@ -211,6 +214,17 @@ static errno_t inet_link_open_locked(service_id_t sid)
 		goto error;
 	}
 
+	/*
+	 * Receive packets through a shared-memory ring if the link
+	 * supports it. Otherwise they are delivered via IPC data writes.
+	 */
+	rc = iplink_rx_ring_setup(ilink->iplink, INET_LINK_RX_RING_SLOTS,
+	    ilink->def_mtu);
+	if (rc != EOK) {
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "Link '%s' does not support "
+		    "receive ring (%s).", ilink->svc_name, str_error_name(rc));
+	}
+
 	/*
 	 * Get the MAC address of the link. If the link has a MAC
 	 * address, we assume that it supports NDP.
@@ -57,6 +57,7 @@
 #include "inetcfg.h"
 #include "inetping.h"
 #include "inet_link.h"
+#include "ntrans.h"
 #include "reass.h"
 #include "sroute.h"
 
@@ -94,6 +95,14 @@ static errno_t inet_init(void)
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "inet_init()");
 
+	rc = ntrans_init();
+	if (rc != EOK)
+		return rc;
+
+	rc = inet_reass_init();
+	if (rc != EOK)
+		return rc;
+
 	rc = inet_link_discovery_start();
 	if (rc != EOK)
 		return rc;
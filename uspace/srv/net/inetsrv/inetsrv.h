@@ -48,6 +48,7 @@
 #include <stdint.h>
 #include <types/inet.h>
 #include <async.h>
+#include "rtrie.h"
 
 /** Inet Client */
 typedef struct {
@@ -124,6 +125,10 @@ typedef struct {
 typedef struct {
 	/** Link to list of addresses */
 	link_t addr_list;
+	/** Entry in network prefix trie */
+	inet_rtrie_entry_t net_entry;
+	/** Entry in host address trie */
+	inet_rtrie_entry_t host_entry;
 	/** Address object ID */
 	sysarg_t id;
 	/** Network address */
@@ -139,6 +144,8 @@ typedef struct {
 /** Static route configuration */
 typedef struct {
 	link_t sroute_list;
+	/** Entry in routing trie */
+	inet_rtrie_entry_t rtrie_entry;
 	/** ID */
 	sysarg_t id;
 	/** Destination network */
@@ -161,24 +161,29 @@ errno_t ndp_translate(addr128_t src_addr, addr128_t ip_addr, eth_addr_t *mac_add
 		return EOK;
 	}
 
-	errno_t rc = ntrans_lookup(ip_addr, mac_addr);
-	if (rc == EOK)
-		return EOK;
+	bool probe;
+	errno_t rc = ntrans_query(ip_addr, mac_addr, &probe);
+	if (rc != EOK && rc != EAGAIN)
+		return rc;
 
-	ndp_packet_t packet;
+	if (probe) {
+		ndp_packet_t packet;
 
-	packet.opcode = ICMPV6_NEIGHBOUR_SOLICITATION;
-	packet.sender_hw_addr = ilink->mac;
-	addr128(src_addr, packet.sender_proto_addr);
-	addr128(ip_addr, packet.solicited_ip);
-	eth_addr_solicited_node(ip_addr, &packet.target_hw_addr);
-	ndp_solicited_node_ip(ip_addr, packet.target_proto_addr);
+		packet.opcode = ICMPV6_NEIGHBOUR_SOLICITATION;
+		packet.sender_hw_addr = ilink->mac;
+		addr128(src_addr, packet.sender_proto_addr);
+		addr128(ip_addr, packet.solicited_ip);
+		eth_addr_solicited_node(ip_addr, &packet.target_hw_addr);
+		ndp_solicited_node_ip(ip_addr, packet.target_proto_addr);
 
-	rc = ndp_send_packet(ilink, &packet);
-	if (rc != EOK)
-		return rc;
+		errno_t prc = ndp_send_packet(ilink, &packet);
+		if (prc != EOK && rc != EOK)
+			return prc;
+	}
 
-	(void) ntrans_wait_timeout(NDP_REQUEST_TIMEOUT);
+	/* Stale translation is used while it is being re-probed */
+	if (rc == EOK)
+		return EOK;
 
-	return ntrans_lookup(ip_addr, mac_addr);
+	return ntrans_lookup_timeout(ip_addr, NDP_REQUEST_TIMEOUT, mac_addr);
 }
@@ -35,37 +35,220 @@
  * @brief
  */
 
+#include <adt/hash.h>
+#include <adt/hash_table.h>
 #include <adt/list.h>
+#include <assert.h>
 #include <errno.h>
 #include <fibril_synch.h>
 #include <inet/eth_addr.h>
 #include <inet/iplink_srv.h>
 #include <stdlib.h>
+#include <time.h>
 #include "ntrans.h"
 
-/** Address translation list (of inet_ntrans_t) */
+/** Address translation table (of inet_ntrans_t) */
 static FIBRIL_MUTEX_INITIALIZE(ntrans_list_lock);
-static LIST_INITIALIZE(ntrans_list);
-static FIBRIL_CONDVAR_INITIALIZE(ntrans_cv);
+static hash_table_t ntrans_table;
+/** Entries in least-recently-updated order */
+static LIST_INITIALIZE(ntrans_lru);
+/** Offset added to the system uptime */
+static nsec_t ntrans_clock_skew;
 
-/** Look for address in translation table
+/** Compute hash of IPv6 address.
  *
  * @param ip_addr IPv6 address
+ * @return Hash
+ */
+static size_t ntrans_addr_hash(const uint8_t *ip_addr)
+{
+	size_t hash = 0;
+	uint32_t w;
+	int i;
+
+	for (i = 0; i < 16; i += 4) {
+		w = ((uint32_t) ip_addr[i] << 24) |
+		    ((uint32_t) ip_addr[i + 1] << 16) |
+		    ((uint32_t) ip_addr[i + 2] << 8) | ip_addr[i + 3];
+		hash = hash_combine(hash, hash_mix32(w));
+	}
+
+	return hash;
+}
+
+static size_t ntrans_key_hash(const void *key)
+{
+	return ntrans_addr_hash((const uint8_t *) key);
+}
+
+static size_t ntrans_hash(const ht_link_t *item)
+{
+	inet_ntrans_t *ntrans = hash_table_get_inst(item, inet_ntrans_t,
+	    ntrans_link);
+	return ntrans_addr_hash(ntrans->ip_addr);
+}
+
+static bool ntrans_key_equal(const void *key, const ht_link_t *item)
+{
+	inet_ntrans_t *ntrans = hash_table_get_inst(item, inet_ntrans_t,
+	    ntrans_link);
+	return addr128_compare(ntrans->ip_addr, (const uint8_t *) key);
+}
+
+static bool ntrans_equal(const ht_link_t *item1, const ht_link_t *item2)
+{
+	inet_ntrans_t *n1 = hash_table_get_inst(item1, inet_ntrans_t,
+	    ntrans_link);
+	inet_ntrans_t *n2 = hash_table_get_inst(item2, inet_ntrans_t,
+	    ntrans_link);
+	return addr128_compare(n1->ip_addr, n2->ip_addr);
+}
+
+static const hash_table_ops_t ntrans_table_ops = {
+	.hash = ntrans_hash,
+	.key_hash = ntrans_key_hash,
+	.key_equal = ntrans_key_equal,
+	.equal = ntrans_equal,
+	.remove_callback = NULL
+};
+
+/** Initialize address translation table.
  *
- * @return inet_ntrans_t with the address on success
- * @return NULL if nothing found
+ * @return EOK on success, ENOMEM if out of memory
  */
+errno_t ntrans_init(void)
+{
+	if (!hash_table_create(&ntrans_table, 0, 0, &ntrans_table_ops))
+		return ENOMEM;
+
+	return EOK;
+}
+
+/** Advance the clock of the translation table.
+ *
+ * Lets tests age entries without waiting.
+ *
+ * @param delta Time to add to the system uptime
+ */
+void ntrans_clock_advance(nsec_t delta)
+{
+	fibril_mutex_lock(&ntrans_list_lock);
+	ntrans_clock_skew += delta;
+	fibril_mutex_unlock(&ntrans_list_lock);
+}
+
+/** Get current time of the translation table.
+ *
+ * @param now Place to store the time
+ */
+static void ntrans_getuptime(struct timespec *now)
+{
+	getuptime(now);
+	ts_add_diff(now, ntrans_clock_skew);
+}
+
 static inet_ntrans_t *ntrans_find(addr128_t ip_addr)
 {
-	list_foreach(ntrans_list, ntrans_list, inet_ntrans_t, ntrans) {
-		if (addr128_compare(ntrans->ip_addr, ip_addr))
-			return ntrans;
+	ht_link_t *link;
+
+	link = hash_table_find(&ntrans_table, ip_addr);
+	if (link == NULL)
+		return NULL;
+
+	return hash_table_get_inst(link, inet_ntrans_t, ntrans_link);
+}
+
+/** Set entry state and expiration time.
+ *
+ * @param ntrans Entry
+ * @param state New state
+ * @param now Current time
+ * @param secs Seconds until the state expires
+ */
+static void ntrans_set_state(inet_ntrans_t *ntrans,
+    inet_ntrans_state_t state, struct timespec *now, unsigned secs)
+{
+	ntrans->state = state;
+	ntrans->expires = *now;
+	ts_add_diff(&ntrans->expires, SEC2NSEC(secs));
+
+	/* Move to the most recently updated end */
+	list_remove(&ntrans->ntrans_lru);
+	list_append(&ntrans->ntrans_lru, &ntrans_lru);
+}
+
+/** Remove entry from the hash table and the LRU list. */
+static void ntrans_unlink(inet_ntrans_t *ntrans)
+{
+	hash_table_remove_item(&ntrans_table, &ntrans->ntrans_link);
+	list_remove(&ntrans->ntrans_lru);
+}
+
+static void ntrans_destroy(inet_ntrans_t *ntrans)
+{
+	assert(ntrans->waiters == 0);
+	ntrans_unlink(ntrans);
+	free(ntrans);
+}
+
+/** Finalize address translation table.
+ *
+ * Frees all entries. No fibril may be waiting for resolution.
+ */
+void ntrans_fini(void)
+{
+	fibril_mutex_lock(&ntrans_list_lock);
+
+	while (!list_empty(&ntrans_lru)) {
+		ntrans_destroy(list_get_instance(list_first(&ntrans_lru),
+		    inet_ntrans_t, ntrans_lru));
 	}
 
-	return NULL;
+	hash_table_destroy(&ntrans_table);
+	ntrans_clock_skew = 0;
+
+	fibril_mutex_unlock(&ntrans_list_lock);
+}
+
+/** Create new entry, evicting the oldest idle entry if the table is full.
+ *
+ * @param ip_addr IP address
+ * @return New entry or @c NULL if out of memory or no entry can be evicted
+ */
+static inet_ntrans_t *ntrans_create(addr128_t ip_addr)
+{
+	inet_ntrans_t *ntrans;
+
+	if (hash_table_size(&ntrans_table) >= NTRANS_MAX_ENTRIES) {
+		list_foreach(ntrans_lru, ntrans_lru, inet_ntrans_t, old) {
+			if (old->waiters == 0) {
+				ntrans_destroy(old);
+				break;
+			}
+		}
+
+		if (hash_table_size(&ntrans_table) >= NTRANS_MAX_ENTRIES)
+			return NULL;
+	}
+
+	ntrans = calloc(1, sizeof(inet_ntrans_t));
+	if (ntrans == NULL)
+		return NULL;
+
+	addr128(ip_addr, ntrans->ip_addr);
+	ntrans->state = ntrans_incomplete;
+	fibril_condvar_initialize(&ntrans->cv);
+	link_initialize(&ntrans->ntrans_lru);
+	list_append(&ntrans->ntrans_lru, &ntrans_lru);
+	hash_table_insert(&ntrans_table, &ntrans->ntrans_link);
+
+	return ntrans;
 }
 
 /** Add entry to translation table
+ *
+ * Creates or updates the entry for @a ip_addr and wakes up any fibrils
+ * waiting for its resolution.
  *
  * @param ip_addr  IPv6 address of the new entry
  * @param mac_addr MAC address of the new entry
@@ -77,25 +260,26 @@ static inet_ntrans_t *ntrans_find(addr128_t ip_addr)
 errno_t ntrans_add(addr128_t ip_addr, eth_addr_t *mac_addr)
 {
 	inet_ntrans_t *ntrans;
-	inet_ntrans_t *prev;
+	struct timespec now;
 
-	ntrans = calloc(1, sizeof(inet_ntrans_t));
-	if (ntrans == NULL)
-		return ENOMEM;
-
-	addr128(ip_addr, ntrans->ip_addr);
-	ntrans->mac_addr = *mac_addr;
+	ntrans_getuptime(&now);
 
 	fibril_mutex_lock(&ntrans_list_lock);
-	prev = ntrans_find(ip_addr);
-	if (prev != NULL) {
-		list_remove(&prev->ntrans_list);
-		free(prev);
+	ntrans = ntrans_find(ip_addr);
+	if (ntrans == NULL) {
+		ntrans = ntrans_create(ip_addr);
+		if (ntrans == NULL) {
+			fibril_mutex_unlock(&ntrans_list_lock);
+			return ENOMEM;
+		}
 	}
 
-	list_append(&ntrans->ntrans_list, &ntrans_list);
+	ntrans->mac_addr = *mac_addr;
+	ntrans->confirmed = now;
+	ntrans_set_state(ntrans, ntrans_reachable, &now,
+	    NTRANS_REACHABLE_TIME);
+	fibril_condvar_broadcast(&ntrans->cv);
 	fibril_mutex_unlock(&ntrans_list_lock);
-	fibril_condvar_broadcast(&ntrans_cv);
 
 	return EOK;
 }
@@ -119,10 +303,42 @@ errno_t ntrans_remove(addr128_t ip_addr)
 		return ENOENT;
 	}
 
-	list_remove(&ntrans->ntrans_list);
+	if (ntrans->waiters > 0) {
+		/*
+		 * Fail pending resolution. The entry can no longer be
+		 * found, the last waiter frees it.
+		 */
+		ntrans_unlink(ntrans);
+		ntrans->removed = true;
+		ntrans->state = ntrans_failed;
+		fibril_condvar_broadcast(&ntrans->cv);
+	} else {
+		ntrans_destroy(ntrans);
+	}
+
 	fibril_mutex_unlock(&ntrans_list_lock);
-	free(ntrans);
+	return EOK;
+}
+
+/** Translate IPv6 address to MAC address using the translation table
+ *
+ * @param ip_addr  IPv6 address to be translated
+ * @param mac_addr MAC address to be assigned
+ *
+ * @return EOK on success
+ * @return ENOENT when no such address found
+ *
+ */
+static errno_t ntrans_lookup_locked(addr128_t ip_addr, eth_addr_t *mac_addr)
+{
+	inet_ntrans_t *ntrans = ntrans_find(ip_addr);
+	if (ntrans == NULL)
+		return ENOENT;
+
+	if (ntrans->state != ntrans_reachable && ntrans->state != ntrans_stale)
+		return ENOENT;
 
+	*mac_addr = ntrans->mac_addr;
 	return EOK;
 }
 
@@ -137,33 +353,185 @@ errno_t ntrans_remove(addr128_t ip_addr)
  */
 errno_t ntrans_lookup(addr128_t ip_addr, eth_addr_t *mac_addr)
 {
+	errno_t rc;
+
 	fibril_mutex_lock(&ntrans_list_lock);
-	inet_ntrans_t *ntrans = ntrans_find(ip_addr);
+	rc = ntrans_lookup_locked(ip_addr, mac_addr);
+	fibril_mutex_unlock(&ntrans_list_lock);
+
+	return rc;
+}
+
+/** Query address translation for transmitting a packet.
+ *
+ * Ages the entry and decides whether a neighbor solicitation should be
+ * sent. Concurrent queries for an unresolved address result in a single
+ * request. Addresses that recently failed to resolve are rejected
+ * without sending a request.
+ *
+ * @param ip_addr IP address
+ * @param mac_addr Place to store MAC address
+ * @param rprobe Place to store @c true if the caller should send
+ *               a neighbor solicitation for @a ip_addr
+ * @return EOK if @a mac_addr is valid (the entry may still need to be
+ *         re-probed), EAGAIN if resolution is in progress and the caller
+ *         should wait using ntrans_lookup_timeout(), ENOENT if resolution
+ *         recently failed, ENOMEM if out of memory
+ */
+errno_t ntrans_query(addr128_t ip_addr, eth_addr_t *mac_addr, bool *rprobe)
+{
+	inet_ntrans_t *ntrans;
+	struct timespec now;
+	struct timespec stale_end;
+	errno_t rc;
+
+	ntrans_getuptime(&now);
+	*rprobe = false;
+
+	fibril_mutex_lock(&ntrans_list_lock);
+	ntrans = ntrans_find(ip_addr);
 	if (ntrans == NULL) {
+		ntrans = ntrans_create(ip_addr);
+		if (ntrans == NULL) {
+			fibril_mutex_unlock(&ntrans_list_lock);
+			return ENOMEM;
+		}
+
+		ntrans_set_state(ntrans, ntrans_incomplete, &now, 0);
+		*rprobe = true;
 		fibril_mutex_unlock(&ntrans_list_lock);
-		return ENOENT;
+		return EAGAIN;
+	}
+
+	switch (ntrans->state) {
+	case ntrans_incomplete:
+		rc = EAGAIN;
+		break;
+	case ntrans_reachable:
+		if (ts_gt(&now, &ntrans->expires)) {
+			/* Keep using the entry but confirm it */
+			ntrans_set_state(ntrans, ntrans_stale, &now,
+			    NTRANS_PROBE_INTERVAL);
+			*rprobe = true;
+		}
+
+		*mac_addr = ntrans->mac_addr;
+		rc = EOK;
+		break;
+	case ntrans_stale:
+		/*
+		 * Expiration time of stale entry is the next probe time.
+		 * Stale entry is discarded NTRANS_STALE_TIME after
+		 * it was last confirmed.
+		 */
+		stale_end = ntrans->confirmed;
+		ts_add_diff(&stale_end, SEC2NSEC(NTRANS_REACHABLE_TIME +
+		    NTRANS_STALE_TIME));
+		if (ts_gt(&now, &stale_end)) {
+			ntrans_set_state(ntrans, ntrans_incomplete, &now, 0);
+			*rprobe = true;
+			rc = EAGAIN;
+			break;
+		}
+
+		if (ts_gt(&now, &ntrans->expires)) {
+			ntrans_set_state(ntrans, ntrans_stale, &now,
+			    NTRANS_PROBE_INTERVAL);
+			*rprobe = true;
+		}
+
+		*mac_addr = ntrans->mac_addr;
+		rc = EOK;
+		break;
+	case ntrans_failed:
+		if (ts_gt(&now, &ntrans->expires)) {
+			/* Negative entry expired, try again */
+			ntrans_set_state(ntrans, ntrans_incomplete, &now, 0);
+			*rprobe = true;
+			rc = EAGAIN;
+		} else {
+			rc = ENOENT;
+		}
+		break;
+	default:
+		assert(false);
+		rc = EINVAL;
+		break;
 	}
 
 	fibril_mutex_unlock(&ntrans_list_lock);
-	*mac_addr = ntrans->mac_addr;
-	return EOK;
+	return rc;
 }
 
-/** Wait on translation table CV for some time
+/** Wait for address resolution to complete.
  *
- * @param timeout Timeout in microseconds
- *
- * @return EOK if woken up by another fibril
- * @return ETIMEOUT if timed out
+ * If resolution does not complete in time, the address is remembered
+ * as unresolvable for a while so that further packets to it fail fast.
+ * At most NTRANS_MAX_PENDING fibrils may wait for one address.
  *
+ * @param ip_addr IP address
+ * @param timeout Timeout in microseconds
+ * @param mac_addr Place to store MAC address
+ * @return EOK on success, ENOENT if resolution failed or timed out,
+ *         ELIMIT if too many packets are already waiting
  */
-errno_t ntrans_wait_timeout(usec_t timeout)
+errno_t ntrans_lookup_timeout(addr128_t ip_addr, usec_t timeout,
+    eth_addr_t *mac_addr)
 {
+	inet_ntrans_t *ntrans;
+	struct timespec now;
+	struct timespec deadline;
+	nsec_t remain;
+	errno_t rc;
+
+	ntrans_getuptime(&deadline);
+	ts_add_diff(&deadline, USEC2NSEC(timeout));
+
 	fibril_mutex_lock(&ntrans_list_lock);
-	errno_t rc = fibril_condvar_wait_timeout(&ntrans_cv, &ntrans_list_lock,
-	    timeout);
-	fibril_mutex_unlock(&ntrans_list_lock);
 
+	ntrans = ntrans_find(ip_addr);
+	if (ntrans == NULL) {
+		fibril_mutex_unlock(&ntrans_list_lock);
+		return ENOENT;
+	}
+
+	if (ntrans->state == ntrans_incomplete &&
+	    ntrans->waiters >= NTRANS_MAX_PENDING) {
+		fibril_mutex_unlock(&ntrans_list_lock);
+		return ELIMIT;
+	}
+
+	++ntrans->waiters;
+
+	while (ntrans->state == ntrans_incomplete) {
+		ntrans_getuptime(&now);
+		remain = ts_sub_diff(&deadline, &now);
+		if (NSEC2USEC(remain) <= 0) {
+			/* Remember failure */
+			ntrans_set_state(ntrans, ntrans_failed, &now,
+			    NTRANS_FAILED_TIME);
+			fibril_condvar_broadcast(&ntrans->cv);
+			break;
+		}
+
+		(void) fibril_condvar_wait_timeout(&ntrans->cv,
+		    &ntrans_list_lock, NSEC2USEC(remain));
+	}
+
+	--ntrans->waiters;
+
+	if (ntrans->state == ntrans_reachable ||
+	    ntrans->state == ntrans_stale) {
+		*mac_addr = ntrans->mac_addr;
+		rc = EOK;
+	} else {
+		rc = ENOENT;
+	}
+
+	if (ntrans->removed && ntrans->waiters == 0)
+		free(ntrans);
+
+	fibril_mutex_unlock(&ntrans_list_lock);
 	return rc;
 }
 
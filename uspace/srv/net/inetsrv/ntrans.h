@@ -38,21 +38,70 @@
 #ifndef NTRANS_H_
 #define NTRANS_H_
 
+#include <adt/hash_table.h>
+#include <adt/list.h>
+#include <fibril_synch.h>
 #include <inet/addr.h>
 #include <inet/eth_addr.h>
 #include <inet/iplink_srv.h>
+#include <stdbool.h>
+#include <time.h>
+
+/** Time after which a confirmed entry becomes stale (seconds) */
+#define NTRANS_REACHABLE_TIME 30
+/** Time after which an unconfirmed stale entry is discarded (seconds) */
+#define NTRANS_STALE_TIME 600
+/** Minimum interval between re-probes of a stale entry (seconds) */
+#define NTRANS_PROBE_INTERVAL 5
+/** Time for which a failed resolution is remembered (seconds) */
+#define NTRANS_FAILED_TIME 20
+/** Maximum number of entries in the table */
+#define NTRANS_MAX_ENTRIES 1024
+/** Maximum number of packets waiting for resolution of one address */
+#define NTRANS_MAX_PENDING 16
+
+/** Address translation table entry state */
+typedef enum {
+	/** Resolution in progress */
+	ntrans_incomplete,
+	/** Recently confirmed */
+	ntrans_reachable,
+	/** Not confirmed recently, usable but needs to be re-probed */
+	ntrans_stale,
+	/** Resolution failed (negative entry) */
+	ntrans_failed
+} inet_ntrans_state_t;
 
 /** Address translation table element */
 typedef struct {
-	link_t ntrans_list;
+	/** Link to address translation hash table */
+	ht_link_t ntrans_link;
+	/** Link to least-recently-updated list */
+	link_t ntrans_lru;
 	addr128_t ip_addr;
 	eth_addr_t mac_addr;
+	/** Entry state */
+	inet_ntrans_state_t state;
+	/** Time when the current state expires */
+	struct timespec expires;
+	/** Time when the translation was last confirmed */
+	struct timespec confirmed;
+	/** Signalled when resolution completes or fails */
+	fibril_condvar_t cv;
+	/** Number of fibrils waiting for resolution */
+	unsigned waiters;
+	/** Removed from the table, the last waiter frees it */
+	bool removed;
 } inet_ntrans_t;
 
+extern errno_t ntrans_init(void);
+extern void ntrans_fini(void);
+extern void ntrans_clock_advance(nsec_t);
 extern errno_t ntrans_add(addr128_t, eth_addr_t *);
 extern errno_t ntrans_remove(addr128_t);
 extern errno_t ntrans_lookup(addr128_t, eth_addr_t *);
-extern errno_t ntrans_wait_timeout(usec_t);
+extern errno_t ntrans_query(addr128_t, eth_addr_t *, bool *);
+extern errno_t ntrans_lookup_timeout(addr128_t, usec_t, eth_addr_t *);
 
 #endif
 
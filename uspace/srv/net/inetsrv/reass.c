@@ -32,42 +32,101 @@
 /**
  * @file
  * @brief Datagram reassembly.
+ *
+ * Datagrams being reassembled are kept in a hash table keyed by (source
+ * address, destination address, protocol, identification). Each datagram
+ * keeps the data received so far as a list of non-overlapping intervals
+ * sorted by offset. Duplicate and overlapping data is trimmed on arrival,
+ * so the datagram is complete as soon as the number of bytes covered
+ * equals the datagram size.
+ *
+ * Memory used by all datagrams is limited. When the limit would be exceeded,
+ * the oldest datagrams are dropped. Datagrams that are not completed within
+ * a timeout are dropped as well.
  */
 
+#include <adt/hash.h>
+#include <adt/hash_table.h>
+#include <adt/list.h>
+#include <assert.h>
 #include <errno.h>
 #include <fibril_synch.h>
 #include <io/log.h>
 #include <macros.h>
 #include <mem.h>
 #include <stdlib.h>
+#include <time.h>
 
 #include "inetsrv.h"
 #include "inet_std.h"
 #include "reass.h"
 
+/** Datagram reassembly timeout (seconds) */
+#define REASS_TIMEOUT 30
+
+/** Maximum number of data intervals per datagram */
+#define REASS_MAX_FRAGS 256
+
+/** Datagram reassembly key */
+typedef struct {
+	inet_addr_t src;
+	inet_addr_t dest;
+	uint8_t proto;
+	uint32_t ident;
+} reass_key_t;
+
 /** Datagram being reassembled.
  *
  * Uniquely identified by (source address, destination address, protocol,
  * identification) per RFC 791 sec. 2.3 / Fragmentation.
  */
 typedef struct {
-	link_t map_link;
-	/** List of fragments, @c reass_frag_t */
+	/** Link to @c reass_dgram_map */
+	ht_link_t map_link;
+	/** Link to @c reass_dgram_lru */
+	link_t lru_link;
+	/** Datagram key */
+	reass_key_t key;
+	/** Link the first fragment was received on */
+	service_id_t link_id;
+	/** Type of service */
+	uint8_t tos;
+	/** Time when reassembly times out */
+	struct timespec expires;
+	/** List of data intervals sorted by offset, @c reass_frag_t */
 	list_t frags;
+	/** Number of data intervals */
+	size_t nfrags;
+	/** Number of data bytes received */
+	size_t covered;
+	/** @c true if the last fragment (with MF clear) has been received */
+	bool have_last;
+	/** Datagram size (valid if @c have_last is @c true) */
+	size_t size;
+	/** Memory charged to this datagram */
+	size_t mem;
 } reass_dgram_t;
 
-/** One datagram fragment */
+/** Interval of datagram data */
 typedef struct {
 	link_t dgram_link;
-	inet_packet_t packet;
+	/** Offset into datagram */
+	size_t offs;
+	/** Size of data */
+	size_t size;
+	/** Data */
+	uint8_t data[];
 } reass_frag_t;
 
-/** Datagram map, list of reass_dgram_t */
-static LIST_INITIALIZE(reass_dgram_map);
+/** Datagram map, hash table of reass_dgram_t */
+static hash_table_t reass_dgram_map;
+/** Datagrams, oldest first */
+static LIST_INITIALIZE(reass_dgram_lru);
 /** Protects access to @c reass_dgram_map */
 static FIBRIL_MUTEX_INITIALIZE(reass_dgram_map_lock);
+/** Reassembly statistics */
+static inet_reass_stats_t reass_stats;
 
-static reass_dgram_t *reass_dgram_new(void);
 static reass_dgram_t *reass_dgram_get(inet_packet_t *);
 static errno_t reass_dgram_insert_frag(reass_dgram_t *, inet_packet_t *);
 static bool reass_dgram_complete(reass_dgram_t *);
@@ -75,10 +134,180 @@ static void reass_dgram_remove(reass_dgram_t *);
 static errno_t reass_dgram_deliver(reass_dgram_t *);
 static void reass_dgram_destroy(reass_dgram_t *);
 
+static size_t reass_addr_hash(const inet_addr_t *addr)
+{
+	size_t hash;
+	uint32_t w;
+	int i;
+
+	switch (addr->version) {
+	case ip_v4:
+		return hash_mix32(addr->addr);
+	case ip_v6:
+		hash = 0;
+		for (i = 0; i < 16; i += 4) {
+			memcpy(&w, &addr->addr6[i], sizeof(w));
+			hash = hash_combine(hash, hash_mix32(w));
+		}
+		return hash;
+	default:
+		return 0;
+	}
+}
+
+static size_t reass_key_hash_impl(const reass_key_t *key)
+{
+	size_t hash;
+
+	hash = reass_addr_hash(&key->src);
+	hash = hash_combine(hash, reass_addr_hash(&key->dest));
+	hash = hash_combine(hash, hash_mix32(((uint32_t) key->proto << 24) ^
+	    key->ident));
+	return hash;
+}
+
+static size_t reass_key_hash(const void *key)
+{
+	return reass_key_hash_impl((const reass_key_t *) key);
+}
+
+static size_t reass_hash(const ht_link_t *item)
+{
+	reass_dgram_t *rdg = hash_table_get_inst(item, reass_dgram_t,
+	    map_link);
+	return reass_key_hash_impl(&rdg->key);
+}
+
+static bool reass_key_equal(const void *key, const ht_link_t *item)
+{
+	const reass_key_t *k = (const reass_key_t *) key;
+	reass_dgram_t *rdg = hash_table_get_inst(item, reass_dgram_t,
+	    map_link);
+
+	return inet_addr_compare(&rdg->key.src, &k->src) &&
+	    inet_addr_compare(&rdg->key.dest, &k->dest) &&
+	    rdg->key.proto == k->proto && rdg->key.ident == k->ident;
+}
+
+static const hash_table_ops_t reass_dgram_map_ops = {
+	.hash = reass_hash,
+	.key_hash = reass_key_hash,
+	.key_equal = reass_key_equal,
+	.equal = NULL,
+	.remove_callback = NULL
+};
+
+/** Initialize datagram reassembly.
+ *
+ * @return EOK on success or ENOMEM.
+ */
+errno_t inet_reass_init(void)
+{
+	if (!hash_table_create(&reass_dgram_map, 0, 0, &reass_dgram_map_ops))
+		return ENOMEM;
+
+	return EOK;
+}
+
+/** Finalize datagram reassembly.
+ *
+ * Drops all datagrams being reassembled.
+ */
+void inet_reass_fini(void)
+{
+	fibril_mutex_lock(&reass_dgram_map_lock);
+
+	while (!list_empty(&reass_dgram_lru)) {
+		reass_dgram_t *rdg = list_get_instance(
+		    list_first(&reass_dgram_lru), reass_dgram_t, lru_link);
+		reass_dgram_remove(rdg);
+		reass_dgram_destroy(rdg);
+	}
+
+	hash_table_destroy(&reass_dgram_map);
+	fibril_mutex_unlock(&reass_dgram_map_lock);
+}
+
+/** Get datagram reassembly statistics.
+ *
+ * @param stats Place to store statistics
+ */
+void inet_reass_get_stats(inet_reass_stats_t *stats)
+{
+	fibril_mutex_lock(&reass_dgram_map_lock);
+	*stats = reass_stats;
+	fibril_mutex_unlock(&reass_dgram_map_lock);
+}
+
+/** Drop datagrams whose reassembly timed out. */
+static void reass_expire(void)
+{
+	struct timespec now;
+
+	assert(fibril_mutex_is_locked(&reass_dgram_map_lock));
+
+	getuptime(&now);
+
+	/* All datagrams have the same timeout, the oldest expire first */
+	while (!list_empty(&reass_dgram_lru)) {
+		reass_dgram_t *rdg = list_get_instance(
+		    list_first(&reass_dgram_lru), reass_dgram_t, lru_link);
+		if (ts_gt(&rdg->expires, &now))
+			break;
+
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "Reassembly timed out, "
+		    "datagram dropped.");
+		reass_dgram_remove(rdg);
+		reass_dgram_destroy(rdg);
+		++reass_stats.timeouts;
+	}
+}
+
+/** Make sure there is memory available for reassembly.
+ *
+ * Drops the oldest datagrams, except @a keep, until @a size more bytes
+ * fit within the memory limit.
+ *
+ * @param size Number of bytes needed
+ * @param keep Datagram which must not be dropped
+ * @return @c true if @a size bytes are available
+ */
+static bool reass_reserve(size_t size, reass_dgram_t *keep)
+{
+	assert(fibril_mutex_is_locked(&reass_dgram_map_lock));
+
+	while (reass_stats.mem_used + size > INET_REASS_MEM_MAX) {
+		link_t *link = list_first(&reass_dgram_lru);
+		if (link == NULL)
+			return false;
+
+		reass_dgram_t *rdg = list_get_instance(link, reass_dgram_t,
+		    lru_link);
+		if (rdg == keep) {
+			link = list_next(link, &reass_dgram_lru);
+			if (link == NULL)
+				return false;
+
+			rdg = list_get_instance(link, reass_dgram_t, lru_link);
+		}
+
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "Reassembly memory exhausted, "
+		    "dropping oldest datagram.");
+		reass_dgram_remove(rdg);
+		reass_dgram_destroy(rdg);
+		++reass_stats.evictions;
+	}
+
+	return true;
+}
+
 /** Queue packet for datagram reassembly.
  *
  * @param packet	Packet
- * @return		EOK on success or ENOMEM.
+ * @return		EOK on success, ENOMEM if out of memory, EINVAL
+ *			if the fragment is inconsistent with the fragments
+ *			received before or ELIMIT if too many fragments were
+ *			received.
  */
 errno_t inet_reass_queue_packet(inet_packet_t *packet)
 {
@@ -89,6 +318,8 @@ errno_t inet_reass_queue_packet(inet_packet_t *packet)
 
 	fibril_mutex_lock(&reass_dgram_map_lock);
 
+	reass_expire();
+
 	/* Get existing or new datagram */
 	rdg = reass_dgram_get(packet);
 	if (rdg == NULL) {
@@ -100,8 +331,25 @@ errno_t inet_reass_queue_packet(inet_packet_t *packet)
 
 	/* Insert fragment into the datagram */
 	rc = reass_dgram_insert_frag(rdg, packet);
-	if (rc != EOK)
-		return ENOMEM;
+	if (rc == EINVAL || rc == ELIMIT) {
+		/* Datagram cannot be reassembled, drop it */
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "Bad fragment, datagram "
+		    "dropped.");
+		reass_dgram_remove(rdg);
+		reass_dgram_destroy(rdg);
+		fibril_mutex_unlock(&reass_dgram_map_lock);
+		return rc;
+	}
+
+	if (rc != EOK) {
+		if (list_empty(&rdg->frags)) {
+			reass_dgram_remove(rdg);
+			reass_dgram_destroy(rdg);
+		}
+
+		fibril_mutex_unlock(&reass_dgram_map_lock);
+		return rc;
+	}
 
 	/* Check if datagram is complete */
 	if (reass_dgram_complete(rdg)) {
@@ -111,7 +359,10 @@ errno_t inet_reass_queue_packet(inet_packet_t *packet)
 
 		/* Deliver complete datagram */
 		rc = reass_dgram_deliver(rdg);
+
+		fibril_mutex_lock(&reass_dgram_map_lock);
 		reass_dgram_destroy(rdg);
+		fibril_mutex_unlock(&reass_dgram_map_lock);
 		return rc;
 	}
 
@@ -123,109 +374,189 @@ errno_t inet_reass_queue_packet(inet_packet_t *packet)
  *
  * @param packet	Packet
  * @return		Datagram reassembly structure matching @a packet
+ *			or @c NULL if out of memory
  */
 static reass_dgram_t *reass_dgram_get(inet_packet_t *packet)
 {
-	assert(fibril_mutex_is_locked(&reass_dgram_map_lock));
+	reass_dgram_t *rdg;
+	reass_key_t key;
+	ht_link_t *link;
 
-	list_foreach(reass_dgram_map, map_link, reass_dgram_t, rdg) {
-		link_t *f1_link = list_first(&rdg->frags);
-		assert(f1_link != NULL);
+	assert(fibril_mutex_is_locked(&reass_dgram_map_lock));
 
-		reass_frag_t *f1 = list_get_instance(f1_link, reass_frag_t,
-		    dgram_link);
+	memset(&key, 0, sizeof(key));
+	key.src = packet->src;
+	key.dest = packet->dest;
+	key.proto = packet->proto;
+	key.ident = packet->ident;
 
-		if ((inet_addr_compare(&f1->packet.src, &packet->src)) &&
-		    (inet_addr_compare(&f1->packet.dest, &packet->dest)) &&
-		    (f1->packet.proto == packet->proto) &&
-		    (f1->packet.ident == packet->ident)) {
-			/* Match */
-			return rdg;
-		}
-	}
+	link = hash_table_find(&reass_dgram_map, &key);
+	if (link != NULL)
+		return hash_table_get_inst(link, reass_dgram_t, map_link);
 
 	/* No existing reassembly structure. Create a new one. */
-	return reass_dgram_new();
-}
-
-/** Create new datagram reassembly structure.
- *
- * @return New datagram reassembly structure.
- */
-static reass_dgram_t *reass_dgram_new(void)
-{
-	reass_dgram_t *rdg;
+	if (!reass_reserve(sizeof(reass_dgram_t), NULL))
+		return NULL;
 
 	rdg = calloc(1, sizeof(reass_dgram_t));
 	if (rdg == NULL)
 		return NULL;
 
-	list_append(&rdg->map_link, &reass_dgram_map);
+	rdg->key = key;
+	rdg->link_id = packet->link_id;
+	rdg->tos = packet->tos;
+	rdg->mem = sizeof(reass_dgram_t);
 	list_initialize(&rdg->frags);
 
+	getuptime(&rdg->expires);
+	ts_add_diff(&rdg->expires, SEC2NSEC(REASS_TIMEOUT));
+
+	hash_table_insert(&reass_dgram_map, &rdg->map_link);
+	list_append(&rdg->lru_link, &reass_dgram_lru);
+	reass_stats.mem_used += rdg->mem;
+	++reass_stats.dgrams;
+
 	return rdg;
 }
 
-static reass_frag_t *reass_frag_new(void)
+/** Insert data interval into datagram.
+ *
+ * @param rdg		Datagram reassembly structure
+ * @param before	Interval to insert before or @c NULL to append
+ * @param offs		Offset of data in datagram
+ * @param data		Data
+ * @param size		Size of data
+ * @return		EOK on success, ENOMEM if out of memory or
+ *			ELIMIT if the datagram has too many intervals
+ */
+static errno_t reass_dgram_insert_data(reass_dgram_t *rdg,
+    reass_frag_t *before, size_t offs, const uint8_t *data, size_t size)
 {
 	reass_frag_t *frag;
+	size_t fsize;
+
+	if (rdg->nfrags >= REASS_MAX_FRAGS)
+		return ELIMIT;
 
-	frag = calloc(1, sizeof(reass_frag_t));
+	fsize = sizeof(reass_frag_t) + size;
+	if (!reass_reserve(fsize, rdg))
+		return ENOMEM;
+
+	frag = malloc(fsize);
 	if (frag == NULL)
-		return NULL;
+		return ENOMEM;
 
 	link_initialize(&frag->dgram_link);
+	frag->offs = offs;
+	frag->size = size;
+	memcpy(frag->data, data, size);
+
+	if (before != NULL)
+		list_insert_before(&frag->dgram_link, &before->dgram_link);
+	else
+		list_append(&frag->dgram_link, &rdg->frags);
 
-	return frag;
+	++rdg->nfrags;
+	rdg->covered += size;
+	rdg->mem += fsize;
+	reass_stats.mem_used += fsize;
+	return EOK;
 }
 
+/** Insert fragment into datagram.
+ *
+ * Only the parts of the fragment not yet covered by previously received
+ * fragments are stored.
+ *
+ * @param rdg		Datagram reassembly structure
+ * @param packet	Fragment
+ * @return		EOK on success, ENOMEM if out of memory, EINVAL
+ *			if the fragment is inconsistent with the datagram or
+ *			ELIMIT if the datagram has too many fragments
+ */
 static errno_t reass_dgram_insert_frag(reass_dgram_t *rdg, inet_packet_t *packet)
 {
-	reass_frag_t *frag;
-	void *data_copy;
+	const uint8_t *data = packet->data;
+	size_t fragoff_limit;
+	size_t cur, end;
 	link_t *link;
+	errno_t rc;
 
 	assert(fibril_mutex_is_locked(&reass_dgram_map_lock));
 
-	frag = reass_frag_new();
+	cur = packet->offs;
+	end = packet->offs + packet->size;
 
-	/* Clone the packet */
+	/* Upper bound for fragment offset field */
+	fragoff_limit = 1 << (FF_FRAGOFF_h - FF_FRAGOFF_l + 1);
 
-	data_copy = malloc(packet->size);
-	if (data_copy == NULL) {
-		free(frag);
-		return ENOMEM;
-	}
+	/* Verify that total size of datagram is within reasonable bounds */
+	if (end > FRAG_OFFS_UNIT * fragoff_limit)
+		return EINVAL;
+
+	if (!packet->mf) {
+		/* Last fragment determines datagram size */
+		if (rdg->have_last && rdg->size != end)
+			return EINVAL;
+
+		link = list_last(&rdg->frags);
+		if (link != NULL) {
+			reass_frag_t *lf = list_get_instance(link,
+			    reass_frag_t, dgram_link);
+			if (lf->offs + lf->size > end)
+				return EINVAL;
+		}
 
-	memcpy(data_copy, packet->data, packet->size);
+		rdg->have_last = true;
+		rdg->size = end;
+	} else if (rdg->have_last && end > rdg->size) {
+		return EINVAL;
+	}
 
-	frag->packet = *packet;
-	frag->packet.data = data_copy;
+	if (cur == end)
+		return EOK;
 
-	/*
-	 * XXX Make resource-consuming attacks harder, eliminate any duplicate
-	 * data immediately. Possibly eliminate redundant packet headers.
-	 */
+	/* Fast path: fragments usually arrive in order, just append */
+	link = list_last(&rdg->frags);
+	if (link != NULL) {
+		reass_frag_t *lf = list_get_instance(link, reass_frag_t,
+		    dgram_link);
+		if (lf->offs + lf->size <= cur)
+			link = NULL;
+	}
 
-	/*
-	 * Insert into the list, which is sorted by offs member ascending.
-	 */
+	if (link == NULL)
+		return reass_dgram_insert_data(rdg, NULL, cur, data, end - cur);
 
+	/* Fill the gaps between existing intervals */
 	link = list_first(&rdg->frags);
-	while (link != NULL) {
+	while (link != NULL && cur < end) {
 		reass_frag_t *qf = list_get_instance(link, reass_frag_t,
 		    dgram_link);
 
-		if (qf->packet.offs >= packet->offs)
+		if (qf->offs >= end)
 			break;
 
+		if (qf->offs > cur) {
+			rc = reass_dgram_insert_data(rdg, qf, cur,
+			    data + (cur - packet->offs), qf->offs - cur);
+			if (rc != EOK)
+				return rc;
+		}
+
+		cur = max(cur, qf->offs + qf->size);
 		link = list_next(link, &rdg->frags);
 	}
 
-	if (link != NULL)
-		list_insert_after(&frag->dgram_link, link);
-	else
-		list_append(&frag->dgram_link, &rdg->frags);
+	if (cur < end) {
+		reass_frag_t *before = NULL;
+		if (link != NULL)
+			before = list_get_instance(link, reass_frag_t,
+			    dgram_link);
+
+		return reass_dgram_insert_data(rdg, before, cur,
+		    data + (cur - packet->offs), end - cur);
+	}
 
 	return EOK;
 }
@@ -237,42 +568,10 @@ static errno_t reass_dgram_insert_frag(reass_dgram_t *rdg, inet_packet_t *packet
  */
 static bool reass_dgram_complete(reass_dgram_t *rdg)
 {
-	reass_frag_t *frag, *prev;
-	link_t *link;
-
 	assert(fibril_mutex_is_locked(&reass_dgram_map_lock));
-	assert(!list_empty(&rdg->frags));
-
-	link = list_first(&rdg->frags);
-	assert(link != NULL);
-
-	frag = list_get_instance(link, reass_frag_t,
-	    dgram_link);
-
-	/* First fragment must be at offset zero */
-	if (frag->packet.offs != 0)
-		return false;
-
-	prev = frag;
-
-	while (true) {
-		link = list_next(link, &rdg->frags);
-		if (link == NULL)
-			break;
-
-		/* Each next fragment must follow immediately or overlap */
-		frag = list_get_instance(link, reass_frag_t, dgram_link);
-		if (frag->packet.offs > prev->packet.offs + prev->packet.size)
-			return false;
-
-		/* No more fragments - datagram is complete */
-		if (!frag->packet.mf)
-			return true;
-
-		prev = frag;
-	}
 
-	return false;
+	/* Intervals do not overlap, so coverage of all bytes means done */
+	return rdg->have_last && rdg->covered == rdg->size;
 }
 
 /** Remove datagram from reassembly map.
@@ -282,7 +581,8 @@ static bool reass_dgram_complete(reass_dgram_t *rdg)
 static void reass_dgram_remove(reass_dgram_t *rdg)
 {
 	assert(fibril_mutex_is_locked(&reass_dgram_map_lock));
-	list_remove(&rdg->map_link);
+	hash_table_remove_item(&reass_dgram_map, &rdg->map_link);
+	list_remove(&rdg->lru_link);
 }
 
 /** Deliver complete datagram.
@@ -291,70 +591,30 @@ static void reass_dgram_remove(reass_dgram_t *rdg)
  */
 static errno_t reass_dgram_deliver(reass_dgram_t *rdg)
 {
-	size_t dgram_size;
-	size_t fragoff_limit;
 	inet_dgram_t dgram;
-	uint8_t proto;
-	reass_frag_t *frag;
 	errno_t rc;
 
-	/*
-	 * Potentially there could be something beyond the first packet
-	 * that has !MF. Make sure we ignore that.
-	 */
-	frag = NULL;
-	list_foreach(rdg->frags, dgram_link, reass_frag_t, cfrag) {
-		if (!cfrag->packet.mf) {
-			frag = cfrag;
-			break;
-		}
-	}
-
-	assert(frag != NULL);
-	assert(!frag->packet.mf);
-
-	dgram_size = frag->packet.offs + frag->packet.size;
-
-	/* Upper bound for fragment offset field */
-	fragoff_limit = 1 << (FF_FRAGOFF_h - FF_FRAGOFF_l + 1);
+	assert(rdg->have_last);
 
-	/* Verify that total size of datagram is within reasonable bounds */
-	if (dgram_size > FRAG_OFFS_UNIT * fragoff_limit)
-		return ELIMIT;
-
-	dgram.data = calloc(dgram_size, 1);
+	dgram.data = malloc(rdg->size);
 	if (dgram.data == NULL)
 		return ENOMEM;
 
 	/* XXX What if different fragments came from different link? */
-	dgram.iplink = frag->packet.link_id;
-	dgram.size = dgram_size;
-	dgram.src = frag->packet.src;
-	dgram.dest = frag->packet.dest;
-	dgram.tos = frag->packet.tos;
-	proto = frag->packet.proto;
+	dgram.iplink = rdg->link_id;
+	dgram.size = rdg->size;
+	dgram.src = rdg->key.src;
+	dgram.dest = rdg->key.dest;
+	dgram.tos = rdg->tos;
 
 	/* Pull together data from individual fragments */
-
-	size_t doffs = 0;
-
-	list_foreach(rdg->frags, dgram_link, reass_frag_t, cfrag) {
-		size_t cb, ce;
-
-		cb = max(doffs, cfrag->packet.offs);
-		ce = min(dgram_size, cfrag->packet.offs + cfrag->packet.size);
-
-		if (ce > cb) {
-			memcpy(dgram.data + cb,
-			    cfrag->packet.data + cb - cfrag->packet.offs,
-			    ce - cb);
-		}
-
-		if (!cfrag->packet.mf)
-			break;
+	list_foreach(rdg->frags, dgram_link, reass_frag_t, frag) {
+		assert(frag->offs + frag->size <= rdg->size);
+		memcpy((uint8_t *) dgram.data + frag->offs, frag->data,
+		    frag->size);
 	}
 
-	rc = inet_recv_dgram_local(&dgram, proto);
+	rc = inet_recv_dgram_local(&dgram, rdg->key.proto);
 	free(dgram.data);
 	return rc;
 }
@@ -365,16 +625,19 @@ static errno_t reass_dgram_deliver(reass_dgram_t *rdg)
  */
 static void reass_dgram_destroy(reass_dgram_t *rdg)
 {
+	assert(fibril_mutex_is_locked(&reass_dgram_map_lock));
+
 	while (!list_empty(&rdg->frags)) {
 		link_t *flink = list_first(&rdg->frags);
 		reass_frag_t *frag = list_get_instance(flink, reass_frag_t,
 		    dgram_link);
 
 		list_remove(&frag->dgram_link);
-		free(frag->packet.data);
 		free(frag);
 	}
 
+	reass_stats.mem_used -= rdg->mem;
+	--reass_stats.dgrams;
 	free(rdg);
 }
 
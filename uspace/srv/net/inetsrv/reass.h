@@ -37,9 +37,29 @@
 #ifndef INET_REASS_H_
 #define INET_REASS_H_
 
+#include <stddef.h>
+#include <stdint.h>
 #include "inetsrv.h"
 
+/** Maximum memory used by datagrams being reassembled (bytes) */
+#define INET_REASS_MEM_MAX (1024 * 1024)
+
+/** Datagram reassembly statistics */
+typedef struct {
+	/** Number of datagrams being reassembled */
+	size_t dgrams;
+	/** Memory used by datagrams being reassembled */
+	size_t mem_used;
+	/** Datagrams dropped because reassembly timed out */
+	uint64_t timeouts;
+	/** Datagrams dropped to stay within the memory limit */
+	uint64_t evictions;
+} inet_reass_stats_t;
+
+extern errno_t inet_reass_init(void);
 extern errno_t inet_reass_queue_packet(inet_packet_t *);
+extern void inet_reass_fini(void);
+extern void inet_reass_get_stats(inet_reass_stats_t *);
 
 #endif
 
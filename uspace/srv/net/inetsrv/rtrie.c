@@ -0,0 +1,386 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup inet
+ * @{
+ */
+/**
+ * @file
+ * @brief Routing trie
+ *
+ * Path-compressed binary (Patricia) trie for longest-prefix-match lookup
+ * of IPv4 and IPv6 network prefixes. Lookup cost depends only on the
+ * address length, not on the number of prefixes stored. Multiple entries
+ * with the same prefix are kept in insertion order and the oldest one
+ * is returned by lookup.
+ */
+
+#include <adt/list.h>
+#include <assert.h>
+#include <errno.h>
+#include <inet/addr.h>
+#include <mem.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include "rtrie.h"
+
+/** Get bit of a key.
+ *
+ * @param key Key
+ * @param pos Bit position, counted from the most significant bit
+ * @return Bit value
+ */
+static unsigned inet_rtrie_bit(const addr128_t key, uint8_t pos)
+{
+	return (key[pos / 8] >> (7 - pos % 8)) & 1;
+}
+
+/** Determine length of common prefix of two keys.
+ *
+ * @param a First key
+ * @param b Second key
+ * @param max Maximum number of bits to compare
+ * @return Number of leading bits in which @a a and @a b agree, at most @a max
+ */
+static uint8_t inet_rtrie_common(const addr128_t a, const addr128_t b,
+    uint8_t max)
+{
+	unsigned n = 0;
+	size_t i = 0;
+	uint8_t x;
+
+	while (n < max) {
+		x = a[i] ^ b[i];
+		if (x != 0) {
+			while ((x & 0x80) == 0) {
+				x <<= 1;
+				++n;
+			}
+
+			return n < max ? n : max;
+		}
+
+		n += 8;
+		++i;
+	}
+
+	return max;
+}
+
+/** Determine if key matches node prefix.
+ *
+ * @param key Key
+ * @param node Node
+ * @return @c true iff the first @c node->plen bits of @a key are equal
+ *         to the prefix of @a node
+ */
+static bool inet_rtrie_match(const addr128_t key, inet_rtrie_node_t *node)
+{
+	size_t nbytes = node->plen / 8;
+	unsigned rbits = node->plen % 8;
+	uint8_t mask;
+
+	if (memcmp(key, node->key, nbytes) != 0)
+		return false;
+
+	if (rbits == 0)
+		return true;
+
+	mask = 0xff << (8 - rbits);
+	return (key[nbytes] & mask) == node->key[nbytes];
+}
+
+/** Convert address to trie key.
+ *
+ * @param rt Routing trie
+ * @param addr Address
+ * @param key Place to store key
+ * @param rlen Place to store address length in bits
+ * @return Pointer to root of the trie for the address family or @c NULL
+ *         if the address family is not supported
+ */
+static inet_rtrie_node_t **inet_rtrie_addr_key(inet_rtrie_t *rt,
+    const inet_addr_t *addr, addr128_t key, uint8_t *rlen)
+{
+	addr32_t a4;
+
+	switch (addr->version) {
+	case ip_v4:
+		a4 = addr->addr;
+		memset(key, 0, sizeof(addr128_t));
+		key[0] = (a4 >> 24) & 0xff;
+		key[1] = (a4 >> 16) & 0xff;
+		key[2] = (a4 >> 8) & 0xff;
+		key[3] = a4 & 0xff;
+		*rlen = 32;
+		return &rt->root4;
+	case ip_v6:
+		memcpy(key, addr->addr6, sizeof(addr128_t));
+		*rlen = 128;
+		return &rt->root6;
+	default:
+		return NULL;
+	}
+}
+
+/** Create trie node.
+ *
+ * @param key Key (bits beyond @a plen are ignored)
+ * @param plen Prefix length
+ * @return New node or @c NULL if out of memory
+ */
+static inet_rtrie_node_t *inet_rtrie_node_new(const addr128_t key,
+    uint8_t plen)
+{
+	inet_rtrie_node_t *node;
+	size_t nbytes = plen / 8;
+	unsigned rbits = plen % 8;
+
+	node = calloc(1, sizeof(inet_rtrie_node_t));
+	if (node == NULL)
+		return NULL;
+
+	memcpy(node->key, key, nbytes);
+	if (rbits != 0)
+		node->key[nbytes] = key[nbytes] & (0xff << (8 - rbits));
+
+	node->plen = plen;
+	list_initialize(&node->entries);
+	return node;
+}
+
+/** Get pointer to the link pointing to a node.
+ *
+ * @param rt Routing trie
+ * @param node Node
+ * @return Pointer to parent's child pointer or trie root pointer
+ */
+static inet_rtrie_node_t **inet_rtrie_node_link(inet_rtrie_t *rt,
+    inet_rtrie_node_t *node)
+{
+	inet_rtrie_node_t *parent = node->parent;
+
+	if (parent == NULL)
+		return rt->root4 == node ? &rt->root4 : &rt->root6;
+
+	return parent->child[0] == node ? &parent->child[0] :
+	    &parent->child[1];
+}
+
+/** Initialize routing trie.
+ *
+ * @param rt Routing trie
+ */
+void inet_rtrie_init(inet_rtrie_t *rt)
+{
+	rt->root4 = NULL;
+	rt->root6 = NULL;
+	rt->count = 0;
+}
+
+/** Finalize routing trie.
+ *
+ * @param rt Routing trie, must be empty
+ */
+void inet_rtrie_fini(inet_rtrie_t *rt)
+{
+	assert(rt->count == 0);
+	assert(rt->root4 == NULL);
+	assert(rt->root6 == NULL);
+}
+
+/** Insert entry into routing trie.
+ *
+ * @param rt Routing trie
+ * @param naddr Network address (prefix) of the entry
+ * @param entry Entry
+ * @param arg Argument returned by inet_rtrie_lookup() for this entry
+ * @return EOK on success, EINVAL if @a naddr is not valid, ENOMEM if
+ *         out of memory
+ */
+errno_t inet_rtrie_insert(inet_rtrie_t *rt, const inet_naddr_t *naddr,
+    inet_rtrie_entry_t *entry, void *arg)
+{
+	inet_rtrie_node_t **pp;
+	inet_rtrie_node_t *parent;
+	inet_rtrie_node_t *node;
+	inet_rtrie_node_t *nnode;
+	inet_rtrie_node_t *bnode;
+	inet_addr_t addr;
+	addr128_t key;
+	uint8_t alen;
+	uint8_t plen;
+	uint8_t common;
+
+	inet_naddr_addr(naddr, &addr);
+	pp = inet_rtrie_addr_key(rt, &addr, key, &alen);
+	if (pp == NULL)
+		return EINVAL;
+
+	plen = naddr->prefix;
+	if (plen > alen)
+		return EINVAL;
+
+	parent = NULL;
+	while (*pp != NULL) {
+		node = *pp;
+		common = inet_rtrie_common(key, node->key,
+		    plen < node->plen ? plen : node->plen);
+
+		if (common == node->plen) {
+			if (node->plen == plen)
+				goto found;
+
+			/* Node prefix is a prefix of the new one, descend */
+			parent = node;
+			pp = &node->child[inet_rtrie_bit(key, node->plen)];
+			continue;
+		}
+
+		nnode = inet_rtrie_node_new(key, plen);
+		if (nnode == NULL)
+			return ENOMEM;
+
+		if (common == plen) {
+			/* New prefix is a prefix of node, insert above it */
+			nnode->child[inet_rtrie_bit(node->key, plen)] = node;
+			nnode->parent = parent;
+			node->parent = nnode;
+			*pp = nnode;
+			node = nnode;
+			goto found;
+		}
+
+		/* Prefixes diverge at bit @c common, add branch node */
+		bnode = inet_rtrie_node_new(key, common);
+		if (bnode == NULL) {
+			free(nnode);
+			return ENOMEM;
+		}
+
+		bnode->child[inet_rtrie_bit(key, common)] = nnode;
+		bnode->child[inet_rtrie_bit(node->key, common)] = node;
+		bnode->parent = parent;
+		nnode->parent = bnode;
+		node->parent = bnode;
+		*pp = bnode;
+		node = nnode;
+		goto found;
+	}
+
+	node = inet_rtrie_node_new(key, plen);
+	if (node == NULL)
+		return ENOMEM;
+
+	node->parent = parent;
+	*pp = node;
+found:
+	entry->node = node;
+	entry->arg = arg;
+	list_append(&entry->lentries, &node->entries);
+	++rt->count;
+	return EOK;
+}
+
+/** Remove entry from routing trie.
+ *
+ * Nodes that are no longer needed are freed.
+ *
+ * @param rt Routing trie
+ * @param entry Entry previously inserted using inet_rtrie_insert()
+ */
+void inet_rtrie_remove(inet_rtrie_t *rt, inet_rtrie_entry_t *entry)
+{
+	inet_rtrie_node_t *node = entry->node;
+	inet_rtrie_node_t *parent;
+	inet_rtrie_node_t *child;
+
+	assert(node != NULL);
+
+	list_remove(&entry->lentries);
+	entry->node = NULL;
+	--rt->count;
+
+	/* Remove nodes that neither hold entries nor branch */
+	while (node != NULL && list_empty(&node->entries) &&
+	    (node->child[0] == NULL || node->child[1] == NULL)) {
+		child = node->child[0] != NULL ? node->child[0] :
+		    node->child[1];
+		parent = node->parent;
+
+		*inet_rtrie_node_link(rt, node) = child;
+		if (child != NULL)
+			child->parent = parent;
+
+		free(node);
+		node = parent;
+	}
+}
+
+/** Look up longest prefix matching an address.
+ *
+ * @param rt Routing trie
+ * @param addr Address
+ * @return Argument of the entry with the longest matching prefix or
+ *         @c NULL if there is no match
+ */
+void *inet_rtrie_lookup(inet_rtrie_t *rt, const inet_addr_t *addr)
+{
+	inet_rtrie_node_t **root;
+	inet_rtrie_node_t *node;
+	inet_rtrie_node_t *best;
+	inet_rtrie_entry_t *entry;
+	addr128_t key;
+	uint8_t alen;
+
+	root = inet_rtrie_addr_key(rt, addr, key, &alen);
+	if (root == NULL)
+		return NULL;
+
+	best = NULL;
+	node = *root;
+	while (node != NULL && inet_rtrie_match(key, node)) {
+		if (!list_empty(&node->entries))
+			best = node;
+
+		if (node->plen >= alen)
+			break;
+
+		node = node->child[inet_rtrie_bit(key, node->plen)];
+	}
+
+	if (best == NULL)
+		return NULL;
+
+	entry = list_get_instance(list_first(&best->entries),
+	    inet_rtrie_entry_t, lentries);
+	return entry->arg;
+}
+
+/** @}
+ */
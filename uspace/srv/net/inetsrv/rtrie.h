@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup inet
+ * @{
+ */
+/**
+ * @file
+ * @brief Routing trie
+ */
+
+#ifndef INET_RTRIE_H_
+#define INET_RTRIE_H_
+
+#include <adt/list.h>
+#include <errno.h>
+#include <inet/addr.h>
+#include <stdint.h>
+
+/** Routing trie node.
+ *
+ * Path-compressed binary trie node. Only nodes that have entries or
+ * two children exist, so the depth of the trie is bounded by the
+ * address length regardless of the number of prefixes.
+ */
+typedef struct inet_rtrie_node {
+	/** Parent node or @c NULL for root */
+	struct inet_rtrie_node *parent;
+	/** Children, indexed by bit @c plen of the key */
+	struct inet_rtrie_node *child[2];
+	/** Prefix (network byte order, bits beyond @c plen are zero) */
+	addr128_t key;
+	/** Prefix length in bits */
+	uint8_t plen;
+	/** Entries with this exact prefix (inet_rtrie_entry_t) */
+	list_t entries;
+} inet_rtrie_node_t;
+
+/** Routing trie entry.
+ *
+ * Embedded in the object that is being looked up.
+ */
+typedef struct {
+	/** Link to inet_rtrie_node_t.entries */
+	link_t lentries;
+	/** Node containing this entry or @c NULL if not inserted */
+	inet_rtrie_node_t *node;
+	/** User argument returned by lookup */
+	void *arg;
+} inet_rtrie_entry_t;
+
+/** Routing trie.
+ *
+ * Maps IPv4 and IPv6 network prefixes to entries and supports
+ * longest-prefix-match lookup.
+ */
+typedef struct {
+	/** Root of IPv4 trie */
+	inet_rtrie_node_t *root4;
+	/** Root of IPv6 trie */
+	inet_rtrie_node_t *root6;
+	/** Number of entries */
+	size_t count;
+} inet_rtrie_t;
+
+extern void inet_rtrie_init(inet_rtrie_t *);
+extern void inet_rtrie_fini(inet_rtrie_t *);
+extern errno_t inet_rtrie_insert(inet_rtrie_t *, const inet_naddr_t *,
+    inet_rtrie_entry_t *, void *);
+extern void inet_rtrie_remove(inet_rtrie_t *, inet_rtrie_entry_t *);
+extern void *inet_rtrie_lookup(inet_rtrie_t *, const inet_addr_t *);
+
+#endif
+
+/** @}
+ */
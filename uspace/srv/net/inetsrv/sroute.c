@@ -34,6 +34,8 @@
  * @brief
  */
 
+#include <adt/hash.h>
+#include <assert.h>
 #include <bitops.h>
 #include <errno.h>
 #include <fibril_synch.h>
@@ -46,11 +48,71 @@
 #include "sroute.h"
 #include "inetsrv.h"
 #include "inet_link.h"
+#include "rtrie.h"
+
+/** Number of entries in the route cache (power of two) */
+#define SROUTE_CACHE_SIZE 64
+
+/** Route cache entry */
+typedef struct {
+	/** Destination address */
+	inet_addr_t addr;
+	/** Route to destination or @c NULL if there is none */
+	inet_sroute_t *sroute;
+	/** Entry is valid */
+	bool valid;
+} inet_sroute_cache_ent_t;
 
 static FIBRIL_MUTEX_INITIALIZE(sroute_list_lock);
 static LIST_INITIALIZE(sroute_list);
 static sysarg_t sroute_id = 0;
 
+/** Routing trie indexing static routes by destination network */
+static inet_rtrie_t sroute_trie;
+/** Direct-mapped cache of recent destinations */
+static inet_sroute_cache_ent_t sroute_cache[SROUTE_CACHE_SIZE];
+
+/** Invalidate route cache.
+ *
+ * Must be called whenever the set of routes changes.
+ */
+static void inet_sroute_cache_flush(void)
+{
+	size_t i;
+
+	assert(fibril_mutex_is_locked(&sroute_list_lock));
+
+	for (i = 0; i < SROUTE_CACHE_SIZE; i++)
+		sroute_cache[i].valid = false;
+}
+
+/** Get route cache entry for destination address.
+ *
+ * @param addr Destination address
+ * @return Cache entry the address maps to
+ */
+static inet_sroute_cache_ent_t *inet_sroute_cache_ent(inet_addr_t *addr)
+{
+	uint32_t h;
+	size_t i;
+
+	switch (addr->version) {
+	case ip_v4:
+		h = addr->addr;
+		break;
+	case ip_v6:
+		h = 0;
+		for (i = 0; i < 16; i++)
+			h = (h << 5) ^ (h >> 27) ^ addr->addr6[i];
+		break;
+	default:
+		h = 0;
+		break;
+	}
+
+	return &sroute_cache[hash_mix32(h) & (SROUTE_CACHE_SIZE - 1)];
+}
+
 inet_sroute_t *inet_sroute_new(void)
 {
 	inet_sroute_t *sroute = calloc(1, sizeof(inet_sroute_t));
@@ -76,57 +138,66 @@ void inet_sroute_delete(inet_sroute_t *sroute)
 	free(sroute);
 }
 
-void inet_sroute_add(inet_sroute_t *sroute)
+errno_t inet_sroute_add(inet_sroute_t *sroute)
 {
+	errno_t rc;
+
 	fibril_mutex_lock(&sroute_list_lock);
+
+	rc = inet_rtrie_insert(&sroute_trie, &sroute->dest,
+	    &sroute->rtrie_entry, sroute);
+	if (rc != EOK) {
+		fibril_mutex_unlock(&sroute_list_lock);
+		return rc;
+	}
+
 	list_append(&sroute->sroute_list, &sroute_list);
+	inet_sroute_cache_flush();
 	fibril_mutex_unlock(&sroute_list_lock);
+
+	return EOK;
 }
 
 void inet_sroute_remove(inet_sroute_t *sroute)
 {
 	fibril_mutex_lock(&sroute_list_lock);
+	inet_rtrie_remove(&sroute_trie, &sroute->rtrie_entry);
 	list_remove(&sroute->sroute_list);
+	inet_sroute_cache_flush();
 	fibril_mutex_unlock(&sroute_list_lock);
 }
 
 /** Find static route object matching address @a addr.
+ *
+ * Returns the most specific route. Recent destinations are served from
+ * the route cache, otherwise the routing trie is consulted.
  *
  * @param addr	Address
  */
 inet_sroute_t *inet_sroute_find(inet_addr_t *addr)
 {
-	ip_ver_t addr_ver = inet_addr_get(addr, NULL, NULL);
-
-	inet_sroute_t *best = NULL;
-	uint8_t best_bits = 0;
+	inet_sroute_cache_ent_t *ent;
+	inet_sroute_t *best;
 
 	fibril_mutex_lock(&sroute_list_lock);
 
-	list_foreach(sroute_list, sroute_list, inet_sroute_t, sroute) {
-		uint8_t dest_bits;
-		ip_ver_t dest_ver = inet_naddr_get(&sroute->dest, NULL, NULL,
-		    &dest_bits);
+	ent = inet_sroute_cache_ent(addr);
+	if (ent->valid && inet_addr_compare(&ent->addr, addr)) {
+		best = ent->sroute;
+	} else {
+		best = inet_rtrie_lookup(&sroute_trie, addr);
 
-		/* Skip comparison with different address family */
-		if (addr_ver != dest_ver)
-			continue;
-
-		/* Look for the most specific route */
-		if ((best != NULL) && (best_bits >= dest_bits))
-			continue;
-
-		if (inet_naddr_compare_mask(&sroute->dest, addr)) {
-			log_msg(LOG_DEFAULT, LVL_DEBUG, "inet_sroute_find: found candidate %p",
-			    sroute);
-
-			best = sroute;
-			best_bits = dest_bits;
-		}
+		ent->addr = *addr;
+		ent->sroute = best;
+		ent->valid = true;
 	}
 
-	if (best == NULL)
+	if (best != NULL) {
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "inet_sroute_find: found %p",
+		    best);
+	} else {
 		log_msg(LOG_DEFAULT, LVL_DEBUG, "inet_sroute_find: Not found");
+	}
 
 	fibril_mutex_unlock(&sroute_list_lock);
 
@@ -271,7 +342,12 @@ static errno_t inet_sroute_load(sif_node_t *nroute)
 		return ENOMEM;
 	}
 
-	inet_sroute_add(sroute);
+	rc = inet_sroute_add(sroute);
+	if (rc != EOK) {
+		inet_sroute_delete(sroute);
+		return rc;
+	}
+
 	return EOK;
 }
 
@@ -0,0 +1,374 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <fibril.h>
+#include <inet/addr.h>
+#include <inet/eth_addr.h>
+#include <pcut/pcut.h>
+#include <stdbool.h>
+#include "../ntrans.h"
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(ntrans);
+
+enum {
+	/** Timeout of waiters that should be woken up (microseconds) */
+	test_long_timeout = 10000000,
+	/** Timeout of lookups that should fail (microseconds) */
+	test_short_timeout = 1000
+};
+
+/** Fibril waiting for address resolution */
+typedef struct {
+	/** Address to resolve */
+	addr128_t ip_addr;
+	/** Resolved MAC address */
+	eth_addr_t mac_addr;
+	/** Return value of ntrans_lookup_timeout() */
+	errno_t rc;
+	/** Set when ntrans_lookup_timeout() returned */
+	bool done;
+} test_waiter_t;
+
+PCUT_TEST_BEFORE
+{
+	PCUT_ASSERT_ERRNO_VAL(EOK, ntrans_init());
+}
+
+PCUT_TEST_AFTER
+{
+	ntrans_fini();
+}
+
+/** Set @a ip_addr to link-local IPv6 address with host part @a n. */
+static void test_addr(uint32_t n, addr128_t ip_addr)
+{
+	addr128_t a = {
+		0xfe, 0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+		n >> 24, (n >> 16) & 0xff, (n >> 8) & 0xff, n & 0xff
+	};
+
+	addr128(a, ip_addr);
+}
+
+/** Set @a mac_addr to locally administered MAC address number @a n. */
+static void test_mac(uint32_t n, eth_addr_t *mac_addr)
+{
+	mac_addr->a = ((uint64_t) 0x02 << 40) | n;
+}
+
+static errno_t test_waiter_fibril(void *arg)
+{
+	test_waiter_t *waiter = (test_waiter_t *) arg;
+
+	waiter->rc = ntrans_lookup_timeout(waiter->ip_addr, test_long_timeout,
+	    &waiter->mac_addr);
+	waiter->done = true;
+	return EOK;
+}
+
+/** Start @a count fibrils waiting for resolution of @a ip_addr. */
+static void test_waiters_start(test_waiter_t *waiters, unsigned count,
+    addr128_t ip_addr)
+{
+	fid_t fid;
+	unsigned i;
+
+	for (i = 0; i < count; i++) {
+		addr128(ip_addr, waiters[i].ip_addr);
+		waiters[i].rc = EINVAL;
+		waiters[i].done = false;
+
+		fid = fibril_create(test_waiter_fibril, &waiters[i]);
+		PCUT_ASSERT_FALSE(fid == 0);
+		fibril_start(fid);
+
+		/* Let the fibril block waiting for resolution */
+		fibril_yield();
+		PCUT_ASSERT_FALSE(waiters[i].done);
+	}
+}
+
+/** Wait until all @a count waiters returned. */
+static void test_waiters_join(test_waiter_t *waiters, unsigned count)
+{
+	unsigned i;
+
+	for (i = 0; i < count; i++) {
+		while (!waiters[i].done)
+			fibril_yield();
+	}
+}
+
+/** Added entry can be looked up and removed */
+PCUT_TEST(add_remove)
+{
+	addr128_t ip;
+	eth_addr_t mac, res;
+	bool probe;
+
+	test_addr(1, ip);
+	test_mac(1, &mac);
+
+	PCUT_ASSERT_ERRNO_VAL(ENOENT, ntrans_lookup(ip, &res));
+	PCUT_ASSERT_ERRNO_VAL(EOK, ntrans_add(ip, &mac));
+
+	PCUT_ASSERT_ERRNO_VAL(EOK, ntrans_lookup(ip, &res));
+	PCUT_ASSERT_EQUALS(0, eth_addr_compare(&mac, &res));
+
+	PCUT_ASSERT_ERRNO_VAL(EOK, ntrans_query(ip, &res, &probe));
+	PCUT_ASSERT_FALSE(probe);
+	PCUT_ASSERT_EQUALS(0, eth_addr_compare(&mac, &res));
+
+	PCUT_ASSERT_ERRNO_VAL(EOK, ntrans_remove(ip));
+	PCUT_ASSERT_ERRNO_VAL(ENOENT, ntrans_lookup(ip, &res));
+	PCUT_ASSERT_ERRNO_VAL(ENOENT, ntrans_remove(ip));
+}
+
+/** Concurrent queries for an unresolved address send a single probe */
+PCUT_TEST(query_incomplete)
+{
+	addr128_t ip;
+	eth_addr_t mac, res;
+	bool probe;
+
+	test_addr(1, ip);
+	test_mac(1, &mac);
+
+	PCUT_ASSERT_ERRNO_VAL(EAGAIN, ntrans_query(ip, &res, &probe));
+	PCUT_ASSERT_TRUE(probe);
+	PCUT_ASSERT_ERRNO_VAL(EAGAIN, ntrans_query(ip, &res, &probe));
+	PCUT_ASSERT_FALSE(probe);
+	PCUT_ASSERT_ERRNO_VAL(ENOENT, ntrans_lookup(ip, &res));
+
+	PCUT_ASSERT_ERRNO_VAL(EOK, ntrans_add(ip, &mac));
+	PCUT_ASSERT_ERRNO_VAL(EOK, ntrans_query(ip, &res, &probe));
+	PCUT_ASSERT_FALSE(probe);
+	PCUT_ASSERT_EQUALS(0, eth_addr_compare(&mac, &res));
+}
+
+/** Failed resolution is remembered until the negative entry expires */
+PCUT_TEST(negative_expiry)
+{
+	addr128_t ip;
+	eth_addr_t res;
+	bool probe;
+
+	test_addr(1, ip);
+
+	PCUT_ASSERT_ERRNO_VAL(EAGAIN, ntrans_query(ip, &res, &probe));
+	PCUT_ASSERT_TRUE(probe);
+	PCUT_ASSERT_ERRNO_VAL(ENOENT,
+	    ntrans_lookup_timeout(ip, test_short_timeout, &res));
+
+	/* Fail fast without sending another probe */
+	PCUT_ASSERT_ERRNO_VAL(ENOENT, ntrans_query(ip, &res, &probe));
+	PCUT_ASSERT_FALSE(probe);
+	PCUT_ASSERT_ERRNO_VAL(ENOENT,
+	    ntrans_lookup_timeout(ip, test_long_timeout, &res));
+
+	ntrans_clock_advance(SEC2NSEC(NTRANS_FAILED_TIME + 1));
+	PCUT_ASSERT_ERRNO_VAL(EAGAIN, ntrans_query(ip, &res, &probe));
+	PCUT_ASSERT_TRUE(probe);
+}
+
+/** Entry becomes stale, is re-probed and is eventually discarded */
+PCUT_TEST(stale_expiry)
+{
+	addr128_t ip;
+	eth_addr_t mac, res;
+	bool probe;
+
+	test_addr(1, ip);
+	test_mac(1, &mac);
+
+	PCUT_ASSERT_ERRNO_VAL(EOK, ntrans_add(ip, &mac));
+
+	/* Stale entry is still used, but confirmed */
+	ntrans_clock_advance(SEC2NSEC(NTRANS_REACHABLE_TIME + 1));
+	PCUT_ASSERT_ERRNO_VAL(EOK, ntrans_query(ip, &res, &probe));
+	PCUT_ASSERT_TRUE(probe);
+	PCUT_ASSERT_EQUALS(0, eth_addr_compare(&mac, &res));
+
+	/* No other probe within the probe interval */
+	PCUT_ASSERT_ERRNO_VAL(EOK, ntrans_query(ip, &res, &probe));
+	PCUT_ASSERT_FALSE(probe);
+
+	ntrans_clock_advance(SEC2NSEC(NTRANS_PROBE_INTERVAL + 1));
+	PCUT_ASSERT_ERRNO_VAL(EOK, ntrans_query(ip, &res, &probe));
+	PCUT_ASSERT_TRUE(probe);
+
+	/* Confirmation makes the entry reachable again */
+	PCUT_ASSERT_ERRNO_VAL(EOK, ntrans_add(ip, &mac));
+	PCUT_ASSERT_ERRNO_VAL(EOK, ntrans_query(ip, &res, &probe));
+	PCUT_ASSERT_FALSE(probe);
+
+	/* Unconfirmed stale entry is discarded */
+	ntrans_clock_advance(SEC2NSEC(NTRANS_REACHABLE_TIME + 1));
+	PCUT_ASSERT_ERRNO_VAL(EOK, ntrans_query(ip, &res, &probe));
+	PCUT_ASSERT_TRUE(probe);
+
+	ntrans_clock_advance(SEC2NSEC(NTRANS_STALE_TIME));
+	PCUT_ASSERT_ERRNO_VAL(EAGAIN, ntrans_query(ip, &res, &probe));
+	PCUT_ASSERT_TRUE(probe);
+	PCUT_ASSERT_ERRNO_VAL(ENOENT, ntrans_lookup(ip, &res));
+}
+
+/** Least recently updated entry is evicted when the table is full */
+PCUT_TEST(evict)
+{
+	addr128_t ip;
+	eth_addr_t mac, res;
+	uint32_t i;
+
+	for (i = 0; i < NTRANS_MAX_ENTRIES; i++) {
+		test_addr(i, ip);
+		test_mac(i, &mac);
+		PCUT_ASSERT_ERRNO_VAL(EOK, ntrans_add(ip, &mac));
+	}
+
+	/* Refresh entry 0 so that entry 1 is the oldest */
+	test_addr(0, ip);
+	test_mac(0, &mac);
+	PCUT_ASSERT_ERRNO_VAL(EOK, ntrans_add(ip, &mac));
+
+	test_addr(NTRANS_MAX_ENTRIES, ip);
+	test_mac(NTRANS_MAX_ENTRIES, &mac);
+	PCUT_ASSERT_ERRNO_VAL(EOK, ntrans_add(ip, &mac));
+
+	test_addr(1, ip);
+	PCUT_ASSERT_ERRNO_VAL(ENOENT, ntrans_lookup(ip, &res));
+
+	for (i = 0; i <= NTRANS_MAX_ENTRIES; i++) {
+		if (i == 1)
+			continue;
+
+		test_addr(i, ip);
+		test_mac(i, &mac);
+		PCUT_ASSERT_ERRNO_VAL(EOK, ntrans_lookup(ip, &res));
+		PCUT_ASSERT_EQUALS(0, eth_addr_compare(&mac, &res));
+	}
+}
+
+/** Entry that is being waited for is not evicted */
+PCUT_TEST(evict_skips_waited)
+{
+	test_waiter_t waiter;
+	addr128_t ip;
+	eth_addr_t mac, res;
+	bool probe;
+	uint32_t i;
+
+	test_addr(0, ip);
+	PCUT_ASSERT_ERRNO_VAL(EAGAIN, ntrans_query(ip, &res, &probe));
+	test_waiters_start(&waiter, 1, ip);
+
+	for (i = 1; i <= NTRANS_MAX_ENTRIES; i++) {
+		test_addr(i, ip);
+		test_mac(i, &mac);
+		PCUT_ASSERT_ERRNO_VAL(EOK, ntrans_add(ip, &mac));
+	}
+
+	/* Entry 1 was evicted instead of the waited-for entry 0 */
+	test_addr(1, ip);
+	PCUT_ASSERT_ERRNO_VAL(ENOENT, ntrans_lookup(ip, &res));
+
+	test_addr(0, ip);
+	PCUT_ASSERT_ERRNO_VAL(EAGAIN, ntrans_query(ip, &res, &probe));
+	PCUT_ASSERT_FALSE(probe);
+
+	test_mac(0, &mac);
+	PCUT_ASSERT_ERRNO_VAL(EOK, ntrans_add(ip, &mac));
+	test_waiters_join(&waiter, 1);
+
+	PCUT_ASSERT_ERRNO_VAL(EOK, waiter.rc);
+	PCUT_ASSERT_EQUALS(0, eth_addr_compare(&mac, &waiter.mac_addr));
+}
+
+/** Removing an entry fails resolution for all its waiters */
+PCUT_TEST(remove_waited)
+{
+	test_waiter_t waiters[3];
+	addr128_t ip;
+	eth_addr_t res;
+	bool probe;
+	unsigned i;
+
+	test_addr(1, ip);
+	PCUT_ASSERT_ERRNO_VAL(EAGAIN, ntrans_query(ip, &res, &probe));
+	test_waiters_start(waiters, 3, ip);
+
+	PCUT_ASSERT_ERRNO_VAL(EOK, ntrans_remove(ip));
+
+	/* Removed entry can no longer be found */
+	PCUT_ASSERT_ERRNO_VAL(ENOENT, ntrans_remove(ip));
+
+	test_waiters_join(waiters, 3);
+	for (i = 0; i < 3; i++)
+		PCUT_ASSERT_ERRNO_VAL(ENOENT, waiters[i].rc);
+
+	/* New resolution starts afresh */
+	PCUT_ASSERT_ERRNO_VAL(EAGAIN, ntrans_query(ip, &res, &probe));
+	PCUT_ASSERT_TRUE(probe);
+}
+
+/** Number of fibrils waiting for one address is limited */
+PCUT_TEST(waiter_limit)
+{
+	test_waiter_t waiters[NTRANS_MAX_PENDING];
+	addr128_t ip;
+	eth_addr_t mac, res;
+	bool probe;
+	unsigned i;
+
+	test_addr(1, ip);
+	test_mac(1, &mac);
+
+	PCUT_ASSERT_ERRNO_VAL(EAGAIN, ntrans_query(ip, &res, &probe));
+	test_waiters_start(waiters, NTRANS_MAX_PENDING, ip);
+
+	PCUT_ASSERT_ERRNO_VAL(ELIMIT,
+	    ntrans_lookup_timeout(ip, test_long_timeout, &res));
+
+	PCUT_ASSERT_ERRNO_VAL(EOK, ntrans_add(ip, &mac));
+	test_waiters_join(waiters, NTRANS_MAX_PENDING);
+
+	for (i = 0; i < NTRANS_MAX_PENDING; i++) {
+		PCUT_ASSERT_ERRNO_VAL(EOK, waiters[i].rc);
+		PCUT_ASSERT_EQUALS(0,
+		    eth_addr_compare(&mac, &waiters[i].mac_addr));
+	}
+
+	/* Resolved address is not subject to the limit */
+	PCUT_ASSERT_ERRNO_VAL(EOK,
+	    ntrans_lookup_timeout(ip, test_long_timeout, &res));
+}
+
+PCUT_EXPORT(ntrans);
@@ -0,0 +1,366 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <inet/addr.h>
+#include <io/log.h>
+#include <mem.h>
+#include <pcut/pcut.h>
+#include <stdlib.h>
+#include "../inetsrv.h"
+#include "../reass.h"
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(reass);
+
+enum {
+	/** Number of datagrams in the stress test */
+	test_ndgrams = 64,
+	/** Maximum datagram size in the stress test */
+	test_max_size = 8192,
+	/** Protocol number used in tests */
+	test_proto = 17
+};
+
+/** Number of datagrams delivered */
+static unsigned test_delivered;
+/** Number of delivered datagrams with wrong content */
+static unsigned test_corrupt;
+/** Size of the last datagram delivered */
+static size_t test_last_size;
+
+/** Test pattern byte at offset @a i of datagram with identification @a id */
+static uint8_t test_pattern(uint32_t id, size_t i)
+{
+	return (uint8_t) (id * 31 + i * 7 + (i >> 8));
+}
+
+/** Replaces the inetsrv function, verifies datagrams delivered. */
+errno_t inet_recv_dgram_local(inet_dgram_t *dgram, uint8_t proto)
+{
+	uint8_t *data = (uint8_t *) dgram->data;
+	uint32_t id = dgram->src.addr & 0xffff;
+	size_t i;
+
+	++test_delivered;
+	test_last_size = dgram->size;
+
+	if (proto != test_proto) {
+		++test_corrupt;
+		return EOK;
+	}
+
+	for (i = 0; i < dgram->size; i++) {
+		if (data[i] != test_pattern(id, i)) {
+			++test_corrupt;
+			break;
+		}
+	}
+
+	return EOK;
+}
+
+static uint32_t test_rand(uint32_t *seed)
+{
+	*seed = *seed * 1103515245 + 12345;
+	return *seed >> 8;
+}
+
+/** Fill in datagram fragment.
+ *
+ * @param packet Packet to fill in
+ * @param id Datagram identification (also encoded in the source address)
+ * @param buf Whole datagram data
+ * @param offs Fragment offset
+ * @param size Fragment size
+ * @param mf More fragments flag
+ */
+static void test_frag(inet_packet_t *packet, uint32_t id, uint8_t *buf,
+    size_t offs, size_t size, bool mf)
+{
+	memset(packet, 0, sizeof(inet_packet_t));
+	inet_addr(&packet->src, 10, 0, id >> 8, id & 0xff);
+	inet_addr(&packet->dest, 10, 0, 0, 1);
+	packet->proto = test_proto;
+	packet->ident = id;
+	packet->mf = mf;
+	packet->offs = offs;
+	packet->data = buf + offs;
+	packet->size = size;
+}
+
+/** Allocate datagram data filled with the test pattern. */
+static uint8_t *test_dgram_data(uint32_t id, size_t size)
+{
+	uint8_t *buf;
+	size_t i;
+
+	buf = malloc(size);
+	PCUT_ASSERT_NOT_NULL(buf);
+
+	for (i = 0; i < size; i++)
+		buf[i] = test_pattern(id, i);
+
+	return buf;
+}
+
+PCUT_TEST_BEFORE
+{
+	errno_t rc;
+
+	/* We will be calling functions that perform logging */
+	rc = log_init("test-inetsrv");
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = inet_reass_init();
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	test_delivered = 0;
+	test_corrupt = 0;
+	test_last_size = 0;
+}
+
+PCUT_TEST_AFTER
+{
+	inet_reass_fini();
+}
+
+/** Fragments arriving in order are reassembled */
+PCUT_TEST(in_order)
+{
+	inet_packet_t packet;
+	inet_reass_stats_t stats;
+	uint8_t *buf;
+	errno_t rc;
+
+	buf = test_dgram_data(1, 3000);
+
+	test_frag(&packet, 1, buf, 0, 1480, true);
+	rc = inet_reass_queue_packet(&packet);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	test_frag(&packet, 1, buf, 1480, 1480, true);
+	rc = inet_reass_queue_packet(&packet);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_INT_EQUALS(0, test_delivered);
+
+	test_frag(&packet, 1, buf, 2960, 40, false);
+	rc = inet_reass_queue_packet(&packet);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	PCUT_ASSERT_INT_EQUALS(1, test_delivered);
+	PCUT_ASSERT_INT_EQUALS(0, test_corrupt);
+	PCUT_ASSERT_INT_EQUALS(3000, test_last_size);
+
+	inet_reass_get_stats(&stats);
+	PCUT_ASSERT_INT_EQUALS(0, stats.dgrams);
+	PCUT_ASSERT_INT_EQUALS(0, stats.mem_used);
+
+	free(buf);
+}
+
+/** Reversed, overlapping and duplicate fragments are reassembled */
+PCUT_TEST(overlap)
+{
+	inet_packet_t packet;
+	uint8_t *buf;
+	errno_t rc;
+
+	buf = test_dgram_data(2, 4000);
+
+	test_frag(&packet, 2, buf, 3000, 1000, false);
+	rc = inet_reass_queue_packet(&packet);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	test_frag(&packet, 2, buf, 1000, 1000, true);
+	rc = inet_reass_queue_packet(&packet);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	/* Duplicate */
+	rc = inet_reass_queue_packet(&packet);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	/* Spans the gap and overlaps both neighbors */
+	test_frag(&packet, 2, buf, 800, 2400, true);
+	rc = inet_reass_queue_packet(&packet);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_INT_EQUALS(0, test_delivered);
+
+	test_frag(&packet, 2, buf, 0, 1600, true);
+	rc = inet_reass_queue_packet(&packet);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	PCUT_ASSERT_INT_EQUALS(1, test_delivered);
+	PCUT_ASSERT_INT_EQUALS(0, test_corrupt);
+	PCUT_ASSERT_INT_EQUALS(4000, test_last_size);
+
+	free(buf);
+}
+
+/** Conflicting last fragments cause the datagram to be dropped */
+PCUT_TEST(inconsistent)
+{
+	inet_packet_t packet;
+	inet_reass_stats_t stats;
+	uint8_t *buf;
+	errno_t rc;
+
+	buf = test_dgram_data(3, 2000);
+
+	test_frag(&packet, 3, buf, 1000, 1000, false);
+	rc = inet_reass_queue_packet(&packet);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	test_frag(&packet, 3, buf, 1000, 500, false);
+	rc = inet_reass_queue_packet(&packet);
+	PCUT_ASSERT_ERRNO_VAL(EINVAL, rc);
+
+	inet_reass_get_stats(&stats);
+	PCUT_ASSERT_INT_EQUALS(0, stats.dgrams);
+	PCUT_ASSERT_INT_EQUALS(0, test_delivered);
+
+	free(buf);
+}
+
+/** Oldest datagrams are dropped when the memory limit is reached */
+PCUT_TEST(mem_limit)
+{
+	inet_packet_t packet;
+	inet_reass_stats_t stats;
+	uint8_t *buf;
+	uint32_t id;
+	size_t n;
+	errno_t rc;
+
+	/* Enough incomplete datagrams to exceed the limit twice */
+	n = 2 * INET_REASS_MEM_MAX / 8192;
+	buf = test_dgram_data(n - 1, 8192 + 8);
+
+	for (id = 0; id < n; id++) {
+		test_frag(&packet, id, buf, 0, 8192, true);
+		rc = inet_reass_queue_packet(&packet);
+		PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	}
+
+	inet_reass_get_stats(&stats);
+	PCUT_ASSERT_TRUE(stats.mem_used <= INET_REASS_MEM_MAX);
+	PCUT_ASSERT_TRUE(stats.evictions > 0);
+	PCUT_ASSERT_INT_EQUALS(n, stats.dgrams + stats.evictions);
+
+	/* The newest datagram survived and can be completed */
+	test_frag(&packet, n - 1, buf, 8192, 8, false);
+	rc = inet_reass_queue_packet(&packet);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_INT_EQUALS(1, test_delivered);
+	PCUT_ASSERT_INT_EQUALS(0, test_corrupt);
+
+	free(buf);
+}
+
+/** Coverage of datagrams in the stress test, in fragment offset units */
+static bool test_covered[test_ndgrams][test_max_size / 8 + 1];
+
+/** Many interleaved datagrams, fragments in random order with duplicates */
+PCUT_TEST(stress)
+{
+	inet_packet_t packet;
+	inet_reass_stats_t stats;
+	uint8_t *buf[test_ndgrams];
+	size_t size[test_ndgrams];
+	bool done[test_ndgrams];
+	uint32_t seed = 42;
+	unsigned remaining;
+	uint32_t id;
+	size_t offs, fsize;
+	size_t nunits, u;
+	errno_t rc;
+
+	for (id = 0; id < test_ndgrams; id++) {
+		size[id] = 8 + test_rand(&seed) % test_max_size;
+		buf[id] = test_dgram_data(id, size[id]);
+		done[id] = false;
+		memset(test_covered[id], 0, sizeof(test_covered[id]));
+	}
+
+	remaining = test_ndgrams;
+	while (remaining > 0) {
+		id = test_rand(&seed) % test_ndgrams;
+		if (done[id])
+			continue;
+
+		/*
+		 * Random 8-byte aligned fragment. Mostly start at the first
+		 * missing piece to make progress, but also send duplicates.
+		 */
+		nunits = (size[id] + 7) / 8;
+		offs = 8 * (test_rand(&seed) % nunits);
+		if (test_rand(&seed) % 4 != 0) {
+			for (u = 0; u < nunits; u++) {
+				if (!test_covered[id][u]) {
+					offs = 8 * u;
+					break;
+				}
+			}
+		}
+
+		fsize = 8 * (1 + test_rand(&seed) % 200);
+		if (offs + fsize >= size[id])
+			fsize = size[id] - offs;
+
+		test_frag(&packet, id, buf[id], offs, fsize,
+		    offs + fsize < size[id]);
+		rc = inet_reass_queue_packet(&packet);
+		PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+		for (u = offs / 8; u < (offs + fsize + 7) / 8; u++)
+			test_covered[id][u] = true;
+
+		for (u = 0; u < nunits; u++) {
+			if (!test_covered[id][u])
+				break;
+		}
+
+		if (u == nunits) {
+			done[id] = true;
+			--remaining;
+			PCUT_ASSERT_INT_EQUALS(test_ndgrams - remaining,
+			    test_delivered);
+		}
+	}
+
+	PCUT_ASSERT_INT_EQUALS(test_ndgrams, test_delivered);
+	PCUT_ASSERT_INT_EQUALS(0, test_corrupt);
+
+	inet_reass_get_stats(&stats);
+	PCUT_ASSERT_INT_EQUALS(0, stats.dgrams);
+	PCUT_ASSERT_INT_EQUALS(0, stats.mem_used);
+
+	for (id = 0; id < test_ndgrams; id++)
+		free(buf[id]);
+}
+
+PCUT_EXPORT(reass);
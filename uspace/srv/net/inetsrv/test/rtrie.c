@@ -0,0 +1,258 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <inet/addr.h>
+#include <pcut/pcut.h>
+#include <stdlib.h>
+#include "../rtrie.h"
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(rtrie);
+
+enum {
+	/** Number of prefixes in the randomized test */
+	test_nprefix = 2048,
+	/** Number of lookups in the randomized test */
+	test_nlookup = 8192
+};
+
+/** Lookup in empty trie finds nothing */
+PCUT_TEST(empty)
+{
+	inet_rtrie_t rt;
+	inet_addr_t addr;
+
+	inet_rtrie_init(&rt);
+
+	inet_addr(&addr, 10, 0, 0, 1);
+	PCUT_ASSERT_NULL(inet_rtrie_lookup(&rt, &addr));
+
+	inet_addr6(&addr, 0xfe80, 0, 0, 0, 0, 0, 0, 1);
+	PCUT_ASSERT_NULL(inet_rtrie_lookup(&rt, &addr));
+
+	inet_rtrie_fini(&rt);
+}
+
+/** The longest matching prefix is found */
+PCUT_TEST(longest_match)
+{
+	inet_rtrie_t rt;
+	inet_rtrie_entry_t e0, e8, e16, e24;
+	inet_naddr_t n0, n8, n16, n24;
+	inet_addr_t addr;
+	errno_t rc;
+
+	inet_rtrie_init(&rt);
+
+	inet_naddr(&n0, 0, 0, 0, 0, 0);
+	inet_naddr(&n8, 10, 0, 0, 0, 8);
+	inet_naddr(&n16, 10, 1, 0, 0, 16);
+	inet_naddr(&n24, 10, 1, 2, 0, 24);
+
+	/* Insert in an order that exercises node splitting */
+	rc = inet_rtrie_insert(&rt, &n24, &e24, &n24);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	rc = inet_rtrie_insert(&rt, &n8, &e8, &n8);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	rc = inet_rtrie_insert(&rt, &n0, &e0, &n0);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	rc = inet_rtrie_insert(&rt, &n16, &e16, &n16);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	inet_addr(&addr, 10, 1, 2, 3);
+	PCUT_ASSERT_EQUALS(&n24, inet_rtrie_lookup(&rt, &addr));
+	inet_addr(&addr, 10, 1, 3, 3);
+	PCUT_ASSERT_EQUALS(&n16, inet_rtrie_lookup(&rt, &addr));
+	inet_addr(&addr, 10, 2, 2, 3);
+	PCUT_ASSERT_EQUALS(&n8, inet_rtrie_lookup(&rt, &addr));
+	inet_addr(&addr, 192, 168, 0, 1);
+	PCUT_ASSERT_EQUALS(&n0, inet_rtrie_lookup(&rt, &addr));
+
+	/* IPv4 default route does not match IPv6 addresses */
+	inet_addr6(&addr, 0xfe80, 0, 0, 0, 0, 0, 0, 1);
+	PCUT_ASSERT_NULL(inet_rtrie_lookup(&rt, &addr));
+
+	inet_rtrie_remove(&rt, &e16);
+	inet_addr(&addr, 10, 1, 3, 3);
+	PCUT_ASSERT_EQUALS(&n8, inet_rtrie_lookup(&rt, &addr));
+
+	inet_rtrie_remove(&rt, &e0);
+	inet_rtrie_remove(&rt, &e24);
+	inet_rtrie_remove(&rt, &e8);
+
+	PCUT_ASSERT_INT_EQUALS(0, rt.count);
+	inet_rtrie_fini(&rt);
+}
+
+/** IPv6 prefixes */
+PCUT_TEST(ipv6)
+{
+	inet_rtrie_t rt;
+	inet_rtrie_entry_t e64, e128;
+	inet_naddr_t n64, n128;
+	inet_addr_t addr;
+	errno_t rc;
+
+	inet_rtrie_init(&rt);
+
+	inet_naddr6(&n64, 0xfe80, 0, 0, 0, 0, 0, 0, 0, 64);
+	inet_naddr6(&n128, 0xfe80, 0, 0, 0, 0, 0, 0, 5, 128);
+
+	rc = inet_rtrie_insert(&rt, &n64, &e64, &n64);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	rc = inet_rtrie_insert(&rt, &n128, &e128, &n128);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	inet_addr6(&addr, 0xfe80, 0, 0, 0, 0, 0, 0, 5);
+	PCUT_ASSERT_EQUALS(&n128, inet_rtrie_lookup(&rt, &addr));
+	inet_addr6(&addr, 0xfe80, 0, 0, 0, 0, 0, 0, 6);
+	PCUT_ASSERT_EQUALS(&n64, inet_rtrie_lookup(&rt, &addr));
+	inet_addr6(&addr, 0xfe80, 0, 0, 1, 0, 0, 0, 5);
+	PCUT_ASSERT_NULL(inet_rtrie_lookup(&rt, &addr));
+
+	inet_rtrie_remove(&rt, &e64);
+	inet_rtrie_remove(&rt, &e128);
+	inet_rtrie_fini(&rt);
+}
+
+/** Entries with the same prefix are returned in insertion order */
+PCUT_TEST(duplicate)
+{
+	inet_rtrie_t rt;
+	inet_rtrie_entry_t e1, e2;
+	inet_naddr_t n1, n2;
+	inet_addr_t addr;
+	errno_t rc;
+
+	inet_rtrie_init(&rt);
+
+	inet_naddr(&n1, 10, 0, 0, 1, 24);
+	inet_naddr(&n2, 10, 0, 0, 2, 24);
+
+	rc = inet_rtrie_insert(&rt, &n1, &e1, &n1);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	rc = inet_rtrie_insert(&rt, &n2, &e2, &n2);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	inet_addr(&addr, 10, 0, 0, 7);
+	PCUT_ASSERT_EQUALS(&n1, inet_rtrie_lookup(&rt, &addr));
+
+	inet_rtrie_remove(&rt, &e1);
+	PCUT_ASSERT_EQUALS(&n2, inet_rtrie_lookup(&rt, &addr));
+
+	inet_rtrie_remove(&rt, &e2);
+	PCUT_ASSERT_NULL(inet_rtrie_lookup(&rt, &addr));
+	inet_rtrie_fini(&rt);
+}
+
+/** Invalid prefix length is rejected */
+PCUT_TEST(invalid)
+{
+	inet_rtrie_t rt;
+	inet_rtrie_entry_t e;
+	inet_naddr_t n;
+
+	inet_rtrie_init(&rt);
+
+	inet_naddr(&n, 10, 0, 0, 0, 33);
+	PCUT_ASSERT_ERRNO_VAL(EINVAL, inet_rtrie_insert(&rt, &n, &e, NULL));
+
+	inet_naddr_any(&n);
+	PCUT_ASSERT_ERRNO_VAL(EINVAL, inet_rtrie_insert(&rt, &n, &e, NULL));
+
+	inet_rtrie_fini(&rt);
+}
+
+/** Simple linear congruential generator for reproducible test data */
+static uint32_t test_rand(uint32_t *seed)
+{
+	*seed = *seed * 1103515245 + 12345;
+	return *seed >> 8;
+}
+
+/** Thousands of random IPv4 prefixes agree with a linear search */
+PCUT_TEST(random_v4)
+{
+	inet_rtrie_t rt;
+	inet_rtrie_entry_t *entries;
+	inet_naddr_t *nets;
+	inet_naddr_t *found;
+	inet_addr_t addr;
+	uint32_t seed = 42;
+	size_t i, j;
+	int best;
+	errno_t rc;
+
+	entries = calloc(test_nprefix, sizeof(inet_rtrie_entry_t));
+	PCUT_ASSERT_NOT_NULL(entries);
+	nets = calloc(test_nprefix, sizeof(inet_naddr_t));
+	PCUT_ASSERT_NOT_NULL(nets);
+
+	inet_rtrie_init(&rt);
+
+	for (i = 0; i < test_nprefix; i++) {
+		/* Keep addresses clustered so that prefixes overlap */
+		inet_naddr_set(0x0a000000 | (test_rand(&seed) & 0xffff) << 4,
+		    8 + test_rand(&seed) % 25, &nets[i]);
+		rc = inet_rtrie_insert(&rt, &nets[i], &entries[i], &nets[i]);
+		PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	}
+
+	for (j = 0; j < test_nlookup; j++) {
+		inet_addr_set(0x0a000000 | (test_rand(&seed) & 0xfffff), &addr);
+
+		best = -1;
+		for (i = 0; i < test_nprefix; i++) {
+			if (!inet_naddr_compare_mask(&nets[i], &addr))
+				continue;
+			if (best < 0 || nets[i].prefix > nets[best].prefix)
+				best = i;
+		}
+
+		found = inet_rtrie_lookup(&rt, &addr);
+		if (best < 0) {
+			PCUT_ASSERT_NULL(found);
+		} else {
+			PCUT_ASSERT_NOT_NULL(found);
+			PCUT_ASSERT_INT_EQUALS(nets[best].prefix, found->prefix);
+			PCUT_ASSERT_TRUE(inet_naddr_compare_mask(found, &addr));
+		}
+	}
+
+	for (i = 0; i < test_nprefix; i++)
+		inet_rtrie_remove(&rt, &entries[i]);
+
+	PCUT_ASSERT_NULL(rt.root4);
+	inet_rtrie_fini(&rt);
+	free(nets);
+	free(entries);
+}
+
+PCUT_EXPORT(rtrie);
@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Longest-prefix-match lookup benchmark. The trie is filled with random
+ * IPv4 prefixes of length 8 to 32 and each lookup is for an address
+ * inside a randomly chosen prefix. The same table is also searched
+ * linearly, as inetsrv did before it had the trie. The results must
+ * agree and the time per lookup of both is reported in the test output.
+ */
+
+#include <errno.h>
+#include <inet/addr.h>
+#include <pcut/pcut.h>
+#include <perf.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "../rtrie.h"
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(rtrie_bench);
+
+enum {
+	/** Number of distinct lookup addresses */
+	bench_naddr = 4096,
+	/** Number of trie lookups */
+	bench_nlookup = 1 << 18,
+	/** Number of route table entries visited by linear lookups */
+	bench_nlinear = 1 << 22
+};
+
+/** Benchmark data */
+typedef struct {
+	/** Number of routes */
+	size_t nroutes;
+	/** Route prefixes */
+	inet_naddr_t *nets;
+	/** Trie entries */
+	inet_rtrie_entry_t *entries;
+	/** Lookup addresses */
+	inet_addr_t *addrs;
+	/** Routing trie */
+	inet_rtrie_t rt;
+} bench_t;
+
+/** Simple linear congruential generator for reproducible test data */
+static uint32_t bench_rand(uint32_t *seed)
+{
+	*seed = *seed * 1103515245 + 12345;
+	return *seed >> 8;
+}
+
+/** Find the longest matching prefix by linear search. */
+static inet_naddr_t *bench_linear_lookup(bench_t *b, inet_addr_t *addr)
+{
+	inet_naddr_t *best = NULL;
+	size_t i;
+
+	for (i = 0; i < b->nroutes; i++) {
+		if (inet_naddr_compare_mask(&b->nets[i], addr) &&
+		    (best == NULL || b->nets[i].prefix > best->prefix))
+			best = &b->nets[i];
+	}
+
+	return best;
+}
+
+/** Fill the route table and the trie and choose lookup addresses. */
+static void bench_setup(bench_t *b, size_t nroutes)
+{
+	uint32_t seed = 1;
+	uint32_t a;
+	uint8_t plen;
+	size_t i;
+	errno_t rc;
+
+	b->nroutes = nroutes;
+	b->nets = calloc(nroutes, sizeof(inet_naddr_t));
+	PCUT_ASSERT_NOT_NULL(b->nets);
+	b->entries = calloc(nroutes, sizeof(inet_rtrie_entry_t));
+	PCUT_ASSERT_NOT_NULL(b->entries);
+	b->addrs = calloc(bench_naddr, sizeof(inet_addr_t));
+	PCUT_ASSERT_NOT_NULL(b->addrs);
+
+	inet_rtrie_init(&b->rt);
+
+	for (i = 0; i < nroutes; i++) {
+		plen = 8 + bench_rand(&seed) % 25;
+		a = bench_rand(&seed) << 8 ^ bench_rand(&seed);
+		if (plen < 32)
+			a &= ~(UINT32_MAX >> plen);
+
+		inet_naddr_set(a, plen, &b->nets[i]);
+		rc = inet_rtrie_insert(&b->rt, &b->nets[i], &b->entries[i],
+		    &b->nets[i]);
+		PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	}
+
+	/* Addresses inside random prefixes, so that lookups hit */
+	for (i = 0; i < bench_naddr; i++) {
+		inet_naddr_t *net = &b->nets[bench_rand(&seed) % nroutes];
+
+		a = bench_rand(&seed) << 8 ^ bench_rand(&seed);
+		if (net->prefix < 32) {
+			a = (net->addr & ~(UINT32_MAX >> net->prefix)) |
+			    (a & (UINT32_MAX >> net->prefix));
+		} else {
+			a = net->addr;
+		}
+
+		inet_addr_set(a, &b->addrs[i]);
+	}
+}
+
+static void bench_teardown(bench_t *b)
+{
+	size_t i;
+
+	for (i = 0; i < b->nroutes; i++)
+		inet_rtrie_remove(&b->rt, &b->entries[i]);
+
+	inet_rtrie_fini(&b->rt);
+	free(b->nets);
+	free(b->entries);
+	free(b->addrs);
+}
+
+/** Time trie and linear lookups in a table of @a nroutes routes. */
+static void bench_lookup(size_t nroutes)
+{
+	stopwatch_t sw;
+	bench_t b;
+	inet_naddr_t *found;
+	nsec_t trie_ns, linear_ns;
+	size_t nlinear;
+	size_t i;
+
+	bench_setup(&b, nroutes);
+
+	/* Both lookups must find the same prefix */
+	for (i = 0; i < bench_naddr; i++) {
+		found = inet_rtrie_lookup(&b.rt, &b.addrs[i]);
+		PCUT_ASSERT_NOT_NULL(found);
+		PCUT_ASSERT_INT_EQUALS(bench_linear_lookup(&b,
+		    &b.addrs[i])->prefix, found->prefix);
+	}
+
+	stopwatch_init(&sw);
+	stopwatch_start(&sw);
+	for (i = 0; i < bench_nlookup; i++)
+		(void) inet_rtrie_lookup(&b.rt, &b.addrs[i % bench_naddr]);
+	stopwatch_stop(&sw);
+	trie_ns = stopwatch_get_nanos(&sw) / bench_nlookup;
+
+	/* Keep the linear search time independent of the table size */
+	nlinear = bench_nlinear / nroutes;
+	stopwatch_init(&sw);
+	stopwatch_start(&sw);
+	for (i = 0; i < nlinear; i++)
+		(void) bench_linear_lookup(&b, &b.addrs[i % bench_naddr]);
+	stopwatch_stop(&sw);
+	linear_ns = stopwatch_get_nanos(&sw) / nlinear;
+
+	printf("%zu routes: trie %lld ns, linear %lld ns per lookup\n",
+	    nroutes, (long long) trie_ns, (long long) linear_ns);
+
+	bench_teardown(&b);
+}
+
+/** Lookup time with a small route table */
+PCUT_TEST(lookup_16)
+{
+	bench_lookup(16);
+}
+
+/** Lookup time with a medium route table */
+PCUT_TEST(lookup_256)
+{
+	bench_lookup(256);
+}
+
+/** Lookup time with thousands of routes */
+PCUT_TEST(lookup_4096)
+{
+	bench_lookup(4096);
+}
+
+PCUT_EXPORT(rtrie_bench);